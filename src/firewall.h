@@ -52,6 +52,7 @@
 #define FW_DBUS_PATH                      "/org/fedoraproject/FirewallD1"
 #define FW_DBUS_PATH_CONFIG               "/org/fedoraproject/FirewallD1/config"
 #define FW_DBUS_PATH_CONFIG_ICMPTYPE      "/org/fedoraproject/FirewallD1/config/icmptype"
+#define FW_DBUS_PATH_CONFIG_IPSET         "/org/fedoraproject/FirewallD1/config/ipset"
 #define FW_DBUS_PATH_CONFIG_SERVICE       "/org/fedoraproject/FirewallD1/config/service"
 #define FW_DBUS_PATH_CONFIG_ZONE          "/org/fedoraproject/FirewallD1/config/zone"
 #define FW_DBUS_PATH_CONFIG_HELPER          "/org/fedoraproject/FirewallD1/config/helper"
@@ -0,0 +1,311 @@
+/*
+ * Copyright (C) 2017 Red Hat, Inc.
+ *
+ * Authors:
+ * Thomas Woerner <twoerner@redhat.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Live instance accounting for all library types. Every class registers
+ * itself in class_init, which wraps constructed and finalize with
+ * counters. Bytes are the instance and private sizes times the live
+ * instances; strings, lists and hash tables owned by the instances are
+ * not included. Subclasses outside of the library are counted with their
+ * closest registered ancestor.
+ */
+
+#include <glib-unix.h>
+#include "fw_accounting.h"
+
+typedef struct {
+    GType type;
+    gsize size;
+    void (*constructed)(GObject *obj);
+    void (*finalize)(GObject *obj);
+    gint live;
+    gint peak;
+} FWAccountingEntry;
+
+static GMutex _fw_accounting_lock;
+static GList *_fw_accounting_entries = NULL;
+
+G_DEFINE_QUARK(fw-accounting-entry, _fw_accounting_entry)
+
+static FWAccountingEntry *
+_fw_accounting_lookup(GType type)
+{
+    FWAccountingEntry *entry = NULL;
+
+    for (; type != 0 && entry == NULL; type = g_type_parent(type))
+	entry = g_type_get_qdata(type, _fw_accounting_entry_quark());
+
+    return entry;
+}
+
+static void
+_fw_accounting_constructed(GObject *obj)
+{
+    FWAccountingEntry *entry = _fw_accounting_lookup(G_OBJECT_TYPE(obj));
+    gint live = g_atomic_int_add(&entry->live, 1) + 1;
+    gint peak = g_atomic_int_get(&entry->peak);
+
+    while (live > peak &&
+	   !g_atomic_int_compare_and_exchange(&entry->peak, peak, live))
+	peak = g_atomic_int_get(&entry->peak);
+
+    if (entry->constructed != NULL)
+	entry->constructed(obj);
+}
+
+static void
+_fw_accounting_finalize(GObject *obj)
+{
+    FWAccountingEntry *entry = _fw_accounting_lookup(G_OBJECT_TYPE(obj));
+
+    g_atomic_int_add(&entry->live, -1);
+
+    entry->finalize(obj);
+}
+
+static FWAccountingEntry *
+_fw_accounting_find(const gchar *type_name)
+{
+    GType type = g_type_from_name(type_name);
+
+    if (type == 0)
+	return NULL;
+
+    return g_type_get_qdata(type, _fw_accounting_entry_quark());
+}
+
+static gint
+_fw_accounting_compare(gconstpointer a,
+		       gconstpointer b)
+{
+    const FWAccountingEntry *entry_a = a, *entry_b = b;
+
+    return g_strcmp0(g_type_name(entry_a->type), g_type_name(entry_b->type));
+}
+
+/**
+ * fw_accounting_register:
+ * @obj_class: class in its class_init, after finalize has been set
+ * @private_size: size of the private struct of the class
+ */
+void
+fw_accounting_register(GObjectClass *obj_class,
+		       gsize private_size)
+{
+    FWAccountingEntry *entry = g_new0(FWAccountingEntry, 1);
+    GTypeQuery query;
+
+    entry->type = G_OBJECT_CLASS_TYPE(obj_class);
+    g_type_query(entry->type, &query);
+    entry->size = query.instance_size + private_size;
+    entry->constructed = obj_class->constructed;
+    entry->finalize = obj_class->finalize;
+
+    obj_class->constructed = _fw_accounting_constructed;
+    obj_class->finalize = _fw_accounting_finalize;
+
+    g_type_set_qdata(entry->type, _fw_accounting_entry_quark(), entry);
+
+    g_mutex_lock(&_fw_accounting_lock);
+    _fw_accounting_entries = g_list_insert_sorted(_fw_accounting_entries,
+						  entry,
+						  _fw_accounting_compare);
+    g_mutex_unlock(&_fw_accounting_lock);
+}
+
+/**
+ * fw_accounting_getInstances:
+ * @type_name: type name like "FWPort"
+ *
+ * Returns: live instances, 0 for types that are not registered
+ */
+gint
+fw_accounting_getInstances(const gchar *type_name)
+{
+    FWAccountingEntry *entry = _fw_accounting_find(type_name);
+
+    if (entry == NULL)
+	return 0;
+
+    return g_atomic_int_get(&entry->live);
+}
+
+/**
+ * fw_accounting_getPeakInstances:
+ * @type_name: type name like "FWPort"
+ *
+ * Returns: largest number of live instances so far
+ */
+gint
+fw_accounting_getPeakInstances(const gchar *type_name)
+{
+    FWAccountingEntry *entry = _fw_accounting_find(type_name);
+
+    if (entry == NULL)
+	return 0;
+
+    return g_atomic_int_get(&entry->peak);
+}
+
+/**
+ * fw_accounting_getBytes:
+ * @type_name: type name like "FWPort"
+ *
+ * Returns: approximate bytes held by the live instances
+ */
+gsize
+fw_accounting_getBytes(const gchar *type_name)
+{
+    FWAccountingEntry *entry = _fw_accounting_find(type_name);
+
+    if (entry == NULL)
+	return 0;
+
+    return entry->size * g_atomic_int_get(&entry->live);
+}
+
+gint
+fw_accounting_getTotalInstances(void)
+{
+    GList *list;
+    gint total = 0;
+
+    g_mutex_lock(&_fw_accounting_lock);
+    for (list = _fw_accounting_entries; list != NULL; list = list->next) {
+	FWAccountingEntry *entry = list->data;
+
+	total += g_atomic_int_get(&entry->live);
+    }
+    g_mutex_unlock(&_fw_accounting_lock);
+
+    return total;
+}
+
+gsize
+fw_accounting_getTotalBytes(void)
+{
+    GList *list;
+    gsize total = 0;
+
+    g_mutex_lock(&_fw_accounting_lock);
+    for (list = _fw_accounting_entries; list != NULL; list = list->next) {
+	FWAccountingEntry *entry = list->data;
+
+	total += entry->size * g_atomic_int_get(&entry->live);
+    }
+    g_mutex_unlock(&_fw_accounting_lock);
+
+    return total;
+}
+
+/**
+ * fw_accounting_getTypeNames:
+ *
+ * Types are registered with their first instance.
+ *
+ * Returns: (transfer container) (allow-none) (type GList*) (element-type gchar*)
+ */
+GList *
+fw_accounting_getTypeNames(void)
+{
+    GList *names = NULL, *list;
+
+    g_mutex_lock(&_fw_accounting_lock);
+    for (list = _fw_accounting_entries; list != NULL; list = list->next) {
+	FWAccountingEntry *entry = list->data;
+
+	names = g_list_prepend(names, (gpointer) g_type_name(entry->type));
+    }
+    g_mutex_unlock(&_fw_accounting_lock);
+
+    return g_list_reverse(names);
+}
+
+/**
+ * fw_accounting_dump:
+ *
+ * Returns: (transfer full) (type gchar*): table of all registered types
+ */
+gchar *
+fw_accounting_dump(void)
+{
+    GString *str = g_string_new(NULL);
+    GList *list;
+    gint total = 0;
+    gsize total_bytes = 0;
+
+    g_string_append_printf(str, "%-26s %10s %10s %12s\n",
+			   "type", "live", "peak", "bytes");
+
+    g_mutex_lock(&_fw_accounting_lock);
+    for (list = _fw_accounting_entries; list != NULL; list = list->next) {
+	FWAccountingEntry *entry = list->data;
+	gint live = g_atomic_int_get(&entry->live);
+
+	g_string_append_printf(str, "%-26s %10d %10d %12" G_GSIZE_FORMAT "\n",
+			       g_type_name(entry->type), live,
+			       g_atomic_int_get(&entry->peak),
+			       entry->size * live);
+	total += live;
+	total_bytes += entry->size * live;
+    }
+    g_mutex_unlock(&_fw_accounting_lock);
+
+    g_string_append_printf(str, "%-26s %10d %10s %12" G_GSIZE_FORMAT "\n",
+			   "total", total, "", total_bytes);
+
+    return g_string_free(str, FALSE);
+}
+
+void
+fw_accounting_print(void)
+{
+    gchar *str = fw_accounting_dump();
+
+    g_print("%s", str);
+    g_free(str);
+}
+
+static gboolean
+_fw_accounting_signal(gpointer user_data)
+{
+    fw_accounting_print();
+
+    return G_SOURCE_CONTINUE;
+}
+
+/**
+ * fw_accounting_installSignalHandler:
+ * @signum: SIGHUP, SIGINT, SIGTERM, SIGUSR1, SIGUSR2 or SIGWINCH
+ *
+ * Prints the accounting table whenever the signal arrives. The dump runs
+ * in the default main context, which needs to be iterated.
+ *
+ * Returns: source id of the signal watch
+ */
+guint
+fw_accounting_installSignalHandler(gint signum)
+{
+#ifdef FW_DEBUG
+    g_printerr("fw_accounting_installSignalHandler(%d)\n", signum);
+#endif
+
+    return g_unix_signal_add(signum, _fw_accounting_signal, NULL);
+}
@@ -0,0 +1,41 @@
+/*
+ * Copyright (C) 2017 Red Hat, Inc.
+ *
+ * Authors:
+ * Thomas Woerner <twoerner@redhat.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __FW_ACCOUNTING_H__
+#define __FW_ACCOUNTING_H__
+
+#include <glib.h>
+#include <glib-object.h>
+#include "firewall.h"
+
+void fw_accounting_register(GObjectClass *obj_class, gsize private_size);
+
+gint fw_accounting_getInstances(const gchar *type_name);
+gint fw_accounting_getPeakInstances(const gchar *type_name);
+gsize fw_accounting_getBytes(const gchar *type_name);
+gint fw_accounting_getTotalInstances(void);
+gsize fw_accounting_getTotalBytes(void);
+GList *fw_accounting_getTypeNames(void);
+
+gchar *fw_accounting_dump(void);
+void fw_accounting_print(void);
+guint fw_accounting_installSignalHandler(gint signum);
+
+#endif /* __FW_ACCOUNTING_H__ */
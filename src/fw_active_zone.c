@@ -19,6 +19,10 @@
  */
 
 #include "fw_active_zone.h"
+#include "fw_trace.h"
+#include "fw_accounting.h"
+#include "fw_functions.h"
+#include <string.h>
 
 G_DEFINE_TYPE(FWActiveZone, fw_active_zone, G_TYPE_OBJECT);
 
@@ -35,6 +39,60 @@ fw_active_zone_new()
     return g_object_new(FW_ACTIVE_ZONE_TYPE, NULL);
 }
 
+/**
+ * fw_active_zone_table_new_from_variant:
+ * @variant: (type GVariant*): getActiveZones reply of type (a{sa{sas}})
+ *
+ * Returns: (transfer full) (allow-none) (element-type gchar* FWActiveZone*)
+ */
+GHashTable *
+fw_active_zone_table_new_from_variant(GVariant *variant)
+{
+    GHashTable *active_zones;
+    GVariantIter iter, iter2;
+    GVariant *value, *list;
+    const gchar *zone, *key;
+
+    if (variant == NULL)
+	return NULL;
+
+    if (strncmp(g_variant_get_type_string(variant), "(a{sa{sas}})", 12) != 0) {
+	if (strncmp(g_variant_get_type_string(variant), "a{sa{sas}}", 10) != 0)
+	    return NULL;
+	g_variant_ref(variant);
+    } else
+	variant = g_variant_get_child_value(variant, 0);
+
+    FW_TRACE_DECODE_START(variant);
+
+    active_zones = g_hash_table_new_full(g_str_hash, g_str_equal,
+					 g_free, g_object_unref);
+
+    g_variant_iter_init(&iter, variant);
+    while (g_variant_iter_next(&iter, "{&s@a{sas}}", &zone, &value)) {
+	FWActiveZone *active_zone = fw_active_zone_new();
+
+	g_variant_iter_init(&iter2, value);
+	while (g_variant_iter_next(&iter2, "{&s@as}", &key, &list)) {
+	    if (strcmp(key, "interfaces") == 0)
+		fw_active_zone_setInterfaces(active_zone,
+					     fw_str_list_new_from_variant(list));
+	    else if (strcmp(key, "sources") == 0)
+		fw_active_zone_setSources(active_zone,
+					  fw_str_list_new_from_variant(list));
+	    g_variant_unref(list);
+	}
+	g_variant_unref(value);
+
+	g_hash_table_insert(active_zones, g_strdup(zone), active_zone);
+    }
+
+    g_variant_unref(variant);
+
+    FW_TRACE_DECODE_DONE();
+    return active_zones;
+}
+
 static void
 fw_active_zone_init(FWActiveZone *obj)
 {
@@ -51,10 +109,10 @@ fw_active_zone_finalize(GObject *obj)
     FWActiveZonePrivate *az = FW_ACTIVE_ZONE_GET_PRIVATE(obj);
 
     if (az->interfaces != NULL) {
-	g_list_foreach(az->interfaces, (GFunc) g_free, NULL);
+	g_list_free_full(az->interfaces, g_free);
     }
     if (az->sources != NULL) {
-	g_list_foreach(az->sources, (GFunc) g_free, NULL);
+	g_list_free_full(az->sources, g_free);
     }
 
     G_OBJECT_CLASS(fw_active_zone_parent_class)->finalize(obj);
@@ -68,6 +126,7 @@ fw_active_zone_class_init(FWActiveZoneClass *fw_active_zone_class)
     obj_class->finalize = fw_active_zone_finalize;
 
     g_type_class_add_private(obj_class, sizeof(FWActiveZonePrivate));
+    fw_accounting_register(obj_class, sizeof(FWActiveZonePrivate));
 }
 
 /* methods */
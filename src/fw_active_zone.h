@@ -41,6 +41,7 @@ typedef struct {
 
 GType fw_active_zone_get_type(void);
 FWActiveZone *fw_active_zone_new(void);
+GHashTable *fw_active_zone_table_new_from_variant(GVariant *variant);
 
 GList *fw_active_zone_getInterfaces(FWActiveZone *obj);
 GList *fw_active_zone_getSources(FWActiveZone *obj);
@@ -19,6 +19,7 @@
  */
 
 #include "fw_args.h"
+#include "fw_accounting.h"
 #include "fw_functions.h"
 
 G_DEFINE_TYPE(FWArgs, fw_args, G_TYPE_OBJECT);
@@ -63,6 +64,7 @@ fw_args_class_init(FWArgsClass *fw_args_class)
     obj_class->finalize = fw_args_finalize;
 
     g_type_class_add_private(obj_class, sizeof(FWArgsPrivate));
+    fw_accounting_register(obj_class, sizeof(FWArgsPrivate));
 }
 
 /* methods */
@@ -0,0 +1,406 @@
+/*
+ * Copyright (C) 2017 Red Hat, Inc.
+ *
+ * Authors:
+ * Thomas Woerner <twoerner@redhat.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Pipelined D-Bus calls to firewalld: calls are collected with fw_batch_add
+ * and sent by fw_batch_run without waiting for each reply, keeping up to
+ * max_pending calls in flight. The replies are dispatched in a private main
+ * context, so running a batch does not dispatch any other sources of the
+ * caller. With a FWLimiter, mutating calls are only sent while the
+ * limiter admits them.
+ */
+
+#include "fw_batch.h"
+#include "fw_accounting.h"
+#include "fw_functions.h"
+
+G_DEFINE_TYPE(FWBatch, fw_batch, G_TYPE_OBJECT);
+
+#define FW_BATCH_GET_PRIVATE(o) (G_TYPE_INSTANCE_GET_PRIVATE((o), FW_BATCH_TYPE, FWBatchPrivate))
+
+typedef struct _FWBatchPrivate FWBatchPrivate;
+
+typedef struct {
+    FWBatchPrivate *priv;
+    gchar *path;
+    const gchar *interface;	/* interned */
+    const gchar *method_name;	/* interned */
+    GVariant *parameters;
+    GVariant *result;
+    GError *error;
+    gint64 sent;
+    gboolean limited;		/* admitted by the limiter */
+} FWBatchCall;
+
+struct _FWBatchPrivate {
+    GDBusConnection *connection;
+    GPtrArray *calls;		/* FWBatchCall */
+    guint max_pending;
+    guint next;			/* first call not sent yet */
+    guint pending;		/* calls in flight */
+    FWLimiter *limiter;
+    FWLimiterPriority priority;
+};
+
+static void
+_fw_batch_call_free(gpointer data)
+{
+    FWBatchCall *call = data;
+
+    g_free(call->path);
+    if (call->parameters != NULL)
+	g_variant_unref(call->parameters);
+    if (call->result != NULL)
+	g_variant_unref(call->result);
+    if (call->error != NULL)
+	g_error_free(call->error);
+    g_slice_free(FWBatchCall, call);
+}
+
+/**
+ * fw_batch_new:
+ * @connection: (type GDBusConnection*): connection to the system bus
+ *
+ * Returns: (transfer full) (type FWBatch*)
+ */
+FWBatch *
+fw_batch_new(GDBusConnection *connection)
+{
+    FWBatch *obj = g_object_new(FW_BATCH_TYPE, NULL);
+    FWBatchPrivate *priv = FW_BATCH_GET_PRIVATE(obj);
+
+    if (connection != NULL)
+	priv->connection = g_object_ref(connection);
+
+    return obj;
+}
+
+static void
+fw_batch_init(FWBatch *obj)
+{
+    FWBatchPrivate *priv = FW_BATCH_GET_PRIVATE(obj);
+
+    /* init vars */
+    priv->connection = NULL;
+    priv->calls = g_ptr_array_new_with_free_func(_fw_batch_call_free);
+    priv->max_pending = FW_BATCH_MAX_PENDING;
+    priv->next = 0;
+    priv->pending = 0;
+    priv->limiter = NULL;
+    priv->priority = FW_LIMITER_PRIORITY_NORMAL;
+}
+
+static void
+fw_batch_finalize(GObject *obj)
+{
+    FWBatchPrivate *priv = FW_BATCH_GET_PRIVATE(obj);
+
+    g_ptr_array_unref(priv->calls);
+    if (priv->limiter != NULL)
+	g_object_unref(priv->limiter);
+    if (priv->connection != NULL)
+	g_object_unref(priv->connection);
+
+    G_OBJECT_CLASS(fw_batch_parent_class)->finalize(obj);
+}
+
+static void
+fw_batch_class_init(FWBatchClass *fw_batch_class)
+{
+    GObjectClass *obj_class = G_OBJECT_CLASS(fw_batch_class);
+
+    obj_class->finalize = fw_batch_finalize;
+
+    g_type_class_add_private(obj_class, sizeof(FWBatchPrivate));
+    fw_accounting_register(obj_class, sizeof(FWBatchPrivate));
+}
+
+/* methods */
+
+void
+fw_batch_setMaxPending(FWBatch *obj,
+		       guint max_pending)
+{
+    FWBatchPrivate *priv = FW_BATCH_GET_PRIVATE(obj);
+
+    priv->max_pending = MAX(max_pending, 1);
+}
+
+guint
+fw_batch_getMaxPending(FWBatch *obj)
+{
+    FWBatchPrivate *priv = FW_BATCH_GET_PRIVATE(obj);
+
+    return priv->max_pending;
+}
+
+/**
+ * fw_batch_setLimiter:
+ * @obj: (type FWBatch*): a FWBatch instance
+ * @limiter: (type FWLimiter*) (allow-none): admission control for the
+ *   mutating calls, shared with other batches and clients to limit the
+ *   load on firewalld
+ * @priority: priority of the calls of this batch
+ */
+void
+fw_batch_setLimiter(FWBatch *obj,
+		    FWLimiter *limiter,
+		    FWLimiterPriority priority)
+{
+    FWBatchPrivate *priv = FW_BATCH_GET_PRIVATE(obj);
+
+    if (limiter != NULL)
+	g_object_ref(limiter);
+    if (priv->limiter != NULL)
+	g_object_unref(priv->limiter);
+    priv->limiter = limiter;
+    priv->priority = priority;
+}
+
+/**
+ * fw_batch_getLimiter:
+ * @obj: (type FWBatch*): a FWBatch instance
+ *
+ * Returns: (transfer none) (allow-none) (type FWLimiter*)
+ */
+FWLimiter *
+fw_batch_getLimiter(FWBatch *obj)
+{
+    FWBatchPrivate *priv = FW_BATCH_GET_PRIVATE(obj);
+
+    return priv->limiter;
+}
+
+/**
+ * fw_batch_add:
+ * @obj: (type FWBatch*): a FWBatch instance
+ * @path: (type utf8): object path
+ * @interface: (type utf8): D-Bus interface
+ * @method_name: (type utf8): method
+ * @parameters: (type GVariant*) (allow-none): method parameters, a
+ *   floating reference is consumed
+ *
+ * Queues a call to firewalld, it is sent with the next fw_batch_run.
+ *
+ * Returns: index of the call for fw_batch_getResult and fw_batch_getError
+ */
+guint
+fw_batch_add(FWBatch *obj,
+	     const gchar *path,
+	     const gchar *interface,
+	     const gchar *method_name,
+	     GVariant *parameters)
+{
+    FWBatchPrivate *priv = FW_BATCH_GET_PRIVATE(obj);
+    FWBatchCall *call = g_slice_new0(FWBatchCall);
+
+    call->priv = priv;
+    call->path = g_strdup(path);
+    call->interface = g_intern_string(interface);
+    call->method_name = g_intern_string(method_name);
+    if (parameters != NULL)
+	call->parameters = g_variant_ref_sink(parameters);
+
+    g_ptr_array_add(priv->calls, call);
+
+    return priv->calls->len - 1;
+}
+
+guint
+fw_batch_getLength(FWBatch *obj)
+{
+    FWBatchPrivate *priv = FW_BATCH_GET_PRIVATE(obj);
+
+    return priv->calls->len;
+}
+
+static void _fw_batch_send(FWBatchPrivate *priv);
+
+static void
+_fw_batch_reply(GObject *source,
+		GAsyncResult *res,
+		gpointer user_data)
+{
+    FWBatchCall *call = user_data;
+    FWBatchPrivate *priv = call->priv;
+
+    call->result = g_dbus_connection_call_finish(G_DBUS_CONNECTION(source),
+						 res, &call->error);
+    priv->pending--;
+
+    if (call->limited)
+	fw_limiter_release(priv->limiter, g_get_monotonic_time() - call->sent,
+			   g_error_matches(call->error, G_DBUS_ERROR,
+					   G_DBUS_ERROR_NO_REPLY) ||
+			   g_error_matches(call->error, G_DBUS_ERROR,
+					   G_DBUS_ERROR_TIMED_OUT) ||
+			   g_error_matches(call->error, G_DBUS_ERROR,
+					   G_DBUS_ERROR_LIMITS_EXCEEDED));
+
+    _fw_batch_send(priv);
+}
+
+static void
+_fw_batch_send(FWBatchPrivate *priv)
+{
+    while (priv->pending < priv->max_pending &&
+	   priv->next < priv->calls->len)
+    {
+	FWBatchCall *call = g_ptr_array_index(priv->calls, priv->next);
+
+	if (priv->limiter != NULL && !fw_method_is_read(call->method_name)) {
+	    /* with calls in flight, the next reply sends more */
+	    if (!fw_limiter_tryAcquire(priv->limiter, priv->priority)) {
+		if (priv->pending > 0)
+		    break;
+		if (!fw_limiter_acquire(priv->limiter, priv->priority)) {
+		    g_set_error(&call->error, G_DBUS_ERROR,
+				G_DBUS_ERROR_LIMITS_EXCEEDED,
+				"too many calls waiting for firewalld");
+		    priv->next++;
+		    continue;
+		}
+	    }
+	    call->limited = TRUE;
+	}
+
+	priv->next++;
+	priv->pending++;
+	call->sent = g_get_monotonic_time();
+	g_dbus_connection_call(priv->connection,
+			       FW_DBUS_NAME,
+			       call->path,
+			       call->interface,
+			       call->method_name,
+			       call->parameters,
+			       NULL,
+			       G_DBUS_CALL_FLAGS_NONE,
+			       -1,
+			       NULL,
+			       _fw_batch_reply,
+			       call);
+    }
+}
+
+/**
+ * fw_batch_run:
+ * @obj: (type FWBatch*): a FWBatch instance
+ * @error: (allow-none): return location for the first failed call
+ *
+ * Sends all calls added since the last run and waits for all replies.
+ * Failed calls do not stop the batch, the results and errors of all calls
+ * are available afterwards.
+ *
+ * Returns: TRUE if all calls succeeded
+ */
+gboolean
+fw_batch_run(FWBatch *obj,
+	     GError **error)
+{
+    FWBatchPrivate *priv = FW_BATCH_GET_PRIVATE(obj);
+    GMainContext *context;
+    guint first = priv->next;
+    guint i;
+
+#ifdef FW_DEBUG
+    g_printerr("fw_batch_run(%u calls)\n", priv->calls->len - first);
+#endif
+
+    if (priv->connection == NULL) {
+	g_set_error(error, G_IO_ERROR, G_IO_ERROR_NOT_CONNECTED,
+		    "no connection to firewalld");
+	return FALSE;
+    }
+
+    context = g_main_context_new();
+    g_main_context_push_thread_default(context);
+
+    _fw_batch_send(priv);
+    while (priv->pending > 0)
+	g_main_context_iteration(context, TRUE);
+
+    g_main_context_pop_thread_default(context);
+    g_main_context_unref(context);
+
+    for (i = first; i < priv->calls->len; i++) {
+	FWBatchCall *call = g_ptr_array_index(priv->calls, i);
+
+	if (call->error != NULL) {
+	    if (error != NULL && *error == NULL) {
+		*error = g_error_copy(call->error);
+		g_prefix_error(error, "%s: ", call->method_name);
+	    }
+	    return FALSE;
+	}
+    }
+
+    return TRUE;
+}
+
+/**
+ * fw_batch_getResult:
+ * @obj: (type FWBatch*): a FWBatch instance
+ * @index: call index as returned by fw_batch_add
+ *
+ * Returns: (transfer none) (allow-none) (type GVariant*): reply of the call
+ */
+GVariant *
+fw_batch_getResult(FWBatch *obj,
+		   guint index)
+{
+    FWBatchPrivate *priv = FW_BATCH_GET_PRIVATE(obj);
+    FWBatchCall *call;
+
+    if (index >= priv->calls->len)
+	return NULL;
+
+    call = g_ptr_array_index(priv->calls, index);
+    return call->result;
+}
+
+/**
+ * fw_batch_getError:
+ * @obj: (type FWBatch*): a FWBatch instance
+ * @index: call index as returned by fw_batch_add
+ *
+ * Returns: (transfer none) (allow-none): error of the call, NULL on success
+ */
+const GError *
+fw_batch_getError(FWBatch *obj,
+		  guint index)
+{
+    FWBatchPrivate *priv = FW_BATCH_GET_PRIVATE(obj);
+    FWBatchCall *call;
+
+    if (index >= priv->calls->len)
+	return NULL;
+
+    call = g_ptr_array_index(priv->calls, index);
+    return call->error;
+}
+
+void
+fw_batch_clear(FWBatch *obj)
+{
+    FWBatchPrivate *priv = FW_BATCH_GET_PRIVATE(obj);
+
+    g_ptr_array_set_size(priv->calls, 0);
+    priv->next = 0;
+}
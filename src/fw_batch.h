@@ -0,0 +1,64 @@
+/*
+ * Copyright (C) 2017 Red Hat, Inc.
+ *
+ * Authors:
+ * Thomas Woerner <twoerner@redhat.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __FW_BATCH_H__
+#define __FW_BATCH_H__
+
+#include <glib.h>
+#include <glib-object.h>
+#include <gio/gio.h>
+#include "firewall.h"
+#include "fw_limiter.h"
+
+#define FW_BATCH_TYPE            (fw_batch_get_type())
+#define FW_BATCH(obj)            (G_TYPE_CHECK_INSTANCE_CAST((obj), FW_BATCH_TYPE, FWBatch))
+#define FW_BATCH_CLASS(klass)    (G_TYPE_CHECK_CLASS_CAST((klass), FW_BATCH_TYPE, FWBatchClass))
+#define FW_IS_BATCH(klass)       (G_TYPE_CHECK_INSTANCE_CLASS((klass), FW_BATCH_TYPE, FWBatchClass))
+#define FW_BATCH_GET_CLASS(obj)  (G_TYPE_INSTANCE_GET_CLASS((obj), FW_BATCH_TYPE, FWBatchClass))
+
+/* number of calls in flight if not set with fw_batch_setMaxPending */
+#define FW_BATCH_MAX_PENDING  64
+
+typedef struct {
+    GObject parent;
+} FWBatch;
+
+typedef struct {
+    GObjectClass parent;
+} FWBatchClass;
+
+GType fw_batch_get_type(void);
+FWBatch *fw_batch_new(GDBusConnection *connection);
+
+void fw_batch_setMaxPending(FWBatch *obj, guint max_pending);
+guint fw_batch_getMaxPending(FWBatch *obj);
+void fw_batch_setLimiter(FWBatch *obj, FWLimiter *limiter, FWLimiterPriority priority);
+FWLimiter *fw_batch_getLimiter(FWBatch *obj);
+
+guint fw_batch_add(FWBatch *obj, const gchar *path, const gchar *interface,
+		   const gchar *method_name, GVariant *parameters);
+guint fw_batch_getLength(FWBatch *obj);
+gboolean fw_batch_run(FWBatch *obj, GError **error);
+
+GVariant *fw_batch_getResult(FWBatch *obj, guint index);
+const GError *fw_batch_getError(FWBatch *obj, guint index);
+void fw_batch_clear(FWBatch *obj);
+
+#endif /* __FW_BATCH_H__ */
@@ -20,6 +20,7 @@
 
 #include <string.h>
 #include "fw_client.h"
+#include "fw_accounting.h"
 #include "fw_functions.h"
 #include "fw_zone.h"
 #include "fw_active_zone.h"
@@ -31,6 +32,7 @@
 #include "fw_passthrough.h"
 #include "fw_types.h"
 #include "fw_ipset.h"
+#include "fw_trace.h"
 
 G_DEFINE_TYPE(FWClient, fw_client, G_TYPE_OBJECT);
 
@@ -48,14 +50,84 @@ typedef struct {
     GError *error;
     
     FWConfig *config;
+    FWServiceCache *service_cache;
+    FWExpirationTracker *expirations;
+
+    /* reconnect */
+    FWClient *obj;
+    gchar *name_owner;
+    guint owner_subscription;
+    GList *intents;
+    guint last_intent;
+
+    /* coalesced async reads */
+    GHashTable *flights;	/* reads in flight, the tasks sharing them */
+    guint64 coalesced;
+
+    /* admission control for mutating calls */
+    FWLimiter *limiter;
+
+    /* async calls */
+    GQueue *pending_calls;	/* mutating calls waiting for admission */
+    guint calls_in_flight;
+    guint calls_admitted;	/* calls in flight holding a limiter slot */
+    GSource *pending_retry;
+
+    /* reloads */
+    guint64 reloads;		/* Reloaded signals */
+    GList *reload_tasks;	/* async reloads in progress */
+    FWHistogram *reload_histogram;
+    FWHistogram *complete_reload_histogram;
 
     /* properties */
     gboolean quiet;
     gboolean connected;
 } FWClientPrivate;
 
+/* runtime intent, replayed after firewalld has been restarted */
+typedef struct {
+    guint id;
+    gchar *interface;
+    gchar *method_name;
+    GVariant *parameters;
+} FWClientIntent;
+
+/* async reload, done with the reply, a Reloaded signal and state RUNNING */
+typedef struct {
+    gboolean complete;
+    guint64 reloads;		/* Reloaded signals before the call */
+    gint64 start;
+    gboolean replied;
+    GSource *cancel_source;	/* completes the task when cancelled */
+} FWClientReload;
+
+/* decodes the reply of an async read, NULL with @error set if it is not
+   of the expected type */
+typedef gpointer (*FWClientDecodeFunc)(GVariant *variant, GError **error);
+
+/* async call, waiting for admission or in flight */
+typedef struct {
+    GDBusProxy **slot;		/* the proxy is replaced with a reconnect */
+    gchar *method_name;
+    GVariant *parameters;
+    gchar *key;			/* read shared with identical later reads */
+    /* reply decoded once for all callers of a shared read */
+    FWClientDecodeFunc decode;
+    GBoxedCopyFunc share;	/* reference for another caller */
+    GDestroyNotify free_result;
+    gboolean admitted;		/* holds a slot of the limiter */
+    gint64 sent;
+    /* expiration to track once the call succeeded */
+    const gchar *type;
+    gchar *zone;
+    gchar *item;
+    gint32 timeout;
+    gboolean added;
+} FWClientCall;
+
 enum {
     PROP_0,
+    PROP_CONNECTED,
     PROP_VERSION,
     PROP_INTERFACE_VERSION,
     PROP_STATE,
@@ -74,6 +146,16 @@ enum {
 
 /* static GParamSpec *obj_properties[N_PROPERTIES] = { NULL, }; */
 
+/**
+ * fw_client_new:
+ *
+ * A client is not thread safe, it keeps the error of the last call. Use
+ * it from one thread at a time, threads that call firewalld at the same
+ * time use a client each. The signals of firewalld are dispatched in the
+ * thread-default main context of the thread that created the client.
+ *
+ * Returns: (transfer full) (type FWClient*)
+ */
 FWClient *
 fw_client_new()
 {
@@ -81,6 +163,17 @@ fw_client_new()
 }
 
 static void _fw_client_dbus_connect(FWClientPrivate *priv);
+static void _fw_client_name_owner_changed(GDBusConnection *connection,
+					  const gchar *sender_name,
+					  const gchar *object_path,
+					  const gchar *interface_name,
+					  const gchar *signal_name,
+					  GVariant *parameters,
+					  gpointer user_data);
+static void _fw_client_properties_changed(GDBusProxy *proxy,
+					  GVariant *changed_properties,
+					  GStrv invalidated_properties,
+					  gpointer user_data);
 
 static void
 fw_client_init(FWClient *obj)
@@ -98,6 +191,31 @@ fw_client_init(FWClient *obj)
     priv->error = NULL;
 
     priv->config = NULL;
+    priv->service_cache = NULL;
+    priv->expirations = fw_expiration_tracker_new(
+	g_main_context_get_thread_default());
+
+    priv->obj = obj;
+    priv->name_owner = NULL;
+    priv->owner_subscription = 0;
+    priv->intents = NULL;
+    priv->last_intent = 0;
+
+    priv->flights = g_hash_table_new_full(g_str_hash, g_str_equal, g_free,
+					  NULL);
+    priv->coalesced = 0;
+
+    priv->limiter = fw_limiter_new();
+
+    priv->pending_calls = g_queue_new();
+    priv->calls_in_flight = 0;
+    priv->calls_admitted = 0;
+    priv->pending_retry = NULL;
+
+    priv->reloads = 0;
+    priv->reload_tasks = NULL;
+    priv->reload_histogram = fw_histogram_new();
+    priv->complete_reload_histogram = fw_histogram_new();
 
     priv->quiet = FALSE;
     priv->connected = FALSE;
@@ -117,8 +235,41 @@ fw_client_init(FWClient *obj)
 #endif
 
     _fw_client_dbus_connect(priv);
+
+    /* follow restarts of firewalld */
+    priv->owner_subscription = g_dbus_connection_signal_subscribe(
+	priv->connection, "org.freedesktop.DBus", "org.freedesktop.DBus",
+	"NameOwnerChanged", "/org/freedesktop/DBus", FW_DBUS_NAME,
+	G_DBUS_SIGNAL_FLAGS_NONE, _fw_client_name_owner_changed, priv, NULL);
+}
+
+static void
+_fw_client_intent_free(gpointer data)
+{
+    FWClientIntent *intent = data;
+
+    g_free(intent->interface);
+    g_free(intent->method_name);
+    if (intent->parameters != NULL)
+	g_variant_unref(intent->parameters);
+    g_free(intent);
+}
+
+/* everything that is rebuilt by a reload of firewalld */
+static void
+_fw_client_invalidate_caches(FWClientPrivate *priv)
+{
+    if (priv->service_cache != NULL)
+	fw_service_cache_invalidate(priv->service_cache);
+    if (priv->config != NULL)
+	fw_config_invalidateCache(priv->config);
+    /* timed runtime entries are gone with a reload */
+    fw_expiration_tracker_clear(priv->expirations, FW_EXPIRATION_RELOADED);
 }
 
+static void _fw_client_reload_check(FWClientPrivate *priv);
+static void _fw_client_reload_fail(FWClientPrivate *priv);
+
 static void
 _fw_client_reset_error(FWClientPrivate *priv)
 {
@@ -137,11 +288,33 @@ _fw_client_signal_receiver(GDBusProxy *proxy,
 			   GVariant *parameters,
 			   gpointer user_data)
 {
+    FWClientPrivate *priv = user_data;
+
     /* print received signals */
     gchar *str;
     str = g_variant_print(parameters, TRUE);
     g_print("received signal: %s: %s\n", signal_name, str);
     g_free(str);
+
+    /* services only change with a reload */
+    if (strcmp(signal_name, "Reloaded") == 0) {
+	priv->reloads++;
+	_fw_client_invalidate_caches(priv);
+	_fw_client_reload_check(priv);
+    }
+}
+
+static void
+_fw_client_zone_signal_receiver(GDBusProxy *proxy,
+				gchar *sender_name,
+				gchar *signal_name,
+				GVariant *parameters,
+				gpointer user_data)
+{
+    FWClientPrivate *priv = user_data;
+
+    fw_expiration_tracker_handleSignal(priv->expirations, signal_name,
+				       parameters);
 }
 
 static void
@@ -151,7 +324,7 @@ _fw_client_dbus_connect(FWClientPrivate *priv)
 
     /* create syncroneous proxies */
     priv->proxy = g_dbus_proxy_new_sync(priv->connection,
-				      G_DBUS_PROXY_FLAGS_NONE,
+				      G_DBUS_PROXY_FLAGS_GET_INVALIDATED_PROPERTIES,
 				      NULL,
 				      FW_DBUS_NAME,
 				      FW_DBUS_PATH,
@@ -169,10 +342,20 @@ _fw_client_dbus_connect(FWClientPrivate *priv)
     g_signal_connect(priv->proxy,
 		     "g-signal",
 		     G_CALLBACK (_fw_client_signal_receiver),
-		     NULL);
+		     priv);
+
+    /* notify property changes */
+    g_signal_connect(priv->proxy,
+		     "g-properties-changed",
+		     G_CALLBACK (_fw_client_properties_changed),
+		     priv->obj);
+
+    /* the instance of firewalld the proxies are talking to */
+    g_free(priv->name_owner);
+    priv->name_owner = g_dbus_proxy_get_name_owner(priv->proxy);
 
     priv->zone_proxy = g_dbus_proxy_new_sync(priv->connection,
-					   G_DBUS_PROXY_FLAGS_NONE,
+					   G_DBUS_PROXY_FLAGS_DO_NOT_LOAD_PROPERTIES,
 					   NULL,
 					   FW_DBUS_NAME,
 					   FW_DBUS_PATH,
@@ -183,8 +366,14 @@ _fw_client_dbus_connect(FWClientPrivate *priv)
     g_assert(priv->zone_proxy != NULL);
     g_dbus_proxy_set_default_timeout(priv->zone_proxy, G_MAXINT);
 
+    /* added and removed signals of timed entries */
+    g_signal_connect(priv->zone_proxy,
+		     "g-signal",
+		     G_CALLBACK (_fw_client_zone_signal_receiver),
+		     priv);
+
     priv->ipset_proxy = g_dbus_proxy_new_sync(priv->connection,
-					    G_DBUS_PROXY_FLAGS_NONE,
+					    G_DBUS_PROXY_FLAGS_DO_NOT_LOAD_PROPERTIES,
 					    NULL,
 					    FW_DBUS_NAME,
 					    FW_DBUS_PATH,
@@ -196,7 +385,7 @@ _fw_client_dbus_connect(FWClientPrivate *priv)
     g_dbus_proxy_set_default_timeout(priv->ipset_proxy, G_MAXINT);
 
     priv->direct_proxy = g_dbus_proxy_new_sync(priv->connection,
-					     G_DBUS_PROXY_FLAGS_NONE,
+					     G_DBUS_PROXY_FLAGS_DO_NOT_LOAD_PROPERTIES,
 					     NULL,
 					     FW_DBUS_NAME,
 					     FW_DBUS_PATH,
@@ -208,7 +397,7 @@ _fw_client_dbus_connect(FWClientPrivate *priv)
     g_dbus_proxy_set_default_timeout(priv->direct_proxy, G_MAXINT);
 
     priv->policies_proxy = g_dbus_proxy_new_sync(priv->connection,
-					       G_DBUS_PROXY_FLAGS_NONE,
+					       G_DBUS_PROXY_FLAGS_DO_NOT_LOAD_PROPERTIES,
 					       NULL,
 					       FW_DBUS_NAME,
 					       FW_DBUS_PATH,
@@ -225,6 +414,123 @@ _fw_client_dbus_connect(FWClientPrivate *priv)
     g_dbus_connection_set_exit_on_close(priv->connection, FALSE);
 }
 
+static void
+_fw_client_dbus_disconnect(FWClientPrivate *priv)
+{
+    GDBusProxy **proxies[] = {
+	&priv->proxy, &priv->zone_proxy, &priv->ipset_proxy,
+	&priv->direct_proxy, &priv->policies_proxy,
+    };
+    guint i;
+
+    for (i = 0; i < G_N_ELEMENTS(proxies); i++) {
+	if (*proxies[i] == NULL)
+	    continue;
+	g_signal_handlers_disconnect_by_data(*proxies[i], priv);
+	g_signal_handlers_disconnect_by_data(*proxies[i], priv->obj);
+	g_clear_object(proxies[i]);
+    }
+
+    priv->connected = FALSE;
+}
+
+/* firewalld is gone, the runtime state went with it */
+static void
+_fw_client_lost(FWClientPrivate *priv)
+{
+    if (!priv->connected)
+	return;
+
+#ifdef FW_DEBUG
+    g_printerr("firewalld %s is gone\n", priv->name_owner);
+#endif
+
+    priv->connected = FALSE;
+    fw_expiration_tracker_clear(priv->expirations, FW_EXPIRATION_RELOADED);
+    _fw_client_reload_fail(priv);
+    g_object_notify(G_OBJECT(priv->obj), "connected");
+}
+
+static void _fw_client_replay(FWClientPrivate *priv);
+
+/* new proxies for the new instance of firewalld, then the intents */
+static void
+_fw_client_reconnect(FWClientPrivate *priv)
+{
+    _fw_client_dbus_disconnect(priv);
+    _fw_client_dbus_connect(priv);
+
+#ifdef FW_DEBUG
+    g_printerr("reconnected to firewalld %s\n", priv->name_owner);
+#endif
+
+    _fw_client_invalidate_caches(priv);
+
+    _fw_client_replay(priv);
+    g_object_notify(G_OBJECT(priv->obj), "connected");
+}
+
+static void
+_fw_client_name_owner_changed(GDBusConnection *connection,
+			      const gchar *sender_name,
+			      const gchar *object_path,
+			      const gchar *interface_name,
+			      const gchar *signal_name,
+			      GVariant *parameters,
+			      gpointer user_data)
+{
+    FWClientPrivate *priv = user_data;
+    const gchar *name, *old_owner, *new_owner;
+
+    g_variant_get(parameters, "(&s&s&s)", &name, &old_owner, &new_owner);
+
+    /* the owners are compared with the instance in use: a call might already
+       have reconnected before the signal got dispatched */
+    if (old_owner[0] != '\0' && g_strcmp0(old_owner, priv->name_owner) == 0)
+	_fw_client_lost(priv);
+    if (new_owner[0] != '\0' && g_strcmp0(new_owner, priv->name_owner) != 0)
+	_fw_client_reconnect(priv);
+}
+
+static gboolean
+_fw_client_name_has_owner(FWClientPrivate *priv)
+{
+    GVariant *result;
+    gboolean value = FALSE;
+
+    result = g_dbus_connection_call_sync(priv->connection,
+					 "org.freedesktop.DBus",
+					 "/org/freedesktop/DBus",
+					 "org.freedesktop.DBus",
+					 "NameHasOwner",
+					 g_variant_new("(s)", FW_DBUS_NAME),
+					 G_VARIANT_TYPE("(b)"),
+					 G_DBUS_CALL_FLAGS_NONE,
+					 -1, NULL, NULL);
+    if (result != NULL) {
+	g_variant_get(result, "(b)", &value);
+	g_variant_unref(result);
+    }
+
+    return value;
+}
+
+/* calls issued while firewalld is gone fail right away instead of waiting
+   for it to come back. The main context might not be running, therefore the
+   bus is asked once whether a new instance is there already. */
+static gboolean
+_fw_client_check_firewalld(FWClientPrivate *priv)
+{
+    if (priv->connected)
+	return TRUE;
+
+    if (!_fw_client_name_has_owner(priv))
+	return FALSE;
+
+    _fw_client_reconnect(priv);
+    return TRUE;
+}
+
 static void
 fw_client_finalize(GObject *obj)
 {
@@ -232,8 +538,23 @@ fw_client_finalize(GObject *obj)
 
     _fw_client_reset_error(priv);
 
+    if (priv->service_cache != NULL)
+	g_object_unref(priv->service_cache);
+    g_object_unref(priv->expirations);
+
     /* disconnect */
-    /***/
+    if (priv->owner_subscription > 0)
+	g_dbus_connection_signal_unsubscribe(priv->connection,
+					     priv->owner_subscription);
+    _fw_client_dbus_disconnect(priv);
+    g_free(priv->name_owner);
+    g_list_free_full(priv->intents, _fw_client_intent_free);
+
+    g_hash_table_destroy(priv->flights);
+    g_object_unref(priv->limiter);
+    g_queue_free(priv->pending_calls);
+    g_object_unref(priv->reload_histogram);
+    g_object_unref(priv->complete_reload_histogram);
 
     G_OBJECT_CLASS(fw_client_parent_class)->finalize(obj);
 }
@@ -267,17 +588,17 @@ fw_client_get_property(GObject *obj,
 		       GValue *value,
 		       GParamSpec *pspec)
 {
-#ifdef TODO
     FWClientPrivate *priv = FW_CLIENT_GET_PRIVATE(obj);
-#endif
+    GVariant *variant;
+    gchar *name;
 
     switch (property_id) {
 
-#ifdef TODO
     case PROP_CONNECTED:
-        /* connected */
+	g_value_set_boolean(value, priv->connected);
         break;
 
+#ifdef TODO
     case PROP_ERROR:
         /* error */
 	if (priv->error != NULL)
@@ -285,12 +606,52 @@ fw_client_get_property(GObject *obj,
         break;
 #endif
 
+    case PROP_VERSION:
+    case PROP_INTERFACE_VERSION:
+    case PROP_STATE:
+    case PROP_IPV4:
+    case PROP_IPV6:
+    case PROP_IPV6_RPFILTER:
+    case PROP_BRIDGE:
+    case PROP_IPSET:
+    case PROP_IPSETTYPES:
+    case PROP_NF_CONNTRACK_HELPER_SETTING:
+    case PROP_NF_CONNTRACK_HELPERS:
+    case PROP_IPV4_ICMPTYPES:
+    case PROP_IPV6_ICMPTYPES:
+	/* served from the property cache of the proxy, filled with GetAll
+	   and kept current with PropertiesChanged. The firewalld names use
+	   '_' instead of '-': IPv6_rpfilter for IPv6-rpfilter */
+	if (priv->proxy == NULL)
+	    break;
+	name = g_strdelimit(g_strdup(pspec->name), "-", '_');
+	variant = g_dbus_proxy_get_cached_property(priv->proxy, name);
+	g_free(name);
+	if (variant != NULL) {
+	    fw_variant_to_value(variant, value);
+	    g_variant_unref(variant);
+	}
+	break;
+
     default:
         G_OBJECT_WARN_INVALID_PROPERTY_ID(obj, property_id, pspec);
         break;
     }
 }
 
+static void
+_fw_client_properties_changed(GDBusProxy *proxy,
+			      GVariant *changed_properties,
+			      GStrv invalidated_properties,
+			      gpointer user_data)
+{
+    fw_notify_properties(user_data, changed_properties,
+			 (const gchar **) invalidated_properties);
+
+    /* an async reload might wait for state RUNNING */
+    _fw_client_reload_check(FW_CLIENT_GET_PRIVATE(user_data));
+}
+
 static void
 fw_client_class_init(FWClientClass *fw_client_class)
 {
@@ -303,6 +664,17 @@ fw_client_class_init(FWClientClass *fw_client_class)
 
     /* properties */
 
+    /**
+     * FWClient:connected:
+     *
+     * Whether firewalld is on the bus. Notified when firewalld went away
+     * and after the client reconnected to a restarted firewalld.
+     **/
+    g_object_class_install_property(
+	obj_class, PROP_CONNECTED,
+	g_param_spec_boolean("connected", "", "", FALSE,
+			     G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+
     /**
      * FWClient:version:
      *
@@ -344,6 +716,10 @@ fw_client_class_init(FWClientClass *fw_client_class)
 	obj_class, PROP_BRIDGE,
 	g_param_spec_boolean("BRIDGE", "", "", FALSE,
 			    G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+    g_object_class_install_property(
+	obj_class, PROP_IPSET,
+	g_param_spec_boolean("IPSet", "", "", FALSE,
+			     G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
     g_object_class_install_property(
 	obj_class, PROP_IPSETTYPES,
 	g_param_spec_boxed("IPSetTypes", "", "", G_TYPE_PTR_ARRAY,
@@ -360,14 +736,6 @@ fw_client_class_init(FWClientClass *fw_client_class)
      * initialize properties
      */
 /*
-    obj_properties[PROP_CONNECTED] = 
-        g_param_spec_string("connected",
-			    "connected",
-			    "Connected to firewalld?",
-			    "World",
-			    G_PARAM_READABLE |
-			    G_PARAM_CONSTRUCT);
-
     obj_properties[PROP_ERROR] = 
         g_param_spec_string("error",
 			    "error",
@@ -381,18 +749,92 @@ fw_client_class_init(FWClientClass *fw_client_class)
 				      obj_properties);
 */
     g_type_class_add_private(obj_class, sizeof(FWClientPrivate));
+    fw_accounting_register(obj_class, sizeof(FWClientPrivate));
 }
 
-GVariant *
-_fw_client_proxy_call_sync(FWClientPrivate *priv,
-			   GDBusProxy *proxy,
-			   const gchar *method_name,
-			   GVariant *parameters)
+static FWBatch *
+_fw_client_batch_new(FWClientPrivate *priv,
+		     FWLimiterPriority priority)
 {
-    GVariant *result;
+    FWBatch *batch = fw_batch_new(priv->connection);
+
+    /* the async calls of the client release their slots with replies that
+       are dispatched in this thread: a batch waiting for one would wait
+       forever, it is sent without admission then */
+    if (priv->calls_admitted == 0)
+	fw_batch_setLimiter(batch, priv->limiter, priority);
+
+    return batch;
+}
+
+/* runs the batch, reports every failed call, priv->error is the first */
+static gboolean
+_fw_client_batch_run(FWClientPrivate *priv,
+		     FWBatch *batch)
+{
+    gboolean ret;
+    guint i;
 
     _fw_client_reset_error(priv);
 
+    /* like the sync calls, fail right away while firewalld is gone */
+    if (!_fw_client_check_firewalld(priv)) {
+	g_set_error(&priv->error, G_DBUS_ERROR, G_DBUS_ERROR_SERVICE_UNKNOWN,
+		    "firewalld is not running");
+	g_print(_("ERROR: %s\n"), priv->error->message);
+	return FALSE;
+    }
+
+    ret = fw_batch_run(batch, &priv->error);
+    for (i = 0; i < fw_batch_getLength(batch); i++) {
+	const GError *error = fw_batch_getError(batch, i);
+
+	if (error != NULL)
+	    g_print(_("ERROR: %s\n"), error->message);
+    }
+
+    return ret;
+}
+
+/* proxy variable in priv, the proxies are replaced with a reconnect */
+static GDBusProxy **
+_fw_client_proxy_slot(FWClientPrivate *priv,
+		      GDBusProxy *proxy)
+{
+    GDBusProxy **proxies[] = {
+	&priv->proxy, &priv->zone_proxy, &priv->ipset_proxy,
+	&priv->direct_proxy, &priv->policies_proxy,
+    };
+    guint i;
+
+    for (i = 0; i < G_N_ELEMENTS(proxies); i++) {
+	if (*proxies[i] == proxy)
+	    return proxies[i];
+    }
+
+    return NULL;
+}
+
+static GVariant *
+_fw_client_proxy_call(FWClientPrivate *priv,
+		      GDBusProxy *proxy,
+		      const gchar *method_name,
+		      GVariant *parameters)
+{
+    GDBusProxy **slot = _fw_client_proxy_slot(priv, proxy);
+    GVariant *result;
+
+    if (!_fw_client_check_firewalld(priv)) {
+	g_set_error(&priv->error, G_DBUS_ERROR, G_DBUS_ERROR_SERVICE_UNKNOWN,
+		    "firewalld is not running");
+	return NULL;
+    }
+
+    /* the proxies are replaced with a reconnect, the call keeps its own */
+    if (slot != NULL)
+	proxy = *slot;
+    g_object_ref(proxy);
+
     result = g_dbus_proxy_call_sync(proxy,
 				    method_name,
 				    parameters,
@@ -400,6 +842,97 @@ _fw_client_proxy_call_sync(FWClientPrivate *priv,
 				    -1,
 				    NULL,
 				    &priv->error);
+
+    /* firewalld went away since the last call and the name owner change has
+       not been seen yet: the call failed with ServiceUnknown or
+       NameHasNoOwner. It did not reach firewalld, it is safe to issue it
+       again if a new instance is there already. */
+    if (priv->connected &&
+	(g_error_matches(priv->error, G_DBUS_ERROR,
+			 G_DBUS_ERROR_SERVICE_UNKNOWN) ||
+	 g_error_matches(priv->error, G_DBUS_ERROR,
+			 G_DBUS_ERROR_NAME_HAS_NO_OWNER))) {
+	_fw_client_lost(priv);
+	if (_fw_client_check_firewalld(priv) && slot != NULL) {
+	    _fw_client_reset_error(priv);
+	    g_object_unref(proxy);
+	    proxy = g_object_ref(*slot);
+	    result = g_dbus_proxy_call_sync(proxy,
+					    method_name,
+					    parameters,
+					    G_DBUS_CALL_FLAGS_NONE,
+					    -1,
+					    NULL,
+					    &priv->error);
+	}
+    }
+
+    g_object_unref(proxy);
+
+    return result;
+}
+
+/* the error of the call is kept in priv->error, a client is not thread safe
+   and is used from one thread at a time */
+GVariant *
+_fw_client_proxy_call_sync(FWClientPrivate *priv,
+			   GDBusProxy *proxy,
+			   const gchar *method_name,
+			   GVariant *parameters)
+{
+    gboolean read = fw_method_is_read(method_name);
+    gboolean admitted = FALSE;
+    GVariant *result;
+    gint64 sent;
+
+    _fw_client_reset_error(priv);
+
+    if (parameters != NULL)
+	g_variant_ref_sink(parameters);
+
+    FW_TRACE_CALL_START(method_name, FW_TRACE_PROXY_PATH(proxy), parameters);
+
+    /* mutating calls wait for admission, not to overrun firewalld. The
+       async calls of the client release their slots with replies that are
+       dispatched in this thread, waiting for them would never end: with
+       async calls admitted, the call goes out without a slot if there is
+       none left. */
+    if (!read && priv->calls_admitted > 0)
+	admitted = fw_limiter_tryAcquire(priv->limiter,
+					 FW_LIMITER_PRIORITY_NORMAL);
+    else if (!read) {
+	admitted = fw_limiter_acquire(priv->limiter,
+				      FW_LIMITER_PRIORITY_NORMAL);
+	if (!admitted) {
+	    g_set_error(&priv->error, G_DBUS_ERROR,
+			G_DBUS_ERROR_LIMITS_EXCEEDED,
+			"too many calls waiting for firewalld");
+	    result = NULL;
+	    goto out;
+	}
+    }
+
+    sent = g_get_monotonic_time();
+    result = _fw_client_proxy_call(priv, proxy, method_name, parameters);
+
+    /* the proxies do not time out, firewalld reports overload with a
+       limits exceeded error */
+    if (admitted)
+	fw_limiter_release(priv->limiter, g_get_monotonic_time() - sent,
+			   g_error_matches(priv->error, G_DBUS_ERROR,
+					   G_DBUS_ERROR_NO_REPLY) ||
+			   g_error_matches(priv->error, G_DBUS_ERROR,
+					   G_DBUS_ERROR_TIMED_OUT) ||
+			   g_error_matches(priv->error, G_DBUS_ERROR,
+					   G_DBUS_ERROR_LIMITS_EXCEEDED));
+
+out:
+    FW_TRACE_CALL_DONE(method_name, FW_TRACE_PROXY_PATH(proxy), result,
+		       priv->error);
+
+    if (parameters != NULL)
+	g_variant_unref(parameters);
+
     if (priv->error != NULL) {
         g_print(_("ERROR: %s failed: %s\n"), method_name, priv->error->message);
     }
@@ -407,11 +940,36 @@ _fw_client_proxy_call_sync(FWClientPrivate *priv,
     return result;
 }
 
+/* only for replies that are zone names: these are interned to keep the
+ * transfer none promise of the callers without leaking a string per call,
+ * the set of zone names is small. Other strings use the dup variant. */
 const gchar *
 _fw_client_proxy_call_sync_get_str(FWClientPrivate *priv,
 				   GDBusProxy *proxy,
 				   const gchar *method_name,
 				   GVariant *parameters)
+{
+    GVariant *variant;
+    const gchar *str;
+
+    variant = _fw_client_proxy_call_sync(priv, proxy, method_name, parameters);
+
+    if (priv->error != NULL) {
+	return NULL;
+    }
+
+    g_variant_get(variant, "(&s)", &str);
+    str = g_intern_string(str);
+    g_variant_unref(variant);
+
+    return str;
+}
+
+gchar *
+_fw_client_proxy_call_sync_dup_str(FWClientPrivate *priv,
+				   GDBusProxy *proxy,
+				   const gchar *method_name,
+				   GVariant *parameters)
 {
     GVariant *variant;
     gchar *str;
@@ -455,7 +1013,7 @@ _fw_client_proxy_call_sync_get_str_list(FWClientPrivate *priv,
 					const gchar *method_name,
 					GVariant *parameters)
 {
-    GVariant *variant, *element;
+    GVariant *variant, *reply, *element;
     GVariantIter iter;
     GList *list = NULL;
     gchar *str;
@@ -468,16 +1026,19 @@ _fw_client_proxy_call_sync_get_str_list(FWClientPrivate *priv,
 
     if (strncmp(g_variant_get_type_string(variant), "(as)", 4) != 0)
     {
+	g_variant_unref(variant);
 	return list;
     }
 
     /* get as from (as) */
-    variant = g_variant_get_child_value(variant, 0);
+    reply = variant;
+    variant = g_variant_get_child_value(reply, 0);
+    g_variant_unref(reply);
 
     if (g_variant_iter_init(&iter, variant)) {
 	while ((element = g_variant_iter_next_value(&iter)) != NULL) {
 	    g_variant_get(element, "s", &str);
-	    list = g_list_append(list, g_strdup(str));
+	    list = g_list_append(list, str);
 	    g_variant_unref(element);
 	}
     }
@@ -492,7 +1053,7 @@ _fw_client_proxy_call_sync_get_gint32_list(FWClientPrivate *priv,
 					   const gchar *method_name,
 					   GVariant *parameters)
 {
-    GVariant *variant, *element;
+    GVariant *variant, *reply, *element;
     GVariantIter iter;
     GList *list = NULL;
     gint32 *i;
@@ -505,11 +1066,14 @@ _fw_client_proxy_call_sync_get_gint32_list(FWClientPrivate *priv,
 
     if (strncmp(g_variant_get_type_string(variant), "(ai)", 4) != 0)
     {
+	g_variant_unref(variant);
 	return list;
     }
 
     /* get ai from (ai) */
-    variant = g_variant_get_child_value(variant, 0);
+    reply = variant;
+    variant = g_variant_get_child_value(reply, 0);
+    g_variant_unref(reply);
 
     if (g_variant_iter_init(&iter, variant)) {
 	while ((element = g_variant_iter_next_value(&iter)) != NULL) {
@@ -523,67 +1087,1188 @@ _fw_client_proxy_call_sync_get_gint32_list(FWClientPrivate *priv,
     return list;
 }
 
-/****************************************************************************/
-/****************************************************************************/
-/****************************************************************************/
-
-/* authorize all */
-
-void
-fw_client_authorizeAll(FWClient *obj)
+/* copies the (as) reply in one go, no list or per element variants */
+gchar **
+_fw_client_proxy_call_sync_get_strv(FWClientPrivate *priv,
+				    GDBusProxy *proxy,
+				    const gchar *method_name,
+				    GVariant *parameters)
 {
-    FWClientPrivate *priv = FW_CLIENT_GET_PRIVATE(obj);
+    GVariant *variant, *reply;
+    gchar **strv;
 
-    _fw_client_proxy_call_sync(priv, priv->proxy, "authorizeAll", NULL);
-}
+    variant = _fw_client_proxy_call_sync(priv, proxy, method_name, parameters);
 
-/* config */
+    if (priv->error != NULL) {
+	return NULL;
+    }
 
-/**
- * fw_client_config:
- *
- * Returns: (transfer none) (allow-none) (type FWConfig*)
- */
-FWConfig *
-fw_client_config(FWClient *obj)
-{
-    FWClientPrivate *priv = FW_CLIENT_GET_PRIVATE(obj);
+    if (strncmp(g_variant_get_type_string(variant), "(as)", 4) != 0)
+    {
+	g_variant_unref(variant);
+	return NULL;
+    }
 
-    if (priv->config == NULL)
-	priv->config = fw_config_new();
+    /* get as from (as) */
+    reply = variant;
+    variant = g_variant_get_child_value(reply, 0);
+    g_variant_unref(reply);
 
-    return priv->config;
-}
+    strv = g_variant_dup_strv(variant, NULL);
+    g_variant_unref(variant);
 
-/* reload */
+    return strv;
+}
 
-void
-fw_client_reload(FWClient *obj)
+/*
+ * packs (aas) port replies into the item strings of the expiration
+ * tracker: "port/protocol" for two fields, the forward port form for four
+ */
+static gchar **
+_fw_client_item_strv_new_from_variant(GVariant *variant,
+				      gsize n_fields)
 {
-    FWClientPrivate *priv = FW_CLIENT_GET_PRIVATE(obj);
+    GVariant *ports;
+    GVariantIter iter;
+    GPtrArray *array;
+    const gchar **strv;
 
-    _fw_client_proxy_call_sync(priv, priv->proxy, "reload", NULL);
+    if (strncmp(g_variant_get_type_string(variant), "(aas)", 5) != 0)
+	return NULL;
+
+    /* get aas from (aas) */
+    ports = g_variant_get_child_value(variant, 0);
+
+    array = g_ptr_array_new();
+    g_variant_iter_init(&iter, ports);
+    while (g_variant_iter_next(&iter, "^a&s", &strv)) {
+	if (g_strv_length((gchar **) strv) == n_fields) {
+	    if (n_fields == 2)
+		g_ptr_array_add(array,
+				fw_expiration_tracker_portItem(strv[0],
+							       strv[1]));
+	    else if (n_fields == 4)
+		g_ptr_array_add(array,
+				fw_expiration_tracker_forwardPortItem(
+				    strv[0], strv[1], strv[2], strv[3]));
+	}
+	g_free(strv);
+    }
+    g_ptr_array_add(array, NULL);
+    g_variant_unref(ports);
+
+    return (gchar **) g_ptr_array_free(array, FALSE);
 }
 
-void
-fw_client_completeReload(FWClient *obj)
+gchar **
+_fw_client_proxy_call_sync_get_item_strv(FWClientPrivate *priv,
+					 GDBusProxy *proxy,
+					 const gchar *method_name,
+					 GVariant *parameters,
+					 gsize n_fields)
 {
-    FWClientPrivate *priv = FW_CLIENT_GET_PRIVATE(obj);
+    GVariant *variant;
+    gchar **strv;
 
-    _fw_client_proxy_call_sync(priv, priv->proxy, "completeReload", NULL);
-}
+    variant = _fw_client_proxy_call_sync(priv, proxy, method_name, parameters);
 
-/* runtime to permanent */
+    if (priv->error != NULL) {
+	return NULL;
+    }
 
-void
-fw_client_runtimeToPermanent(FWClient *obj)
-{
-    FWClientPrivate *priv = FW_CLIENT_GET_PRIVATE(obj);
+    strv = _fw_client_item_strv_new_from_variant(variant, n_fields);
+    g_variant_unref(variant);
 
-    _fw_client_proxy_call_sync(priv, priv->proxy, "runtimeToPermanent", NULL);
+    return strv;
 }
 
-/* properties */
+/*
+ * async calls
+ *
+ * Many calls can be in flight on the connection of the client at the same
+ * time. Reads are sent right away, a read identical to one in flight gets
+ * the reply of that one instead of asking firewalld again. Reads that
+ * decode the reply do so once and share the result. The cancellable
+ * of a caller does not cancel a shared read. Mutating calls are
+ * admitted by the limiter like the sync ones and wait in line while it is
+ * full. The replies are dispatched in the main context of the caller, the
+ * async calls of a client have to be started from the same main context.
+ */
+
+static void _fw_client_call_drain(FWClientPrivate *priv);
+
+/* identical reads have the same key */
+static gchar *
+_fw_client_flight_key(GDBusProxy *proxy,
+		      const gchar *method_name,
+		      GVariant *parameters)
+{
+    gchar *args, *key;
+
+    args = (parameters != NULL) ? g_variant_print(parameters, TRUE) : NULL;
+    key = g_strdup_printf("%s.%s%s", g_dbus_proxy_get_interface_name(proxy),
+			  method_name, (args != NULL) ? args : "()");
+    g_free(args);
+
+    return key;
+}
+
+static void
+_fw_client_call_free(gpointer data)
+{
+    FWClientCall *call = data;
+
+    g_free(call->method_name);
+    if (call->parameters != NULL)
+	g_variant_unref(call->parameters);
+    g_free(call->key);
+    g_free(call->zone);
+    g_free(call->item);
+    g_free(call);
+}
+
+/* the reads that joined the read of the task get its result as well, the
+   reply or the decoded reply */
+static void
+_fw_client_call_share(FWClientPrivate *priv,
+		      GTask *task,
+		      gpointer result,
+		      const GError *error)
+{
+    FWClientCall *call = g_task_get_task_data(task);
+    GBoxedCopyFunc share = (GBoxedCopyFunc) g_variant_ref;
+    GDestroyNotify free_result = (GDestroyNotify) g_variant_unref;
+    GList *tasks, *list;
+
+    if (call->key == NULL)
+	return;
+
+    if (call->decode != NULL) {
+	share = call->share;
+	free_result = call->free_result;
+    }
+
+    tasks = g_hash_table_lookup(priv->flights, call->key);
+    g_hash_table_remove(priv->flights, call->key);
+
+    /* the first one is the task itself */
+    for (list = (tasks != NULL) ? tasks->next : NULL; list != NULL;
+	 list = list->next) {
+	if (error != NULL)
+	    g_task_return_error(list->data, g_error_copy(error));
+	else
+	    g_task_return_pointer(list->data,
+				  (result != NULL) ? share(result) : NULL,
+				  free_result);
+	g_object_unref(list->data);
+    }
+    g_list_free(tasks);
+}
+
+static void
+_fw_client_call_reply(GObject *source,
+		      GAsyncResult *res,
+		      gpointer user_data)
+{
+    GTask *task = user_data;
+    FWClientPrivate *priv = FW_CLIENT_GET_PRIVATE(g_task_get_source_object(task));
+    FWClientCall *call = g_task_get_task_data(task);
+    GError *error = NULL;
+    GVariant *result;
+
+    result = g_dbus_proxy_call_finish(G_DBUS_PROXY(source), res, &error);
+    priv->calls_in_flight--;
+
+    if (call->admitted) {
+	priv->calls_admitted--;
+	fw_limiter_release(priv->limiter, g_get_monotonic_time() - call->sent,
+			   g_error_matches(error, G_DBUS_ERROR,
+					   G_DBUS_ERROR_NO_REPLY) ||
+			   g_error_matches(error, G_DBUS_ERROR,
+					   G_DBUS_ERROR_TIMED_OUT) ||
+			   g_error_matches(error, G_DBUS_ERROR,
+					   G_DBUS_ERROR_LIMITS_EXCEEDED));
+	_fw_client_call_drain(priv);
+    }
+
+    if (result == NULL) {
+	_fw_client_call_share(priv, task, NULL, error);
+	g_task_return_error(task, error);
+	g_object_unref(task);
+	return;
+    }
+
+    if (call->type != NULL) {
+	if (call->added)
+	    fw_expiration_tracker_add(priv->expirations, call->zone,
+				      call->type, call->item, call->timeout);
+	else
+	    fw_expiration_tracker_remove(priv->expirations, call->zone,
+					 call->type, call->item);
+    }
+
+    if (call->decode != NULL) {
+	gpointer value = call->decode(result, &error);
+
+	g_variant_unref(result);
+	_fw_client_call_share(priv, task, value, error);
+	if (error != NULL)
+	    g_task_return_error(task, error);
+	else
+	    g_task_return_pointer(task, value, call->free_result);
+	g_object_unref(task);
+	return;
+    }
+
+    _fw_client_call_share(priv, task, result, NULL);
+    g_task_return_pointer(task, result, (GDestroyNotify) g_variant_unref);
+    g_object_unref(task);
+}
+
+static void
+_fw_client_call_send(GTask *task)
+{
+    FWClientPrivate *priv = FW_CLIENT_GET_PRIVATE(g_task_get_source_object(task));
+    FWClientCall *call = g_task_get_task_data(task);
+
+    /* like the sync calls, fail right away while firewalld is gone instead
+       of calling the stale proxies. The name owner change reconnects, the
+       main context of the async calls is running. */
+    if (!priv->connected || *call->slot == NULL) {
+	GError *error = g_error_new(G_DBUS_ERROR,
+				    G_DBUS_ERROR_SERVICE_UNKNOWN,
+				    "firewalld is not running");
+
+	if (call->admitted)
+	    fw_limiter_release(priv->limiter, 0, FALSE);
+	_fw_client_call_share(priv, task, NULL, error);
+	g_task_return_error(task, error);
+	g_object_unref(task);
+	return;
+    }
+
+    call->sent = g_get_monotonic_time();
+    priv->calls_in_flight++;
+    if (call->admitted)
+	priv->calls_admitted++;
+    g_dbus_proxy_call(*call->slot,
+		      call->method_name,
+		      call->parameters,
+		      G_DBUS_CALL_FLAGS_NONE,
+		      -1,
+		      (call->key == NULL) ? g_task_get_cancellable(task) : NULL,
+		      _fw_client_call_reply,
+		      task);
+}
+
+static gboolean
+_fw_client_call_retry(gpointer user_data)
+{
+    FWClientPrivate *priv = user_data;
+
+    g_source_unref(priv->pending_retry);
+    priv->pending_retry = NULL;
+    _fw_client_call_drain(priv);
+
+    return G_SOURCE_REMOVE;
+}
+
+/* sends the waiting calls the limiter admits now */
+static void
+_fw_client_call_drain(FWClientPrivate *priv)
+{
+    GTask *task;
+
+    while ((task = g_queue_peek_head(priv->pending_calls)) != NULL) {
+	FWClientCall *call = g_task_get_task_data(task);
+
+	if (!fw_limiter_tryAcquire(priv->limiter, FW_LIMITER_PRIORITY_NORMAL))
+	    break;
+	g_queue_pop_head(priv->pending_calls);
+	call->admitted = TRUE;
+	_fw_client_call_send(task);
+    }
+
+    if (task == NULL) {
+	if (priv->pending_retry != NULL) {
+	    g_source_destroy(priv->pending_retry);
+	    g_source_unref(priv->pending_retry);
+	    priv->pending_retry = NULL;
+	}
+	return;
+    }
+
+    /* the slots are held by sync calls or by batches sharing the limiter,
+       which release them without waking the queue. Only the replies of
+       admitted calls drain it, reads in flight do not: look again in a
+       while */
+    if (priv->calls_admitted == 0 && priv->pending_retry == NULL) {
+	priv->pending_retry = g_timeout_source_new(1);
+	g_source_set_callback(priv->pending_retry, _fw_client_call_retry,
+			      priv, NULL);
+	g_source_attach(priv->pending_retry, g_task_get_context(task));
+    }
+}
+
+static void
+_fw_client_call_async(FWClientPrivate *priv,
+		      GTask *task,
+		      GDBusProxy *proxy,
+		      const gchar *method_name,
+		      GVariant *parameters)
+{
+    FWClientCall *call = g_task_get_task_data(task);
+
+    call->slot = _fw_client_proxy_slot(priv, proxy);
+    call->method_name = g_strdup(method_name);
+    if (parameters != NULL)
+	call->parameters = g_variant_ref_sink(parameters);
+
+    if (fw_method_is_read(method_name)) {
+	GList *tasks;
+
+	call->key = _fw_client_flight_key(proxy, method_name,
+					  call->parameters);
+	tasks = g_hash_table_lookup(priv->flights, call->key);
+	if (tasks != NULL) {
+	    /* identical read in flight, wait for its reply */
+	    tasks = g_list_append(tasks, task);
+	    priv->coalesced++;
+	    return;
+	}
+	g_hash_table_insert(priv->flights, g_strdup(call->key),
+			    g_list_append(NULL, task));
+	_fw_client_call_send(task);
+	return;
+    }
+
+    /* mutating calls keep their order */
+    if (g_queue_is_empty(priv->pending_calls) &&
+	fw_limiter_tryAcquire(priv->limiter, FW_LIMITER_PRIORITY_NORMAL)) {
+	call->admitted = TRUE;
+	_fw_client_call_send(task);
+	return;
+    }
+
+    if (g_queue_get_length(priv->pending_calls) >=
+	fw_limiter_getQueueLength(priv->limiter)) {
+	g_task_return_new_error(task, G_DBUS_ERROR,
+				G_DBUS_ERROR_LIMITS_EXCEEDED,
+				"too many calls waiting for firewalld");
+	g_object_unref(task);
+	return;
+    }
+
+    g_queue_push_tail(priv->pending_calls, task);
+    _fw_client_call_drain(priv);
+}
+
+static GTask *
+_fw_client_call_new(FWClient *obj,
+		    GCancellable *cancellable,
+		    GAsyncReadyCallback callback,
+		    gpointer user_data)
+{
+    GTask *task;
+
+    task = g_task_new(obj, cancellable, callback, user_data);
+    g_task_set_task_data(task, g_new0(FWClientCall, 1), _fw_client_call_free);
+
+    return task;
+}
+
+/* decodes the reply of a read once, callers that join the read get a
+   reference to the decoded result */
+static void
+_fw_client_call_set_decode(GTask *task,
+			   FWClientDecodeFunc decode,
+			   GBoxedCopyFunc share,
+			   GDestroyNotify free_result)
+{
+    FWClientCall *call = g_task_get_task_data(task);
+
+    call->decode = decode;
+    call->share = share;
+    call->free_result = free_result;
+}
+
+/* records the expiration of an add or remove call once it succeeded */
+static void
+_fw_client_call_set_expiration(GTask *task,
+			       const gchar *zone,
+			       const gchar *type,
+			       gchar *item,
+			       gboolean added,
+			       gint32 timeout)
+{
+    FWClientCall *call = g_task_get_task_data(task);
+
+    call->type = type;
+    call->zone = g_strdup(zone);
+    call->item = item;
+    call->added = added;
+    call->timeout = timeout;
+}
+
+static GVariant *
+_fw_client_call_finish(FWClient *obj,
+		       GAsyncResult *result,
+		       const gchar *type,
+		       GError **error)
+{
+    GVariant *variant;
+
+    g_return_val_if_fail(g_task_is_valid(result, obj), NULL);
+
+    variant = g_task_propagate_pointer(G_TASK(result), error);
+    if (variant == NULL)
+	return NULL;
+
+    if (!g_variant_is_of_type(variant, G_VARIANT_TYPE(type))) {
+	g_set_error(error, G_DBUS_ERROR, G_DBUS_ERROR_INVALID_SIGNATURE,
+		    "unexpected reply of type %s",
+		    g_variant_get_type_string(variant));
+	g_variant_unref(variant);
+	return NULL;
+    }
+
+    return variant;
+}
+
+static gpointer
+_fw_client_call_finish_decoded(FWClient *obj,
+			       GAsyncResult *result,
+			       GError **error)
+{
+    g_return_val_if_fail(g_task_is_valid(result, obj), NULL);
+
+    return g_task_propagate_pointer(G_TASK(result), error);
+}
+
+static void
+_fw_client_decode_error(GVariant *variant,
+			GError **error)
+{
+    g_set_error(error, G_DBUS_ERROR, G_DBUS_ERROR_INVALID_SIGNATURE,
+		"unexpected reply of type %s",
+		g_variant_get_type_string(variant));
+}
+
+static const gchar *
+_fw_client_call_finish_str(FWClient *obj,
+			   GAsyncResult *result,
+			   GError **error)
+{
+    GVariant *variant;
+    const gchar *str;
+
+    variant = _fw_client_call_finish(obj, result, "(s)", error);
+    if (variant == NULL)
+	return NULL;
+
+    g_variant_get(variant, "(&s)", &str);
+    str = g_intern_string(str);
+    g_variant_unref(variant);
+
+    return str;
+}
+
+static gboolean
+_fw_client_call_finish_bool(FWClient *obj,
+			    GAsyncResult *result,
+			    GError **error)
+{
+    GVariant *variant;
+    gboolean value;
+
+    variant = _fw_client_call_finish(obj, result, "(b)", error);
+    if (variant == NULL)
+	return FALSE;
+
+    g_variant_get(variant, "(b)", &value);
+    g_variant_unref(variant);
+
+    return value;
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
+
+/* authorize all */
+
+void
+fw_client_authorizeAll(FWClient *obj)
+{
+    FWClientPrivate *priv = FW_CLIENT_GET_PRIVATE(obj);
+
+    _fw_client_proxy_call_sync(priv, priv->proxy, "authorizeAll", NULL);
+}
+
+/* config */
+
+/**
+ * fw_client_config:
+ *
+ * Returns: (transfer none) (allow-none) (type FWConfig*)
+ */
+FWConfig *
+fw_client_config(FWClient *obj)
+{
+    FWClientPrivate *priv = FW_CLIENT_GET_PRIVATE(obj);
+
+    if (priv->config == NULL)
+	priv->config = fw_config_new();
+
+    return priv->config;
+}
+
+/**
+ * fw_client_getConnection:
+ *
+ * Returns: (transfer none) (allow-none) (type GDBusConnection*)
+ */
+GDBusConnection *
+fw_client_getConnection(FWClient *obj)
+{
+    FWClientPrivate *priv = FW_CLIENT_GET_PRIVATE(obj);
+
+    return priv->connection;
+}
+
+/* reconnect */
+
+/* replays the intents in one batch on the current instance of firewalld */
+static void
+_fw_client_replay(FWClientPrivate *priv)
+{
+    FWBatch *batch;
+    GList *list;
+
+    if (priv->intents == NULL)
+	return;
+
+    batch = _fw_client_batch_new(priv, FW_LIMITER_PRIORITY_HIGH);
+    for (list = priv->intents; list != NULL; list = list->next) {
+	FWClientIntent *intent = list->data;
+
+	fw_batch_add(batch, FW_DBUS_PATH, intent->interface,
+		     intent->method_name, intent->parameters);
+    }
+    _fw_client_batch_run(priv, batch);
+    g_object_unref(batch);
+}
+
+/**
+ * fw_client_isConnected:
+ *
+ * Returns: FALSE after firewalld went away until the client has been
+ * reconnected to a restarted firewalld
+ */
+gboolean
+fw_client_isConnected(FWClient *obj)
+{
+    FWClientPrivate *priv = FW_CLIENT_GET_PRIVATE(obj);
+
+    return priv->connected;
+}
+
+/**
+ * fw_client_addRuntimeIntent:
+ * @interface: firewalld interface of the method, for example
+ *   FW_DBUS_INTERFACE_ZONE
+ * @method_name: method of the interface
+ * @parameters: (allow-none): parameters of the call
+ *
+ * Registers a call that re-creates runtime state, for example a port
+ * binding with "addPort" or a passthrough with "addPassthrough". The
+ * intents are not called here, they are replayed in one batch after the
+ * client reconnected to a restarted firewalld.
+ *
+ * Returns: id of the intent for fw_client_removeRuntimeIntent
+ */
+guint
+fw_client_addRuntimeIntent(FWClient *obj,
+			   const gchar *interface,
+			   const gchar *method_name,
+			   GVariant *parameters)
+{
+    FWClientPrivate *priv = FW_CLIENT_GET_PRIVATE(obj);
+    FWClientIntent *intent;
+
+    intent = g_new0(FWClientIntent, 1);
+    intent->id = ++priv->last_intent;
+    intent->interface = g_strdup(interface);
+    intent->method_name = g_strdup(method_name);
+    if (parameters != NULL)
+	intent->parameters = g_variant_ref_sink(parameters);
+
+    priv->intents = g_list_append(priv->intents, intent);
+
+    return intent->id;
+}
+
+gboolean
+fw_client_removeRuntimeIntent(FWClient *obj,
+			      guint id)
+{
+    FWClientPrivate *priv = FW_CLIENT_GET_PRIVATE(obj);
+    GList *list;
+
+    for (list = priv->intents; list != NULL; list = list->next) {
+	FWClientIntent *intent = list->data;
+
+	if (intent->id == id) {
+	    _fw_client_intent_free(intent);
+	    priv->intents = g_list_delete_link(priv->intents, list);
+	    return TRUE;
+	}
+    }
+
+    return FALSE;
+}
+
+void
+fw_client_clearRuntimeIntents(FWClient *obj)
+{
+    FWClientPrivate *priv = FW_CLIENT_GET_PRIVATE(obj);
+
+    g_list_free_full(priv->intents, _fw_client_intent_free);
+    priv->intents = NULL;
+}
+
+/**
+ * fw_client_replayRuntimeIntents:
+ *
+ * Replays the intents right away, for example after a complete reload.
+ *
+ * Returns: TRUE if all intents have been applied
+ */
+gboolean
+fw_client_replayRuntimeIntents(FWClient *obj)
+{
+    FWClientPrivate *priv = FW_CLIENT_GET_PRIVATE(obj);
+
+    _fw_client_reset_error(priv);
+    _fw_client_replay(priv);
+
+    return priv->error == NULL;
+}
+
+/* admission control */
+
+/**
+ * fw_client_getLimiter:
+ *
+ * Admission control of the mutating calls of the client. The limiter can
+ * be configured and holds the stats, it can also be shared with own
+ * batches with fw_batch_setLimiter.
+ *
+ * Returns: (transfer none) (type FWLimiter*)
+ */
+FWLimiter *
+fw_client_getLimiter(FWClient *obj)
+{
+    FWClientPrivate *priv = FW_CLIENT_GET_PRIVATE(obj);
+
+    return priv->limiter;
+}
+
+/* coalesced calls */
+
+/**
+ * fw_client_getCoalescedCalls:
+ *
+ * Returns: number of async reads that have been answered with the reply of
+ * an identical async read already in flight
+ */
+guint64
+fw_client_getCoalescedCalls(FWClient *obj)
+{
+    FWClientPrivate *priv = FW_CLIENT_GET_PRIVATE(obj);
+
+    return priv->coalesced;
+}
+
+/* reload */
+
+void
+fw_client_reload(FWClient *obj)
+{
+    FWClientPrivate *priv = FW_CLIENT_GET_PRIVATE(obj);
+    gint64 start = g_get_monotonic_time();
+
+    _fw_client_proxy_call_sync(priv, priv->proxy, "reload", NULL);
+    if (priv->error == NULL) {
+	_fw_client_invalidate_caches(priv);
+	fw_histogram_add(priv->reload_histogram,
+			 g_get_monotonic_time() - start);
+    }
+}
+
+void
+fw_client_completeReload(FWClient *obj)
+{
+    FWClientPrivate *priv = FW_CLIENT_GET_PRIVATE(obj);
+    gint64 start = g_get_monotonic_time();
+
+    _fw_client_proxy_call_sync(priv, priv->proxy, "completeReload", NULL);
+    if (priv->error == NULL) {
+	_fw_client_invalidate_caches(priv);
+	fw_histogram_add(priv->complete_reload_histogram,
+			 g_get_monotonic_time() - start);
+    }
+}
+
+/* completes an async reload in the list of the client */
+static void
+_fw_client_reload_done(FWClientPrivate *priv,
+		       GTask *task,
+		       GError *error)
+{
+    FWClientReload *reload = g_task_get_task_data(task);
+
+    priv->reload_tasks = g_list_remove(priv->reload_tasks, task);
+    if (reload->cancel_source != NULL) {
+	g_source_destroy(reload->cancel_source);
+	g_source_unref(reload->cancel_source);
+	reload->cancel_source = NULL;
+    }
+
+    if (error != NULL) {
+	g_task_return_error(task, error);
+    } else {
+	fw_histogram_add(reload->complete ? priv->complete_reload_histogram :
+			 priv->reload_histogram,
+			 g_get_monotonic_time() - reload->start);
+	g_task_return_boolean(task, TRUE);
+    }
+    g_object_unref(task);
+}
+
+/* fails all async reloads, firewalld went away */
+static void
+_fw_client_reload_fail(FWClientPrivate *priv)
+{
+    while (priv->reload_tasks != NULL)
+	_fw_client_reload_done(priv, priv->reload_tasks->data,
+			       g_error_new(G_DBUS_ERROR,
+					   G_DBUS_ERROR_SERVICE_UNKNOWN,
+					   "firewalld went away during the reload"));
+}
+
+/* completes the async reloads that are done */
+static void
+_fw_client_reload_check(FWClientPrivate *priv)
+{
+    GList *list, *next;
+    GVariant *state;
+    gboolean running, failed;
+
+    if (priv->reload_tasks == NULL || priv->proxy == NULL)
+	return;
+
+    state = g_dbus_proxy_get_cached_property(priv->proxy, "state");
+    running = (state == NULL ||
+	       g_strcmp0(g_variant_get_string(state, NULL), "RUNNING") == 0);
+    failed = (state != NULL &&
+	      g_strcmp0(g_variant_get_string(state, NULL), "FAILED") == 0);
+    if (state != NULL)
+	g_variant_unref(state);
+    if (!running && !failed)
+	return;
+
+    for (list = priv->reload_tasks; list != NULL; list = next) {
+	GTask *task = list->data;
+	FWClientReload *reload = g_task_get_task_data(task);
+
+	next = list->next;
+	if (!reload->replied)
+	    continue;
+
+	/* firewalld does not send Reloaded when the reload failed */
+	if (failed)
+	    _fw_client_reload_done(priv, task,
+				   g_error_new(G_IO_ERROR, G_IO_ERROR_FAILED,
+					       "firewalld failed to reload"));
+	else if (priv->reloads > reload->reloads)
+	    _fw_client_reload_done(priv, task, NULL);
+    }
+}
+
+static gboolean
+_fw_client_reload_cancelled(GCancellable *cancellable,
+			    gpointer user_data)
+{
+    GTask *task = user_data;
+    FWClientPrivate *priv = FW_CLIENT_GET_PRIVATE(g_task_get_source_object(task));
+
+    _fw_client_reload_done(priv, task,
+			   g_error_new(G_IO_ERROR, G_IO_ERROR_CANCELLED,
+				       "Operation was cancelled"));
+
+    return G_SOURCE_REMOVE;
+}
+
+static void
+_fw_client_reload_free(gpointer data)
+{
+    FWClientReload *reload = data;
+
+    if (reload->cancel_source != NULL) {
+	g_source_destroy(reload->cancel_source);
+	g_source_unref(reload->cancel_source);
+    }
+    g_free(reload);
+}
+
+static void
+_fw_client_reload_reply(GObject *source,
+			GAsyncResult *res,
+			gpointer user_data)
+{
+    GTask *task = user_data;
+    FWClientPrivate *priv = FW_CLIENT_GET_PRIVATE(g_task_get_source_object(task));
+    FWClientReload *reload = g_task_get_task_data(task);
+    GError *error = NULL;
+    GVariant *result;
+
+    result = g_dbus_proxy_call_finish(G_DBUS_PROXY(source), res, &error);
+
+    /* completed already: cancelled or firewalld went away */
+    if (g_list_find(priv->reload_tasks, task) == NULL) {
+	if (result != NULL)
+	    g_variant_unref(result);
+	g_clear_error(&error);
+	g_object_unref(task);
+	return;
+    }
+
+    if (result == NULL) {
+	_fw_client_reload_done(priv, task, error);
+	g_object_unref(task);
+	return;
+    }
+    g_variant_unref(result);
+
+    reload->replied = TRUE;
+    _fw_client_invalidate_caches(priv);
+    _fw_client_reload_check(priv);
+    g_object_unref(task);
+}
+
+static void
+_fw_client_reload_async(FWClient *obj,
+			gboolean complete,
+			GCancellable *cancellable,
+			GAsyncReadyCallback callback,
+			gpointer user_data)
+{
+    FWClientPrivate *priv = FW_CLIENT_GET_PRIVATE(obj);
+    FWClientReload *reload;
+    GTask *task;
+
+    task = g_task_new(obj, cancellable, callback, user_data);
+    if (priv->proxy == NULL) {
+	g_task_return_new_error(task, G_DBUS_ERROR,
+				G_DBUS_ERROR_SERVICE_UNKNOWN,
+				"firewalld is not running");
+	g_object_unref(task);
+	return;
+    }
+
+    reload = g_new0(FWClientReload, 1);
+    reload->complete = complete;
+    reload->reloads = priv->reloads;
+    reload->start = g_get_monotonic_time();
+    reload->replied = FALSE;
+
+    /* the reply might be in already, stop waiting for the signals */
+    if (cancellable != NULL) {
+	reload->cancel_source = g_cancellable_source_new(cancellable);
+	g_source_set_callback(reload->cancel_source,
+			      (GSourceFunc) _fw_client_reload_cancelled,
+			      task, NULL);
+	g_source_attach(reload->cancel_source, g_task_get_context(task));
+    }
+
+    g_task_set_task_data(task, reload, _fw_client_reload_free);
+    priv->reload_tasks = g_list_append(priv->reload_tasks, task);
+
+    /* the list and the call hold a reference each */
+    g_dbus_proxy_call(priv->proxy,
+		      complete ? "completeReload" : "reload",
+		      NULL,
+		      G_DBUS_CALL_FLAGS_NONE,
+		      -1,
+		      cancellable,
+		      _fw_client_reload_reply,
+		      g_object_ref(task));
+}
+
+/**
+ * fw_client_reloadAsync: (finish-func reloadFinish)
+ * @cancellable: (allow-none): cancels the call, not the reload itself
+ * @callback: (scope async): called when the firewall is consistent again
+ * @user_data: (closure): data for @callback
+ *
+ * Starts a reload of firewalld and returns right away. The reload is done
+ * with the reply, the Reloaded signal and the state back to RUNNING, the
+ * signals are dispatched in the main context of the client. It fails if
+ * firewalld ends the reload in state FAILED or goes away before, and with
+ * G_IO_ERROR_CANCELLED once @cancellable is cancelled.
+ */
+void
+fw_client_reloadAsync(FWClient *obj,
+		      GCancellable *cancellable,
+		      GAsyncReadyCallback callback,
+		      gpointer user_data)
+{
+    _fw_client_reload_async(obj, FALSE, cancellable, callback, user_data);
+}
+
+/**
+ * fw_client_reloadFinish:
+ * @result: the result passed to the callback
+ * @error: (allow-none): return location for an error
+ *
+ * Returns: TRUE if the reload succeeded
+ */
+gboolean
+fw_client_reloadFinish(FWClient *obj,
+		       GAsyncResult *result,
+		       GError **error)
+{
+    g_return_val_if_fail(g_task_is_valid(result, obj), FALSE);
+
+    return g_task_propagate_boolean(G_TASK(result), error);
+}
+
+/**
+ * fw_client_completeReloadAsync: (finish-func completeReloadFinish)
+ * @cancellable: (allow-none): cancels the call, not the reload itself
+ * @callback: (scope async): called when the firewall is consistent again
+ * @user_data: (closure): data for @callback
+ *
+ * Like fw_client_reloadAsync with a complete reload.
+ */
+void
+fw_client_completeReloadAsync(FWClient *obj,
+			      GCancellable *cancellable,
+			      GAsyncReadyCallback callback,
+			      gpointer user_data)
+{
+    _fw_client_reload_async(obj, TRUE, cancellable, callback, user_data);
+}
+
+gboolean
+fw_client_completeReloadFinish(FWClient *obj,
+			       GAsyncResult *result,
+			       GError **error)
+{
+    g_return_val_if_fail(g_task_is_valid(result, obj), FALSE);
+
+    return g_task_propagate_boolean(G_TASK(result), error);
+}
+
+/**
+ * fw_client_getReloadHistogram:
+ *
+ * Durations of the reloads of this client in us, until the firewall has
+ * been consistent again for async reloads.
+ *
+ * Returns: (transfer none) (type FWHistogram*)
+ */
+FWHistogram *
+fw_client_getReloadHistogram(FWClient *obj)
+{
+    FWClientPrivate *priv = FW_CLIENT_GET_PRIVATE(obj);
+
+    return priv->reload_histogram;
+}
+
+/**
+ * fw_client_getCompleteReloadHistogram:
+ *
+ * Returns: (transfer none) (type FWHistogram*)
+ */
+FWHistogram *
+fw_client_getCompleteReloadHistogram(FWClient *obj)
+{
+    FWClientPrivate *priv = FW_CLIENT_GET_PRIVATE(obj);
+
+    return priv->complete_reload_histogram;
+}
+
+/* runtime to permanent */
+
+void
+fw_client_runtimeToPermanent(FWClient *obj)
+{
+    FWClientPrivate *priv = FW_CLIENT_GET_PRIVATE(obj);
+
+    _fw_client_proxy_call_sync(priv, priv->proxy, "runtimeToPermanent", NULL);
+}
+
+/* names of the zones in the (as) result of the batch call */
+static GHashTable *
+_fw_client_batch_names(FWBatch *batch,
+		       guint index,
+		       GHashTable *names)
+{
+    GVariant *result = fw_batch_getResult(batch, index);
+    GVariantIter *iter;
+    gchar *name;
+
+    if (result == NULL)
+	return names;
+
+    g_variant_get(result, "(as)", &iter);
+    while (g_variant_iter_next(iter, "s", &name))
+	g_hash_table_add(names, name);
+    g_variant_iter_free(iter);
+
+    return names;
+}
+
+/**
+ * fw_client_diffRuntimePermanent:
+ * @obj: (type FWClient*): a FWClient instance
+ *
+ * Compares the runtime and the permanent settings of all zones that exist
+ * in both configurations. The settings are fetched in three pipelined
+ * batches: zone names, runtime settings with the permanent zone paths and
+ * permanent settings. Use this to review the changes before
+ * fw_client_runtimeToPermanent or to apply only some of them with
+ * fw_client_applyRuntimeDiff.
+ *
+ * Returns: (transfer full) (allow-none) (type FWRuntimeDiff*)
+ */
+FWRuntimeDiff *
+fw_client_diffRuntimePermanent(FWClient *obj)
+{
+    FWClientPrivate *priv = FW_CLIENT_GET_PRIVATE(obj);
+    FWRuntimeDiff *diff = NULL;
+    FWBatch *batch;
+    GHashTable *runtime_names, *permanent_names;
+    GHashTableIter iter;
+    GPtrArray *zones, *runtime, *paths;
+    gpointer key;
+    guint i;
+
+#ifdef FW_DEBUG
+    g_printerr("fw_client_diffRuntimePermanent()\n");
+#endif
+
+    /* zone names of both sides */
+    batch = _fw_client_batch_new(priv, FW_LIMITER_PRIORITY_NORMAL);
+    fw_batch_add(batch, FW_DBUS_PATH, FW_DBUS_INTERFACE_ZONE, "getZones",
+		 NULL);
+    fw_batch_add(batch, FW_DBUS_PATH_CONFIG, FW_DBUS_INTERFACE_CONFIG,
+		 "getZoneNames", NULL);
+    if (!_fw_client_batch_run(priv, batch)) {
+	g_object_unref(batch);
+	return NULL;
+    }
+
+    runtime_names = _fw_client_batch_names(
+	batch, 0, g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL));
+    permanent_names = _fw_client_batch_names(
+	batch, 1, g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL));
+    g_object_unref(batch);
+
+    zones = g_ptr_array_new();
+    g_hash_table_iter_init(&iter, runtime_names);
+    while (g_hash_table_iter_next(&iter, &key, NULL)) {
+	if (g_hash_table_contains(permanent_names, key))
+	    g_ptr_array_add(zones, key);
+    }
+
+    /* runtime settings and permanent zone paths */
+    batch = _fw_client_batch_new(priv, FW_LIMITER_PRIORITY_NORMAL);
+    for (i = 0; i < zones->len; i++) {
+	fw_batch_add(batch, FW_DBUS_PATH, FW_DBUS_INTERFACE, "getZoneSettings",
+		     g_variant_new("(s)", g_ptr_array_index(zones, i)));
+	fw_batch_add(batch, FW_DBUS_PATH_CONFIG, FW_DBUS_INTERFACE_CONFIG,
+		     "getZoneByName",
+		     g_variant_new("(s)", g_ptr_array_index(zones, i)));
+    }
+    if (!_fw_client_batch_run(priv, batch))
+	goto out;
+
+    runtime = g_ptr_array_new_with_free_func((GDestroyNotify) g_variant_unref);
+    paths = g_ptr_array_new_with_free_func(g_free);
+    for (i = 0; i < zones->len; i++) {
+	gchar *path;
+
+	g_ptr_array_add(runtime, g_variant_get_child_value(
+			    fw_batch_getResult(batch, 2 * i), 0));
+	g_variant_get(fw_batch_getResult(batch, 2 * i + 1), "(o)", &path);
+	g_ptr_array_add(paths, path);
+    }
+    g_object_unref(batch);
+
+    /* permanent settings */
+    batch = _fw_client_batch_new(priv, FW_LIMITER_PRIORITY_NORMAL);
+    for (i = 0; i < zones->len; i++)
+	fw_batch_add(batch, g_ptr_array_index(paths, i),
+		     FW_DBUS_INTERFACE_CONFIG_ZONE, "getSettings", NULL);
+    if (_fw_client_batch_run(priv, batch)) {
+	diff = fw_runtime_diff_new();
+	for (i = 0; i < zones->len; i++) {
+	    GVariant *permanent = g_variant_get_child_value(
+		fw_batch_getResult(batch, i), 0);
+
+	    fw_runtime_diff_addZone(diff, g_ptr_array_index(zones, i),
+				    g_ptr_array_index(paths, i),
+				    g_ptr_array_index(runtime, i), permanent);
+	    g_variant_unref(permanent);
+	}
+    }
+
+    g_ptr_array_unref(runtime);
+    g_ptr_array_unref(paths);
+
+out:
+    g_object_unref(batch);
+    g_ptr_array_unref(zones);
+    g_hash_table_destroy(runtime_names);
+    g_hash_table_destroy(permanent_names);
+
+    return diff;
+}
+
+/**
+ * fw_client_applyRuntimeDiff:
+ * @obj: (type FWClient*): a FWClient instance
+ * @diff: (type FWRuntimeDiff*): diff of fw_client_diffRuntimePermanent
+ * @hunks: (element-type FWDiffHunk*) (allow-none): hunks of @diff to
+ *   apply, NULL for all
+ *
+ * Takes the runtime state of the selected hunks into the permanent
+ * configuration. The calls are pipelined, failed calls are reported and
+ * do not stop the others.
+ *
+ * Returns: (type gboolean): TRUE if all calls succeeded
+ */
+gboolean
+fw_client_applyRuntimeDiff(FWClient *obj,
+			   FWRuntimeDiff *diff,
+			   GList *hunks)
+{
+    FWClientPrivate *priv = FW_CLIENT_GET_PRIVATE(obj);
+    FWBatch *batch;
+    gboolean ret;
+
+    batch = _fw_client_batch_new(priv, FW_LIMITER_PRIORITY_NORMAL);
+    fw_runtime_diff_queueApply(diff, hunks, batch);
+    ret = _fw_client_batch_run(priv, batch);
+    g_object_unref(batch);
+
+    return ret;
+}
+
+/* properties */
 
 /* panic mode */
 
@@ -640,6 +2325,61 @@ fw_client_getZoneSettings(FWClient *obj,
     return zne;
 }
 
+static gpointer
+_fw_client_decode_zone(GVariant *variant,
+		       GError **error)
+{
+    FWZone *zone = fw_zone_new_from_variant(variant);
+
+    if (zone == NULL)
+	_fw_client_decode_error(variant, error);
+
+    return zone;
+}
+
+/**
+ * fw_client_getZoneSettingsAsync: (finish-func getZoneSettingsFinish)
+ * @obj: (type FWClient*): a FWClient instance
+ * @zone: (type gchar*)
+ * @cancellable: (allow-none)
+ * @callback: (scope async): called with the reply
+ * @user_data: (closure): data for @callback
+ */
+void
+fw_client_getZoneSettingsAsync(FWClient *obj,
+			       const gchar *zone,
+			       GCancellable *cancellable,
+			       GAsyncReadyCallback callback,
+			       gpointer user_data)
+{
+    FWClientPrivate *priv = FW_CLIENT_GET_PRIVATE(obj);
+    GTask *task;
+
+    task = _fw_client_call_new(obj, cancellable, callback, user_data);
+    _fw_client_call_set_decode(task, _fw_client_decode_zone,
+			       g_object_ref, g_object_unref);
+    _fw_client_call_async(priv, task, priv->proxy, "getZoneSettings",
+			  g_variant_new("(s)", zone));
+}
+
+/**
+ * fw_client_getZoneSettingsFinish:
+ * @result: the result passed to the callback
+ * @error: (allow-none): return location for an error
+ *
+ * The zone is shared with the other callers of an identical read, copy it
+ * before changing it.
+ *
+ * Returns: (transfer full) (allow-none) (type FWZone*)
+ */
+FWZone *
+fw_client_getZoneSettingsFinish(FWClient *obj,
+				GAsyncResult *result,
+				GError **error)
+{
+    return _fw_client_call_finish_decoded(obj, result, error);
+}
+
 /**
  * fw_client_listServices:
  *
@@ -654,6 +2394,23 @@ fw_client_listServices(FWClient *obj)
 						   "listServices", NULL);
 }
 
+/**
+ * fw_client_listServicesStrv:
+ * @obj: (type FWClient*): a FWClient instance
+ *
+ * Same as fw_client_listServices, but as a single string array.
+ *
+ * Returns: (transfer full) (allow-none) (array zero-terminated=1)
+ */
+gchar **
+fw_client_listServicesStrv(FWClient *obj)
+{
+    FWClientPrivate *priv = FW_CLIENT_GET_PRIVATE(obj);
+
+    return _fw_client_proxy_call_sync_get_strv(priv, priv->proxy,
+					       "listServices", NULL);
+}
+
 /**
  * fw_client_getServiceSettings:
  *
@@ -680,6 +2437,129 @@ fw_client_getServiceSettings(FWClient *obj,
     return srvc;
 }
 
+/* effective settings of zones, with the services expanded */
+
+/**
+ * fw_client_getServiceCache:
+ * @obj: (type FWClient*): a FWClient instance
+ *
+ * Returns: (transfer none) (type FWServiceCache*): service definitions
+ *   shared by all zones, invalidated on reload
+ */
+FWServiceCache *
+fw_client_getServiceCache(FWClient *obj)
+{
+    FWClientPrivate *priv = FW_CLIENT_GET_PRIVATE(obj);
+
+    if (priv->service_cache == NULL)
+	priv->service_cache = fw_service_cache_new(priv->connection);
+
+    return priv->service_cache;
+}
+
+/**
+ * fw_client_getEffectivePorts:
+ * @obj: (type FWClient*): a FWClient instance
+ * @zone: (type utf8): zone name
+ *
+ * Ports opened by the zone, the ports of the zone and of all of its
+ * services, normalized per protocol with merged port ranges.
+ *
+ * Returns: (transfer full) (allow-none) (type FWPortList*)
+ */
+FWPortList *
+fw_client_getEffectivePorts(FWClient *obj,
+			    const gchar *zone)
+{
+    FWZone *settings;
+    FWPortList *ports;
+
+    settings = fw_client_getZoneSettings(obj, zone);
+    if (settings == NULL)
+	return NULL;
+
+    ports = fw_service_cache_getEffectivePorts(fw_client_getServiceCache(obj),
+					       zone, settings);
+    g_object_unref(settings);
+
+    return ports;
+}
+
+/**
+ * fw_client_getEffectiveSourcePorts:
+ * @obj: (type FWClient*): a FWClient instance
+ * @zone: (type utf8): zone name
+ *
+ * Returns: (transfer full) (allow-none) (type FWPortList*)
+ */
+FWPortList *
+fw_client_getEffectiveSourcePorts(FWClient *obj,
+				  const gchar *zone)
+{
+    FWZone *settings;
+    FWPortList *ports;
+
+    settings = fw_client_getZoneSettings(obj, zone);
+    if (settings == NULL)
+	return NULL;
+
+    ports = fw_service_cache_getEffectiveSourcePorts(
+	fw_client_getServiceCache(obj), zone, settings);
+    g_object_unref(settings);
+
+    return ports;
+}
+
+/**
+ * fw_client_getEffectiveProtocols:
+ * @obj: (type FWClient*): a FWClient instance
+ * @zone: (type utf8): zone name
+ *
+ * Returns: (transfer full) (allow-none) (element-type utf8)
+ */
+GList *
+fw_client_getEffectiveProtocols(FWClient *obj,
+				const gchar *zone)
+{
+    FWZone *settings;
+    GList *protocols;
+
+    settings = fw_client_getZoneSettings(obj, zone);
+    if (settings == NULL)
+	return NULL;
+
+    protocols = fw_service_cache_getEffectiveProtocols(
+	fw_client_getServiceCache(obj), zone, settings);
+    g_object_unref(settings);
+
+    return protocols;
+}
+
+/**
+ * fw_client_getEffectiveModules:
+ * @obj: (type FWClient*): a FWClient instance
+ * @zone: (type utf8): zone name
+ *
+ * Returns: (transfer full) (allow-none) (element-type utf8)
+ */
+GList *
+fw_client_getEffectiveModules(FWClient *obj,
+			      const gchar *zone)
+{
+    FWZone *settings;
+    GList *modules;
+
+    settings = fw_client_getZoneSettings(obj, zone);
+    if (settings == NULL)
+	return NULL;
+
+    modules = fw_service_cache_getEffectiveModules(
+	fw_client_getServiceCache(obj), zone, settings);
+    g_object_unref(settings);
+
+    return modules;
+}
+
 /**
  * fw_client_listIPSets:
  *
@@ -764,6 +2644,54 @@ fw_client_getIcmpTypeSettings(FWClient *obj,
     return icmp;
 }
 
+/**
+ * fw_client_getIcmpCatalogue:
+ * @obj: (type FWClient*): a FWClient instance
+ *
+ * Gets the names of all icmptypes and then their settings in one
+ * pipelined batch, for local icmp block checks with bitsets.
+ *
+ * Returns: (transfer full) (allow-none) (type FWIcmpCatalogue*)
+ */
+FWIcmpCatalogue *
+fw_client_getIcmpCatalogue(FWClient *obj)
+{
+    FWClientPrivate *priv = FW_CLIENT_GET_PRIVATE(obj);
+    FWIcmpCatalogue *catalogue = NULL;
+    FWBatch *batch;
+    GList *names, *list;
+    guint i;
+
+#ifdef FW_DEBUG
+    g_printerr("fw_client_getIcmpCatalogue()\n");
+#endif
+
+    names = fw_client_listIcmpTypes(obj);
+    if (priv->error != NULL)
+	return NULL;
+
+    batch = _fw_client_batch_new(priv, FW_LIMITER_PRIORITY_NORMAL);
+    for (list = names; list != NULL; list = list->next)
+	fw_batch_add(batch, FW_DBUS_PATH, FW_DBUS_INTERFACE,
+		     "getIcmpTypeSettings", g_variant_new("(s)", list->data));
+
+    if (_fw_client_batch_run(priv, batch)) {
+	catalogue = fw_icmp_catalogue_new();
+	for (list = names, i = 0; list != NULL; list = list->next, i++) {
+	    FWIcmpType *icmptype = fw_icmptype_new_from_variant(
+		fw_batch_getResult(batch, i));
+
+	    fw_icmp_catalogue_addIcmpType(catalogue, list->data, icmptype);
+	    g_object_unref(icmptype);
+	}
+    }
+
+    g_object_unref(batch);
+    fw_str_list_free(names);
+
+    return catalogue;
+}
+
 /**
  * fw_client_listHelpers:
  *
@@ -804,6 +2732,47 @@ fw_client_getHelperSettings(FWClient *obj,
     return hlpr;
 }
 
+/* timed runtime entries */
+
+/**
+ * fw_client_setExpirationFunc:
+ * @obj: (type FWClient*): a FWClient instance
+ * @func: (scope notified) (allow-none): called on the main context of the
+ *   client when a timed runtime entry has been removed, has timed out or
+ *   has been dropped by a reload
+ * @user_data: (allow-none): user data for func
+ * @destroy: (allow-none): destroys user_data
+ */
+void
+fw_client_setExpirationFunc(FWClient *obj,
+			    FWExpirationFunc func,
+			    gpointer user_data,
+			    GDestroyNotify destroy)
+{
+    FWClientPrivate *priv = FW_CLIENT_GET_PRIVATE(obj);
+
+    fw_expiration_tracker_setFunc(priv->expirations, func, user_data,
+				  destroy);
+}
+
+/**
+ * fw_client_getPendingExpirations:
+ * @obj: (type FWClient*): a FWClient instance
+ *
+ * Timed runtime entries added with this client or announced by added
+ * signals that have not ended yet.
+ *
+ * Returns: (transfer full) (allow-none) (element-type FWExpiration*): sorted
+ *   by deadline
+ */
+GList *
+fw_client_getPendingExpirations(FWClient *obj)
+{
+    FWClientPrivate *priv = FW_CLIENT_GET_PRIVATE(obj);
+
+    return fw_expiration_tracker_getPending(priv->expirations);
+}
+
 /* default zone */
 
 const gchar*
@@ -840,6 +2809,23 @@ fw_client_getZones(FWClient *obj)
 						   "getZones", NULL);
 }
 
+/**
+ * fw_client_getZonesStrv:
+ * @obj: (type FWClient*): a FWClient instance
+ *
+ * Same as fw_client_getZones, but as a single string array.
+ *
+ * Returns: (transfer full) (allow-none) (array zero-terminated=1)
+ */
+gchar **
+fw_client_getZonesStrv(FWClient *obj)
+{
+    FWClientPrivate *priv = FW_CLIENT_GET_PRIVATE(obj);
+
+    return _fw_client_proxy_call_sync_get_strv(priv, priv->zone_proxy,
+					       "getZones", NULL);
+}
+
 /**
  * fw_client_getActiveZones:
  * @obj: (type FWClient*): a FWClient instance
@@ -853,74 +2839,73 @@ fw_client_getActiveZones(FWClient *obj)
 {
     FWClientPrivate *priv = FW_CLIENT_GET_PRIVATE(obj);
     GVariant *variant;
-    GVariantIter *iter1, *iter2, *iter3;
-    GHashTable *active_zones = NULL;
-    const gchar *zone_key;
-    GVariant *key;
-    GVariant *entry;
+    GHashTable *active_zones;
 
     variant = _fw_client_proxy_call_sync(priv, priv->zone_proxy, "getActiveZones",
 					 NULL);
 
     if (priv->error != NULL) {
-	return active_zones;
+	return NULL;
     }
 
-    /* create active_zone return hash table */
-    active_zones = g_hash_table_new_full(g_str_hash, g_str_equal,
-					 g_free, g_object_unref);
-
-    /* get a{sa{sas}} from (a{sa{sas}}) */
-    variant = g_variant_get_child_value(variant, 0);
-
-    g_variant_get(variant, "a{sa{sas}}", &iter1);
-    while ((entry = g_variant_iter_next_value(iter1))) {
-	GVariant *value, *value2;
-	GVariant *entry2;
-	FWActiveZone *active_zone = fw_active_zone_new();
-
-	key = g_variant_get_child_value(entry, 0);
-	zone_key = g_variant_get_string(key, NULL);
-	g_variant_unref(key);
-
-	value = g_variant_get_child_value(entry, 1);
-	g_variant_unref(entry);
-
-	g_variant_get(value, "a{sas}", &iter2);
-	while ((entry2 = g_variant_iter_next_value(iter2))) {
-	    GList *list = NULL;
-	    const gchar *entry_key;
-	    gchar *str;
-
-	    key = g_variant_get_child_value(entry2, 0);
-	    entry_key = g_variant_get_string(key, NULL);
-	    g_variant_unref(key);
-
-	    value2 = g_variant_get_child_value(entry2, 1);
-	    g_variant_unref(entry2);
+    active_zones = fw_active_zone_table_new_from_variant(variant);
+    g_variant_unref(variant);
 
-	    g_variant_get(value2, "as", &iter3);
-	    while (g_variant_iter_loop(iter3, "s", &str)) {
-		list = g_list_append(list, g_strdup(str));
-	    }
+    return active_zones;
+}
 
-	    if (strncmp(entry_key, "interfaces", 10) == 0) {
-		fw_active_zone_setInterfaces(active_zone, list);
-	    }
-	    if (strncmp(entry_key, "sources", 7) == 0) {
-	        fw_active_zone_setSources(active_zone, list);
-	    }
+static gpointer
+_fw_client_decode_active_zones(GVariant *variant,
+			       GError **error)
+{
+    GHashTable *active_zones = fw_active_zone_table_new_from_variant(variant);
 
-	    g_variant_unref(value2);
-	}
+    if (active_zones == NULL)
+	_fw_client_decode_error(variant, error);
 
-	g_hash_table_insert(active_zones, (gchar *) zone_key,
-			    (gpointer)active_zone);
-    }
+    return active_zones;
+}
 
-    g_variant_unref(variant);
+/**
+ * fw_client_getActiveZonesAsync: (finish-func getActiveZonesFinish)
+ * @obj: (type FWClient*): a FWClient instance
+ * @cancellable: (allow-none)
+ * @callback: (scope async): called with the reply
+ * @user_data: (closure): data for @callback
+ */
+void
+fw_client_getActiveZonesAsync(FWClient *obj,
+			      GCancellable *cancellable,
+			      GAsyncReadyCallback callback,
+			      gpointer user_data)
+{
+    FWClientPrivate *priv = FW_CLIENT_GET_PRIVATE(obj);
+    GTask *task;
+
+    task = _fw_client_call_new(obj, cancellable, callback, user_data);
+    _fw_client_call_set_decode(task, _fw_client_decode_active_zones,
+			       (GBoxedCopyFunc) g_hash_table_ref,
+			       (GDestroyNotify) g_hash_table_unref);
+    _fw_client_call_async(priv, task, priv->zone_proxy, "getActiveZones",
+			  NULL);
+}
 
-    return active_zones;
+/**
+ * fw_client_getActiveZonesFinish:
+ * @result: the result passed to the callback
+ * @error: (allow-none): return location for an error
+ *
+ * The table is shared with the other callers of an identical read, it must
+ * not be changed.
+ *
+ * Returns: (transfer full) (allow-none) (element-type gchar* FWActiveZone*)
+ */
+GHashTable *
+fw_client_getActiveZonesFinish(FWClient *obj,
+			       GAsyncResult *result,
+			       GError **error)
+{
+    return _fw_client_call_finish_decoded(obj, result, error);
 }
 
 /**
@@ -1057,6 +3042,26 @@ fw_client_getInterfaces(FWClient *obj,
 						   g_variant_new("(s)", zone));
 }
 
+/**
+ * fw_client_getInterfacesStrv:
+ * @obj: (type FWClient*): a FWClient instance
+ * @zone: (type gchar*)
+ *
+ * Same as fw_client_getInterfaces, but as a single string array.
+ *
+ * Returns: (transfer full) (allow-none) (array zero-terminated=1)
+ */
+gchar **
+fw_client_getInterfacesStrv(FWClient *obj,
+			    const gchar *zone)
+{
+    FWClientPrivate *priv = FW_CLIENT_GET_PRIVATE(obj);
+
+    return _fw_client_proxy_call_sync_get_strv(priv, priv->zone_proxy,
+					       "getInterfaces",
+					       g_variant_new("(s)", zone));
+}
+
 /* sources */
 
 /**
@@ -1146,9 +3151,29 @@ fw_client_getSources(FWClient *obj,
 {
     FWClientPrivate *priv = FW_CLIENT_GET_PRIVATE(obj);
 
-    return _fw_client_proxy_call_sync_get_str_list(priv, priv->zone_proxy,
-						   "getSources",
-						   g_variant_new("(s)", zone));
+    return _fw_client_proxy_call_sync_get_str_list(priv, priv->zone_proxy,
+						   "getSources",
+						   g_variant_new("(s)", zone));
+}
+
+/**
+ * fw_client_getSourcesStrv:
+ * @obj: (type FWClient*): a FWClient instance
+ * @zone: (type gchar*)
+ *
+ * Same as fw_client_getSources, but as a single string array.
+ *
+ * Returns: (transfer full) (allow-none) (array zero-terminated=1)
+ */
+gchar **
+fw_client_getSourcesStrv(FWClient *obj,
+			 const gchar *zone)
+{
+    FWClientPrivate *priv = FW_CLIENT_GET_PRIVATE(obj);
+
+    return _fw_client_proxy_call_sync_get_strv(priv, priv->zone_proxy,
+					       "getSources",
+					       g_variant_new("(s)", zone));
 }
 
 /* rich rules */
@@ -1160,11 +3185,18 @@ fw_client_addRichRule(FWClient *obj,
 		      gint32 timeout)
 {
     FWClientPrivate *priv = FW_CLIENT_GET_PRIVATE(obj);
+    const gchar *result;
 
-    return _fw_client_proxy_call_sync_get_str(priv, priv->zone_proxy,
-					      "addRichRule",
-					      g_variant_new("(ssi)", zone,
-							    rule, timeout));
+    result = _fw_client_proxy_call_sync_get_str(priv, priv->zone_proxy,
+						"addRichRule",
+						g_variant_new("(ssi)", zone,
+							      rule, timeout));
+
+    if (priv->error == NULL)
+	fw_expiration_tracker_add(priv->expirations, zone,
+				  "rich-rule", rule, timeout);
+
+    return result;
 }
 
 gboolean
@@ -1186,11 +3218,18 @@ fw_client_removeRichRule(FWClient *obj,
 			 const gchar *rule)
 {
     FWClientPrivate *priv = FW_CLIENT_GET_PRIVATE(obj);
+    const gchar *result;
 
-    return _fw_client_proxy_call_sync_get_str(priv, priv->zone_proxy,
-					      "removeRichRule",
-					      g_variant_new("(ss)", zone,
-							    rule));
+    result = _fw_client_proxy_call_sync_get_str(priv, priv->zone_proxy,
+						"removeRichRule",
+						g_variant_new("(ss)", zone,
+							      rule));
+
+    if (priv->error == NULL)
+	fw_expiration_tracker_remove(priv->expirations, zone,
+				     "rich-rule", rule);
+
+    return result;
 }
 
 /**
@@ -1209,6 +3248,26 @@ fw_client_getRichRules(FWClient *obj,
 						   g_variant_new("(s)", zone));
 }
 
+/**
+ * fw_client_getRichRulesStrv:
+ * @obj: (type FWClient*): a FWClient instance
+ * @zone: (type gchar*)
+ *
+ * Same as fw_client_getRichRules, but as a single string array.
+ *
+ * Returns: (transfer full) (allow-none) (array zero-terminated=1)
+ */
+gchar **
+fw_client_getRichRulesStrv(FWClient *obj,
+			   const gchar *zone)
+{
+    FWClientPrivate *priv = FW_CLIENT_GET_PRIVATE(obj);
+
+    return _fw_client_proxy_call_sync_get_strv(priv, priv->zone_proxy,
+					       "getRichRules",
+					       g_variant_new("(s)", zone));
+}
+
 /* services */
 
 const gchar *
@@ -1218,11 +3277,18 @@ fw_client_addService(FWClient *obj,
 		     gint32 timeout)
 {
     FWClientPrivate *priv = FW_CLIENT_GET_PRIVATE(obj);
+    const gchar *result;
 
-    return _fw_client_proxy_call_sync_get_str(priv, priv->zone_proxy,
-					      "addService",
-					      g_variant_new("(ssi)", zone,
-							    service, timeout));
+    result = _fw_client_proxy_call_sync_get_str(priv, priv->zone_proxy,
+						"addService",
+						g_variant_new("(ssi)", zone,
+							      service, timeout));
+
+    if (priv->error == NULL)
+	fw_expiration_tracker_add(priv->expirations, zone,
+				  "service", service, timeout);
+
+    return result;
 }
 
 gboolean
@@ -1244,11 +3310,18 @@ fw_client_removeService(FWClient *obj,
 			const gchar *service)
 {
     FWClientPrivate *priv = FW_CLIENT_GET_PRIVATE(obj);
+    const gchar *result;
 
-    return _fw_client_proxy_call_sync_get_str(priv, priv->zone_proxy,
-					      "removeService",
-					      g_variant_new("(ss)", zone,
-							    service));
+    result = _fw_client_proxy_call_sync_get_str(priv, priv->zone_proxy,
+						"removeService",
+						g_variant_new("(ss)", zone,
+							      service));
+
+    if (priv->error == NULL)
+	fw_expiration_tracker_remove(priv->expirations, zone,
+				     "service", service);
+
+    return result;
 }
 
 /**
@@ -1267,6 +3340,202 @@ fw_client_getServices(FWClient *obj,
 						   g_variant_new("(s)", zone));
 }
 
+/**
+ * fw_client_getServicesStrv:
+ * @obj: (type FWClient*): a FWClient instance
+ * @zone: (type gchar*)
+ *
+ * Same as fw_client_getServices, but as a single string array.
+ *
+ * Returns: (transfer full) (allow-none) (array zero-terminated=1)
+ */
+gchar **
+fw_client_getServicesStrv(FWClient *obj,
+			  const gchar *zone)
+{
+    FWClientPrivate *priv = FW_CLIENT_GET_PRIVATE(obj);
+
+    return _fw_client_proxy_call_sync_get_strv(priv, priv->zone_proxy,
+					       "getServices",
+					       g_variant_new("(s)", zone));
+}
+
+/**
+ * fw_client_addServiceAsync: (finish-func addServiceFinish)
+ * @obj: (type FWClient*): a FWClient instance
+ * @zone: (type gchar*)
+ * @service: (type gchar*)
+ * @timeout: (type gint32)
+ * @cancellable: (allow-none)
+ * @callback: (scope async): called with the reply
+ * @user_data: (closure): data for @callback
+ *
+ * Async version of fw_client_addService, see fw_client_addServiceFinish.
+ */
+void
+fw_client_addServiceAsync(FWClient *obj,
+			  const gchar *zone,
+			  const gchar *service,
+			  gint32 timeout,
+			  GCancellable *cancellable,
+			  GAsyncReadyCallback callback,
+			  gpointer user_data)
+{
+    FWClientPrivate *priv = FW_CLIENT_GET_PRIVATE(obj);
+    GTask *task;
+
+    task = _fw_client_call_new(obj, cancellable, callback, user_data);
+    _fw_client_call_set_expiration(task, zone, "service", g_strdup(service),
+				   TRUE, timeout);
+    _fw_client_call_async(priv, task, priv->zone_proxy, "addService",
+			  g_variant_new("(ssi)", zone, service, timeout));
+}
+
+/**
+ * fw_client_addServiceFinish:
+ * @result: the result passed to the callback
+ * @error: (allow-none): return location for an error
+ *
+ * Returns: (transfer none) (allow-none): the zone or NULL with @error set
+ */
+const gchar *
+fw_client_addServiceFinish(FWClient *obj,
+			   GAsyncResult *result,
+			   GError **error)
+{
+    return _fw_client_call_finish_str(obj, result, error);
+}
+
+/**
+ * fw_client_queryServiceAsync: (finish-func queryServiceFinish)
+ * @obj: (type FWClient*): a FWClient instance
+ * @zone: (type gchar*)
+ * @service: (type gchar*)
+ * @cancellable: (allow-none)
+ * @callback: (scope async): called with the reply
+ * @user_data: (closure): data for @callback
+ */
+void
+fw_client_queryServiceAsync(FWClient *obj,
+			    const gchar *zone,
+			    const gchar *service,
+			    GCancellable *cancellable,
+			    GAsyncReadyCallback callback,
+			    gpointer user_data)
+{
+    FWClientPrivate *priv = FW_CLIENT_GET_PRIVATE(obj);
+
+    _fw_client_call_async(priv,
+			  _fw_client_call_new(obj, cancellable, callback,
+					      user_data),
+			  priv->zone_proxy, "queryService",
+			  g_variant_new("(ss)", zone, service));
+}
+
+/**
+ * fw_client_queryServiceFinish:
+ * @result: the result passed to the callback
+ * @error: (allow-none): return location for an error
+ */
+gboolean
+fw_client_queryServiceFinish(FWClient *obj,
+			     GAsyncResult *result,
+			     GError **error)
+{
+    return _fw_client_call_finish_bool(obj, result, error);
+}
+
+/**
+ * fw_client_removeServiceAsync: (finish-func removeServiceFinish)
+ * @obj: (type FWClient*): a FWClient instance
+ * @zone: (type gchar*)
+ * @service: (type gchar*)
+ * @cancellable: (allow-none)
+ * @callback: (scope async): called with the reply
+ * @user_data: (closure): data for @callback
+ */
+void
+fw_client_removeServiceAsync(FWClient *obj,
+			     const gchar *zone,
+			     const gchar *service,
+			     GCancellable *cancellable,
+			     GAsyncReadyCallback callback,
+			     gpointer user_data)
+{
+    FWClientPrivate *priv = FW_CLIENT_GET_PRIVATE(obj);
+    GTask *task;
+
+    task = _fw_client_call_new(obj, cancellable, callback, user_data);
+    _fw_client_call_set_expiration(task, zone, "service", g_strdup(service),
+				   FALSE, 0);
+    _fw_client_call_async(priv, task, priv->zone_proxy, "removeService",
+			  g_variant_new("(ss)", zone, service));
+}
+
+/**
+ * fw_client_removeServiceFinish:
+ * @result: the result passed to the callback
+ * @error: (allow-none): return location for an error
+ *
+ * Returns: (transfer none) (allow-none): the zone or NULL with @error set
+ */
+const gchar *
+fw_client_removeServiceFinish(FWClient *obj,
+			      GAsyncResult *result,
+			      GError **error)
+{
+    return _fw_client_call_finish_str(obj, result, error);
+}
+
+/**
+ * fw_client_getServicesStrvAsync: (finish-func getServicesStrvFinish)
+ * @obj: (type FWClient*): a FWClient instance
+ * @zone: (type gchar*)
+ * @cancellable: (allow-none)
+ * @callback: (scope async): called with the reply
+ * @user_data: (closure): data for @callback
+ */
+void
+fw_client_getServicesStrvAsync(FWClient *obj,
+			       const gchar *zone,
+			       GCancellable *cancellable,
+			       GAsyncReadyCallback callback,
+			       gpointer user_data)
+{
+    FWClientPrivate *priv = FW_CLIENT_GET_PRIVATE(obj);
+
+    _fw_client_call_async(priv,
+			  _fw_client_call_new(obj, cancellable, callback,
+					      user_data),
+			  priv->zone_proxy, "getServices",
+			  g_variant_new("(s)", zone));
+}
+
+/**
+ * fw_client_getServicesStrvFinish:
+ * @result: the result passed to the callback
+ * @error: (allow-none): return location for an error
+ *
+ * Returns: (transfer full) (allow-none) (array zero-terminated=1)
+ */
+gchar **
+fw_client_getServicesStrvFinish(FWClient *obj,
+				GAsyncResult *result,
+				GError **error)
+{
+    GVariant *variant;
+    gchar **strv;
+
+    variant = _fw_client_call_finish(obj, result, "(as)", error);
+    if (variant == NULL)
+	return NULL;
+
+    g_variant_get(variant, "(^as)", &strv);
+    g_variant_unref(variant);
+
+    return strv;
+}
+
 /* ports */
 
 const gchar *
@@ -1277,12 +3546,23 @@ fw_client_addPort(FWClient *obj,
 		  gint32 timeout)
 {
     FWClientPrivate *priv = FW_CLIENT_GET_PRIVATE(obj);
+    const gchar *result;
+    gchar *item;
+
+    result = _fw_client_proxy_call_sync_get_str(priv, priv->zone_proxy,
+						"addPort",
+						g_variant_new("(sssi)", zone,
+							      port, protocol,
+							      timeout));
+
+    if (priv->error == NULL) {
+	item = fw_expiration_tracker_portItem(port, protocol);
+	fw_expiration_tracker_add(priv->expirations, zone,
+				  "port", item, timeout);
+	g_free(item);
+    }
 
-    return _fw_client_proxy_call_sync_get_str(priv, priv->zone_proxy,
-					      "addPort",
-					      g_variant_new("(sssi)", zone,
-							    port, protocol,
-							    timeout));
+    return result;
 }
 
 gboolean
@@ -1306,11 +3586,22 @@ fw_client_removePort(FWClient *obj,
 		     const gchar *protocol)
 {
     FWClientPrivate *priv = FW_CLIENT_GET_PRIVATE(obj);
+    const gchar *result;
+    gchar *item;
+
+    result = _fw_client_proxy_call_sync_get_str(priv, priv->zone_proxy,
+						"removePort",
+						g_variant_new("(sss)", zone,
+							      port, protocol));
+
+    if (priv->error == NULL) {
+	item = fw_expiration_tracker_portItem(port, protocol);
+	fw_expiration_tracker_remove(priv->expirations, zone,
+				     "port", item);
+	g_free(item);
+    }
 
-    return _fw_client_proxy_call_sync_get_str(priv, priv->zone_proxy,
-					      "removePort",
-					      g_variant_new("(sss)", zone,
-							    port, protocol));
+    return result;
 }
 
 /**
@@ -1323,7 +3614,7 @@ fw_client_getPorts(FWClient *obj,
 		   const gchar *zone)
 {
     FWClientPrivate *priv = FW_CLIENT_GET_PRIVATE(obj);
-    GVariant *variant;
+    GVariant *variant, *reply;
     GVariantIter iter;
     GList *list = NULL;
 
@@ -1336,11 +3627,14 @@ fw_client_getPorts(FWClient *obj,
     }
 
     if (strncmp(g_variant_get_type_string(variant), "(aas)", 5) != 0) {
+	g_variant_unref(variant);
 	return list;
     }
 
     /* get aas from (aas) */
-    variant = g_variant_get_child_value(variant, 0);
+    reply = variant;
+    variant = g_variant_get_child_value(reply, 0);
+    g_variant_unref(reply);
 
     if (g_variant_iter_init(&iter, variant)) {
 	GVariant *element;
@@ -1350,8 +3644,8 @@ fw_client_getPorts(FWClient *obj,
 	    const gchar **strv = g_variant_get_strv(element, &length);
 
 	    if (length == 2) {
-		list = g_list_append(list, fw_port_new(g_strdup(strv[0]),
-						       g_strdup(strv[1])));
+		list = g_list_append(list, fw_port_new((gchar *) strv[0],
+						       (gchar *) strv[1]));
 
 	    }
 	    g_free(strv);
@@ -1364,6 +3658,216 @@ fw_client_getPorts(FWClient *obj,
     return list;
 }
 
+/**
+ * fw_client_getPortsStrv:
+ * @obj: (type FWClient*): a FWClient instance
+ * @zone: (type gchar*)
+ *
+ * Same as fw_client_getPorts, but as a single string array with
+ * "port/protocol" entries.
+ *
+ * Returns: (transfer full) (allow-none) (array zero-terminated=1)
+ */
+gchar **
+fw_client_getPortsStrv(FWClient *obj,
+		       const gchar *zone)
+{
+    FWClientPrivate *priv = FW_CLIENT_GET_PRIVATE(obj);
+
+    return _fw_client_proxy_call_sync_get_item_strv(priv, priv->zone_proxy,
+						    "getPorts",
+						    g_variant_new("(s)", zone),
+						    2);
+}
+
+/**
+ * fw_client_addPortAsync: (finish-func addPortFinish)
+ * @obj: (type FWClient*): a FWClient instance
+ * @zone: (type gchar*)
+ * @port: (type gchar*)
+ * @protocol: (type gchar*)
+ * @timeout: (type gint32)
+ * @cancellable: (allow-none)
+ * @callback: (scope async): called with the reply
+ * @user_data: (closure): data for @callback
+ *
+ * Async version of fw_client_addPort, see fw_client_addPortFinish.
+ */
+void
+fw_client_addPortAsync(FWClient *obj,
+		       const gchar *zone,
+		       const gchar *port,
+		       const gchar *protocol,
+		       gint32 timeout,
+		       GCancellable *cancellable,
+		       GAsyncReadyCallback callback,
+		       gpointer user_data)
+{
+    FWClientPrivate *priv = FW_CLIENT_GET_PRIVATE(obj);
+    GTask *task;
+
+    task = _fw_client_call_new(obj, cancellable, callback, user_data);
+    _fw_client_call_set_expiration(task, zone, "port",
+				   fw_expiration_tracker_portItem(port,
+								  protocol),
+				   TRUE, timeout);
+    _fw_client_call_async(priv, task, priv->zone_proxy, "addPort",
+			  g_variant_new("(sssi)", zone, port, protocol,
+					timeout));
+}
+
+/**
+ * fw_client_addPortFinish:
+ * @result: the result passed to the callback
+ * @error: (allow-none): return location for an error
+ *
+ * Returns: (transfer none) (allow-none): the zone or NULL with @error set
+ */
+const gchar *
+fw_client_addPortFinish(FWClient *obj,
+			GAsyncResult *result,
+			GError **error)
+{
+    return _fw_client_call_finish_str(obj, result, error);
+}
+
+/**
+ * fw_client_queryPortAsync: (finish-func queryPortFinish)
+ * @obj: (type FWClient*): a FWClient instance
+ * @zone: (type gchar*)
+ * @port: (type gchar*)
+ * @protocol: (type gchar*)
+ * @cancellable: (allow-none)
+ * @callback: (scope async): called with the reply
+ * @user_data: (closure): data for @callback
+ */
+void
+fw_client_queryPortAsync(FWClient *obj,
+			 const gchar *zone,
+			 const gchar *port,
+			 const gchar *protocol,
+			 GCancellable *cancellable,
+			 GAsyncReadyCallback callback,
+			 gpointer user_data)
+{
+    FWClientPrivate *priv = FW_CLIENT_GET_PRIVATE(obj);
+
+    _fw_client_call_async(priv,
+			  _fw_client_call_new(obj, cancellable, callback,
+					      user_data),
+			  priv->zone_proxy, "queryPort",
+			  g_variant_new("(sss)", zone, port, protocol));
+}
+
+/**
+ * fw_client_queryPortFinish:
+ * @result: the result passed to the callback
+ * @error: (allow-none): return location for an error
+ */
+gboolean
+fw_client_queryPortFinish(FWClient *obj,
+			  GAsyncResult *result,
+			  GError **error)
+{
+    return _fw_client_call_finish_bool(obj, result, error);
+}
+
+/**
+ * fw_client_removePortAsync: (finish-func removePortFinish)
+ * @obj: (type FWClient*): a FWClient instance
+ * @zone: (type gchar*)
+ * @port: (type gchar*)
+ * @protocol: (type gchar*)
+ * @cancellable: (allow-none)
+ * @callback: (scope async): called with the reply
+ * @user_data: (closure): data for @callback
+ */
+void
+fw_client_removePortAsync(FWClient *obj,
+			  const gchar *zone,
+			  const gchar *port,
+			  const gchar *protocol,
+			  GCancellable *cancellable,
+			  GAsyncReadyCallback callback,
+			  gpointer user_data)
+{
+    FWClientPrivate *priv = FW_CLIENT_GET_PRIVATE(obj);
+    GTask *task;
+
+    task = _fw_client_call_new(obj, cancellable, callback, user_data);
+    _fw_client_call_set_expiration(task, zone, "port",
+				   fw_expiration_tracker_portItem(port,
+								  protocol),
+				   FALSE, 0);
+    _fw_client_call_async(priv, task, priv->zone_proxy, "removePort",
+			  g_variant_new("(sss)", zone, port, protocol));
+}
+
+/**
+ * fw_client_removePortFinish:
+ * @result: the result passed to the callback
+ * @error: (allow-none): return location for an error
+ *
+ * Returns: (transfer none) (allow-none): the zone or NULL with @error set
+ */
+const gchar *
+fw_client_removePortFinish(FWClient *obj,
+			   GAsyncResult *result,
+			   GError **error)
+{
+    return _fw_client_call_finish_str(obj, result, error);
+}
+
+/**
+ * fw_client_getPortsStrvAsync: (finish-func getPortsStrvFinish)
+ * @obj: (type FWClient*): a FWClient instance
+ * @zone: (type gchar*)
+ * @cancellable: (allow-none)
+ * @callback: (scope async): called with the reply
+ * @user_data: (closure): data for @callback
+ */
+void
+fw_client_getPortsStrvAsync(FWClient *obj,
+			    const gchar *zone,
+			    GCancellable *cancellable,
+			    GAsyncReadyCallback callback,
+			    gpointer user_data)
+{
+    FWClientPrivate *priv = FW_CLIENT_GET_PRIVATE(obj);
+
+    _fw_client_call_async(priv,
+			  _fw_client_call_new(obj, cancellable, callback,
+					      user_data),
+			  priv->zone_proxy, "getPorts",
+			  g_variant_new("(s)", zone));
+}
+
+/**
+ * fw_client_getPortsStrvFinish:
+ * @result: the result passed to the callback
+ * @error: (allow-none): return location for an error
+ *
+ * Returns: (transfer full) (allow-none) (array zero-terminated=1):
+ *   "port/protocol" entries
+ */
+gchar **
+fw_client_getPortsStrvFinish(FWClient *obj,
+			     GAsyncResult *result,
+			     GError **error)
+{
+    GVariant *variant;
+    gchar **strv;
+
+    variant = _fw_client_call_finish(obj, result, "(aas)", error);
+    if (variant == NULL)
+	return NULL;
+
+    strv = _fw_client_item_strv_new_from_variant(variant, 2);
+    g_variant_unref(variant);
+
+    return strv;
+}
+
 /* protocols */
 
 const gchar *
@@ -1373,12 +3877,19 @@ fw_client_addProtocol(FWClient *obj,
 		      gint32 timeout)
 {
     FWClientPrivate *priv = FW_CLIENT_GET_PRIVATE(obj);
+    const gchar *result;
 
-    return _fw_client_proxy_call_sync_get_str(priv, priv->zone_proxy,
-					      "addProtocol",
-					      g_variant_new("(ssi)", zone,
-							    protocol,
-							    timeout));
+    result = _fw_client_proxy_call_sync_get_str(priv, priv->zone_proxy,
+						"addProtocol",
+						g_variant_new("(ssi)", zone,
+							      protocol,
+							      timeout));
+
+    if (priv->error == NULL)
+	fw_expiration_tracker_add(priv->expirations, zone,
+				  "protocol", protocol, timeout);
+
+    return result;
 }
 
 gboolean
@@ -1400,11 +3911,18 @@ fw_client_removeProtocol(FWClient *obj,
 			 const gchar *protocol)
 {
     FWClientPrivate *priv = FW_CLIENT_GET_PRIVATE(obj);
+    const gchar *result;
 
-    return _fw_client_proxy_call_sync_get_str(priv, priv->zone_proxy,
-					      "removeProtocol",
-					      g_variant_new("(ss)", zone,
-							    protocol));
+    result = _fw_client_proxy_call_sync_get_str(priv, priv->zone_proxy,
+						"removeProtocol",
+						g_variant_new("(ss)", zone,
+							      protocol));
+
+    if (priv->error == NULL)
+	fw_expiration_tracker_remove(priv->expirations, zone,
+				     "protocol", protocol);
+
+    return result;
 }
 
 /**
@@ -1423,6 +3941,26 @@ fw_client_getProtocols(FWClient *obj,
 						   g_variant_new("(s)", zone));
 }
 
+/**
+ * fw_client_getProtocolsStrv:
+ * @obj: (type FWClient*): a FWClient instance
+ * @zone: (type gchar*)
+ *
+ * Same as fw_client_getProtocols, but as a single string array.
+ *
+ * Returns: (transfer full) (allow-none) (array zero-terminated=1)
+ */
+gchar **
+fw_client_getProtocolsStrv(FWClient *obj,
+			   const gchar *zone)
+{
+    FWClientPrivate *priv = FW_CLIENT_GET_PRIVATE(obj);
+
+    return _fw_client_proxy_call_sync_get_strv(priv, priv->zone_proxy,
+					       "getProtocols",
+					       g_variant_new("(s)", zone));
+}
+
 /* sourceports */
 
 const gchar *
@@ -1433,12 +3971,23 @@ fw_client_addSourcePort(FWClient *obj,
 			gint32 timeout)
 {
     FWClientPrivate *priv = FW_CLIENT_GET_PRIVATE(obj);
+    const gchar *result;
+    gchar *item;
+
+    result = _fw_client_proxy_call_sync_get_str(priv, priv->zone_proxy,
+						"addSourcePort",
+						g_variant_new("(sssi)", zone,
+							      port, protocol,
+							      timeout));
+
+    if (priv->error == NULL) {
+	item = fw_expiration_tracker_portItem(port, protocol);
+	fw_expiration_tracker_add(priv->expirations, zone,
+				  "source-port", item, timeout);
+	g_free(item);
+    }
 
-    return _fw_client_proxy_call_sync_get_str(priv, priv->zone_proxy,
-					      "addSourcePort",
-					      g_variant_new("(sssi)", zone,
-							    port, protocol,
-							    timeout));
+    return result;
 }
 
 gboolean
@@ -1462,11 +4011,22 @@ fw_client_removeSourcePort(FWClient *obj,
 			   const gchar *protocol)
 {
     FWClientPrivate *priv = FW_CLIENT_GET_PRIVATE(obj);
+    const gchar *result;
+    gchar *item;
+
+    result = _fw_client_proxy_call_sync_get_str(priv, priv->zone_proxy,
+						"removeSourcePort",
+						g_variant_new("(sss)", zone,
+							      port, protocol));
+
+    if (priv->error == NULL) {
+	item = fw_expiration_tracker_portItem(port, protocol);
+	fw_expiration_tracker_remove(priv->expirations, zone,
+				     "source-port", item);
+	g_free(item);
+    }
 
-    return _fw_client_proxy_call_sync_get_str(priv, priv->zone_proxy,
-					      "removeSourcePort",
-					      g_variant_new("(sss)", zone,
-							    port, protocol));
+    return result;
 }
 
 /**
@@ -1479,7 +4039,7 @@ fw_client_getSourcePorts(FWClient *obj,
 			 const gchar *zone)
 {
     FWClientPrivate *priv = FW_CLIENT_GET_PRIVATE(obj);
-    GVariant *variant;
+    GVariant *variant, *reply;
     GVariantIter iter;
     GList *list = NULL;
 
@@ -1492,11 +4052,14 @@ fw_client_getSourcePorts(FWClient *obj,
     }
 
     if (strncmp(g_variant_get_type_string(variant), "(aas)", 5) != 0) {
+	g_variant_unref(variant);
 	return list;
     }
 
     /* get aas from (aas) */
-    variant = g_variant_get_child_value(variant, 0);
+    reply = variant;
+    variant = g_variant_get_child_value(reply, 0);
+    g_variant_unref(reply);
 
     if (g_variant_iter_init(&iter, variant)) {
 	GVariant *element;
@@ -1506,17 +4069,39 @@ fw_client_getSourcePorts(FWClient *obj,
 	    const gchar **strv = g_variant_get_strv(element, &length);
 
 	    if (length == 2) {
-		list = g_list_append(list, fw_port_new(g_strdup(strv[0]),
-						       g_strdup(strv[1])));
+		list = g_list_append(list, fw_port_new((gchar *) strv[0],
+						       (gchar *) strv[1]));
 	    }
 	    g_free(strv);
 	    g_variant_unref(element);
 	}
     }
 
-    g_variant_unref(variant);
+    g_variant_unref(variant);
+
+    return list;
+}
+
+/**
+ * fw_client_getSourcePortsStrv:
+ * @obj: (type FWClient*): a FWClient instance
+ * @zone: (type gchar*)
+ *
+ * Same as fw_client_getSourcePorts, but as a single string array with
+ * "port/protocol" entries.
+ *
+ * Returns: (transfer full) (allow-none) (array zero-terminated=1)
+ */
+gchar **
+fw_client_getSourcePortsStrv(FWClient *obj,
+			     const gchar *zone)
+{
+    FWClientPrivate *priv = FW_CLIENT_GET_PRIVATE(obj);
 
-    return list;
+    return _fw_client_proxy_call_sync_get_item_strv(priv, priv->zone_proxy,
+						    "getSourcePorts",
+						    g_variant_new("(s)", zone),
+						    2);
 }
 
 /* masquerade */
@@ -1527,11 +4112,18 @@ fw_client_addMasquerade(FWClient *obj,
 			gint32 timeout)
 {
     FWClientPrivate *priv = FW_CLIENT_GET_PRIVATE(obj);
+    const gchar *result;
 
-    return _fw_client_proxy_call_sync_get_str(priv, priv->zone_proxy,
-					      "addMasquerade",
-					      g_variant_new("(si)", zone,
-							    timeout));
+    result = _fw_client_proxy_call_sync_get_str(priv, priv->zone_proxy,
+						"addMasquerade",
+						g_variant_new("(si)", zone,
+							      timeout));
+
+    if (priv->error == NULL)
+	fw_expiration_tracker_add(priv->expirations, zone,
+				  "masquerade", "", timeout);
+
+    return result;
 }
 
 gboolean
@@ -1550,10 +4142,17 @@ fw_client_removeMasquerade(FWClient *obj,
 			   const gchar *zone)
 {
     FWClientPrivate *priv = FW_CLIENT_GET_PRIVATE(obj);
+    const gchar *result;
 
-    return _fw_client_proxy_call_sync_get_str(priv, priv->zone_proxy,
-					      "removeMasquerade",
-					      g_variant_new("(s)", zone));
+    result = _fw_client_proxy_call_sync_get_str(priv, priv->zone_proxy,
+						"removeMasquerade",
+						g_variant_new("(s)", zone));
+
+    if (priv->error == NULL)
+	fw_expiration_tracker_remove(priv->expirations, zone,
+				     "masquerade", "");
+
+    return result;
 }
 
 /* foward ports */
@@ -1568,13 +4167,25 @@ fw_client_addForwardPort(FWClient *obj,
 			 gint32 timeout)
 {
     FWClientPrivate *priv = FW_CLIENT_GET_PRIVATE(obj);
+    const gchar *result;
+    gchar *item;
+
+    result = _fw_client_proxy_call_sync_get_str(priv, priv->zone_proxy,
+						"addForwardPort",
+						g_variant_new("(sssssi)", zone,
+							      port, protocol,
+							      toport, toaddr,
+							      timeout));
+
+    if (priv->error == NULL) {
+	item = fw_expiration_tracker_forwardPortItem(port, protocol,
+						     toport, toaddr);
+	fw_expiration_tracker_add(priv->expirations, zone,
+				  "forward-port", item, timeout);
+	g_free(item);
+    }
 
-    return _fw_client_proxy_call_sync_get_str(priv, priv->zone_proxy,
-					      "addForwardPort",
-					      g_variant_new("(sssssi)", zone,
-							    port, protocol,
-							    toport, toaddr,
-							    timeout));
+    return result;
 }
 
 gboolean
@@ -1603,12 +4214,24 @@ fw_client_removeForwardPort(FWClient *obj,
 			    const gchar *toaddr)
 {
     FWClientPrivate *priv = FW_CLIENT_GET_PRIVATE(obj);
+    const gchar *result;
+    gchar *item;
+
+    result = _fw_client_proxy_call_sync_get_str(priv, priv->zone_proxy,
+						"removeForwardPort",
+						g_variant_new("(sssss)", zone,
+							      port, protocol,
+							      toport, toaddr));
+
+    if (priv->error == NULL) {
+	item = fw_expiration_tracker_forwardPortItem(port, protocol,
+						     toport, toaddr);
+	fw_expiration_tracker_remove(priv->expirations, zone,
+				     "forward-port", item);
+	g_free(item);
+    }
 
-    return _fw_client_proxy_call_sync_get_str(priv, priv->zone_proxy,
-					      "removeForwardPort",
-					      g_variant_new("(sssss)", zone,
-							    port, protocol,
-							    toport, toaddr));
+    return result;
 }
 
 /**
@@ -1622,7 +4245,7 @@ fw_client_getForwardPorts(FWClient *obj,
 {
     FWClientPrivate *priv = FW_CLIENT_GET_PRIVATE(obj);
 
-    GVariant *variant;
+    GVariant *variant, *reply;
     GVariantIter iter;
     GList *list = NULL;
 
@@ -1635,11 +4258,14 @@ fw_client_getForwardPorts(FWClient *obj,
     }
 
     if (strncmp(g_variant_get_type_string(variant), "(aas)", 5) != 0) {
+	g_variant_unref(variant);
 	return list;
     }
 
     /* get aas from (aas) */
-    variant = g_variant_get_child_value(variant, 0);
+    reply = variant;
+    variant = g_variant_get_child_value(reply, 0);
+    g_variant_unref(reply);
 
     if (g_variant_iter_init(&iter, variant)) {
 	GVariant *element;
@@ -1663,6 +4289,28 @@ fw_client_getForwardPorts(FWClient *obj,
     return list;
 }
 
+/**
+ * fw_client_getForwardPortsStrv:
+ * @obj: (type FWClient*): a FWClient instance
+ * @zone: (type gchar*)
+ *
+ * Same as fw_client_getForwardPorts, but as a single string array with
+ * "port=..:proto=..:toport=..:toaddr=.." entries.
+ *
+ * Returns: (transfer full) (allow-none) (array zero-terminated=1)
+ */
+gchar **
+fw_client_getForwardPortsStrv(FWClient *obj,
+			      const gchar *zone)
+{
+    FWClientPrivate *priv = FW_CLIENT_GET_PRIVATE(obj);
+
+    return _fw_client_proxy_call_sync_get_item_strv(priv, priv->zone_proxy,
+						    "getForwardPorts",
+						    g_variant_new("(s)", zone),
+						    4);
+}
+
 /* icmpblock */
 
 const gchar *
@@ -1672,11 +4320,18 @@ fw_client_addIcmpBlock(FWClient *obj,
 		       gint32 timeout)
 {
     FWClientPrivate *priv = FW_CLIENT_GET_PRIVATE(obj);
+    const gchar *result;
 
-    return _fw_client_proxy_call_sync_get_str(priv, priv->zone_proxy,
-					      "addIcmpBlock",
-					      g_variant_new("(ssi)", zone,
-							    icmptype, timeout));
+    result = _fw_client_proxy_call_sync_get_str(priv, priv->zone_proxy,
+						"addIcmpBlock",
+						g_variant_new("(ssi)", zone,
+							      icmptype, timeout));
+
+    if (priv->error == NULL)
+	fw_expiration_tracker_add(priv->expirations, zone,
+				  "icmp-block", icmptype, timeout);
+
+    return result;
 }
 
 gboolean
@@ -1698,11 +4353,18 @@ fw_client_removeIcmpBlock(FWClient *obj,
 			  const gchar *icmptype)
 {
     FWClientPrivate *priv = FW_CLIENT_GET_PRIVATE(obj);
+    const gchar *result;
 
-    return _fw_client_proxy_call_sync_get_str(priv, priv->zone_proxy,
-					      "removeIcmpBlock",
-					      g_variant_new("(ss)", zone,
-							    icmptype));
+    result = _fw_client_proxy_call_sync_get_str(priv, priv->zone_proxy,
+						"removeIcmpBlock",
+						g_variant_new("(ss)", zone,
+							      icmptype));
+
+    if (priv->error == NULL)
+	fw_expiration_tracker_remove(priv->expirations, zone,
+				     "icmp-block", icmptype);
+
+    return result;
 }
 
 /**
@@ -1721,6 +4383,26 @@ fw_client_getIcmpBlocks(FWClient *obj,
 						   g_variant_new("(s)", zone));
 }
 
+/**
+ * fw_client_getIcmpBlocksStrv:
+ * @obj: (type FWClient*): a FWClient instance
+ * @zone: (type gchar*)
+ *
+ * Same as fw_client_getIcmpBlocks, but as a single string array.
+ *
+ * Returns: (transfer full) (allow-none) (array zero-terminated=1)
+ */
+gchar **
+fw_client_getIcmpBlocksStrv(FWClient *obj,
+			    const gchar *zone)
+{
+    FWClientPrivate *priv = FW_CLIENT_GET_PRIVATE(obj);
+
+    return _fw_client_proxy_call_sync_get_strv(priv, priv->zone_proxy,
+					       "getIcmpBlocks",
+					       g_variant_new("(s)", zone));
+}
+
 /* direct chain */
 
 void
@@ -1857,6 +4539,8 @@ fw_client_getRules(FWClient *obj,
     GVariant *variant;
     GVariant *child;
     GVariantIter iter;
+    gint32 priority;
+    GVariant *args;
     GList *list = NULL;
 
     variant = _fw_client_proxy_call_sync(priv, priv->direct_proxy,
@@ -1870,38 +4554,21 @@ fw_client_getRules(FWClient *obj,
 
     child = g_variant_get_child_value(variant, 0);
 
-    if (g_variant_iter_init(&iter, child)) {
-	GVariant *element;
+    g_variant_iter_init(&iter, child);
+    while (g_variant_iter_next(&iter, "(i@as)", &priority, &args)) {
+	FWDirectSimpleRule *rule = fw_direct_simple_rule_new();
+	GList *args_list = fw_str_list_new_from_variant(args);
 
-	while ((element = g_variant_iter_next_value(&iter)) != NULL) {
-	    GVariant *item;
-	    gint32 priority;
-	    GVariantIter iter2;
-	    GList *args = NULL;
-	    FWDirectSimpleRule *rule = NULL;
-
-	    item = g_variant_get_child_value(element, 0);
-	    g_variant_get(item, "i", &priority);
-
-	    item = g_variant_get_child_value(element, 1);
-	    if (g_variant_iter_init(&iter2, item)) {
-		GVariant *item2;
-		const gchar *str;
-
-		while ((item2 = g_variant_iter_next_value(&iter2))) {
-		    str = g_variant_get_string(item2, NULL);
-		    args = g_list_append(args, g_strdup(str));
-		}
-	    }
+	fw_direct_simple_rule_setPriority(rule, priority);
+	fw_direct_simple_rule_setArgs(rule, args_list);
+	list = g_list_prepend(list, rule);
 
-	    rule = fw_direct_simple_rule_new();
-	    fw_direct_simple_rule_setPriority(rule, priority);
-	    fw_direct_simple_rule_setArgs(rule, args);
-	    list = g_list_append(list, rule);
-	    g_variant_unref(element);
-	}
+	fw_str_list_free(args_list);
+	g_variant_unref(args);
     }
+    list = g_list_reverse(list);
 
+    g_variant_unref(child);
     g_variant_unref(variant);
 
     return list;
@@ -1999,9 +4666,7 @@ fw_client_getAllRules(FWClient *obj)
 {
     FWClientPrivate *priv = FW_CLIENT_GET_PRIVATE(obj);
     GVariant *variant;
-    GVariant *child;
-    GVariantIter iter;
-    GList *list = NULL;
+    GList *list;
 
 #ifdef FW_DEBUG
     g_printerr("fw_client_getAllRules()\n");
@@ -2012,59 +4677,188 @@ fw_client_getAllRules(FWClient *obj)
                                          NULL);
 
     if (priv->error != NULL) {
-        return list;
+        return NULL;
     }
 
-    child = g_variant_get_child_value(variant, 0);
+    list = fw_direct_rule_list_new_from_variant(variant);
+    g_variant_unref(variant);
 
-    if (g_variant_iter_init(&iter, child)) {
-        GVariant *element;
-
-        while ((element = g_variant_iter_next_value(&iter)) != NULL) {
-            GVariant *item;
-            gchar *ipv, *table, *chain;
-            gint32 priority;
-            GVariantIter iter2;
-            GList *args = NULL;
-            FWDirectRule *rule = NULL;
-
-            item = g_variant_get_child_value(element, 0);
-            g_variant_get(item, "s", &ipv);
-
-            item = g_variant_get_child_value(element, 1);
-            g_variant_get(item, "s", &table);
-
-            item = g_variant_get_child_value(element, 2);
-            g_variant_get(item, "s", &chain);
-
-            item = g_variant_get_child_value(element, 3);
-            g_variant_get(item, "i", &priority);
-
-            item = g_variant_get_child_value(element, 4);
-            if (g_variant_iter_init(&iter2, item)) {
-                GVariant *item2;
-                const gchar *str;
-
-                while ((item2 = g_variant_iter_next_value(&iter2))) {
-                    str = g_variant_get_string(item2, NULL);
-                    args = g_list_append(args, g_strdup(str));
-                }
-            }
-
-            rule = fw_direct_rule_new();
-            fw_direct_rule_setIpv(rule, ipv);
-            fw_direct_rule_setTable(rule, table);
-            fw_direct_rule_setChain(rule, chain);
-            fw_direct_rule_setPriority(rule, priority);
-            fw_direct_rule_setArgs(rule, args);
-            list = g_list_append(list, rule);
-            g_variant_unref(element);
-        }
+    return list;
+}
+
+static gpointer
+_fw_client_decode_rules(GVariant *variant,
+			GError **error)
+{
+    if (!g_variant_is_of_type(variant, G_VARIANT_TYPE("(a(sssias))"))) {
+	_fw_client_decode_error(variant, error);
+	return NULL;
+    }
+
+    return fw_direct_rule_list_new_from_variant(variant);
+}
+
+/* the rules are shared, the list is not */
+static gpointer
+_fw_client_rule_list_copy(gpointer list)
+{
+    return g_list_copy_deep(list, (GCopyFunc) g_object_ref, NULL);
+}
+
+static void
+_fw_client_rule_list_free(gpointer list)
+{
+    g_list_free_full(list, g_object_unref);
+}
+
+/**
+ * fw_client_getAllRulesAsync: (finish-func getAllRulesFinish)
+ * @obj: (type FWClient*): a FWClient instance
+ * @cancellable: (allow-none)
+ * @callback: (scope async): called with the reply
+ * @user_data: (closure): data for @callback
+ */
+void
+fw_client_getAllRulesAsync(FWClient *obj,
+			   GCancellable *cancellable,
+			   GAsyncReadyCallback callback,
+			   gpointer user_data)
+{
+    FWClientPrivate *priv = FW_CLIENT_GET_PRIVATE(obj);
+    GTask *task;
+
+    task = _fw_client_call_new(obj, cancellable, callback, user_data);
+    _fw_client_call_set_decode(task, _fw_client_decode_rules,
+			       _fw_client_rule_list_copy,
+			       _fw_client_rule_list_free);
+    _fw_client_call_async(priv, task, priv->direct_proxy, "getAllRules",
+			  NULL);
+}
+
+/**
+ * fw_client_getAllRulesFinish:
+ * @result: the result passed to the callback
+ * @error: (allow-none): return location for an error
+ *
+ * The rules are shared with the other callers of an identical read, they
+ * must not be changed.
+ *
+ * Returns: (transfer full) (allow-none) (element-type FWDirectRule*)
+ */
+GList *
+fw_client_getAllRulesFinish(FWClient *obj,
+			    GAsyncResult *result,
+			    GError **error)
+{
+    return _fw_client_call_finish_decoded(obj, result, error);
+}
+
+/**
+ * fw_client_getAllRulesVariant:
+ * @obj: (type FWClient*): a FWClient instance
+ *
+ * Same as fw_client_getAllRules, but returns the packed reply without
+ * creating a FWDirectRule per rule.
+ *
+ * Returns: (transfer full) (allow-none): variant of type a(sssias)
+ */
+GVariant *
+fw_client_getAllRulesVariant(FWClient *obj)
+{
+    FWClientPrivate *priv = FW_CLIENT_GET_PRIVATE(obj);
+    GVariant *variant, *rules;
+
+#ifdef FW_DEBUG
+    g_printerr("fw_client_getAllRulesVariant()\n");
+#endif
+
+    variant = _fw_client_proxy_call_sync(priv, priv->direct_proxy,
+					 "getAllRules",
+					 NULL);
+    if (priv->error != NULL)
+	return NULL;
+
+    if (strncmp(g_variant_get_type_string(variant), "(a(sssias))", 11) != 0) {
+	g_variant_unref(variant);
+	return NULL;
     }
 
+    /* get a(sssias) from (a(sssias)) */
+    rules = g_variant_get_child_value(variant, 0);
     g_variant_unref(variant);
 
-    return list;
+    return rules;
+}
+
+/**
+ * fw_client_getDirectRuleSet:
+ * @obj: (type FWClient*): a FWClient instance
+ *
+ * Gets all runtime direct rules with a single call, for local lookups
+ * instead of fw_client_queryRule and fw_client_getRules.
+ *
+ * Returns: (transfer full) (allow-none) (type FWDirectRuleSet*)
+ */
+FWDirectRuleSet *
+fw_client_getDirectRuleSet(FWClient *obj)
+{
+    FWClientPrivate *priv = FW_CLIENT_GET_PRIVATE(obj);
+    GVariant *variant;
+    FWDirectRuleSet *rules;
+
+#ifdef FW_DEBUG
+    g_printerr("fw_client_getDirectRuleSet()\n");
+#endif
+
+    variant = _fw_client_proxy_call_sync(priv, priv->direct_proxy,
+					 "getAllRules",
+					 NULL);
+    if (priv->error != NULL)
+	return NULL;
+
+    rules = fw_direct_rule_set_new_from_variant(variant);
+    g_variant_unref(variant);
+
+    return rules;
+}
+
+/**
+ * fw_client_applyDirectRuleSet:
+ * @obj: (type FWClient*): a FWClient instance
+ * @rules: (type FWDirectRuleSet*): desired runtime direct rules
+ *
+ * Changes the runtime direct rules to @rules with the minimal number of
+ * removeRule and addRule calls. The calls are pipelined, failed calls are
+ * reported and do not stop the others.
+ *
+ * Returns: (type gboolean): TRUE if all calls succeeded
+ */
+gboolean
+fw_client_applyDirectRuleSet(FWClient *obj,
+			     FWDirectRuleSet *rules)
+{
+    FWClientPrivate *priv = FW_CLIENT_GET_PRIVATE(obj);
+    FWDirectRuleSet *current;
+    FWBatch *batch;
+    gboolean ret;
+
+#ifdef FW_DEBUG
+    g_printerr("fw_client_applyDirectRuleSet(%u rules)\n",
+	       fw_direct_rule_set_length(rules));
+#endif
+
+    current = fw_client_getDirectRuleSet(obj);
+    if (current == NULL)
+	return FALSE;
+
+    batch = _fw_client_batch_new(priv, FW_LIMITER_PRIORITY_NORMAL);
+    fw_direct_rule_set_queueDiff(current, rules, batch);
+    ret = _fw_client_batch_run(priv, batch);
+
+    g_object_unref(batch);
+    g_object_unref(current);
+
+    return ret;
 }
 
 /* direct passthrough (untracked) */
@@ -2074,8 +4868,10 @@ fw_client_getAllRules(FWClient *obj)
  * @obj: (type FWClient*): a FWClient instance
  * @ipv: (type utf8)
  * @args: (type GList*) (element-type utf8)
+ *
+ * Returns: (transfer full) (allow-none): output of the command
  */
-const gchar *
+gchar *
 fw_client_passthrough(FWClient *obj,
 		      const gchar *ipv,
 		      const GList *args)
@@ -2096,7 +4892,7 @@ fw_client_passthrough(FWClient *obj,
 			      (gchar *)g_list_nth_data((GList *)args, i));
     }
 
-    return _fw_client_proxy_call_sync_get_str(priv, priv->direct_proxy,
+    return _fw_client_proxy_call_sync_dup_str(priv, priv->direct_proxy,
 					      "passthrough",
 					      g_variant_new("(sas)", ipv,
 							    &builder));
@@ -2215,7 +5011,7 @@ fw_client_getPassthroughs(FWClient *obj,
 			  const gchar *ipv)
 {
     FWClientPrivate *priv = FW_CLIENT_GET_PRIVATE(obj);
-    GVariant *variant;
+    GVariant *variant, *child;
     GVariantIter iter;
     GList *list = NULL;
 
@@ -2232,13 +5028,14 @@ fw_client_getPassthroughs(FWClient *obj,
     }
 
     if (strncmp(g_variant_get_type_string(variant), "(aas)", 5) != 0) {
+	g_variant_unref(variant);
 	return list;
     }
 
     /* get aas from (aas) */
-    variant = g_variant_get_child_value(variant, 0);
+    child = g_variant_get_child_value(variant, 0);
 
-    if (g_variant_iter_init(&iter, variant)) {
+    if (g_variant_iter_init(&iter, child)) {
 	GVariant *element;
 
 	while ((element = g_variant_iter_next_value(&iter)) != NULL) {
@@ -2247,15 +5044,17 @@ fw_client_getPassthroughs(FWClient *obj,
 	    const gchar **strv = g_variant_get_strv(element, &length);
 
 	    for (i=0; i<length; i++) {
-		fw_args_addArg(args, g_strdup(strv[i]));
+		fw_args_addArg(args, (gchar *) strv[i]);
 	    }
 	    g_free(strv);
 
-	    list = g_list_append(list, args);
+	    list = g_list_prepend(list, args);
 	    g_variant_unref(element);
 	}
     }
+    list = g_list_reverse(list);
 
+    g_variant_unref(child);
     g_variant_unref(variant);
 
     return list;
@@ -2271,8 +5070,10 @@ GList *
 fw_client_getAllPassthroughs(FWClient *obj)
 {
     FWClientPrivate *priv = FW_CLIENT_GET_PRIVATE(obj);
-    GVariant *variant;
+    GVariant *variant, *child;
     GVariantIter iter;
+    const gchar *ipv;
+    GVariant *args;
     GList *list = NULL;
 
 #ifdef FW_DEBUG
@@ -2288,49 +5089,105 @@ fw_client_getAllPassthroughs(FWClient *obj)
     }
 
     if (strncmp(g_variant_get_type_string(variant), "(a(sas))", 7) != 0) {
+	g_variant_unref(variant);
 	return list;
     }
 
     /* get a(sas) from (a(sas)) */
-    variant = g_variant_get_child_value(variant, 0);
+    child = g_variant_get_child_value(variant, 0);
 
-    if (g_variant_iter_init(&iter, variant)) {
-	GVariant *element;
+    g_variant_iter_init(&iter, child);
+    while (g_variant_iter_next(&iter, "(&s@as)", &ipv, &args)) {
+	FWPassthrough *pthru = fw_passthrough_new();
+	GList *args_list = fw_str_list_new_from_variant(args);
 
-	while ((element = g_variant_iter_next_value(&iter)) != NULL) {
-	    GVariant *item;
-	    gchar *ipv;
-	    GVariantIter iter2;
-	    GList *args = NULL;
-	    FWPassthrough *pthru = NULL;
-
-	    item = g_variant_get_child_value(element, 0);
-	    g_variant_get(item, "s", &ipv);
-
-	    item = g_variant_get_child_value(element, 1);
-	    if (g_variant_iter_init(&iter2, item)) {
-		GVariant *item2;
-		const gchar *str;
-
-		while ((item2 = g_variant_iter_next_value(&iter2))) {
-		    str = g_variant_get_string(item2, NULL);
-		    args = g_list_append(args, g_strdup(str));
-		}
-	    }
+	fw_passthrough_setIpv(pthru, (gchar *) ipv);
+	fw_passthrough_setArgs(pthru, args_list);
+	list = g_list_prepend(list, pthru);
 
-	    pthru = fw_passthrough_new();
-	    fw_passthrough_setIpv(pthru, ipv);
-	    fw_passthrough_setArgs(pthru, args);
-	    list = g_list_append(list, pthru);
-	    g_variant_unref(element);
-	}
+	fw_str_list_free(args_list);
+	g_variant_unref(args);
     }
+    list = g_list_reverse(list);
 
+    g_variant_unref(child);
     g_variant_unref(variant);
 
     return list;
 }
 
+/**
+ * fw_client_getPassthroughSet:
+ * @obj: (type FWClient*): a FWClient instance
+ *
+ * Gets all tracked passthroughs with a single call, for local lookups
+ * instead of fw_client_queryPassthrough.
+ *
+ * Returns: (transfer full) (allow-none) (type FWPassthroughSet*)
+ */
+FWPassthroughSet *
+fw_client_getPassthroughSet(FWClient *obj)
+{
+    FWClientPrivate *priv = FW_CLIENT_GET_PRIVATE(obj);
+    GVariant *variant;
+    FWPassthroughSet *passthroughs;
+
+#ifdef FW_DEBUG
+    g_printerr("fw_client_getPassthroughSet()\n");
+#endif
+
+    variant = _fw_client_proxy_call_sync(priv, priv->direct_proxy,
+					 "getAllPassthroughs",
+					 NULL);
+    if (priv->error != NULL)
+	return NULL;
+
+    passthroughs = fw_passthrough_set_new_from_variant(variant);
+    g_variant_unref(variant);
+
+    return passthroughs;
+}
+
+/**
+ * fw_client_reconcilePassthroughs:
+ * @obj: (type FWClient*): a FWClient instance
+ * @passthroughs: (type FWPassthroughSet*): desired tracked passthroughs
+ *
+ * Changes the tracked passthroughs to @passthroughs, only the missing
+ * ones are added and the ones not in @passthroughs removed. The calls are
+ * pipelined, failed calls are reported and do not stop the others.
+ *
+ * Returns: (type gboolean): TRUE if all calls succeeded
+ */
+gboolean
+fw_client_reconcilePassthroughs(FWClient *obj,
+				FWPassthroughSet *passthroughs)
+{
+    FWClientPrivate *priv = FW_CLIENT_GET_PRIVATE(obj);
+    FWPassthroughSet *current;
+    FWBatch *batch;
+    gboolean ret;
+
+#ifdef FW_DEBUG
+    g_printerr("fw_client_reconcilePassthroughs(%u passthroughs)\n",
+	       fw_passthrough_set_length(passthroughs));
+#endif
+
+    current = fw_client_getPassthroughSet(obj);
+    if (current == NULL)
+	return FALSE;
+
+    batch = _fw_client_batch_new(priv, FW_LIMITER_PRIORITY_NORMAL);
+    fw_passthrough_set_queueDiff(current, passthroughs, batch);
+    ret = _fw_client_batch_run(priv, batch);
+
+    g_object_unref(batch);
+    g_object_unref(current);
+
+    return ret;
+}
+
+
 /**
  * fw_client_removeAllPassthroughs:
  * @obj: (type FWClient*): a FWClient instance
@@ -2668,3 +5525,112 @@ fw_client_removeLockdownWhitelistUser(FWClient *obj,
 			       g_variant_new("(s)", user));
 }
 
+/* lockdown whitelist */
+
+/**
+ * fw_client_getLockdownWhitelist:
+ * @obj: (type FWClient*): a FWClient instance
+ *
+ * Gets the commands, contexts, uids and users of the runtime lockdown
+ * whitelist in one pipelined batch, for local checks with
+ * fw_lockdown_whitelist_isAllowed.
+ *
+ * Returns: (transfer full) (allow-none) (type FWLockdownWhitelist*)
+ */
+FWLockdownWhitelist *
+fw_client_getLockdownWhitelist(FWClient *obj)
+{
+    FWClientPrivate *priv = FW_CLIENT_GET_PRIVATE(obj);
+    FWLockdownWhitelist *whitelist;
+    FWBatch *batch;
+    GVariantIter *iter;
+    const gchar *str;
+    gint32 uid;
+    guint i;
+
+#ifdef FW_DEBUG
+    g_printerr("fw_client_getLockdownWhitelist()\n");
+#endif
+
+    batch = _fw_client_batch_new(priv, FW_LIMITER_PRIORITY_NORMAL);
+    fw_batch_add(batch, FW_DBUS_PATH, FW_DBUS_INTERFACE_POLICIES,
+		 "getLockdownWhitelistCommands", NULL);
+    fw_batch_add(batch, FW_DBUS_PATH, FW_DBUS_INTERFACE_POLICIES,
+		 "getLockdownWhitelistContexts", NULL);
+    fw_batch_add(batch, FW_DBUS_PATH, FW_DBUS_INTERFACE_POLICIES,
+		 "getLockdownWhitelistUids", NULL);
+    fw_batch_add(batch, FW_DBUS_PATH, FW_DBUS_INTERFACE_POLICIES,
+		 "getLockdownWhitelistUsers", NULL);
+    if (!_fw_client_batch_run(priv, batch)) {
+	g_object_unref(batch);
+	return NULL;
+    }
+
+    whitelist = fw_lockdown_whitelist_new();
+    for (i = 0; i < 4; i++) {
+	GVariant *result = fw_batch_getResult(batch, i);
+
+	if (i == 2) {
+	    g_variant_get(result, "(ai)", &iter);
+	    while (g_variant_iter_next(iter, "i", &uid))
+		fw_lockdown_whitelist_addUid(whitelist, uid);
+	    g_variant_iter_free(iter);
+	    continue;
+	}
+
+	g_variant_get(result, "(as)", &iter);
+	while (g_variant_iter_next(iter, "&s", &str)) {
+	    if (i == 0)
+		fw_lockdown_whitelist_addCommand(whitelist, str);
+	    else if (i == 1)
+		fw_lockdown_whitelist_addContext(whitelist, str);
+	    else
+		fw_lockdown_whitelist_addUser(whitelist, str);
+	}
+	g_variant_iter_free(iter);
+    }
+    g_object_unref(batch);
+
+    return whitelist;
+}
+
+/**
+ * fw_client_reconcileLockdownWhitelist:
+ * @obj: (type FWClient*): a FWClient instance
+ * @desired: (type FWLockdownWhitelist*): desired runtime lockdown
+ *   whitelist
+ *
+ * Changes the runtime lockdown whitelist to @desired with the minimal
+ * number of add and remove calls. The calls are pipelined, failed calls
+ * are reported and do not stop the others.
+ *
+ * Returns: (type gboolean): TRUE if all calls succeeded
+ */
+gboolean
+fw_client_reconcileLockdownWhitelist(FWClient *obj,
+				     FWLockdownWhitelist *desired)
+{
+    FWClientPrivate *priv = FW_CLIENT_GET_PRIVATE(obj);
+    FWLockdownWhitelist *current;
+    FWBatch *batch;
+    gboolean ret;
+
+#ifdef FW_DEBUG
+    g_printerr("fw_client_reconcileLockdownWhitelist(%u items)\n",
+	       fw_lockdown_whitelist_length(desired));
+#endif
+
+    current = fw_client_getLockdownWhitelist(obj);
+    if (current == NULL)
+	return FALSE;
+
+    batch = _fw_client_batch_new(priv, FW_LIMITER_PRIORITY_NORMAL);
+    fw_lockdown_whitelist_queueDiff(current, desired, batch);
+    ret = _fw_client_batch_run(priv, batch);
+
+    g_object_unref(batch);
+    g_object_unref(current);
+
+    return ret;
+}
+
@@ -31,6 +31,15 @@
 #include "fw_ipset.h"
 #include "fw_helper.h"
 #include "fw_config.h"
+#include "fw_direct_rule_set.h"
+#include "fw_passthrough_set.h"
+#include "fw_service_cache.h"
+#include "fw_expiration_tracker.h"
+#include "fw_limiter.h"
+#include "fw_histogram.h"
+#include "fw_runtime_diff.h"
+#include "fw_lockdown_whitelist.h"
+#include "fw_icmp_catalogue.h"
 
 #define FW_CLIENT_TYPE           (fw_client_get_type())
 #define FW_CLIENT(obj)           (G_TYPE_CHECK_INSTANCE_CAST((obj), FW_CLIENT_TYPE, FWClient))
@@ -57,15 +66,41 @@ void fw_client_authorizeAll(FWClient *obj);
 /* config */
 
 FWConfig *fw_client_config(FWClient *obj);
+GDBusConnection *fw_client_getConnection(FWClient *obj);
+
+/* reconnect */
+
+gboolean fw_client_isConnected(FWClient *obj);
+
+guint fw_client_addRuntimeIntent(FWClient *obj, const gchar *interface, const gchar *method_name, GVariant *parameters);
+gboolean fw_client_removeRuntimeIntent(FWClient *obj, guint id);
+void fw_client_clearRuntimeIntents(FWClient *obj);
+gboolean fw_client_replayRuntimeIntents(FWClient *obj);
+
+/* admission control */
+
+FWLimiter *fw_client_getLimiter(FWClient *obj);
+
+/* coalesced calls */
+
+guint64 fw_client_getCoalescedCalls(FWClient *obj);
 
 /* reload */
 
 void fw_client_reload(FWClient *obj);
 void fw_client_completeReload(FWClient *obj);
+void fw_client_reloadAsync(FWClient *obj, GCancellable *cancellable, GAsyncReadyCallback callback, gpointer user_data);
+gboolean fw_client_reloadFinish(FWClient *obj, GAsyncResult *result, GError **error);
+void fw_client_completeReloadAsync(FWClient *obj, GCancellable *cancellable, GAsyncReadyCallback callback, gpointer user_data);
+gboolean fw_client_completeReloadFinish(FWClient *obj, GAsyncResult *result, GError **error);
+FWHistogram *fw_client_getReloadHistogram(FWClient *obj);
+FWHistogram *fw_client_getCompleteReloadHistogram(FWClient *obj);
 
 /* runtime to permanent */
 
 void fw_client_runtimeToPermanent(FWClient *obj);
+FWRuntimeDiff *fw_client_diffRuntimePermanent(FWClient *obj);
+gboolean fw_client_applyRuntimeDiff(FWClient *obj, FWRuntimeDiff *diff, GList *hunks);
 
 /* properties */
 
@@ -84,15 +119,32 @@ gboolean fw_client_queryPanicMode(FWClient *obj);
 /* list functions */
 
 FWZone *fw_client_getZoneSettings(FWClient *obj, const gchar *zone);
+void fw_client_getZoneSettingsAsync(FWClient *obj, const gchar *zone, GCancellable *cancellable, GAsyncReadyCallback callback, gpointer user_data);
+FWZone *fw_client_getZoneSettingsFinish(FWClient *obj, GAsyncResult *result, GError **error);
 GList *fw_client_listServices(FWClient *obj);
+gchar **fw_client_listServicesStrv(FWClient *obj);
 FWService *fw_client_getServiceSettings(FWClient *obj, const gchar *service);
+
+/* effective settings of zones, with the services expanded */
+
+FWServiceCache *fw_client_getServiceCache(FWClient *obj);
+FWPortList *fw_client_getEffectivePorts(FWClient *obj, const gchar *zone);
+FWPortList *fw_client_getEffectiveSourcePorts(FWClient *obj, const gchar *zone);
+GList *fw_client_getEffectiveProtocols(FWClient *obj, const gchar *zone);
+GList *fw_client_getEffectiveModules(FWClient *obj, const gchar *zone);
 GList *fw_client_listIPSets(FWClient *obj);
 FWIPSet *fw_client_getIPSetSettings(FWClient *obj, const gchar *ipset);
 GList *fw_client_listIcmpTypes(FWClient *obj);
 FWIcmpType *fw_client_getIcmpTypeSettings(FWClient *obj, const gchar *icmptype);
+FWIcmpCatalogue *fw_client_getIcmpCatalogue(FWClient *obj);
 GList *fw_client_listHelpers(FWClient *obj);
 FWHelper *fw_client_getHelperSettings(FWClient *obj, const gchar *helper);
 
+/* timed runtime entries, tracked until they expire */
+
+void fw_client_setExpirationFunc(FWClient *obj, FWExpirationFunc func, gpointer user_data, GDestroyNotify destroy);
+GList *fw_client_getPendingExpirations(FWClient *obj);
+
 /* default zone */
 
 const gchar* fw_client_getDefaultZone(FWClient *obj);
@@ -101,7 +153,10 @@ void fw_client_setDefaultZone(FWClient *obj, const gchar *zone);
 /* zone */
 
 GList *fw_client_getZones(FWClient *obj);
+gchar **fw_client_getZonesStrv(FWClient *obj);
 GHashTable *fw_client_getActiveZones(FWClient *obj);
+void fw_client_getActiveZonesAsync(FWClient *obj, GCancellable *cancellable, GAsyncReadyCallback callback, gpointer user_data);
+GHashTable *fw_client_getActiveZonesFinish(FWClient *obj, GAsyncResult *result, GError **error);
 const gchar *fw_client_getZoneOfInterface(FWClient *obj, const gchar *interface);
 const gchar *fw_client_getZoneOfSource(FWClient *obj, const gchar *source);
 /* isImmutableis is deprecated since some time and is always returning FALSE */
@@ -112,6 +167,7 @@ const gchar *fw_client_addInterface(FWClient *obj, const gchar *zone, const gcha
 /* changeZone is deprecated and should not be used anymore */
 const gchar *fw_client_changeZoneOfInterface(FWClient *obj, const gchar *zone, const gchar *interface);
 GList *fw_client_getInterfaces(FWClient *obj, const gchar *zone);
+gchar **fw_client_getInterfacesStrv(FWClient *obj, const gchar *zone);
 gboolean fw_client_queryInterface(FWClient *obj, const gchar *zone, const gchar *interface);
 const gchar *fw_client_removeInterface(FWClient *obj, const gchar *zone, const gchar *interface);
 
@@ -120,6 +176,7 @@ const gchar *fw_client_removeInterface(FWClient *obj, const gchar *zone, const g
 const gchar *fw_client_addSource(FWClient *obj, const gchar *zone, const gchar *source);
 const gchar *fw_client_changeZoneOfSource(FWClient *obj, const gchar *zone, const gchar *source);
 GList *fw_client_getSources(FWClient *obj, const gchar *zone);
+gchar **fw_client_getSourcesStrv(FWClient *obj, const gchar *zone);
 gboolean fw_client_querySource(FWClient *obj, const gchar *zone, const gchar *source);
 const gchar *fw_client_removeSource(FWClient *obj, const gchar *zone, const gchar *source);
 
@@ -127,6 +184,7 @@ const gchar *fw_client_removeSource(FWClient *obj, const gchar *zone, const gcha
 
 const gchar *fw_client_addRichRule(FWClient *obj, const gchar *zone, const gchar *rule, gint32 timeout);
 GList *fw_client_getRichRules(FWClient *obj, const gchar *zone);
+gchar **fw_client_getRichRulesStrv(FWClient *obj, const gchar *zone);
 gboolean fw_client_queryRichRule(FWClient *obj, const gchar *zone, const gchar *rule);
 const gchar *fw_client_removeRichRule(FWClient *obj, const gchar *zone, const gchar *rule);
 
@@ -134,20 +192,39 @@ const gchar *fw_client_removeRichRule(FWClient *obj, const gchar *zone, const gc
 
 const gchar *fw_client_addService(FWClient *obj, const gchar *zone, const gchar *service, gint32 timeout);
 GList *fw_client_getServices(FWClient *obj, const gchar *zone);
+gchar **fw_client_getServicesStrv(FWClient *obj, const gchar *zone);
 gboolean fw_client_queryService(FWClient *obj, const gchar *zone, const gchar *service);
 const gchar *fw_client_removeService(FWClient *obj, const gchar *zone, const gchar *service);
+void fw_client_addServiceAsync(FWClient *obj, const gchar *zone, const gchar *service, gint32 timeout, GCancellable *cancellable, GAsyncReadyCallback callback, gpointer user_data);
+const gchar *fw_client_addServiceFinish(FWClient *obj, GAsyncResult *result, GError **error);
+void fw_client_queryServiceAsync(FWClient *obj, const gchar *zone, const gchar *service, GCancellable *cancellable, GAsyncReadyCallback callback, gpointer user_data);
+gboolean fw_client_queryServiceFinish(FWClient *obj, GAsyncResult *result, GError **error);
+void fw_client_removeServiceAsync(FWClient *obj, const gchar *zone, const gchar *service, GCancellable *cancellable, GAsyncReadyCallback callback, gpointer user_data);
+const gchar *fw_client_removeServiceFinish(FWClient *obj, GAsyncResult *result, GError **error);
+void fw_client_getServicesStrvAsync(FWClient *obj, const gchar *zone, GCancellable *cancellable, GAsyncReadyCallback callback, gpointer user_data);
+gchar **fw_client_getServicesStrvFinish(FWClient *obj, GAsyncResult *result, GError **error);
 
 /* ports */
 
 const gchar *fw_client_addPort(FWClient *obj, const gchar *zone, const gchar *port, const gchar *protocol, gint32 timeout);
 GList *fw_client_getPorts(FWClient *obj, const gchar *zone);
+gchar **fw_client_getPortsStrv(FWClient *obj, const gchar *zone);
 gboolean fw_client_queryPort(FWClient *obj, const gchar *zone, const gchar *port, const gchar *protocol);
 const gchar *fw_client_removePort(FWClient *obj, const gchar *zone, const gchar *port, const gchar *protocol);
+void fw_client_addPortAsync(FWClient *obj, const gchar *zone, const gchar *port, const gchar *protocol, gint32 timeout, GCancellable *cancellable, GAsyncReadyCallback callback, gpointer user_data);
+const gchar *fw_client_addPortFinish(FWClient *obj, GAsyncResult *result, GError **error);
+void fw_client_queryPortAsync(FWClient *obj, const gchar *zone, const gchar *port, const gchar *protocol, GCancellable *cancellable, GAsyncReadyCallback callback, gpointer user_data);
+gboolean fw_client_queryPortFinish(FWClient *obj, GAsyncResult *result, GError **error);
+void fw_client_removePortAsync(FWClient *obj, const gchar *zone, const gchar *port, const gchar *protocol, GCancellable *cancellable, GAsyncReadyCallback callback, gpointer user_data);
+const gchar *fw_client_removePortFinish(FWClient *obj, GAsyncResult *result, GError **error);
+void fw_client_getPortsStrvAsync(FWClient *obj, const gchar *zone, GCancellable *cancellable, GAsyncReadyCallback callback, gpointer user_data);
+gchar **fw_client_getPortsStrvFinish(FWClient *obj, GAsyncResult *result, GError **error);
 
 /* protocols */
 
 const gchar *fw_client_addProtocol(FWClient *obj, const gchar *zone, const gchar *protocol, gint32 timeout);
 GList *fw_client_getProtocols(FWClient *obj, const gchar *zone);
+gchar **fw_client_getProtocolsStrv(FWClient *obj, const gchar *zone);
 gboolean fw_client_queryProtocol(FWClient *obj, const gchar *zone, const gchar *protocol);
 const gchar *fw_client_removeProtocol(FWClient *obj, const gchar *zone, const gchar *protocol);
 
@@ -155,6 +232,7 @@ const gchar *fw_client_removeProtocol(FWClient *obj, const gchar *zone, const gc
 
 const gchar *fw_client_addSourcePort(FWClient *obj, const gchar *zone, const gchar *port, const gchar *protocol, gint32 timeout);
 GList *fw_client_getSourcePorts(FWClient *obj, const gchar *zone);
+gchar **fw_client_getSourcePortsStrv(FWClient *obj, const gchar *zone);
 gboolean fw_client_querySourcePort(FWClient *obj, const gchar *zone, const gchar *port, const gchar *protocol);
 const gchar *fw_client_removeSourcePort(FWClient *obj, const gchar *zone, const gchar *port, const gchar *protocol);
 
@@ -168,6 +246,7 @@ const gchar *fw_client_removeMasquerade(FWClient *obj, const gchar *zone);
 
 const gchar *fw_client_addForwardPort(FWClient *obj, const gchar *zone, const gchar *port, const gchar *protocol, const gchar *toport, const gchar *toaddr, gint32 timeout);
 GList *fw_client_getForwardPorts(FWClient *obj, const gchar *zone);
+gchar **fw_client_getForwardPortsStrv(FWClient *obj, const gchar *zone);
 gboolean fw_client_queryForwardPort(FWClient *obj, const gchar *zone, const gchar *port, const gchar *protocol, const gchar *toport, const gchar *toaddr);
 const gchar *fw_client_removeForwardPort(FWClient *obj, const gchar *zone, const gchar *port, const gchar *protocol, const gchar *toport, const gchar *toaddr);
 
@@ -175,6 +254,7 @@ const gchar *fw_client_removeForwardPort(FWClient *obj, const gchar *zone, const
 
 const gchar *fw_client_addIcmpBlock(FWClient *obj,  const gchar *zone,  const gchar *icmptype, gint32 timeout);
 GList *fw_client_getIcmpBlocks(FWClient *obj,  const gchar *zone);
+gchar **fw_client_getIcmpBlocksStrv(FWClient *obj,  const gchar *zone);
 gboolean fw_client_queryIcmpBlock(FWClient *obj,  const gchar *zone,  const gchar *icmptype);
 const gchar *fw_client_removeIcmpBlock(FWClient *obj,  const gchar *zone,  const gchar *icmptype);
 
@@ -199,10 +279,16 @@ void fw_client_removeRule(FWClient *obj, const gchar *ipv, const gchar *table, c
 void fw_client_removeRules(FWClient *obj, const gchar *ipv, const gchar *table, const gchar *chain);
 
 GList *fw_client_getAllRules(FWClient *obj);
+void fw_client_getAllRulesAsync(FWClient *obj, GCancellable *cancellable, GAsyncReadyCallback callback, gpointer user_data);
+GList *fw_client_getAllRulesFinish(FWClient *obj, GAsyncResult *result, GError **error);
+GVariant *fw_client_getAllRulesVariant(FWClient *obj);
+
+FWDirectRuleSet *fw_client_getDirectRuleSet(FWClient *obj);
+gboolean fw_client_applyDirectRuleSet(FWClient *obj, FWDirectRuleSet *rules);
 
 /* direct passthrough (untracked) */
 
-const gchar *fw_client_passthrough(FWClient *obj, const gchar *ipv, const GList *args);
+gchar *fw_client_passthrough(FWClient *obj, const gchar *ipv, const GList *args);
 
 /* direct passthrough (tracked) */
 
@@ -213,6 +299,9 @@ GList *fw_client_getPassthroughs(FWClient *obj, const gchar *ipv);
 GList *fw_client_getAllPassthroughs(FWClient *obj);
 void fw_client_removeAllPassthroughs(FWClient *obj);
 
+FWPassthroughSet *fw_client_getPassthroughSet(FWClient *obj);
+gboolean fw_client_reconcilePassthroughs(FWClient *obj, FWPassthroughSet *passthroughs);
+
 /* lockdown */
 
 void fw_client_enableLockdown(FWClient *obj);
@@ -249,4 +338,9 @@ GList *fw_client_getLockdownWhitelistUsers(FWClient *obj);
 gboolean fw_client_queryLockdownWhitelistUser(FWClient *obj, const gchar *user);
 void fw_client_removeLockdownWhitelistUser(FWClient *obj, const gchar *user);
 
+/* lockdown whitelist */
+
+FWLockdownWhitelist *fw_client_getLockdownWhitelist(FWClient *obj);
+gboolean fw_client_reconcileLockdownWhitelist(FWClient *obj, FWLockdownWhitelist *desired);
+
 #endif /* __FW_CLIENT_H__ */
@@ -20,6 +20,7 @@
 
 #include <string.h>
 #include "fw_config.h"
+#include "fw_accounting.h"
 #include "fw_port.h"
 #include "fw_forward_port.h"
 #include "fw_direct_simple_rule.h"
@@ -27,11 +28,42 @@
 #include "fw_args.h"
 #include "fw_passthrough.h"
 #include "fw_types.h"
+#include "fw_batch.h"
+#include "fw_functions.h"
+#include "fw_trace.h"
 
 G_DEFINE_TYPE(FWConfig, fw_config, G_TYPE_OBJECT);
 
 #define FW_CONFIG_GET_PRIVATE(o) (G_TYPE_INSTANCE_GET_PRIVATE((o), FW_CONFIG_TYPE, FWConfigPrivate))
 
+/* config objects handed out by the get*ByName functions */
+enum {
+    FW_CONFIG_CACHE_HELPER,
+    FW_CONFIG_CACHE_ICMPTYPE,
+    FW_CONFIG_CACHE_IPSET,
+    FW_CONFIG_CACHE_SERVICE,
+    FW_CONFIG_CACHE_ZONE,
+    FW_CONFIG_N_CACHES,
+};
+
+static const struct {
+    const gchar *type;		/* as in get<type>ByName */
+    const gchar *interface;
+} fw_config_cache_types[FW_CONFIG_N_CACHES] = {
+    { "Helper", FW_DBUS_INTERFACE_CONFIG_HELPER },
+    { "IcmpType", FW_DBUS_INTERFACE_CONFIG_ICMPTYPE },
+    { "IPSet", FW_DBUS_INTERFACE_CONFIG_IPSET },
+    { "Service", FW_DBUS_INTERFACE_CONFIG_SERVICE },
+    { "Zone", FW_DBUS_INTERFACE_CONFIG_ZONE },
+};
+
+typedef struct {
+    GHashTable *paths;		/* name -> object path */
+    GHashTable *objects;	/* object path -> FWConfig<type> */
+    gboolean seeded;		/* paths has been filled with all names */
+    guint subscription;		/* Renamed and Removed signals */
+} FWConfigCache;
+
 typedef struct {
     /* dbus */
     GDBusConnection *connection;
@@ -46,6 +78,16 @@ typedef struct {
     GDBusProxy *zone_proxy;
     GError *error;
 
+    /* offline backend, NULL if connected to firewalld */
+    FWConfigOffline *offline;
+
+    /* shared config objects, only used with firewalld */
+    FWConfigCache caches[FW_CONFIG_N_CACHES];
+    guint added_subscription;
+    GPtrArray *stale;		/* removed objects, may still be in use */
+    GCancellable *lookups;	/* background path lookups, cancelled with
+				   the instance */
+
     /* properties */
     gboolean quiet;
     gboolean connected;
@@ -72,18 +114,60 @@ enum {
 
 /* static GParamSpec *obj_properties[N_PROPERTIES] = { NULL, }; */
 
+static void _fw_config_dbus_connect(FWConfigPrivate *fw);
+static void _fw_config_properties_changed(GDBusProxy *proxy,
+					  GVariant *changed_properties,
+					  GStrv invalidated_properties,
+					  gpointer user_data);
+
 FWConfig *
 fw_config_new()
 {
-    return g_object_new(FW_CONFIG_TYPE, NULL);
+    FWConfig *obj = g_object_new(FW_CONFIG_TYPE, NULL);
+    FWConfigPrivate *fw = FW_CONFIG_GET_PRIVATE(obj);
+
+    _fw_config_dbus_connect(fw);
+
+    /* notify property changes */
+    if (fw->properties_proxy != NULL)
+	g_signal_connect(fw->properties_proxy,
+			 "g-properties-changed",
+			 G_CALLBACK (_fw_config_properties_changed),
+			 obj);
+
+    return obj;
 }
 
-static void _fw_config_dbus_connect(FWConfigPrivate *fw);
+/**
+ * fw_config_new_offline:
+ * @default_dir: (type filename) (allow-none): firewalld default
+ *   configuration, NULL for /usr/lib/firewalld
+ * @config_dir: (type filename) (allow-none): firewalld user configuration,
+ *   NULL for /etc/firewalld
+ *
+ * Creates a FWConfig that reads and writes the XML configuration directly
+ * instead of talking to firewalld. The configuration is loaded once here,
+ * changes are written to @config_dir.
+ *
+ * Returns: (transfer full) (type FWConfig*)
+ */
+FWConfig *
+fw_config_new_offline(const gchar *default_dir,
+		      const gchar *config_dir)
+{
+    FWConfig *obj = g_object_new(FW_CONFIG_TYPE, NULL);
+    FWConfigPrivate *fw = FW_CONFIG_GET_PRIVATE(obj);
+
+    fw->offline = fw_config_offline_new(default_dir, config_dir);
+
+    return obj;
+}
 
 static void
 fw_config_init(FWConfig *obj)
 {
     FWConfigPrivate *fw = FW_CONFIG_GET_PRIVATE(obj);
+    guint i;
 
     /* init vars */
     fw->connection = NULL;
@@ -97,25 +181,23 @@ fw_config_init(FWConfig *obj)
     fw->service_proxy = NULL;
     fw->zone_proxy = NULL;
     fw->error = NULL;
+    fw->offline = NULL;
+
+    for (i=0; i<FW_CONFIG_N_CACHES; i++) {
+	fw->caches[i].paths = g_hash_table_new_full(g_str_hash, g_str_equal,
+						    g_free, g_free);
+	fw->caches[i].objects = g_hash_table_new_full(g_str_hash,
+						      g_str_equal, g_free,
+						      g_object_unref);
+	fw->caches[i].seeded = FALSE;
+	fw->caches[i].subscription = 0;
+    }
+    fw->added_subscription = 0;
+    fw->stale = g_ptr_array_new_with_free_func(g_object_unref);
+    fw->lookups = g_cancellable_new();
 
     fw->quiet = FALSE;
     fw->connected = FALSE;
-
-    /* connect to system dbus */
-    fw->connection = g_bus_get_sync(G_BUS_TYPE_SYSTEM, NULL, &fw->error);
-    if (fw->error != NULL) {
-        g_print("ERROR: Failed to connect to system bus: %s",
-		fw->error->message);
-	return;
-    }
-
-#ifdef FW_DEBUG
-    gchar *conn_name;
-    g_object_get(fw->connection, "unique-name", &conn_name, NULL);
-    g_free(conn_name);
-#endif
-
-    _fw_config_dbus_connect(fw);
 }
 
 static void
@@ -143,14 +225,177 @@ _fw_config_signal_receiver(GDBusProxy *proxy,
     g_free(str);
 }
 
+/* name of a cached object path */
+static const gchar *
+_fw_config_cache_find_name(FWConfigCache *cache,
+			   const gchar *path)
+{
+    GHashTableIter iter;
+    gpointer key, value;
+
+    g_hash_table_iter_init(&iter, cache->paths);
+    while (g_hash_table_iter_next(&iter, &key, &value)) {
+	if (strcmp(value, path) == 0)
+	    return key;
+    }
+
+    return NULL;
+}
+
+static void
+_fw_config_cache_object_signal(GDBusConnection *connection,
+			       const gchar *sender_name,
+			       const gchar *object_path,
+			       const gchar *interface_name,
+			       const gchar *signal_name,
+			       GVariant *parameters,
+			       gpointer user_data)
+{
+    FWConfigPrivate *fw = user_data;
+    FWConfigCache *cache = NULL;
+    const gchar *name, *old_name;
+    gpointer key, object;
+    guint i;
+
+    for (i=0; i<FW_CONFIG_N_CACHES; i++) {
+	if (strcmp(interface_name, fw_config_cache_types[i].interface) == 0)
+	    cache = &fw->caches[i];
+    }
+    if (cache == NULL ||
+	!g_variant_is_of_type(parameters, G_VARIANT_TYPE("(s)")))
+	return;
+    g_variant_get(parameters, "(&s)", &name);
+
+    if (strcmp(signal_name, "Removed") == 0) {
+	old_name = _fw_config_cache_find_name(cache, object_path);
+	if (old_name != NULL)
+	    g_hash_table_remove(cache->paths, old_name);
+	g_hash_table_remove(cache->paths, name);
+	/* the object has been handed out without a reference */
+	if (g_hash_table_lookup_extended(cache->objects, object_path,
+					 &key, &object)) {
+	    g_hash_table_steal(cache->objects, object_path);
+	    g_free(key);
+	    g_ptr_array_add(fw->stale, object);
+	}
+    } else if (strcmp(signal_name, "Renamed") == 0) {
+	old_name = _fw_config_cache_find_name(cache, object_path);
+	if (old_name != NULL)
+	    g_hash_table_remove(cache->paths, old_name);
+	g_hash_table_insert(cache->paths, g_strdup(name),
+			    g_strdup(object_path));
+    }
+}
+
+typedef struct {
+    FWConfigPrivate *fw;
+    guint kind;
+    gchar *name;
+} FWConfigCacheLookup;
+
+static void
+_fw_config_cache_lookup_done(GObject *source,
+			     GAsyncResult *res,
+			     gpointer user_data)
+{
+    FWConfigCacheLookup *lookup = user_data;
+    GError *error = NULL;
+    GVariant *result;
+    gchar *path;
+
+    result = g_dbus_proxy_call_finish(G_DBUS_PROXY(source), res, &error);
+
+    /* the instance is gone, do not touch lookup->fw */
+    if (g_error_matches(error, G_IO_ERROR, G_IO_ERROR_CANCELLED)) {
+	g_error_free(error);
+	g_free(lookup->name);
+	g_slice_free(FWConfigCacheLookup, lookup);
+	return;
+    }
+    g_clear_error(&error);
+
+    if (result != NULL) {
+	g_variant_get(result, "(o)", &path);
+	g_hash_table_insert(lookup->fw->caches[lookup->kind].paths,
+			    lookup->name, path);
+	g_variant_unref(result);
+    } else {
+	g_free(lookup->name);
+    }
+    g_slice_free(FWConfigCacheLookup, lookup);
+}
+
+static void
+_fw_config_cache_added_signal(GDBusConnection *connection,
+			      const gchar *sender_name,
+			      const gchar *object_path,
+			      const gchar *interface_name,
+			      const gchar *signal_name,
+			      GVariant *parameters,
+			      gpointer user_data)
+{
+    FWConfigPrivate *fw = user_data;
+    FWConfigCacheLookup *lookup;
+    const gchar *name;
+    gchar *method;
+    guint i;
+
+    if (!g_variant_is_of_type(parameters, G_VARIANT_TYPE("(s)")))
+	return;
+    g_variant_get(parameters, "(&s)", &name);
+
+    for (i=0; i<FW_CONFIG_N_CACHES; i++) {
+	method = g_strconcat(fw_config_cache_types[i].type, "Added", NULL);
+	if (strcmp(signal_name, method) == 0)
+	    break;
+	g_free(method);
+    }
+    if (i >= FW_CONFIG_N_CACHES)
+	return;
+    g_free(method);
+
+    /* added with this instance or not needed yet */
+    if (!fw->caches[i].seeded ||
+	g_hash_table_lookup(fw->caches[i].paths, name) != NULL)
+	return;
+
+    /* look up the path in the background, a get<type>ByName before the
+       reply just does its own call */
+    lookup = g_slice_new0(FWConfigCacheLookup);
+    lookup->fw = fw;
+    lookup->kind = i;
+    lookup->name = g_strdup(name);
+    method = g_strdup_printf("get%sByName", fw_config_cache_types[i].type);
+    g_dbus_proxy_call(fw->proxy, method, g_variant_new("(s)", name),
+		      G_DBUS_CALL_FLAGS_NONE, -1, fw->lookups,
+		      _fw_config_cache_lookup_done, lookup);
+    g_free(method);
+}
+
 static void
 _fw_config_dbus_connect(FWConfigPrivate *fw)
 {
+    guint i;
+
     _fw_config_reset_error(fw);
 
+    /* connect to system dbus */
+    fw->connection = g_bus_get_sync(G_BUS_TYPE_SYSTEM, NULL, &fw->error);
+    if (fw->error != NULL) {
+        g_print("ERROR: Failed to connect to system bus: %s",
+		fw->error->message);
+	return;
+    }
+
+#ifdef FW_DEBUG
+    gchar *conn_name;
+    g_object_get(fw->connection, "unique-name", &conn_name, NULL);
+    g_free(conn_name);
+#endif
+
     /* create syncroneous proxies */
     fw->proxy = g_dbus_proxy_new_sync(fw->connection,
-				      G_DBUS_PROXY_FLAGS_NONE,
+				      G_DBUS_PROXY_FLAGS_DO_NOT_LOAD_PROPERTIES,
 				      NULL,
 				      FW_DBUS_NAME,
 				      FW_DBUS_PATH_CONFIG,
@@ -171,7 +416,7 @@ _fw_config_dbus_connect(FWConfigPrivate *fw)
 		     NULL);
 
     fw->direct_proxy = g_dbus_proxy_new_sync(fw->connection,
-					     G_DBUS_PROXY_FLAGS_NONE,
+					     G_DBUS_PROXY_FLAGS_DO_NOT_LOAD_PROPERTIES,
 					     NULL,
 					     FW_DBUS_NAME,
 					     FW_DBUS_PATH,
@@ -182,7 +427,7 @@ _fw_config_dbus_connect(FWConfigPrivate *fw)
     g_dbus_proxy_set_default_timeout(fw->direct_proxy, G_MAXINT);
 
     fw->icmptype_proxy = g_dbus_proxy_new_sync(fw->connection,
-					       G_DBUS_PROXY_FLAGS_NONE,
+					       G_DBUS_PROXY_FLAGS_DO_NOT_LOAD_PROPERTIES,
 					       NULL,
 					       FW_DBUS_NAME,
 					       FW_DBUS_PATH,
@@ -193,7 +438,7 @@ _fw_config_dbus_connect(FWConfigPrivate *fw)
     g_dbus_proxy_set_default_timeout(fw->icmptype_proxy, G_MAXINT);
 
     fw->ipset_proxy = g_dbus_proxy_new_sync(fw->connection,
-					    G_DBUS_PROXY_FLAGS_NONE,
+					    G_DBUS_PROXY_FLAGS_DO_NOT_LOAD_PROPERTIES,
 					    NULL,
 					    FW_DBUS_NAME,
 					    FW_DBUS_PATH,
@@ -204,7 +449,7 @@ _fw_config_dbus_connect(FWConfigPrivate *fw)
     g_dbus_proxy_set_default_timeout(fw->ipset_proxy, G_MAXINT);
 
     fw->policies_proxy = g_dbus_proxy_new_sync(fw->connection,
-					       G_DBUS_PROXY_FLAGS_NONE,
+					       G_DBUS_PROXY_FLAGS_DO_NOT_LOAD_PROPERTIES,
 					       NULL,
 					       FW_DBUS_NAME,
 					       FW_DBUS_PATH,
@@ -215,7 +460,7 @@ _fw_config_dbus_connect(FWConfigPrivate *fw)
     g_dbus_proxy_set_default_timeout(fw->policies_proxy, G_MAXINT);
 
     fw->service_proxy = g_dbus_proxy_new_sync(fw->connection,
-					      G_DBUS_PROXY_FLAGS_NONE,
+					      G_DBUS_PROXY_FLAGS_DO_NOT_LOAD_PROPERTIES,
 					      NULL,
 					      FW_DBUS_NAME,
 					      FW_DBUS_PATH,
@@ -226,7 +471,7 @@ _fw_config_dbus_connect(FWConfigPrivate *fw)
     g_dbus_proxy_set_default_timeout(fw->service_proxy, G_MAXINT);
 
     fw->zone_proxy = g_dbus_proxy_new_sync(fw->connection,
-					   G_DBUS_PROXY_FLAGS_NONE,
+					   G_DBUS_PROXY_FLAGS_DO_NOT_LOAD_PROPERTIES,
 					   NULL,
 					   FW_DBUS_NAME,
 					   FW_DBUS_PATH,
@@ -236,6 +481,31 @@ _fw_config_dbus_connect(FWConfigPrivate *fw)
     g_assert(fw->zone_proxy != NULL);
     g_dbus_proxy_set_default_timeout(fw->zone_proxy, G_MAXINT);
 
+    /* firewalld properties, fetched once with GetAll and kept current */
+    fw->properties_proxy = g_dbus_proxy_new_sync(
+	fw->connection,
+	G_DBUS_PROXY_FLAGS_GET_INVALIDATED_PROPERTIES |
+	G_DBUS_PROXY_FLAGS_DO_NOT_CONNECT_SIGNALS,
+	NULL,
+	FW_DBUS_NAME,
+	FW_DBUS_PATH,
+	FW_DBUS_INTERFACE,
+	NULL,
+	&fw->error);
+    g_assert(fw->properties_proxy != NULL);
+
+    /* keep the config object cache coherent */
+    fw->added_subscription = g_dbus_connection_signal_subscribe(
+	fw->connection, FW_DBUS_NAME, FW_DBUS_INTERFACE_CONFIG, NULL,
+	FW_DBUS_PATH_CONFIG, NULL, G_DBUS_SIGNAL_FLAGS_NONE,
+	_fw_config_cache_added_signal, fw, NULL);
+    for (i=0; i<FW_CONFIG_N_CACHES; i++) {
+	fw->caches[i].subscription = g_dbus_connection_signal_subscribe(
+	    fw->connection, FW_DBUS_NAME, fw_config_cache_types[i].interface,
+	    NULL, NULL, NULL, G_DBUS_SIGNAL_FLAGS_NONE,
+	    _fw_config_cache_object_signal, fw, NULL);
+    }
+
     fw->connected = TRUE;
 
     /* do not terminate if connection has been closed */
@@ -246,9 +516,29 @@ static void
 fw_config_finalize(GObject *obj)
 {
     FWConfigPrivate *fw = FW_CONFIG_GET_PRIVATE(obj);
+    guint i;
 
     _fw_config_reset_error(fw);
 
+    if (fw->offline != NULL)
+	g_object_unref(fw->offline);
+
+    /* the replies of the lookups in flight are dropped */
+    g_cancellable_cancel(fw->lookups);
+    g_object_unref(fw->lookups);
+
+    if (fw->added_subscription != 0)
+	g_dbus_connection_signal_unsubscribe(fw->connection,
+					     fw->added_subscription);
+    for (i=0; i<FW_CONFIG_N_CACHES; i++) {
+	if (fw->caches[i].subscription != 0)
+	    g_dbus_connection_signal_unsubscribe(fw->connection,
+						 fw->caches[i].subscription);
+	g_hash_table_destroy(fw->caches[i].paths);
+	g_hash_table_destroy(fw->caches[i].objects);
+    }
+    g_ptr_array_unref(fw->stale);
+
     /* disconnect */
     /***/
 
@@ -285,6 +575,8 @@ fw_config_get_property(GObject *obj,
 		       GParamSpec *pspec)
 {
     FWConfigPrivate *fw = FW_CONFIG_GET_PRIVATE(obj);
+    GVariant *variant;
+    gchar *name;
 
     switch (property_id) {
 
@@ -300,12 +592,49 @@ fw_config_get_property(GObject *obj,
         break;
 #endif
 
+    case PROP_VERSION:
+    case PROP_INTERFACE_VERSION:
+    case PROP_STATE:
+    case PROP_IPV4:
+    case PROP_IPV6:
+    case PROP_IPV6_RPFILTER:
+    case PROP_BRIDGE:
+    case PROP_IPSET:
+    case PROP_IPSETTYPES:
+    case PROP_NF_CONNTRACK_HELPER_SETTING:
+    case PROP_NF_CONNTRACK_HELPERS:
+    case PROP_NF_NAT_HELPERS:
+    case PROP_IPV4_ICMPTYPES:
+    case PROP_IPV6_ICMPTYPES:
+	/* firewalld properties, see fw_client_get_property */
+	if (fw->properties_proxy == NULL)
+	    break;
+	name = g_strdelimit(g_strdup(pspec->name), "-", '_');
+	variant = g_dbus_proxy_get_cached_property(fw->properties_proxy,
+						   name);
+	g_free(name);
+	if (variant != NULL) {
+	    fw_variant_to_value(variant, value);
+	    g_variant_unref(variant);
+	}
+	break;
+
     default:
         G_OBJECT_WARN_INVALID_PROPERTY_ID(obj, property_id, pspec);
         break;
     }
 }
 
+static void
+_fw_config_properties_changed(GDBusProxy *proxy,
+			      GVariant *changed_properties,
+			      GStrv invalidated_properties,
+			      gpointer user_data)
+{
+    fw_notify_properties(user_data, changed_properties,
+			 (const gchar **) invalidated_properties);
+}
+
 static void
 fw_config_class_init(FWConfigClass *fw_config_class)
 {
@@ -359,6 +688,10 @@ fw_config_class_init(FWConfigClass *fw_config_class)
 	obj_class, PROP_BRIDGE,
 	g_param_spec_boolean("BRIDGE", "", "", FALSE,
 			    G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+    g_object_class_install_property(
+	obj_class, PROP_IPSET,
+	g_param_spec_boolean("IPSet", "", "", FALSE,
+			     G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
     g_object_class_install_property(
 	obj_class, PROP_IPSETTYPES,
 	g_param_spec_boxed("IPSetTypes", "", "", G_TYPE_PTR_ARRAY,
@@ -371,6 +704,10 @@ fw_config_class_init(FWConfigClass *fw_config_class)
 	obj_class, PROP_NF_CONNTRACK_HELPERS,
 	g_param_spec_boxed("nf-conntrack-helpers", "", "", G_TYPE_PTR_ARRAY,
 			   G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+    g_object_class_install_property(
+	obj_class, PROP_NF_NAT_HELPERS,
+	g_param_spec_boxed("nf-nat-helpers", "", "", G_TYPE_PTR_ARRAY,
+			   G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
     /*
      * initialize properties
      */
@@ -396,6 +733,7 @@ fw_config_class_init(FWConfigClass *fw_config_class)
 				      obj_properties);
 */
     g_type_class_add_private(obj_class, sizeof(FWConfigPrivate));
+    fw_accounting_register(obj_class, sizeof(FWConfigPrivate));
 }
 
 GVariant *
@@ -408,13 +746,26 @@ _fw_config_proxy_call_sync(FWConfigPrivate *fw,
 
     _fw_config_reset_error(fw);
 
-    result = g_dbus_proxy_call_sync(proxy,
-				    method_name,
-				    parameters,
-				    G_DBUS_CALL_FLAGS_NONE,
-				    -1,
-				    NULL,
-				    &fw->error);
+    FW_TRACE_CALL_START(method_name, (fw->offline != NULL) ?
+			FW_DBUS_PATH_CONFIG : FW_TRACE_PROXY_PATH(proxy),
+			parameters);
+
+    if (fw->offline != NULL)
+	result = fw_config_offline_call(fw->offline, FW_DBUS_PATH_CONFIG,
+					method_name, parameters, &fw->error);
+    else
+	result = g_dbus_proxy_call_sync(proxy,
+					method_name,
+					parameters,
+					G_DBUS_CALL_FLAGS_NONE,
+					-1,
+					NULL,
+					&fw->error);
+
+    FW_TRACE_CALL_DONE(method_name, (fw->offline != NULL) ?
+		       FW_DBUS_PATH_CONFIG : FW_TRACE_PROXY_PATH(proxy),
+		       result, fw->error);
+
     if (fw->error != NULL) {
         g_print(_("ERROR: %s failed: %s\n"), method_name, fw->error->message);
     }
@@ -491,7 +842,7 @@ _fw_config_proxy_call_sync_get_str_list(FWConfigPrivate *fw,
 					const gchar *method_name,
 					GVariant *parameters)
 {
-    GVariant *variant, *element;
+    GVariant *variant, *reply, *element;
     GVariantIter iter;
     GList *list = NULL;
     gchar *str;
@@ -505,15 +856,18 @@ _fw_config_proxy_call_sync_get_str_list(FWConfigPrivate *fw,
     if (strncmp(g_variant_get_type_string(variant), "(as)", 4) != 0)
     {
 	g_print("!(as): %s", g_variant_get_type_string(variant));
+	g_variant_unref(variant);
 	return list;
     }
 
     /* get as from (as) */
-    variant = g_variant_get_child_value(variant, 0);
+    reply = variant;
+    variant = g_variant_get_child_value(reply, 0);
+    g_variant_unref(reply);
 
     if (g_variant_iter_init(&iter, variant)) {
 	while ((element = g_variant_iter_next_value(&iter)) != NULL) {
-	    g_variant_get(element, "s", &str);
+	    g_variant_get(element, "&s", &str);
 	    list = fw_str_list_append(list, str);
 	    g_variant_unref(element);
 	}
@@ -529,7 +883,7 @@ _fw_config_proxy_call_sync_get_obj_list(FWConfigPrivate *fw,
 					const gchar *method_name,
 					GVariant *parameters)
 {
-    GVariant *variant, *element;
+    GVariant *variant, *reply, *element;
     GVariantIter iter;
     GList *list = NULL;
     gchar *str;
@@ -543,15 +897,18 @@ _fw_config_proxy_call_sync_get_obj_list(FWConfigPrivate *fw,
     if (strncmp(g_variant_get_type_string(variant), "(ao)", 4) != 0)
     {
 	g_print("!(as): %s", g_variant_get_type_string(variant));
+	g_variant_unref(variant);
 	return list;
     }
 
     /* get as from (as) */
-    variant = g_variant_get_child_value(variant, 0);
+    reply = variant;
+    variant = g_variant_get_child_value(reply, 0);
+    g_variant_unref(reply);
 
     if (g_variant_iter_init(&iter, variant)) {
 	while ((element = g_variant_iter_next_value(&iter)) != NULL) {
-	    g_variant_get(element, "o", &str);
+	    g_variant_get(element, "&o", &str);
 	    list = fw_str_list_append(list, str);
 	    g_variant_unref(element);
 	}
@@ -567,7 +924,7 @@ _fw_config_proxy_call_sync_get_gint32_list(FWConfigPrivate *fw,
 					   const gchar *method_name,
 					   GVariant *parameters)
 {
-    GVariant *variant, *element;
+    GVariant *variant, *reply, *element;
     GVariantIter iter;
     GList *list = NULL;
     gint32 *i;
@@ -580,11 +937,14 @@ _fw_config_proxy_call_sync_get_gint32_list(FWConfigPrivate *fw,
 
     if (strncmp(g_variant_get_type_string(variant), "(ai)", 4) != 0)
     {
+	g_variant_unref(variant);
 	return list;
     }
 
     /* get ai from (ai) */
-    variant = g_variant_get_child_value(variant, 0);
+    reply = variant;
+    variant = g_variant_get_child_value(reply, 0);
+    g_variant_unref(reply);
 
     if (g_variant_iter_init(&iter, variant)) {
 	while ((element = g_variant_iter_next_value(&iter)) != NULL) {
@@ -598,6 +958,141 @@ _fw_config_proxy_call_sync_get_gint32_list(FWConfigPrivate *fw,
     return list;
 }
 
+/* config object cache */
+
+static gpointer
+_fw_config_cache_new_object(guint kind,
+			    gchar *path)
+{
+    switch (kind) {
+    case FW_CONFIG_CACHE_HELPER:
+	return fw_config_helper_new(path);
+    case FW_CONFIG_CACHE_ICMPTYPE:
+	return fw_config_icmptype_new(path);
+    case FW_CONFIG_CACHE_IPSET:
+	return fw_config_ipset_new(path);
+    case FW_CONFIG_CACHE_SERVICE:
+	return fw_config_service_new(path);
+    case FW_CONFIG_CACHE_ZONE:
+	return fw_config_zone_new(path);
+    }
+
+    return NULL;
+}
+
+/* looks up the paths of all names with a single round trip */
+static void
+_fw_config_cache_seed(FWConfigPrivate *fw,
+		      guint kind)
+{
+    FWConfigCache *cache = &fw->caches[kind];
+    GList *names, *l;
+    FWBatch *batch;
+    gchar *method;
+    guint i;
+
+    method = g_strdup_printf("get%sNames", fw_config_cache_types[kind].type);
+    names = _fw_config_proxy_call_sync_get_str_list(fw, fw->proxy, method,
+						    NULL);
+    g_free(method);
+    if (fw->error != NULL)
+	return;
+
+    method = g_strdup_printf("get%sByName", fw_config_cache_types[kind].type);
+    batch = fw_batch_new(fw->connection);
+    for (l = names; l != NULL; l = l->next)
+	fw_batch_add(batch, FW_DBUS_PATH_CONFIG, FW_DBUS_INTERFACE_CONFIG,
+		     method, g_variant_new("(s)", (gchar *) l->data));
+    fw_batch_run(batch, NULL);
+
+    for (l = names, i = 0; l != NULL; l = l->next, i++) {
+	const GError *error = fw_batch_getError(batch, i);
+	gchar *path;
+
+	if (error != NULL) {
+	    g_print(_("ERROR: %s(%s) failed: %s\n"), method,
+		    (gchar *) l->data, error->message);
+	    continue;
+	}
+	g_variant_get(fw_batch_getResult(batch, i), "(o)", &path);
+	g_hash_table_insert(cache->paths, g_strdup(l->data), path);
+    }
+
+    g_object_unref(batch);
+    g_free(method);
+    fw_str_list_free(names);
+    cache->seeded = TRUE;
+}
+
+/* shared config object of a name, created with the first use */
+static gpointer
+_fw_config_cache_get(FWConfigPrivate *fw,
+		     guint kind,
+		     const gchar *name)
+{
+    FWConfigCache *cache = &fw->caches[kind];
+    gpointer object;
+    gchar *path;
+
+    if (!cache->seeded)
+	_fw_config_cache_seed(fw, kind);
+
+    path = g_hash_table_lookup(cache->paths, name);
+    if (path == NULL) {
+	gchar *method = g_strdup_printf("get%sByName",
+					fw_config_cache_types[kind].type);
+
+	path = (gchar *) _fw_config_proxy_call_sync_get_obj(
+	    fw, fw->proxy, method, g_variant_new("(s)", name));
+	g_free(method);
+	if (path == NULL)
+	    return NULL;
+	g_hash_table_insert(cache->paths, g_strdup(name), path);
+    }
+
+    object = g_hash_table_lookup(cache->objects, path);
+    if (object == NULL) {
+	object = _fw_config_cache_new_object(kind, path);
+	g_hash_table_insert(cache->objects, g_strdup(path), object);
+    }
+
+    return object;
+}
+
+/* remembers the path of a new object */
+static const gchar *
+_fw_config_cache_added(FWConfigPrivate *fw,
+		       guint kind,
+		       const gchar *name,
+		       const gchar *path)
+{
+    if (path != NULL && fw->offline == NULL)
+	g_hash_table_insert(fw->caches[kind].paths, g_strdup(name),
+			    g_strdup(path));
+
+    return path;
+}
+
+/**
+ * fw_config_invalidateCache:
+ * @obj: (type FWConfig*): a FWConfig instance
+ *
+ * Drops the name to object path mapping after a reload of firewalld, it
+ * is filled again with the next lookup. Objects that have been handed out
+ * stay valid.
+ */
+void
+fw_config_invalidateCache(FWConfig *obj)
+{
+    FWConfigPrivate *fw = FW_CONFIG_GET_PRIVATE(obj);
+    guint i;
+
+    for (i=0; i<FW_CONFIG_N_CACHES; i++) {
+	g_hash_table_remove_all(fw->caches[i].paths);
+	fw->caches[i].seeded = FALSE;
+    }
+}
+
 /****************************************************************************/
 /****************************************************************************/
 /****************************************************************************/
@@ -615,10 +1110,13 @@ fw_config_addHelper(FWConfig *obj,
 		    FWHelper *settings)
 {
     FWConfigPrivate *fw = FW_CONFIG_GET_PRIVATE(obj);
+    const gchar *path;
 
-    return _fw_config_proxy_call_sync_get_obj(
+    path = _fw_config_proxy_call_sync_get_obj(
 	fw, fw->proxy, "addHelper",
 	g_variant_new("(sv)", helper, fw_helper_to_variant(settings)));
+
+    return _fw_config_cache_added(fw, FW_CONFIG_CACHE_HELPER, helper, path);
 }
 
 /**
@@ -652,6 +1150,10 @@ fw_config_getHelperNames(FWConfig *obj)
 /**
  * fw_config_getHelperByName:
  *
+ * The object is shared and owned by the FWConfig, it is created with the
+ * first use and kept until firewalld removes it. Take a reference to use
+ * it longer than the FWConfig.
+ *
  * Returns: (transfer none) (allow-none) (type FWConfigHelper*)
  */
 FWConfigHelper *
@@ -659,12 +1161,16 @@ fw_config_getHelperByName(FWConfig *obj,
 			  const gchar *helper)
 {
     FWConfigPrivate *fw = FW_CONFIG_GET_PRIVATE(obj);
+    gchar *path;
+
+    if (fw->offline == NULL)
+	return _fw_config_cache_get(fw, FW_CONFIG_CACHE_HELPER, helper);
 
-    gchar *path = (gchar *) _fw_config_proxy_call_sync_get_obj(
+    path = (gchar *) _fw_config_proxy_call_sync_get_obj(
 	fw, fw->proxy, "getHelperByName",
 	g_variant_new("(s)", helper));
 
-    return fw_config_helper_new(path);
+    return fw_config_helper_new_offline(fw->offline, path);
 }
 
 /****************************************************************************/
@@ -684,6 +1190,7 @@ fw_config_addIcmpType(FWConfig *obj,
 		      FWIcmpType *settings)
 {
     FWConfigPrivate *fw = FW_CONFIG_GET_PRIVATE(obj);
+    const gchar *path;
     GVariantBuilder builder;
     GList *list = fw_icmptype_getDestinations(settings);
     gint i;
@@ -694,7 +1201,7 @@ fw_config_addIcmpType(FWConfig *obj,
 			      (gchar *)g_list_nth_data(list, i));
     }
 
-    return _fw_config_proxy_call_sync_get_obj(
+    path = _fw_config_proxy_call_sync_get_obj(
 	fw, fw->proxy, "addIcmpType",
 	g_variant_new("(s(sssas))",
 		      icmptype,
@@ -702,6 +1209,8 @@ fw_config_addIcmpType(FWConfig *obj,
 		      fw_icmptype_getShort(settings),
 		      fw_icmptype_getDescription(settings),
 		      &builder));
+
+    return _fw_config_cache_added(fw, FW_CONFIG_CACHE_ICMPTYPE, icmptype, path);
 }
 
 /**
@@ -735,6 +1244,10 @@ fw_config_getIcmpTypeNames(FWConfig *obj)
 /**
  * fw_config_getIcmpTypeByName:
  *
+ * The object is shared and owned by the FWConfig, it is created with the
+ * first use and kept until firewalld removes it. Take a reference to use
+ * it longer than the FWConfig.
+ *
  * Returns: (transfer none) (allow-none) (type FWConfigIcmpType*)
  */
 FWConfigIcmpType *
@@ -742,12 +1255,16 @@ fw_config_getIcmpTypeByName(FWConfig *obj,
 			    const gchar *icmptype)
 {
     FWConfigPrivate *fw = FW_CONFIG_GET_PRIVATE(obj);
+    gchar *path;
+
+    if (fw->offline == NULL)
+	return _fw_config_cache_get(fw, FW_CONFIG_CACHE_ICMPTYPE, icmptype);
 
-    gchar *path = (gchar *) _fw_config_proxy_call_sync_get_obj(
+    path = (gchar *) _fw_config_proxy_call_sync_get_obj(
 	fw, fw->proxy, "getIcmpTypeByName",
 	g_variant_new("(s)", icmptype));
 
-    return fw_config_icmptype_new(path);
+    return fw_config_icmptype_new_offline(fw->offline, path);
 }
 
 /****************************************************************************/
@@ -767,6 +1284,7 @@ fw_config_addIPSet(FWConfig *obj,
 		   FWIPSet *settings)
 {
     FWConfigPrivate *fw = FW_CONFIG_GET_PRIVATE(obj);
+    const gchar *path;
     GVariantBuilder builder_options;
     GVariantBuilder builder_entries;
     GHashTable *hash;
@@ -789,7 +1307,7 @@ fw_config_addIPSet(FWConfig *obj,
 			      g_list_nth_data(list, i));
     }
 
-    return _fw_config_proxy_call_sync_get_obj(
+    path = _fw_config_proxy_call_sync_get_obj(
 	fw, fw->proxy, "addIPSet",
 	g_variant_new("(s(ssssa{ss}as))",
 		      ipset,
@@ -799,6 +1317,8 @@ fw_config_addIPSet(FWConfig *obj,
 		      fw_ipset_getType(settings),
 		      &builder_options,
 		      &builder_entries));
+
+    return _fw_config_cache_added(fw, FW_CONFIG_CACHE_IPSET, ipset, path);
 }
 
 /**
@@ -832,6 +1352,10 @@ fw_config_getIPSetNames(FWConfig *obj)
 /**
  * fw_config_getIPSetByName:
  *
+ * The object is shared and owned by the FWConfig, it is created with the
+ * first use and kept until firewalld removes it. Take a reference to use
+ * it longer than the FWConfig.
+ *
  * Returns: (transfer none) (allow-none) (type FWConfigIPSet*)
  */
 FWConfigIPSet *
@@ -839,12 +1363,16 @@ fw_config_getIPSetByName(FWConfig *obj,
 			 const gchar *ipset)
 {
     FWConfigPrivate *fw = FW_CONFIG_GET_PRIVATE(obj);
+    gchar *path;
+
+    if (fw->offline == NULL)
+	return _fw_config_cache_get(fw, FW_CONFIG_CACHE_IPSET, ipset);
 
-    gchar *path = (gchar *) _fw_config_proxy_call_sync_get_obj(
+    path = (gchar *) _fw_config_proxy_call_sync_get_obj(
 	fw, fw->proxy, "getIPSetByName",
 	g_variant_new("(s)", ipset));
 
-    return fw_config_ipset_new(path);
+    return fw_config_ipset_new_offline(fw->offline, path);
 }
 
 /****************************************************************************/
@@ -864,10 +1392,13 @@ fw_config_addService(FWConfig *obj,
 		     FWService *settings)
 {
     FWConfigPrivate *fw = FW_CONFIG_GET_PRIVATE(obj);
+    const gchar *path;
 
-    return _fw_config_proxy_call_sync_get_obj(
+    path = _fw_config_proxy_call_sync_get_obj(
 	fw, fw->proxy, "addService",
 	g_variant_new("(sv)", service, fw_service_to_variant(settings)));
+
+    return _fw_config_cache_added(fw, FW_CONFIG_CACHE_SERVICE, service, path);
 }
 
 /**
@@ -901,6 +1432,10 @@ fw_config_getServiceNames(FWConfig *obj)
 /**
  * fw_config_getServiceByName:
  *
+ * The object is shared and owned by the FWConfig, it is created with the
+ * first use and kept until firewalld removes it. Take a reference to use
+ * it longer than the FWConfig.
+ *
  * Returns: (transfer none) (allow-none) (type FWConfigService*)
  */
 FWConfigService *
@@ -908,12 +1443,16 @@ fw_config_getServiceByName(FWConfig *obj,
 			   const gchar *service)
 {
     FWConfigPrivate *fw = FW_CONFIG_GET_PRIVATE(obj);
+    gchar *path;
 
-    gchar *path = (gchar *) _fw_config_proxy_call_sync_get_obj(
+    if (fw->offline == NULL)
+	return _fw_config_cache_get(fw, FW_CONFIG_CACHE_SERVICE, service);
+
+    path = (gchar *) _fw_config_proxy_call_sync_get_obj(
 	fw, fw->proxy, "getServiceByName",
 	g_variant_new("(s)", service));
 
-    return fw_config_service_new(path);
+    return fw_config_service_new_offline(fw->offline, path);
 }
 
 /****************************************************************************/
@@ -933,11 +1472,14 @@ fw_config_addZone(FWConfig *obj,
 		    FWZone *settings)
 {
     FWConfigPrivate *fw = FW_CONFIG_GET_PRIVATE(obj);
+    const gchar *path;
 
-    return _fw_config_proxy_call_sync_get_obj(
+    path = _fw_config_proxy_call_sync_get_obj(
 	fw, fw->proxy, "addZone",
 	g_variant_new("(sv)", zone, fw_zone_to_variant(settings)));
 
+    return _fw_config_cache_added(fw, FW_CONFIG_CACHE_ZONE, zone, path);
+
 #ifdef FOOBAT
     GVariantBuilder builder_services;
     GVariantBuilder builder_ports;
@@ -1077,6 +1619,10 @@ fw_config_getZoneNames(FWConfig *obj)
 /**
  * fw_config_getZoneByName:
  *
+ * The object is shared and owned by the FWConfig, it is created with the
+ * first use and kept until firewalld removes it. Take a reference to use
+ * it longer than the FWConfig.
+ *
  * Returns: (transfer none) (allow-none) (type FWConfigZone*)
  */
 FWConfigZone *
@@ -1084,10 +1630,14 @@ fw_config_getZoneByName(FWConfig *obj,
 			const gchar *zone)
 {
     FWConfigPrivate *fw = FW_CONFIG_GET_PRIVATE(obj);
+    gchar *path;
+
+    if (fw->offline == NULL)
+	return _fw_config_cache_get(fw, FW_CONFIG_CACHE_ZONE, zone);
 
-    gchar *path = (gchar *) _fw_config_proxy_call_sync_get_obj(
+    path = (gchar *) _fw_config_proxy_call_sync_get_obj(
 	fw, fw->proxy, "getZoneByName",
 	g_variant_new("(s)", zone));
 
-    return fw_config_zone_new(path);
+    return fw_config_zone_new_offline(fw->offline, path);
 }
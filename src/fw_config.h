@@ -30,6 +30,7 @@
 #include "fw_icmptype.h"
 #include "fw_ipset.h"
 #include "fw_helper.h"
+#include "fw_config_offline.h"
 #include "fw_config_helper.h"
 #include "fw_config_icmptype.h"
 #include "fw_config_ipset.h"
@@ -53,9 +54,13 @@ typedef struct {
 
 GType fw_config_get_type(void);
 FWConfig *fw_config_new(void);
+FWConfig *fw_config_new_offline(const gchar *default_dir,
+				const gchar *config_dir);
 
 /* config */
 
+void fw_config_invalidateCache(FWConfig *obj);
+
 /* properties */
 
 /*
@@ -20,6 +20,8 @@
 
 #include <string.h>
 #include "fw_config_icmptype.h"
+#include "fw_trace.h"
+#include "fw_accounting.h"
 
 G_DEFINE_TYPE(FWConfigIcmpType, fw_config_icmptype, G_TYPE_OBJECT);
 
@@ -31,6 +33,9 @@ typedef struct {
     GError *error;
 
     gchar *path;
+
+    /* offline backend, NULL if connected to firewalld */
+    FWConfigOffline *offline;
 } FWConfigIcmpTypePrivate;
 
 enum _FWConfigIcmpTypeProperties {
@@ -62,6 +67,26 @@ fw_config_icmptype_new(gchar *path)
     */
 }
 
+/**
+ * fw_config_icmptype_new_offline:
+ * @offline: (type FWConfigOffline*): the offline backend
+ * @path: (type utf8): object path of the icmptype in the backend
+ *
+ * Returns: (transfer full) (type FWConfigIcmpType*)
+ */
+FWConfigIcmpType *
+fw_config_icmptype_new_offline(FWConfigOffline *offline,
+			       gchar *path)
+{
+    FWConfigIcmpType *obj = g_object_new(FW_CONFIG_ICMPTYPE_TYPE, NULL);
+    FWConfigIcmpTypePrivate *priv = FW_CONFIG_ICMPTYPE_GET_PRIVATE(obj);
+
+    priv->path = g_strdup(path);
+    priv->offline = g_object_ref(offline);
+
+    return obj;
+}
+
 static void
 fw_config_icmptype_init(FWConfigIcmpType *obj)
 {
@@ -71,19 +96,8 @@ fw_config_icmptype_init(FWConfigIcmpType *obj)
     priv->connection = NULL;
     priv->proxy = NULL;
     priv->error = NULL;
-
-    priv->connection = g_bus_get_sync(G_BUS_TYPE_SYSTEM, NULL, &priv->error);
-    if (priv->error != NULL) {
-        g_print("ERROR: Failed to connect to system bus: %s",
-		priv->error->message);
-	return;
-    }
-
-#ifdef FW_DEBUG
-    gchar *conn_name;
-    g_object_get(priv->connection, "unique-name", &conn_name, NULL);
-    g_free(conn_name);
-#endif
+    priv->path = NULL;
+    priv->offline = NULL;
 }
 
 static void
@@ -114,6 +128,19 @@ _fw_config_icmptype_dbus_connect(FWConfigIcmpTypePrivate *priv)
 {
     _fw_config_icmptype_reset_error(priv);
 
+    priv->connection = g_bus_get_sync(G_BUS_TYPE_SYSTEM, NULL, &priv->error);
+    if (priv->error != NULL) {
+        g_print("ERROR: Failed to connect to system bus: %s",
+		priv->error->message);
+	return;
+    }
+
+#ifdef FW_DEBUG
+    gchar *conn_name;
+    g_object_get(priv->connection, "unique-name", &conn_name, NULL);
+    g_free(conn_name);
+#endif
+
     /* create syncroneous proxies */
     priv->proxy = g_dbus_proxy_new_sync(priv->connection,
 					G_DBUS_PROXY_FLAGS_NONE,
@@ -147,6 +174,10 @@ fw_config_icmptype_finalize(GObject *obj)
 
     _fw_config_icmptype_reset_error(priv);
 
+    if (priv->offline != NULL)
+	g_object_unref(priv->offline);
+    g_free(priv->path);
+
     /* disconnect */
     /***/
 
@@ -219,6 +250,7 @@ fw_config_icmptype_class_init(FWConfigIcmpTypeClass *fw_config_icmptype_class)
     obj_class->finalize = fw_config_icmptype_finalize;
 
     g_type_class_add_private(obj_class, sizeof(FWConfigIcmpTypePrivate));
+    fw_accounting_register(obj_class, sizeof(FWConfigIcmpTypePrivate));
 }
 
 GVariant *
@@ -231,13 +263,26 @@ _fw_config_icmptype_proxy_call_sync(FWConfigIcmpTypePrivate *priv,
 
     _fw_config_icmptype_reset_error(priv);
 
-    result = g_dbus_proxy_call_sync(proxy,
-				    method_name,
-				    parameters,
-				    G_DBUS_CALL_FLAGS_NONE,
-				    -1,
-				    NULL,
-				    &priv->error);
+    FW_TRACE_CALL_START(method_name, (priv->offline != NULL) ?
+			priv->path : FW_TRACE_PROXY_PATH(proxy), parameters);
+
+    if (priv->offline != NULL)
+	result = fw_config_offline_call(priv->offline, priv->path,
+					method_name, parameters,
+					&priv->error);
+    else
+	result = g_dbus_proxy_call_sync(proxy,
+					method_name,
+					parameters,
+					G_DBUS_CALL_FLAGS_NONE,
+					-1,
+					NULL,
+					&priv->error);
+
+    FW_TRACE_CALL_DONE(method_name, (priv->offline != NULL) ?
+		       priv->path : FW_TRACE_PROXY_PATH(proxy), result,
+		       priv->error);
+
     if (priv->error != NULL) {
         g_print(_("ERROR: %s failed: %s\n"), method_name, priv->error->message);
     }
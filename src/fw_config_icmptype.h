@@ -25,6 +25,7 @@
 #include <glib-object.h>
 #include <gio/gio.h>
 #include "firewall.h"
+#include "fw_config_offline.h"
 #include "fw_functions.h"
 #include "fw_port.h"
 #include "fw_port_list.h"
@@ -46,6 +47,8 @@ typedef struct {
 
 GType fw_config_icmptype_get_type(void);
 FWConfigIcmpType *fw_config_icmptype_new(gchar *path);
+FWConfigIcmpType *fw_config_icmptype_new_offline(FWConfigOffline *offline,
+						 gchar *path);
 
 void fw_config_icmptype_print_str(FWConfigIcmpType *obj);
 
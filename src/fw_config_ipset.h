@@ -25,6 +25,7 @@
 #include <glib-object.h>
 #include <gio/gio.h>
 #include "firewall.h"
+#include "fw_config_offline.h"
 #include "fw_functions.h"
 #include "fw_port.h"
 #include "fw_port_list.h"
@@ -46,6 +47,8 @@ typedef struct {
 
 GType fw_config_ipset_get_type(void);
 FWConfigIPSet *fw_config_ipset_new(gchar *path);
+FWConfigIPSet *fw_config_ipset_new_offline(FWConfigOffline *offline,
+					   gchar *path);
 
 void fw_config_ipset_print_str(FWConfigIPSet *obj);
 
@@ -0,0 +1,1078 @@
+/*
+ * Copyright (C) 2017 Red Hat, Inc.
+ *
+ * Authors:
+ * Thomas Woerner <twoerner@redhat.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Offline configuration backend: implements the methods of the firewalld
+ * config D-Bus interfaces on the XML configuration tree, so that FWConfig
+ * and the FWConfig* objects work without a running firewalld.
+ *
+ * The default configuration in default_dir and the user configuration in
+ * config_dir are loaded once, all files in parallel. Every change is
+ * written back to config_dir atomically.
+ */
+
+#include <string.h>
+#include <glib/gstdio.h>
+#include <gio/gio.h>
+#include "fw_config_offline.h"
+#include "fw_accounting.h"
+
+G_DEFINE_TYPE(FWConfigOffline, fw_config_offline, G_TYPE_OBJECT);
+
+#define FW_CONFIG_OFFLINE_GET_PRIVATE(o) (G_TYPE_INSTANCE_GET_PRIVATE((o), FW_CONFIG_OFFLINE_TYPE, FWConfigOfflinePrivate))
+
+/* below this number of files the thread pool is not worth starting */
+#define FW_CONFIG_OFFLINE_PARALLEL_MIN 32
+
+typedef struct {
+    gchar *default_dir;
+    gchar *config_dir;
+
+    GHashTable *names[FW_XML_N_TYPES];	/* name -> entry */
+    GHashTable *paths;			/* path -> entry */
+    gint next_id[FW_XML_N_TYPES];
+} FWConfigOfflinePrivate;
+
+typedef struct {
+    FWXmlType type;
+    gchar *name;
+    gchar *path;
+    GVariant *settings;
+    GVariant *defaults;		/* settings in default_dir, NULL if none */
+} FWConfigOfflineEntry;
+
+typedef enum {
+    FW_CONFIG_OFFLINE_STRING,
+    FW_CONFIG_OFFLINE_BOOL,
+    FW_CONFIG_OFFLINE_LIST,
+    FW_CONFIG_OFFLINE_DICT,
+} FWConfigOfflineKind;
+
+typedef struct {
+    gint index;
+    const gchar *plural;	/* get/set name, NULL for alias entries */
+    const gchar *singular;	/* add/remove/query name, NULL if none */
+    FWConfigOfflineKind kind;
+} FWConfigOfflineField;
+
+static const FWConfigOfflineField fw_config_offline_common_fields[] = {
+    { 0, "Version", NULL, FW_CONFIG_OFFLINE_STRING },
+    { 1, "Short", NULL, FW_CONFIG_OFFLINE_STRING },
+    { 2, "Description", NULL, FW_CONFIG_OFFLINE_STRING },
+    { -1, NULL, NULL, 0 }
+};
+
+static const FWConfigOfflineField fw_config_offline_zone_fields[] = {
+    { 4, "Target", NULL, FW_CONFIG_OFFLINE_STRING },
+    { 5, "Services", "Service", FW_CONFIG_OFFLINE_LIST },
+    { 6, "Ports", "Port", FW_CONFIG_OFFLINE_LIST },
+    { 7, "IcmpBlocks", "IcmpBlock", FW_CONFIG_OFFLINE_LIST },
+    { 8, "Masquerade", "Masquerade", FW_CONFIG_OFFLINE_BOOL },
+    { 9, "ForwardPorts", "ForwardPort", FW_CONFIG_OFFLINE_LIST },
+    { 9, NULL, "Forward_Port", FW_CONFIG_OFFLINE_LIST },
+    { 10, "Interfaces", "Interface", FW_CONFIG_OFFLINE_LIST },
+    { 11, "Sources", "Source", FW_CONFIG_OFFLINE_LIST },
+    { 12, "RichRules", "RichRule", FW_CONFIG_OFFLINE_LIST },
+    { 13, "Protocols", "Protocol", FW_CONFIG_OFFLINE_LIST },
+    { 14, "SourcePorts", "SourcePort", FW_CONFIG_OFFLINE_LIST },
+    { 15, "IcmpBlockInversion", "IcmpBlockInversion",
+      FW_CONFIG_OFFLINE_BOOL },
+    { -1, NULL, NULL, 0 }
+};
+
+static const FWConfigOfflineField fw_config_offline_service_fields[] = {
+    { 3, "Ports", "Port", FW_CONFIG_OFFLINE_LIST },
+    { 4, "Modules", "Module", FW_CONFIG_OFFLINE_LIST },
+    { 5, "Destinations", "Destination", FW_CONFIG_OFFLINE_DICT },
+    { 6, "Protocols", "Protocol", FW_CONFIG_OFFLINE_LIST },
+    { 7, "SourcePorts", "SourcePort", FW_CONFIG_OFFLINE_LIST },
+    { -1, NULL, NULL, 0 }
+};
+
+static const FWConfigOfflineField fw_config_offline_ipset_fields[] = {
+    { 3, "Type", NULL, FW_CONFIG_OFFLINE_STRING },
+    { 4, "Options", "Option", FW_CONFIG_OFFLINE_DICT },
+    { 5, "Entries", "Entry", FW_CONFIG_OFFLINE_LIST },
+    { -1, NULL, NULL, 0 }
+};
+
+static const FWConfigOfflineField fw_config_offline_icmptype_fields[] = {
+    { 3, "Destinations", "Destination", FW_CONFIG_OFFLINE_LIST },
+    { -1, NULL, NULL, 0 }
+};
+
+static const FWConfigOfflineField fw_config_offline_helper_fields[] = {
+    { 3, "Family", NULL, FW_CONFIG_OFFLINE_STRING },
+    { 4, "Module", NULL, FW_CONFIG_OFFLINE_STRING },
+    { 5, "Ports", "Port", FW_CONFIG_OFFLINE_LIST },
+    { -1, NULL, NULL, 0 }
+};
+
+static const struct {
+    const gchar *name;		/* as used in the config method names */
+    const gchar *error;		/* as used in the firewalld error codes */
+    const gchar *path;
+    const FWConfigOfflineField *fields;
+} fw_config_offline_types[FW_XML_N_TYPES] = {
+    { "Zone", "ZONE", FW_DBUS_PATH_CONFIG_ZONE,
+      fw_config_offline_zone_fields },
+    { "Service", "SERVICE", FW_DBUS_PATH_CONFIG_SERVICE,
+      fw_config_offline_service_fields },
+    { "IPSet", "IPSET", FW_DBUS_PATH_CONFIG_IPSET,
+      fw_config_offline_ipset_fields },
+    { "IcmpType", "ICMPTYPE", FW_DBUS_PATH_CONFIG_ICMPTYPE,
+      fw_config_offline_icmptype_fields },
+    { "Helper", "HELPER", FW_DBUS_PATH_CONFIG_HELPER,
+      fw_config_offline_helper_fields },
+};
+
+static void _fw_config_offline_load(FWConfigOfflinePrivate *priv);
+
+/**
+ * fw_config_offline_new:
+ * @default_dir: (type filename) (allow-none): firewalld default
+ *   configuration, NULL for FW_CONFIG_OFFLINE_DEFAULT_DIR
+ * @config_dir: (type filename) (allow-none): firewalld user configuration,
+ *   NULL for FW_CONFIG_OFFLINE_CONFIG_DIR
+ *
+ * Returns: (transfer full) (type FWConfigOffline*)
+ */
+FWConfigOffline *
+fw_config_offline_new(const gchar *default_dir,
+		      const gchar *config_dir)
+{
+    FWConfigOffline *obj = g_object_new(FW_CONFIG_OFFLINE_TYPE, NULL);
+    FWConfigOfflinePrivate *priv = FW_CONFIG_OFFLINE_GET_PRIVATE(obj);
+
+    priv->default_dir = g_strdup(default_dir ? default_dir
+				 : FW_CONFIG_OFFLINE_DEFAULT_DIR);
+    priv->config_dir = g_strdup(config_dir ? config_dir
+				: FW_CONFIG_OFFLINE_CONFIG_DIR);
+
+    _fw_config_offline_load(priv);
+
+    return obj;
+}
+
+static void
+_fw_config_offline_entry_free(gpointer data)
+{
+    FWConfigOfflineEntry *entry = data;
+
+    g_free(entry->name);
+    g_free(entry->path);
+    if (entry->settings != NULL)
+	g_variant_unref(entry->settings);
+    if (entry->defaults != NULL)
+	g_variant_unref(entry->defaults);
+    g_free(entry);
+}
+
+static void
+fw_config_offline_init(FWConfigOffline *obj)
+{
+    FWConfigOfflinePrivate *priv = FW_CONFIG_OFFLINE_GET_PRIVATE(obj);
+    gint i;
+
+    priv->default_dir = NULL;
+    priv->config_dir = NULL;
+    for (i=0; i<FW_XML_N_TYPES; i++) {
+	priv->names[i] = g_hash_table_new_full(g_str_hash, g_str_equal, NULL,
+					       _fw_config_offline_entry_free);
+	priv->next_id[i] = 0;
+    }
+    priv->paths = g_hash_table_new(g_str_hash, g_str_equal);
+}
+
+static void
+fw_config_offline_finalize(GObject *obj)
+{
+    FWConfigOfflinePrivate *priv = FW_CONFIG_OFFLINE_GET_PRIVATE(obj);
+    gint i;
+
+    g_hash_table_destroy(priv->paths);
+    for (i=0; i<FW_XML_N_TYPES; i++)
+	g_hash_table_destroy(priv->names[i]);
+    g_free(priv->default_dir);
+    g_free(priv->config_dir);
+
+    G_OBJECT_CLASS(fw_config_offline_parent_class)->finalize(obj);
+}
+
+static void
+fw_config_offline_class_init(FWConfigOfflineClass *fw_config_offline_class)
+{
+    GObjectClass *obj_class = G_OBJECT_CLASS(fw_config_offline_class);
+
+    obj_class->finalize = fw_config_offline_finalize;
+
+    g_type_class_add_private(obj_class, sizeof(FWConfigOfflinePrivate));
+    fw_accounting_register(obj_class, sizeof(FWConfigOfflinePrivate));
+}
+
+/**
+ * fw_config_offline_getDefaultDir:
+ *
+ * Returns: (transfer none) (type filename)
+ */
+const gchar *
+fw_config_offline_getDefaultDir(FWConfigOffline *obj)
+{
+    FWConfigOfflinePrivate *priv = FW_CONFIG_OFFLINE_GET_PRIVATE(obj);
+
+    return priv->default_dir;
+}
+
+/**
+ * fw_config_offline_getConfigDir:
+ *
+ * Returns: (transfer none) (type filename)
+ */
+const gchar *
+fw_config_offline_getConfigDir(FWConfigOffline *obj)
+{
+    FWConfigOfflinePrivate *priv = FW_CONFIG_OFFLINE_GET_PRIVATE(obj);
+
+    return priv->config_dir;
+}
+
+/****************************************************************************/
+/* loading */
+
+typedef struct {
+    FWXmlType type;
+    gboolean is_default;
+    gchar *name;
+    gchar *filename;
+    GVariant *settings;
+    GError *error;
+} FWConfigOfflineJob;
+
+static void
+_fw_config_offline_job_run(gpointer data,
+			   gpointer user_data)
+{
+    FWConfigOfflineJob *job = data;
+
+    job->settings = fw_xml_parse_file(job->type, job->filename, &job->error);
+}
+
+static void
+_fw_config_offline_job_free(gpointer data)
+{
+    FWConfigOfflineJob *job = data;
+
+    g_free(job->name);
+    g_free(job->filename);
+    if (job->settings != NULL)
+	g_variant_unref(job->settings);
+    if (job->error != NULL)
+	g_error_free(job->error);
+    g_free(job);
+}
+
+static void
+_fw_config_offline_scan(GPtrArray *jobs,
+			FWXmlType type,
+			const gchar *base_dir,
+			gboolean is_default)
+{
+    gchar *dirname;
+    const gchar *filename;
+    GDir *dir;
+
+    dirname = g_build_filename(base_dir, fw_xml_type_get_dir(type), NULL);
+    dir = g_dir_open(dirname, 0, NULL);
+    if (dir == NULL) {
+	g_free(dirname);
+	return;
+    }
+
+    while ((filename = g_dir_read_name(dir)) != NULL) {
+	FWConfigOfflineJob *job;
+
+	if (!g_str_has_suffix(filename, ".xml") || filename[0] == '.')
+	    continue;
+
+	job = g_new0(FWConfigOfflineJob, 1);
+	job->type = type;
+	job->is_default = is_default;
+	job->name = g_strndup(filename, strlen(filename) - 4);
+	job->filename = g_build_filename(dirname, filename, NULL);
+	g_ptr_array_add(jobs, job);
+    }
+
+    g_dir_close(dir);
+    g_free(dirname);
+}
+
+static gint
+_fw_config_offline_job_cmp(gconstpointer a,
+			   gconstpointer b)
+{
+    const FWConfigOfflineJob *job_a = *(FWConfigOfflineJob * const *) a;
+    const FWConfigOfflineJob *job_b = *(FWConfigOfflineJob * const *) b;
+
+    if (job_a->type != job_b->type)
+	return job_a->type - job_b->type;
+    if (job_a->is_default != job_b->is_default)
+	return job_b->is_default - job_a->is_default;
+    return strcmp(job_a->name, job_b->name);
+}
+
+static FWConfigOfflineEntry *
+_fw_config_offline_entry_add(FWConfigOfflinePrivate *priv,
+			     FWXmlType type,
+			     const gchar *name)
+{
+    FWConfigOfflineEntry *entry = g_new0(FWConfigOfflineEntry, 1);
+
+    entry->type = type;
+    entry->name = g_strdup(name);
+    entry->path = g_strdup_printf("%s/%d", fw_config_offline_types[type].path,
+				  priv->next_id[type]++);
+    g_hash_table_insert(priv->names[type], entry->name, entry);
+    g_hash_table_insert(priv->paths, entry->path, entry);
+
+    return entry;
+}
+
+static void
+_fw_config_offline_load(FWConfigOfflinePrivate *priv)
+{
+    GPtrArray *jobs;
+    guint i;
+    gint type;
+
+#ifdef FW_DEBUG
+    g_printerr("_fw_config_offline_load(%s, %s)\n", priv->default_dir,
+	       priv->config_dir);
+#endif
+
+    jobs = g_ptr_array_new_with_free_func(_fw_config_offline_job_free);
+    for (type=0; type<FW_XML_N_TYPES; type++) {
+	_fw_config_offline_scan(jobs, type, priv->default_dir, TRUE);
+	_fw_config_offline_scan(jobs, type, priv->config_dir, FALSE);
+    }
+
+    /* every job only writes its own result, no locking is needed */
+    if (jobs->len >= FW_CONFIG_OFFLINE_PARALLEL_MIN) {
+	GThreadPool *pool;
+
+	pool = g_thread_pool_new(_fw_config_offline_job_run, NULL,
+				 g_get_num_processors(), FALSE, NULL);
+	for (i=0; i<jobs->len; i++)
+	    g_thread_pool_push(pool, jobs->pdata[i], NULL);
+	g_thread_pool_free(pool, FALSE, TRUE);
+    } else {
+	for (i=0; i<jobs->len; i++)
+	    _fw_config_offline_job_run(jobs->pdata[i], NULL);
+    }
+
+    /* defaults first, user configuration overrides, paths in name order */
+    g_ptr_array_sort(jobs, _fw_config_offline_job_cmp);
+    for (i=0; i<jobs->len; i++) {
+	FWConfigOfflineJob *job = jobs->pdata[i];
+	FWConfigOfflineEntry *entry;
+
+	if (job->settings == NULL) {
+	    g_print(_("ERROR: Failed to load %s: %s\n"), job->filename,
+		    job->error ? job->error->message : "");
+	    continue;
+	}
+
+	entry = g_hash_table_lookup(priv->names[job->type], job->name);
+	if (entry == NULL)
+	    entry = _fw_config_offline_entry_add(priv, job->type, job->name);
+	if (entry->settings != NULL)
+	    g_variant_unref(entry->settings);
+	entry->settings = g_variant_ref(job->settings);
+	if (job->is_default)
+	    entry->defaults = g_variant_ref(job->settings);
+    }
+
+    g_ptr_array_free(jobs, TRUE);
+}
+
+/****************************************************************************/
+/* helpers */
+
+static gchar *
+_fw_config_offline_filename(FWConfigOfflinePrivate *priv,
+			    FWConfigOfflineEntry *entry)
+{
+    gchar *basename = g_strdup_printf("%s.xml", entry->name);
+    gchar *filename = g_build_filename(priv->config_dir,
+				       fw_xml_type_get_dir(entry->type),
+				       basename, NULL);
+
+    g_free(basename);
+    return filename;
+}
+
+static gboolean
+_fw_config_offline_write(FWConfigOfflinePrivate *priv,
+			 FWConfigOfflineEntry *entry,
+			 GError **error)
+{
+    gchar *filename = _fw_config_offline_filename(priv, entry);
+    gboolean ret;
+
+    ret = fw_xml_write_file(entry->type, entry->settings, filename, error);
+    g_free(filename);
+
+    return ret;
+}
+
+static void
+_fw_config_offline_unlink(FWConfigOfflinePrivate *priv,
+			  FWConfigOfflineEntry *entry)
+{
+    gchar *filename = _fw_config_offline_filename(priv, entry);
+
+    g_unlink(filename);
+    g_free(filename);
+}
+
+/* Replaces the settings of the entry and writes them to config_dir. */
+static gboolean
+_fw_config_offline_store(FWConfigOfflinePrivate *priv,
+			 FWConfigOfflineEntry *entry,
+			 GVariant *settings,
+			 GError **error)
+{
+    GVariant *old = entry->settings;
+
+    entry->settings = g_variant_ref_sink(settings);
+    if (!_fw_config_offline_write(priv, entry, error)) {
+	g_variant_unref(entry->settings);
+	entry->settings = old;
+	return FALSE;
+    }
+    g_variant_unref(old);
+
+    return TRUE;
+}
+
+/* Returns a copy of the settings with one field replaced. */
+static GVariant *
+_fw_config_offline_replace(GVariant *settings,
+			   gint index,
+			   GVariant *value)
+{
+    gsize n = g_variant_n_children(settings);
+    GVariant **children = g_new(GVariant *, n);
+    GVariant *result;
+    gsize i;
+
+    for (i=0; i<n; i++) {
+	if ((gint) i == index)
+	    children[i] = value;
+	else
+	    children[i] = g_variant_get_child_value(settings, i);
+    }
+    result = g_variant_new_tuple(children, n);
+    for (i=0; i<n; i++) {
+	if ((gint) i != index)
+	    g_variant_unref(children[i]);
+    }
+    g_free(children);
+
+    return result;
+}
+
+/* Unwraps settings given as (v), ((...)) or v to the settings tuple. */
+static GVariant *
+_fw_config_offline_unwrap(GVariant *settings,
+			  FWXmlType type)
+{
+    const GVariantType *signature =
+	G_VARIANT_TYPE(fw_xml_type_get_signature(type));
+    GVariant *child;
+
+    g_variant_ref(settings);
+    while (!g_variant_is_of_type(settings, signature)) {
+	if (g_variant_is_of_type(settings, G_VARIANT_TYPE_VARIANT))
+	    child = g_variant_get_variant(settings);
+	else if (g_variant_is_container(settings) &&
+		 g_variant_n_children(settings) == 1)
+	    child = g_variant_get_child_value(settings, 0);
+	else {
+	    g_variant_unref(settings);
+	    return NULL;
+	}
+	g_variant_unref(settings);
+	settings = child;
+    }
+
+    return settings;
+}
+
+static gboolean
+_fw_config_offline_check_params(GVariant *parameters,
+				const gchar *signature,
+				const gchar *method_name,
+				GError **error)
+{
+    if (parameters == NULL && strcmp(signature, "()") == 0)
+	return TRUE;
+    if (parameters != NULL &&
+	g_variant_is_of_type(parameters, G_VARIANT_TYPE(signature)))
+	return TRUE;
+
+    g_set_error(error, G_DBUS_ERROR, G_DBUS_ERROR_INVALID_ARGS,
+		"INVALID_TYPE: %s expects %s, got %s", method_name, signature,
+		parameters ? g_variant_get_type_string(parameters) : "()");
+    return FALSE;
+}
+
+static gboolean
+_fw_config_offline_match(const gchar *method_name,
+			 const gchar *prefix,
+			 const gchar *name,
+			 const gchar *suffix)
+{
+    gsize len;
+
+    if (name == NULL || !g_str_has_prefix(method_name, prefix))
+	return FALSE;
+    method_name += strlen(prefix);
+    len = strlen(name);
+    if (strncmp(method_name, name, len) != 0)
+	return FALSE;
+    return (strcmp(method_name + len, suffix) == 0);
+}
+
+/****************************************************************************/
+/* org.fedoraproject.FirewallD1.config */
+
+static GVariant *
+_fw_config_offline_names(FWConfigOfflinePrivate *priv,
+			 FWXmlType type,
+			 gboolean paths)
+{
+    GVariantBuilder builder;
+    GList *names, *list;
+
+    names = g_list_sort(g_hash_table_get_keys(priv->names[type]),
+			(GCompareFunc) strcmp);
+    g_variant_builder_init(&builder, paths ? G_VARIANT_TYPE("ao")
+			   : G_VARIANT_TYPE("as"));
+    for (list = names; list != NULL; list = list->next) {
+	if (paths) {
+	    FWConfigOfflineEntry *entry =
+		g_hash_table_lookup(priv->names[type], list->data);
+	    g_variant_builder_add(&builder, "o", entry->path);
+	} else
+	    g_variant_builder_add(&builder, "s", list->data);
+    }
+    g_list_free(names);
+
+    return g_variant_new(paths ? "(ao)" : "(as)", &builder);
+}
+
+static GVariant *
+_fw_config_offline_zone_of(FWConfigOfflinePrivate *priv,
+			   gint index,
+			   const gchar *item)
+{
+    GHashTableIter iter;
+    gpointer value;
+
+    g_hash_table_iter_init(&iter, priv->names[FW_XML_ZONE]);
+    while (g_hash_table_iter_next(&iter, NULL, &value)) {
+	FWConfigOfflineEntry *entry = value;
+	GVariant *list = g_variant_get_child_value(entry->settings, index);
+	GVariantIter list_iter;
+	const gchar *str;
+	gboolean found = FALSE;
+
+	g_variant_iter_init(&list_iter, list);
+	while (!found && g_variant_iter_next(&list_iter, "&s", &str))
+	    found = (strcmp(str, item) == 0);
+	g_variant_unref(list);
+
+	if (found)
+	    return g_variant_new("(s)", entry->name);
+    }
+
+    return g_variant_new("(s)", "");
+}
+
+static GVariant *
+_fw_config_offline_config_call(FWConfigOfflinePrivate *priv,
+			       const gchar *method_name,
+			       GVariant *parameters,
+			       GError **error)
+{
+    FWConfigOfflineEntry *entry;
+    const gchar *name;
+    GVariant *settings;
+    gint type;
+
+    if (strcmp(method_name, "getZoneOfInterface") == 0 ||
+	strcmp(method_name, "getZoneOfSource") == 0)
+    {
+	if (!_fw_config_offline_check_params(parameters, "(s)", method_name,
+					     error))
+	    return NULL;
+	g_variant_get(parameters, "(&s)", &name);
+	return _fw_config_offline_zone_of(
+	    priv, strcmp(method_name, "getZoneOfSource") == 0 ? 11 : 10, name);
+    }
+
+    for (type=0; type<FW_XML_N_TYPES; type++) {
+	const gchar *type_name = fw_config_offline_types[type].name;
+
+	if (_fw_config_offline_match(method_name, "get", type_name, "Names"))
+	    return _fw_config_offline_names(priv, type, FALSE);
+
+	if (_fw_config_offline_match(method_name, "list", type_name, "s"))
+	    return _fw_config_offline_names(priv, type, TRUE);
+
+	if (_fw_config_offline_match(method_name, "get", type_name,
+				     "ByName"))
+	{
+	    if (!_fw_config_offline_check_params(parameters, "(s)",
+						 method_name, error))
+		return NULL;
+	    g_variant_get(parameters, "(&s)", &name);
+	    entry = g_hash_table_lookup(priv->names[type], name);
+	    if (entry == NULL) {
+		g_set_error(error, G_IO_ERROR, G_IO_ERROR_NOT_FOUND,
+			    "INVALID_%s: %s",
+			    fw_config_offline_types[type].error, name);
+		return NULL;
+	    }
+	    return g_variant_new("(o)", entry->path);
+	}
+
+	if (_fw_config_offline_match(method_name, "add", type_name, "")) {
+	    GVariant *child;
+
+	    if (parameters == NULL ||
+		!g_variant_is_of_type(parameters, G_VARIANT_TYPE_TUPLE) ||
+		g_variant_n_children(parameters) != 2)
+	    {
+		_fw_config_offline_check_params(
+		    parameters, "(sv)", method_name, error);
+		return NULL;
+	    }
+	    g_variant_get_child(parameters, 0, "&s", &name);
+	    child = g_variant_get_child_value(parameters, 1);
+	    settings = _fw_config_offline_unwrap(child, type);
+	    g_variant_unref(child);
+	    if (settings == NULL) {
+		_fw_config_offline_check_params(
+		    parameters, fw_xml_type_get_signature(type), method_name,
+		    error);
+		return NULL;
+	    }
+	    if (g_hash_table_lookup(priv->names[type], name) != NULL) {
+		g_variant_unref(settings);
+		g_set_error(error, G_IO_ERROR, G_IO_ERROR_EXISTS,
+			    "NAME_CONFLICT: %s", name);
+		return NULL;
+	    }
+	    entry = _fw_config_offline_entry_add(priv, type, name);
+	    entry->settings = settings;
+	    if (!_fw_config_offline_write(priv, entry, error)) {
+		g_hash_table_remove(priv->paths, entry->path);
+		g_hash_table_remove(priv->names[type], name);
+		return NULL;
+	    }
+	    return g_variant_new("(o)", entry->path);
+	}
+    }
+
+    g_set_error(error, G_DBUS_ERROR, G_DBUS_ERROR_UNKNOWN_METHOD,
+		"Method %s is not supported offline", method_name);
+    return NULL;
+}
+
+/****************************************************************************/
+/* org.fedoraproject.FirewallD1.config.<type> */
+
+/* get<Plural>, set<Plural>: the whole field */
+static GVariant *
+_fw_config_offline_field_call(FWConfigOfflinePrivate *priv,
+			      FWConfigOfflineEntry *entry,
+			      const FWConfigOfflineField *field,
+			      const gchar *method_name,
+			      gboolean set,
+			      GVariant *parameters,
+			      GError **error)
+{
+    GVariant *value, *result = NULL;
+    gchar *signature;
+
+    value = g_variant_get_child_value(entry->settings, field->index);
+
+    if (!set) {
+	if (_fw_config_offline_check_params(parameters, "()", method_name,
+					    error))
+	    result = g_variant_new_tuple(&value, 1);
+	g_variant_unref(value);
+	return result;
+    }
+
+    signature = g_strdup_printf("(%s)", g_variant_get_type_string(value));
+    g_variant_unref(value);
+    if (_fw_config_offline_check_params(parameters, signature, method_name,
+					error))
+    {
+	value = g_variant_get_child_value(parameters, 0);
+	if (_fw_config_offline_store(
+		priv, entry,
+		_fw_config_offline_replace(entry->settings, field->index,
+					   value),
+		error))
+	    result = g_variant_new("()");
+	g_variant_unref(value);
+    }
+    g_free(signature);
+
+    return result;
+}
+
+/* add<Item>, remove<Item>, query<Item> and set<Item> for dicts */
+static GVariant *
+_fw_config_offline_item_call(FWConfigOfflinePrivate *priv,
+			     FWConfigOfflineEntry *entry,
+			     const FWConfigOfflineField *field,
+			     const gchar *method_name,
+			     const gchar *verb,
+			     GVariant *parameters,
+			     GError **error)
+{
+    GVariant *value, *element, *item = NULL, *result = NULL;
+    const GVariantType *element_type;
+    const gchar *key = NULL, *item_value = NULL;
+    const gchar *dict_key, *dict_value;
+    GVariantBuilder builder;
+    GVariantIter iter;
+    gboolean query = (strcmp(verb, "query") == 0);
+    gboolean add = (strcmp(verb, "add") == 0 || strcmp(verb, "set") == 0);
+    gboolean found = FALSE;
+
+    value = g_variant_get_child_value(entry->settings, field->index);
+
+    switch (field->kind) {
+    case FW_CONFIG_OFFLINE_BOOL:
+	if (!_fw_config_offline_check_params(parameters, "()", method_name,
+					     error))
+	    goto out;
+	found = g_variant_get_boolean(value);
+	break;
+
+    case FW_CONFIG_OFFLINE_LIST:
+	/* string items are passed as (s), tuples as they are */
+	element_type = g_variant_type_element(g_variant_get_type(value));
+	if (g_variant_type_equal(element_type, G_VARIANT_TYPE_STRING)) {
+	    if (!_fw_config_offline_check_params(parameters, "(s)",
+						 method_name, error))
+		goto out;
+	    item = g_variant_get_child_value(parameters, 0);
+	} else {
+	    gchar *signature = g_variant_type_dup_string(element_type);
+	    gboolean valid = _fw_config_offline_check_params(
+		parameters, signature, method_name, error);
+
+	    g_free(signature);
+	    if (!valid)
+		goto out;
+	    item = g_variant_ref(parameters);
+	}
+
+	g_variant_builder_init(&builder, g_variant_get_type(value));
+	g_variant_iter_init(&iter, value);
+	while ((element = g_variant_iter_next_value(&iter)) != NULL) {
+	    if (g_variant_equal(element, item))
+		found = TRUE;
+	    else
+		g_variant_builder_add_value(&builder, element);
+	    g_variant_unref(element);
+	}
+	if (add)
+	    g_variant_builder_add_value(&builder, item);
+	break;
+
+    case FW_CONFIG_OFFLINE_DICT:
+	/* set<Item>(ss), remove<Item>(s), query<Item>(ss) */
+	if (strcmp(verb, "remove") == 0) {
+	    if (!_fw_config_offline_check_params(parameters, "(s)",
+						 method_name, error))
+		goto out;
+	    g_variant_get(parameters, "(&s)", &key);
+	} else {
+	    if (!_fw_config_offline_check_params(parameters, "(ss)",
+						 method_name, error))
+		goto out;
+	    g_variant_get(parameters, "(&s&s)", &key, &item_value);
+	}
+
+	g_variant_builder_init(&builder, G_VARIANT_TYPE("a{ss}"));
+	g_variant_iter_init(&iter, value);
+	while (g_variant_iter_next(&iter, "{&s&s}", &dict_key, &dict_value)) {
+	    if (strcmp(dict_key, key) == 0)
+		found = (!query || strcmp(dict_value, item_value) == 0);
+	    else
+		g_variant_builder_add(&builder, "{ss}", dict_key, dict_value);
+	}
+	if (add)
+	    g_variant_builder_add(&builder, "{ss}", key, item_value);
+	/* setting an existing dict item replaces it */
+	if (strcmp(verb, "set") == 0)
+	    found = FALSE;
+	break;
+
+    default:
+	goto out;
+    }
+
+    if (query) {
+	result = g_variant_new("(b)", found);
+    } else if (add == found) {
+	gchar *item_str;
+
+	if (key != NULL)
+	    item_str = g_strdup(key);
+	else if (item != NULL &&
+		 g_variant_is_of_type(item, G_VARIANT_TYPE_STRING))
+	    item_str = g_variant_dup_string(item, NULL);
+	else if (item != NULL)
+	    item_str = g_variant_print(item, FALSE);
+	else
+	    item_str = g_ascii_strdown(field->singular, -1);
+	g_set_error(error, G_IO_ERROR,
+		    found ? G_IO_ERROR_EXISTS : G_IO_ERROR_NOT_FOUND,
+		    "%s: '%s' in '%s'",
+		    found ? "ALREADY_ENABLED" : "NOT_ENABLED",
+		    item_str, entry->name);
+	g_free(item_str);
+    } else if (field->kind == FW_CONFIG_OFFLINE_BOOL) {
+	if (_fw_config_offline_store(
+		priv, entry,
+		_fw_config_offline_replace(entry->settings, field->index,
+					   g_variant_new_boolean(add)),
+		error))
+	    result = g_variant_new("()");
+    } else {
+	if (_fw_config_offline_store(
+		priv, entry,
+		_fw_config_offline_replace(entry->settings, field->index,
+					   g_variant_builder_end(&builder)),
+		error))
+	    result = g_variant_new("()");
+    }
+
+    /* no-op if the builder has been ended above */
+    if (field->kind != FW_CONFIG_OFFLINE_BOOL)
+	g_variant_builder_clear(&builder);
+
+out:
+    if (item != NULL)
+	g_variant_unref(item);
+    g_variant_unref(value);
+
+    return result;
+}
+
+static GVariant *
+_fw_config_offline_object_call(FWConfigOfflinePrivate *priv,
+			       FWConfigOfflineEntry *entry,
+			       const gchar *method_name,
+			       GVariant *parameters,
+			       GError **error)
+{
+    static const gchar *verbs[] = { "get", "set", "add", "remove", "query",
+				    NULL };
+    const FWConfigOfflineField *fields[2];
+    const gchar *type_error = fw_config_offline_types[entry->type].error;
+    const gchar *name;
+    GVariant *settings;
+    gint i, j, k;
+
+    if (strcmp(method_name, "getSettings") == 0)
+	return g_variant_new_tuple(&entry->settings, 1);
+
+    if (strcmp(method_name, "update") == 0) {
+	settings = parameters ? _fw_config_offline_unwrap(parameters,
+							  entry->type)
+	    : NULL;
+	if (settings == NULL) {
+	    _fw_config_offline_check_params(parameters, "(v)", method_name,
+					    error);
+	    return NULL;
+	}
+	if (!_fw_config_offline_store(priv, entry, settings, error))
+	    return NULL;
+	return g_variant_new("()");
+    }
+
+    if (strcmp(method_name, "loadDefaults") == 0) {
+	if (entry->defaults == NULL) {
+	    g_set_error(error, G_IO_ERROR, G_IO_ERROR_NOT_FOUND,
+			"NO_DEFAULTS: %s", entry->name);
+	    return NULL;
+	}
+	g_variant_unref(entry->settings);
+	entry->settings = g_variant_ref(entry->defaults);
+	_fw_config_offline_unlink(priv, entry);
+	return g_variant_new("()");
+    }
+
+    if (strcmp(method_name, "remove") == 0) {
+	if (entry->defaults != NULL) {
+	    g_set_error(error, G_IO_ERROR, G_IO_ERROR_PERMISSION_DENIED,
+			"BUILTIN_%s: %s", type_error, entry->name);
+	    return NULL;
+	}
+	_fw_config_offline_unlink(priv, entry);
+	g_hash_table_remove(priv->paths, entry->path);
+	g_hash_table_remove(priv->names[entry->type], entry->name);
+	return g_variant_new("()");
+    }
+
+    if (strcmp(method_name, "rename") == 0) {
+	gboolean renamed;
+	gchar *old_name;
+
+	if (!_fw_config_offline_check_params(parameters, "(s)", method_name,
+					     error))
+	    return NULL;
+	g_variant_get(parameters, "(&s)", &name);
+	if (entry->defaults != NULL) {
+	    g_set_error(error, G_IO_ERROR, G_IO_ERROR_PERMISSION_DENIED,
+			"BUILTIN_%s: %s", type_error, entry->name);
+	    return NULL;
+	}
+	if (g_hash_table_lookup(priv->names[entry->type], name) != NULL) {
+	    g_set_error(error, G_IO_ERROR, G_IO_ERROR_EXISTS,
+			"NAME_CONFLICT: %s", name);
+	    return NULL;
+	}
+
+	/* write the new file first, the old one stays valid on failure */
+	g_hash_table_steal(priv->names[entry->type], entry->name);
+	old_name = entry->name;
+	entry->name = g_strdup(name);
+	renamed = _fw_config_offline_write(priv, entry, error);
+	if (renamed) {
+	    FWConfigOfflineEntry old = *entry;
+
+	    old.name = old_name;
+	    _fw_config_offline_unlink(priv, &old);
+	    g_free(old_name);
+	} else {
+	    g_free(entry->name);
+	    entry->name = old_name;
+	}
+	g_hash_table_insert(priv->names[entry->type], entry->name, entry);
+
+	return renamed ? g_variant_new("()") : NULL;
+    }
+
+    fields[0] = fw_config_offline_common_fields;
+    fields[1] = fw_config_offline_types[entry->type].fields;
+    for (i=0; verbs[i] != NULL; i++) {
+	if (!g_str_has_prefix(method_name, verbs[i]))
+	    continue;
+	for (j=0; j<2; j++) {
+	    for (k=0; fields[j][k].index >= 0; k++) {
+		const FWConfigOfflineField *field = &fields[j][k];
+
+		if (i < 2 && _fw_config_offline_match(method_name, verbs[i],
+						      field->plural, ""))
+		    return _fw_config_offline_field_call(
+			priv, entry, field, method_name, i == 1,
+			parameters, error);
+
+		/* set<Item> only exists for dicts */
+		if ((i > 1 || field->kind == FW_CONFIG_OFFLINE_DICT) &&
+		    i > 0 &&
+		    _fw_config_offline_match(method_name, verbs[i],
+					     field->singular, ""))
+		    return _fw_config_offline_item_call(
+			priv, entry, field, method_name, verbs[i],
+			parameters, error);
+	    }
+	}
+    }
+
+    g_set_error(error, G_DBUS_ERROR, G_DBUS_ERROR_UNKNOWN_METHOD,
+		"Method %s is not supported offline", method_name);
+    return NULL;
+}
+
+/**
+ * fw_config_offline_call:
+ * @obj: (type FWConfigOffline*): a FWConfigOffline instance
+ * @path: (type utf8): object path, FW_DBUS_PATH_CONFIG or the path of a
+ *   zone, service, ipset, icmptype or helper
+ * @method_name: (type utf8): config D-Bus method name
+ * @parameters: (type GVariant*) (allow-none): method parameters, floating
+ *   references are consumed
+ * @error: return location for a #GError
+ *
+ * Executes a method of the firewalld config D-Bus interfaces on the
+ * offline configuration. The reply has the same shape as the reply of
+ * g_dbus_proxy_call_sync.
+ *
+ * Returns: (transfer full) (allow-none) (type GVariant*)
+ */
+GVariant *
+fw_config_offline_call(FWConfigOffline *obj,
+		       const gchar *path,
+		       const gchar *method_name,
+		       GVariant *parameters,
+		       GError **error)
+{
+    FWConfigOfflinePrivate *priv = FW_CONFIG_OFFLINE_GET_PRIVATE(obj);
+    FWConfigOfflineEntry *entry;
+    GVariant *result;
+
+#ifdef FW_DEBUG
+    g_printerr("fw_config_offline_call(%s, %s)\n", path, method_name);
+#endif
+
+    if (parameters != NULL)
+	g_variant_ref_sink(parameters);
+
+    if (path == NULL || strcmp(path, FW_DBUS_PATH_CONFIG) == 0) {
+	result = _fw_config_offline_config_call(priv, method_name, parameters,
+						error);
+    } else if ((entry = g_hash_table_lookup(priv->paths, path)) != NULL) {
+	result = _fw_config_offline_object_call(priv, entry, method_name,
+						parameters, error);
+    } else {
+	g_set_error(error, G_DBUS_ERROR, G_DBUS_ERROR_UNKNOWN_OBJECT,
+		    "No such object path '%s'", path);
+	result = NULL;
+    }
+
+    if (parameters != NULL)
+	g_variant_unref(parameters);
+
+    if (result != NULL)
+	g_variant_ref_sink(result);
+
+    return result;
+}
@@ -0,0 +1,59 @@
+/*
+ * Copyright (C) 2017 Red Hat, Inc.
+ *
+ * Authors:
+ * Thomas Woerner <twoerner@redhat.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __FW_CONFIG_OFFLINE_H__
+#define __FW_CONFIG_OFFLINE_H__
+
+#include <glib.h>
+#include <glib-object.h>
+#include "firewall.h"
+#include "fw_xml.h"
+
+#define FW_CONFIG_OFFLINE_TYPE            (fw_config_offline_get_type())
+#define FW_CONFIG_OFFLINE(obj)            (G_TYPE_CHECK_INSTANCE_CAST((obj), FW_CONFIG_OFFLINE_TYPE, FWConfigOffline))
+#define FW_CONFIG_OFFLINE_CLASS(klass)    (G_TYPE_CHECK_CLASS_CAST((klass), FW_CONFIG_OFFLINE_TYPE, FWConfigOfflineClass))
+#define FW_IS_CONFIG_OFFLINE(klass)       (G_TYPE_CHECK_INSTANCE_CLASS((klass), FW_CONFIG_OFFLINE_TYPE, FWConfigOfflineClass))
+#define FW_CONFIG_OFFLINE_GET_CLASS(obj)  (G_TYPE_INSTANCE_GET_CLASS((obj), FW_CONFIG_OFFLINE_TYPE, FWConfigOfflineClass))
+
+#define FW_CONFIG_OFFLINE_DEFAULT_DIR     "/usr/lib/firewalld"
+#define FW_CONFIG_OFFLINE_CONFIG_DIR      "/etc/firewalld"
+
+typedef struct {
+    GObject parent;
+} FWConfigOffline;
+
+typedef struct {
+    GObjectClass parent;
+} FWConfigOfflineClass;
+
+GType fw_config_offline_get_type(void);
+FWConfigOffline *fw_config_offline_new(const gchar *default_dir,
+				       const gchar *config_dir);
+
+const gchar *fw_config_offline_getDefaultDir(FWConfigOffline *obj);
+const gchar *fw_config_offline_getConfigDir(FWConfigOffline *obj);
+
+GVariant *fw_config_offline_call(FWConfigOffline *obj,
+				 const gchar *path,
+				 const gchar *method_name,
+				 GVariant *parameters,
+				 GError **error);
+
+#endif /* __FW_CONFIG_OFFLINE_H__ */
@@ -20,6 +20,8 @@
 
 #include <string.h>
 #include "fw_config_service.h"
+#include "fw_trace.h"
+#include "fw_accounting.h"
 #include "fw_functions.h"
 
 G_DEFINE_TYPE(FWConfigService, fw_config_service, G_TYPE_OBJECT);
@@ -32,6 +34,9 @@ typedef struct {
     GError *error;
 
     gchar *path;
+
+    /* offline backend, NULL if connected to firewalld */
+    FWConfigOffline *offline;
 } FWConfigServicePrivate;
 
 enum _FWConfigServiceProperties {
@@ -63,6 +68,26 @@ fw_config_service_new(gchar *path)
     */
 }
 
+/**
+ * fw_config_service_new_offline:
+ * @offline: (type FWConfigOffline*): the offline backend
+ * @path: (type utf8): object path of the service in the backend
+ *
+ * Returns: (transfer full) (type FWConfigService*)
+ */
+FWConfigService *
+fw_config_service_new_offline(FWConfigOffline *offline,
+			      gchar *path)
+{
+    FWConfigService *obj = g_object_new(FW_CONFIG_SERVICE_TYPE, NULL);
+    FWConfigServicePrivate *priv = FW_CONFIG_SERVICE_GET_PRIVATE(obj);
+
+    priv->path = g_strdup(path);
+    priv->offline = g_object_ref(offline);
+
+    return obj;
+}
+
 static void
 fw_config_service_init(FWConfigService *obj)
 {
@@ -72,19 +97,8 @@ fw_config_service_init(FWConfigService *obj)
     priv->connection = NULL;
     priv->proxy = NULL;
     priv->error = NULL;
-
-    priv->connection = g_bus_get_sync(G_BUS_TYPE_SYSTEM, NULL, &priv->error);
-    if (priv->error != NULL) {
-        g_print("ERROR: Failed to connect to system bus: %s",
-		priv->error->message);
-	return;
-    }
-
-#ifdef FW_DEBUG
-    gchar *conn_name;
-    g_object_get(priv->connection, "unique-name", &conn_name, NULL);
-    g_free(conn_name);
-#endif
+    priv->path = NULL;
+    priv->offline = NULL;
 }
 
 static void
@@ -115,6 +129,19 @@ _fw_config_service_dbus_connect(FWConfigServicePrivate *priv)
 {
     _fw_config_service_reset_error(priv);
 
+    priv->connection = g_bus_get_sync(G_BUS_TYPE_SYSTEM, NULL, &priv->error);
+    if (priv->error != NULL) {
+        g_print("ERROR: Failed to connect to system bus: %s",
+		priv->error->message);
+	return;
+    }
+
+#ifdef FW_DEBUG
+    gchar *conn_name;
+    g_object_get(priv->connection, "unique-name", &conn_name, NULL);
+    g_free(conn_name);
+#endif
+
     /* create syncroneous proxies */
     priv->proxy = g_dbus_proxy_new_sync(priv->connection,
 					G_DBUS_PROXY_FLAGS_NONE,
@@ -148,6 +175,10 @@ fw_config_service_finalize(GObject *obj)
 
     _fw_config_service_reset_error(priv);
 
+    if (priv->offline != NULL)
+	g_object_unref(priv->offline);
+    g_free(priv->path);
+
     /* disconnect */
     /***/
 
@@ -220,6 +251,7 @@ fw_config_service_class_init(FWConfigServiceClass *fw_config_service_class)
     obj_class->finalize = fw_config_service_finalize;
 
     g_type_class_add_private(obj_class, sizeof(FWConfigServicePrivate));
+    fw_accounting_register(obj_class, sizeof(FWConfigServicePrivate));
 }
 
 GVariant *
@@ -232,13 +264,26 @@ _fw_config_service_proxy_call_sync(FWConfigServicePrivate *priv,
 
     _fw_config_service_reset_error(priv);
 
-    result = g_dbus_proxy_call_sync(proxy,
-				    method_name,
-				    parameters,
-				    G_DBUS_CALL_FLAGS_NONE,
-				    -1,
-				    NULL,
-				    &priv->error);
+    FW_TRACE_CALL_START(method_name, (priv->offline != NULL) ?
+			priv->path : FW_TRACE_PROXY_PATH(proxy), parameters);
+
+    if (priv->offline != NULL)
+	result = fw_config_offline_call(priv->offline, priv->path,
+					method_name, parameters,
+					&priv->error);
+    else
+	result = g_dbus_proxy_call_sync(proxy,
+					method_name,
+					parameters,
+					G_DBUS_CALL_FLAGS_NONE,
+					-1,
+					NULL,
+					&priv->error);
+
+    FW_TRACE_CALL_DONE(method_name, (priv->offline != NULL) ?
+		       priv->path : FW_TRACE_PROXY_PATH(proxy), result,
+		       priv->error);
+
     if (priv->error != NULL) {
         g_print(_("ERROR: %s failed: %s\n"), method_name, priv->error->message);
     }
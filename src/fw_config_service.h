@@ -25,6 +25,7 @@
 #include <glib-object.h>
 #include <gio/gio.h>
 #include "firewall.h"
+#include "fw_config_offline.h"
 #include "fw_functions.h"
 #include "fw_port.h"
 #include "fw_service.h"
@@ -45,6 +46,8 @@ typedef struct {
 
 GType fw_config_service_get_type(void);
 FWConfigService *fw_config_service_new(gchar *path);
+FWConfigService *fw_config_service_new_offline(FWConfigOffline *offline,
+					       gchar *path);
 
 void fw_config_service_print_str(FWConfigService *obj);
 
@@ -20,6 +20,8 @@
 
 #include <string.h>
 #include "fw_config_zone.h"
+#include "fw_trace.h"
+#include "fw_accounting.h"
 #include "fw_functions.h"
 
 G_DEFINE_TYPE(FWConfigZone, fw_config_zone, G_TYPE_OBJECT);
@@ -32,6 +34,9 @@ typedef struct {
     GError *error;
 
     gchar *path;
+
+    /* offline backend, NULL if connected to firewalld */
+    FWConfigOffline *offline;
 } FWConfigZonePrivate;
 
 enum _FWConfigZoneProperties {
@@ -63,6 +68,26 @@ fw_config_zone_new(gchar *path)
     */
 }
 
+/**
+ * fw_config_zone_new_offline:
+ * @offline: (type FWConfigOffline*): the offline backend
+ * @path: (type utf8): object path of the zone in the backend
+ *
+ * Returns: (transfer full) (type FWConfigZone*)
+ */
+FWConfigZone *
+fw_config_zone_new_offline(FWConfigOffline *offline,
+			   gchar *path)
+{
+    FWConfigZone *obj = g_object_new(FW_CONFIG_ZONE_TYPE, NULL);
+    FWConfigZonePrivate *priv = FW_CONFIG_ZONE_GET_PRIVATE(obj);
+
+    priv->path = g_strdup(path);
+    priv->offline = g_object_ref(offline);
+
+    return obj;
+}
+
 static void
 fw_config_zone_init(FWConfigZone *obj)
 {
@@ -72,19 +97,8 @@ fw_config_zone_init(FWConfigZone *obj)
     priv->connection = NULL;
     priv->proxy = NULL;
     priv->error = NULL;
-
-    priv->connection = g_bus_get_sync(G_BUS_TYPE_SYSTEM, NULL, &priv->error);
-    if (priv->error != NULL) {
-        g_print("ERROR: Failed to connect to system bus: %s",
-		priv->error->message);
-	return;
-    }
-
-#ifdef FW_DEBUG
-    gchar *conn_name;
-    g_object_get(priv->connection, "unique-name", &conn_name, NULL);
-    g_free(conn_name);
-#endif
+    priv->path = NULL;
+    priv->offline = NULL;
 }
 
 static void
@@ -115,6 +129,19 @@ _fw_config_zone_dbus_connect(FWConfigZonePrivate *priv)
 {
     _fw_config_zone_reset_error(priv);
 
+    priv->connection = g_bus_get_sync(G_BUS_TYPE_SYSTEM, NULL, &priv->error);
+    if (priv->error != NULL) {
+        g_print("ERROR: Failed to connect to system bus: %s",
+		priv->error->message);
+	return;
+    }
+
+#ifdef FW_DEBUG
+    gchar *conn_name;
+    g_object_get(priv->connection, "unique-name", &conn_name, NULL);
+    g_free(conn_name);
+#endif
+
     /* create syncroneous proxies */
     priv->proxy = g_dbus_proxy_new_sync(priv->connection,
 					G_DBUS_PROXY_FLAGS_NONE,
@@ -148,6 +175,10 @@ fw_config_zone_finalize(GObject *obj)
 
     _fw_config_zone_reset_error(priv);
 
+    if (priv->offline != NULL)
+	g_object_unref(priv->offline);
+    g_free(priv->path);
+
     /* disconnect */
     /***/
 
@@ -220,6 +251,7 @@ fw_config_zone_class_init(FWConfigZoneClass *fw_config_zone_class)
     obj_class->finalize = fw_config_zone_finalize;
 
     g_type_class_add_private(obj_class, sizeof(FWConfigZonePrivate));
+    fw_accounting_register(obj_class, sizeof(FWConfigZonePrivate));
 }
 
 GVariant *
@@ -232,13 +264,26 @@ _fw_config_zone_proxy_call_sync(FWConfigZonePrivate *priv,
 
     _fw_config_zone_reset_error(priv);
 
-    result = g_dbus_proxy_call_sync(proxy,
-				    method_name,
-				    parameters,
-				    G_DBUS_CALL_FLAGS_NONE,
-				    -1,
-				    NULL,
-				    &priv->error);
+    FW_TRACE_CALL_START(method_name, (priv->offline != NULL) ?
+			priv->path : FW_TRACE_PROXY_PATH(proxy), parameters);
+
+    if (priv->offline != NULL)
+	result = fw_config_offline_call(priv->offline, priv->path,
+					method_name, parameters,
+					&priv->error);
+    else
+	result = g_dbus_proxy_call_sync(proxy,
+					method_name,
+					parameters,
+					G_DBUS_CALL_FLAGS_NONE,
+					-1,
+					NULL,
+					&priv->error);
+
+    FW_TRACE_CALL_DONE(method_name, (priv->offline != NULL) ?
+		       priv->path : FW_TRACE_PROXY_PATH(proxy), result,
+		       priv->error);
+
     if (priv->error != NULL) {
         g_print(_("ERROR: %s failed: %s\n"), method_name, priv->error->message);
     }
@@ -25,6 +25,7 @@
 #include <glib-object.h>
 #include <gio/gio.h>
 #include "firewall.h"
+#include "fw_config_offline.h"
 #include "fw_functions.h"
 #include "fw_port.h"
 #include "fw_zone.h"
@@ -45,6 +46,8 @@ typedef struct {
 
 GType fw_config_zone_get_type(void);
 FWConfigZone *fw_config_zone_new(gchar *path);
+FWConfigZone *fw_config_zone_new_offline(FWConfigOffline *offline,
+					 gchar *path);
 
 void fw_config_zone_print_str(FWConfigZone *obj);
 
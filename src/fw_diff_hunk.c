@@ -0,0 +1,275 @@
+/*
+ * Copyright (C) 2017 Red Hat, Inc.
+ *
+ * Authors:
+ * Thomas Woerner <twoerner@redhat.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "fw_diff_hunk.h"
+#include "fw_accounting.h"
+
+G_DEFINE_TYPE(FWDiffHunk, fw_diff_hunk, G_TYPE_OBJECT);
+
+#define FW_DIFF_HUNK_GET_PRIVATE(o) (G_TYPE_INSTANCE_GET_PRIVATE((o), FW_DIFF_HUNK_TYPE, FWDiffHunkPrivate))
+
+typedef struct {
+    gchar *zone;		/* string */
+    gchar *field;		/* string */
+    FWDiffHunkOperation operation;
+    gchar *item;		/* string */
+    gchar *permanent_item;	/* string */
+
+    /* call to the permanent zone that applies the hunk */
+    gchar *path;
+    const gchar *method_name;	/* interned */
+    GVariant *parameters;
+} FWDiffHunkPrivate;
+
+FWDiffHunk *
+fw_diff_hunk_new()
+{
+    return g_object_new(FW_DIFF_HUNK_TYPE, NULL);
+}
+
+static void
+fw_diff_hunk_init(FWDiffHunk *obj)
+{
+    FWDiffHunkPrivate *priv = FW_DIFF_HUNK_GET_PRIVATE(obj);
+
+    /* init vars */
+    priv->zone = g_strdup("");
+    priv->field = g_strdup("");
+    priv->operation = FW_DIFF_HUNK_RUNTIME_ONLY;
+    priv->item = g_strdup("");
+    priv->permanent_item = g_strdup("");
+    priv->path = NULL;
+    priv->method_name = NULL;
+    priv->parameters = NULL;
+}
+
+static void
+fw_diff_hunk_finalize(GObject *obj)
+{
+    FWDiffHunkPrivate *priv = FW_DIFF_HUNK_GET_PRIVATE(obj);
+
+    g_free(priv->zone);
+    g_free(priv->field);
+    g_free(priv->item);
+    g_free(priv->permanent_item);
+    g_free(priv->path);
+    if (priv->parameters != NULL)
+	g_variant_unref(priv->parameters);
+
+    G_OBJECT_CLASS(fw_diff_hunk_parent_class)->finalize(obj);
+}
+
+static void
+fw_diff_hunk_class_init(FWDiffHunkClass *fw_diff_hunk_class)
+{
+    GObjectClass *obj_class = G_OBJECT_CLASS(fw_diff_hunk_class);
+
+    obj_class->finalize = fw_diff_hunk_finalize;
+
+    g_type_class_add_private(obj_class, sizeof(FWDiffHunkPrivate));
+    fw_accounting_register(obj_class, sizeof(FWDiffHunkPrivate));
+}
+
+/* methods */
+
+/**
+ * fw_diff_hunk_getZone:
+ * @obj: (type FWDiffHunk*): a FWDiffHunk instance
+ *
+ * Returns: (type gchar*)
+ */
+gchar *
+fw_diff_hunk_getZone(FWDiffHunk *obj)
+{
+    FWDiffHunkPrivate *priv = FW_DIFF_HUNK_GET_PRIVATE(obj);
+
+    return priv->zone;
+}
+
+/**
+ * fw_diff_hunk_getField:
+ * @obj: (type FWDiffHunk*): a FWDiffHunk instance
+ *
+ * The zone setting, for example "services", "ports" or "target".
+ *
+ * Returns: (type gchar*)
+ */
+gchar *
+fw_diff_hunk_getField(FWDiffHunk *obj)
+{
+    FWDiffHunkPrivate *priv = FW_DIFF_HUNK_GET_PRIVATE(obj);
+
+    return priv->field;
+}
+
+FWDiffHunkOperation
+fw_diff_hunk_getOperation(FWDiffHunk *obj)
+{
+    FWDiffHunkPrivate *priv = FW_DIFF_HUNK_GET_PRIVATE(obj);
+
+    return priv->operation;
+}
+
+/**
+ * fw_diff_hunk_getItem:
+ * @obj: (type FWDiffHunk*): a FWDiffHunk instance
+ *
+ * The item in firewall-cmd syntax, the runtime value for changed values.
+ *
+ * Returns: (type gchar*)
+ */
+gchar *
+fw_diff_hunk_getItem(FWDiffHunk *obj)
+{
+    FWDiffHunkPrivate *priv = FW_DIFF_HUNK_GET_PRIVATE(obj);
+
+    return priv->item;
+}
+
+/**
+ * fw_diff_hunk_getPermanentItem:
+ * @obj: (type FWDiffHunk*): a FWDiffHunk instance
+ *
+ * The permanent value for changed values, "" otherwise.
+ *
+ * Returns: (type gchar*)
+ */
+gchar *
+fw_diff_hunk_getPermanentItem(FWDiffHunk *obj)
+{
+    FWDiffHunkPrivate *priv = FW_DIFF_HUNK_GET_PRIVATE(obj);
+
+    return priv->permanent_item;
+}
+
+/**
+ * fw_diff_hunk_setZone:
+ * @obj: (type FWDiffHunk*): a FWDiffHunk instance
+ * @zone: (type gchar*)
+ */
+void
+fw_diff_hunk_setZone(FWDiffHunk *obj, const gchar *zone)
+{
+    FWDiffHunkPrivate *priv = FW_DIFF_HUNK_GET_PRIVATE(obj);
+
+    g_free(priv->zone);
+    priv->zone = g_strdup(zone);
+}
+
+/**
+ * fw_diff_hunk_setField:
+ * @obj: (type FWDiffHunk*): a FWDiffHunk instance
+ * @field: (type gchar*)
+ */
+void
+fw_diff_hunk_setField(FWDiffHunk *obj, const gchar *field)
+{
+    FWDiffHunkPrivate *priv = FW_DIFF_HUNK_GET_PRIVATE(obj);
+
+    g_free(priv->field);
+    priv->field = g_strdup(field);
+}
+
+void
+fw_diff_hunk_setOperation(FWDiffHunk *obj, FWDiffHunkOperation operation)
+{
+    FWDiffHunkPrivate *priv = FW_DIFF_HUNK_GET_PRIVATE(obj);
+
+    priv->operation = operation;
+}
+
+/**
+ * fw_diff_hunk_setItem:
+ * @obj: (type FWDiffHunk*): a FWDiffHunk instance
+ * @item: (type gchar*)
+ */
+void
+fw_diff_hunk_setItem(FWDiffHunk *obj, const gchar *item)
+{
+    FWDiffHunkPrivate *priv = FW_DIFF_HUNK_GET_PRIVATE(obj);
+
+    g_free(priv->item);
+    priv->item = g_strdup(item);
+}
+
+/**
+ * fw_diff_hunk_setPermanentItem:
+ * @obj: (type FWDiffHunk*): a FWDiffHunk instance
+ * @item: (type gchar*)
+ */
+void
+fw_diff_hunk_setPermanentItem(FWDiffHunk *obj, const gchar *item)
+{
+    FWDiffHunkPrivate *priv = FW_DIFF_HUNK_GET_PRIVATE(obj);
+
+    g_free(priv->permanent_item);
+    priv->permanent_item = g_strdup(item);
+}
+
+/**
+ * fw_diff_hunk_setCall:
+ * @obj: (type FWDiffHunk*): a FWDiffHunk instance
+ * @path: (type utf8): object path of the permanent zone
+ * @method_name: (type utf8): method of the config zone interface
+ * @parameters: (type GVariant*) (allow-none): method parameters, a
+ *   floating reference is consumed
+ *
+ * Sets the call that applies the runtime state of the hunk to the
+ * permanent configuration.
+ */
+void
+fw_diff_hunk_setCall(FWDiffHunk *obj,
+		     const gchar *path,
+		     const gchar *method_name,
+		     GVariant *parameters)
+{
+    FWDiffHunkPrivate *priv = FW_DIFF_HUNK_GET_PRIVATE(obj);
+
+    g_free(priv->path);
+    priv->path = g_strdup(path);
+    priv->method_name = g_intern_string(method_name);
+    if (priv->parameters != NULL)
+	g_variant_unref(priv->parameters);
+    priv->parameters = (parameters != NULL) ?
+	g_variant_ref_sink(parameters) : NULL;
+}
+
+/**
+ * fw_diff_hunk_queue:
+ * @obj: (type FWDiffHunk*): a FWDiffHunk instance
+ * @batch: (type FWBatch*): batch to add the call to
+ *
+ * Returns: number of calls added to the batch
+ */
+guint
+fw_diff_hunk_queue(FWDiffHunk *obj,
+		   FWBatch *batch)
+{
+    FWDiffHunkPrivate *priv = FW_DIFF_HUNK_GET_PRIVATE(obj);
+
+    if (priv->method_name == NULL)
+	return 0;
+
+    /* not floating: the batch takes its own reference */
+    fw_batch_add(batch, priv->path, FW_DBUS_INTERFACE_CONFIG_ZONE,
+		 priv->method_name, priv->parameters);
+
+    return 1;
+}
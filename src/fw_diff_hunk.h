@@ -0,0 +1,68 @@
+/*
+ * Copyright (C) 2017 Red Hat, Inc.
+ *
+ * Authors:
+ * Thomas Woerner <twoerner@redhat.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __FW_DIFF_HUNK_H__
+#define __FW_DIFF_HUNK_H__
+
+#include <glib.h>
+#include <glib-object.h>
+#include "firewall.h"
+#include "fw_batch.h"
+
+#define FW_DIFF_HUNK_TYPE            (fw_diff_hunk_get_type())
+#define FW_DIFF_HUNK(obj)            (G_TYPE_CHECK_INSTANCE_CAST((obj), FW_DIFF_HUNK_TYPE, FWDiffHunk))
+#define FW_DIFF_HUNK_CLASS(klass)    (G_TYPE_CHECK_CLASS_CAST((klass), FW_DIFF_HUNK_TYPE, FWDiffHunkClass))
+#define FW_IS_DIFF_HUNK(klass)       (G_TYPE_CHECK_INSTANCE_CLASS((klass), FW_DIFF_HUNK_TYPE, FWDiffHunkClass))
+#define FW_DIFF_HUNK_GET_CLASS(obj)  (G_TYPE_INSTANCE_GET_CLASS((obj), FW_DIFF_HUNK_TYPE, FWDiffHunkClass))
+
+typedef struct {
+    GObject parent;
+} FWDiffHunk;
+
+typedef struct {
+    GObjectClass parent;
+} FWDiffHunkClass;
+
+/* how runtime and permanent configuration differ */
+typedef enum {
+    FW_DIFF_HUNK_RUNTIME_ONLY,		/* item only in runtime */
+    FW_DIFF_HUNK_PERMANENT_ONLY,	/* item only in permanent */
+    FW_DIFF_HUNK_CHANGED,		/* value differs */
+} FWDiffHunkOperation;
+
+GType fw_diff_hunk_get_type(void);
+FWDiffHunk *fw_diff_hunk_new(void);
+
+gchar *fw_diff_hunk_getZone(FWDiffHunk *obj);
+gchar *fw_diff_hunk_getField(FWDiffHunk *obj);
+FWDiffHunkOperation fw_diff_hunk_getOperation(FWDiffHunk *obj);
+gchar *fw_diff_hunk_getItem(FWDiffHunk *obj);
+gchar *fw_diff_hunk_getPermanentItem(FWDiffHunk *obj);
+
+void fw_diff_hunk_setZone(FWDiffHunk *obj, const gchar *zone);
+void fw_diff_hunk_setField(FWDiffHunk *obj, const gchar *field);
+void fw_diff_hunk_setOperation(FWDiffHunk *obj, FWDiffHunkOperation operation);
+void fw_diff_hunk_setItem(FWDiffHunk *obj, const gchar *item);
+void fw_diff_hunk_setPermanentItem(FWDiffHunk *obj, const gchar *item);
+
+void fw_diff_hunk_setCall(FWDiffHunk *obj, const gchar *path, const gchar *method_name, GVariant *parameters);
+guint fw_diff_hunk_queue(FWDiffHunk *obj, FWBatch *batch);
+
+#endif /* __FW_DIFF_HUNK_H__ */
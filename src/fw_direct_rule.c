@@ -19,7 +19,10 @@
  */
 
 #include "fw_direct_rule.h"
+#include "fw_trace.h"
+#include "fw_accounting.h"
 #include "fw_functions.h"
+#include <string.h>
 
 G_DEFINE_TYPE(FWDirectRule, fw_direct_rule, G_TYPE_OBJECT);
 
@@ -39,6 +42,59 @@ fw_direct_rule_new()
     return g_object_new(FW_DIRECT_RULE_TYPE, NULL);
 }
 
+/**
+ * fw_direct_rule_list_new_from_variant:
+ * @variant: (type GVariant*): getAllRules reply of type (a(sssias))
+ *
+ * Returns: (transfer full) (allow-none) (element-type FWDirectRule*)
+ */
+GList *
+fw_direct_rule_list_new_from_variant(GVariant *variant)
+{
+    GVariantIter iter;
+    const gchar *ipv, *table, *chain;
+    gint32 priority;
+    GVariant *args;
+    GList *list = NULL;
+
+    if (variant == NULL)
+	return NULL;
+
+    if (strncmp(g_variant_get_type_string(variant), "(a(sssias))", 11) != 0) {
+	if (strncmp(g_variant_get_type_string(variant), "a(sssias)", 9) != 0)
+	    return NULL;
+	g_variant_ref(variant);
+    } else
+	variant = g_variant_get_child_value(variant, 0);
+
+    FW_TRACE_DECODE_START(variant);
+
+    g_variant_iter_init(&iter, variant);
+    while (g_variant_iter_next(&iter, "(&s&s&si@as)", &ipv, &table, &chain,
+			       &priority, &args))
+    {
+	FWDirectRule *rule = fw_direct_rule_new();
+	FWDirectRulePrivate *priv = FW_DIRECT_RULE_GET_PRIVATE(rule);
+
+	g_free(priv->ipv);
+	priv->ipv = g_strdup(ipv);
+	g_free(priv->table);
+	priv->table = g_strdup(table);
+	g_free(priv->chain);
+	priv->chain = g_strdup(chain);
+	priv->priority = priority;
+	priv->args = fw_str_list_new_from_variant(args);
+	list = g_list_prepend(list, rule);
+
+	g_variant_unref(args);
+    }
+
+    g_variant_unref(variant);
+
+    FW_TRACE_DECODE_DONE();
+    return g_list_reverse(list);
+}
+
 static void
 fw_direct_rule_init(FWDirectRule *obj)
 {
@@ -77,6 +133,7 @@ fw_direct_rule_class_init(FWDirectRuleClass *fw_direct_rule_class)
     obj_class->finalize = fw_direct_rule_finalize;
 
     g_type_class_add_private(obj_class, sizeof(FWDirectRulePrivate));
+    fw_accounting_register(obj_class, sizeof(FWDirectRulePrivate));
 }
 
 /* methods */
@@ -41,6 +41,7 @@ typedef struct {
 
 GType fw_direct_rule_get_type(void);
 FWDirectRule *fw_direct_rule_new(void);
+GList *fw_direct_rule_list_new_from_variant(GVariant *variant);
 
 gchar *fw_direct_rule_getIpv(FWDirectRule *obj);
 gchar *fw_direct_rule_getTable(FWDirectRule *obj);
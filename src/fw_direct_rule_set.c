@@ -0,0 +1,761 @@
+/*
+ * Copyright (C) 2017 Red Hat, Inc.
+ *
+ * Authors:
+ * Thomas Woerner <twoerner@redhat.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Set of direct rules indexed by (ipv, table, chain). The rules of a chain
+ * are kept in priority order, rules with the same priority in the order
+ * they have been added, which is the order firewalld applies them in.
+ * Every rule is also hashed by all of its fields including the args, so
+ * that membership tests do not depend on the number of rules.
+ */
+
+#include <string.h>
+#include "fw_direct_rule_set.h"
+#include "fw_trace.h"
+#include "fw_accounting.h"
+
+G_DEFINE_TYPE(FWDirectRuleSet, fw_direct_rule_set, G_TYPE_OBJECT);
+
+#define FW_DIRECT_RULE_SET_GET_PRIVATE(o) (G_TYPE_INSTANCE_GET_PRIVATE((o), FW_DIRECT_RULE_SET_TYPE, FWDirectRuleSetPrivate))
+
+typedef struct {
+    gchar *key;			/* chain key */
+    gchar *ipv;
+    gchar *table;
+    gchar *chain;
+    GSequence *entries;		/* FWDirectRuleSetEntry, by priority */
+} FWDirectRuleSetChain;
+
+typedef struct {
+    gchar *key;			/* rule key */
+    FWDirectRule *rule;
+    guint64 serial;		/* insertion order */
+    FWDirectRuleSetChain *chain;
+    GSequenceIter *iter;
+} FWDirectRuleSetEntry;
+
+typedef struct {
+    GHashTable *chains;		/* chain key -> FWDirectRuleSetChain */
+    GHashTable *rules;		/* rule key -> FWDirectRuleSetEntry */
+    guint64 serial;
+} FWDirectRuleSetPrivate;
+
+/* keys: length prefixed fields, the chain key is a prefix of the rule key */
+
+static void
+_fw_direct_rule_set_key_append(GString *key,
+			       const gchar *str)
+{
+    gsize len = strlen(str);
+
+    g_string_append_printf(key, "%" G_GSIZE_FORMAT ":", len);
+    g_string_append_len(key, str, len);
+}
+
+static void
+_fw_direct_rule_set_chain_key(GString *key,
+			      const gchar *ipv,
+			      const gchar *table,
+			      const gchar *chain)
+{
+    g_string_truncate(key, 0);
+    _fw_direct_rule_set_key_append(key, ipv);
+    _fw_direct_rule_set_key_append(key, table);
+    _fw_direct_rule_set_key_append(key, chain);
+}
+
+/* returns the length of the chain key part */
+static gsize
+_fw_direct_rule_set_rule_key(GString *key,
+			     const gchar *ipv,
+			     const gchar *table,
+			     const gchar *chain,
+			     gint32 priority,
+			     const GList *args)
+{
+    const GList *l;
+    gsize chain_len;
+
+    _fw_direct_rule_set_chain_key(key, ipv, table, chain);
+    chain_len = key->len;
+    g_string_append_printf(key, "%d;", priority);
+    for (l = args; l != NULL; l = l->next)
+	_fw_direct_rule_set_key_append(key, l->data);
+
+    return chain_len;
+}
+
+static void
+_fw_direct_rule_set_chain_free(gpointer data)
+{
+    FWDirectRuleSetChain *chain = data;
+
+    g_sequence_free(chain->entries);
+    g_free(chain->key);
+    g_free(chain->ipv);
+    g_free(chain->table);
+    g_free(chain->chain);
+    g_slice_free(FWDirectRuleSetChain, chain);
+}
+
+static void
+_fw_direct_rule_set_entry_free(gpointer data)
+{
+    FWDirectRuleSetEntry *entry = data;
+
+    g_object_unref(entry->rule);
+    g_free(entry->key);
+    g_slice_free(FWDirectRuleSetEntry, entry);
+}
+
+static gint
+_fw_direct_rule_set_entry_cmp(gconstpointer a,
+			      gconstpointer b,
+			      gpointer user_data)
+{
+    const FWDirectRuleSetEntry *entry_a = a;
+    const FWDirectRuleSetEntry *entry_b = b;
+    gint32 priority_a = fw_direct_rule_getPriority(entry_a->rule);
+    gint32 priority_b = fw_direct_rule_getPriority(entry_b->rule);
+
+    if (priority_a != priority_b)
+	return (priority_a < priority_b) ? -1 : 1;
+    if (entry_a->serial != entry_b->serial)
+	return (entry_a->serial < entry_b->serial) ? -1 : 1;
+    return 0;
+}
+
+static gint
+_fw_direct_rule_set_chain_cmp(gconstpointer a,
+			      gconstpointer b)
+{
+    const FWDirectRuleSetChain *chain_a = a;
+    const FWDirectRuleSetChain *chain_b = b;
+    gint ret;
+
+    ret = strcmp(chain_a->ipv, chain_b->ipv);
+    if (ret == 0)
+	ret = strcmp(chain_a->table, chain_b->table);
+    if (ret == 0)
+	ret = strcmp(chain_a->chain, chain_b->chain);
+    return ret;
+}
+
+/* chains sorted by ipv, table and chain */
+static GList *
+_fw_direct_rule_set_get_chains(FWDirectRuleSetPrivate *priv)
+{
+    return g_list_sort(g_hash_table_get_values(priv->chains),
+		       _fw_direct_rule_set_chain_cmp);
+}
+
+FWDirectRuleSet *
+fw_direct_rule_set_new()
+{
+    return g_object_new(FW_DIRECT_RULE_SET_TYPE, NULL);
+}
+
+static void
+fw_direct_rule_set_init(FWDirectRuleSet *obj)
+{
+    FWDirectRuleSetPrivate *priv = FW_DIRECT_RULE_SET_GET_PRIVATE(obj);
+
+    /* init vars */
+    priv->chains = g_hash_table_new_full(g_str_hash, g_str_equal, NULL,
+					 _fw_direct_rule_set_chain_free);
+    priv->rules = g_hash_table_new_full(g_str_hash, g_str_equal, NULL,
+					_fw_direct_rule_set_entry_free);
+    priv->serial = 0;
+}
+
+static void
+fw_direct_rule_set_finalize(GObject *obj)
+{
+    FWDirectRuleSetPrivate *priv = FW_DIRECT_RULE_SET_GET_PRIVATE(obj);
+
+    g_hash_table_destroy(priv->chains);
+    g_hash_table_destroy(priv->rules);
+
+    G_OBJECT_CLASS(fw_direct_rule_set_parent_class)->finalize(obj);
+}
+
+static void
+fw_direct_rule_set_class_init(FWDirectRuleSetClass *fw_direct_rule_set_class)
+{
+    GObjectClass *obj_class = G_OBJECT_CLASS(fw_direct_rule_set_class);
+
+    obj_class->finalize = fw_direct_rule_set_finalize;
+
+    g_type_class_add_private(obj_class, sizeof(FWDirectRuleSetPrivate));
+    fw_accounting_register(obj_class, sizeof(FWDirectRuleSetPrivate));
+}
+
+/* internal add and remove, key has to be the rule key */
+
+static gboolean
+_fw_direct_rule_set_insert(FWDirectRuleSetPrivate *priv,
+			   GString *key,
+			   gsize chain_len,
+			   const gchar *ipv,
+			   const gchar *table,
+			   const gchar *chain_name,
+			   gint32 priority,
+			   const GList *args)
+{
+    FWDirectRuleSetChain *chain;
+    FWDirectRuleSetEntry *entry;
+    gchar *chain_key;
+
+    if (g_hash_table_contains(priv->rules, key->str))
+	return FALSE;
+
+    chain_key = g_strndup(key->str, chain_len);
+    chain = g_hash_table_lookup(priv->chains, chain_key);
+    if (chain == NULL) {
+	chain = g_slice_new(FWDirectRuleSetChain);
+	chain->key = chain_key;
+	chain->ipv = g_strdup(ipv);
+	chain->table = g_strdup(table);
+	chain->chain = g_strdup(chain_name);
+	chain->entries = g_sequence_new(NULL);
+	g_hash_table_insert(priv->chains, chain->key, chain);
+    } else
+	g_free(chain_key);
+
+    entry = g_slice_new(FWDirectRuleSetEntry);
+    entry->key = g_strdup(key->str);
+    entry->rule = fw_direct_rule_new();
+    fw_direct_rule_setIpv(entry->rule, chain->ipv);
+    fw_direct_rule_setTable(entry->rule, chain->table);
+    fw_direct_rule_setChain(entry->rule, chain->chain);
+    fw_direct_rule_setPriority(entry->rule, priority);
+    fw_direct_rule_setArgs(entry->rule, (GList *) args);
+    entry->serial = priv->serial++;
+    entry->chain = chain;
+    entry->iter = g_sequence_insert_sorted(chain->entries, entry,
+					   _fw_direct_rule_set_entry_cmp,
+					   NULL);
+    g_hash_table_insert(priv->rules, entry->key, entry);
+
+    return TRUE;
+}
+
+static gboolean
+_fw_direct_rule_set_delete(FWDirectRuleSetPrivate *priv,
+			   const gchar *key)
+{
+    FWDirectRuleSetEntry *entry;
+    FWDirectRuleSetChain *chain;
+
+    entry = g_hash_table_lookup(priv->rules, key);
+    if (entry == NULL)
+	return FALSE;
+
+    chain = entry->chain;
+    g_sequence_remove(entry->iter);
+    g_hash_table_remove(priv->rules, key);
+    if (g_sequence_get_begin_iter(chain->entries) ==
+	g_sequence_get_end_iter(chain->entries))
+	g_hash_table_remove(priv->chains, chain->key);
+
+    return TRUE;
+}
+
+/**
+ * fw_direct_rule_set_new_from_variant:
+ * @variant: (type GVariant*): rules as a(sssias) or (a(sssias)) like
+ *   returned by getAllRules
+ *
+ * Returns: (transfer full) (type FWDirectRuleSet*)
+ */
+FWDirectRuleSet *
+fw_direct_rule_set_new_from_variant(GVariant *variant)
+{
+    FWDirectRuleSet *obj = fw_direct_rule_set_new();
+    FWDirectRuleSetPrivate *priv = FW_DIRECT_RULE_SET_GET_PRIVATE(obj);
+    GString *key;
+    GVariantIter iter;
+    const gchar *ipv, *table, *chain;
+    gint32 priority;
+    GVariant *args;
+    gsize chain_len;
+
+    if (g_variant_is_of_type(variant, G_VARIANT_TYPE("(a(sssias))")))
+	variant = g_variant_get_child_value(variant, 0);
+    else if (g_variant_is_of_type(variant, G_VARIANT_TYPE("a(sssias)")))
+	g_variant_ref(variant);
+    else {
+	g_print(_("ERROR: invalid direct rules type '%s'\n"),
+		g_variant_get_type_string(variant));
+	return obj;
+    }
+
+    FW_TRACE_DECODE_START(variant);
+
+    key = g_string_sized_new(128);
+
+    g_variant_iter_init(&iter, variant);
+    while (g_variant_iter_next(&iter, "(&s&s&si@as)", &ipv, &table, &chain,
+			       &priority, &args))
+    {
+	GVariantIter iter2;
+	const gchar *arg;
+	GList *list = NULL;
+
+	/* borrowed strings, args only lives for this iteration */
+	g_variant_iter_init(&iter2, args);
+	while (g_variant_iter_next(&iter2, "&s", &arg))
+	    list = g_list_prepend(list, (gpointer) arg);
+	list = g_list_reverse(list);
+
+	chain_len = _fw_direct_rule_set_rule_key(key, ipv, table, chain,
+						 priority, list);
+	_fw_direct_rule_set_insert(priv, key, chain_len, ipv, table, chain,
+				   priority, list);
+
+	g_list_free(list);
+	g_variant_unref(args);
+    }
+
+    g_string_free(key, TRUE);
+    g_variant_unref(variant);
+
+    FW_TRACE_DECODE_DONE();
+    return obj;
+}
+
+/**
+ * fw_direct_rule_set_to_variant:
+ * @obj: (type FWDirectRuleSet*): a FWDirectRuleSet instance
+ *
+ * Returns: (transfer none) (type GVariant*): floating a(sssias) in the
+ *   order of fw_direct_rule_set_getAllRules
+ */
+GVariant *
+fw_direct_rule_set_to_variant(FWDirectRuleSet *obj)
+{
+    GVariantBuilder builder;
+    GList *rules, *l, *k;
+
+    g_variant_builder_init(&builder, G_VARIANT_TYPE("a(sssias)"));
+
+    rules = fw_direct_rule_set_getAllRules(obj);
+    for (l = rules; l != NULL; l = l->next) {
+	FWDirectRule *rule = l->data;
+
+	g_variant_builder_open(&builder, G_VARIANT_TYPE("(sssias)"));
+	g_variant_builder_add(&builder, "s", fw_direct_rule_getIpv(rule));
+	g_variant_builder_add(&builder, "s", fw_direct_rule_getTable(rule));
+	g_variant_builder_add(&builder, "s", fw_direct_rule_getChain(rule));
+	g_variant_builder_add(&builder, "i", fw_direct_rule_getPriority(rule));
+	g_variant_builder_open(&builder, G_VARIANT_TYPE("as"));
+	for (k = fw_direct_rule_getArgs(rule); k != NULL; k = k->next)
+	    g_variant_builder_add(&builder, "s", k->data);
+	g_variant_builder_close(&builder);
+	g_variant_builder_close(&builder);
+    }
+    g_list_free(rules);
+
+    return g_variant_builder_end(&builder);
+}
+
+guint
+fw_direct_rule_set_length(FWDirectRuleSet *obj)
+{
+    FWDirectRuleSetPrivate *priv = FW_DIRECT_RULE_SET_GET_PRIVATE(obj);
+
+    return g_hash_table_size(priv->rules);
+}
+
+/**
+ * fw_direct_rule_set_addRule:
+ * @obj: (type FWDirectRuleSet*): a FWDirectRuleSet instance
+ * @ipv: (type utf8)
+ * @table: (type utf8)
+ * @chain: (type utf8)
+ * @priority: (type gint32)
+ * @args: (type GList*) (element-type utf8)
+ *
+ * Returns: FALSE if the rule is already in the set
+ */
+gboolean
+fw_direct_rule_set_addRule(FWDirectRuleSet *obj,
+			   const gchar *ipv,
+			   const gchar *table,
+			   const gchar *chain,
+			   gint32 priority,
+			   const GList *args)
+{
+    FWDirectRuleSetPrivate *priv = FW_DIRECT_RULE_SET_GET_PRIVATE(obj);
+    GString *key = g_string_sized_new(128);
+    gsize chain_len;
+    gboolean ret;
+
+    chain_len = _fw_direct_rule_set_rule_key(key, ipv, table, chain,
+					     priority, args);
+    ret = _fw_direct_rule_set_insert(priv, key, chain_len, ipv, table, chain,
+				     priority, args);
+    g_string_free(key, TRUE);
+
+    return ret;
+}
+
+/**
+ * fw_direct_rule_set_removeRule:
+ * @obj: (type FWDirectRuleSet*): a FWDirectRuleSet instance
+ * @ipv: (type utf8)
+ * @table: (type utf8)
+ * @chain: (type utf8)
+ * @priority: (type gint32)
+ * @args: (type GList*) (element-type utf8)
+ *
+ * Returns: FALSE if the rule is not in the set
+ */
+gboolean
+fw_direct_rule_set_removeRule(FWDirectRuleSet *obj,
+			      const gchar *ipv,
+			      const gchar *table,
+			      const gchar *chain,
+			      gint32 priority,
+			      const GList *args)
+{
+    FWDirectRuleSetPrivate *priv = FW_DIRECT_RULE_SET_GET_PRIVATE(obj);
+    GString *key = g_string_sized_new(128);
+    gboolean ret;
+
+    _fw_direct_rule_set_rule_key(key, ipv, table, chain, priority, args);
+    ret = _fw_direct_rule_set_delete(priv, key->str);
+    g_string_free(key, TRUE);
+
+    return ret;
+}
+
+/**
+ * fw_direct_rule_set_queryRule:
+ * @obj: (type FWDirectRuleSet*): a FWDirectRuleSet instance
+ * @ipv: (type utf8)
+ * @table: (type utf8)
+ * @chain: (type utf8)
+ * @priority: (type gint32)
+ * @args: (type GList*) (element-type utf8)
+ *
+ * Returns: (type gboolean)
+ */
+gboolean
+fw_direct_rule_set_queryRule(FWDirectRuleSet *obj,
+			     const gchar *ipv,
+			     const gchar *table,
+			     const gchar *chain,
+			     gint32 priority,
+			     const GList *args)
+{
+    FWDirectRuleSetPrivate *priv = FW_DIRECT_RULE_SET_GET_PRIVATE(obj);
+    GString *key = g_string_sized_new(128);
+    gboolean ret;
+
+    _fw_direct_rule_set_rule_key(key, ipv, table, chain, priority, args);
+    ret = g_hash_table_contains(priv->rules, key->str);
+    g_string_free(key, TRUE);
+
+    return ret;
+}
+
+/**
+ * fw_direct_rule_set_removeRules:
+ * @obj: (type FWDirectRuleSet*): a FWDirectRuleSet instance
+ * @ipv: (type utf8)
+ * @table: (type utf8)
+ * @chain: (type utf8)
+ *
+ * Removes all rules of the chain.
+ */
+void
+fw_direct_rule_set_removeRules(FWDirectRuleSet *obj,
+			       const gchar *ipv,
+			       const gchar *table,
+			       const gchar *chain_name)
+{
+    FWDirectRuleSetPrivate *priv = FW_DIRECT_RULE_SET_GET_PRIVATE(obj);
+    FWDirectRuleSetChain *chain;
+    GSequenceIter *iter;
+    GString *key = g_string_sized_new(64);
+
+    _fw_direct_rule_set_chain_key(key, ipv, table, chain_name);
+    chain = g_hash_table_lookup(priv->chains, key->str);
+    g_string_free(key, TRUE);
+    if (chain == NULL)
+	return;
+
+    for (iter = g_sequence_get_begin_iter(chain->entries);
+	 !g_sequence_iter_is_end(iter);
+	 iter = g_sequence_iter_next(iter))
+    {
+	FWDirectRuleSetEntry *entry = g_sequence_get(iter);
+
+	g_hash_table_remove(priv->rules, entry->key);
+    }
+    g_hash_table_remove(priv->chains, chain->key);
+}
+
+/**
+ * fw_direct_rule_set_add:
+ * @obj: (type FWDirectRuleSet*): a FWDirectRuleSet instance
+ * @rule: (type FWDirectRule*): rule, the set keeps a copy
+ *
+ * Returns: FALSE if the rule is already in the set
+ */
+gboolean
+fw_direct_rule_set_add(FWDirectRuleSet *obj,
+		       FWDirectRule *rule)
+{
+    return fw_direct_rule_set_addRule(obj,
+				      fw_direct_rule_getIpv(rule),
+				      fw_direct_rule_getTable(rule),
+				      fw_direct_rule_getChain(rule),
+				      fw_direct_rule_getPriority(rule),
+				      fw_direct_rule_getArgs(rule));
+}
+
+/**
+ * fw_direct_rule_set_remove:
+ * @obj: (type FWDirectRuleSet*): a FWDirectRuleSet instance
+ * @rule: (type FWDirectRule*)
+ *
+ * Returns: FALSE if the rule is not in the set
+ */
+gboolean
+fw_direct_rule_set_remove(FWDirectRuleSet *obj,
+			  FWDirectRule *rule)
+{
+    return fw_direct_rule_set_removeRule(obj,
+					 fw_direct_rule_getIpv(rule),
+					 fw_direct_rule_getTable(rule),
+					 fw_direct_rule_getChain(rule),
+					 fw_direct_rule_getPriority(rule),
+					 fw_direct_rule_getArgs(rule));
+}
+
+/**
+ * fw_direct_rule_set_query:
+ * @obj: (type FWDirectRuleSet*): a FWDirectRuleSet instance
+ * @rule: (type FWDirectRule*)
+ *
+ * Returns: (type gboolean)
+ */
+gboolean
+fw_direct_rule_set_query(FWDirectRuleSet *obj,
+			 FWDirectRule *rule)
+{
+    return fw_direct_rule_set_queryRule(obj,
+					fw_direct_rule_getIpv(rule),
+					fw_direct_rule_getTable(rule),
+					fw_direct_rule_getChain(rule),
+					fw_direct_rule_getPriority(rule),
+					fw_direct_rule_getArgs(rule));
+}
+
+static GList *
+_fw_direct_rule_set_chain_rules(FWDirectRuleSetChain *chain,
+				GList *list)
+{
+    GSequenceIter *iter;
+
+    /* prepend backwards, the caller gets the rules in order */
+    iter = g_sequence_get_end_iter(chain->entries);
+    while (!g_sequence_iter_is_begin(iter)) {
+	FWDirectRuleSetEntry *entry;
+
+	iter = g_sequence_iter_prev(iter);
+	entry = g_sequence_get(iter);
+	list = g_list_prepend(list, entry->rule);
+    }
+
+    return list;
+}
+
+/**
+ * fw_direct_rule_set_getRules:
+ * @obj: (type FWDirectRuleSet*): a FWDirectRuleSet instance
+ * @ipv: (type utf8)
+ * @table: (type utf8)
+ * @chain: (type utf8)
+ *
+ * Returns: (transfer container) (allow-none) (element-type FWDirectRule*):
+ *   rules of the chain in priority order
+ */
+GList *
+fw_direct_rule_set_getRules(FWDirectRuleSet *obj,
+			    const gchar *ipv,
+			    const gchar *table,
+			    const gchar *chain_name)
+{
+    FWDirectRuleSetPrivate *priv = FW_DIRECT_RULE_SET_GET_PRIVATE(obj);
+    FWDirectRuleSetChain *chain;
+    GString *key = g_string_sized_new(64);
+
+    _fw_direct_rule_set_chain_key(key, ipv, table, chain_name);
+    chain = g_hash_table_lookup(priv->chains, key->str);
+    g_string_free(key, TRUE);
+    if (chain == NULL)
+	return NULL;
+
+    return _fw_direct_rule_set_chain_rules(chain, NULL);
+}
+
+/**
+ * fw_direct_rule_set_getAllRules:
+ * @obj: (type FWDirectRuleSet*): a FWDirectRuleSet instance
+ *
+ * Returns: (transfer container) (allow-none) (element-type FWDirectRule*):
+ *   rules sorted by ipv, table and chain and in priority order per chain
+ */
+GList *
+fw_direct_rule_set_getAllRules(FWDirectRuleSet *obj)
+{
+    FWDirectRuleSetPrivate *priv = FW_DIRECT_RULE_SET_GET_PRIVATE(obj);
+    GList *chains, *l;
+    GList *list = NULL;
+
+    chains = _fw_direct_rule_set_get_chains(priv);
+    for (l = g_list_last(chains); l != NULL; l = l->prev)
+	list = _fw_direct_rule_set_chain_rules(l->data, list);
+    g_list_free(chains);
+
+    return list;
+}
+
+/* entries of obj in getAllRules order that are not in other */
+static GList *
+_fw_direct_rule_set_missing(FWDirectRuleSetPrivate *priv,
+			    FWDirectRuleSetPrivate *other)
+{
+    GList *chains, *l;
+    GList *list = NULL;
+
+    chains = _fw_direct_rule_set_get_chains(priv);
+    for (l = g_list_last(chains); l != NULL; l = l->prev) {
+	FWDirectRuleSetChain *chain = l->data;
+	GSequenceIter *iter = g_sequence_get_end_iter(chain->entries);
+
+	while (!g_sequence_iter_is_begin(iter)) {
+	    FWDirectRuleSetEntry *entry;
+
+	    iter = g_sequence_iter_prev(iter);
+	    entry = g_sequence_get(iter);
+	    if (!g_hash_table_contains(other->rules, entry->key))
+		list = g_list_prepend(list, entry->rule);
+	}
+    }
+    g_list_free(chains);
+
+    return list;
+}
+
+/**
+ * fw_direct_rule_set_diff:
+ * @obj: (type FWDirectRuleSet*): current rules
+ * @desired: (type FWDirectRuleSet*): rules to get to
+ * @to_remove: (out) (transfer container) (element-type FWDirectRule*):
+ *   rules of obj that are not in desired
+ * @to_add: (out) (transfer container) (element-type FWDirectRule*):
+ *   rules of desired that are not in obj, in priority order per chain
+ *
+ * The rules in the lists belong to the sets.
+ */
+void
+fw_direct_rule_set_diff(FWDirectRuleSet *obj,
+			FWDirectRuleSet *desired,
+			GList **to_remove,
+			GList **to_add)
+{
+    FWDirectRuleSetPrivate *priv = FW_DIRECT_RULE_SET_GET_PRIVATE(obj);
+    FWDirectRuleSetPrivate *desired_priv = FW_DIRECT_RULE_SET_GET_PRIVATE(desired);
+
+    if (to_remove != NULL)
+	*to_remove = _fw_direct_rule_set_missing(priv, desired_priv);
+    if (to_add != NULL)
+	*to_add = _fw_direct_rule_set_missing(desired_priv, priv);
+}
+
+static guint
+_fw_direct_rule_set_queue(FWBatch *batch,
+			  const gchar *method_name,
+			  GList *rules)
+{
+    GList *l, *k;
+    guint n = 0;
+
+    for (l = rules; l != NULL; l = l->next) {
+	FWDirectRule *rule = l->data;
+	GVariantBuilder builder;
+
+	g_variant_builder_init(&builder, G_VARIANT_TYPE("as"));
+	for (k = fw_direct_rule_getArgs(rule); k != NULL; k = k->next)
+	    g_variant_builder_add(&builder, "s", k->data);
+
+	fw_batch_add(batch, FW_DBUS_PATH, FW_DBUS_INTERFACE_DIRECT,
+		     method_name,
+		     g_variant_new("(sssias)",
+				   fw_direct_rule_getIpv(rule),
+				   fw_direct_rule_getTable(rule),
+				   fw_direct_rule_getChain(rule),
+				   fw_direct_rule_getPriority(rule),
+				   &builder));
+	n++;
+    }
+
+    return n;
+}
+
+/**
+ * fw_direct_rule_set_queueDiff:
+ * @obj: (type FWDirectRuleSet*): current rules
+ * @desired: (type FWDirectRuleSet*): rules to get to
+ * @batch: (type FWBatch*): batch to add the calls to
+ *
+ * Adds the removeRule calls and then the addRule calls that change the
+ * runtime direct rules from obj to desired to the batch. Rules that are
+ * in both sets are not touched.
+ *
+ * Returns: number of calls added to the batch
+ */
+guint
+fw_direct_rule_set_queueDiff(FWDirectRuleSet *obj,
+			     FWDirectRuleSet *desired,
+			     FWBatch *batch)
+{
+    GList *to_remove, *to_add;
+    guint n;
+
+    fw_direct_rule_set_diff(obj, desired, &to_remove, &to_add);
+
+#ifdef FW_DEBUG
+    g_printerr("fw_direct_rule_set_queueDiff(): %u to remove, %u to add\n",
+	       g_list_length(to_remove), g_list_length(to_add));
+#endif
+
+    n = _fw_direct_rule_set_queue(batch, "removeRule", to_remove);
+    n += _fw_direct_rule_set_queue(batch, "addRule", to_add);
+
+    g_list_free(to_remove);
+    g_list_free(to_add);
+
+    return n;
+}
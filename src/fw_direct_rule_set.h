@@ -0,0 +1,68 @@
+/*
+ * Copyright (C) 2017 Red Hat, Inc.
+ *
+ * Authors:
+ * Thomas Woerner <twoerner@redhat.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __FW_DIRECT_RULE_SET_H__
+#define __FW_DIRECT_RULE_SET_H__
+
+#include <glib.h>
+#include <glib-object.h>
+#include "firewall.h"
+#include "fw_direct_rule.h"
+#include "fw_batch.h"
+
+#define FW_DIRECT_RULE_SET_TYPE            (fw_direct_rule_set_get_type())
+#define FW_DIRECT_RULE_SET(obj)            (G_TYPE_CHECK_INSTANCE_CAST((obj), FW_DIRECT_RULE_SET_TYPE, FWDirectRuleSet))
+#define FW_DIRECT_RULE_SET_CLASS(klass)    (G_TYPE_CHECK_CLASS_CAST((klass), FW_DIRECT_RULE_SET_TYPE, FWDirectRuleSetClass))
+#define FW_IS_DIRECT_RULE_SET(klass)       (G_TYPE_CHECK_INSTANCE_CLASS((klass), FW_DIRECT_RULE_SET_TYPE, FWDirectRuleSetClass))
+#define FW_DIRECT_RULE_SET_GET_CLASS(obj)  (G_TYPE_INSTANCE_GET_CLASS((obj), FW_DIRECT_RULE_SET_TYPE, FWDirectRuleSetClass))
+
+typedef struct {
+    GObject parent;
+} FWDirectRuleSet;
+
+typedef struct {
+    GObjectClass parent;
+} FWDirectRuleSetClass;
+
+GType fw_direct_rule_set_get_type(void);
+FWDirectRuleSet *fw_direct_rule_set_new(void);
+FWDirectRuleSet *fw_direct_rule_set_new_from_variant(GVariant *variant);
+GVariant *fw_direct_rule_set_to_variant(FWDirectRuleSet *obj);
+
+guint fw_direct_rule_set_length(FWDirectRuleSet *obj);
+
+gboolean fw_direct_rule_set_addRule(FWDirectRuleSet *obj, const gchar *ipv, const gchar *table, const gchar *chain, gint32 priority, const GList *args);
+gboolean fw_direct_rule_set_removeRule(FWDirectRuleSet *obj, const gchar *ipv, const gchar *table, const gchar *chain, gint32 priority, const GList *args);
+gboolean fw_direct_rule_set_queryRule(FWDirectRuleSet *obj, const gchar *ipv, const gchar *table, const gchar *chain, gint32 priority, const GList *args);
+void fw_direct_rule_set_removeRules(FWDirectRuleSet *obj, const gchar *ipv, const gchar *table, const gchar *chain);
+
+gboolean fw_direct_rule_set_add(FWDirectRuleSet *obj, FWDirectRule *rule);
+gboolean fw_direct_rule_set_remove(FWDirectRuleSet *obj, FWDirectRule *rule);
+gboolean fw_direct_rule_set_query(FWDirectRuleSet *obj, FWDirectRule *rule);
+
+GList *fw_direct_rule_set_getRules(FWDirectRuleSet *obj, const gchar *ipv, const gchar *table, const gchar *chain);
+GList *fw_direct_rule_set_getAllRules(FWDirectRuleSet *obj);
+
+/* changes to get from obj to desired */
+
+void fw_direct_rule_set_diff(FWDirectRuleSet *obj, FWDirectRuleSet *desired, GList **to_remove, GList **to_add);
+guint fw_direct_rule_set_queueDiff(FWDirectRuleSet *obj, FWDirectRuleSet *desired, FWBatch *batch);
+
+#endif /* __FW_DIRECT_RULE_SET_H__ */
@@ -19,6 +19,7 @@
  */
 
 #include "fw_direct_simple_rule.h"
+#include "fw_accounting.h"
 #include "fw_functions.h"
 
 G_DEFINE_TYPE(FWDirectSimpleRule, fw_direct_simple_rule, G_TYPE_OBJECT);
@@ -65,6 +66,7 @@ fw_direct_simple_rule_class_init(FWDirectSimpleRuleClass *fw_direct_simple_rule_
     obj_class->finalize = fw_direct_simple_rule_finalize;
 
     g_type_class_add_private(obj_class, sizeof(FWDirectSimpleRulePrivate));
+    fw_accounting_register(obj_class, sizeof(FWDirectSimpleRulePrivate));
 }
 
 /* methods */
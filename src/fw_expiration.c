@@ -0,0 +1,200 @@
+/*
+ * Copyright (C) 2017 Red Hat, Inc.
+ *
+ * Authors:
+ * Thomas Woerner <twoerner@redhat.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "fw_expiration.h"
+#include "fw_accounting.h"
+
+G_DEFINE_TYPE(FWExpiration, fw_expiration, G_TYPE_OBJECT);
+
+#define FW_EXPIRATION_GET_PRIVATE(o) (G_TYPE_INSTANCE_GET_PRIVATE((o), FW_EXPIRATION_TYPE, FWExpirationPrivate))
+
+typedef struct {
+    gchar *zone;        /* string */
+    gchar *type;        /* string */
+    gchar *item;        /* string */
+    gint64 deadline;    /* monotonic time in microseconds */
+} FWExpirationPrivate;
+
+FWExpiration *
+fw_expiration_new()
+{
+    return g_object_new(FW_EXPIRATION_TYPE, NULL);
+}
+
+static void
+fw_expiration_init(FWExpiration *obj)
+{
+    FWExpirationPrivate *priv = FW_EXPIRATION_GET_PRIVATE(obj);
+
+    /* init vars */
+    priv->zone = g_strdup("");
+    priv->type = g_strdup("");
+    priv->item = g_strdup("");
+    priv->deadline = 0;
+}
+
+static void
+fw_expiration_finalize(GObject *obj)
+{
+    FWExpirationPrivate *priv = FW_EXPIRATION_GET_PRIVATE(obj);
+
+    if (priv->zone != NULL)
+	g_free(priv->zone);
+    if (priv->type != NULL)
+	g_free(priv->type);
+    if (priv->item != NULL)
+	g_free(priv->item);
+
+    G_OBJECT_CLASS(fw_expiration_parent_class)->finalize(obj);
+}
+
+static void
+fw_expiration_class_init(FWExpirationClass *fw_expiration_class)
+{
+    GObjectClass *obj_class = G_OBJECT_CLASS(fw_expiration_class);
+
+    obj_class->finalize = fw_expiration_finalize;
+
+    g_type_class_add_private(obj_class, sizeof(FWExpirationPrivate));
+    fw_accounting_register(obj_class, sizeof(FWExpirationPrivate));
+}
+
+/* methods */
+
+/**
+ * fw_expiration_getZone:
+ * @obj: (type FWExpiration*): a FWExpiration instance
+ *
+ * Returns: (type gchar*)
+ */
+gchar *
+fw_expiration_getZone(FWExpiration *obj)
+{
+    FWExpirationPrivate *priv = FW_EXPIRATION_GET_PRIVATE(obj);
+
+    return priv->zone;
+}
+
+/**
+ * fw_expiration_getType:
+ * @obj: (type FWExpiration*): a FWExpiration instance
+ *
+ * One of "service", "port", "protocol", "source-port", "masquerade",
+ * "forward-port", "icmp-block" and "rich-rule".
+ *
+ * Returns: (type gchar*)
+ */
+gchar *
+fw_expiration_getType(FWExpiration *obj)
+{
+    FWExpirationPrivate *priv = FW_EXPIRATION_GET_PRIVATE(obj);
+
+    return priv->type;
+}
+
+/**
+ * fw_expiration_getItem:
+ * @obj: (type FWExpiration*): a FWExpiration instance
+ *
+ * The entry in firewall-cmd syntax: "port/protocol" for ports and source
+ * ports, "port=..:proto=..:toport=..:toaddr=.." for forward ports and ""
+ * for masquerade.
+ *
+ * Returns: (type gchar*)
+ */
+gchar *
+fw_expiration_getItem(FWExpiration *obj)
+{
+    FWExpirationPrivate *priv = FW_EXPIRATION_GET_PRIVATE(obj);
+
+    return priv->item;
+}
+
+/**
+ * fw_expiration_getDeadline:
+ * @obj: (type FWExpiration*): a FWExpiration instance
+ *
+ * Returns: monotonic time in microseconds, see g_get_monotonic_time
+ */
+gint64
+fw_expiration_getDeadline(FWExpiration *obj)
+{
+    FWExpirationPrivate *priv = FW_EXPIRATION_GET_PRIVATE(obj);
+
+    return priv->deadline;
+}
+
+/**
+ * fw_expiration_setZone:
+ * @obj: (type FWExpiration*): a FWExpiration instance
+ * @zone: (type gchar*)
+ */
+void
+fw_expiration_setZone(FWExpiration *obj, const gchar *zone)
+{
+    FWExpirationPrivate *priv = FW_EXPIRATION_GET_PRIVATE(obj);
+
+    if (priv->zone != NULL)
+	g_free(priv->zone);
+    priv->zone = g_strdup(zone);
+}
+
+/**
+ * fw_expiration_setType:
+ * @obj: (type FWExpiration*): a FWExpiration instance
+ * @type: (type gchar*)
+ */
+void
+fw_expiration_setType(FWExpiration *obj, const gchar *type)
+{
+    FWExpirationPrivate *priv = FW_EXPIRATION_GET_PRIVATE(obj);
+
+    if (priv->type != NULL)
+	g_free(priv->type);
+    priv->type = g_strdup(type);
+}
+
+/**
+ * fw_expiration_setItem:
+ * @obj: (type FWExpiration*): a FWExpiration instance
+ * @item: (type gchar*)
+ */
+void
+fw_expiration_setItem(FWExpiration *obj, const gchar *item)
+{
+    FWExpirationPrivate *priv = FW_EXPIRATION_GET_PRIVATE(obj);
+
+    if (priv->item != NULL)
+	g_free(priv->item);
+    priv->item = g_strdup(item);
+}
+
+/**
+ * fw_expiration_setDeadline:
+ * @obj: (type FWExpiration*): a FWExpiration instance
+ * @deadline: monotonic time in microseconds
+ */
+void
+fw_expiration_setDeadline(FWExpiration *obj, gint64 deadline)
+{
+    FWExpirationPrivate *priv = FW_EXPIRATION_GET_PRIVATE(obj);
+
+    priv->deadline = deadline;
+}
@@ -0,0 +1,66 @@
+/*
+ * Copyright (C) 2017 Red Hat, Inc.
+ *
+ * Authors:
+ * Thomas Woerner <twoerner@redhat.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __FW_EXPIRATION_H__
+#define __FW_EXPIRATION_H__
+
+#include <glib.h>
+#include <glib-object.h>
+#include "firewall.h"
+
+#define FW_EXPIRATION_TYPE            (fw_expiration_get_type())
+#define FW_EXPIRATION(obj)            (G_TYPE_CHECK_INSTANCE_CAST((obj), FW_EXPIRATION_TYPE, FWExpiration))
+#define FW_EXPIRATION_CLASS(klass)    (G_TYPE_CHECK_CLASS_CAST((klass), FW_EXPIRATION_TYPE, FWExpirationClass))
+#define FW_IS_EXPIRATION(klass)       (G_TYPE_CHECK_INSTANCE_CLASS((klass), FW_EXPIRATION_TYPE, FWExpirationClass))
+#define FW_EXPIRATION_GET_CLASS(obj)  (G_TYPE_INSTANCE_GET_CLASS((obj), FW_EXPIRATION_TYPE, FWExpirationClass))
+
+typedef struct {
+    GObject parent;
+} FWExpiration;
+
+typedef struct {
+    GObjectClass parent;
+} FWExpirationClass;
+
+/* why a timed runtime entry has ended */
+typedef enum {
+    FW_EXPIRATION_REMOVED,	/* removed signal or remove call */
+    FW_EXPIRATION_TIMEOUT,	/* deadline passed without removed signal */
+    FW_EXPIRATION_RELOADED,	/* runtime configuration has been reloaded */
+} FWExpirationReason;
+
+typedef void (*FWExpirationFunc)(FWExpiration *expiration,
+				 FWExpirationReason reason,
+				 gpointer user_data);
+
+GType fw_expiration_get_type(void);
+FWExpiration *fw_expiration_new(void);
+
+gchar *fw_expiration_getZone(FWExpiration *obj);
+gchar *fw_expiration_getType(FWExpiration *obj);
+gchar *fw_expiration_getItem(FWExpiration *obj);
+gint64 fw_expiration_getDeadline(FWExpiration *obj);
+
+void fw_expiration_setZone(FWExpiration *obj, const gchar *zone);
+void fw_expiration_setType(FWExpiration *obj, const gchar *type);
+void fw_expiration_setItem(FWExpiration *obj, const gchar *item);
+void fw_expiration_setDeadline(FWExpiration *obj, gint64 deadline);
+
+#endif /* __FW_EXPIRATION_H__ */
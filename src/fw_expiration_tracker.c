@@ -0,0 +1,528 @@
+/*
+ * Copyright (C) 2017 Red Hat, Inc.
+ *
+ * Authors:
+ * Thomas Woerner <twoerner@redhat.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Tracks timed runtime entries until firewalld removes them. The entries
+ * are kept in a timer wheel at deadline plus grace time, a single GSource
+ * on the main context is woken up for the next timer only, so thousands of
+ * short lived entries do not need any polling. The removed signals of the
+ * zone interface end an entry early, a timer that fires without a removed
+ * signal is reported as timeout.
+ */
+
+#include <string.h>
+#include "fw_expiration_tracker.h"
+#include "fw_accounting.h"
+#include "fw_timer_wheel.h"
+
+G_DEFINE_TYPE(FWExpirationTracker, fw_expiration_tracker, G_TYPE_OBJECT);
+
+#define FW_EXPIRATION_TRACKER_GET_PRIVATE(o) (G_TYPE_INSTANCE_GET_PRIVATE((o), FW_EXPIRATION_TRACKER_TYPE, FWExpirationTrackerPrivate))
+
+/* wheel resolution */
+#define FW_EXPIRATION_TRACKER_TICK  (G_USEC_PER_SEC / 10)
+
+typedef struct {
+    gchar *key;
+    FWExpiration *expiration;
+    FWTimerWheelEntry *timer;
+} FWExpirationTrackerEntry;
+
+typedef struct {
+    GHashTable *entries;	/* key -> FWExpirationTrackerEntry */
+    FWTimerWheel *wheel;
+    GSource *source;
+
+    FWExpirationFunc func;
+    gpointer user_data;
+    GDestroyNotify destroy;
+} FWExpirationTrackerPrivate;
+
+/* zone signals of timed entries */
+static const struct {
+    const gchar *added;
+    const gchar *removed;
+    const gchar *type;
+    guint n_strings;		/* zone and item fields */
+} _fw_expiration_tracker_signals[] = {
+    { "ServiceAdded",    "ServiceRemoved",    "service",      2 },
+    { "PortAdded",       "PortRemoved",       "port",         3 },
+    { "ProtocolAdded",   "ProtocolRemoved",   "protocol",     2 },
+    { "SourcePortAdded", "SourcePortRemoved", "source-port",  3 },
+    { "MasqueradeAdded", "MasqueradeRemoved", "masquerade",   1 },
+    { "ForwardPortAdded", "ForwardPortRemoved", "forward-port", 5 },
+    { "IcmpBlockAdded",  "IcmpBlockRemoved",  "icmp-block",   2 },
+    { "RichRuleAdded",   "RichRuleRemoved",   "rich-rule",    2 },
+};
+
+static void
+_fw_expiration_tracker_entry_free(gpointer data)
+{
+    FWExpirationTrackerEntry *entry = data;
+
+    g_free(entry->key);
+    g_object_unref(entry->expiration);
+    g_slice_free(FWExpirationTrackerEntry, entry);
+}
+
+static gboolean
+_fw_expiration_tracker_source_dispatch(GSource *source,
+				       GSourceFunc callback,
+				       gpointer user_data)
+{
+    return callback(user_data);
+}
+
+static GSourceFuncs _fw_expiration_tracker_source_funcs = {
+    NULL,
+    NULL,
+    _fw_expiration_tracker_source_dispatch,
+    NULL,
+};
+
+static gboolean _fw_expiration_tracker_timeout(gpointer user_data);
+
+/**
+ * fw_expiration_tracker_new:
+ * @context: (allow-none): main context for the expiry callbacks, NULL for
+ *   the default context
+ *
+ * Returns: (transfer full) (type FWExpirationTracker*)
+ */
+FWExpirationTracker *
+fw_expiration_tracker_new(GMainContext *context)
+{
+    FWExpirationTracker *obj = g_object_new(FW_EXPIRATION_TRACKER_TYPE, NULL);
+    FWExpirationTrackerPrivate *priv = FW_EXPIRATION_TRACKER_GET_PRIVATE(obj);
+
+    priv->source = g_source_new(&_fw_expiration_tracker_source_funcs,
+				sizeof(GSource));
+    g_source_set_callback(priv->source, _fw_expiration_tracker_timeout,
+			  priv, NULL);
+    g_source_attach(priv->source, context);
+
+    return obj;
+}
+
+static void
+fw_expiration_tracker_init(FWExpirationTracker *obj)
+{
+    FWExpirationTrackerPrivate *priv = FW_EXPIRATION_TRACKER_GET_PRIVATE(obj);
+
+    /* init vars */
+    priv->entries = g_hash_table_new_full(g_str_hash, g_str_equal, NULL,
+					  _fw_expiration_tracker_entry_free);
+    priv->wheel = fw_timer_wheel_new(FW_EXPIRATION_TRACKER_TICK,
+				     g_get_monotonic_time());
+    priv->source = NULL;
+    priv->func = NULL;
+    priv->user_data = NULL;
+    priv->destroy = NULL;
+}
+
+static void
+fw_expiration_tracker_finalize(GObject *obj)
+{
+    FWExpirationTrackerPrivate *priv = FW_EXPIRATION_TRACKER_GET_PRIVATE(obj);
+
+    if (priv->source != NULL) {
+	g_source_destroy(priv->source);
+	g_source_unref(priv->source);
+    }
+    g_hash_table_destroy(priv->entries);
+    g_object_unref(priv->wheel);
+    if (priv->destroy != NULL)
+	priv->destroy(priv->user_data);
+
+    G_OBJECT_CLASS(fw_expiration_tracker_parent_class)->finalize(obj);
+}
+
+static void
+fw_expiration_tracker_class_init(FWExpirationTrackerClass *fw_expiration_tracker_class)
+{
+    GObjectClass *obj_class = G_OBJECT_CLASS(fw_expiration_tracker_class);
+
+    obj_class->finalize = fw_expiration_tracker_finalize;
+
+    g_type_class_add_private(obj_class, sizeof(FWExpirationTrackerPrivate));
+    fw_accounting_register(obj_class, sizeof(FWExpirationTrackerPrivate));
+}
+
+/* helpers */
+
+static gchar *
+_fw_expiration_tracker_key(const gchar *zone,
+			   const gchar *type,
+			   const gchar *item)
+{
+    return g_strdup_printf("%zu:%s%zu:%s%s", strlen(zone), zone,
+			   strlen(type), type, item);
+}
+
+static void
+_fw_expiration_tracker_schedule(FWExpirationTrackerPrivate *priv)
+{
+    if (priv->source != NULL)
+	g_source_set_ready_time(priv->source,
+				fw_timer_wheel_getNextWakeup(priv->wheel));
+}
+
+/* removes the entry and reports it */
+static void
+_fw_expiration_tracker_end(FWExpirationTrackerPrivate *priv,
+			   FWExpirationTrackerEntry *entry,
+			   FWExpirationReason reason)
+{
+    FWExpiration *expiration = g_object_ref(entry->expiration);
+
+#ifdef FW_DEBUG
+    g_printerr("expiration %s %s '%s': %d\n",
+	       fw_expiration_getZone(expiration),
+	       fw_expiration_getType(expiration),
+	       fw_expiration_getItem(expiration), reason);
+#endif
+
+    if (entry->timer != NULL)
+	fw_timer_wheel_remove(priv->wheel, entry->timer);
+    g_hash_table_remove(priv->entries, entry->key);
+
+    if (priv->func != NULL)
+	priv->func(expiration, reason, priv->user_data);
+    g_object_unref(expiration);
+}
+
+static void
+_fw_expiration_tracker_expired(gpointer data,
+			       gpointer user_data)
+{
+    FWExpirationTrackerEntry *entry = data;
+
+    /* the timer handle is gone already */
+    entry->timer = NULL;
+    _fw_expiration_tracker_end(user_data, entry, FW_EXPIRATION_TIMEOUT);
+}
+
+static gboolean
+_fw_expiration_tracker_timeout(gpointer user_data)
+{
+    FWExpirationTrackerPrivate *priv = user_data;
+
+    fw_timer_wheel_advance(priv->wheel, g_get_monotonic_time(),
+			   _fw_expiration_tracker_expired, priv);
+    _fw_expiration_tracker_schedule(priv);
+
+    return G_SOURCE_CONTINUE;
+}
+
+/* methods */
+
+/**
+ * fw_expiration_tracker_setFunc:
+ * @obj: (type FWExpirationTracker*): a FWExpirationTracker instance
+ * @func: (scope notified) (allow-none): called when an entry ended
+ * @user_data: (allow-none): user data for func
+ * @destroy: (allow-none): destroys user_data
+ */
+void
+fw_expiration_tracker_setFunc(FWExpirationTracker *obj,
+			      FWExpirationFunc func,
+			      gpointer user_data,
+			      GDestroyNotify destroy)
+{
+    FWExpirationTrackerPrivate *priv = FW_EXPIRATION_TRACKER_GET_PRIVATE(obj);
+
+    if (priv->destroy != NULL)
+	priv->destroy(priv->user_data);
+    priv->func = func;
+    priv->user_data = user_data;
+    priv->destroy = destroy;
+}
+
+static void
+_fw_expiration_tracker_add(FWExpirationTrackerPrivate *priv,
+			   gchar *key,
+			   const gchar *zone,
+			   const gchar *type,
+			   const gchar *item,
+			   gint32 timeout)
+{
+    FWExpirationTrackerEntry *entry;
+    gint64 deadline;
+
+    deadline = g_get_monotonic_time() + (gint64) timeout * G_USEC_PER_SEC;
+
+    entry = g_hash_table_lookup(priv->entries, key);
+    if (entry != NULL) {
+	g_free(key);
+	fw_timer_wheel_remove(priv->wheel, entry->timer);
+    } else {
+	entry = g_slice_new0(FWExpirationTrackerEntry);
+	entry->key = key;
+	entry->expiration = fw_expiration_new();
+	fw_expiration_setZone(entry->expiration, zone);
+	fw_expiration_setType(entry->expiration, type);
+	fw_expiration_setItem(entry->expiration, item);
+	g_hash_table_insert(priv->entries, entry->key, entry);
+    }
+
+    fw_expiration_setDeadline(entry->expiration, deadline);
+    entry->timer = fw_timer_wheel_add(priv->wheel,
+				      deadline + FW_EXPIRATION_TRACKER_GRACE,
+				      entry);
+    _fw_expiration_tracker_schedule(priv);
+}
+
+/**
+ * fw_expiration_tracker_add:
+ * @obj: (type FWExpirationTracker*): a FWExpirationTracker instance
+ * @zone: (type gchar*)
+ * @type: (type gchar*): entry type, see fw_expiration_getType
+ * @item: (type gchar*): entry, see fw_expiration_getItem
+ * @timeout: timeout in seconds, entries without timeout are ignored
+ *
+ * Records an entry that has been added with this client. Adding an entry
+ * again only moves its deadline, therefore the added signal of the
+ * addition may be handled before or after this. An added signal that is
+ * handled after the entry has been removed records it again until the
+ * removed signal that follows it.
+ */
+void
+fw_expiration_tracker_add(FWExpirationTracker *obj,
+			  const gchar *zone,
+			  const gchar *type,
+			  const gchar *item,
+			  gint32 timeout)
+{
+    FWExpirationTrackerPrivate *priv = FW_EXPIRATION_TRACKER_GET_PRIVATE(obj);
+
+    if (timeout <= 0)
+	return;
+
+    _fw_expiration_tracker_add(priv,
+			       _fw_expiration_tracker_key(zone, type, item),
+			       zone, type, item, timeout);
+}
+
+/**
+ * fw_expiration_tracker_remove:
+ * @obj: (type FWExpirationTracker*): a FWExpirationTracker instance
+ * @zone: (type gchar*)
+ * @type: (type gchar*)
+ * @item: (type gchar*)
+ *
+ * Ends a tracked entry with FW_EXPIRATION_REMOVED.
+ */
+void
+fw_expiration_tracker_remove(FWExpirationTracker *obj,
+			     const gchar *zone,
+			     const gchar *type,
+			     const gchar *item)
+{
+    FWExpirationTrackerPrivate *priv = FW_EXPIRATION_TRACKER_GET_PRIVATE(obj);
+    FWExpirationTrackerEntry *entry;
+    gchar *key;
+
+    key = _fw_expiration_tracker_key(zone, type, item);
+    entry = g_hash_table_lookup(priv->entries, key);
+    g_free(key);
+    if (entry == NULL)
+	return;
+
+    _fw_expiration_tracker_end(priv, entry, FW_EXPIRATION_REMOVED);
+    _fw_expiration_tracker_schedule(priv);
+}
+
+/**
+ * fw_expiration_tracker_clear:
+ * @obj: (type FWExpirationTracker*): a FWExpirationTracker instance
+ * @reason: reported for all entries
+ */
+void
+fw_expiration_tracker_clear(FWExpirationTracker *obj,
+			    FWExpirationReason reason)
+{
+    FWExpirationTrackerPrivate *priv = FW_EXPIRATION_TRACKER_GET_PRIVATE(obj);
+    GHashTableIter iter;
+    gpointer value;
+
+    /* the callback may add entries again */
+    while (g_hash_table_size(priv->entries) > 0) {
+	g_hash_table_iter_init(&iter, priv->entries);
+	g_hash_table_iter_next(&iter, NULL, &value);
+	_fw_expiration_tracker_end(priv, value, reason);
+    }
+    _fw_expiration_tracker_schedule(priv);
+}
+
+guint
+fw_expiration_tracker_length(FWExpirationTracker *obj)
+{
+    FWExpirationTrackerPrivate *priv = FW_EXPIRATION_TRACKER_GET_PRIVATE(obj);
+
+    return g_hash_table_size(priv->entries);
+}
+
+static gint
+_fw_expiration_tracker_compare(gconstpointer a,
+			       gconstpointer b)
+{
+    gint64 da = fw_expiration_getDeadline((FWExpiration *) a);
+    gint64 db = fw_expiration_getDeadline((FWExpiration *) b);
+
+    return (da > db) - (da < db);
+}
+
+/**
+ * fw_expiration_tracker_getPending:
+ * @obj: (type FWExpirationTracker*): a FWExpirationTracker instance
+ *
+ * Returns: (transfer full) (allow-none) (element-type FWExpiration*): sorted
+ *   by deadline
+ */
+GList *
+fw_expiration_tracker_getPending(FWExpirationTracker *obj)
+{
+    FWExpirationTrackerPrivate *priv = FW_EXPIRATION_TRACKER_GET_PRIVATE(obj);
+    GHashTableIter iter;
+    gpointer value;
+    GList *list = NULL;
+
+    g_hash_table_iter_init(&iter, priv->entries);
+    while (g_hash_table_iter_next(&iter, NULL, &value)) {
+	FWExpirationTrackerEntry *entry = value;
+
+	list = g_list_prepend(list, g_object_ref(entry->expiration));
+    }
+
+    return g_list_sort(list, _fw_expiration_tracker_compare);
+}
+
+/**
+ * fw_expiration_tracker_handleSignal:
+ * @obj: (type FWExpirationTracker*): a FWExpirationTracker instance
+ * @signal_name: (type gchar*): signal of the zone interface
+ * @parameters: signal parameters
+ *
+ * Records timed entries from added signals, also the ones of other
+ * clients, and ends entries with removed signals.
+ *
+ * Returns: TRUE if the signal has been used
+ */
+gboolean
+fw_expiration_tracker_handleSignal(FWExpirationTracker *obj,
+				   const gchar *signal_name,
+				   GVariant *parameters)
+{
+    const gchar *strv[5];
+    gchar *item;
+    gboolean added;
+    guint i, j;
+
+    for (i = 0; i < G_N_ELEMENTS(_fw_expiration_tracker_signals); i++) {
+	if (strcmp(signal_name, _fw_expiration_tracker_signals[i].added) == 0
+	    || strcmp(signal_name,
+		      _fw_expiration_tracker_signals[i].removed) == 0)
+	    break;
+    }
+    if (i >= G_N_ELEMENTS(_fw_expiration_tracker_signals))
+	return FALSE;
+
+    added = (strcmp(signal_name,
+		    _fw_expiration_tracker_signals[i].added) == 0);
+    if (g_variant_n_children(parameters) !=
+	_fw_expiration_tracker_signals[i].n_strings + (added ? 1 : 0))
+	return FALSE;
+
+    for (j = 0; j < _fw_expiration_tracker_signals[i].n_strings; j++) {
+	GVariant *child = g_variant_get_child_value(parameters, j);
+
+	if (!g_variant_is_of_type(child, G_VARIANT_TYPE_STRING)) {
+	    g_variant_unref(child);
+	    return FALSE;
+	}
+	/* the string is owned by parameters */
+	strv[j] = g_variant_get_string(child, NULL);
+	g_variant_unref(child);
+    }
+
+    if (strcmp(_fw_expiration_tracker_signals[i].type, "masquerade") == 0)
+	item = g_strdup("");
+    else if (strcmp(_fw_expiration_tracker_signals[i].type,
+		    "forward-port") == 0)
+	item = fw_expiration_tracker_forwardPortItem(strv[1], strv[2],
+						     strv[3], strv[4]);
+    else if (_fw_expiration_tracker_signals[i].n_strings == 3)
+	item = fw_expiration_tracker_portItem(strv[1], strv[2]);
+    else
+	item = g_strdup(strv[1]);
+
+    if (added) {
+	GVariant *child = g_variant_get_child_value(
+	    parameters, _fw_expiration_tracker_signals[i].n_strings);
+
+	/* also the signals of own additions, recorded with the call */
+	if (g_variant_is_of_type(child, G_VARIANT_TYPE_INT32))
+	    fw_expiration_tracker_add(obj, strv[0],
+				      _fw_expiration_tracker_signals[i].type,
+				      item, g_variant_get_int32(child));
+	g_variant_unref(child);
+    } else {
+	fw_expiration_tracker_remove(obj, strv[0],
+				     _fw_expiration_tracker_signals[i].type,
+				     item);
+    }
+    g_free(item);
+
+    return TRUE;
+}
+
+/**
+ * fw_expiration_tracker_portItem:
+ * @port: (type gchar*)
+ * @protocol: (type gchar*)
+ *
+ * Returns: (transfer full) (type gchar*): "port/protocol"
+ */
+gchar *
+fw_expiration_tracker_portItem(const gchar *port,
+			       const gchar *protocol)
+{
+    return g_strdup_printf("%s/%s", port, protocol);
+}
+
+/**
+ * fw_expiration_tracker_forwardPortItem:
+ * @port: (type gchar*)
+ * @protocol: (type gchar*)
+ * @toport: (type gchar*)
+ * @toaddr: (type gchar*)
+ *
+ * Returns: (transfer full) (type gchar*):
+ *   "port=..:proto=..:toport=..:toaddr=.."
+ */
+gchar *
+fw_expiration_tracker_forwardPortItem(const gchar *port,
+				      const gchar *protocol,
+				      const gchar *toport,
+				      const gchar *toaddr)
+{
+    return g_strdup_printf("port=%s:proto=%s:toport=%s:toaddr=%s", port,
+			   protocol, toport, toaddr);
+}
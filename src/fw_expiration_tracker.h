@@ -0,0 +1,62 @@
+/*
+ * Copyright (C) 2017 Red Hat, Inc.
+ *
+ * Authors:
+ * Thomas Woerner <twoerner@redhat.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __FW_EXPIRATION_TRACKER_H__
+#define __FW_EXPIRATION_TRACKER_H__
+
+#include <glib.h>
+#include <glib-object.h>
+#include "firewall.h"
+#include "fw_expiration.h"
+
+#define FW_EXPIRATION_TRACKER_TYPE            (fw_expiration_tracker_get_type())
+#define FW_EXPIRATION_TRACKER(obj)            (G_TYPE_CHECK_INSTANCE_CAST((obj), FW_EXPIRATION_TRACKER_TYPE, FWExpirationTracker))
+#define FW_EXPIRATION_TRACKER_CLASS(klass)    (G_TYPE_CHECK_CLASS_CAST((klass), FW_EXPIRATION_TRACKER_TYPE, FWExpirationTrackerClass))
+#define FW_IS_EXPIRATION_TRACKER(klass)       (G_TYPE_CHECK_INSTANCE_CLASS((klass), FW_EXPIRATION_TRACKER_TYPE, FWExpirationTrackerClass))
+#define FW_EXPIRATION_TRACKER_GET_CLASS(obj)  (G_TYPE_INSTANCE_GET_CLASS((obj), FW_EXPIRATION_TRACKER_TYPE, FWExpirationTrackerClass))
+
+/* time after the deadline to wait for the removed signal */
+#define FW_EXPIRATION_TRACKER_GRACE  (2 * G_USEC_PER_SEC)
+
+typedef struct {
+    GObject parent;
+} FWExpirationTracker;
+
+typedef struct {
+    GObjectClass parent;
+} FWExpirationTrackerClass;
+
+GType fw_expiration_tracker_get_type(void);
+FWExpirationTracker *fw_expiration_tracker_new(GMainContext *context);
+
+void fw_expiration_tracker_setFunc(FWExpirationTracker *obj, FWExpirationFunc func, gpointer user_data, GDestroyNotify destroy);
+
+void fw_expiration_tracker_add(FWExpirationTracker *obj, const gchar *zone, const gchar *type, const gchar *item, gint32 timeout);
+void fw_expiration_tracker_remove(FWExpirationTracker *obj, const gchar *zone, const gchar *type, const gchar *item);
+void fw_expiration_tracker_clear(FWExpirationTracker *obj, FWExpirationReason reason);
+guint fw_expiration_tracker_length(FWExpirationTracker *obj);
+GList *fw_expiration_tracker_getPending(FWExpirationTracker *obj);
+
+gboolean fw_expiration_tracker_handleSignal(FWExpirationTracker *obj, const gchar *signal_name, GVariant *parameters);
+
+gchar *fw_expiration_tracker_portItem(const gchar *port, const gchar *protocol);
+gchar *fw_expiration_tracker_forwardPortItem(const gchar *port, const gchar *protocol, const gchar *toport, const gchar *toaddr);
+
+#endif /* __FW_EXPIRATION_TRACKER_H__ */
@@ -0,0 +1,256 @@
+/*
+ * Copyright (C) 2017 Red Hat, Inc.
+ *
+ * Authors:
+ * Thomas Woerner <twoerner@redhat.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Structural fingerprints of GVariant settings. Basic values are hashed
+ * with MurmurHash3 x64 128 over a fixed little endian encoding, tuples
+ * hash the fingerprints of their children in order. Arrays and dicts are
+ * sets in firewalld: they hash the sum of the fingerprints of their
+ * elements, which does not depend on the element order.
+ */
+
+#include <string.h>
+#include "fw_fingerprint.h"
+
+#define FW_FINGERPRINT_SEED  0
+
+static inline guint64
+_fw_fingerprint_rotl(guint64 x,
+		     gint r)
+{
+    return (x << r) | (x >> (64 - r));
+}
+
+static inline guint64
+_fw_fingerprint_fmix(guint64 k)
+{
+    k ^= k >> 33;
+    k *= G_GUINT64_CONSTANT(0xff51afd7ed558ccd);
+    k ^= k >> 33;
+    k *= G_GUINT64_CONSTANT(0xc4ceb9fe1a85ec53);
+    k ^= k >> 33;
+
+    return k;
+}
+
+/* little endian load, independent of the host byte order */
+static inline guint64
+_fw_fingerprint_load(const guchar *data,
+		     gsize len)
+{
+    guint64 value = 0;
+    gsize i;
+
+    for (i = len; i > 0; i--)
+	value = (value << 8) | data[i - 1];
+
+    return value;
+}
+
+static void
+_fw_fingerprint_murmur(const guchar *data,
+		       gsize len,
+		       FWFingerprint *fingerprint)
+{
+    const guint64 c1 = G_GUINT64_CONSTANT(0x87c37b91114253d5);
+    const guint64 c2 = G_GUINT64_CONSTANT(0x4cf5ad432745937f);
+    guint64 h1 = FW_FINGERPRINT_SEED, h2 = FW_FINGERPRINT_SEED;
+    guint64 k1, k2;
+    gsize i, blocks = len / 16, tail = len % 16;
+
+    for (i = 0; i < blocks; i++) {
+	k1 = _fw_fingerprint_load(data + i * 16, 8);
+	k2 = _fw_fingerprint_load(data + i * 16 + 8, 8);
+
+	k1 *= c1; k1 = _fw_fingerprint_rotl(k1, 31); k1 *= c2; h1 ^= k1;
+	h1 = _fw_fingerprint_rotl(h1, 27); h1 += h2;
+	h1 = h1 * 5 + 0x52dce729;
+
+	k2 *= c2; k2 = _fw_fingerprint_rotl(k2, 33); k2 *= c1; h2 ^= k2;
+	h2 = _fw_fingerprint_rotl(h2, 31); h2 += h1;
+	h2 = h2 * 5 + 0x38495ab5;
+    }
+
+    data += blocks * 16;
+    if (tail > 8) {
+	k2 = _fw_fingerprint_load(data + 8, tail - 8);
+	k2 *= c2; k2 = _fw_fingerprint_rotl(k2, 33); k2 *= c1; h2 ^= k2;
+    }
+    if (tail > 0) {
+	k1 = _fw_fingerprint_load(data, MIN(tail, 8));
+	k1 *= c1; k1 = _fw_fingerprint_rotl(k1, 31); k1 *= c2; h1 ^= k1;
+    }
+
+    h1 ^= len;
+    h2 ^= len;
+    h1 += h2;
+    h2 += h1;
+    h1 = _fw_fingerprint_fmix(h1);
+    h2 = _fw_fingerprint_fmix(h2);
+    h1 += h2;
+    h2 += h1;
+
+    fingerprint->high = h1;
+    fingerprint->low = h2;
+}
+
+static void
+_fw_fingerprint_append_u64(GByteArray *buffer,
+			   guint64 value)
+{
+    guchar bytes[8];
+    guint i;
+
+    for (i = 0; i < 8; i++)
+	bytes[i] = (value >> (8 * i)) & 0xff;
+    g_byte_array_append(buffer, bytes, 8);
+}
+
+static void
+_fw_fingerprint_append(GByteArray *buffer,
+		       const FWFingerprint *fingerprint)
+{
+    _fw_fingerprint_append_u64(buffer, fingerprint->high);
+    _fw_fingerprint_append_u64(buffer, fingerprint->low);
+}
+
+/* basic value encoding, integers widened to 64 bits */
+static void
+_fw_fingerprint_append_basic(GByteArray *buffer,
+			     GVariant *variant)
+{
+    const gchar *str;
+    gdouble d;
+    guint64 bits;
+    gsize len;
+
+    switch (g_variant_classify(variant)) {
+    case G_VARIANT_CLASS_BOOLEAN:
+	_fw_fingerprint_append_u64(buffer, g_variant_get_boolean(variant));
+	break;
+    case G_VARIANT_CLASS_BYTE:
+	_fw_fingerprint_append_u64(buffer, g_variant_get_byte(variant));
+	break;
+    case G_VARIANT_CLASS_INT16:
+	_fw_fingerprint_append_u64(buffer, g_variant_get_int16(variant));
+	break;
+    case G_VARIANT_CLASS_UINT16:
+	_fw_fingerprint_append_u64(buffer, g_variant_get_uint16(variant));
+	break;
+    case G_VARIANT_CLASS_INT32:
+	_fw_fingerprint_append_u64(buffer, g_variant_get_int32(variant));
+	break;
+    case G_VARIANT_CLASS_UINT32:
+	_fw_fingerprint_append_u64(buffer, g_variant_get_uint32(variant));
+	break;
+    case G_VARIANT_CLASS_INT64:
+	_fw_fingerprint_append_u64(buffer, g_variant_get_int64(variant));
+	break;
+    case G_VARIANT_CLASS_UINT64:
+	_fw_fingerprint_append_u64(buffer, g_variant_get_uint64(variant));
+	break;
+    case G_VARIANT_CLASS_HANDLE:
+	_fw_fingerprint_append_u64(buffer, g_variant_get_handle(variant));
+	break;
+    case G_VARIANT_CLASS_DOUBLE:
+	d = g_variant_get_double(variant);
+	memcpy(&bits, &d, sizeof(bits));
+	_fw_fingerprint_append_u64(buffer, bits);
+	break;
+    default:
+	/* string, object path, signature */
+	str = g_variant_get_string(variant, &len);
+	g_byte_array_append(buffer, (const guint8 *) str, len);
+	break;
+    }
+}
+
+/**
+ * fw_fingerprint_variant:
+ * @variant: (type GVariant*): value to fingerprint
+ * @fingerprint: (out caller-allocates): fingerprint of the value
+ *
+ * Equal values have equal fingerprints, arrays and dicts are compared as
+ * multisets: the order of their elements does not matter.
+ */
+void
+fw_fingerprint_variant(GVariant *variant,
+		       FWFingerprint *fingerprint)
+{
+    const gchar *type = g_variant_get_type_string(variant);
+    GByteArray *buffer = g_byte_array_sized_new(64);
+    FWFingerprint child_fingerprint, sum = { 0, 0 };
+    GVariantIter iter;
+    GVariant *child;
+    gsize n = 0;
+
+    /* type and separator, values of different types never collide */
+    g_byte_array_append(buffer, (const guint8 *) type, strlen(type) + 1);
+
+    if (g_variant_is_container(variant)) {
+	gboolean array = g_variant_is_of_type(variant, G_VARIANT_TYPE_ARRAY);
+
+	g_variant_iter_init(&iter, variant);
+	while ((child = g_variant_iter_next_value(&iter)) != NULL) {
+	    fw_fingerprint_variant(child, &child_fingerprint);
+	    if (array) {
+		sum.high += child_fingerprint.high;
+		sum.low += child_fingerprint.low;
+	    } else
+		_fw_fingerprint_append(buffer, &child_fingerprint);
+	    g_variant_unref(child);
+	    n++;
+	}
+
+	if (array) {
+	    _fw_fingerprint_append(buffer, &sum);
+	    _fw_fingerprint_append_u64(buffer, n);
+	}
+    } else
+	_fw_fingerprint_append_basic(buffer, variant);
+
+    _fw_fingerprint_murmur(buffer->data, buffer->len, fingerprint);
+    g_byte_array_unref(buffer);
+}
+
+gboolean
+fw_fingerprint_equal(const FWFingerprint *a,
+		     const FWFingerprint *b)
+{
+    return a->high == b->high && a->low == b->low;
+}
+
+guint
+fw_fingerprint_hash(const FWFingerprint *fingerprint)
+{
+    return (guint) fingerprint->low;
+}
+
+/**
+ * fw_fingerprint_to_string:
+ *
+ * Returns: (transfer full): 32 hex digits
+ */
+gchar *
+fw_fingerprint_to_string(const FWFingerprint *fingerprint)
+{
+    return g_strdup_printf("%016" G_GINT64_MODIFIER "x%016" G_GINT64_MODIFIER
+			   "x", fingerprint->high, fingerprint->low);
+}
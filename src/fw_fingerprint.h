@@ -0,0 +1,38 @@
+/*
+ * Copyright (C) 2017 Red Hat, Inc.
+ *
+ * Authors:
+ * Thomas Woerner <twoerner@redhat.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __FW_FINGERPRINT_H__
+#define __FW_FINGERPRINT_H__
+
+#include <glib.h>
+#include "firewall.h"
+
+/* 128 bit structural hash, stable across hosts and versions */
+typedef struct {
+    guint64 high;
+    guint64 low;
+} FWFingerprint;
+
+void fw_fingerprint_variant(GVariant *variant, FWFingerprint *fingerprint);
+gboolean fw_fingerprint_equal(const FWFingerprint *a, const FWFingerprint *b);
+guint fw_fingerprint_hash(const FWFingerprint *fingerprint);
+gchar *fw_fingerprint_to_string(const FWFingerprint *fingerprint);
+
+#endif /* __FW_FINGERPRINT_H__ */
@@ -20,6 +20,8 @@
 
 #include <string.h>
 #include "fw_forward_port.h"
+#include "fw_trace.h"
+#include "fw_accounting.h"
 
 G_DEFINE_TYPE(FWForwardPort, fw_forward_port, G_TYPE_OBJECT);
 
@@ -45,26 +47,29 @@ fw_forward_port_new_from_variant(GVariant *variant)
     GVariant *item=NULL;
     const gchar *port, *protocol, *toport, *toaddr;
 
+    FW_TRACE_DECODE_START(variant);
+
     item = g_variant_get_child_value(variant, 0);
-    g_variant_get(item, "s", &port);
+    g_variant_get(item, "&s", &port);
     fw_forward_port_setPort(obj, port);
     g_variant_unref(item);
 
     item = g_variant_get_child_value(variant, 1);
-    g_variant_get(item, "s", &protocol);
+    g_variant_get(item, "&s", &protocol);
     fw_forward_port_setProtocol(obj, protocol);
     g_variant_unref(item);
 
     item = g_variant_get_child_value(variant, 2);
-    g_variant_get(item, "s", &toport);
+    g_variant_get(item, "&s", &toport);
     fw_forward_port_setToPort(obj, toport);
     g_variant_unref(item);
 
     item = g_variant_get_child_value(variant, 3);
-    g_variant_get(item, "s", &toaddr);
+    g_variant_get(item, "&s", &toaddr);
     fw_forward_port_setToAddr(obj, toaddr);
     g_variant_unref(item);
 
+    FW_TRACE_DECODE_DONE();
     return obj;
 }
 
@@ -130,6 +135,7 @@ fw_forward_port_class_init(FWForwardPortClass *fw_forward_port_class)
     obj_class->finalize = fw_forward_port_finalize;
 
     g_type_class_add_private(obj_class, sizeof(FWForwardPortPrivate));
+    fw_accounting_register(obj_class, sizeof(FWForwardPortPrivate));
 }
 
 /* methods */
@@ -18,17 +18,280 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+/*
+ * Forward ports in insertion order with a value index on all four fields,
+ * a secondary index on the destination (toaddr, toport) and the numeric
+ * port ranges per protocol sorted by the first port for overlap checks.
+ */
+
 #include <string.h>
+#include <stdlib.h>
 #include "fw_forward_port_list.h"
+#include "fw_trace.h"
+#include "fw_accounting.h"
 
 G_DEFINE_TYPE(FWForwardPortList, fw_forward_port_list, G_TYPE_OBJECT);
 
 #define FW_FORWARD_PORT_LIST_GET_PRIVATE(o) (G_TYPE_INSTANCE_GET_PRIVATE((o), FW_FORWARD_PORT_LIST_TYPE, FWForwardPortListPrivate))
 
+typedef struct {
+    GSequence *entries;		/* FWForwardPortListEntry by port range */
+    guint max_width;		/* widest range ever added */
+} FWForwardPortListRanges;
+
+typedef struct {
+    gchar *key;			/* value key */
+    gchar *destination;		/* destination key */
+    FWForwardPort *forward_port;
+    GList *link;		/* in forward_ports */
+    guint64 serial;		/* insertion order */
+    guint first;		/* port range, not numeric: first > last */
+    guint last;
+    FWForwardPortListRanges *ranges;
+    GSequenceIter *iter;	/* in ranges->entries */
+} FWForwardPortListEntry;
+
 typedef struct {
     GList *forward_ports;              /* list of FWForwardPort */
+    GList *last;			/* last link of forward_ports */
+    GHashTable *entries;		/* value key -> FWForwardPortListEntry */
+    GHashTable *destinations;		/* destination key -> set of entries */
+    GHashTable *ranges;			/* protocol -> FWForwardPortListRanges */
+    guint64 serial;
 } FWForwardPortListPrivate;
 
+/* keys: length prefixed fields */
+
+static void
+_fw_forward_port_list_key_append(GString *key,
+				 const gchar *str)
+{
+    gsize len = (str != NULL) ? strlen(str) : 0;
+
+    g_string_append_printf(key, "%" G_GSIZE_FORMAT ":", len);
+    if (len > 0)
+	g_string_append_len(key, str, len);
+}
+
+static gchar *
+_fw_forward_port_list_key(const gchar *port,
+			  const gchar *protocol,
+			  const gchar *toport,
+			  const gchar *toaddr)
+{
+    GString *key = g_string_sized_new(64);
+
+    _fw_forward_port_list_key_append(key, port);
+    _fw_forward_port_list_key_append(key, protocol);
+    _fw_forward_port_list_key_append(key, toport);
+    _fw_forward_port_list_key_append(key, toaddr);
+
+    return g_string_free(key, FALSE);
+}
+
+static gchar *
+_fw_forward_port_list_destination_key(const gchar *toport,
+				      const gchar *toaddr)
+{
+    GString *key = g_string_sized_new(32);
+
+    _fw_forward_port_list_key_append(key, toaddr);
+    _fw_forward_port_list_key_append(key, toport);
+
+    return g_string_free(key, FALSE);
+}
+
+static gchar *
+_fw_forward_port_list_item_key(FWForwardPort *forward_port)
+{
+    return _fw_forward_port_list_key(fw_forward_port_getPort(forward_port),
+				     fw_forward_port_getProtocol(forward_port),
+				     fw_forward_port_getToPort(forward_port),
+				     fw_forward_port_getToAddr(forward_port));
+}
+
+/* "port" or "first-last", FALSE if not numeric */
+static gboolean
+_fw_forward_port_list_parse_range(const gchar *port,
+				  guint *first,
+				  guint *last)
+{
+    gchar *end;
+    gulong value;
+
+    if (port == NULL || !g_ascii_isdigit(*port))
+	return FALSE;
+
+    value = strtoul(port, &end, 10);
+    if (value > 65535)
+	return FALSE;
+    *first = *last = value;
+
+    if (*end == '-') {
+	if (!g_ascii_isdigit(end[1]))
+	    return FALSE;
+	value = strtoul(end + 1, &end, 10);
+	if (value > 65535 || value < *first)
+	    return FALSE;
+	*last = value;
+    }
+
+    return *end == '\0';
+}
+
+static gint
+_fw_forward_port_list_range_cmp(gconstpointer a,
+				gconstpointer b,
+				gpointer user_data)
+{
+    const FWForwardPortListEntry *entry_a = a;
+    const FWForwardPortListEntry *entry_b = b;
+
+    if (entry_a->first != entry_b->first)
+	return (entry_a->first < entry_b->first) ? -1 : 1;
+    if (entry_a->last != entry_b->last)
+	return (entry_a->last < entry_b->last) ? -1 : 1;
+    return 0;
+}
+
+/* list order, entries are only appended */
+static gint
+_fw_forward_port_list_order_cmp(gconstpointer a,
+				gconstpointer b)
+{
+    const FWForwardPortListEntry *entry_a = a;
+    const FWForwardPortListEntry *entry_b = b;
+
+    if (entry_a->serial != entry_b->serial)
+	return (entry_a->serial < entry_b->serial) ? -1 : 1;
+    return 0;
+}
+
+static void
+_fw_forward_port_list_ranges_free(gpointer data)
+{
+    FWForwardPortListRanges *ranges = data;
+
+    g_sequence_free(ranges->entries);
+    g_slice_free(FWForwardPortListRanges, ranges);
+}
+
+static void
+_fw_forward_port_list_entry_free(gpointer data)
+{
+    FWForwardPortListEntry *entry = data;
+
+    g_object_unref(entry->forward_port);
+    g_free(entry->key);
+    g_free(entry->destination);
+    g_slice_free(FWForwardPortListEntry, entry);
+}
+
+/* takes the reference of forward_port, FALSE if it is already listed */
+static gboolean
+_fw_forward_port_list_insert(FWForwardPortListPrivate *priv,
+			     FWForwardPort *forward_port)
+{
+    FWForwardPortListEntry *entry;
+    GHashTable *destination;
+    const gchar *protocol;
+    gchar *key;
+
+    key = _fw_forward_port_list_item_key(forward_port);
+    if (g_hash_table_contains(priv->entries, key)) {
+	g_free(key);
+	g_object_unref(forward_port);
+	return FALSE;
+    }
+
+    entry = g_slice_new0(FWForwardPortListEntry);
+    entry->key = key;
+    entry->forward_port = forward_port;
+    entry->serial = priv->serial++;
+    g_hash_table_insert(priv->entries, entry->key, entry);
+
+    priv->last = g_list_append(priv->last, forward_port);
+    if (priv->forward_ports == NULL)
+	priv->forward_ports = priv->last;
+    else
+	priv->last = priv->last->next;
+    entry->link = priv->last;
+
+    entry->destination = _fw_forward_port_list_destination_key(
+	fw_forward_port_getToPort(forward_port),
+	fw_forward_port_getToAddr(forward_port));
+    destination = g_hash_table_lookup(priv->destinations, entry->destination);
+    if (destination == NULL) {
+	destination = g_hash_table_new(g_direct_hash, g_direct_equal);
+	g_hash_table_insert(priv->destinations, g_strdup(entry->destination),
+			    destination);
+    }
+    g_hash_table_add(destination, entry);
+
+    protocol = fw_forward_port_getProtocol(forward_port);
+    if (protocol != NULL &&
+	_fw_forward_port_list_parse_range(fw_forward_port_getPort(forward_port),
+					  &entry->first, &entry->last))
+    {
+	entry->ranges = g_hash_table_lookup(priv->ranges, protocol);
+	if (entry->ranges == NULL) {
+	    entry->ranges = g_slice_new0(FWForwardPortListRanges);
+	    entry->ranges->entries = g_sequence_new(NULL);
+	    g_hash_table_insert(priv->ranges, g_strdup(protocol),
+				entry->ranges);
+	}
+	entry->ranges->max_width = MAX(entry->ranges->max_width,
+				       entry->last - entry->first);
+	entry->iter = g_sequence_insert_sorted(entry->ranges->entries, entry,
+					       _fw_forward_port_list_range_cmp,
+					       NULL);
+    } else {
+	entry->first = 1;
+	entry->last = 0;
+    }
+
+    return TRUE;
+}
+
+static gboolean
+_fw_forward_port_list_delete(FWForwardPortListPrivate *priv,
+			     const gchar *key)
+{
+    FWForwardPortListEntry *entry;
+    GHashTable *destination;
+
+    entry = g_hash_table_lookup(priv->entries, key);
+    if (entry == NULL)
+	return FALSE;
+
+    if (entry->link == priv->last)
+	priv->last = priv->last->prev;
+    priv->forward_ports = g_list_delete_link(priv->forward_ports, entry->link);
+
+    destination = g_hash_table_lookup(priv->destinations, entry->destination);
+    g_hash_table_remove(destination, entry);
+    if (g_hash_table_size(destination) == 0)
+	g_hash_table_remove(priv->destinations, entry->destination);
+
+    if (entry->iter != NULL)
+	g_sequence_remove(entry->iter);
+
+    g_hash_table_remove(priv->entries, key);
+
+    return TRUE;
+}
+
+static void
+_fw_forward_port_list_clear(FWForwardPortListPrivate *priv)
+{
+    g_list_free(priv->forward_ports);
+    priv->forward_ports = NULL;
+    priv->last = NULL;
+    g_hash_table_remove_all(priv->destinations);
+    g_hash_table_remove_all(priv->ranges);
+    g_hash_table_remove_all(priv->entries);
+}
+
 FWForwardPortList *
 fw_forward_port_list_new()
 {
@@ -49,6 +312,8 @@ fw_forward_port_list_new_from_variant(GVariant *variant)
 	    return list;
     }
 
+    FW_TRACE_DECODE_START(variant);
+
     list = fw_forward_port_list_new();
 
     if (g_variant_iter_init(&iter, variant)) {
@@ -76,10 +341,15 @@ fw_forward_port_list_new_from_variant(GVariant *variant)
 
 	    fw_forward_port_list_addForwardPort(list, port, protocol,
 						toport, toaddr);
+	    g_free(port);
+	    g_free(protocol);
+	    g_free(toport);
+	    g_free(toaddr);
 	    g_variant_unref(element);
 	}
     }
 
+    FW_TRACE_DECODE_DONE();
     return list;
 }
 
@@ -127,7 +397,7 @@ fw_forward_port_list_length(FWForwardPortList *obj)
 {
     FWForwardPortListPrivate *priv = FW_FORWARD_PORT_LIST_GET_PRIVATE(obj);
 
-    return g_list_length(priv->forward_ports);
+    return g_hash_table_size(priv->entries);
 }
 
 gpointer
@@ -144,14 +414,7 @@ fw_forward_port_list_free(FWForwardPortList *obj)
 {
     FWForwardPortListPrivate *priv = FW_FORWARD_PORT_LIST_GET_PRIVATE(obj);
 
-    if (priv->forward_ports != NULL) {
-/*
-        gint i;
-	for (i=0; i<g_list_length(priv->forward_ports); i++)
-	    g_free(g_list_nth_data(priv->forward_ports, i));
-*/
-	g_list_free(priv->forward_ports);
-    }
+    _fw_forward_port_list_clear(priv);
 }
 
 static void
@@ -161,19 +424,26 @@ fw_forward_port_list_init(FWForwardPortList *obj)
 
     /* init vars */
     priv->forward_ports = NULL;
+    priv->last = NULL;
+    priv->serial = 0;
+    priv->entries = g_hash_table_new_full(g_str_hash, g_str_equal, NULL,
+					  _fw_forward_port_list_entry_free);
+    priv->destinations = g_hash_table_new_full(
+	g_str_hash, g_str_equal, g_free,
+	(GDestroyNotify) g_hash_table_destroy);
+    priv->ranges = g_hash_table_new_full(g_str_hash, g_str_equal, g_free,
+					 _fw_forward_port_list_ranges_free);
 }
 
 static void
 fw_forward_port_list_finalize(GObject *obj)
 {
     FWForwardPortListPrivate *priv = FW_FORWARD_PORT_LIST_GET_PRIVATE(obj);
-    gint i;
 
-    if (priv->forward_ports != NULL) {
-	for (i=0; i<g_list_length(priv->forward_ports); i++)
-	    g_free(g_list_nth_data(priv->forward_ports, i));
-	g_list_free(priv->forward_ports);
-    }
+    _fw_forward_port_list_clear(priv);
+    g_hash_table_destroy(priv->entries);
+    g_hash_table_destroy(priv->destinations);
+    g_hash_table_destroy(priv->ranges);
 
     G_OBJECT_CLASS(fw_forward_port_list_parent_class)->finalize(obj);
 }
@@ -186,6 +456,7 @@ fw_forward_port_list_class_init(FWForwardPortListClass *fw_forward_port_list_cla
     obj_class->finalize = fw_forward_port_list_finalize;
 
     g_type_class_add_private(obj_class, sizeof(FWForwardPortListPrivate));
+    fw_accounting_register(obj_class, sizeof(FWForwardPortListPrivate));
 }
 
 /* methods */
@@ -271,17 +542,19 @@ fw_forward_port_list_getForwardPorts(FWForwardPortList *obj)
 /**
  * fw_forward_port_list_setForwardPorts:
  * @obj: (type FWForwardPortList*): a FWForwardPortList instance
- * @forward_ports: (type GList*) (element-type FWForwardPort*)
+ * @forward_ports: (type GList*) (transfer full) (element-type FWForwardPort*)
  */
 void
 fw_forward_port_list_setForwardPorts(FWForwardPortList *obj,
 		   GList *forward_ports)
 {
     FWForwardPortListPrivate *priv = FW_FORWARD_PORT_LIST_GET_PRIVATE(obj);
+    GList *list;
 
-    if (priv->forward_ports != NULL)
-	g_free(priv->forward_ports); /* TODO* */
-    priv->forward_ports = forward_ports; /* TODO */
+    _fw_forward_port_list_clear(priv);
+    for (list = forward_ports; list != NULL; list = list->next)
+	_fw_forward_port_list_insert(priv, list->data);
+    g_list_free(forward_ports);
 }
 
 /*
@@ -327,7 +600,7 @@ fw_forward_port_list_addForwardPort(FWForwardPortList *obj,
     FWForwardPortListPrivate *priv = FW_FORWARD_PORT_LIST_GET_PRIVATE(obj);
     FWForwardPort *item = fw_forward_port_new(port, protocol, toport, toaddr);
 
-    priv->forward_ports = g_list_append(priv->forward_ports, item);
+    _fw_forward_port_list_insert(priv, item);
 }
 
 void
@@ -338,10 +611,11 @@ fw_forward_port_list_removeForwardPort(FWForwardPortList *obj,
 				       gchar *toaddr)
 {
     FWForwardPortListPrivate *priv = FW_FORWARD_PORT_LIST_GET_PRIVATE(obj);
-    FWForwardPort *item = fw_forward_port_new(forward_port, protocol,
-					      toport, toaddr);
+    gchar *key = _fw_forward_port_list_key(forward_port, protocol, toport,
+					   toaddr);
 
-    priv->forward_ports = g_list_remove(priv->forward_ports, item);
+    _fw_forward_port_list_delete(priv, key);
+    g_free(key);
 }
 
 gboolean
@@ -352,43 +626,205 @@ fw_forward_port_list_queryForwardPort(FWForwardPortList *obj,
 				      gchar *toaddr)
 {
     FWForwardPortListPrivate *priv = FW_FORWARD_PORT_LIST_GET_PRIVATE(obj);
-    FWForwardPort *item = fw_forward_port_new(forward_port, protocol,
-					      toport, toaddr);
-    GList *list;
+    gchar *key = _fw_forward_port_list_key(forward_port, protocol, toport,
+					   toaddr);
+    gboolean ret;
 
-    list = g_list_find(priv->forward_ports, item);
-    if (list == NULL)
-	return FALSE;
-    return TRUE;
+    ret = g_hash_table_contains(priv->entries, key);
+    g_free(key);
+
+    return ret;
 }
 
+/**
+ * fw_forward_port_list_add:
+ * @obj: (type FWForwardPortList*): a FWForwardPortList instance
+ * @forward_port: (type FWForwardPort*) (transfer full): forward port, it
+ *   is dropped if an equal one is already listed
+ */
 void
 fw_forward_port_list_add(FWForwardPortList *obj,
 			 FWForwardPort *forward_port)
 {
     FWForwardPortListPrivate *priv = FW_FORWARD_PORT_LIST_GET_PRIVATE(obj);
 
-    priv->forward_ports = g_list_append(priv->forward_ports, forward_port);
+    _fw_forward_port_list_insert(priv, forward_port);
 }
 
+/**
+ * fw_forward_port_list_remove:
+ * @obj: (type FWForwardPortList*): a FWForwardPortList instance
+ * @forward_port: (type FWForwardPort*): forward port, compared by value
+ */
 void
 fw_forward_port_list_remove(FWForwardPortList *obj,
 			    FWForwardPort *forward_port)
 {
     FWForwardPortListPrivate *priv = FW_FORWARD_PORT_LIST_GET_PRIVATE(obj);
+    gchar *key = _fw_forward_port_list_item_key(forward_port);
 
-    priv->forward_ports = g_list_remove(priv->forward_ports, forward_port);
+    _fw_forward_port_list_delete(priv, key);
+    g_free(key);
 }
 
+/**
+ * fw_forward_port_list_query:
+ * @obj: (type FWForwardPortList*): a FWForwardPortList instance
+ * @forward_port: (type FWForwardPort*): forward port, compared by value
+ */
 gboolean
 fw_forward_port_list_query(FWForwardPortList *obj,
 			   FWForwardPort *forward_port)
 {
     FWForwardPortListPrivate *priv = FW_FORWARD_PORT_LIST_GET_PRIVATE(obj);
-    GList *list;
+    gchar *key = _fw_forward_port_list_item_key(forward_port);
+    gboolean ret;
 
-    list = g_list_find(priv->forward_ports, forward_port);
-    if (list == NULL)
-	return FALSE;
-    return TRUE;
+    ret = g_hash_table_contains(priv->entries, key);
+    g_free(key);
+
+    return ret;
+}
+
+/* lookups */
+
+/**
+ * fw_forward_port_list_getByDestination:
+ * @obj: (type FWForwardPortList*): a FWForwardPortList instance
+ * @toport: (type utf8) (allow-none): destination port, "" or NULL for none
+ * @toaddr: (type utf8) (allow-none): destination address, "" or NULL for
+ *   none
+ *
+ * Returns: (type GList*) (transfer container) (element-type FWForwardPort*):
+ * forward ports to the destination in list order
+ */
+GList *
+fw_forward_port_list_getByDestination(FWForwardPortList *obj,
+				      const gchar *toport,
+				      const gchar *toaddr)
+{
+    FWForwardPortListPrivate *priv = FW_FORWARD_PORT_LIST_GET_PRIVATE(obj);
+    GHashTable *destination;
+    GList *list, *ret;
+    gchar *key;
+
+    key = _fw_forward_port_list_destination_key(toport, toaddr);
+    destination = g_hash_table_lookup(priv->destinations, key);
+    g_free(key);
+    if (destination == NULL)
+	return NULL;
+
+    ret = g_list_sort(g_hash_table_get_keys(destination),
+		      _fw_forward_port_list_order_cmp);
+    for (list = ret; list != NULL; list = list->next)
+	list->data = ((FWForwardPortListEntry *) list->data)->forward_port;
+
+    return ret;
+}
+
+/* entries of ranges that overlap [first, last], in range order */
+static GList *
+_fw_forward_port_list_overlaps(FWForwardPortListRanges *ranges,
+			       guint first,
+			       guint last,
+			       FWForwardPortListEntry *skip)
+{
+    FWForwardPortListEntry probe;
+    GSequenceIter *iter, *prev;
+    GList *ret = NULL;
+
+    /* no range that starts before first - max_width can reach first */
+    probe.first = (first > ranges->max_width) ? first - ranges->max_width : 0;
+    probe.last = 0;
+    iter = g_sequence_search(ranges->entries, &probe,
+			     _fw_forward_port_list_range_cmp, NULL);
+    while (!g_sequence_iter_is_begin(iter)) {
+	prev = g_sequence_iter_prev(iter);
+	if (((FWForwardPortListEntry *) g_sequence_get(prev))->first <
+	    probe.first)
+	    break;
+	iter = prev;
+    }
+
+    for (; !g_sequence_iter_is_end(iter); iter = g_sequence_iter_next(iter)) {
+	FWForwardPortListEntry *entry = g_sequence_get(iter);
+
+	if (entry->first > last)
+	    break;
+	if (entry->last >= first && entry != skip)
+	    ret = g_list_prepend(ret, entry);
+    }
+
+    return g_list_reverse(ret);
+}
+
+/**
+ * fw_forward_port_list_getConflicts:
+ * @obj: (type FWForwardPortList*): a FWForwardPortList instance
+ * @port: (type utf8): port or port range "first-last"
+ * @protocol: (type utf8): protocol
+ *
+ * Returns: (type GList*) (transfer container) (element-type FWForwardPort*):
+ * listed forward ports of the protocol with port ranges that overlap
+ * @port, by first port
+ */
+GList *
+fw_forward_port_list_getConflicts(FWForwardPortList *obj,
+				  const gchar *port,
+				  const gchar *protocol)
+{
+    FWForwardPortListPrivate *priv = FW_FORWARD_PORT_LIST_GET_PRIVATE(obj);
+    FWForwardPortListRanges *ranges;
+    GList *list, *ret;
+    guint first, last;
+
+    ranges = g_hash_table_lookup(priv->ranges, protocol);
+    if (ranges == NULL ||
+	!_fw_forward_port_list_parse_range(port, &first, &last))
+	return NULL;
+
+    ret = _fw_forward_port_list_overlaps(ranges, first, last, NULL);
+    for (list = ret; list != NULL; list = list->next)
+	list->data = ((FWForwardPortListEntry *) list->data)->forward_port;
+
+    return ret;
+}
+
+/**
+ * fw_forward_port_list_getAllConflicts:
+ * @obj: (type FWForwardPortList*): a FWForwardPortList instance
+ *
+ * Collisions within the list: a packet to a port of an overlap is only
+ * forwarded by one of the forward ports.
+ *
+ * Returns: (type GList*) (transfer container) (element-type FWForwardPort*):
+ * listed forward ports that overlap another one, in list order
+ */
+GList *
+fw_forward_port_list_getAllConflicts(FWForwardPortList *obj)
+{
+    FWForwardPortListPrivate *priv = FW_FORWARD_PORT_LIST_GET_PRIVATE(obj);
+    GHashTableIter iter;
+    GList *list, *overlaps, *ret = NULL;
+    gpointer value;
+
+    g_hash_table_iter_init(&iter, priv->entries);
+    while (g_hash_table_iter_next(&iter, NULL, &value)) {
+	FWForwardPortListEntry *entry = value;
+
+	if (entry->ranges == NULL)
+	    continue;
+
+	overlaps = _fw_forward_port_list_overlaps(entry->ranges, entry->first,
+						  entry->last, entry);
+	if (overlaps != NULL)
+	    ret = g_list_prepend(ret, entry);
+	g_list_free(overlaps);
+    }
+
+    ret = g_list_sort(ret, _fw_forward_port_list_order_cmp);
+    for (list = ret; list != NULL; list = list->next)
+	list->data = ((FWForwardPortListEntry *) list->data)->forward_port;
+
+    return ret;
 }
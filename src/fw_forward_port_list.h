@@ -69,4 +69,8 @@ void fw_forward_port_list_add(FWForwardPortList *obj, FWForwardPort *forward_por
 void fw_forward_port_list_remove(FWForwardPortList *obj, FWForwardPort *forward_port);
 gboolean fw_forward_port_list_query(FWForwardPortList *obj, FWForwardPort *forward_port);
 
+GList *fw_forward_port_list_getByDestination(FWForwardPortList *obj, const gchar *toport, const gchar *toaddr);
+GList *fw_forward_port_list_getConflicts(FWForwardPortList *obj, const gchar *port, const gchar *protocol);
+GList *fw_forward_port_list_getAllConflicts(FWForwardPortList *obj);
+
 #endif /* __FW_FORWARD_PORT_LIST_H__ */
@@ -20,6 +20,7 @@
 
 #include <string.h>
 #include "fw_functions.h"
+#include "fw_trace.h"
 
 /**
  * fw_str_equal:
@@ -233,10 +234,10 @@ GVariantBuilder *
 fw_str_list_to_builder(GList *list)
 {
     GVariantBuilder *builder = g_variant_builder_new(G_VARIANT_TYPE("as"));
-    gint i;
+    GList *l;
 
-    for (i=0; i<g_list_length(list); i++)
-	g_variant_builder_add(builder, "s", g_list_nth_data(list, i));
+    for (l = list; l != NULL; l = l->next)
+	g_variant_builder_add(builder, "s", l->data);
 
     return builder;
 }
@@ -257,17 +258,130 @@ fw_str_list_new_from_variant(GVariant *variant)
     if (strncmp(g_variant_get_type_string(variant), "(as)", 4) != 0) {
 	if (strncmp(g_variant_get_type_string(variant), "as", 2) != 0)
 	    return NULL;
+	g_variant_ref(variant);
     } else
 	variant = g_variant_get_child_value(variant, 0);
 
+    FW_TRACE_DECODE_START(variant);
+
     if (g_variant_iter_init(&iter, variant)) {
 	while ((element = g_variant_iter_next_value(&iter)) != NULL) {
 	    g_variant_get(element, "s", &str);
-	    list = g_list_append(list, g_strdup(str));
+	    list = g_list_prepend(list, str);
 	    g_variant_unref(element);
 	}
     }
+    list = g_list_reverse(list);
     g_variant_unref(variant);
 
+    FW_TRACE_DECODE_DONE();
     return list;
 }
+
+/**
+ * fw_variant_to_value:
+ * @variant: (type GVariant*): a D-Bus property value
+ * @value: (type GValue*): an initialized GValue of a string, boolean or
+ *   GPtrArray property
+ *
+ * Sets value from variant. String arrays and the keys of string
+ * dictionaries are stored in a GPtrArray of strings.
+ *
+ * Returns: FALSE if the types do not match
+ */
+gboolean
+fw_variant_to_value(GVariant *variant,
+		    GValue *value)
+{
+    GType type = G_VALUE_TYPE(value);
+
+    if (type == G_TYPE_STRING &&
+	g_variant_is_of_type(variant, G_VARIANT_TYPE_STRING)) {
+	g_value_set_string(value, g_variant_get_string(variant, NULL));
+	return TRUE;
+    }
+
+    if (type == G_TYPE_BOOLEAN &&
+	g_variant_is_of_type(variant, G_VARIANT_TYPE_BOOLEAN)) {
+	g_value_set_boolean(value, g_variant_get_boolean(variant));
+	return TRUE;
+    }
+
+    if (type == G_TYPE_PTR_ARRAY &&
+	(g_variant_is_of_type(variant, G_VARIANT_TYPE("as")) ||
+	 g_variant_is_of_type(variant, G_VARIANT_TYPE("a{s*}")))) {
+	GPtrArray *array;
+	GVariantIter iter;
+	GVariant *element;
+
+	array = g_ptr_array_new_with_free_func(g_free);
+	g_variant_iter_init(&iter, variant);
+	while ((element = g_variant_iter_next_value(&iter)) != NULL) {
+	    GVariant *str = element;
+
+	    if (g_variant_is_of_type(element, G_VARIANT_TYPE_DICT_ENTRY))
+		str = g_variant_get_child_value(element, 0);
+	    g_ptr_array_add(array, g_variant_dup_string(str, NULL));
+	    if (str != element)
+		g_variant_unref(str);
+	    g_variant_unref(element);
+	}
+	g_value_take_boxed(value, array);
+	return TRUE;
+    }
+
+    return FALSE;
+}
+
+/* emits notify for a D-Bus property change */
+static void
+_fw_notify_property(GObject *obj,
+		    const gchar *dbus_name)
+{
+    gchar *name = g_strdelimit(g_strdup(dbus_name), "_", '-');
+
+    if (g_object_class_find_property(G_OBJECT_GET_CLASS(obj), name) != NULL)
+	g_object_notify(obj, name);
+    g_free(name);
+}
+
+/**
+ * fw_notify_properties:
+ * @obj: (type GObject*): object with properties named like the D-Bus
+ *   properties, with '-' instead of '_'
+ * @changed_properties: (type GVariant*): a{sv} of changed properties
+ * @invalidated_properties: (array zero-terminated=1) (allow-none): names
+ *   of invalidated properties
+ *
+ * Emits notify for the properties of a PropertiesChanged signal.
+ */
+void
+fw_notify_properties(GObject *obj,
+		     GVariant *changed_properties,
+		     const gchar **invalidated_properties)
+{
+    GVariantIter iter;
+    const gchar *key;
+    guint i;
+
+    g_variant_iter_init(&iter, changed_properties);
+    while (g_variant_iter_next(&iter, "{&sv}", &key, NULL))
+	_fw_notify_property(obj, key);
+    for (i = 0; invalidated_properties != NULL &&
+	     invalidated_properties[i] != NULL; i++)
+	_fw_notify_property(obj, invalidated_properties[i]);
+}
+
+/**
+ * fw_method_is_read:
+ * @method_name: firewalld method
+ *
+ * Returns: TRUE if the method does not change the state of firewalld
+ */
+gboolean
+fw_method_is_read(const gchar *method_name)
+{
+    return (g_str_has_prefix(method_name, "get") ||
+	    g_str_has_prefix(method_name, "query") ||
+	    g_str_has_prefix(method_name, "list"));
+}
@@ -22,6 +22,7 @@
 #define __FW_FUNCTIONS_H__
 
 #include <glib.h>
+#include <glib-object.h>
 
 /*
 gint g_list_str_equal(gconstpointer a, gconstpointer b);
@@ -53,4 +54,9 @@ GVariant *fw_str_list_to_variant(GList *list);
 GVariantBuilder *fw_str_list_to_builder(GList *list);
 GList *fw_str_list_new_from_variant(GVariant *variant);
 
+gboolean fw_variant_to_value(GVariant *variant, GValue *value);
+void fw_notify_properties(GObject *obj, GVariant *changed_properties, const gchar **invalidated_properties);
+
+gboolean fw_method_is_read(const gchar *method_name);
+
 #endif /* __FW_FUNCTIONS_H__ */
@@ -19,6 +19,8 @@
  */
 
 #include "fw_helper.h"
+#include "fw_trace.h"
+#include "fw_accounting.h"
 #include <string.h>
 
 G_DEFINE_TYPE(FWHelper, fw_helper, G_TYPE_OBJECT);
@@ -32,6 +34,8 @@ typedef struct {
     gchar *family;             /* string */
     gchar *module;             /* string */
     FWPortList *ports;         /* list of FWPort */
+    FWFingerprint fingerprint;  /* cached structural hash */
+    gboolean fingerprint_valid;
 } FWHelperPrivate;
 
 FWHelper *
@@ -56,6 +60,8 @@ fw_helper_new_from_variant(GVariant *variant)
        return obj;
     }
 
+    FW_TRACE_DECODE_START(variant);
+
     /* get sssssa(ss) from (sssssa(ss)) */
     variant = g_variant_get_child_value(variant, 0);
 
@@ -63,31 +69,31 @@ fw_helper_new_from_variant(GVariant *variant)
 
     /* 0: version */
     item = g_variant_get_child_value(variant, 0);
-    g_variant_get(item, "s", &str);
+    g_variant_get(item, "&s", &str);
     fw_helper_setVersion(obj, str);
     g_variant_unref(item);
 
     /* 1: short */
     item = g_variant_get_child_value(variant, 1);
-    g_variant_get(item, "s", &str);
+    g_variant_get(item, "&s", &str);
     fw_helper_setShort(obj, str);
     g_variant_unref(item);
 
     /* 2: description */
     item = g_variant_get_child_value(variant, 2);
-    g_variant_get(item, "s", &str);
+    g_variant_get(item, "&s", &str);
     fw_helper_setDescription(obj, str);
     g_variant_unref(item);
 
     /* 3: family */
     item = g_variant_get_child_value(variant, 3);
-    g_variant_get(item, "s", &str);
+    g_variant_get(item, "&s", &str);
     fw_helper_setFamily(obj, str);
     g_variant_unref(item);
 
     /* 4: module */
     item = g_variant_get_child_value(variant, 4);
-    g_variant_get(item, "s", &str);
+    g_variant_get(item, "&s", &str);
     fw_helper_setModule(obj, str);
     g_variant_unref(item);
 
@@ -96,6 +102,9 @@ fw_helper_new_from_variant(GVariant *variant)
     fw_helper_setPorts(obj, fw_port_list_new_from_variant(item));
     g_variant_unref(item);
 
+    g_variant_unref(variant);
+
+    FW_TRACE_DECODE_DONE();
     return obj;
 }
 
@@ -131,6 +140,7 @@ fw_helper_init(FWHelper *obj)
     priv->family = g_strdup("");
     priv->module = g_strdup("");
     priv->ports = fw_port_list_new();
+    priv->fingerprint_valid = FALSE;
 }
 
 static void
@@ -149,7 +159,7 @@ fw_helper_finalize(GObject *obj)
     if (priv->module != NULL)
 	g_free(priv->module);
     if (priv->ports != NULL)
-	fw_port_list_free(priv->ports);
+	g_object_unref(priv->ports);
     G_OBJECT_CLASS(fw_helper_parent_class)->finalize(obj);
 }
 
@@ -161,6 +171,7 @@ fw_helper_class_init(FWHelperClass *fw_helper_class)
     obj_class->finalize = fw_helper_finalize;
 
     g_type_class_add_private(obj_class, sizeof(FWHelperPrivate));
+    fw_accounting_register(obj_class, sizeof(FWHelperPrivate));
 }
 
 /* methods */
@@ -204,6 +215,7 @@ fw_helper_setVersion(FWHelper *obj,
     if (priv->version != NULL)
 	g_free(priv->version);
     priv->version = g_strdup(version);
+    priv->fingerprint_valid = FALSE;
 }
 
 /**
@@ -228,6 +240,7 @@ fw_helper_setShort(FWHelper *obj,
     if (priv->short_description != NULL)
 	g_free(priv->short_description);
     priv->short_description = g_strdup(short_description);
+    priv->fingerprint_valid = FALSE;
 }
 
 /**
@@ -252,6 +265,7 @@ fw_helper_setDescription(FWHelper *obj,
     if (priv->description != NULL)
 	g_free(priv->description);
     priv->description = g_strdup(description);
+    priv->fingerprint_valid = FALSE;
 }
 
 /**
@@ -276,6 +290,7 @@ fw_helper_setFamily(FWHelper *obj,
     if (priv->family != NULL)
 	g_free(priv->family);
     priv->family = g_strdup(family);
+    priv->fingerprint_valid = FALSE;
 }
 
 /**
@@ -300,6 +315,7 @@ fw_helper_setModule(FWHelper *obj,
     if (priv->module != NULL)
 	g_free(priv->module);
     priv->module = g_strdup(module);
+    priv->fingerprint_valid = FALSE;
 }
 
 /**
@@ -318,7 +334,8 @@ fw_helper_getPorts(FWHelper *obj)
 /**
  * fw_helper_setPorts:
  * @obj: (type FWHelper*): a FWHelper instance
- * @ports: (type FWPortList*)
+ * @ports: (type FWPortList*) (transfer full): the list is owned by @obj
+ *   afterwards
  */
 void
 fw_helper_setPorts(FWHelper *obj,
@@ -326,9 +343,13 @@ fw_helper_setPorts(FWHelper *obj,
 {
     FWHelperPrivate *priv = FW_HELPER_GET_PRIVATE(obj);
 
+    if (ports == priv->ports)
+	return;
+
     if (priv->ports != NULL)
-	fw_port_list_free(priv->ports);
+	g_object_unref(priv->ports);
     priv->ports = ports;
+    priv->fingerprint_valid = FALSE;
 }
 
 void
@@ -339,6 +360,7 @@ fw_helper_addPort(FWHelper *obj,
     FWHelperPrivate *priv = FW_HELPER_GET_PRIVATE(obj);
 
     fw_port_list_addPort(priv->ports, port, protocol);
+    priv->fingerprint_valid = FALSE;
 }
 
 void
@@ -349,6 +371,7 @@ fw_helper_removePort(FWHelper *obj,
     FWHelperPrivate *priv = FW_HELPER_GET_PRIVATE(obj);
 
     fw_port_list_removePort(priv->ports, port, protocol);
+    priv->fingerprint_valid = FALSE;
 }
 
 gboolean
@@ -368,6 +391,7 @@ fw_helper_add_port(FWHelper *obj,
     FWHelperPrivate *priv = FW_HELPER_GET_PRIVATE(obj);
 
     fw_port_list_add(priv->ports, port);
+    priv->fingerprint_valid = FALSE;
 }
 
 void
@@ -377,6 +401,7 @@ fw_helper_remove_port(FWHelper *obj,
     FWHelperPrivate *priv = FW_HELPER_GET_PRIVATE(obj);
 
     fw_port_list_remove(priv->ports, port);
+    priv->fingerprint_valid = FALSE;
 }
 
 gboolean
@@ -387,3 +412,54 @@ fw_helper_query_port(FWHelper *obj,
 
     return fw_port_list_query(priv->ports, port);
 }
+
+/* fingerprint */
+
+/**
+ * fw_helper_getFingerprint:
+ * @obj: (type FWHelper*): a FWHelper instance
+ *
+ * Order insensitive structural hash of the settings, cached until the
+ * next change through the FWHelper methods.
+ *
+ * Returns: (transfer none): fingerprint of the settings
+ */
+const FWFingerprint *
+fw_helper_getFingerprint(FWHelper *obj)
+{
+    FWHelperPrivate *priv = FW_HELPER_GET_PRIVATE(obj);
+    GVariant *variant;
+
+    if (!priv->fingerprint_valid) {
+	variant = g_variant_ref_sink(fw_helper_to_variant(obj));
+	fw_fingerprint_variant(variant, &priv->fingerprint);
+	g_variant_unref(variant);
+	priv->fingerprint_valid = TRUE;
+    }
+
+    return &priv->fingerprint;
+}
+
+/**
+ * fw_helper_equal:
+ * @a: (type FWHelper*): a FWHelper instance
+ * @b: (type FWHelper*): a FWHelper instance
+ *
+ * Returns: TRUE if the settings are equal up to the order of list items
+ */
+gboolean
+fw_helper_equal(FWHelper *a,
+		FWHelper *b)
+{
+    if (a == b)
+	return TRUE;
+
+    return fw_fingerprint_equal(fw_helper_getFingerprint(a),
+				fw_helper_getFingerprint(b));
+}
+
+guint
+fw_helper_hash(FWHelper *obj)
+{
+    return fw_fingerprint_hash(fw_helper_getFingerprint(obj));
+}
@@ -24,6 +24,7 @@
 #include <glib.h>
 #include <glib-object.h>
 #include "firewall.h"
+#include "fw_fingerprint.h"
 #include "fw_functions.h"
 #include "fw_port.h"
 #include "fw_port_list.h"
@@ -75,4 +76,8 @@ void fw_helper_add_port(FWHelper *obj, FWPort *port);
 void fw_helper_remove_port(FWHelper *obj, FWPort *port);
 gboolean fw_helper_query_port(FWHelper *obj, FWPort *port);
 
+const FWFingerprint *fw_helper_getFingerprint(FWHelper *obj);
+gboolean fw_helper_equal(FWHelper *a, FWHelper *b);
+guint fw_helper_hash(FWHelper *obj);
+
 #endif /* __FW_HELPER_H__ */
@@ -0,0 +1,216 @@
+/*
+ * Copyright (C) 2017 Red Hat, Inc.
+ *
+ * Authors:
+ * Thomas Woerner <twoerner@redhat.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Histogram of durations with power of two buckets: constant size and
+ * constant time per value, percentiles are exact to a factor of two.
+ */
+
+#include "fw_histogram.h"
+#include "fw_accounting.h"
+
+G_DEFINE_TYPE(FWHistogram, fw_histogram, G_TYPE_OBJECT);
+
+#define FW_HISTOGRAM_GET_PRIVATE(o) (G_TYPE_INSTANCE_GET_PRIVATE((o), FW_HISTOGRAM_TYPE, FWHistogramPrivate))
+
+typedef struct {
+    guint64 buckets[FW_HISTOGRAM_BUCKETS];
+    guint64 count;
+    gint64 sum;
+    gint64 min;
+    gint64 max;
+} FWHistogramPrivate;
+
+/**
+ * fw_histogram_new:
+ *
+ * Returns: (transfer full) (type FWHistogram*)
+ */
+FWHistogram *
+fw_histogram_new(void)
+{
+    return g_object_new(FW_HISTOGRAM_TYPE, NULL);
+}
+
+static void
+fw_histogram_init(FWHistogram *obj)
+{
+    fw_histogram_reset(obj);
+}
+
+static void
+fw_histogram_class_init(FWHistogramClass *fw_histogram_class)
+{
+    GObjectClass *obj_class = G_OBJECT_CLASS(fw_histogram_class);
+
+    g_type_class_add_private(obj_class, sizeof(FWHistogramPrivate));
+    fw_accounting_register(obj_class, sizeof(FWHistogramPrivate));
+}
+
+/* methods */
+
+void
+fw_histogram_add(FWHistogram *obj,
+		 gint64 value)
+{
+    FWHistogramPrivate *priv = FW_HISTOGRAM_GET_PRIVATE(obj);
+    guint i;
+
+    value = MAX(value, 0);
+    i = (value > 0) ? g_bit_storage((gulong) value) : 0;
+    priv->buckets[MIN(i, FW_HISTOGRAM_BUCKETS - 1)]++;
+
+    if (priv->count == 0 || value < priv->min)
+	priv->min = value;
+    if (priv->count == 0 || value > priv->max)
+	priv->max = value;
+    priv->count++;
+    priv->sum += value;
+}
+
+void
+fw_histogram_reset(FWHistogram *obj)
+{
+    FWHistogramPrivate *priv = FW_HISTOGRAM_GET_PRIVATE(obj);
+    guint i;
+
+    for (i = 0; i < FW_HISTOGRAM_BUCKETS; i++)
+	priv->buckets[i] = 0;
+    priv->count = 0;
+    priv->sum = 0;
+    priv->min = 0;
+    priv->max = 0;
+}
+
+/**
+ * fw_histogram_merge:
+ * @obj: (type FWHistogram*): a FWHistogram instance
+ * @other: (type FWHistogram*): histogram to add to obj
+ */
+void
+fw_histogram_merge(FWHistogram *obj,
+		   FWHistogram *other)
+{
+    FWHistogramPrivate *priv = FW_HISTOGRAM_GET_PRIVATE(obj);
+    FWHistogramPrivate *other_priv = FW_HISTOGRAM_GET_PRIVATE(other);
+    guint i;
+
+    if (other_priv->count == 0)
+	return;
+
+    for (i = 0; i < FW_HISTOGRAM_BUCKETS; i++)
+	priv->buckets[i] += other_priv->buckets[i];
+
+    if (priv->count == 0 || other_priv->min < priv->min)
+	priv->min = other_priv->min;
+    if (priv->count == 0 || other_priv->max > priv->max)
+	priv->max = other_priv->max;
+    priv->count += other_priv->count;
+    priv->sum += other_priv->sum;
+}
+
+guint64
+fw_histogram_getCount(FWHistogram *obj)
+{
+    FWHistogramPrivate *priv = FW_HISTOGRAM_GET_PRIVATE(obj);
+
+    return priv->count;
+}
+
+gint64
+fw_histogram_getSum(FWHistogram *obj)
+{
+    FWHistogramPrivate *priv = FW_HISTOGRAM_GET_PRIVATE(obj);
+
+    return priv->sum;
+}
+
+gint64
+fw_histogram_getMin(FWHistogram *obj)
+{
+    FWHistogramPrivate *priv = FW_HISTOGRAM_GET_PRIVATE(obj);
+
+    return priv->min;
+}
+
+gint64
+fw_histogram_getMax(FWHistogram *obj)
+{
+    FWHistogramPrivate *priv = FW_HISTOGRAM_GET_PRIVATE(obj);
+
+    return priv->max;
+}
+
+/**
+ * fw_histogram_getPercentile:
+ * @percentile: 0 to 100
+ *
+ * Returns: upper limit of the bucket holding the percentile, capped by
+ * the largest value
+ */
+gint64
+fw_histogram_getPercentile(FWHistogram *obj,
+			   gdouble percentile)
+{
+    FWHistogramPrivate *priv = FW_HISTOGRAM_GET_PRIVATE(obj);
+    guint64 rank, seen = 0;
+    guint i;
+
+    if (priv->count == 0)
+	return 0;
+
+    rank = (guint64) (CLAMP(percentile, 0, 100) / 100.0 * priv->count);
+    rank = CLAMP(rank, 1, priv->count);
+    for (i = 0; i < FW_HISTOGRAM_BUCKETS; i++) {
+	seen += priv->buckets[i];
+	if (seen >= rank)
+	    break;
+    }
+
+    return MIN(fw_histogram_getBucketLimit(obj, i), priv->max);
+}
+
+guint64
+fw_histogram_getBucketCount(FWHistogram *obj,
+			    guint index)
+{
+    FWHistogramPrivate *priv = FW_HISTOGRAM_GET_PRIVATE(obj);
+
+    if (index >= FW_HISTOGRAM_BUCKETS)
+	return 0;
+
+    return priv->buckets[index];
+}
+
+/**
+ * fw_histogram_getBucketLimit:
+ * @index: bucket index
+ *
+ * Returns: largest value counted in the bucket
+ */
+gint64
+fw_histogram_getBucketLimit(FWHistogram *obj,
+			    guint index)
+{
+    if (index >= FW_HISTOGRAM_BUCKETS - 1)
+	return G_MAXINT64;
+
+    return ((gint64) 1 << index) - 1;
+}
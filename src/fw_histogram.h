@@ -0,0 +1,61 @@
+/*
+ * Copyright (C) 2017 Red Hat, Inc.
+ *
+ * Authors:
+ * Thomas Woerner <twoerner@redhat.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __FW_HISTOGRAM_H__
+#define __FW_HISTOGRAM_H__
+
+#include <glib.h>
+#include <glib-object.h>
+#include "firewall.h"
+
+#define FW_HISTOGRAM_TYPE            (fw_histogram_get_type())
+#define FW_HISTOGRAM(obj)            (G_TYPE_CHECK_INSTANCE_CAST((obj), FW_HISTOGRAM_TYPE, FWHistogram))
+#define FW_HISTOGRAM_CLASS(klass)    (G_TYPE_CHECK_CLASS_CAST((klass), FW_HISTOGRAM_TYPE, FWHistogramClass))
+#define FW_IS_HISTOGRAM(klass)       (G_TYPE_CHECK_INSTANCE_CLASS((klass), FW_HISTOGRAM_TYPE, FWHistogramClass))
+#define FW_HISTOGRAM_GET_CLASS(obj)  (G_TYPE_INSTANCE_GET_CLASS((obj), FW_HISTOGRAM_TYPE, FWHistogramClass))
+
+/* bucket i counts values below 2^i, the last one all others */
+#define FW_HISTOGRAM_BUCKETS  40
+
+typedef struct {
+    GObject parent;
+} FWHistogram;
+
+typedef struct {
+    GObjectClass parent;
+} FWHistogramClass;
+
+GType fw_histogram_get_type(void);
+FWHistogram *fw_histogram_new(void);
+
+void fw_histogram_add(FWHistogram *obj, gint64 value);
+void fw_histogram_reset(FWHistogram *obj);
+void fw_histogram_merge(FWHistogram *obj, FWHistogram *other);
+
+guint64 fw_histogram_getCount(FWHistogram *obj);
+gint64 fw_histogram_getSum(FWHistogram *obj);
+gint64 fw_histogram_getMin(FWHistogram *obj);
+gint64 fw_histogram_getMax(FWHistogram *obj);
+gint64 fw_histogram_getPercentile(FWHistogram *obj, gdouble percentile);
+
+guint64 fw_histogram_getBucketCount(FWHistogram *obj, guint index);
+gint64 fw_histogram_getBucketLimit(FWHistogram *obj, guint index);
+
+#endif /* __FW_HISTOGRAM_H__ */
@@ -0,0 +1,461 @@
+/*
+ * Copyright (C) 2017 Red Hat, Inc.
+ *
+ * Authors:
+ * Thomas Woerner <twoerner@redhat.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Catalogue of icmptypes with dense ids, sets of icmptypes are bitsets of
+ * these ids. The destinations of the icmptypes give a mask per family, an
+ * icmptype without destinations applies to both families like in
+ * firewalld. Ids are stable for the lifetime of the catalogue, bitsets of
+ * different catalogues can not be compared.
+ */
+
+#include <string.h>
+#include "fw_icmp_catalogue.h"
+#include "fw_accounting.h"
+
+G_DEFINE_TYPE(FWIcmpCatalogue, fw_icmp_catalogue, G_TYPE_OBJECT);
+
+#define FW_ICMP_CATALOGUE_GET_PRIVATE(o) (G_TYPE_INSTANCE_GET_PRIVATE((o), FW_ICMP_CATALOGUE_TYPE, FWIcmpCataloguePrivate))
+
+typedef struct {
+    GHashTable *ids;		/* name -> id + 1 */
+    GPtrArray *names;		/* id -> name */
+    FWIcmpBitset all;
+    FWIcmpBitset families[FW_ICMP_N_FAMILIES];
+} FWIcmpCataloguePrivate;
+
+static const gchar *_fw_icmp_catalogue_destinations[FW_ICMP_N_FAMILIES] = {
+    "ipv4", "ipv6",
+};
+
+/* bitsets */
+
+void
+fw_icmp_bitset_clear(FWIcmpBitset *set)
+{
+    memset(set, 0, sizeof(FWIcmpBitset));
+}
+
+void
+fw_icmp_bitset_add(FWIcmpBitset *set,
+		   guint id)
+{
+    g_return_if_fail(id < FW_ICMP_CATALOGUE_MAX);
+
+    set->words[id / 64] |= G_GUINT64_CONSTANT(1) << (id % 64);
+}
+
+void
+fw_icmp_bitset_remove(FWIcmpBitset *set,
+		      guint id)
+{
+    g_return_if_fail(id < FW_ICMP_CATALOGUE_MAX);
+
+    set->words[id / 64] &= ~(G_GUINT64_CONSTANT(1) << (id % 64));
+}
+
+gboolean
+fw_icmp_bitset_contains(const FWIcmpBitset *set,
+			guint id)
+{
+    if (id >= FW_ICMP_CATALOGUE_MAX)
+	return FALSE;
+
+    return (set->words[id / 64] >> (id % 64)) & 1;
+}
+
+gboolean
+fw_icmp_bitset_equal(const FWIcmpBitset *a,
+		     const FWIcmpBitset *b)
+{
+    guint i;
+
+    for (i = 0; i < FW_ICMP_BITSET_WORDS; i++) {
+	if (a->words[i] != b->words[i])
+	    return FALSE;
+    }
+
+    return TRUE;
+}
+
+gboolean
+fw_icmp_bitset_isEmpty(const FWIcmpBitset *set)
+{
+    guint i;
+
+    for (i = 0; i < FW_ICMP_BITSET_WORDS; i++) {
+	if (set->words[i] != 0)
+	    return FALSE;
+    }
+
+    return TRUE;
+}
+
+guint
+fw_icmp_bitset_count(const FWIcmpBitset *set)
+{
+    guint i, n = 0;
+
+    for (i = 0; i < FW_ICMP_BITSET_WORDS; i++) {
+	guint64 word = set->words[i];
+
+	for (; word != 0; word &= word - 1)
+	    n++;
+    }
+
+    return n;
+}
+
+/* result may be one of the operands */
+
+void
+fw_icmp_bitset_and(FWIcmpBitset *result,
+		   const FWIcmpBitset *a,
+		   const FWIcmpBitset *b)
+{
+    guint i;
+
+    for (i = 0; i < FW_ICMP_BITSET_WORDS; i++)
+	result->words[i] = a->words[i] & b->words[i];
+}
+
+void
+fw_icmp_bitset_or(FWIcmpBitset *result,
+		  const FWIcmpBitset *a,
+		  const FWIcmpBitset *b)
+{
+    guint i;
+
+    for (i = 0; i < FW_ICMP_BITSET_WORDS; i++)
+	result->words[i] = a->words[i] | b->words[i];
+}
+
+void
+fw_icmp_bitset_xor(FWIcmpBitset *result,
+		   const FWIcmpBitset *a,
+		   const FWIcmpBitset *b)
+{
+    guint i;
+
+    for (i = 0; i < FW_ICMP_BITSET_WORDS; i++)
+	result->words[i] = a->words[i] ^ b->words[i];
+}
+
+void
+fw_icmp_bitset_andNot(FWIcmpBitset *result,
+		      const FWIcmpBitset *a,
+		      const FWIcmpBitset *b)
+{
+    guint i;
+
+    for (i = 0; i < FW_ICMP_BITSET_WORDS; i++)
+	result->words[i] = a->words[i] & ~b->words[i];
+}
+
+/* catalogue */
+
+/**
+ * fw_icmp_catalogue_new:
+ *
+ * Returns: (transfer full) (type FWIcmpCatalogue*)
+ */
+FWIcmpCatalogue *
+fw_icmp_catalogue_new(void)
+{
+    return g_object_new(FW_ICMP_CATALOGUE_TYPE, NULL);
+}
+
+static void
+fw_icmp_catalogue_init(FWIcmpCatalogue *obj)
+{
+    FWIcmpCataloguePrivate *priv = FW_ICMP_CATALOGUE_GET_PRIVATE(obj);
+    guint i;
+
+    /* init vars */
+    priv->ids = g_hash_table_new(g_str_hash, g_str_equal);
+    priv->names = g_ptr_array_new_with_free_func(g_free);
+    fw_icmp_bitset_clear(&priv->all);
+    for (i = 0; i < FW_ICMP_N_FAMILIES; i++)
+	fw_icmp_bitset_clear(&priv->families[i]);
+}
+
+static void
+fw_icmp_catalogue_finalize(GObject *obj)
+{
+    FWIcmpCataloguePrivate *priv = FW_ICMP_CATALOGUE_GET_PRIVATE(obj);
+
+    g_hash_table_destroy(priv->ids);
+    g_ptr_array_unref(priv->names);
+
+    G_OBJECT_CLASS(fw_icmp_catalogue_parent_class)->finalize(obj);
+}
+
+static void
+fw_icmp_catalogue_class_init(FWIcmpCatalogueClass *fw_icmp_catalogue_class)
+{
+    GObjectClass *obj_class = G_OBJECT_CLASS(fw_icmp_catalogue_class);
+
+    obj_class->finalize = fw_icmp_catalogue_finalize;
+
+    g_type_class_add_private(obj_class, sizeof(FWIcmpCataloguePrivate));
+    fw_accounting_register(obj_class, sizeof(FWIcmpCataloguePrivate));
+}
+
+/* methods */
+
+/**
+ * fw_icmp_catalogue_intern:
+ * @obj: (type FWIcmpCatalogue*): a FWIcmpCatalogue instance
+ * @name: (type utf8): icmptype name
+ * @destinations: (type GList*) (element-type utf8) (allow-none): "ipv4"
+ *   and/or "ipv6", none for both
+ *
+ * Adds the icmptype or updates its destinations.
+ *
+ * Returns: id of the icmptype, FW_ICMP_CATALOGUE_INVALID if the
+ * catalogue is full
+ */
+guint
+fw_icmp_catalogue_intern(FWIcmpCatalogue *obj,
+			 const gchar *name,
+			 GList *destinations)
+{
+    FWIcmpCataloguePrivate *priv = FW_ICMP_CATALOGUE_GET_PRIVATE(obj);
+    guint id, i;
+
+    id = fw_icmp_catalogue_lookup(obj, name);
+    if (id == FW_ICMP_CATALOGUE_INVALID) {
+	if (priv->names->len >= FW_ICMP_CATALOGUE_MAX) {
+	    g_print(_("ERROR: too many icmptypes, ignoring '%s'\n"), name);
+	    return FW_ICMP_CATALOGUE_INVALID;
+	}
+	id = priv->names->len;
+	g_ptr_array_add(priv->names, g_strdup(name));
+	g_hash_table_insert(priv->ids, g_ptr_array_index(priv->names, id),
+			    GUINT_TO_POINTER(id + 1));
+	fw_icmp_bitset_add(&priv->all, id);
+    }
+
+    for (i = 0; i < FW_ICMP_N_FAMILIES; i++) {
+	if (destinations == NULL ||
+	    fw_str_list_contains(destinations,
+				 _fw_icmp_catalogue_destinations[i]))
+	    fw_icmp_bitset_add(&priv->families[i], id);
+	else
+	    fw_icmp_bitset_remove(&priv->families[i], id);
+    }
+
+    return id;
+}
+
+/**
+ * fw_icmp_catalogue_addIcmpType:
+ * @obj: (type FWIcmpCatalogue*): a FWIcmpCatalogue instance
+ * @name: (type utf8): icmptype name
+ * @icmptype: (type FWIcmpType*): settings of the icmptype
+ *
+ * Returns: id of the icmptype, FW_ICMP_CATALOGUE_INVALID if the
+ * catalogue is full
+ */
+guint
+fw_icmp_catalogue_addIcmpType(FWIcmpCatalogue *obj,
+			      const gchar *name,
+			      FWIcmpType *icmptype)
+{
+    return fw_icmp_catalogue_intern(obj, name,
+				    fw_icmptype_getDestinations(icmptype));
+}
+
+/**
+ * fw_icmp_catalogue_lookup:
+ *
+ * Returns: id of the icmptype, FW_ICMP_CATALOGUE_INVALID if unknown
+ */
+guint
+fw_icmp_catalogue_lookup(FWIcmpCatalogue *obj,
+			 const gchar *name)
+{
+    FWIcmpCataloguePrivate *priv = FW_ICMP_CATALOGUE_GET_PRIVATE(obj);
+    guint id = GPOINTER_TO_UINT(g_hash_table_lookup(priv->ids, name));
+
+    return (id == 0) ? FW_ICMP_CATALOGUE_INVALID : id - 1;
+}
+
+/**
+ * fw_icmp_catalogue_getName:
+ *
+ * Returns: (transfer none) (allow-none): name of the icmptype
+ */
+const gchar *
+fw_icmp_catalogue_getName(FWIcmpCatalogue *obj,
+			  guint id)
+{
+    FWIcmpCataloguePrivate *priv = FW_ICMP_CATALOGUE_GET_PRIVATE(obj);
+
+    if (id >= priv->names->len)
+	return NULL;
+
+    return g_ptr_array_index(priv->names, id);
+}
+
+guint
+fw_icmp_catalogue_length(FWIcmpCatalogue *obj)
+{
+    FWIcmpCataloguePrivate *priv = FW_ICMP_CATALOGUE_GET_PRIVATE(obj);
+
+    return priv->names->len;
+}
+
+/**
+ * fw_icmp_catalogue_getFamilyMask:
+ *
+ * Returns: (transfer none): icmptypes that apply to the family
+ */
+const FWIcmpBitset *
+fw_icmp_catalogue_getFamilyMask(FWIcmpCatalogue *obj,
+				FWIcmpFamily family)
+{
+    FWIcmpCataloguePrivate *priv = FW_ICMP_CATALOGUE_GET_PRIVATE(obj);
+
+    g_return_val_if_fail(family < FW_ICMP_N_FAMILIES, NULL);
+
+    return &priv->families[family];
+}
+
+/**
+ * fw_icmp_catalogue_fromList:
+ * @obj: (type FWIcmpCatalogue*): a FWIcmpCatalogue instance
+ * @names: (type GList*) (element-type utf8): icmptype names
+ * @set: (out caller-allocates): bitset of the names
+ *
+ * Returns: FALSE if names are not in the catalogue, they are left out
+ */
+gboolean
+fw_icmp_catalogue_fromList(FWIcmpCatalogue *obj,
+			   GList *names,
+			   FWIcmpBitset *set)
+{
+    gboolean ret = TRUE;
+    GList *list;
+
+    fw_icmp_bitset_clear(set);
+    for (list = names; list != NULL; list = list->next) {
+	guint id = fw_icmp_catalogue_lookup(obj, list->data);
+
+	if (id == FW_ICMP_CATALOGUE_INVALID) {
+#ifdef FW_DEBUG
+	    g_printerr("fw_icmp_catalogue_fromList(): unknown '%s'\n",
+		       (gchar *) list->data);
+#endif
+	    ret = FALSE;
+	    continue;
+	}
+	fw_icmp_bitset_add(set, id);
+    }
+
+    return ret;
+}
+
+/**
+ * fw_icmp_catalogue_fromZone:
+ * @obj: (type FWIcmpCatalogue*): a FWIcmpCatalogue instance
+ * @zone: (type FWZone*): zone settings
+ * @blocks: (out caller-allocates): icmp blocks of the zone
+ *
+ * Returns: FALSE if icmp blocks are not in the catalogue
+ */
+gboolean
+fw_icmp_catalogue_fromZone(FWIcmpCatalogue *obj,
+			   FWZone *zone,
+			   FWIcmpBitset *blocks)
+{
+    return fw_icmp_catalogue_fromList(obj, fw_zone_getIcmpBlocks(zone),
+				      blocks);
+}
+
+/**
+ * fw_icmp_catalogue_toList:
+ *
+ * Returns: (type GList*) (transfer container) (element-type utf8): names
+ * in id order
+ */
+GList *
+fw_icmp_catalogue_toList(FWIcmpCatalogue *obj,
+			 const FWIcmpBitset *set)
+{
+    FWIcmpCataloguePrivate *priv = FW_ICMP_CATALOGUE_GET_PRIVATE(obj);
+    GList *list = NULL;
+    guint id;
+
+    for (id = priv->names->len; id > 0; id--) {
+	if (fw_icmp_bitset_contains(set, id - 1))
+	    list = g_list_prepend(list, g_ptr_array_index(priv->names, id - 1));
+    }
+
+    return list;
+}
+
+/**
+ * fw_icmp_catalogue_getBlocked:
+ * @obj: (type FWIcmpCatalogue*): a FWIcmpCatalogue instance
+ * @blocks: icmp blocks of a zone
+ * @inversion: icmp block inversion of the zone
+ * @family: address family
+ * @blocked: (out caller-allocates): icmptypes that are blocked
+ *
+ * Blocks only have an effect for the families of the icmptype. With
+ * inversion the blocks are accepted and all other icmptypes are blocked.
+ */
+void
+fw_icmp_catalogue_getBlocked(FWIcmpCatalogue *obj,
+			     const FWIcmpBitset *blocks,
+			     gboolean inversion,
+			     FWIcmpFamily family,
+			     FWIcmpBitset *blocked)
+{
+    FWIcmpCataloguePrivate *priv = FW_ICMP_CATALOGUE_GET_PRIVATE(obj);
+
+    g_return_if_fail(family < FW_ICMP_N_FAMILIES);
+
+    fw_icmp_bitset_and(blocked, blocks, &priv->families[family]);
+    if (inversion)
+	fw_icmp_bitset_andNot(blocked, &priv->all, blocked);
+}
+
+gboolean
+fw_icmp_catalogue_isBlocked(FWIcmpCatalogue *obj,
+			    const FWIcmpBitset *blocks,
+			    gboolean inversion,
+			    FWIcmpFamily family,
+			    guint id)
+{
+    FWIcmpCataloguePrivate *priv = FW_ICMP_CATALOGUE_GET_PRIVATE(obj);
+    gboolean effective;
+
+    g_return_val_if_fail(family < FW_ICMP_N_FAMILIES, FALSE);
+
+    if (id >= priv->names->len)
+	return FALSE;
+
+    effective = fw_icmp_bitset_contains(blocks, id) &&
+	fw_icmp_bitset_contains(&priv->families[family], id);
+
+    return inversion ? !effective : effective;
+}
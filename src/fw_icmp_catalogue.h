@@ -0,0 +1,89 @@
+/*
+ * Copyright (C) 2017 Red Hat, Inc.
+ *
+ * Authors:
+ * Thomas Woerner <twoerner@redhat.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __FW_ICMP_CATALOGUE_H__
+#define __FW_ICMP_CATALOGUE_H__
+
+#include <glib.h>
+#include <glib-object.h>
+#include "firewall.h"
+#include "fw_icmptype.h"
+#include "fw_zone.h"
+
+#define FW_ICMP_CATALOGUE_TYPE            (fw_icmp_catalogue_get_type())
+#define FW_ICMP_CATALOGUE(obj)            (G_TYPE_CHECK_INSTANCE_CAST((obj), FW_ICMP_CATALOGUE_TYPE, FWIcmpCatalogue))
+#define FW_ICMP_CATALOGUE_CLASS(klass)    (G_TYPE_CHECK_CLASS_CAST((klass), FW_ICMP_CATALOGUE_TYPE, FWIcmpCatalogueClass))
+#define FW_IS_ICMP_CATALOGUE(klass)       (G_TYPE_CHECK_INSTANCE_CLASS((klass), FW_ICMP_CATALOGUE_TYPE, FWIcmpCatalogueClass))
+#define FW_ICMP_CATALOGUE_GET_CLASS(obj)  (G_TYPE_INSTANCE_GET_CLASS((obj), FW_ICMP_CATALOGUE_TYPE, FWIcmpCatalogueClass))
+
+/* 256 icmptypes, firewalld ships less than 50 */
+#define FW_ICMP_BITSET_WORDS       4
+#define FW_ICMP_CATALOGUE_MAX      (FW_ICMP_BITSET_WORDS * 64)
+#define FW_ICMP_CATALOGUE_INVALID  G_MAXUINT
+
+typedef enum {
+    FW_ICMP_FAMILY_IPV4,
+    FW_ICMP_FAMILY_IPV6,
+    FW_ICMP_N_FAMILIES,
+} FWIcmpFamily;
+
+/* set of icmptype ids of a catalogue */
+typedef struct {
+    guint64 words[FW_ICMP_BITSET_WORDS];
+} FWIcmpBitset;
+
+typedef struct {
+    GObject parent;
+} FWIcmpCatalogue;
+
+typedef struct {
+    GObjectClass parent;
+} FWIcmpCatalogueClass;
+
+void fw_icmp_bitset_clear(FWIcmpBitset *set);
+void fw_icmp_bitset_add(FWIcmpBitset *set, guint id);
+void fw_icmp_bitset_remove(FWIcmpBitset *set, guint id);
+gboolean fw_icmp_bitset_contains(const FWIcmpBitset *set, guint id);
+gboolean fw_icmp_bitset_equal(const FWIcmpBitset *a, const FWIcmpBitset *b);
+gboolean fw_icmp_bitset_isEmpty(const FWIcmpBitset *set);
+guint fw_icmp_bitset_count(const FWIcmpBitset *set);
+void fw_icmp_bitset_and(FWIcmpBitset *result, const FWIcmpBitset *a, const FWIcmpBitset *b);
+void fw_icmp_bitset_or(FWIcmpBitset *result, const FWIcmpBitset *a, const FWIcmpBitset *b);
+void fw_icmp_bitset_xor(FWIcmpBitset *result, const FWIcmpBitset *a, const FWIcmpBitset *b);
+void fw_icmp_bitset_andNot(FWIcmpBitset *result, const FWIcmpBitset *a, const FWIcmpBitset *b);
+
+GType fw_icmp_catalogue_get_type(void);
+FWIcmpCatalogue *fw_icmp_catalogue_new(void);
+
+guint fw_icmp_catalogue_intern(FWIcmpCatalogue *obj, const gchar *name, GList *destinations);
+guint fw_icmp_catalogue_addIcmpType(FWIcmpCatalogue *obj, const gchar *name, FWIcmpType *icmptype);
+guint fw_icmp_catalogue_lookup(FWIcmpCatalogue *obj, const gchar *name);
+const gchar *fw_icmp_catalogue_getName(FWIcmpCatalogue *obj, guint id);
+guint fw_icmp_catalogue_length(FWIcmpCatalogue *obj);
+const FWIcmpBitset *fw_icmp_catalogue_getFamilyMask(FWIcmpCatalogue *obj, FWIcmpFamily family);
+
+gboolean fw_icmp_catalogue_fromList(FWIcmpCatalogue *obj, GList *names, FWIcmpBitset *set);
+gboolean fw_icmp_catalogue_fromZone(FWIcmpCatalogue *obj, FWZone *zone, FWIcmpBitset *blocks);
+GList *fw_icmp_catalogue_toList(FWIcmpCatalogue *obj, const FWIcmpBitset *set);
+
+void fw_icmp_catalogue_getBlocked(FWIcmpCatalogue *obj, const FWIcmpBitset *blocks, gboolean inversion, FWIcmpFamily family, FWIcmpBitset *blocked);
+gboolean fw_icmp_catalogue_isBlocked(FWIcmpCatalogue *obj, const FWIcmpBitset *blocks, gboolean inversion, FWIcmpFamily family, guint id);
+
+#endif /* __FW_ICMP_CATALOGUE_H__ */
@@ -19,6 +19,8 @@
  */
 
 #include "fw_icmptype.h"
+#include "fw_trace.h"
+#include "fw_accounting.h"
 #include <string.h>
 
 G_DEFINE_TYPE(FWIcmpType, fw_icmptype, G_TYPE_OBJECT);
@@ -30,6 +32,8 @@ typedef struct {
     gchar *short_description;  /* string */
     gchar *description;        /* string */
     GList *destinations;       /* list of strings */
+    FWFingerprint fingerprint;  /* cached structural hash */
+    gboolean fingerprint_valid;
 } FWIcmpTypePrivate;
 
 FWIcmpType *
@@ -44,6 +48,7 @@ fw_icmptype_new_from_variant(GVariant *variant)
     FWIcmpType *obj = NULL;
     GVariant *item;
     gchar *str;
+    GList *strs;
 
     if (variant == NULL)
 	return NULL;
@@ -51,34 +56,42 @@ fw_icmptype_new_from_variant(GVariant *variant)
     if (strncmp(g_variant_get_type_string(variant), "((sssas))", 9) != 0) {
 	if (strncmp(g_variant_get_type_string(variant), "(sssas)", 7) != 0)
 	    return NULL;
+	g_variant_ref(variant);
     } else
 	variant = g_variant_get_child_value(variant, 0);
 
+    FW_TRACE_DECODE_START(variant);
+
     obj = fw_icmptype_new();
 
     /* 0: version */
     item = g_variant_get_child_value(variant, 0);
-    g_variant_get(item, "s", &str);
+    g_variant_get(item, "&s", &str);
     fw_icmptype_setVersion(obj, str);
     g_variant_unref(item);
 
     /* 1: short */
     item = g_variant_get_child_value(variant, 1);
-    g_variant_get(item, "s", &str);
+    g_variant_get(item, "&s", &str);
     fw_icmptype_setShort(obj, str);
     g_variant_unref(item);
 
     /* 2: description */
     item = g_variant_get_child_value(variant, 2);
-    g_variant_get(item, "s", &str);
+    g_variant_get(item, "&s", &str);
     fw_icmptype_setDescription(obj, str);
     g_variant_unref(item);
 
     /* 3: destinations */
     item = g_variant_get_child_value(variant, 3);
-    fw_icmptype_setDestinations(obj, fw_str_list_new_from_variant(item));
+    strs = fw_str_list_new_from_variant(item);
+    fw_icmptype_setDestinations(obj, strs);
+    fw_str_list_free(strs);
     g_variant_unref(item);
 
+    g_variant_unref(variant);
+
+    FW_TRACE_DECODE_DONE();
     return obj;
 }
 
@@ -110,6 +123,7 @@ fw_icmptype_init(FWIcmpType *obj)
     priv->short_description = g_strdup("");
     priv->description = g_strdup("");
     priv->destinations = NULL;
+    priv->fingerprint_valid = FALSE;
 }
 
 static void
@@ -137,6 +151,7 @@ fw_icmptype_class_init(FWIcmpTypeClass *fw_icmptype_class)
     obj_class->finalize = fw_icmptype_finalize;
 
     g_type_class_add_private(obj_class, sizeof(FWIcmpTypePrivate));
+    fw_accounting_register(obj_class, sizeof(FWIcmpTypePrivate));
 }
 
 /* methods */
@@ -180,6 +195,7 @@ fw_icmptype_setVersion(FWIcmpType *obj,
     if (priv->version != NULL)
 	g_free(priv->version);
     priv->version = g_strdup(version);
+    priv->fingerprint_valid = FALSE;
 }
 
 /**
@@ -204,6 +220,7 @@ fw_icmptype_setShort(FWIcmpType *obj,
     if (priv->short_description != NULL)
 	g_free(priv->short_description);
     priv->short_description = g_strdup(short_description);
+    priv->fingerprint_valid = FALSE;
 }
 
 /**
@@ -228,6 +245,7 @@ fw_icmptype_setDescription(FWIcmpType *obj,
     if (priv->description != NULL)
 	g_free(priv->description);
     priv->description = g_strdup(description);
+    priv->fingerprint_valid = FALSE;
 }
 
 /**
@@ -258,6 +276,7 @@ fw_icmptype_setDestinations(FWIcmpType *obj,
     if (priv->destinations != NULL)
 	fw_str_list_free(priv->destinations);
     priv->destinations = fw_str_list_copy(destinations);
+    priv->fingerprint_valid = FALSE;
 }
 
 void
@@ -267,6 +286,7 @@ fw_icmptype_addDestination(FWIcmpType *obj,
     FWIcmpTypePrivate *priv = FW_ICMPTYPE_GET_PRIVATE(obj);
 
     priv->destinations = fw_str_list_append(priv->destinations, destination);
+    priv->fingerprint_valid = FALSE;
 }
 
 void
@@ -276,6 +296,7 @@ fw_icmptype_removeDestination(FWIcmpType *obj,
     FWIcmpTypePrivate *priv = FW_ICMPTYPE_GET_PRIVATE(obj);
 
     priv->destinations = fw_str_list_remove(priv->destinations, destination);
+    priv->fingerprint_valid = FALSE;
 }
 
 gboolean
@@ -286,3 +307,54 @@ fw_icmptype_queryDestination(FWIcmpType *obj,
 
     return fw_str_list_contains(priv->destinations, destination);
 }
+
+/* fingerprint */
+
+/**
+ * fw_icmptype_getFingerprint:
+ * @obj: (type FWIcmpType*): a FWIcmpType instance
+ *
+ * Order insensitive structural hash of the settings, cached until the
+ * next change through the FWIcmpType methods.
+ *
+ * Returns: (transfer none): fingerprint of the settings
+ */
+const FWFingerprint *
+fw_icmptype_getFingerprint(FWIcmpType *obj)
+{
+    FWIcmpTypePrivate *priv = FW_ICMPTYPE_GET_PRIVATE(obj);
+    GVariant *variant;
+
+    if (!priv->fingerprint_valid) {
+	variant = g_variant_ref_sink(fw_icmptype_to_variant(obj));
+	fw_fingerprint_variant(variant, &priv->fingerprint);
+	g_variant_unref(variant);
+	priv->fingerprint_valid = TRUE;
+    }
+
+    return &priv->fingerprint;
+}
+
+/**
+ * fw_icmptype_equal:
+ * @a: (type FWIcmpType*): a FWIcmpType instance
+ * @b: (type FWIcmpType*): a FWIcmpType instance
+ *
+ * Returns: TRUE if the settings are equal up to the order of list items
+ */
+gboolean
+fw_icmptype_equal(FWIcmpType *a,
+		  FWIcmpType *b)
+{
+    if (a == b)
+	return TRUE;
+
+    return fw_fingerprint_equal(fw_icmptype_getFingerprint(a),
+				fw_icmptype_getFingerprint(b));
+}
+
+guint
+fw_icmptype_hash(FWIcmpType *obj)
+{
+    return fw_fingerprint_hash(fw_icmptype_getFingerprint(obj));
+}
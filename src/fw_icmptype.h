@@ -24,6 +24,7 @@
 #include <glib.h>
 #include <glib-object.h>
 #include "firewall.h"
+#include "fw_fingerprint.h"
 #include "fw_functions.h"
 #include "fw_port.h"
 
@@ -63,4 +64,8 @@ void fw_icmptype_addDestination(FWIcmpType *obj, gchar *destination);
 void fw_icmptype_removeDestination(FWIcmpType *obj, gchar *destination);
 gboolean fw_icmptype_queryDestination(FWIcmpType *obj, gchar *destination);
 
+const FWFingerprint *fw_icmptype_getFingerprint(FWIcmpType *obj);
+gboolean fw_icmptype_equal(FWIcmpType *a, FWIcmpType *b);
+guint fw_icmptype_hash(FWIcmpType *obj);
+
 #endif /* __FW_ICMPTYPE_H__ */
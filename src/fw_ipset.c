@@ -19,6 +19,8 @@
  */
 
 #include "fw_ipset.h"
+#include "fw_trace.h"
+#include "fw_accounting.h"
 #include <string.h>
 
 G_DEFINE_TYPE(FWIPSet, fw_ipset, G_TYPE_OBJECT);
@@ -32,6 +34,8 @@ typedef struct {
     gchar *type;               /* string */
     GHashTable *options;       /* hash table of string: string */
     GList *entries;            /* list of string */
+    FWFingerprint fingerprint;  /* cached structural hash */
+    gboolean fingerprint_valid;
 } FWIPSetPrivate;
 
 FWIPSet *
@@ -47,6 +51,7 @@ fw_ipset_new_from_variant(GVariant *variant)
     GVariant *item;
     GVariantIter iter;
     gchar *str;
+    GList *strs;
 
     if (variant == NULL)
 	return NULL;
@@ -55,31 +60,33 @@ fw_ipset_new_from_variant(GVariant *variant)
 		"((ssssa{ss}as))", 11) != 0)
 	return NULL;
 
+    FW_TRACE_DECODE_START(variant);
+
     variant = g_variant_get_child_value(variant, 0);
 
     obj = fw_ipset_new();
 
     /* 0: version */
     item = g_variant_get_child_value(variant, 0);
-    g_variant_get(item, "s", &str);
+    g_variant_get(item, "&s", &str);
     fw_ipset_setVersion(obj, str);
     g_variant_unref(item);
 
     /* 1: short */
     item = g_variant_get_child_value(variant, 1);
-    g_variant_get(item, "s", &str);
+    g_variant_get(item, "&s", &str);
     fw_ipset_setShort(obj, str);
     g_variant_unref(item);
 
     /* 2: description */
     item = g_variant_get_child_value(variant, 2);
-    g_variant_get(item, "s", &str);
+    g_variant_get(item, "&s", &str);
     fw_ipset_setDescription(obj, str);
     g_variant_unref(item);
 
     /* 3: type */
     item = g_variant_get_child_value(variant, 3);
-    g_variant_get(item, "s", &str);
+    g_variant_get(item, "&s", &str);
     fw_ipset_setType(obj, str);
     g_variant_unref(item);
 
@@ -100,7 +107,7 @@ fw_ipset_new_from_variant(GVariant *variant)
            g_variant_get(item2, "s", &value);
            g_variant_unref(item2);
 
-           fw_ipset_setOption(obj, g_strdup(key), g_strdup(value));
+           fw_ipset_setOption(obj, key, value);
            g_variant_unref(element);
        }
     }
@@ -109,9 +116,14 @@ fw_ipset_new_from_variant(GVariant *variant)
 
     /* 5: entries */
     item = g_variant_get_child_value(variant, 5);
-    fw_ipset_setEntries(obj, fw_str_list_new_from_variant(item));
+    strs = fw_str_list_new_from_variant(item);
+    fw_ipset_setEntries(obj, strs);
+    fw_str_list_free(strs);
     g_variant_unref(item);
 
+    g_variant_unref(variant);
+
+    FW_TRACE_DECODE_DONE();
     return obj;
 }
 
@@ -159,6 +171,7 @@ fw_ipset_init(FWIPSet *obj)
     priv->type = g_strdup("");
     priv->options = g_hash_table_new(g_str_hash, g_str_equal);
     priv->entries = NULL;
+    priv->fingerprint_valid = FALSE;
 }
 
 static void
@@ -192,6 +205,7 @@ fw_ipset_class_init(FWIPSetClass *fw_ipset_class)
     obj_class->finalize = fw_ipset_finalize;
 
     g_type_class_add_private(obj_class, sizeof(FWIPSetPrivate));
+    fw_accounting_register(obj_class, sizeof(FWIPSetPrivate));
 }
 
 /* methods */
@@ -250,6 +264,7 @@ fw_ipset_setVersion(FWIPSet *obj,
     if (priv->version != NULL)
 	g_free(priv->version);
     priv->version = g_strdup(version);
+    priv->fingerprint_valid = FALSE;
 }
 
 /**
@@ -274,6 +289,7 @@ fw_ipset_setShort(FWIPSet *obj,
     if (priv->short_description != NULL)
 	g_free(priv->short_description);
     priv->short_description = g_strdup(short_description);
+    priv->fingerprint_valid = FALSE;
 }
 
 /**
@@ -298,6 +314,7 @@ fw_ipset_setDescription(FWIPSet *obj,
     if (priv->description != NULL)
 	g_free(priv->description);
     priv->description = g_strdup(description);
+    priv->fingerprint_valid = FALSE;
 }
 
 /**
@@ -322,6 +339,7 @@ fw_ipset_setType(FWIPSet *obj,
     if (priv->type != NULL)
 	g_free(priv->type);
     priv->type = g_strdup(type);
+    priv->fingerprint_valid = FALSE;
 }
 
 /**
@@ -363,6 +381,7 @@ fw_ipset_setOption(FWIPSet *obj,
     FWIPSetPrivate *priv = FW_IPSET_GET_PRIVATE(obj);
 
     g_hash_table_replace(priv->options, key, value);
+    priv->fingerprint_valid = FALSE;
 }
 
 void
@@ -372,6 +391,7 @@ fw_ipset_removeOption(FWIPSet *obj,
     FWIPSetPrivate *priv = FW_IPSET_GET_PRIVATE(obj);
 
     g_hash_table_remove(priv->options, key);
+    priv->fingerprint_valid = FALSE;
 }
 
 gboolean
@@ -414,6 +434,7 @@ fw_ipset_setEntries(FWIPSet *obj,
     if (priv->entries != NULL)
 	fw_str_list_free(priv->entries);
     priv->entries = fw_str_list_copy(entries);
+    priv->fingerprint_valid = FALSE;
 }
 
 void
@@ -423,6 +444,7 @@ fw_ipset_addEntry(FWIPSet *obj,
     FWIPSetPrivate *priv = FW_IPSET_GET_PRIVATE(obj);
 
     priv->entries = fw_str_list_append(priv->entries, entry);
+    priv->fingerprint_valid = FALSE;
 }
 
 void
@@ -432,6 +454,7 @@ fw_ipset_removeEntry(FWIPSet *obj,
     FWIPSetPrivate *priv = FW_IPSET_GET_PRIVATE(obj);
 
     priv->entries = fw_str_list_remove(priv->entries, entry);
+    priv->fingerprint_valid = FALSE;
 }
 
 gboolean
@@ -443,3 +466,53 @@ fw_ipset_queryEntry(FWIPSet *obj,
     return fw_str_list_contains(priv->entries, entry);
 }
 
+/* fingerprint */
+
+/**
+ * fw_ipset_getFingerprint:
+ * @obj: (type FWIPSet*): a FWIPSet instance
+ *
+ * Order insensitive structural hash of the settings, cached until the
+ * next change through the FWIPSet methods.
+ *
+ * Returns: (transfer none): fingerprint of the settings
+ */
+const FWFingerprint *
+fw_ipset_getFingerprint(FWIPSet *obj)
+{
+    FWIPSetPrivate *priv = FW_IPSET_GET_PRIVATE(obj);
+    GVariant *variant;
+
+    if (!priv->fingerprint_valid) {
+	variant = g_variant_ref_sink(fw_ipset_to_variant(obj));
+	fw_fingerprint_variant(variant, &priv->fingerprint);
+	g_variant_unref(variant);
+	priv->fingerprint_valid = TRUE;
+    }
+
+    return &priv->fingerprint;
+}
+
+/**
+ * fw_ipset_equal:
+ * @a: (type FWIPSet*): a FWIPSet instance
+ * @b: (type FWIPSet*): a FWIPSet instance
+ *
+ * Returns: TRUE if the settings are equal up to the order of list items
+ */
+gboolean
+fw_ipset_equal(FWIPSet *a,
+	       FWIPSet *b)
+{
+    if (a == b)
+	return TRUE;
+
+    return fw_fingerprint_equal(fw_ipset_getFingerprint(a),
+				fw_ipset_getFingerprint(b));
+}
+
+guint
+fw_ipset_hash(FWIPSet *obj)
+{
+    return fw_fingerprint_hash(fw_ipset_getFingerprint(obj));
+}
@@ -24,6 +24,7 @@
 #include <glib.h>
 #include <glib-object.h>
 #include "firewall.h"
+#include "fw_fingerprint.h"
 #include "fw_functions.h"
 
 #define FW_IPSET_TYPE            (fw_ipset_get_type())
@@ -71,4 +72,8 @@ void fw_ipset_addEntry(FWIPSet *obj, gchar *entry);
 void fw_ipset_removeEntry(FWIPSet *obj, gchar *entry);
 gboolean fw_ipset_queryEntry(FWIPSet *obj, gchar *entry);
 
+const FWFingerprint *fw_ipset_getFingerprint(FWIPSet *obj);
+gboolean fw_ipset_equal(FWIPSet *a, FWIPSet *b);
+guint fw_ipset_hash(FWIPSet *obj);
+
 #endif /* __FW_IPSET_H__ */
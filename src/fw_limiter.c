@@ -0,0 +1,483 @@
+/*
+ * Copyright (C) 2017 Red Hat, Inc.
+ *
+ * Authors:
+ * Thomas Woerner <twoerner@redhat.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Admission control for mutating calls to firewalld. firewalld rebuilds
+ * rules for every change, sending more changes than it can apply only
+ * grows its latency. The number of calls in flight is limited with AIMD:
+ * the limit grows by one per round trip while the reply latency stays
+ * below the target and is halved once the target is exceeded. Callers
+ * over the limit wait in a bounded queue, ordered by priority and in FIFO
+ * order within a priority.
+ */
+
+#include "fw_limiter.h"
+#include "fw_accounting.h"
+
+G_DEFINE_TYPE(FWLimiter, fw_limiter, G_TYPE_OBJECT);
+
+#define FW_LIMITER_GET_PRIVATE(o) (G_TYPE_INSTANCE_GET_PRIVATE((o), FW_LIMITER_TYPE, FWLimiterPrivate))
+
+/* multiplicative decrease */
+#define FW_LIMITER_BACKOFF  0.5
+
+typedef struct {
+    GMutex lock;
+    GCond cond;
+
+    gdouble limit;
+    guint min_limit;
+    guint max_limit;
+    gint64 target_latency;
+    guint queue_length;
+
+    guint in_flight;
+    guint queued;
+    guint waiting[FW_LIMITER_N_PRIORITIES];
+    guint64 next_ticket[FW_LIMITER_N_PRIORITIES];
+    guint64 serving[FW_LIMITER_N_PRIORITIES];
+
+    gint64 last_decrease;
+    gint64 latency;		/* moving average */
+    guint64 admitted;
+    guint64 rejected;
+    guint64 decreases;
+} FWLimiterPrivate;
+
+/**
+ * fw_limiter_new:
+ *
+ * Returns: (transfer full) (type FWLimiter*)
+ */
+FWLimiter *
+fw_limiter_new(void)
+{
+    return g_object_new(FW_LIMITER_TYPE, NULL);
+}
+
+static void
+fw_limiter_init(FWLimiter *obj)
+{
+    FWLimiterPrivate *priv = FW_LIMITER_GET_PRIVATE(obj);
+    guint i;
+
+    /* init vars */
+    g_mutex_init(&priv->lock);
+    g_cond_init(&priv->cond);
+
+    priv->limit = FW_LIMITER_INITIAL_LIMIT;
+    priv->min_limit = FW_LIMITER_MIN_LIMIT;
+    priv->max_limit = FW_LIMITER_MAX_LIMIT;
+    priv->target_latency = FW_LIMITER_TARGET_LATENCY;
+    priv->queue_length = FW_LIMITER_QUEUE_LENGTH;
+
+    priv->in_flight = 0;
+    priv->queued = 0;
+    for (i = 0; i < FW_LIMITER_N_PRIORITIES; i++) {
+	priv->waiting[i] = 0;
+	priv->next_ticket[i] = 0;
+	priv->serving[i] = 0;
+    }
+
+    priv->last_decrease = 0;
+    priv->latency = 0;
+    priv->admitted = 0;
+    priv->rejected = 0;
+    priv->decreases = 0;
+}
+
+static void
+fw_limiter_finalize(GObject *obj)
+{
+    FWLimiterPrivate *priv = FW_LIMITER_GET_PRIVATE(obj);
+
+    g_cond_clear(&priv->cond);
+    g_mutex_clear(&priv->lock);
+
+    G_OBJECT_CLASS(fw_limiter_parent_class)->finalize(obj);
+}
+
+static void
+fw_limiter_class_init(FWLimiterClass *fw_limiter_class)
+{
+    GObjectClass *obj_class = G_OBJECT_CLASS(fw_limiter_class);
+
+    obj_class->finalize = fw_limiter_finalize;
+
+    g_type_class_add_private(obj_class, sizeof(FWLimiterPrivate));
+    fw_accounting_register(obj_class, sizeof(FWLimiterPrivate));
+}
+
+/* methods */
+
+void
+fw_limiter_setLimits(FWLimiter *obj,
+		     guint min_limit,
+		     guint max_limit)
+{
+    FWLimiterPrivate *priv = FW_LIMITER_GET_PRIVATE(obj);
+
+    g_mutex_lock(&priv->lock);
+    priv->min_limit = MAX(min_limit, 1);
+    priv->max_limit = MAX(max_limit, priv->min_limit);
+    priv->limit = CLAMP(priv->limit, priv->min_limit, priv->max_limit);
+    g_cond_broadcast(&priv->cond);
+    g_mutex_unlock(&priv->lock);
+}
+
+guint
+fw_limiter_getMinLimit(FWLimiter *obj)
+{
+    FWLimiterPrivate *priv = FW_LIMITER_GET_PRIVATE(obj);
+    guint min_limit;
+
+    g_mutex_lock(&priv->lock);
+    min_limit = priv->min_limit;
+    g_mutex_unlock(&priv->lock);
+
+    return min_limit;
+}
+
+guint
+fw_limiter_getMaxLimit(FWLimiter *obj)
+{
+    FWLimiterPrivate *priv = FW_LIMITER_GET_PRIVATE(obj);
+    guint max_limit;
+
+    g_mutex_lock(&priv->lock);
+    max_limit = priv->max_limit;
+    g_mutex_unlock(&priv->lock);
+
+    return max_limit;
+}
+
+/**
+ * fw_limiter_setTargetLatency:
+ * @latency: reply latency in us, the limit is decreased if it is exceeded
+ */
+void
+fw_limiter_setTargetLatency(FWLimiter *obj,
+			    gint64 latency)
+{
+    FWLimiterPrivate *priv = FW_LIMITER_GET_PRIVATE(obj);
+
+    g_mutex_lock(&priv->lock);
+    priv->target_latency = MAX(latency, 1);
+    g_mutex_unlock(&priv->lock);
+}
+
+gint64
+fw_limiter_getTargetLatency(FWLimiter *obj)
+{
+    FWLimiterPrivate *priv = FW_LIMITER_GET_PRIVATE(obj);
+    gint64 target_latency;
+
+    g_mutex_lock(&priv->lock);
+    target_latency = priv->target_latency;
+    g_mutex_unlock(&priv->lock);
+
+    return target_latency;
+}
+
+/**
+ * fw_limiter_setQueueLength:
+ * @queue_length: number of callers that may wait for admission, further
+ *   callers are rejected
+ */
+void
+fw_limiter_setQueueLength(FWLimiter *obj,
+			  guint queue_length)
+{
+    FWLimiterPrivate *priv = FW_LIMITER_GET_PRIVATE(obj);
+
+    g_mutex_lock(&priv->lock);
+    priv->queue_length = queue_length;
+    g_mutex_unlock(&priv->lock);
+}
+
+guint
+fw_limiter_getQueueLength(FWLimiter *obj)
+{
+    FWLimiterPrivate *priv = FW_LIMITER_GET_PRIVATE(obj);
+    guint queue_length;
+
+    g_mutex_lock(&priv->lock);
+    queue_length = priv->queue_length;
+    g_mutex_unlock(&priv->lock);
+
+    return queue_length;
+}
+
+/* lock held: no caller of the same or a higher priority is waiting */
+static gboolean
+_fw_limiter_first(FWLimiterPrivate *priv,
+		  FWLimiterPriority priority)
+{
+    guint i;
+
+    for (i = 0; i <= priority; i++) {
+	if (priv->waiting[i] > 0)
+	    return FALSE;
+    }
+
+    return TRUE;
+}
+
+/* lock held: higher priorities go first */
+static gboolean
+_fw_limiter_higher_waiting(FWLimiterPrivate *priv,
+			   FWLimiterPriority priority)
+{
+    guint i;
+
+    for (i = 0; i < priority; i++) {
+	if (priv->waiting[i] > 0)
+	    return TRUE;
+    }
+
+    return FALSE;
+}
+
+/**
+ * fw_limiter_acquire:
+ * @priority: priority of the call
+ *
+ * Waits until the call may be sent. Every successful acquire needs a
+ * fw_limiter_release with the latency of the reply.
+ *
+ * Returns: FALSE if the queue is full and the call has been rejected
+ */
+gboolean
+fw_limiter_acquire(FWLimiter *obj,
+		   FWLimiterPriority priority)
+{
+    FWLimiterPrivate *priv = FW_LIMITER_GET_PRIVATE(obj);
+    guint64 ticket;
+
+    g_return_val_if_fail(priority < FW_LIMITER_N_PRIORITIES, FALSE);
+
+    g_mutex_lock(&priv->lock);
+
+    if (priv->in_flight < (guint) priv->limit &&
+	_fw_limiter_first(priv, priority))
+	goto admit;
+
+    if (priv->queued >= priv->queue_length) {
+	priv->rejected++;
+	g_mutex_unlock(&priv->lock);
+	return FALSE;
+    }
+
+    ticket = priv->next_ticket[priority]++;
+    priv->waiting[priority]++;
+    priv->queued++;
+    while (priv->serving[priority] != ticket ||
+	   priv->in_flight >= (guint) priv->limit ||
+	   _fw_limiter_higher_waiting(priv, priority))
+	g_cond_wait(&priv->cond, &priv->lock);
+    priv->serving[priority]++;
+    priv->waiting[priority]--;
+    priv->queued--;
+
+    /* the next one in line might fit as well */
+    g_cond_broadcast(&priv->cond);
+
+admit:
+    priv->in_flight++;
+    priv->admitted++;
+    g_mutex_unlock(&priv->lock);
+
+    return TRUE;
+}
+
+/**
+ * fw_limiter_tryAcquire:
+ * @priority: priority of the call
+ *
+ * Like fw_limiter_acquire, but does not wait.
+ *
+ * Returns: TRUE if the call may be sent
+ */
+gboolean
+fw_limiter_tryAcquire(FWLimiter *obj,
+		      FWLimiterPriority priority)
+{
+    FWLimiterPrivate *priv = FW_LIMITER_GET_PRIVATE(obj);
+    gboolean ret = FALSE;
+
+    g_return_val_if_fail(priority < FW_LIMITER_N_PRIORITIES, FALSE);
+
+    g_mutex_lock(&priv->lock);
+    if (priv->in_flight < (guint) priv->limit &&
+	_fw_limiter_first(priv, priority)) {
+	priv->in_flight++;
+	priv->admitted++;
+	ret = TRUE;
+    }
+    g_mutex_unlock(&priv->lock);
+
+    return ret;
+}
+
+/**
+ * fw_limiter_release:
+ * @latency: time in us from sending the call until the reply arrived
+ * @overload: TRUE if the call failed because firewalld is overloaded, for
+ *   example with a timeout
+ *
+ * Ends a call admitted with fw_limiter_acquire or fw_limiter_tryAcquire
+ * and adapts the limit.
+ */
+void
+fw_limiter_release(FWLimiter *obj,
+		   gint64 latency,
+		   gboolean overload)
+{
+    FWLimiterPrivate *priv = FW_LIMITER_GET_PRIVATE(obj);
+    gint64 now = g_get_monotonic_time();
+
+    g_mutex_lock(&priv->lock);
+
+    if (priv->in_flight == 0) {
+	g_mutex_unlock(&priv->lock);
+	g_return_if_reached();
+    }
+
+    if (priv->latency == 0)
+	priv->latency = latency;
+    else
+	priv->latency += (latency - priv->latency) / 8;
+
+    if (overload || latency > priv->target_latency) {
+	/* replies of calls sent before the last decrease still show the
+	   old load, decrease only once per round trip */
+	if (now - priv->last_decrease > latency) {
+	    priv->limit = MAX(priv->limit * FW_LIMITER_BACKOFF,
+			      priv->min_limit);
+	    priv->last_decrease = now;
+	    priv->decreases++;
+	}
+    } else if (priv->in_flight >= (guint) priv->limit) {
+	/* grow only if the limit has been used, by one per round trip */
+	priv->limit = MIN(priv->limit + 1.0 / priv->limit, priv->max_limit);
+    }
+
+    priv->in_flight--;
+    g_cond_broadcast(&priv->cond);
+    g_mutex_unlock(&priv->lock);
+}
+
+/* stats */
+
+guint
+fw_limiter_getLimit(FWLimiter *obj)
+{
+    FWLimiterPrivate *priv = FW_LIMITER_GET_PRIVATE(obj);
+    guint limit;
+
+    g_mutex_lock(&priv->lock);
+    limit = (guint) priv->limit;
+    g_mutex_unlock(&priv->lock);
+
+    return limit;
+}
+
+guint
+fw_limiter_getInFlight(FWLimiter *obj)
+{
+    FWLimiterPrivate *priv = FW_LIMITER_GET_PRIVATE(obj);
+    guint in_flight;
+
+    g_mutex_lock(&priv->lock);
+    in_flight = priv->in_flight;
+    g_mutex_unlock(&priv->lock);
+
+    return in_flight;
+}
+
+guint
+fw_limiter_getQueued(FWLimiter *obj)
+{
+    FWLimiterPrivate *priv = FW_LIMITER_GET_PRIVATE(obj);
+    guint queued;
+
+    g_mutex_lock(&priv->lock);
+    queued = priv->queued;
+    g_mutex_unlock(&priv->lock);
+
+    return queued;
+}
+
+guint64
+fw_limiter_getAdmitted(FWLimiter *obj)
+{
+    FWLimiterPrivate *priv = FW_LIMITER_GET_PRIVATE(obj);
+    guint64 admitted;
+
+    g_mutex_lock(&priv->lock);
+    admitted = priv->admitted;
+    g_mutex_unlock(&priv->lock);
+
+    return admitted;
+}
+
+guint64
+fw_limiter_getRejected(FWLimiter *obj)
+{
+    FWLimiterPrivate *priv = FW_LIMITER_GET_PRIVATE(obj);
+    guint64 rejected;
+
+    g_mutex_lock(&priv->lock);
+    rejected = priv->rejected;
+    g_mutex_unlock(&priv->lock);
+
+    return rejected;
+}
+
+guint64
+fw_limiter_getDecreases(FWLimiter *obj)
+{
+    FWLimiterPrivate *priv = FW_LIMITER_GET_PRIVATE(obj);
+    guint64 decreases;
+
+    g_mutex_lock(&priv->lock);
+    decreases = priv->decreases;
+    g_mutex_unlock(&priv->lock);
+
+    return decreases;
+}
+
+/**
+ * fw_limiter_getLatency:
+ *
+ * Returns: moving average of the reply latency in us
+ */
+gint64
+fw_limiter_getLatency(FWLimiter *obj)
+{
+    FWLimiterPrivate *priv = FW_LIMITER_GET_PRIVATE(obj);
+    gint64 latency;
+
+    g_mutex_lock(&priv->lock);
+    latency = priv->latency;
+    g_mutex_unlock(&priv->lock);
+
+    return latency;
+}
@@ -0,0 +1,81 @@
+/*
+ * Copyright (C) 2017 Red Hat, Inc.
+ *
+ * Authors:
+ * Thomas Woerner <twoerner@redhat.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __FW_LIMITER_H__
+#define __FW_LIMITER_H__
+
+#include <glib.h>
+#include <glib-object.h>
+#include "firewall.h"
+
+#define FW_LIMITER_TYPE            (fw_limiter_get_type())
+#define FW_LIMITER(obj)            (G_TYPE_CHECK_INSTANCE_CAST((obj), FW_LIMITER_TYPE, FWLimiter))
+#define FW_LIMITER_CLASS(klass)    (G_TYPE_CHECK_CLASS_CAST((klass), FW_LIMITER_TYPE, FWLimiterClass))
+#define FW_IS_LIMITER(klass)       (G_TYPE_CHECK_INSTANCE_CLASS((klass), FW_LIMITER_TYPE, FWLimiterClass))
+#define FW_LIMITER_GET_CLASS(obj)  (G_TYPE_INSTANCE_GET_CLASS((obj), FW_LIMITER_TYPE, FWLimiterClass))
+
+/* defaults, latencies in us */
+#define FW_LIMITER_MIN_LIMIT       1
+#define FW_LIMITER_MAX_LIMIT       64
+#define FW_LIMITER_INITIAL_LIMIT   4
+#define FW_LIMITER_TARGET_LATENCY  (50 * G_TIME_SPAN_MILLISECOND)
+#define FW_LIMITER_QUEUE_LENGTH    1024
+
+typedef enum {
+    FW_LIMITER_PRIORITY_HIGH,
+    FW_LIMITER_PRIORITY_NORMAL,
+    FW_LIMITER_PRIORITY_LOW,
+    FW_LIMITER_N_PRIORITIES,
+} FWLimiterPriority;
+
+typedef struct {
+    GObject parent;
+} FWLimiter;
+
+typedef struct {
+    GObjectClass parent;
+} FWLimiterClass;
+
+GType fw_limiter_get_type(void);
+FWLimiter *fw_limiter_new(void);
+
+void fw_limiter_setLimits(FWLimiter *obj, guint min_limit, guint max_limit);
+guint fw_limiter_getMinLimit(FWLimiter *obj);
+guint fw_limiter_getMaxLimit(FWLimiter *obj);
+void fw_limiter_setTargetLatency(FWLimiter *obj, gint64 latency);
+gint64 fw_limiter_getTargetLatency(FWLimiter *obj);
+void fw_limiter_setQueueLength(FWLimiter *obj, guint queue_length);
+guint fw_limiter_getQueueLength(FWLimiter *obj);
+
+gboolean fw_limiter_acquire(FWLimiter *obj, FWLimiterPriority priority);
+gboolean fw_limiter_tryAcquire(FWLimiter *obj, FWLimiterPriority priority);
+void fw_limiter_release(FWLimiter *obj, gint64 latency, gboolean overload);
+
+/* stats */
+
+guint fw_limiter_getLimit(FWLimiter *obj);
+guint fw_limiter_getInFlight(FWLimiter *obj);
+guint fw_limiter_getQueued(FWLimiter *obj);
+guint64 fw_limiter_getAdmitted(FWLimiter *obj);
+guint64 fw_limiter_getRejected(FWLimiter *obj);
+guint64 fw_limiter_getDecreases(FWLimiter *obj);
+gint64 fw_limiter_getLatency(FWLimiter *obj);
+
+#endif /* __FW_LIMITER_H__ */
@@ -0,0 +1,593 @@
+/*
+ * Copyright (C) 2017 Red Hat, Inc.
+ *
+ * Authors:
+ * Thomas Woerner <twoerner@redhat.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Local copy of the lockdown whitelist. Contexts, uids and users are hash
+ * sets. The command patterns are compiled into a trie on the first match
+ * after a change: exact commands accept at their last character, patterns
+ * with a trailing "*" accept as soon as their prefix has been read, so a
+ * command line is matched against all patterns in a single pass.
+ */
+
+#include <string.h>
+#include "fw_lockdown_whitelist.h"
+#include "fw_accounting.h"
+
+G_DEFINE_TYPE(FWLockdownWhitelist, fw_lockdown_whitelist, G_TYPE_OBJECT);
+
+#define FW_LOCKDOWN_WHITELIST_GET_PRIVATE(o) (G_TYPE_INSTANCE_GET_PRIVATE((o), FW_LOCKDOWN_WHITELIST_TYPE, FWLockdownWhitelistPrivate))
+
+#define FW_LOCKDOWN_WHITELIST_EXACT   (1 << 0)
+#define FW_LOCKDOWN_WHITELIST_PREFIX  (1 << 1)
+
+typedef struct {
+    guint child;		/* first child, 0 for none */
+    guint sibling;		/* next sibling, 0 for none */
+    gchar c;
+    guint8 accept;
+} FWLockdownWhitelistNode;
+
+typedef struct {
+    GHashTable *commands;
+    GHashTable *contexts;
+    GHashTable *uids;		/* GINT_TO_POINTER(uid) */
+    GHashTable *users;
+    GArray *nodes;		/* FWLockdownWhitelistNode, root at 0 */
+    gboolean compiled;
+} FWLockdownWhitelistPrivate;
+
+/**
+ * fw_lockdown_whitelist_new:
+ *
+ * Returns: (transfer full) (type FWLockdownWhitelist*)
+ */
+FWLockdownWhitelist *
+fw_lockdown_whitelist_new(void)
+{
+    return g_object_new(FW_LOCKDOWN_WHITELIST_TYPE, NULL);
+}
+
+static void
+fw_lockdown_whitelist_init(FWLockdownWhitelist *obj)
+{
+    FWLockdownWhitelistPrivate *priv = FW_LOCKDOWN_WHITELIST_GET_PRIVATE(obj);
+
+    /* init vars */
+    priv->commands = g_hash_table_new_full(g_str_hash, g_str_equal, g_free,
+					   NULL);
+    priv->contexts = g_hash_table_new_full(g_str_hash, g_str_equal, g_free,
+					   NULL);
+    priv->uids = g_hash_table_new(g_direct_hash, g_direct_equal);
+    priv->users = g_hash_table_new_full(g_str_hash, g_str_equal, g_free,
+					NULL);
+    priv->nodes = g_array_new(FALSE, TRUE, sizeof(FWLockdownWhitelistNode));
+    priv->compiled = FALSE;
+}
+
+static void
+fw_lockdown_whitelist_finalize(GObject *obj)
+{
+    FWLockdownWhitelistPrivate *priv = FW_LOCKDOWN_WHITELIST_GET_PRIVATE(obj);
+
+    g_hash_table_destroy(priv->commands);
+    g_hash_table_destroy(priv->contexts);
+    g_hash_table_destroy(priv->uids);
+    g_hash_table_destroy(priv->users);
+    g_array_free(priv->nodes, TRUE);
+
+    G_OBJECT_CLASS(fw_lockdown_whitelist_parent_class)->finalize(obj);
+}
+
+static void
+fw_lockdown_whitelist_class_init(FWLockdownWhitelistClass *fw_lockdown_whitelist_class)
+{
+    GObjectClass *obj_class = G_OBJECT_CLASS(fw_lockdown_whitelist_class);
+
+    obj_class->finalize = fw_lockdown_whitelist_finalize;
+
+    g_type_class_add_private(obj_class, sizeof(FWLockdownWhitelistPrivate));
+    fw_accounting_register(obj_class, sizeof(FWLockdownWhitelistPrivate));
+}
+
+/* command trie */
+
+static guint
+_fw_lockdown_whitelist_child(GArray *nodes,
+			     guint index,
+			     gchar c)
+{
+    guint child = g_array_index(nodes, FWLockdownWhitelistNode, index).child;
+
+    while (child != 0) {
+	FWLockdownWhitelistNode *node = &g_array_index(
+	    nodes, FWLockdownWhitelistNode, child);
+
+	if (node->c == c)
+	    return child;
+	child = node->sibling;
+    }
+
+    return 0;
+}
+
+static void
+_fw_lockdown_whitelist_compile(FWLockdownWhitelistPrivate *priv)
+{
+    GHashTableIter iter;
+    gpointer key;
+
+    g_array_set_size(priv->nodes, 1);
+    memset(priv->nodes->data, 0, sizeof(FWLockdownWhitelistNode));
+
+    g_hash_table_iter_init(&iter, priv->commands);
+    while (g_hash_table_iter_next(&iter, &key, NULL)) {
+	const gchar *command = key;
+	gsize i, len = strlen(command);
+	guint8 accept = FW_LOCKDOWN_WHITELIST_EXACT;
+	guint index = 0;
+
+	if (len > 0 && command[len - 1] == '*') {
+	    accept = FW_LOCKDOWN_WHITELIST_PREFIX;
+	    len--;
+	}
+
+	for (i = 0; i < len; i++) {
+	    guint child = _fw_lockdown_whitelist_child(priv->nodes, index,
+							command[i]);
+
+	    if (child == 0) {
+		FWLockdownWhitelistNode node = { 0, 0, command[i], 0 };
+
+		child = priv->nodes->len;
+		node.sibling = g_array_index(priv->nodes,
+					     FWLockdownWhitelistNode,
+					     index).child;
+		g_array_append_val(priv->nodes, node);
+		g_array_index(priv->nodes, FWLockdownWhitelistNode,
+			      index).child = child;
+	    }
+	    index = child;
+	}
+	g_array_index(priv->nodes, FWLockdownWhitelistNode,
+		      index).accept |= accept;
+    }
+
+#ifdef FW_DEBUG
+    g_printerr("_fw_lockdown_whitelist_compile(): %u commands, %u nodes\n",
+	       g_hash_table_size(priv->commands), priv->nodes->len);
+#endif
+
+    priv->compiled = TRUE;
+}
+
+/* set helpers */
+
+static gboolean
+_fw_lockdown_whitelist_add(GHashTable *table,
+			   const gchar *item)
+{
+    if (g_hash_table_contains(table, item))
+	return FALSE;
+
+    g_hash_table_add(table, g_strdup(item));
+
+    return TRUE;
+}
+
+static GList *
+_fw_lockdown_whitelist_get(GHashTable *table)
+{
+    return g_list_sort(g_hash_table_get_keys(table),
+		       (GCompareFunc) strcmp);
+}
+
+static gint
+_fw_lockdown_whitelist_uid_cmp(gconstpointer a,
+			       gconstpointer b)
+{
+    gint32 uid_a = GPOINTER_TO_INT(a);
+    gint32 uid_b = GPOINTER_TO_INT(b);
+
+    return (uid_a < uid_b) ? -1 : (uid_a > uid_b);
+}
+
+/* methods */
+
+guint
+fw_lockdown_whitelist_length(FWLockdownWhitelist *obj)
+{
+    FWLockdownWhitelistPrivate *priv = FW_LOCKDOWN_WHITELIST_GET_PRIVATE(obj);
+
+    return g_hash_table_size(priv->commands) +
+	g_hash_table_size(priv->contexts) +
+	g_hash_table_size(priv->uids) +
+	g_hash_table_size(priv->users);
+}
+
+/* commands */
+
+/**
+ * fw_lockdown_whitelist_addCommand:
+ * @obj: (type FWLockdownWhitelist*): a FWLockdownWhitelist instance
+ * @command: (type utf8): command line, a trailing "*" matches any rest
+ *
+ * Returns: FALSE if the command is already in the whitelist
+ */
+gboolean
+fw_lockdown_whitelist_addCommand(FWLockdownWhitelist *obj,
+				 const gchar *command)
+{
+    FWLockdownWhitelistPrivate *priv = FW_LOCKDOWN_WHITELIST_GET_PRIVATE(obj);
+
+    if (!_fw_lockdown_whitelist_add(priv->commands, command))
+	return FALSE;
+
+    priv->compiled = FALSE;
+
+    return TRUE;
+}
+
+gboolean
+fw_lockdown_whitelist_removeCommand(FWLockdownWhitelist *obj,
+				    const gchar *command)
+{
+    FWLockdownWhitelistPrivate *priv = FW_LOCKDOWN_WHITELIST_GET_PRIVATE(obj);
+
+    if (!g_hash_table_remove(priv->commands, command))
+	return FALSE;
+
+    priv->compiled = FALSE;
+
+    return TRUE;
+}
+
+/**
+ * fw_lockdown_whitelist_queryCommand:
+ * @obj: (type FWLockdownWhitelist*): a FWLockdownWhitelist instance
+ * @command: (type utf8): command pattern
+ *
+ * Returns: TRUE if the pattern is in the whitelist, see
+ * fw_lockdown_whitelist_matchCommand for matching a command line
+ */
+gboolean
+fw_lockdown_whitelist_queryCommand(FWLockdownWhitelist *obj,
+				   const gchar *command)
+{
+    FWLockdownWhitelistPrivate *priv = FW_LOCKDOWN_WHITELIST_GET_PRIVATE(obj);
+
+    return g_hash_table_contains(priv->commands, command);
+}
+
+/**
+ * fw_lockdown_whitelist_getCommands:
+ * @obj: (type FWLockdownWhitelist*): a FWLockdownWhitelist instance
+ *
+ * Returns: (type GList*) (transfer container) (element-type utf8): sorted
+ */
+GList *
+fw_lockdown_whitelist_getCommands(FWLockdownWhitelist *obj)
+{
+    FWLockdownWhitelistPrivate *priv = FW_LOCKDOWN_WHITELIST_GET_PRIVATE(obj);
+
+    return _fw_lockdown_whitelist_get(priv->commands);
+}
+
+/* contexts */
+
+gboolean
+fw_lockdown_whitelist_addContext(FWLockdownWhitelist *obj,
+				 const gchar *context)
+{
+    FWLockdownWhitelistPrivate *priv = FW_LOCKDOWN_WHITELIST_GET_PRIVATE(obj);
+
+    return _fw_lockdown_whitelist_add(priv->contexts, context);
+}
+
+gboolean
+fw_lockdown_whitelist_removeContext(FWLockdownWhitelist *obj,
+				    const gchar *context)
+{
+    FWLockdownWhitelistPrivate *priv = FW_LOCKDOWN_WHITELIST_GET_PRIVATE(obj);
+
+    return g_hash_table_remove(priv->contexts, context);
+}
+
+gboolean
+fw_lockdown_whitelist_queryContext(FWLockdownWhitelist *obj,
+				   const gchar *context)
+{
+    FWLockdownWhitelistPrivate *priv = FW_LOCKDOWN_WHITELIST_GET_PRIVATE(obj);
+
+    return g_hash_table_contains(priv->contexts, context);
+}
+
+/**
+ * fw_lockdown_whitelist_getContexts:
+ * @obj: (type FWLockdownWhitelist*): a FWLockdownWhitelist instance
+ *
+ * Returns: (type GList*) (transfer container) (element-type utf8): sorted
+ */
+GList *
+fw_lockdown_whitelist_getContexts(FWLockdownWhitelist *obj)
+{
+    FWLockdownWhitelistPrivate *priv = FW_LOCKDOWN_WHITELIST_GET_PRIVATE(obj);
+
+    return _fw_lockdown_whitelist_get(priv->contexts);
+}
+
+/* uids */
+
+gboolean
+fw_lockdown_whitelist_addUid(FWLockdownWhitelist *obj,
+			     gint32 uid)
+{
+    FWLockdownWhitelistPrivate *priv = FW_LOCKDOWN_WHITELIST_GET_PRIVATE(obj);
+
+    return g_hash_table_add(priv->uids, GINT_TO_POINTER(uid));
+}
+
+gboolean
+fw_lockdown_whitelist_removeUid(FWLockdownWhitelist *obj,
+				gint32 uid)
+{
+    FWLockdownWhitelistPrivate *priv = FW_LOCKDOWN_WHITELIST_GET_PRIVATE(obj);
+
+    return g_hash_table_remove(priv->uids, GINT_TO_POINTER(uid));
+}
+
+gboolean
+fw_lockdown_whitelist_queryUid(FWLockdownWhitelist *obj,
+			       gint32 uid)
+{
+    FWLockdownWhitelistPrivate *priv = FW_LOCKDOWN_WHITELIST_GET_PRIVATE(obj);
+
+    return g_hash_table_contains(priv->uids, GINT_TO_POINTER(uid));
+}
+
+/**
+ * fw_lockdown_whitelist_getUids:
+ * @obj: (type FWLockdownWhitelist*): a FWLockdownWhitelist instance
+ *
+ * Returns: (type GList*) (transfer container) (element-type gint32): sorted
+ */
+GList *
+fw_lockdown_whitelist_getUids(FWLockdownWhitelist *obj)
+{
+    FWLockdownWhitelistPrivate *priv = FW_LOCKDOWN_WHITELIST_GET_PRIVATE(obj);
+
+    return g_list_sort(g_hash_table_get_keys(priv->uids),
+		       _fw_lockdown_whitelist_uid_cmp);
+}
+
+/* users */
+
+gboolean
+fw_lockdown_whitelist_addUser(FWLockdownWhitelist *obj,
+			      const gchar *user)
+{
+    FWLockdownWhitelistPrivate *priv = FW_LOCKDOWN_WHITELIST_GET_PRIVATE(obj);
+
+    return _fw_lockdown_whitelist_add(priv->users, user);
+}
+
+gboolean
+fw_lockdown_whitelist_removeUser(FWLockdownWhitelist *obj,
+				 const gchar *user)
+{
+    FWLockdownWhitelistPrivate *priv = FW_LOCKDOWN_WHITELIST_GET_PRIVATE(obj);
+
+    return g_hash_table_remove(priv->users, user);
+}
+
+gboolean
+fw_lockdown_whitelist_queryUser(FWLockdownWhitelist *obj,
+				const gchar *user)
+{
+    FWLockdownWhitelistPrivate *priv = FW_LOCKDOWN_WHITELIST_GET_PRIVATE(obj);
+
+    return g_hash_table_contains(priv->users, user);
+}
+
+/**
+ * fw_lockdown_whitelist_getUsers:
+ * @obj: (type FWLockdownWhitelist*): a FWLockdownWhitelist instance
+ *
+ * Returns: (type GList*) (transfer container) (element-type utf8): sorted
+ */
+GList *
+fw_lockdown_whitelist_getUsers(FWLockdownWhitelist *obj)
+{
+    FWLockdownWhitelistPrivate *priv = FW_LOCKDOWN_WHITELIST_GET_PRIVATE(obj);
+
+    return _fw_lockdown_whitelist_get(priv->users);
+}
+
+/* matching */
+
+/**
+ * fw_lockdown_whitelist_matchCommand:
+ * @obj: (type FWLockdownWhitelist*): a FWLockdownWhitelist instance
+ * @command: (type utf8): command line
+ *
+ * Returns: TRUE if the command line is equal to a command of the
+ * whitelist or starts with a command that ends with "*"
+ */
+gboolean
+fw_lockdown_whitelist_matchCommand(FWLockdownWhitelist *obj,
+				   const gchar *command)
+{
+    FWLockdownWhitelistPrivate *priv = FW_LOCKDOWN_WHITELIST_GET_PRIVATE(obj);
+    FWLockdownWhitelistNode *node;
+    guint index = 0;
+
+    if (!priv->compiled)
+	_fw_lockdown_whitelist_compile(priv);
+
+    for (;;) {
+	node = &g_array_index(priv->nodes, FWLockdownWhitelistNode, index);
+	if (node->accept & FW_LOCKDOWN_WHITELIST_PREFIX)
+	    return TRUE;
+	if (*command == '\0')
+	    return (node->accept & FW_LOCKDOWN_WHITELIST_EXACT) != 0;
+	index = _fw_lockdown_whitelist_child(priv->nodes, index, *command++);
+	if (index == 0)
+	    return FALSE;
+    }
+}
+
+gboolean
+fw_lockdown_whitelist_matchContext(FWLockdownWhitelist *obj,
+				   const gchar *context)
+{
+    return fw_lockdown_whitelist_queryContext(obj, context);
+}
+
+gboolean
+fw_lockdown_whitelist_matchUid(FWLockdownWhitelist *obj,
+			       gint32 uid)
+{
+    return fw_lockdown_whitelist_queryUid(obj, uid);
+}
+
+gboolean
+fw_lockdown_whitelist_matchUser(FWLockdownWhitelist *obj,
+				const gchar *user)
+{
+    return fw_lockdown_whitelist_queryUser(obj, user);
+}
+
+/**
+ * fw_lockdown_whitelist_isAllowed:
+ * @obj: (type FWLockdownWhitelist*): a FWLockdownWhitelist instance
+ * @command: (type utf8) (allow-none): command line of the caller
+ * @context: (type utf8) (allow-none): selinux context of the caller
+ * @uid: uid of the caller, negative if unknown
+ * @user: (type utf8) (allow-none): user name of the caller
+ *
+ * Checks the caller the way firewalld does with lockdown enabled: a match
+ * of any of the given attributes is enough.
+ *
+ * Returns: TRUE if the caller would be allowed
+ */
+gboolean
+fw_lockdown_whitelist_isAllowed(FWLockdownWhitelist *obj,
+				const gchar *command,
+				const gchar *context,
+				gint32 uid,
+				const gchar *user)
+{
+    if (context != NULL && fw_lockdown_whitelist_matchContext(obj, context))
+	return TRUE;
+    if (uid >= 0 && fw_lockdown_whitelist_matchUid(obj, uid))
+	return TRUE;
+    if (user != NULL && fw_lockdown_whitelist_matchUser(obj, user))
+	return TRUE;
+    if (command != NULL && fw_lockdown_whitelist_matchCommand(obj, command))
+	return TRUE;
+
+    return FALSE;
+}
+
+/* diff */
+
+/* calls for the items of table that are not in other */
+static guint
+_fw_lockdown_whitelist_queue(FWBatch *batch,
+			     const gchar *method_name,
+			     GHashTable *table,
+			     GHashTable *other,
+			     gboolean uids)
+{
+    GList *list, *l;
+    guint n = 0;
+
+    if (uids)
+	list = g_list_sort(g_hash_table_get_keys(table),
+			   _fw_lockdown_whitelist_uid_cmp);
+    else
+	list = _fw_lockdown_whitelist_get(table);
+
+    for (l = list; l != NULL; l = l->next) {
+	if (g_hash_table_contains(other, l->data))
+	    continue;
+
+	fw_batch_add(batch, FW_DBUS_PATH, FW_DBUS_INTERFACE_POLICIES,
+		     method_name,
+		     uids ? g_variant_new("(i)", GPOINTER_TO_INT(l->data)) :
+		     g_variant_new("(s)", l->data));
+	n++;
+    }
+    g_list_free(list);
+
+    return n;
+}
+
+/**
+ * fw_lockdown_whitelist_queueDiff:
+ * @obj: (type FWLockdownWhitelist*): current whitelist
+ * @desired: (type FWLockdownWhitelist*): whitelist to get to
+ * @batch: (type FWBatch*): batch to add the calls to
+ *
+ * Adds the add calls and then the remove calls that change the runtime
+ * lockdown whitelist from obj to desired to the batch. Items that are in
+ * both whitelists are not touched. Adding first keeps the caller
+ * whitelisted for the whole batch if the new entries still match it.
+ *
+ * Returns: number of calls added to the batch
+ */
+guint
+fw_lockdown_whitelist_queueDiff(FWLockdownWhitelist *obj,
+				FWLockdownWhitelist *desired,
+				FWBatch *batch)
+{
+    FWLockdownWhitelistPrivate *priv = FW_LOCKDOWN_WHITELIST_GET_PRIVATE(obj);
+    FWLockdownWhitelistPrivate *desired_priv = FW_LOCKDOWN_WHITELIST_GET_PRIVATE(desired);
+    guint n = 0;
+
+    /* with lockdown enabled the caller may only be allowed by the entry
+     * that gets replaced, add the new entries before removing it */
+    n += _fw_lockdown_whitelist_queue(batch, "addLockdownWhitelistCommand",
+				      desired_priv->commands, priv->commands,
+				      FALSE);
+    n += _fw_lockdown_whitelist_queue(batch, "addLockdownWhitelistContext",
+				      desired_priv->contexts, priv->contexts,
+				      FALSE);
+    n += _fw_lockdown_whitelist_queue(batch, "addLockdownWhitelistUid",
+				      desired_priv->uids, priv->uids, TRUE);
+    n += _fw_lockdown_whitelist_queue(batch, "addLockdownWhitelistUser",
+				      desired_priv->users, priv->users, FALSE);
+
+    n += _fw_lockdown_whitelist_queue(batch, "removeLockdownWhitelistCommand",
+				      priv->commands, desired_priv->commands,
+				      FALSE);
+    n += _fw_lockdown_whitelist_queue(batch, "removeLockdownWhitelistContext",
+				      priv->contexts, desired_priv->contexts,
+				      FALSE);
+    n += _fw_lockdown_whitelist_queue(batch, "removeLockdownWhitelistUid",
+				      priv->uids, desired_priv->uids, TRUE);
+    n += _fw_lockdown_whitelist_queue(batch, "removeLockdownWhitelistUser",
+				      priv->users, desired_priv->users, FALSE);
+
+#ifdef FW_DEBUG
+    g_printerr("fw_lockdown_whitelist_queueDiff(): %u calls\n", n);
+#endif
+
+    return n;
+}
@@ -0,0 +1,80 @@
+/*
+ * Copyright (C) 2017 Red Hat, Inc.
+ *
+ * Authors:
+ * Thomas Woerner <twoerner@redhat.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __FW_LOCKDOWN_WHITELIST_H__
+#define __FW_LOCKDOWN_WHITELIST_H__
+
+#include <glib.h>
+#include <glib-object.h>
+#include "firewall.h"
+#include "fw_batch.h"
+
+#define FW_LOCKDOWN_WHITELIST_TYPE            (fw_lockdown_whitelist_get_type())
+#define FW_LOCKDOWN_WHITELIST(obj)            (G_TYPE_CHECK_INSTANCE_CAST((obj), FW_LOCKDOWN_WHITELIST_TYPE, FWLockdownWhitelist))
+#define FW_LOCKDOWN_WHITELIST_CLASS(klass)    (G_TYPE_CHECK_CLASS_CAST((klass), FW_LOCKDOWN_WHITELIST_TYPE, FWLockdownWhitelistClass))
+#define FW_IS_LOCKDOWN_WHITELIST(klass)       (G_TYPE_CHECK_INSTANCE_CLASS((klass), FW_LOCKDOWN_WHITELIST_TYPE, FWLockdownWhitelistClass))
+#define FW_LOCKDOWN_WHITELIST_GET_CLASS(obj)  (G_TYPE_INSTANCE_GET_CLASS((obj), FW_LOCKDOWN_WHITELIST_TYPE, FWLockdownWhitelistClass))
+
+typedef struct {
+    GObject parent;
+} FWLockdownWhitelist;
+
+typedef struct {
+    GObjectClass parent;
+} FWLockdownWhitelistClass;
+
+GType fw_lockdown_whitelist_get_type(void);
+FWLockdownWhitelist *fw_lockdown_whitelist_new(void);
+
+guint fw_lockdown_whitelist_length(FWLockdownWhitelist *obj);
+
+gboolean fw_lockdown_whitelist_addCommand(FWLockdownWhitelist *obj, const gchar *command);
+gboolean fw_lockdown_whitelist_removeCommand(FWLockdownWhitelist *obj, const gchar *command);
+gboolean fw_lockdown_whitelist_queryCommand(FWLockdownWhitelist *obj, const gchar *command);
+GList *fw_lockdown_whitelist_getCommands(FWLockdownWhitelist *obj);
+
+gboolean fw_lockdown_whitelist_addContext(FWLockdownWhitelist *obj, const gchar *context);
+gboolean fw_lockdown_whitelist_removeContext(FWLockdownWhitelist *obj, const gchar *context);
+gboolean fw_lockdown_whitelist_queryContext(FWLockdownWhitelist *obj, const gchar *context);
+GList *fw_lockdown_whitelist_getContexts(FWLockdownWhitelist *obj);
+
+gboolean fw_lockdown_whitelist_addUid(FWLockdownWhitelist *obj, gint32 uid);
+gboolean fw_lockdown_whitelist_removeUid(FWLockdownWhitelist *obj, gint32 uid);
+gboolean fw_lockdown_whitelist_queryUid(FWLockdownWhitelist *obj, gint32 uid);
+GList *fw_lockdown_whitelist_getUids(FWLockdownWhitelist *obj);
+
+gboolean fw_lockdown_whitelist_addUser(FWLockdownWhitelist *obj, const gchar *user);
+gboolean fw_lockdown_whitelist_removeUser(FWLockdownWhitelist *obj, const gchar *user);
+gboolean fw_lockdown_whitelist_queryUser(FWLockdownWhitelist *obj, const gchar *user);
+GList *fw_lockdown_whitelist_getUsers(FWLockdownWhitelist *obj);
+
+/* matching like the firewalld access check */
+
+gboolean fw_lockdown_whitelist_matchCommand(FWLockdownWhitelist *obj, const gchar *command);
+gboolean fw_lockdown_whitelist_matchContext(FWLockdownWhitelist *obj, const gchar *context);
+gboolean fw_lockdown_whitelist_matchUid(FWLockdownWhitelist *obj, gint32 uid);
+gboolean fw_lockdown_whitelist_matchUser(FWLockdownWhitelist *obj, const gchar *user);
+gboolean fw_lockdown_whitelist_isAllowed(FWLockdownWhitelist *obj, const gchar *command, const gchar *context, gint32 uid, const gchar *user);
+
+/* changes to get from obj to desired */
+
+guint fw_lockdown_whitelist_queueDiff(FWLockdownWhitelist *obj, FWLockdownWhitelist *desired, FWBatch *batch);
+
+#endif /* __FW_LOCKDOWN_WHITELIST_H__ */
@@ -0,0 +1,1759 @@
+/*
+ * Copyright (C) 2017 Red Hat, Inc.
+ *
+ * Authors:
+ * Thomas Woerner <twoerner@redhat.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Newline delimited JSON export and import of the firewalld configuration.
+ * Every line is one record:
+ *
+ *   {"type":"zone","scope":"permanent","name":"public","settings":{...}}
+ *   {"type":"default_zone","scope":"runtime","name":"public"}
+ *   {"type":"direct_rule","scope":"runtime","ipv":"ipv4","table":"filter",
+ *    "chain":"INPUT","priority":0,"args":["-j","ACCEPT"]}
+ *   {"type":"passthrough","scope":"runtime","ipv":"ipv4","args":[...]}
+ *
+ * Objects are zones, services, ipsets, icmptypes and helpers, in both
+ * scopes. Records are sorted by scope, type and name, so that exports of
+ * equal configurations are equal.
+ *
+ * All D-Bus calls are pipelined with FWBatch. The import brings every
+ * object that is listed to the listed state, objects that are not listed
+ * are not touched. Runtime services, icmptypes and helpers can not be
+ * changed in firewalld, their records are ignored on import.
+ */
+
+#include <errno.h>
+#include <string.h>
+#include "fw_ndjson.h"
+#include "fw_batch.h"
+
+/* buffer size of the export stream */
+#define FW_NDJSON_BUFFER_SIZE  (64 * 1024)
+
+/* nesting limit of the parser */
+#define FW_NDJSON_MAX_DEPTH    32
+
+/* record types, the object types are the same as FWXmlType */
+enum {
+    FW_NDJSON_DEFAULT_ZONE = FW_XML_N_TYPES,
+    FW_NDJSON_DIRECT_RULE,
+    FW_NDJSON_PASSTHROUGH,
+    FW_NDJSON_N_TYPES
+};
+
+static const gchar *fw_ndjson_type_names[FW_NDJSON_N_TYPES] = {
+    "zone",
+    "service",
+    "ipset",
+    "icmptype",
+    "helper",
+    "default_zone",
+    "direct_rule",
+    "passthrough",
+};
+
+/* JSON member names of the settings fields, NULL for unused fields */
+
+static const gchar *fw_ndjson_zone_fields[] = {
+    "version", "short", "description", NULL, "target", "services", "ports",
+    "icmp_blocks", "masquerade", "forward_ports", "interfaces", "sources",
+    "rich_rules", "protocols", "source_ports", "icmp_block_inversion",
+};
+
+static const gchar *fw_ndjson_service_fields[] = {
+    "version", "short", "description", "ports", "modules", "destinations",
+    "protocols", "source_ports",
+};
+
+static const gchar *fw_ndjson_ipset_fields[] = {
+    "version", "short", "description", "type", "options", "entries",
+};
+
+static const gchar *fw_ndjson_icmptype_fields[] = {
+    "version", "short", "description", "destinations",
+};
+
+static const gchar *fw_ndjson_helper_fields[] = {
+    "version", "short", "description", "family", "module", "ports",
+};
+
+typedef struct {
+    const gchar **fields;
+    guint n_fields;
+
+    /* permanent */
+    const gchar *config_interface;
+    const gchar *names;
+    const gchar *by_name;
+    const gchar *add;
+
+    /* runtime */
+    const gchar *list_interface;
+    const gchar *list;
+    const gchar *get_interface;
+    const gchar *get;
+} FWNdjsonType;
+
+static const FWNdjsonType fw_ndjson_types[FW_XML_N_TYPES] = {
+    { fw_ndjson_zone_fields, G_N_ELEMENTS(fw_ndjson_zone_fields),
+      FW_DBUS_INTERFACE_CONFIG_ZONE,
+      "getZoneNames", "getZoneByName", "addZone",
+      FW_DBUS_INTERFACE_ZONE, "getZones",
+      FW_DBUS_INTERFACE, "getZoneSettings" },
+    { fw_ndjson_service_fields, G_N_ELEMENTS(fw_ndjson_service_fields),
+      FW_DBUS_INTERFACE_CONFIG_SERVICE,
+      "getServiceNames", "getServiceByName", "addService",
+      FW_DBUS_INTERFACE, "listServices",
+      FW_DBUS_INTERFACE, "getServiceSettings" },
+    { fw_ndjson_ipset_fields, G_N_ELEMENTS(fw_ndjson_ipset_fields),
+      FW_DBUS_INTERFACE_CONFIG_IPSET,
+      "getIPSetNames", "getIPSetByName", "addIPSet",
+      FW_DBUS_INTERFACE_IPSET, "getIPSets",
+      FW_DBUS_INTERFACE_IPSET, "getIPSetSettings" },
+    { fw_ndjson_icmptype_fields, G_N_ELEMENTS(fw_ndjson_icmptype_fields),
+      FW_DBUS_INTERFACE_CONFIG_ICMPTYPE,
+      "getIcmpTypeNames", "getIcmpTypeByName", "addIcmpType",
+      FW_DBUS_INTERFACE, "listIcmpTypes",
+      FW_DBUS_INTERFACE, "getIcmpTypeSettings" },
+    { fw_ndjson_helper_fields, G_N_ELEMENTS(fw_ndjson_helper_fields),
+      FW_DBUS_INTERFACE_CONFIG_HELPER,
+      "getHelperNames", "getHelperByName", "addHelper",
+      FW_DBUS_INTERFACE, "getHelpers",
+      FW_DBUS_INTERFACE, "getHelperSettings" },
+};
+
+/* runtime zone fields and the zone interface methods to change them */
+
+typedef struct {
+    guint index;
+    const gchar *add;
+    const gchar *remove;
+    gboolean timeout;		/* add method takes a timeout */
+} FWNdjsonZoneField;
+
+static const FWNdjsonZoneField fw_ndjson_zone_runtime_fields[] = {
+    { 5, "addService", "removeService", TRUE },
+    { 6, "addPort", "removePort", TRUE },
+    { 7, "addIcmpBlock", "removeIcmpBlock", TRUE },
+    { 8, "addMasquerade", "removeMasquerade", TRUE },
+    { 9, "addForwardPort", "removeForwardPort", TRUE },
+    { 10, "addInterface", "removeInterface", FALSE },
+    { 11, "addSource", "removeSource", FALSE },
+    { 12, "addRichRule", "removeRichRule", TRUE },
+    { 13, "addProtocol", "removeProtocol", TRUE },
+    { 14, "addSourcePort", "removeSourcePort", TRUE },
+    { 15, "addIcmpBlockInversion", "removeIcmpBlockInversion", FALSE },
+};
+
+#define FW_NDJSON_IPSET_ENTRIES  5
+
+/****************************************************************************/
+/* writer */
+
+static void
+_fw_ndjson_append_string(GString *str,
+			 const gchar *value)
+{
+    const gchar *p = value;
+
+    g_string_append_c(str, '"');
+    for (;;) {
+	const gchar *run = p;
+
+	while (*p != '\0' && *p != '"' && *p != '\\' && (guchar) *p >= 0x20)
+	    p++;
+	g_string_append_len(str, run, p - run);
+
+	switch (*p) {
+	case '\0':
+	    g_string_append_c(str, '"');
+	    return;
+	case '"':
+	    g_string_append(str, "\\\"");
+	    break;
+	case '\\':
+	    g_string_append(str, "\\\\");
+	    break;
+	case '\n':
+	    g_string_append(str, "\\n");
+	    break;
+	case '\r':
+	    g_string_append(str, "\\r");
+	    break;
+	case '\t':
+	    g_string_append(str, "\\t");
+	    break;
+	default:
+	    g_string_append_printf(str, "\\u%04x", (guchar) *p);
+	    break;
+	}
+	p++;
+    }
+}
+
+static void
+_fw_ndjson_append_value(GString *str,
+			GVariant *value)
+{
+    switch (g_variant_classify(value)) {
+    case G_VARIANT_CLASS_STRING:
+    case G_VARIANT_CLASS_OBJECT_PATH:
+	_fw_ndjson_append_string(str, g_variant_get_string(value, NULL));
+	break;
+
+    case G_VARIANT_CLASS_BOOLEAN:
+	g_string_append(str, g_variant_get_boolean(value) ? "true" : "false");
+	break;
+
+    case G_VARIANT_CLASS_INT32:
+	g_string_append_printf(str, "%d", g_variant_get_int32(value));
+	break;
+
+    case G_VARIANT_CLASS_VARIANT: {
+	GVariant *child = g_variant_get_variant(value);
+
+	_fw_ndjson_append_value(str, child);
+	g_variant_unref(child);
+	break;
+    }
+
+    case G_VARIANT_CLASS_ARRAY:
+    case G_VARIANT_CLASS_TUPLE: {
+	gboolean dict = g_variant_is_of_type(value, G_VARIANT_TYPE_DICTIONARY);
+	gsize i, n = g_variant_n_children(value);
+
+	g_string_append_c(str, dict ? '{' : '[');
+	for (i = 0; i < n; i++) {
+	    GVariant *child = g_variant_get_child_value(value, i);
+
+	    if (i > 0)
+		g_string_append_c(str, ',');
+	    if (dict) {
+		GVariant *key = g_variant_get_child_value(child, 0);
+		GVariant *val = g_variant_get_child_value(child, 1);
+
+		_fw_ndjson_append_value(str, key);
+		g_string_append_c(str, ':');
+		_fw_ndjson_append_value(str, val);
+		g_variant_unref(key);
+		g_variant_unref(val);
+	    } else {
+		_fw_ndjson_append_value(str, child);
+	    }
+	    g_variant_unref(child);
+	}
+	g_string_append_c(str, dict ? '}' : ']');
+	break;
+    }
+
+    default:
+	g_string_append(str, "null");
+	break;
+    }
+}
+
+/* Returns: the settings tuple of type in a reply or variant, new reference */
+static GVariant *
+_fw_ndjson_unwrap(FWXmlType type,
+		  GVariant *settings)
+{
+    const GVariantType *signature = G_VARIANT_TYPE(
+	fw_xml_type_get_signature(type));
+
+    g_variant_ref(settings);
+    while (!g_variant_is_of_type(settings, signature)) {
+	GVariant *child;
+
+	if (g_variant_is_of_type(settings, G_VARIANT_TYPE_VARIANT))
+	    child = g_variant_get_variant(settings);
+	else if (g_variant_is_of_type(settings, G_VARIANT_TYPE_TUPLE) &&
+		 g_variant_n_children(settings) == 1)
+	    child = g_variant_get_child_value(settings, 0);
+	else
+	    child = NULL;
+
+	g_variant_unref(settings);
+	if (child == NULL)
+	    return NULL;
+	settings = child;
+    }
+
+    return settings;
+}
+
+/**
+ * fw_ndjson_append_settings:
+ * @str: (type GString*): string to append to
+ * @type: object type
+ * @settings: (type GVariant*): settings of the object, as reply of
+ *   getSettings or as settings tuple
+ *
+ * Appends the settings as JSON object with named members.
+ */
+void
+fw_ndjson_append_settings(GString *str,
+			  FWXmlType type,
+			  GVariant *settings)
+{
+    const FWNdjsonType *info = &fw_ndjson_types[type];
+    GVariant *tuple = _fw_ndjson_unwrap(type, settings);
+    gboolean first = TRUE;
+    guint i;
+
+    if (tuple == NULL) {
+	g_string_append(str, "null");
+	return;
+    }
+
+    g_string_append_c(str, '{');
+    for (i = 0; i < info->n_fields; i++) {
+	GVariant *child;
+
+	if (info->fields[i] == NULL)
+	    continue;
+
+	if (!first)
+	    g_string_append_c(str, ',');
+	first = FALSE;
+
+	_fw_ndjson_append_string(str, info->fields[i]);
+	g_string_append_c(str, ':');
+	child = g_variant_get_child_value(tuple, i);
+	_fw_ndjson_append_value(str, child);
+	g_variant_unref(child);
+    }
+    g_string_append_c(str, '}');
+
+    g_variant_unref(tuple);
+}
+
+static void
+_fw_ndjson_append_header(GString *str,
+			 guint type,
+			 gboolean runtime)
+{
+    g_string_append(str, "{\"type\":");
+    _fw_ndjson_append_string(str, fw_ndjson_type_names[type]);
+    g_string_append(str, ",\"scope\":");
+    _fw_ndjson_append_string(str, runtime ? FW_NDJSON_SCOPE_RUNTIME :
+			     FW_NDJSON_SCOPE_PERMANENT);
+}
+
+static void
+_fw_ndjson_append_object(GString *str,
+			 FWXmlType type,
+			 gboolean runtime,
+			 const gchar *name,
+			 GVariant *settings)
+{
+    _fw_ndjson_append_header(str, type, runtime);
+    g_string_append(str, ",\"name\":");
+    _fw_ndjson_append_string(str, name);
+    g_string_append(str, ",\"settings\":");
+    fw_ndjson_append_settings(str, type, settings);
+    g_string_append_c(str, '}');
+}
+
+static void
+_fw_ndjson_append_direct_rule(GString *str,
+			      GVariant *rule)
+{
+    const gchar *ipv, *table, *chain;
+    gint32 priority;
+    GVariant *args;
+
+    g_variant_get(rule, "(&s&s&si@as)", &ipv, &table, &chain, &priority,
+		  &args);
+
+    _fw_ndjson_append_header(str, FW_NDJSON_DIRECT_RULE, TRUE);
+    g_string_append(str, ",\"ipv\":");
+    _fw_ndjson_append_string(str, ipv);
+    g_string_append(str, ",\"table\":");
+    _fw_ndjson_append_string(str, table);
+    g_string_append(str, ",\"chain\":");
+    _fw_ndjson_append_string(str, chain);
+    g_string_append_printf(str, ",\"priority\":%d,\"args\":", priority);
+    _fw_ndjson_append_value(str, args);
+    g_string_append_c(str, '}');
+
+    g_variant_unref(args);
+}
+
+static void
+_fw_ndjson_append_passthrough(GString *str,
+			      GVariant *passthrough)
+{
+    const gchar *ipv;
+    GVariant *args;
+
+    g_variant_get(passthrough, "(&s@as)", &ipv, &args);
+
+    _fw_ndjson_append_header(str, FW_NDJSON_PASSTHROUGH, TRUE);
+    g_string_append(str, ",\"ipv\":");
+    _fw_ndjson_append_string(str, ipv);
+    g_string_append(str, ",\"args\":");
+    _fw_ndjson_append_value(str, args);
+    g_string_append_c(str, '}');
+
+    g_variant_unref(args);
+}
+
+/****************************************************************************/
+/* parser */
+
+/*
+ * JSON values are parsed into plain variants first: objects become a{sv},
+ * arrays av, integers x, other numbers d and null an empty mv. These are
+ * converted to the settings types afterwards.
+ */
+
+typedef struct {
+    const gchar *start;
+    const gchar *p;
+    GError **error;
+} FWNdjsonParser;
+
+static gpointer
+_fw_ndjson_fail(FWNdjsonParser *parser,
+		const gchar *message)
+{
+    g_set_error(parser->error, G_IO_ERROR, G_IO_ERROR_INVALID_DATA,
+		"column %ld: %s", (glong) (parser->p - parser->start) + 1,
+		message);
+    return NULL;
+}
+
+static void
+_fw_ndjson_skip_space(FWNdjsonParser *parser)
+{
+    while (*parser->p == ' ' || *parser->p == '\t' || *parser->p == '\n' ||
+	   *parser->p == '\r')
+	parser->p++;
+}
+
+static gint
+_fw_ndjson_parse_hex4(FWNdjsonParser *parser)
+{
+    gint value = 0;
+    gint i;
+
+    for (i = 0; i < 4; i++) {
+	gint digit = g_ascii_xdigit_value(parser->p[i]);
+
+	if (digit < 0)
+	    return -1;
+	value = value * 16 + digit;
+    }
+    parser->p += 4;
+
+    return value;
+}
+
+static gchar *
+_fw_ndjson_parse_string(FWNdjsonParser *parser)
+{
+    GString *str;
+
+    if (*parser->p != '"')
+	return _fw_ndjson_fail(parser, "string expected");
+    parser->p++;
+
+    str = g_string_new(NULL);
+    for (;;) {
+	const gchar *run = parser->p;
+	gint c;
+
+	while (*parser->p != '"' && *parser->p != '\\' &&
+	       (guchar) *parser->p >= 0x20)
+	    parser->p++;
+	g_string_append_len(str, run, parser->p - run);
+
+	if (*parser->p == '"') {
+	    parser->p++;
+	    return g_string_free(str, FALSE);
+	}
+	if (*parser->p != '\\') {
+	    g_string_free(str, TRUE);
+	    return _fw_ndjson_fail(parser, "unterminated string");
+	}
+	parser->p++;
+
+	switch (*parser->p++) {
+	case '"':  g_string_append_c(str, '"'); break;
+	case '\\': g_string_append_c(str, '\\'); break;
+	case '/':  g_string_append_c(str, '/'); break;
+	case 'b':  g_string_append_c(str, '\b'); break;
+	case 'f':  g_string_append_c(str, '\f'); break;
+	case 'n':  g_string_append_c(str, '\n'); break;
+	case 'r':  g_string_append_c(str, '\r'); break;
+	case 't':  g_string_append_c(str, '\t'); break;
+	case 'u':
+	    c = _fw_ndjson_parse_hex4(parser);
+	    if (c >= 0xd800 && c < 0xdc00) {
+		gint low = -1;
+
+		/* surrogate pair */
+		if (parser->p[0] == '\\' && parser->p[1] == 'u') {
+		    parser->p += 2;
+		    low = _fw_ndjson_parse_hex4(parser);
+		}
+		if (low < 0xdc00 || low >= 0xe000)
+		    c = -1;
+		else
+		    c = 0x10000 + ((c - 0xd800) << 10) + (low - 0xdc00);
+	    } else if (c >= 0xdc00 && c < 0xe000) {
+		c = -1;
+	    }
+	    if (c <= 0) {
+		g_string_free(str, TRUE);
+		return _fw_ndjson_fail(parser, "invalid unicode escape");
+	    }
+	    g_string_append_unichar(str, c);
+	    break;
+	default:
+	    parser->p--;
+	    g_string_free(str, TRUE);
+	    return _fw_ndjson_fail(parser, "invalid escape");
+	}
+    }
+}
+
+static GVariant *
+_fw_ndjson_parse_number(FWNdjsonParser *parser)
+{
+    const gchar *start = parser->p;
+    gboolean integer = TRUE;
+    gchar *end;
+
+    if (*parser->p == '-')
+	parser->p++;
+    if (!g_ascii_isdigit(*parser->p))
+	return _fw_ndjson_fail(parser, "invalid value");
+    while (g_ascii_isdigit(*parser->p) || *parser->p == '.' ||
+	   *parser->p == 'e' || *parser->p == 'E' ||
+	   *parser->p == '+' || *parser->p == '-')
+    {
+	if (!g_ascii_isdigit(*parser->p))
+	    integer = FALSE;
+	parser->p++;
+    }
+
+    if (integer) {
+	gint64 value;
+
+	errno = 0;
+	value = g_ascii_strtoll(start, &end, 10);
+	if (errno == 0 && end == parser->p)
+	    return g_variant_new_int64(value);
+    } else {
+	gdouble value = g_ascii_strtod(start, &end);
+
+	if (end == parser->p)
+	    return g_variant_new_double(value);
+    }
+
+    parser->p = start;
+    return _fw_ndjson_fail(parser, "invalid number");
+}
+
+static GVariant *
+_fw_ndjson_parse_value(FWNdjsonParser *parser,
+		       guint depth)
+{
+    GVariantBuilder builder;
+    gboolean object;
+
+    _fw_ndjson_skip_space(parser);
+
+    if (depth > FW_NDJSON_MAX_DEPTH)
+	return _fw_ndjson_fail(parser, "nesting too deep");
+
+    switch (*parser->p) {
+    case '"': {
+	gchar *str = _fw_ndjson_parse_string(parser);
+
+	if (str == NULL)
+	    return NULL;
+	return g_variant_new_take_string(str);
+    }
+
+    case 't':
+	if (strncmp(parser->p, "true", 4) != 0)
+	    return _fw_ndjson_fail(parser, "invalid value");
+	parser->p += 4;
+	return g_variant_new_boolean(TRUE);
+
+    case 'f':
+	if (strncmp(parser->p, "false", 5) != 0)
+	    return _fw_ndjson_fail(parser, "invalid value");
+	parser->p += 5;
+	return g_variant_new_boolean(FALSE);
+
+    case 'n':
+	if (strncmp(parser->p, "null", 4) != 0)
+	    return _fw_ndjson_fail(parser, "invalid value");
+	parser->p += 4;
+	return g_variant_new_maybe(G_VARIANT_TYPE_VARIANT, NULL);
+
+    case '{':
+    case '[':
+	break;
+
+    default:
+	return _fw_ndjson_parse_number(parser);
+    }
+
+    object = (*parser->p == '{');
+    parser->p++;
+
+    g_variant_builder_init(&builder, object ? G_VARIANT_TYPE_VARDICT :
+			   G_VARIANT_TYPE("av"));
+
+    _fw_ndjson_skip_space(parser);
+    if (*parser->p == (object ? '}' : ']')) {
+	parser->p++;
+	return g_variant_builder_end(&builder);
+    }
+
+    for (;;) {
+	gchar *key = NULL;
+	GVariant *value;
+
+	if (object) {
+	    _fw_ndjson_skip_space(parser);
+	    key = _fw_ndjson_parse_string(parser);
+	    if (key == NULL) {
+		g_variant_builder_clear(&builder);
+		return NULL;
+	    }
+	    _fw_ndjson_skip_space(parser);
+	    if (*parser->p != ':') {
+		g_free(key);
+		g_variant_builder_clear(&builder);
+		return _fw_ndjson_fail(parser, "':' expected");
+	    }
+	    parser->p++;
+	}
+
+	value = _fw_ndjson_parse_value(parser, depth + 1);
+	if (value == NULL) {
+	    g_free(key);
+	    g_variant_builder_clear(&builder);
+	    return NULL;
+	}
+
+	if (object) {
+	    g_variant_builder_add(&builder, "{sv}", key, value);
+	    g_free(key);
+	} else {
+	    g_variant_builder_add(&builder, "v", value);
+	}
+
+	_fw_ndjson_skip_space(parser);
+	if (*parser->p == ',') {
+	    parser->p++;
+	} else if (*parser->p == (object ? '}' : ']')) {
+	    parser->p++;
+	    return g_variant_builder_end(&builder);
+	} else {
+	    g_variant_builder_clear(&builder);
+	    return _fw_ndjson_fail(parser, object ? "',' or '}' expected" :
+				   "',' or ']' expected");
+	}
+    }
+}
+
+/* Returns: the parsed line as plain variant with a full reference */
+static GVariant *
+_fw_ndjson_parse(const gchar *json,
+		 GError **error)
+{
+    FWNdjsonParser parser = { json, json, error };
+    GVariant *value;
+
+    if (!g_utf8_validate(json, -1, NULL)) {
+	g_set_error(error, G_IO_ERROR, G_IO_ERROR_INVALID_DATA,
+		    "invalid UTF-8");
+	return NULL;
+    }
+
+    value = _fw_ndjson_parse_value(&parser, 0);
+    if (value == NULL)
+	return NULL;
+    g_variant_ref_sink(value);
+
+    _fw_ndjson_skip_space(&parser);
+    if (*parser.p != '\0') {
+	g_variant_unref(value);
+	return _fw_ndjson_fail(&parser, "garbage after value");
+    }
+
+    return value;
+}
+
+/* Returns: value converted to type, a floating reference */
+static GVariant *
+_fw_ndjson_convert(GVariant *value,
+		   const GVariantType *type,
+		   const gchar *member,
+		   GError **error)
+{
+    GVariantBuilder builder;
+    GVariantIter iter;
+    GVariant *child;
+    const GVariantType *item = NULL;
+
+    if (g_variant_type_equal(type, G_VARIANT_TYPE_STRING)) {
+	if (g_variant_is_of_type(value, type))
+	    return g_variant_new_string(g_variant_get_string(value, NULL));
+    }
+    else if (g_variant_type_equal(type, G_VARIANT_TYPE_BOOLEAN)) {
+	if (g_variant_is_of_type(value, type))
+	    return g_variant_new_boolean(g_variant_get_boolean(value));
+    }
+    else if (g_variant_type_equal(type, G_VARIANT_TYPE("i"))) {
+	if (g_variant_is_of_type(value, G_VARIANT_TYPE("x"))) {
+	    gint64 number = g_variant_get_int64(value);
+
+	    if (number >= G_MININT32 && number <= G_MAXINT32)
+		return g_variant_new_int32(number);
+	}
+    }
+    else if (g_variant_type_is_subtype_of(type, G_VARIANT_TYPE_DICTIONARY)) {
+	if (g_variant_is_of_type(value, G_VARIANT_TYPE_VARDICT)) {
+	    const gchar *key;
+
+	    g_variant_builder_init(&builder, type);
+	    g_variant_iter_init(&iter, value);
+	    while (g_variant_iter_next(&iter, "{&sv}", &key, &child)) {
+		GVariant *converted = _fw_ndjson_convert(
+		    child, g_variant_type_value(g_variant_type_element(type)),
+		    member, error);
+
+		g_variant_unref(child);
+		if (converted == NULL) {
+		    g_variant_builder_clear(&builder);
+		    return NULL;
+		}
+		g_variant_builder_add_value(
+		    &builder,
+		    g_variant_new_dict_entry(g_variant_new_string(key),
+					     converted));
+	    }
+	    return g_variant_builder_end(&builder);
+	}
+    }
+    else if (g_variant_type_is_array(type) ||
+	     g_variant_type_is_tuple(type))
+    {
+	gboolean tuple = g_variant_type_is_tuple(type);
+
+	if (g_variant_is_of_type(value, G_VARIANT_TYPE("av")) &&
+	    (!tuple || g_variant_n_children(value) ==
+	     g_variant_type_n_items(type)))
+	{
+	    g_variant_builder_init(&builder, type);
+	    if (tuple)
+		item = g_variant_type_first(type);
+	    g_variant_iter_init(&iter, value);
+	    while (g_variant_iter_next(&iter, "v", &child)) {
+		GVariant *converted = _fw_ndjson_convert(
+		    child, tuple ? item : g_variant_type_element(type),
+		    member, error);
+
+		g_variant_unref(child);
+		if (converted == NULL) {
+		    g_variant_builder_clear(&builder);
+		    return NULL;
+		}
+		g_variant_builder_add_value(&builder, converted);
+		if (tuple)
+		    item = g_variant_type_next(item);
+	    }
+	    return g_variant_builder_end(&builder);
+	}
+    }
+
+    if (error != NULL && *error == NULL) {
+	gchar *expected = g_variant_type_dup_string(type);
+
+	g_set_error(error, G_IO_ERROR, G_IO_ERROR_INVALID_DATA,
+		    "'%s': value of type '%s' expected", member, expected);
+	g_free(expected);
+    }
+    return NULL;
+}
+
+/* Returns: default value of a settings field that is not in the record */
+static GVariant *
+_fw_ndjson_default(FWXmlType type,
+		   guint index,
+		   const GVariantType *item)
+{
+    if (g_variant_type_equal(item, G_VARIANT_TYPE_STRING)) {
+	/* firewalld does not know an empty zone target */
+	if (type == FW_XML_ZONE && index == 4)
+	    return g_variant_new_string("default");
+	return g_variant_new_string("");
+    }
+    if (g_variant_type_equal(item, G_VARIANT_TYPE_BOOLEAN))
+	return g_variant_new_boolean(FALSE);
+
+    return g_variant_new_array(g_variant_type_element(item), NULL, 0);
+}
+
+/* Returns: settings tuple from JSON object, a floating reference */
+static GVariant *
+_fw_ndjson_settings_from_object(FWXmlType type,
+				GVariant *object,
+				GError **error)
+{
+    const FWNdjsonType *info = &fw_ndjson_types[type];
+    const GVariantType *item;
+    GVariantBuilder builder;
+    guint i;
+
+    if (!g_variant_is_of_type(object, G_VARIANT_TYPE_VARDICT)) {
+	g_set_error(error, G_IO_ERROR, G_IO_ERROR_INVALID_DATA,
+		    "'settings': object expected");
+	return NULL;
+    }
+
+    g_variant_builder_init(&builder,
+			   G_VARIANT_TYPE(fw_xml_type_get_signature(type)));
+
+    item = g_variant_type_first(
+	G_VARIANT_TYPE(fw_xml_type_get_signature(type)));
+    for (i = 0; item != NULL; i++, item = g_variant_type_next(item)) {
+	GVariant *member = NULL;
+	GVariant *value;
+
+	if (info->fields[i] != NULL)
+	    member = g_variant_lookup_value(object, info->fields[i], NULL);
+	if (member != NULL &&
+	    g_variant_classify(member) == G_VARIANT_CLASS_MAYBE)
+	{
+	    g_variant_unref(member);
+	    member = NULL;
+	}
+
+	if (member == NULL) {
+	    value = _fw_ndjson_default(type, i, item);
+	} else {
+	    value = _fw_ndjson_convert(member, item, info->fields[i], error);
+	    g_variant_unref(member);
+	}
+
+	if (value == NULL) {
+	    g_variant_builder_clear(&builder);
+	    return NULL;
+	}
+	g_variant_builder_add_value(&builder, value);
+    }
+
+    return g_variant_builder_end(&builder);
+}
+
+/**
+ * fw_ndjson_parse_settings:
+ * @type: object type
+ * @json: (type utf8): JSON object as written by fw_ndjson_append_settings
+ * @error: (allow-none): return location for an error
+ *
+ * Returns: (transfer full) (allow-none) (type GVariant*): settings tuple
+ */
+GVariant *
+fw_ndjson_parse_settings(FWXmlType type,
+			 const gchar *json,
+			 GError **error)
+{
+    GVariant *object, *settings;
+
+    object = _fw_ndjson_parse(json, error);
+    if (object == NULL)
+	return NULL;
+
+    settings = _fw_ndjson_settings_from_object(type, object, error);
+    g_variant_unref(object);
+
+    if (settings == NULL)
+	return NULL;
+    return g_variant_ref_sink(settings);
+}
+
+/****************************************************************************/
+/* records */
+
+typedef struct {
+    guint type;
+    gboolean runtime;
+    gchar *name;
+    GVariant *value;		/* settings, (sssias) rule or (sas) passthrough */
+
+    /* import state */
+    guint call;			/* batch index of the lookup */
+    gchar *path;		/* permanent object path */
+    GVariant *current;		/* current settings */
+} FWNdjsonRecord;
+
+static void
+_fw_ndjson_record_free(gpointer data)
+{
+    FWNdjsonRecord *record = data;
+
+    g_free(record->name);
+    g_free(record->path);
+    if (record->value != NULL)
+	g_variant_unref(record->value);
+    if (record->current != NULL)
+	g_variant_unref(record->current);
+    g_slice_free(FWNdjsonRecord, record);
+}
+
+/* Returns: member converted to type, a full reference */
+static GVariant *
+_fw_ndjson_lookup(GVariant *object,
+		  const gchar *member,
+		  const gchar *type,
+		  GError **error)
+{
+    GVariant *value, *converted;
+
+    value = g_variant_lookup_value(object, member, NULL);
+    if (value == NULL) {
+	g_set_error(error, G_IO_ERROR, G_IO_ERROR_INVALID_DATA,
+		    "'%s' missing", member);
+	return NULL;
+    }
+
+    converted = _fw_ndjson_convert(value, G_VARIANT_TYPE(type), member, error);
+    g_variant_unref(value);
+    if (converted == NULL)
+	return NULL;
+
+    return g_variant_ref_sink(converted);
+}
+
+static FWNdjsonRecord *
+_fw_ndjson_record_parse(const gchar *line,
+			GError **error)
+{
+    FWNdjsonRecord *record;
+    GVariant *object, *value;
+    GError *local_error = NULL;
+    const gchar *str;
+    guint type;
+
+    object = _fw_ndjson_parse(line, error);
+    if (object == NULL)
+	return NULL;
+    if (!g_variant_is_of_type(object, G_VARIANT_TYPE_VARDICT)) {
+	g_variant_unref(object);
+	g_set_error(error, G_IO_ERROR, G_IO_ERROR_INVALID_DATA,
+		    "record is not an object");
+	return NULL;
+    }
+
+    if (!g_variant_lookup(object, "type", "&s", &str)) {
+	g_variant_unref(object);
+	g_set_error(error, G_IO_ERROR, G_IO_ERROR_INVALID_DATA,
+		    "'type' missing");
+	return NULL;
+    }
+    for (type = 0; type < FW_NDJSON_N_TYPES; type++) {
+	if (strcmp(str, fw_ndjson_type_names[type]) == 0)
+	    break;
+    }
+    if (type == FW_NDJSON_N_TYPES) {
+	g_set_error(error, G_IO_ERROR, G_IO_ERROR_INVALID_DATA,
+		    "unknown type '%s'", str);
+	g_variant_unref(object);
+	return NULL;
+    }
+
+    record = g_slice_new0(FWNdjsonRecord);
+    record->type = type;
+
+    /* default zone, direct rules and passthroughs are runtime only */
+    record->runtime = (type >= FW_XML_N_TYPES);
+    if (g_variant_lookup(object, "scope", "&s", &str)) {
+	if (strcmp(str, FW_NDJSON_SCOPE_RUNTIME) == 0)
+	    record->runtime = TRUE;
+	else if (strcmp(str, FW_NDJSON_SCOPE_PERMANENT) != 0 ||
+		 type >= FW_XML_N_TYPES)
+	    g_set_error(&local_error, G_IO_ERROR, G_IO_ERROR_INVALID_DATA,
+			"invalid scope '%s'", str);
+    } else if (type < FW_XML_N_TYPES) {
+	g_set_error(&local_error, G_IO_ERROR, G_IO_ERROR_INVALID_DATA,
+		    "'scope' missing");
+    }
+
+    if (local_error == NULL &&
+	(type < FW_XML_N_TYPES || type == FW_NDJSON_DEFAULT_ZONE))
+    {
+	if (!g_variant_lookup(object, "name", "s", &record->name)) {
+	    g_set_error(&local_error, G_IO_ERROR, G_IO_ERROR_INVALID_DATA,
+			"'name' missing");
+	} else if (type < FW_XML_N_TYPES) {
+	    value = g_variant_lookup_value(object, "settings", NULL);
+	    if (value == NULL) {
+		g_set_error(&local_error, G_IO_ERROR,
+			    G_IO_ERROR_INVALID_DATA, "'settings' missing");
+	    } else {
+		record->value = _fw_ndjson_settings_from_object(
+		    type, value, &local_error);
+		if (record->value != NULL)
+		    g_variant_ref_sink(record->value);
+		g_variant_unref(value);
+	    }
+	}
+    } else if (local_error == NULL) {
+	const gchar *members[] = { "ipv", "table", "chain", "priority",
+				   "args" };
+	const gchar *types[] = { "s", "s", "s", "i", "as" };
+	GVariant *items[G_N_ELEMENTS(members)];
+	guint i, n = 0;
+
+	for (i = 0; i < G_N_ELEMENTS(members); i++) {
+	    /* passthroughs only have ipv and args */
+	    if (type == FW_NDJSON_PASSTHROUGH && i > 0 && i < 4)
+		continue;
+	    items[n] = _fw_ndjson_lookup(object, members[i], types[i],
+					 &local_error);
+	    if (items[n] == NULL)
+		break;
+	    n++;
+	}
+	if (local_error == NULL)
+	    record->value = g_variant_ref_sink(g_variant_new_tuple(items, n));
+	for (i = 0; i < n; i++)
+	    g_variant_unref(items[i]);
+    }
+    g_variant_unref(object);
+
+    if (local_error != NULL) {
+	g_propagate_error(error, local_error);
+	_fw_ndjson_record_free(record);
+	return NULL;
+    }
+
+    return record;
+}
+
+/****************************************************************************/
+/* export */
+
+typedef struct {
+    GPtrArray *names[2][FW_XML_N_TYPES];  /* sorted names per scope */
+    guint lists[2][FW_XML_N_TYPES];	  /* batch index of the list call */
+    guint settings[2][FW_XML_N_TYPES];	  /* batch index of the first get */
+    guint paths[FW_XML_N_TYPES];	  /* batch index of the first path */
+    guint default_zone;
+    guint direct_rules;
+    guint passthroughs;
+} FWNdjsonExport;
+
+static gint
+_fw_ndjson_str_compare(gconstpointer a,
+		       gconstpointer b)
+{
+    return strcmp(*(const gchar **) a, *(const gchar **) b);
+}
+
+/* Returns: sorted names of a (as) reply */
+static GPtrArray *
+_fw_ndjson_get_names(GVariant *reply)
+{
+    GPtrArray *names = g_ptr_array_new_with_free_func(g_free);
+    GVariantIter *iter;
+    gchar *name;
+
+    g_variant_get(reply, "(as)", &iter);
+    while (g_variant_iter_next(iter, "s", &name))
+	g_ptr_array_add(names, name);
+    g_variant_iter_free(iter);
+
+    g_ptr_array_sort(names, _fw_ndjson_str_compare);
+
+    return names;
+}
+
+static gboolean
+_fw_ndjson_write_line(GOutputStream *stream,
+		      GString *line,
+		      GError **error)
+{
+    gboolean ok;
+
+    g_string_append_c(line, '\n');
+    ok = g_output_stream_write_all(stream, line->str, line->len, NULL, NULL,
+				   error);
+    g_string_truncate(line, 0);
+
+    return ok;
+}
+
+static gboolean
+_fw_ndjson_export_write(FWNdjsonExport *export,
+			FWBatch *batch,
+			GOutputStream *stream,
+			GError **error)
+{
+    GString *line = g_string_sized_new(4096);
+    GVariant *reply, *list, *child;
+    gboolean ok = TRUE;
+    guint scope, type, i;
+    GVariantIter iter;
+
+    for (scope = 0; scope < 2 && ok; scope++) {
+	if (scope == 1) {
+	    const gchar *name;
+
+	    reply = fw_batch_getResult(batch, export->default_zone);
+	    g_variant_get(reply, "(&s)", &name);
+	    _fw_ndjson_append_header(line, FW_NDJSON_DEFAULT_ZONE, TRUE);
+	    g_string_append(line, ",\"name\":");
+	    _fw_ndjson_append_string(line, name);
+	    g_string_append_c(line, '}');
+	    ok = _fw_ndjson_write_line(stream, line, error);
+	}
+
+	for (type = 0; type < FW_XML_N_TYPES && ok; type++) {
+	    GPtrArray *names = export->names[scope][type];
+
+	    for (i = 0; i < names->len && ok; i++) {
+		reply = fw_batch_getResult(batch,
+					   export->settings[scope][type] + i);
+		_fw_ndjson_append_object(line, type, scope,
+					 g_ptr_array_index(names, i), reply);
+		ok = _fw_ndjson_write_line(stream, line, error);
+	    }
+	}
+    }
+
+    reply = fw_batch_getResult(batch, export->direct_rules);
+    list = g_variant_get_child_value(reply, 0);
+    g_variant_iter_init(&iter, list);
+    while (ok && (child = g_variant_iter_next_value(&iter)) != NULL) {
+	_fw_ndjson_append_direct_rule(line, child);
+	ok = _fw_ndjson_write_line(stream, line, error);
+	g_variant_unref(child);
+    }
+    g_variant_unref(list);
+
+    reply = fw_batch_getResult(batch, export->passthroughs);
+    list = g_variant_get_child_value(reply, 0);
+    g_variant_iter_init(&iter, list);
+    while (ok && (child = g_variant_iter_next_value(&iter)) != NULL) {
+	_fw_ndjson_append_passthrough(line, child);
+	ok = _fw_ndjson_write_line(stream, line, error);
+	g_variant_unref(child);
+    }
+    g_variant_unref(list);
+
+    g_string_free(line, TRUE);
+
+    return ok;
+}
+
+/**
+ * fw_ndjson_export:
+ * @client: (type FWClient*): a FWClient instance
+ * @stream: (type GOutputStream*): stream to write to, it is not closed
+ * @error: (allow-none): return location for an error
+ *
+ * Writes all permanent and runtime zones, services, ipsets, icmptypes and
+ * helpers, the default zone, the direct rules and the passthroughs as
+ * newline delimited JSON. The configuration is read with three rounds of
+ * pipelined calls, nothing is written if one of the calls fails.
+ *
+ * Returns: TRUE on success
+ */
+gboolean
+fw_ndjson_export(FWClient *client,
+		 GOutputStream *stream,
+		 GError **error)
+{
+    FWBatch *batch = fw_batch_new(fw_client_getConnection(client));
+    FWNdjsonExport export;
+    GOutputStream *buffered;
+    gboolean ok;
+    guint scope, type, i;
+
+#ifdef FW_DEBUG
+    g_printerr("fw_ndjson_export()\n");
+#endif
+
+    memset(&export, 0, sizeof(export));
+
+    /* names */
+    for (type = 0; type < FW_XML_N_TYPES; type++) {
+	const FWNdjsonType *info = &fw_ndjson_types[type];
+
+	export.lists[0][type] = fw_batch_add(batch, FW_DBUS_PATH_CONFIG,
+					     FW_DBUS_INTERFACE_CONFIG,
+					     info->names, NULL);
+	export.lists[1][type] = fw_batch_add(batch, FW_DBUS_PATH,
+					     info->list_interface, info->list,
+					     NULL);
+    }
+    export.default_zone = fw_batch_add(batch, FW_DBUS_PATH, FW_DBUS_INTERFACE,
+				       "getDefaultZone", NULL);
+    export.direct_rules = fw_batch_add(batch, FW_DBUS_PATH,
+				       FW_DBUS_INTERFACE_DIRECT,
+				       "getAllRules", NULL);
+    export.passthroughs = fw_batch_add(batch, FW_DBUS_PATH,
+				       FW_DBUS_INTERFACE_DIRECT,
+				       "getAllPassthroughs", NULL);
+    ok = fw_batch_run(batch, error);
+
+    /* runtime settings and permanent object paths */
+    for (type = 0; type < FW_XML_N_TYPES && ok; type++) {
+	const FWNdjsonType *info = &fw_ndjson_types[type];
+
+	for (scope = 0; scope < 2; scope++) {
+	    GPtrArray *names = _fw_ndjson_get_names(
+		fw_batch_getResult(batch, export.lists[scope][type]));
+
+	    export.names[scope][type] = names;
+	    export.settings[scope][type] = fw_batch_getLength(batch);
+	    for (i = 0; i < names->len; i++) {
+		const gchar *name = g_ptr_array_index(names, i);
+
+		if (scope == 0)
+		    fw_batch_add(batch, FW_DBUS_PATH_CONFIG,
+				 FW_DBUS_INTERFACE_CONFIG, info->by_name,
+				 g_variant_new("(s)", name));
+		else
+		    fw_batch_add(batch, FW_DBUS_PATH, info->get_interface,
+				 info->get, g_variant_new("(s)", name));
+	    }
+	}
+    }
+    if (ok)
+	ok = fw_batch_run(batch, error);
+
+    /* permanent settings */
+    for (type = 0; type < FW_XML_N_TYPES && ok; type++) {
+	GPtrArray *names = export.names[0][type];
+	guint first = export.settings[0][type];
+
+	export.paths[type] = first;
+	export.settings[0][type] = fw_batch_getLength(batch);
+	for (i = 0; i < names->len; i++) {
+	    const gchar *path;
+
+	    g_variant_get(fw_batch_getResult(batch, first + i), "(&o)", &path);
+	    fw_batch_add(batch, path, fw_ndjson_types[type].config_interface,
+			 "getSettings", NULL);
+	}
+    }
+    if (ok)
+	ok = fw_batch_run(batch, error);
+
+    if (ok) {
+	buffered = g_buffered_output_stream_new_sized(stream,
+						      FW_NDJSON_BUFFER_SIZE);
+	g_filter_output_stream_set_close_base_stream(
+	    G_FILTER_OUTPUT_STREAM(buffered), FALSE);
+
+	ok = _fw_ndjson_export_write(&export, batch, buffered, error);
+	if (ok)
+	    ok = g_output_stream_flush(buffered, NULL, error);
+	g_object_unref(buffered);
+    }
+
+    if (!ok && error != NULL && *error != NULL)
+	g_print(_("ERROR: export failed: %s\n"), (*error)->message);
+
+    for (scope = 0; scope < 2; scope++) {
+	for (type = 0; type < FW_XML_N_TYPES; type++) {
+	    if (export.names[scope][type] != NULL)
+		g_ptr_array_unref(export.names[scope][type]);
+	}
+    }
+    g_object_unref(batch);
+
+    return ok;
+}
+
+/****************************************************************************/
+/* import */
+
+static guint
+_fw_ndjson_variant_hash(gconstpointer v)
+{
+    GVariant *variant = (GVariant *) v;
+    GVariantIter iter;
+    GVariant *child;
+    guint hash = 5381;
+
+    if (!g_variant_is_container(variant))
+	return g_variant_hash(variant);
+
+    g_variant_iter_init(&iter, variant);
+    while ((child = g_variant_iter_next_value(&iter)) != NULL) {
+	hash = hash * 33 + _fw_ndjson_variant_hash(child);
+	g_variant_unref(child);
+    }
+
+    return hash;
+}
+
+/* Returns: set of the children of an array */
+static GHashTable *
+_fw_ndjson_set_new(GVariant *array)
+{
+    GHashTable *set = g_hash_table_new_full(_fw_ndjson_variant_hash,
+					    g_variant_equal,
+					    (GDestroyNotify) g_variant_unref,
+					    NULL);
+    GVariantIter iter;
+    GVariant *child;
+
+    g_variant_iter_init(&iter, array);
+    while ((child = g_variant_iter_next_value(&iter)) != NULL)
+	g_hash_table_add(set, child);
+
+    return set;
+}
+
+/* Returns: parameters (name, item..., [timeout]) for the zone interface */
+static GVariant *
+_fw_ndjson_item_params(const gchar *name,
+		       GVariant *item,
+		       gboolean timeout)
+{
+    GVariantBuilder builder;
+
+    g_variant_builder_init(&builder, G_VARIANT_TYPE_TUPLE);
+    g_variant_builder_add(&builder, "s", name);
+    if (item != NULL && g_variant_is_of_type(item, G_VARIANT_TYPE_TUPLE)) {
+	GVariantIter iter;
+	GVariant *child;
+
+	g_variant_iter_init(&iter, item);
+	while ((child = g_variant_iter_next_value(&iter)) != NULL) {
+	    g_variant_builder_add_value(&builder, child);
+	    g_variant_unref(child);
+	}
+    } else if (item != NULL) {
+	g_variant_builder_add_value(&builder, item);
+    }
+    if (timeout)
+	g_variant_builder_add(&builder, "i", 0);
+
+    return g_variant_builder_end(&builder);
+}
+
+/* queues method for all items of array that are not in the array other */
+static void
+_fw_ndjson_queue_missing(FWBatch *batch,
+			 const gchar *interface,
+			 const gchar *method_name,
+			 const gchar *name,
+			 GVariant *array,
+			 GVariant *other,
+			 gboolean timeout)
+{
+    GHashTable *set = _fw_ndjson_set_new(other);
+    GVariantIter iter;
+    GVariant *child;
+
+    g_variant_iter_init(&iter, array);
+    while ((child = g_variant_iter_next_value(&iter)) != NULL) {
+	if (!g_hash_table_contains(set, child))
+	    fw_batch_add(batch, FW_DBUS_PATH, interface, method_name,
+			 _fw_ndjson_item_params(name, child, timeout));
+	g_variant_unref(child);
+    }
+
+    g_hash_table_destroy(set);
+}
+
+/* queues the changes of a runtime zone, removals or additions */
+static void
+_fw_ndjson_queue_zone(FWBatch *batch,
+		      FWNdjsonRecord *record,
+		      gboolean add)
+{
+    guint i;
+
+    for (i = 0; i < G_N_ELEMENTS(fw_ndjson_zone_runtime_fields); i++) {
+	const FWNdjsonZoneField *field = &fw_ndjson_zone_runtime_fields[i];
+	GVariant *current = g_variant_get_child_value(record->current,
+						      field->index);
+	GVariant *wanted = g_variant_get_child_value(record->value,
+						     field->index);
+
+	if (g_variant_is_of_type(wanted, G_VARIANT_TYPE_BOOLEAN)) {
+	    gboolean enable = g_variant_get_boolean(wanted);
+
+	    if (enable != g_variant_get_boolean(current) && enable == add)
+		fw_batch_add(batch, FW_DBUS_PATH, FW_DBUS_INTERFACE_ZONE,
+			     add ? field->add : field->remove,
+			     _fw_ndjson_item_params(record->name, NULL,
+						    add && field->timeout));
+	} else if (add) {
+	    _fw_ndjson_queue_missing(batch, FW_DBUS_INTERFACE_ZONE, field->add,
+				     record->name, wanted, current,
+				     field->timeout);
+	} else {
+	    _fw_ndjson_queue_missing(batch, FW_DBUS_INTERFACE_ZONE,
+				     field->remove, record->name, current,
+				     wanted, FALSE);
+	}
+
+	g_variant_unref(current);
+	g_variant_unref(wanted);
+    }
+}
+
+static void
+_fw_ndjson_queue_ipset(FWBatch *batch,
+		       FWNdjsonRecord *record,
+		       gboolean add)
+{
+    GVariant *current = g_variant_get_child_value(record->current,
+						  FW_NDJSON_IPSET_ENTRIES);
+    GVariant *wanted = g_variant_get_child_value(record->value,
+						 FW_NDJSON_IPSET_ENTRIES);
+
+    if (add)
+	_fw_ndjson_queue_missing(batch, FW_DBUS_INTERFACE_IPSET, "addEntry",
+				 record->name, wanted, current, FALSE);
+    else
+	_fw_ndjson_queue_missing(batch, FW_DBUS_INTERFACE_IPSET, "removeEntry",
+				 record->name, current, wanted, FALSE);
+
+    g_variant_unref(current);
+    g_variant_unref(wanted);
+}
+
+/* prints the error of a failed call, keeps the first error for the caller */
+static gboolean
+_fw_ndjson_check_call(FWBatch *batch,
+		      guint index,
+		      GError **error)
+{
+    const GError *call_error = fw_batch_getError(batch, index);
+
+    if (call_error == NULL)
+	return TRUE;
+
+    g_print(_("ERROR: %s\n"), call_error->message);
+    if (error != NULL && *error == NULL)
+	*error = g_error_copy(call_error);
+
+    return FALSE;
+}
+
+/* checks all calls from first on, returns FALSE if any failed */
+static gboolean
+_fw_ndjson_check_calls(FWBatch *batch,
+		       guint first,
+		       GError **error)
+{
+    gboolean ok = TRUE;
+    guint i;
+
+    for (i = first; i < fw_batch_getLength(batch); i++)
+	ok = _fw_ndjson_check_call(batch, i, error) && ok;
+
+    return ok;
+}
+
+static GPtrArray *
+_fw_ndjson_read_records(GInputStream *stream,
+			GError **error)
+{
+    GPtrArray *records = g_ptr_array_new_with_free_func(
+	_fw_ndjson_record_free);
+    GDataInputStream *data = g_data_input_stream_new(stream);
+    GError *read_error = NULL;
+    guint line_number = 0;
+    gchar *line;
+
+    g_filter_input_stream_set_close_base_stream(G_FILTER_INPUT_STREAM(data),
+						FALSE);
+
+    while ((line = g_data_input_stream_read_line(data, NULL, NULL,
+						 &read_error)) != NULL)
+    {
+	FWNdjsonRecord *record;
+
+	line_number++;
+	if (*g_strchug(line) == '\0') {
+	    g_free(line);
+	    continue;
+	}
+
+	record = _fw_ndjson_record_parse(line, &read_error);
+	g_free(line);
+	if (record == NULL)
+	    break;
+	g_ptr_array_add(records, record);
+    }
+    g_object_unref(data);
+
+    if (read_error != NULL) {
+	g_propagate_prefixed_error(error, read_error, "line %u: ",
+				   line_number);
+	g_ptr_array_unref(records);
+	return NULL;
+    }
+
+    return records;
+}
+
+static gboolean
+_fw_ndjson_apply(FWClient *client,
+		 GPtrArray *records,
+		 GError **error)
+{
+    FWBatch *batch = fw_batch_new(fw_client_getConnection(client));
+    GVariant *reply;
+    guint default_zone = G_MAXUINT;
+    guint direct_rules = G_MAXUINT;
+    guint passthroughs = G_MAXUINT;
+    guint first, i;
+    gboolean ok = TRUE;
+    gboolean add;
+
+    fw_batch_setLimiter(batch, fw_client_getLimiter(client),
+			FW_LIMITER_PRIORITY_NORMAL);
+
+    /* current state of the listed objects */
+    for (i = 0; i < records->len; i++) {
+	FWNdjsonRecord *record = g_ptr_array_index(records, i);
+	const FWNdjsonType *info = NULL;
+
+	record->call = G_MAXUINT;
+	if (record->type < FW_XML_N_TYPES)
+	    info = &fw_ndjson_types[record->type];
+
+	if (info != NULL && !record->runtime) {
+	    record->call = fw_batch_add(batch, FW_DBUS_PATH_CONFIG,
+					FW_DBUS_INTERFACE_CONFIG,
+					info->by_name,
+					g_variant_new("(s)", record->name));
+	} else if (record->type == FW_XML_ZONE ||
+		   record->type == FW_XML_IPSET) {
+	    record->call = fw_batch_add(batch, FW_DBUS_PATH,
+					info->get_interface, info->get,
+					g_variant_new("(s)", record->name));
+	} else if (record->type == FW_NDJSON_DEFAULT_ZONE) {
+	    if (default_zone == G_MAXUINT)
+		default_zone = fw_batch_add(batch, FW_DBUS_PATH,
+					    FW_DBUS_INTERFACE,
+					    "getDefaultZone", NULL);
+	    record->call = default_zone;
+	} else if (record->type == FW_NDJSON_DIRECT_RULE) {
+	    if (direct_rules == G_MAXUINT)
+		direct_rules = fw_batch_add(batch, FW_DBUS_PATH,
+					    FW_DBUS_INTERFACE_DIRECT,
+					    "getAllRules", NULL);
+	    record->call = direct_rules;
+	} else if (record->type == FW_NDJSON_PASSTHROUGH) {
+	    if (passthroughs == G_MAXUINT)
+		passthroughs = fw_batch_add(batch, FW_DBUS_PATH,
+					    FW_DBUS_INTERFACE_DIRECT,
+					    "getAllPassthroughs", NULL);
+	    record->call = passthroughs;
+	}
+#ifdef FW_DEBUG
+	else {
+	    g_printerr("fw_ndjson_import: runtime %s '%s' ignored\n",
+		       fw_ndjson_type_names[record->type], record->name);
+	}
+#endif
+    }
+    fw_batch_run(batch, NULL);
+
+    /* settings of the existing permanent objects */
+    first = fw_batch_getLength(batch);
+    for (i = 0; i < records->len; i++) {
+	FWNdjsonRecord *record = g_ptr_array_index(records, i);
+
+	if (record->call == G_MAXUINT)
+	    continue;
+
+	reply = fw_batch_getResult(batch, record->call);
+	if (reply == NULL) {
+	    /* permanent objects that do not exist are added */
+	    if (record->runtime || record->type >= FW_XML_N_TYPES)
+		ok = _fw_ndjson_check_call(batch, record->call, error) && ok;
+	    record->call = G_MAXUINT;
+	} else if (!record->runtime) {
+	    g_variant_get(reply, "(o)", &record->path);
+	    record->call = fw_batch_add(
+		batch, record->path,
+		fw_ndjson_types[record->type].config_interface,
+		"getSettings", NULL);
+	} else if (record->type < FW_XML_N_TYPES) {
+	    record->current = _fw_ndjson_unwrap(record->type, reply);
+	} else {
+	    record->current = g_variant_get_child_value(reply, 0);
+	}
+    }
+    if (!ok) {
+	g_object_unref(batch);
+	return FALSE;
+    }
+    if (fw_batch_getLength(batch) > first) {
+	fw_batch_run(batch, NULL);
+	ok = _fw_ndjson_check_calls(batch, first, error);
+	for (i = 0; i < records->len && ok; i++) {
+	    FWNdjsonRecord *record = g_ptr_array_index(records, i);
+
+	    if (!record->runtime && record->call != G_MAXUINT)
+		record->current = _fw_ndjson_unwrap(
+		    record->type, fw_batch_getResult(batch, record->call));
+	}
+    }
+    if (!ok) {
+	g_object_unref(batch);
+	return FALSE;
+    }
+
+    /*
+     * changes: all removals first, then additions and updates, so that
+     * interfaces and sources can move between zones
+     */
+    fw_batch_clear(batch);
+    for (add = FALSE; add <= TRUE; add++) {
+	GHashTable *rules = NULL, *passthroughs_set = NULL;
+
+	for (i = 0; i < records->len; i++) {
+	    FWNdjsonRecord *record = g_ptr_array_index(records, i);
+	    const gchar *name;
+
+	    if (record->type < FW_XML_N_TYPES && !record->runtime) {
+		const FWNdjsonType *info = &fw_ndjson_types[record->type];
+
+		if (!add)
+		    continue;
+		if (record->path == NULL) {
+		    GVariant *params;
+
+		    /* same parameters as fw_config_add* */
+		    if (record->type == FW_XML_ICMPTYPE)
+			params = g_variant_new("(s@(sssas))", record->name,
+					       record->value);
+		    else
+			params = g_variant_new("(sv)", record->name,
+					       record->value);
+		    fw_batch_add(batch, FW_DBUS_PATH_CONFIG,
+				 FW_DBUS_INTERFACE_CONFIG, info->add, params);
+		} else if (record->current == NULL ||
+			   !g_variant_equal(record->current, record->value)) {
+		    fw_batch_add(batch, record->path, info->config_interface,
+				 "update",
+				 g_variant_new("(v)", record->value));
+		}
+	    } else if (record->current == NULL) {
+		continue;
+	    } else if (record->type == FW_XML_ZONE) {
+		_fw_ndjson_queue_zone(batch, record, add);
+	    } else if (record->type == FW_XML_IPSET) {
+		_fw_ndjson_queue_ipset(batch, record, add);
+	    } else if (record->type == FW_NDJSON_DEFAULT_ZONE) {
+		g_variant_get(record->current, "&s", &name);
+		if (add && strcmp(name, record->name) != 0)
+		    fw_batch_add(batch, FW_DBUS_PATH, FW_DBUS_INTERFACE,
+				 "setDefaultZone",
+				 g_variant_new("(s)", record->name));
+	    } else if (add && record->type == FW_NDJSON_DIRECT_RULE) {
+		if (rules == NULL)
+		    rules = _fw_ndjson_set_new(record->current);
+		if (!g_hash_table_contains(rules, record->value)) {
+		    g_hash_table_add(rules, g_variant_ref(record->value));
+		    fw_batch_add(batch, FW_DBUS_PATH, FW_DBUS_INTERFACE_DIRECT,
+				 "addRule", g_variant_ref(record->value));
+		}
+	    } else if (add && record->type == FW_NDJSON_PASSTHROUGH) {
+		if (passthroughs_set == NULL)
+		    passthroughs_set = _fw_ndjson_set_new(record->current);
+		if (!g_hash_table_contains(passthroughs_set, record->value)) {
+		    g_hash_table_add(passthroughs_set,
+				     g_variant_ref(record->value));
+		    fw_batch_add(batch, FW_DBUS_PATH, FW_DBUS_INTERFACE_DIRECT,
+				 "addPassthrough",
+				 g_variant_ref(record->value));
+		}
+	    }
+	}
+
+	if (rules != NULL)
+	    g_hash_table_destroy(rules);
+	if (passthroughs_set != NULL)
+	    g_hash_table_destroy(passthroughs_set);
+    }
+
+#ifdef FW_DEBUG
+    g_printerr("fw_ndjson_import: %u records, %u changes\n", records->len,
+	       fw_batch_getLength(batch));
+#endif
+
+    fw_batch_run(batch, NULL);
+    ok = _fw_ndjson_check_calls(batch, 0, error);
+
+    g_object_unref(batch);
+
+    return ok;
+}
+
+/**
+ * fw_ndjson_import:
+ * @client: (type FWClient*): a FWClient instance
+ * @stream: (type GInputStream*): stream to read from, it is not closed
+ * @error: (allow-none): return location for an error
+ *
+ * Reads records as written by fw_ndjson_export and applies them. The whole
+ * input is parsed before anything is changed. Permanent objects are added
+ * or updated, runtime zones and ipsets get the differences to the listed
+ * settings, missing direct rules and passthroughs are added and the default
+ * zone is set. All changes are sent as one pipelined batch.
+ *
+ * Returns: TRUE on success
+ */
+gboolean
+fw_ndjson_import(FWClient *client,
+		 GInputStream *stream,
+		 GError **error)
+{
+    GPtrArray *records;
+    gboolean ok;
+
+#ifdef FW_DEBUG
+    g_printerr("fw_ndjson_import()\n");
+#endif
+
+    records = _fw_ndjson_read_records(stream, error);
+    if (records == NULL) {
+	if (error != NULL && *error != NULL)
+	    g_print(_("ERROR: import failed: %s\n"), (*error)->message);
+	return FALSE;
+    }
+
+    ok = _fw_ndjson_apply(client, records, error);
+    g_ptr_array_unref(records);
+
+    return ok;
+}
@@ -0,0 +1,47 @@
+/*
+ * Copyright (C) 2017 Red Hat, Inc.
+ *
+ * Authors:
+ * Thomas Woerner <twoerner@redhat.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __FW_NDJSON_H__
+#define __FW_NDJSON_H__
+
+#include <glib.h>
+#include <gio/gio.h>
+#include "firewall.h"
+#include "fw_client.h"
+#include "fw_xml.h"
+
+#define FW_NDJSON_SCOPE_PERMANENT  "permanent"
+#define FW_NDJSON_SCOPE_RUNTIME    "runtime"
+
+/* export and import of the complete configuration, one record per line */
+
+gboolean fw_ndjson_export(FWClient *client, GOutputStream *stream,
+			  GError **error);
+gboolean fw_ndjson_import(FWClient *client, GInputStream *stream,
+			  GError **error);
+
+/* settings of a single object as JSON object */
+
+void fw_ndjson_append_settings(GString *str, FWXmlType type,
+			       GVariant *settings);
+GVariant *fw_ndjson_parse_settings(FWXmlType type, const gchar *json,
+				   GError **error);
+
+#endif /* __FW_NDJSON_H__ */
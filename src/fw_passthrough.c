@@ -19,6 +19,7 @@
  */
 
 #include "fw_passthrough.h"
+#include "fw_accounting.h"
 #include "fw_functions.h"
 
 G_DEFINE_TYPE(FWPassthrough, fw_passthrough, G_TYPE_OBJECT);
@@ -67,6 +68,7 @@ fw_passthrough_class_init(FWPassthroughClass *fw_passthrough_class)
     obj_class->finalize = fw_passthrough_finalize;
 
     g_type_class_add_private(obj_class, sizeof(FWPassthroughPrivate));
+    fw_accounting_register(obj_class, sizeof(FWPassthroughPrivate));
 }
 
 /* methods */
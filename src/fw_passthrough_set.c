@@ -0,0 +1,568 @@
+/*
+ * Copyright (C) 2017 Red Hat, Inc.
+ *
+ * Authors:
+ * Thomas Woerner <twoerner@redhat.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Set of tracked passthroughs, kept per ipv in the order they have been
+ * added and hashed by ipv and args for lookups without a D-Bus call.
+ */
+
+#include <string.h>
+#include "fw_passthrough_set.h"
+#include "fw_trace.h"
+#include "fw_accounting.h"
+
+G_DEFINE_TYPE(FWPassthroughSet, fw_passthrough_set, G_TYPE_OBJECT);
+
+#define FW_PASSTHROUGH_SET_GET_PRIVATE(o) (G_TYPE_INSTANCE_GET_PRIVATE((o), FW_PASSTHROUGH_SET_TYPE, FWPassthroughSetPrivate))
+
+typedef struct {
+    gchar *ipv;
+    GQueue entries;		/* FWPassthroughSetEntry, in order */
+} FWPassthroughSetIpv;
+
+typedef struct {
+    gchar *key;
+    FWPassthrough *passthrough;
+    FWPassthroughSetIpv *ipv;
+    GList link;			/* in ipv->entries */
+} FWPassthroughSetEntry;
+
+typedef struct {
+    GHashTable *ipvs;		/* ipv -> FWPassthroughSetIpv */
+    GHashTable *passthroughs;	/* key -> FWPassthroughSetEntry */
+} FWPassthroughSetPrivate;
+
+/* key: length prefixed ipv and args */
+static void
+_fw_passthrough_set_key(GString *key,
+			const gchar *ipv,
+			const GList *args)
+{
+    const GList *l;
+
+    g_string_truncate(key, 0);
+    g_string_append_printf(key, "%" G_GSIZE_FORMAT ":%s", strlen(ipv), ipv);
+    for (l = args; l != NULL; l = l->next)
+	g_string_append_printf(key, "%" G_GSIZE_FORMAT ":%s",
+			       strlen(l->data), (gchar *) l->data);
+}
+
+static void
+_fw_passthrough_set_ipv_free(gpointer data)
+{
+    FWPassthroughSetIpv *ipv = data;
+
+    g_free(ipv->ipv);
+    g_slice_free(FWPassthroughSetIpv, ipv);
+}
+
+static void
+_fw_passthrough_set_entry_free(gpointer data)
+{
+    FWPassthroughSetEntry *entry = data;
+
+    g_object_unref(entry->passthrough);
+    g_free(entry->key);
+    g_slice_free(FWPassthroughSetEntry, entry);
+}
+
+static gint
+_fw_passthrough_set_ipv_cmp(gconstpointer a,
+			    gconstpointer b)
+{
+    const FWPassthroughSetIpv *ipv_a = a;
+    const FWPassthroughSetIpv *ipv_b = b;
+
+    return strcmp(ipv_a->ipv, ipv_b->ipv);
+}
+
+FWPassthroughSet *
+fw_passthrough_set_new()
+{
+    return g_object_new(FW_PASSTHROUGH_SET_TYPE, NULL);
+}
+
+static void
+fw_passthrough_set_init(FWPassthroughSet *obj)
+{
+    FWPassthroughSetPrivate *priv = FW_PASSTHROUGH_SET_GET_PRIVATE(obj);
+
+    /* init vars */
+    priv->ipvs = g_hash_table_new_full(g_str_hash, g_str_equal, NULL,
+				       _fw_passthrough_set_ipv_free);
+    priv->passthroughs = g_hash_table_new_full(g_str_hash, g_str_equal, NULL,
+					       _fw_passthrough_set_entry_free);
+}
+
+static void
+fw_passthrough_set_finalize(GObject *obj)
+{
+    FWPassthroughSetPrivate *priv = FW_PASSTHROUGH_SET_GET_PRIVATE(obj);
+
+    g_hash_table_destroy(priv->passthroughs);
+    g_hash_table_destroy(priv->ipvs);
+
+    G_OBJECT_CLASS(fw_passthrough_set_parent_class)->finalize(obj);
+}
+
+static void
+fw_passthrough_set_class_init(FWPassthroughSetClass *fw_passthrough_set_class)
+{
+    GObjectClass *obj_class = G_OBJECT_CLASS(fw_passthrough_set_class);
+
+    obj_class->finalize = fw_passthrough_set_finalize;
+
+    g_type_class_add_private(obj_class, sizeof(FWPassthroughSetPrivate));
+    fw_accounting_register(obj_class, sizeof(FWPassthroughSetPrivate));
+}
+
+/* internal add and remove, key has to be the passthrough key */
+
+static gboolean
+_fw_passthrough_set_insert(FWPassthroughSetPrivate *priv,
+			   GString *key,
+			   const gchar *ipv_name,
+			   const GList *args)
+{
+    FWPassthroughSetIpv *ipv;
+    FWPassthroughSetEntry *entry;
+
+    if (g_hash_table_contains(priv->passthroughs, key->str))
+	return FALSE;
+
+    ipv = g_hash_table_lookup(priv->ipvs, ipv_name);
+    if (ipv == NULL) {
+	ipv = g_slice_new0(FWPassthroughSetIpv);
+	ipv->ipv = g_strdup(ipv_name);
+	g_queue_init(&ipv->entries);
+	g_hash_table_insert(priv->ipvs, ipv->ipv, ipv);
+    }
+
+    entry = g_slice_new0(FWPassthroughSetEntry);
+    entry->key = g_strdup(key->str);
+    entry->passthrough = fw_passthrough_new();
+    fw_passthrough_setIpv(entry->passthrough, ipv->ipv);
+    fw_passthrough_setArgs(entry->passthrough, (GList *) args);
+    entry->ipv = ipv;
+    entry->link.data = entry;
+    g_queue_push_tail_link(&ipv->entries, &entry->link);
+    g_hash_table_insert(priv->passthroughs, entry->key, entry);
+
+    return TRUE;
+}
+
+static gboolean
+_fw_passthrough_set_delete(FWPassthroughSetPrivate *priv,
+			   const gchar *key)
+{
+    FWPassthroughSetEntry *entry;
+    FWPassthroughSetIpv *ipv;
+
+    entry = g_hash_table_lookup(priv->passthroughs, key);
+    if (entry == NULL)
+	return FALSE;
+
+    ipv = entry->ipv;
+    g_queue_unlink(&ipv->entries, &entry->link);
+    g_hash_table_remove(priv->passthroughs, key);
+    if (g_queue_is_empty(&ipv->entries))
+	g_hash_table_remove(priv->ipvs, ipv->ipv);
+
+    return TRUE;
+}
+
+/**
+ * fw_passthrough_set_new_from_variant:
+ * @variant: (type GVariant*): passthroughs as a(sas) or (a(sas)) like
+ *   returned by getAllPassthroughs
+ *
+ * Returns: (transfer full) (type FWPassthroughSet*)
+ */
+FWPassthroughSet *
+fw_passthrough_set_new_from_variant(GVariant *variant)
+{
+    FWPassthroughSet *obj = fw_passthrough_set_new();
+    FWPassthroughSetPrivate *priv = FW_PASSTHROUGH_SET_GET_PRIVATE(obj);
+    GString *key;
+    GVariantIter iter;
+    const gchar *ipv;
+    GVariant *args;
+
+    if (g_variant_is_of_type(variant, G_VARIANT_TYPE("(a(sas))")))
+	variant = g_variant_get_child_value(variant, 0);
+    else if (g_variant_is_of_type(variant, G_VARIANT_TYPE("a(sas)")))
+	g_variant_ref(variant);
+    else {
+	g_print(_("ERROR: invalid passthroughs type '%s'\n"),
+		g_variant_get_type_string(variant));
+	return obj;
+    }
+
+    FW_TRACE_DECODE_START(variant);
+
+    key = g_string_sized_new(128);
+
+    g_variant_iter_init(&iter, variant);
+    while (g_variant_iter_next(&iter, "(&s@as)", &ipv, &args)) {
+	GVariantIter iter2;
+	const gchar *arg;
+	GList *list = NULL;
+
+	/* borrowed strings, args only lives for this iteration */
+	g_variant_iter_init(&iter2, args);
+	while (g_variant_iter_next(&iter2, "&s", &arg))
+	    list = g_list_prepend(list, (gpointer) arg);
+	list = g_list_reverse(list);
+
+	_fw_passthrough_set_key(key, ipv, list);
+	_fw_passthrough_set_insert(priv, key, ipv, list);
+
+	g_list_free(list);
+	g_variant_unref(args);
+    }
+
+    g_string_free(key, TRUE);
+    g_variant_unref(variant);
+
+    FW_TRACE_DECODE_DONE();
+    return obj;
+}
+
+/**
+ * fw_passthrough_set_to_variant:
+ * @obj: (type FWPassthroughSet*): a FWPassthroughSet instance
+ *
+ * Returns: (transfer none) (type GVariant*): floating a(sas) in the order
+ *   of fw_passthrough_set_getAllPassthroughs
+ */
+GVariant *
+fw_passthrough_set_to_variant(FWPassthroughSet *obj)
+{
+    GVariantBuilder builder;
+    GList *passthroughs, *l, *k;
+
+    g_variant_builder_init(&builder, G_VARIANT_TYPE("a(sas)"));
+
+    passthroughs = fw_passthrough_set_getAllPassthroughs(obj);
+    for (l = passthroughs; l != NULL; l = l->next) {
+	FWPassthrough *passthrough = l->data;
+
+	g_variant_builder_open(&builder, G_VARIANT_TYPE("(sas)"));
+	g_variant_builder_add(&builder, "s",
+			      fw_passthrough_getIpv(passthrough));
+	g_variant_builder_open(&builder, G_VARIANT_TYPE("as"));
+	for (k = fw_passthrough_getArgs(passthrough); k != NULL; k = k->next)
+	    g_variant_builder_add(&builder, "s", k->data);
+	g_variant_builder_close(&builder);
+	g_variant_builder_close(&builder);
+    }
+    g_list_free(passthroughs);
+
+    return g_variant_builder_end(&builder);
+}
+
+guint
+fw_passthrough_set_length(FWPassthroughSet *obj)
+{
+    FWPassthroughSetPrivate *priv = FW_PASSTHROUGH_SET_GET_PRIVATE(obj);
+
+    return g_hash_table_size(priv->passthroughs);
+}
+
+/**
+ * fw_passthrough_set_addPassthrough:
+ * @obj: (type FWPassthroughSet*): a FWPassthroughSet instance
+ * @ipv: (type utf8)
+ * @args: (type GList*) (element-type utf8)
+ *
+ * Returns: FALSE if the passthrough is already in the set
+ */
+gboolean
+fw_passthrough_set_addPassthrough(FWPassthroughSet *obj,
+				  const gchar *ipv,
+				  const GList *args)
+{
+    FWPassthroughSetPrivate *priv = FW_PASSTHROUGH_SET_GET_PRIVATE(obj);
+    GString *key = g_string_sized_new(128);
+    gboolean ret;
+
+    _fw_passthrough_set_key(key, ipv, args);
+    ret = _fw_passthrough_set_insert(priv, key, ipv, args);
+    g_string_free(key, TRUE);
+
+    return ret;
+}
+
+/**
+ * fw_passthrough_set_removePassthrough:
+ * @obj: (type FWPassthroughSet*): a FWPassthroughSet instance
+ * @ipv: (type utf8)
+ * @args: (type GList*) (element-type utf8)
+ *
+ * Returns: FALSE if the passthrough is not in the set
+ */
+gboolean
+fw_passthrough_set_removePassthrough(FWPassthroughSet *obj,
+				     const gchar *ipv,
+				     const GList *args)
+{
+    FWPassthroughSetPrivate *priv = FW_PASSTHROUGH_SET_GET_PRIVATE(obj);
+    GString *key = g_string_sized_new(128);
+    gboolean ret;
+
+    _fw_passthrough_set_key(key, ipv, args);
+    ret = _fw_passthrough_set_delete(priv, key->str);
+    g_string_free(key, TRUE);
+
+    return ret;
+}
+
+/**
+ * fw_passthrough_set_queryPassthrough:
+ * @obj: (type FWPassthroughSet*): a FWPassthroughSet instance
+ * @ipv: (type utf8)
+ * @args: (type GList*) (element-type utf8)
+ *
+ * Returns: (type gboolean)
+ */
+gboolean
+fw_passthrough_set_queryPassthrough(FWPassthroughSet *obj,
+				    const gchar *ipv,
+				    const GList *args)
+{
+    FWPassthroughSetPrivate *priv = FW_PASSTHROUGH_SET_GET_PRIVATE(obj);
+    GString *key = g_string_sized_new(128);
+    gboolean ret;
+
+    _fw_passthrough_set_key(key, ipv, args);
+    ret = g_hash_table_contains(priv->passthroughs, key->str);
+    g_string_free(key, TRUE);
+
+    return ret;
+}
+
+/**
+ * fw_passthrough_set_add:
+ * @obj: (type FWPassthroughSet*): a FWPassthroughSet instance
+ * @passthrough: (type FWPassthrough*): passthrough, the set keeps a copy
+ *
+ * Returns: FALSE if the passthrough is already in the set
+ */
+gboolean
+fw_passthrough_set_add(FWPassthroughSet *obj,
+		       FWPassthrough *passthrough)
+{
+    return fw_passthrough_set_addPassthrough(obj,
+					     fw_passthrough_getIpv(passthrough),
+					     fw_passthrough_getArgs(passthrough));
+}
+
+/**
+ * fw_passthrough_set_remove:
+ * @obj: (type FWPassthroughSet*): a FWPassthroughSet instance
+ * @passthrough: (type FWPassthrough*)
+ *
+ * Returns: FALSE if the passthrough is not in the set
+ */
+gboolean
+fw_passthrough_set_remove(FWPassthroughSet *obj,
+			  FWPassthrough *passthrough)
+{
+    return fw_passthrough_set_removePassthrough(obj,
+						fw_passthrough_getIpv(passthrough),
+						fw_passthrough_getArgs(passthrough));
+}
+
+/**
+ * fw_passthrough_set_query:
+ * @obj: (type FWPassthroughSet*): a FWPassthroughSet instance
+ * @passthrough: (type FWPassthrough*)
+ *
+ * Returns: (type gboolean)
+ */
+gboolean
+fw_passthrough_set_query(FWPassthroughSet *obj,
+			 FWPassthrough *passthrough)
+{
+    return fw_passthrough_set_queryPassthrough(obj,
+					       fw_passthrough_getIpv(passthrough),
+					       fw_passthrough_getArgs(passthrough));
+}
+
+/* entries of ipv in order that are not in other, prepended to list */
+static GList *
+_fw_passthrough_set_ipv_missing(FWPassthroughSetIpv *ipv,
+				FWPassthroughSetPrivate *other,
+				GList *list)
+{
+    GList *l;
+
+    for (l = ipv->entries.tail; l != NULL; l = l->prev) {
+	FWPassthroughSetEntry *entry = l->data;
+
+	if (other == NULL ||
+	    !g_hash_table_contains(other->passthroughs, entry->key))
+	    list = g_list_prepend(list, entry->passthrough);
+    }
+
+    return list;
+}
+
+/* passthroughs sorted by ipv and in order per ipv */
+static GList *
+_fw_passthrough_set_missing(FWPassthroughSetPrivate *priv,
+			    FWPassthroughSetPrivate *other)
+{
+    GList *ipvs, *l;
+    GList *list = NULL;
+
+    ipvs = g_list_sort(g_hash_table_get_values(priv->ipvs),
+		       _fw_passthrough_set_ipv_cmp);
+    for (l = g_list_last(ipvs); l != NULL; l = l->prev)
+	list = _fw_passthrough_set_ipv_missing(l->data, other, list);
+    g_list_free(ipvs);
+
+    return list;
+}
+
+/**
+ * fw_passthrough_set_getPassthroughs:
+ * @obj: (type FWPassthroughSet*): a FWPassthroughSet instance
+ * @ipv: (type utf8)
+ *
+ * Returns: (transfer container) (allow-none) (element-type FWPassthrough*):
+ *   passthroughs of ipv in the order they have been added
+ */
+GList *
+fw_passthrough_set_getPassthroughs(FWPassthroughSet *obj,
+				   const gchar *ipv_name)
+{
+    FWPassthroughSetPrivate *priv = FW_PASSTHROUGH_SET_GET_PRIVATE(obj);
+    FWPassthroughSetIpv *ipv;
+
+    ipv = g_hash_table_lookup(priv->ipvs, ipv_name);
+    if (ipv == NULL)
+	return NULL;
+
+    return _fw_passthrough_set_ipv_missing(ipv, NULL, NULL);
+}
+
+/**
+ * fw_passthrough_set_getAllPassthroughs:
+ * @obj: (type FWPassthroughSet*): a FWPassthroughSet instance
+ *
+ * Returns: (transfer container) (allow-none) (element-type FWPassthrough*):
+ *   passthroughs sorted by ipv and in the order they have been added
+ */
+GList *
+fw_passthrough_set_getAllPassthroughs(FWPassthroughSet *obj)
+{
+    FWPassthroughSetPrivate *priv = FW_PASSTHROUGH_SET_GET_PRIVATE(obj);
+
+    return _fw_passthrough_set_missing(priv, NULL);
+}
+
+/**
+ * fw_passthrough_set_diff:
+ * @obj: (type FWPassthroughSet*): current passthroughs
+ * @desired: (type FWPassthroughSet*): passthroughs to get to
+ * @to_remove: (out) (transfer container) (element-type FWPassthrough*):
+ *   passthroughs of obj that are not in desired
+ * @to_add: (out) (transfer container) (element-type FWPassthrough*):
+ *   passthroughs of desired that are not in obj
+ *
+ * The passthroughs in the lists belong to the sets.
+ */
+void
+fw_passthrough_set_diff(FWPassthroughSet *obj,
+			FWPassthroughSet *desired,
+			GList **to_remove,
+			GList **to_add)
+{
+    FWPassthroughSetPrivate *priv = FW_PASSTHROUGH_SET_GET_PRIVATE(obj);
+    FWPassthroughSetPrivate *desired_priv = FW_PASSTHROUGH_SET_GET_PRIVATE(desired);
+
+    if (to_remove != NULL)
+	*to_remove = _fw_passthrough_set_missing(priv, desired_priv);
+    if (to_add != NULL)
+	*to_add = _fw_passthrough_set_missing(desired_priv, priv);
+}
+
+static guint
+_fw_passthrough_set_queue(FWBatch *batch,
+			  const gchar *method_name,
+			  GList *passthroughs)
+{
+    GList *l, *k;
+    guint n = 0;
+
+    for (l = passthroughs; l != NULL; l = l->next) {
+	FWPassthrough *passthrough = l->data;
+	GVariantBuilder builder;
+
+	g_variant_builder_init(&builder, G_VARIANT_TYPE("as"));
+	for (k = fw_passthrough_getArgs(passthrough); k != NULL; k = k->next)
+	    g_variant_builder_add(&builder, "s", k->data);
+
+	fw_batch_add(batch, FW_DBUS_PATH, FW_DBUS_INTERFACE_DIRECT,
+		     method_name,
+		     g_variant_new("(sas)",
+				   fw_passthrough_getIpv(passthrough),
+				   &builder));
+	n++;
+    }
+
+    return n;
+}
+
+/**
+ * fw_passthrough_set_queueDiff:
+ * @obj: (type FWPassthroughSet*): current passthroughs
+ * @desired: (type FWPassthroughSet*): passthroughs to get to
+ * @batch: (type FWBatch*): batch to add the calls to
+ *
+ * Adds the removePassthrough calls and then the addPassthrough calls that
+ * change the tracked passthroughs from obj to desired to the batch.
+ *
+ * Returns: number of calls added to the batch
+ */
+guint
+fw_passthrough_set_queueDiff(FWPassthroughSet *obj,
+			     FWPassthroughSet *desired,
+			     FWBatch *batch)
+{
+    GList *to_remove, *to_add;
+    guint n;
+
+    fw_passthrough_set_diff(obj, desired, &to_remove, &to_add);
+
+#ifdef FW_DEBUG
+    g_printerr("fw_passthrough_set_queueDiff(): %u to remove, %u to add\n",
+	       g_list_length(to_remove), g_list_length(to_add));
+#endif
+
+    n = _fw_passthrough_set_queue(batch, "removePassthrough", to_remove);
+    n += _fw_passthrough_set_queue(batch, "addPassthrough", to_add);
+
+    g_list_free(to_remove);
+    g_list_free(to_add);
+
+    return n;
+}
@@ -0,0 +1,67 @@
+/*
+ * Copyright (C) 2017 Red Hat, Inc.
+ *
+ * Authors:
+ * Thomas Woerner <twoerner@redhat.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __FW_PASSTHROUGH_SET_H__
+#define __FW_PASSTHROUGH_SET_H__
+
+#include <glib.h>
+#include <glib-object.h>
+#include "firewall.h"
+#include "fw_passthrough.h"
+#include "fw_batch.h"
+
+#define FW_PASSTHROUGH_SET_TYPE            (fw_passthrough_set_get_type())
+#define FW_PASSTHROUGH_SET(obj)            (G_TYPE_CHECK_INSTANCE_CAST((obj), FW_PASSTHROUGH_SET_TYPE, FWPassthroughSet))
+#define FW_PASSTHROUGH_SET_CLASS(klass)    (G_TYPE_CHECK_CLASS_CAST((klass), FW_PASSTHROUGH_SET_TYPE, FWPassthroughSetClass))
+#define FW_IS_PASSTHROUGH_SET(klass)       (G_TYPE_CHECK_INSTANCE_CLASS((klass), FW_PASSTHROUGH_SET_TYPE, FWPassthroughSetClass))
+#define FW_PASSTHROUGH_SET_GET_CLASS(obj)  (G_TYPE_INSTANCE_GET_CLASS((obj), FW_PASSTHROUGH_SET_TYPE, FWPassthroughSetClass))
+
+typedef struct {
+    GObject parent;
+} FWPassthroughSet;
+
+typedef struct {
+    GObjectClass parent;
+} FWPassthroughSetClass;
+
+GType fw_passthrough_set_get_type(void);
+FWPassthroughSet *fw_passthrough_set_new(void);
+FWPassthroughSet *fw_passthrough_set_new_from_variant(GVariant *variant);
+GVariant *fw_passthrough_set_to_variant(FWPassthroughSet *obj);
+
+guint fw_passthrough_set_length(FWPassthroughSet *obj);
+
+gboolean fw_passthrough_set_addPassthrough(FWPassthroughSet *obj, const gchar *ipv, const GList *args);
+gboolean fw_passthrough_set_removePassthrough(FWPassthroughSet *obj, const gchar *ipv, const GList *args);
+gboolean fw_passthrough_set_queryPassthrough(FWPassthroughSet *obj, const gchar *ipv, const GList *args);
+
+gboolean fw_passthrough_set_add(FWPassthroughSet *obj, FWPassthrough *passthrough);
+gboolean fw_passthrough_set_remove(FWPassthroughSet *obj, FWPassthrough *passthrough);
+gboolean fw_passthrough_set_query(FWPassthroughSet *obj, FWPassthrough *passthrough);
+
+GList *fw_passthrough_set_getPassthroughs(FWPassthroughSet *obj, const gchar *ipv);
+GList *fw_passthrough_set_getAllPassthroughs(FWPassthroughSet *obj);
+
+/* changes to get from obj to desired */
+
+void fw_passthrough_set_diff(FWPassthroughSet *obj, FWPassthroughSet *desired, GList **to_remove, GList **to_add);
+guint fw_passthrough_set_queueDiff(FWPassthroughSet *obj, FWPassthroughSet *desired, FWBatch *batch);
+
+#endif /* __FW_PASSTHROUGH_SET_H__ */
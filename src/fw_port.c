@@ -19,6 +19,8 @@
  */
 
 #include "fw_port.h"
+#include "fw_trace.h"
+#include "fw_accounting.h"
 
 G_DEFINE_TYPE(FWPort, fw_port, G_TYPE_OBJECT);
 
@@ -42,16 +44,19 @@ fw_port_new_from_variant(GVariant *variant)
     GVariant *item=NULL;
     gchar *port, *protocol;
 
+    FW_TRACE_DECODE_START(variant);
+
     item = g_variant_get_child_value(variant, 0);
-    g_variant_get(item, "s", &port);
+    g_variant_get(item, "&s", &port);
     fw_port_setPort(obj, port);
     g_variant_unref(item);
 
     item = g_variant_get_child_value(variant, 1);
-    g_variant_get(item, "s", &protocol);
+    g_variant_get(item, "&s", &protocol);
     fw_port_setProtocol(obj, protocol);
     g_variant_unref(item);
 
+    FW_TRACE_DECODE_DONE();
     return obj;
 }
 
@@ -106,6 +111,7 @@ fw_port_class_init(FWPortClass *fw_port_class)
     obj_class->finalize = fw_port_finalize;
 
     g_type_class_add_private(obj_class, sizeof(FWPortPrivate));
+    fw_accounting_register(obj_class, sizeof(FWPortPrivate));
 }
 
 /* methods */
@@ -20,6 +20,8 @@
 
 #include <string.h>
 #include "fw_port_list.h"
+#include "fw_trace.h"
+#include "fw_accounting.h"
 
 G_DEFINE_TYPE(FWPortList, fw_port_list, G_TYPE_OBJECT);
 
@@ -49,6 +51,8 @@ fw_port_list_new_from_variant(GVariant *variant)
 	    return NULL;
     }
 
+    FW_TRACE_DECODE_START(variant);
+
     list = fw_port_list_new();
 
     if (g_variant_iter_init(&iter, variant)) {
@@ -67,10 +71,13 @@ fw_port_list_new_from_variant(GVariant *variant)
 	    g_variant_unref(item2);
 
 	    fw_port_list_addPort(list, port, protocol);
+	    g_free(port);
+	    g_free(protocol);
 	    g_variant_unref(element);
 	}
     }
 
+    FW_TRACE_DECODE_DONE();
     return list;
 }
 
@@ -154,13 +161,9 @@ static void
 fw_port_list_finalize(GObject *obj)
 {
     FWPortListPrivate *priv = FW_PORT_LIST_GET_PRIVATE(obj);
-    gint i;
 
-    if (priv->ports != NULL) {
-	for (i=0; i<g_list_length(priv->ports); i++)
-	    g_free(g_list_nth_data(priv->ports, i));
-	g_list_free(priv->ports);
-    }
+    /* ports are FWPort objects */
+    g_list_free_full(priv->ports, g_object_unref);
 
     G_OBJECT_CLASS(fw_port_list_parent_class)->finalize(obj);
 }
@@ -173,6 +176,7 @@ fw_port_list_class_init(FWPortListClass *fw_port_list_class)
     obj_class->finalize = fw_port_list_finalize;
 
     g_type_class_add_private(obj_class, sizeof(FWPortListPrivate));
+    fw_accounting_register(obj_class, sizeof(FWPortListPrivate));
 }
 
 /* methods */
@@ -282,15 +286,36 @@ fw_port_list_addPort(FWPortList *obj,
     priv->ports = g_list_append(priv->ports, item);
 }
 
+/* ports are compared by value, no temporary FWPort is needed */
+static GList *
+_fw_port_list_find(FWPortListPrivate *priv,
+		   const gchar *port,
+		   const gchar *protocol)
+{
+    GList *list;
+
+    for (list = priv->ports; list != NULL; list = list->next) {
+	if (g_strcmp0(fw_port_getPort(list->data), port) == 0 &&
+	    g_strcmp0(fw_port_getProtocol(list->data), protocol) == 0)
+	    return list;
+    }
+
+    return NULL;
+}
+
 void
 fw_port_list_removePort(FWPortList *obj,
 			gchar *port,
 			gchar *protocol)
 {
     FWPortListPrivate *priv = FW_PORT_LIST_GET_PRIVATE(obj);
-    FWPort *item = fw_port_new(port, protocol);
+    GList *list = _fw_port_list_find(priv, port, protocol);
+
+    if (list == NULL)
+	return;
 
-    priv->ports = g_list_remove(priv->ports, item);
+    g_object_unref(list->data);
+    priv->ports = g_list_delete_link(priv->ports, list);
 }
 
 gboolean
@@ -299,13 +324,8 @@ fw_port_list_queryPort(FWPortList *obj,
 		       gchar *protocol)
 {
     FWPortListPrivate *priv = FW_PORT_LIST_GET_PRIVATE(obj);
-    FWPort *item = fw_port_new(port, protocol);
-    GList *list;
 
-    list = g_list_find(priv->ports, item);
-    if (list == NULL)
-	return FALSE;
-    return TRUE;
+    return _fw_port_list_find(priv, port, protocol) != NULL;
 }
 
 void
@@ -0,0 +1,407 @@
+/*
+ * Copyright (C) 2017 Red Hat, Inc.
+ *
+ * Authors:
+ * Thomas Woerner <twoerner@redhat.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Difference of runtime and permanent zone settings, field by field. List
+ * fields are compared as sets: the permanent items are hashed, the runtime
+ * items are looked up and marked, whatever is left has been removed in
+ * runtime. Every hunk knows the config zone call that takes the runtime
+ * state into the permanent configuration, so selected hunks can be
+ * applied instead of runtimeToPermanent for everything.
+ */
+
+#include <string.h>
+#include "fw_runtime_diff.h"
+#include "fw_accounting.h"
+#include "fw_expiration_tracker.h"
+
+G_DEFINE_TYPE(FWRuntimeDiff, fw_runtime_diff, G_TYPE_OBJECT);
+
+#define FW_RUNTIME_DIFF_GET_PRIVATE(o) (G_TYPE_INSTANCE_GET_PRIVATE((o), FW_RUNTIME_DIFF_TYPE, FWRuntimeDiffPrivate))
+
+typedef struct {
+    GPtrArray *hunks;		/* FWDiffHunk */
+} FWRuntimeDiffPrivate;
+
+/* compared fields of the zone settings, see FW_XML_ZONE_SIGNATURE */
+static const struct {
+    guint index;
+    const gchar *field;
+    const gchar *method;	/* set<method>, add<method>, remove<method> */
+} _fw_runtime_diff_fields[] = {
+    { 4,  "target",               "Target" },
+    { 5,  "services",             "Service" },
+    { 6,  "ports",                "Port" },
+    { 7,  "icmp-blocks",          "IcmpBlock" },
+    { 8,  "masquerade",           "Masquerade" },
+    { 9,  "forward-ports",        "ForwardPort" },
+    { 10, "interfaces",           "Interface" },
+    { 11, "sources",              "Source" },
+    { 12, "rich-rules",           "RichRule" },
+    { 13, "protocols",            "Protocol" },
+    { 14, "source-ports",         "SourcePort" },
+    { 15, "icmp-block-inversion", "IcmpBlockInversion" },
+};
+
+/**
+ * fw_runtime_diff_new:
+ *
+ * Returns: (transfer full) (type FWRuntimeDiff*)
+ */
+FWRuntimeDiff *
+fw_runtime_diff_new(void)
+{
+    return g_object_new(FW_RUNTIME_DIFF_TYPE, NULL);
+}
+
+static void
+fw_runtime_diff_init(FWRuntimeDiff *obj)
+{
+    FWRuntimeDiffPrivate *priv = FW_RUNTIME_DIFF_GET_PRIVATE(obj);
+
+    /* init vars */
+    priv->hunks = g_ptr_array_new_with_free_func(g_object_unref);
+}
+
+static void
+fw_runtime_diff_finalize(GObject *obj)
+{
+    FWRuntimeDiffPrivate *priv = FW_RUNTIME_DIFF_GET_PRIVATE(obj);
+
+    g_ptr_array_unref(priv->hunks);
+
+    G_OBJECT_CLASS(fw_runtime_diff_parent_class)->finalize(obj);
+}
+
+static void
+fw_runtime_diff_class_init(FWRuntimeDiffClass *fw_runtime_diff_class)
+{
+    GObjectClass *obj_class = G_OBJECT_CLASS(fw_runtime_diff_class);
+
+    obj_class->finalize = fw_runtime_diff_finalize;
+
+    g_type_class_add_private(obj_class, sizeof(FWRuntimeDiffPrivate));
+    fw_accounting_register(obj_class, sizeof(FWRuntimeDiffPrivate));
+}
+
+/* g_variant_hash only handles basic types, tuples hash their children */
+static guint
+_fw_runtime_diff_hash(gconstpointer key)
+{
+    GVariant *variant = (GVariant *) key;
+    GVariant *child;
+    GVariantIter iter;
+    guint hash = 0;
+
+    if (!g_variant_is_container(variant))
+	return g_variant_hash(variant);
+
+    g_variant_iter_init(&iter, variant);
+    while ((child = g_variant_iter_next_value(&iter)) != NULL) {
+	hash = hash * 31 + _fw_runtime_diff_hash(child);
+	g_variant_unref(child);
+    }
+
+    return hash;
+}
+
+/* item in firewall-cmd syntax */
+static gchar *
+_fw_runtime_diff_item_str(GVariant *item)
+{
+    const gchar *port, *protocol, *toport, *toaddr;
+
+    if (g_variant_is_of_type(item, G_VARIANT_TYPE_STRING))
+	return g_variant_dup_string(item, NULL);
+    if (g_variant_is_of_type(item, G_VARIANT_TYPE_BOOLEAN))
+	return g_strdup(g_variant_get_boolean(item) ? "yes" : "no");
+    if (g_variant_is_of_type(item, G_VARIANT_TYPE("(ss)"))) {
+	g_variant_get(item, "(&s&s)", &port, &protocol);
+	return fw_expiration_tracker_portItem(port, protocol);
+    }
+    if (g_variant_is_of_type(item, G_VARIANT_TYPE("(ssss)"))) {
+	g_variant_get(item, "(&s&s&s&s)", &port, &protocol, &toport, &toaddr);
+	return fw_expiration_tracker_forwardPortItem(port, protocol, toport,
+						     toaddr);
+    }
+
+    return g_variant_print(item, FALSE);
+}
+
+static void
+_fw_runtime_diff_add_hunk(FWRuntimeDiffPrivate *priv,
+			  const gchar *zone,
+			  const gchar *path,
+			  const gchar *field,
+			  FWDiffHunkOperation operation,
+			  GVariant *item,
+			  GVariant *permanent_item,
+			  const gchar *verb,
+			  const gchar *method,
+			  GVariant *parameters)
+{
+    FWDiffHunk *hunk = fw_diff_hunk_new();
+    gchar *str, *method_name;
+
+    fw_diff_hunk_setZone(hunk, zone);
+    fw_diff_hunk_setField(hunk, field);
+    fw_diff_hunk_setOperation(hunk, operation);
+    str = _fw_runtime_diff_item_str(item);
+    fw_diff_hunk_setItem(hunk, str);
+    g_free(str);
+    if (permanent_item != NULL) {
+	str = _fw_runtime_diff_item_str(permanent_item);
+	fw_diff_hunk_setPermanentItem(hunk, str);
+	g_free(str);
+    }
+
+    method_name = g_strconcat(verb, method, NULL);
+    fw_diff_hunk_setCall(hunk, path, method_name, parameters);
+    g_free(method_name);
+
+    g_ptr_array_add(priv->hunks, hunk);
+}
+
+/* list items are passed as (s) or as the tuple they are */
+static GVariant *
+_fw_runtime_diff_item_params(GVariant *item)
+{
+    if (g_variant_is_of_type(item, G_VARIANT_TYPE_TUPLE))
+	return item;
+
+    return g_variant_new_tuple(&item, 1);
+}
+
+static guint
+_fw_runtime_diff_list(FWRuntimeDiffPrivate *priv,
+		      const gchar *zone,
+		      const gchar *path,
+		      guint field,
+		      GVariant *runtime,
+		      GVariant *permanent)
+{
+    const gchar *name = _fw_runtime_diff_fields[field].field;
+    const gchar *method = _fw_runtime_diff_fields[field].method;
+    GHashTable *items;
+    GHashTableIter hash_iter;
+    GVariantIter iter;
+    GVariant *item;
+    gpointer key, value;
+    guint n = 0;
+
+    /* permanent item -> seen in runtime */
+    items = g_hash_table_new_full(_fw_runtime_diff_hash, g_variant_equal,
+				  (GDestroyNotify) g_variant_unref, NULL);
+    g_variant_iter_init(&iter, permanent);
+    while ((item = g_variant_iter_next_value(&iter)) != NULL)
+	g_hash_table_insert(items, item, GINT_TO_POINTER(FALSE));
+
+    g_variant_iter_init(&iter, runtime);
+    while ((item = g_variant_iter_next_value(&iter)) != NULL) {
+	if (g_hash_table_contains(items, item)) {
+	    g_hash_table_insert(items, g_variant_ref(item),
+				GINT_TO_POINTER(TRUE));
+	} else {
+	    _fw_runtime_diff_add_hunk(priv, zone, path, name,
+				      FW_DIFF_HUNK_RUNTIME_ONLY, item, NULL,
+				      "add", method,
+				      _fw_runtime_diff_item_params(item));
+	    n++;
+	}
+	g_variant_unref(item);
+    }
+
+    g_hash_table_iter_init(&hash_iter, items);
+    while (g_hash_table_iter_next(&hash_iter, &key, &value)) {
+	if (GPOINTER_TO_INT(value))
+	    continue;
+	_fw_runtime_diff_add_hunk(priv, zone, path, name,
+				  FW_DIFF_HUNK_PERMANENT_ONLY, key, NULL,
+				  "remove", method,
+				  _fw_runtime_diff_item_params(key));
+	n++;
+    }
+
+    g_hash_table_destroy(items);
+
+    return n;
+}
+
+/* methods */
+
+/**
+ * fw_runtime_diff_addZone:
+ * @obj: (type FWRuntimeDiff*): a FWRuntimeDiff instance
+ * @zone: (type utf8): zone name
+ * @path: (type utf8): object path of the permanent zone
+ * @runtime: (type GVariant*): runtime zone settings
+ * @permanent: (type GVariant*): permanent zone settings
+ *
+ * Adds the hunks of a zone, the settings are in the format of
+ * getZoneSettings and of getSettings of the config zone interface.
+ *
+ * Returns: number of hunks added
+ */
+guint
+fw_runtime_diff_addZone(FWRuntimeDiff *obj,
+			const gchar *zone,
+			const gchar *path,
+			GVariant *runtime,
+			GVariant *permanent)
+{
+    FWRuntimeDiffPrivate *priv = FW_RUNTIME_DIFF_GET_PRIVATE(obj);
+    GVariant *runtime_value, *permanent_value;
+    guint i, n = 0;
+
+    for (i = 0; i < G_N_ELEMENTS(_fw_runtime_diff_fields); i++) {
+	guint index = _fw_runtime_diff_fields[i].index;
+	const gchar *name = _fw_runtime_diff_fields[i].field;
+	const gchar *method = _fw_runtime_diff_fields[i].method;
+
+	if (index >= g_variant_n_children(runtime) ||
+	    index >= g_variant_n_children(permanent))
+	    continue;
+
+	runtime_value = g_variant_get_child_value(runtime, index);
+	permanent_value = g_variant_get_child_value(permanent, index);
+
+	if (g_variant_is_of_type(runtime_value, G_VARIANT_TYPE_ARRAY)) {
+	    n += _fw_runtime_diff_list(priv, zone, path, i, runtime_value,
+				       permanent_value);
+	} else if (!g_variant_equal(runtime_value, permanent_value)) {
+	    /* target is set, booleans are added or removed */
+	    if (g_variant_is_of_type(runtime_value, G_VARIANT_TYPE_BOOLEAN))
+		_fw_runtime_diff_add_hunk(
+		    priv, zone, path, name, FW_DIFF_HUNK_CHANGED,
+		    runtime_value, permanent_value,
+		    g_variant_get_boolean(runtime_value) ? "add" : "remove",
+		    method, NULL);
+	    else
+		_fw_runtime_diff_add_hunk(
+		    priv, zone, path, name, FW_DIFF_HUNK_CHANGED,
+		    runtime_value, permanent_value, "set", method,
+		    g_variant_new_tuple(&runtime_value, 1));
+	    n++;
+	}
+
+	g_variant_unref(runtime_value);
+	g_variant_unref(permanent_value);
+    }
+
+    return n;
+}
+
+guint
+fw_runtime_diff_getLength(FWRuntimeDiff *obj)
+{
+    FWRuntimeDiffPrivate *priv = FW_RUNTIME_DIFF_GET_PRIVATE(obj);
+
+    return priv->hunks->len;
+}
+
+/**
+ * fw_runtime_diff_getHunk:
+ * @obj: (type FWRuntimeDiff*): a FWRuntimeDiff instance
+ * @index: hunk index
+ *
+ * Returns: (transfer none) (allow-none) (type FWDiffHunk*)
+ */
+FWDiffHunk *
+fw_runtime_diff_getHunk(FWRuntimeDiff *obj,
+			guint index)
+{
+    FWRuntimeDiffPrivate *priv = FW_RUNTIME_DIFF_GET_PRIVATE(obj);
+
+    if (index >= priv->hunks->len)
+	return NULL;
+
+    return g_ptr_array_index(priv->hunks, index);
+}
+
+/**
+ * fw_runtime_diff_getHunks:
+ * @obj: (type FWRuntimeDiff*): a FWRuntimeDiff instance
+ *
+ * Returns: (transfer container) (element-type FWDiffHunk*): all hunks in
+ * zone order
+ */
+GList *
+fw_runtime_diff_getHunks(FWRuntimeDiff *obj)
+{
+    return fw_runtime_diff_getZoneHunks(obj, NULL);
+}
+
+/**
+ * fw_runtime_diff_getZoneHunks:
+ * @obj: (type FWRuntimeDiff*): a FWRuntimeDiff instance
+ * @zone: (allow-none): zone name, NULL for all zones
+ *
+ * Returns: (transfer container) (element-type FWDiffHunk*)
+ */
+GList *
+fw_runtime_diff_getZoneHunks(FWRuntimeDiff *obj,
+			     const gchar *zone)
+{
+    FWRuntimeDiffPrivate *priv = FW_RUNTIME_DIFF_GET_PRIVATE(obj);
+    GList *list = NULL;
+    guint i;
+
+    for (i = priv->hunks->len; i > 0; i--) {
+	FWDiffHunk *hunk = g_ptr_array_index(priv->hunks, i - 1);
+
+	if (zone == NULL || strcmp(fw_diff_hunk_getZone(hunk), zone) == 0)
+	    list = g_list_prepend(list, hunk);
+    }
+
+    return list;
+}
+
+/**
+ * fw_runtime_diff_queueApply:
+ * @obj: (type FWRuntimeDiff*): a FWRuntimeDiff instance
+ * @hunks: (element-type FWDiffHunk*) (allow-none): selected hunks, NULL
+ *   for all
+ * @batch: (type FWBatch*): batch to add the calls to
+ *
+ * Adds the config zone calls that take the runtime state of the hunks
+ * into the permanent configuration to the batch.
+ *
+ * Returns: number of calls added to the batch
+ */
+guint
+fw_runtime_diff_queueApply(FWRuntimeDiff *obj,
+			   GList *hunks,
+			   FWBatch *batch)
+{
+    FWRuntimeDiffPrivate *priv = FW_RUNTIME_DIFF_GET_PRIVATE(obj);
+    GList *list;
+    guint i, n = 0;
+
+    if (hunks == NULL) {
+	for (i = 0; i < priv->hunks->len; i++)
+	    n += fw_diff_hunk_queue(g_ptr_array_index(priv->hunks, i), batch);
+	return n;
+    }
+
+    for (list = hunks; list != NULL; list = list->next)
+	n += fw_diff_hunk_queue(list->data, batch);
+
+    return n;
+}
@@ -0,0 +1,56 @@
+/*
+ * Copyright (C) 2017 Red Hat, Inc.
+ *
+ * Authors:
+ * Thomas Woerner <twoerner@redhat.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __FW_RUNTIME_DIFF_H__
+#define __FW_RUNTIME_DIFF_H__
+
+#include <glib.h>
+#include <glib-object.h>
+#include "firewall.h"
+#include "fw_batch.h"
+#include "fw_diff_hunk.h"
+
+#define FW_RUNTIME_DIFF_TYPE            (fw_runtime_diff_get_type())
+#define FW_RUNTIME_DIFF(obj)            (G_TYPE_CHECK_INSTANCE_CAST((obj), FW_RUNTIME_DIFF_TYPE, FWRuntimeDiff))
+#define FW_RUNTIME_DIFF_CLASS(klass)    (G_TYPE_CHECK_CLASS_CAST((klass), FW_RUNTIME_DIFF_TYPE, FWRuntimeDiffClass))
+#define FW_IS_RUNTIME_DIFF(klass)       (G_TYPE_CHECK_INSTANCE_CLASS((klass), FW_RUNTIME_DIFF_TYPE, FWRuntimeDiffClass))
+#define FW_RUNTIME_DIFF_GET_CLASS(obj)  (G_TYPE_INSTANCE_GET_CLASS((obj), FW_RUNTIME_DIFF_TYPE, FWRuntimeDiffClass))
+
+typedef struct {
+    GObject parent;
+} FWRuntimeDiff;
+
+typedef struct {
+    GObjectClass parent;
+} FWRuntimeDiffClass;
+
+GType fw_runtime_diff_get_type(void);
+FWRuntimeDiff *fw_runtime_diff_new(void);
+
+guint fw_runtime_diff_addZone(FWRuntimeDiff *obj, const gchar *zone, const gchar *path, GVariant *runtime, GVariant *permanent);
+
+guint fw_runtime_diff_getLength(FWRuntimeDiff *obj);
+FWDiffHunk *fw_runtime_diff_getHunk(FWRuntimeDiff *obj, guint index);
+GList *fw_runtime_diff_getHunks(FWRuntimeDiff *obj);
+GList *fw_runtime_diff_getZoneHunks(FWRuntimeDiff *obj, const gchar *zone);
+
+guint fw_runtime_diff_queueApply(FWRuntimeDiff *obj, GList *hunks, FWBatch *batch);
+
+#endif /* __FW_RUNTIME_DIFF_H__ */
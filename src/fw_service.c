@@ -19,6 +19,8 @@
  */
 
 #include "fw_service.h"
+#include "fw_trace.h"
+#include "fw_accounting.h"
 #include <string.h>
 
 G_DEFINE_TYPE(FWService, fw_service, G_TYPE_OBJECT);
@@ -34,6 +36,8 @@ typedef struct {
     GHashTable *destinations;  /* hash table of string: string */
     GList *protocols;          /* list of string */
     FWPortList *source_ports;  /* list of FWPort */
+    FWFingerprint fingerprint;  /* cached structural hash */
+    gboolean fingerprint_valid;
 } FWServicePrivate;
 
 FWService *
@@ -54,6 +58,7 @@ fw_service_new_from_variant(GVariant *variant)
     GVariant *item;
     GVariantIter iter;
     gchar *str;
+    GList *strs;
 
     if (variant == NULL)
 	return NULL;
@@ -62,6 +67,8 @@ fw_service_new_from_variant(GVariant *variant)
 		"((sssa(ss)asa{ss}asa(ss)))", 26) != 0)
 	return NULL;
 
+    FW_TRACE_DECODE_START(variant);
+
     /* get sssa(ss)asa{ss}asa(ss) from (sssa(ss)asa{ss}asa(ss)) */
     variant = g_variant_get_child_value(variant, 0);
 
@@ -69,19 +76,19 @@ fw_service_new_from_variant(GVariant *variant)
 
     /* 0: version */
     item = g_variant_get_child_value(variant, 0);
-    g_variant_get(item, "s", &str);
+    g_variant_get(item, "&s", &str);
     fw_service_setVersion(obj, str);
     g_variant_unref(item);
 
     /* 1: short */
     item = g_variant_get_child_value(variant, 1);
-    g_variant_get(item, "s", &str);
+    g_variant_get(item, "&s", &str);
     fw_service_setShort(obj, str);
     g_variant_unref(item);
 
     /* 2: description */
     item = g_variant_get_child_value(variant, 2);
-    g_variant_get(item, "s", &str);
+    g_variant_get(item, "&s", &str);
     fw_service_setDescription(obj, str);
     g_variant_unref(item);
 
@@ -92,7 +99,9 @@ fw_service_new_from_variant(GVariant *variant)
 
     /* 4: modules */
     item = g_variant_get_child_value(variant, 4);
-    fw_service_setModules(obj, fw_str_list_new_from_variant(item));
+    strs = fw_str_list_new_from_variant(item);
+    fw_service_setModules(obj, strs);
+    fw_str_list_free(strs);
     g_variant_unref(item);
 
     /* 5: destinations */
@@ -112,7 +121,9 @@ fw_service_new_from_variant(GVariant *variant)
            g_variant_get(item2, "s", &value);
            g_variant_unref(item2);
 
-           fw_service_setDestination(obj, g_strdup(key), g_strdup(value));
+           fw_service_setDestination(obj, key, value);
+           g_free(key);
+           g_free(value);
            g_variant_unref(element);
        }
     }
@@ -120,7 +131,9 @@ fw_service_new_from_variant(GVariant *variant)
 
     /* 6: protocols */
     item = g_variant_get_child_value(variant, 6);
-    fw_service_setProtocols(obj, fw_str_list_new_from_variant(item));
+    strs = fw_str_list_new_from_variant(item);
+    fw_service_setProtocols(obj, strs);
+    fw_str_list_free(strs);
     g_variant_unref(item);
 
     /* 7: source ports */
@@ -128,6 +141,9 @@ fw_service_new_from_variant(GVariant *variant)
     fw_service_setSourcePorts(obj, fw_port_list_new_from_variant(item));
     g_variant_unref(item);
 
+    g_variant_unref(variant);
+
+    FW_TRACE_DECODE_DONE();
     return obj;
 }
 
@@ -188,6 +204,7 @@ fw_service_init(FWService *obj)
     priv->destinations = g_hash_table_new(g_str_hash, g_str_equal);
     priv->protocols = NULL;
     priv->source_ports = fw_port_list_new();
+    priv->fingerprint_valid = FALSE;
 }
 
 static void
@@ -202,7 +219,7 @@ fw_service_finalize(GObject *obj)
     if (priv->description != NULL)
 	g_free(priv->description);
     if (priv->ports != NULL)
-	fw_port_list_free(priv->ports);
+	g_object_unref(priv->ports);
     if (priv->modules != NULL)
 	fw_str_list_free(priv->modules);
     if (priv->destinations != NULL)
@@ -210,7 +227,7 @@ fw_service_finalize(GObject *obj)
     if (priv->protocols != NULL)
 	fw_str_list_free(priv->protocols);
     if (priv->source_ports != NULL)
-	fw_port_list_free(priv->source_ports);
+	g_object_unref(priv->source_ports);
     G_OBJECT_CLASS(fw_service_parent_class)->finalize(obj);
 }
 
@@ -222,6 +239,7 @@ fw_service_class_init(FWServiceClass *fw_service_class)
     obj_class->finalize = fw_service_finalize;
 
     g_type_class_add_private(obj_class, sizeof(FWServicePrivate));
+    fw_accounting_register(obj_class, sizeof(FWServicePrivate));
 }
 
 /* methods */
@@ -328,6 +346,7 @@ fw_service_setVersion(FWService *obj,
     if (priv->version != NULL)
 	g_free(priv->version);
     priv->version = g_strdup(version);
+    priv->fingerprint_valid = FALSE;
 }
 
 /**
@@ -352,6 +371,7 @@ fw_service_setShort(FWService *obj,
     if (priv->short_description != NULL)
 	g_free(priv->short_description);
     priv->short_description = g_strdup(short_description);
+    priv->fingerprint_valid = FALSE;
 }
 
 /**
@@ -376,6 +396,7 @@ fw_service_setDescription(FWService *obj,
     if (priv->description != NULL)
 	g_free(priv->description);
     priv->description = g_strdup(description);
+    priv->fingerprint_valid = FALSE;
 }
 
 /**
@@ -394,7 +415,8 @@ fw_service_getPorts(FWService *obj)
 /**
  * fw_service_setPorts:
  * @obj: (type FWService*): a FWService instance
- * @ports: (type FWPortList*)
+ * @ports: (type FWPortList*) (transfer full): the list is owned by @obj
+ *   afterwards
  */
 void
 fw_service_setPorts(FWService *obj,
@@ -402,9 +424,13 @@ fw_service_setPorts(FWService *obj,
 {
     FWServicePrivate *priv = FW_SERVICE_GET_PRIVATE(obj);
 
+    if (ports == priv->ports)
+	return;
+
     if (priv->ports != NULL)
-	fw_port_list_free(priv->ports);
+	g_object_unref(priv->ports);
     priv->ports = ports;
+    priv->fingerprint_valid = FALSE;
 }
 
 void
@@ -416,6 +442,7 @@ fw_service_addPort(FWService *obj,
     FWPort *item = fw_port_new(port, protocol);
 
     fw_port_list_add(priv->ports, item);
+    priv->fingerprint_valid = FALSE;
 }
 
 void
@@ -427,6 +454,7 @@ fw_service_removePort(FWService *obj,
     FWPort *item = fw_port_new(port, protocol);
 
     fw_port_list_remove(priv->ports, item);
+    priv->fingerprint_valid = FALSE;
 }
 
 gboolean
@@ -447,6 +475,7 @@ fw_service_add_port(FWService *obj,
     FWServicePrivate *priv = FW_SERVICE_GET_PRIVATE(obj);
 
     fw_port_list_add(priv->ports, port);
+    priv->fingerprint_valid = FALSE;
 }
 
 void
@@ -456,6 +485,7 @@ fw_service_remove_port(FWService *obj,
     FWServicePrivate *priv = FW_SERVICE_GET_PRIVATE(obj);
 
     fw_port_list_remove(priv->ports, port);
+    priv->fingerprint_valid = FALSE;
 }
 
 gboolean
@@ -494,6 +524,7 @@ fw_service_setProtocols(FWService *obj,
     if (priv->protocols != NULL)
 	fw_str_list_free(priv->protocols);
     priv->protocols = fw_str_list_copy(protocols);
+    priv->fingerprint_valid = FALSE;
 }
 
 void
@@ -503,6 +534,7 @@ fw_service_addProtocol(FWService *obj,
     FWServicePrivate *priv = FW_SERVICE_GET_PRIVATE(obj);
 
     priv->protocols = fw_str_list_append(priv->protocols, protocol);
+    priv->fingerprint_valid = FALSE;
 }
 
 void
@@ -512,6 +544,7 @@ fw_service_removeProtocol(FWService *obj,
     FWServicePrivate *priv = FW_SERVICE_GET_PRIVATE(obj);
 
     priv->protocols = fw_str_list_remove(priv->protocols, protocol);
+    priv->fingerprint_valid = FALSE;
 }
 
 gboolean
@@ -539,7 +572,8 @@ fw_service_getSourcePorts(FWService *obj)
 /**
  * fw_service_setSourcePorts:
  * @obj: (type FWService*): a FWService instance
- * @ports: (type FWPortList*)
+ * @ports: (type FWPortList*) (transfer full): the list is owned by @obj
+ *   afterwards
  */
 void
 fw_service_setSourcePorts(FWService *obj,
@@ -547,9 +581,13 @@ fw_service_setSourcePorts(FWService *obj,
 {
     FWServicePrivate *priv = FW_SERVICE_GET_PRIVATE(obj);
 
+    if (ports == priv->source_ports)
+	return;
+
     if (priv->source_ports != NULL)
-	fw_port_list_free(priv->source_ports);
+	g_object_unref(priv->source_ports);
     priv->source_ports = ports;
+    priv->fingerprint_valid = FALSE;
 }
 
 void
@@ -561,6 +599,7 @@ fw_service_addSourcePort(FWService *obj,
     FWPort *item = fw_port_new(port, protocol);
 
     fw_port_list_add(priv->source_ports, item);
+    priv->fingerprint_valid = FALSE;
 }
 
 void
@@ -572,6 +611,7 @@ fw_service_removeSourcePort(FWService *obj,
     FWPort *item = fw_port_new(port, protocol);
 
     fw_port_list_remove(priv->source_ports, item);
+    priv->fingerprint_valid = FALSE;
 }
 
 gboolean
@@ -592,6 +632,7 @@ fw_service_add_source_port(FWService *obj,
     FWServicePrivate *priv = FW_SERVICE_GET_PRIVATE(obj);
 
     fw_port_list_add(priv->source_ports, port);
+    priv->fingerprint_valid = FALSE;
 }
 
 void
@@ -601,6 +642,7 @@ fw_service_remove_source_port(FWService *obj,
     FWServicePrivate *priv = FW_SERVICE_GET_PRIVATE(obj);
 
     fw_port_list_remove(priv->source_ports, port);
+    priv->fingerprint_valid = FALSE;
 }
 
 gboolean
@@ -639,7 +681,8 @@ fw_service_setModules(FWService *obj,
 
     if (priv->modules != NULL)
 	fw_str_list_free(priv->modules);
-    priv->protocols = fw_str_list_copy(modules);
+    priv->modules = fw_str_list_copy(modules);
+    priv->fingerprint_valid = FALSE;
 }
 
 void
@@ -649,6 +692,7 @@ fw_service_addModule(FWService *obj,
     FWServicePrivate *priv = FW_SERVICE_GET_PRIVATE(obj);
 
     priv->modules = fw_str_list_append(priv->modules, module);
+    priv->fingerprint_valid = FALSE;
 }
 
 void
@@ -658,6 +702,7 @@ fw_service_removeModule(FWService *obj,
     FWServicePrivate *priv = FW_SERVICE_GET_PRIVATE(obj);
 
     priv->modules = fw_str_list_remove(priv->modules, module);
+    priv->fingerprint_valid = FALSE;
 }
 
 gboolean
@@ -703,6 +748,7 @@ fw_service_setDestination(FWService *obj,
     FWServicePrivate *priv = FW_SERVICE_GET_PRIVATE(obj);
 
     g_hash_table_replace(priv->destinations, g_strdup(ipv), g_strdup(address));
+    priv->fingerprint_valid = FALSE;
 }
 
 void
@@ -712,6 +758,7 @@ fw_service_removeDestination(FWService *obj,
     FWServicePrivate *priv = FW_SERVICE_GET_PRIVATE(obj);
 
     g_hash_table_remove(priv->destinations, ipv);
+    priv->fingerprint_valid = FALSE;
 }
 
 gboolean
@@ -725,3 +772,54 @@ fw_service_queryDestination(FWService *obj,
     value = g_hash_table_lookup(priv->destinations, ipv);
     return (strcmp(value, address) == 0);
 }
+
+/* fingerprint */
+
+/**
+ * fw_service_getFingerprint:
+ * @obj: (type FWService*): a FWService instance
+ *
+ * Order insensitive structural hash of the settings, cached until the
+ * next change through the FWService methods.
+ *
+ * Returns: (transfer none): fingerprint of the settings
+ */
+const FWFingerprint *
+fw_service_getFingerprint(FWService *obj)
+{
+    FWServicePrivate *priv = FW_SERVICE_GET_PRIVATE(obj);
+    GVariant *variant;
+
+    if (!priv->fingerprint_valid) {
+	variant = g_variant_ref_sink(fw_service_to_variant(obj));
+	fw_fingerprint_variant(variant, &priv->fingerprint);
+	g_variant_unref(variant);
+	priv->fingerprint_valid = TRUE;
+    }
+
+    return &priv->fingerprint;
+}
+
+/**
+ * fw_service_equal:
+ * @a: (type FWService*): a FWService instance
+ * @b: (type FWService*): a FWService instance
+ *
+ * Returns: TRUE if the settings are equal up to the order of list items
+ */
+gboolean
+fw_service_equal(FWService *a,
+		 FWService *b)
+{
+    if (a == b)
+	return TRUE;
+
+    return fw_fingerprint_equal(fw_service_getFingerprint(a),
+				fw_service_getFingerprint(b));
+}
+
+guint
+fw_service_hash(FWService *obj)
+{
+    return fw_fingerprint_hash(fw_service_getFingerprint(obj));
+}
@@ -24,6 +24,7 @@
 #include <glib.h>
 #include <glib-object.h>
 #include "firewall.h"
+#include "fw_fingerprint.h"
 #include "fw_functions.h"
 #include "fw_port.h"
 #include "fw_port_list.h"
@@ -98,4 +99,8 @@ void fw_service_setDestination(FWService *obj, gchar *ipv, gchar *address);
 void fw_service_removeDestination(FWService *obj, gchar *ipv);
 gboolean fw_service_queryDestination(FWService *obj, gchar *ipv, gchar *address);
 
+const FWFingerprint *fw_service_getFingerprint(FWService *obj);
+gboolean fw_service_equal(FWService *a, FWService *b);
+guint fw_service_hash(FWService *obj);
+
 #endif /* __FW_SERVICE_H__ */
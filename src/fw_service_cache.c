@@ -0,0 +1,612 @@
+/*
+ * Copyright (C) 2017 Red Hat, Inc.
+ *
+ * Authors:
+ * Thomas Woerner <twoerner@redhat.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Cache of the runtime service definitions. Services can not be changed in
+ * the runtime configuration, they only change with a reload, so the cache
+ * is valid until fw_service_cache_invalidate is called for the next
+ * configuration generation.
+ *
+ * The expansion of a zone, the union of the zone settings with the
+ * settings of all of its services, is kept per zone name and recomputed
+ * only if the generation or the services, ports or protocols of the zone
+ * changed. Ports are normalized per protocol: sorted and with overlapping
+ * and adjacent ranges merged.
+ */
+
+#include <string.h>
+#include "fw_service_cache.h"
+#include "fw_accounting.h"
+#include "fw_batch.h"
+#include "fw_port.h"
+#include "fw_functions.h"
+
+G_DEFINE_TYPE(FWServiceCache, fw_service_cache, G_TYPE_OBJECT);
+
+#define FW_SERVICE_CACHE_GET_PRIVATE(o) (G_TYPE_INSTANCE_GET_PRIVATE((o), FW_SERVICE_CACHE_TYPE, FWServiceCachePrivate))
+
+typedef struct {
+    guint generation;
+    gchar *signature;		/* services, ports and protocols of the zone */
+    GPtrArray *ports;		/* port, protocol, port, protocol, ... */
+    GPtrArray *source_ports;	/* port, protocol, port, protocol, ... */
+    GList *protocols;		/* sorted */
+    GList *modules;		/* sorted */
+} FWServiceCacheExpansion;
+
+typedef struct {
+    GDBusConnection *connection;
+    guint generation;
+    GHashTable *services;	/* name -> FWService */
+    GHashTable *expansions;	/* zone name -> FWServiceCacheExpansion */
+} FWServiceCachePrivate;
+
+/* port ranges of one protocol */
+typedef struct {
+    guint lo;
+    guint hi;
+} FWServiceCacheRange;
+
+typedef struct {
+    GArray *ranges;		/* FWServiceCacheRange */
+    GHashTable *names;		/* ports that are not numbers */
+} FWServiceCacheProtocol;
+
+static void
+_fw_service_cache_expansion_free(gpointer data)
+{
+    FWServiceCacheExpansion *expansion = data;
+
+    g_free(expansion->signature);
+    g_ptr_array_unref(expansion->ports);
+    g_ptr_array_unref(expansion->source_ports);
+    fw_str_list_free(expansion->protocols);
+    fw_str_list_free(expansion->modules);
+    g_slice_free(FWServiceCacheExpansion, expansion);
+}
+
+static void
+_fw_service_cache_protocol_free(gpointer data)
+{
+    FWServiceCacheProtocol *protocol = data;
+
+    g_array_unref(protocol->ranges);
+    g_hash_table_destroy(protocol->names);
+    g_slice_free(FWServiceCacheProtocol, protocol);
+}
+
+/**
+ * fw_service_cache_new:
+ * @connection: (type GDBusConnection*): connection to the system bus
+ *
+ * Returns: (transfer full) (type FWServiceCache*)
+ */
+FWServiceCache *
+fw_service_cache_new(GDBusConnection *connection)
+{
+    FWServiceCache *obj = g_object_new(FW_SERVICE_CACHE_TYPE, NULL);
+    FWServiceCachePrivate *priv = FW_SERVICE_CACHE_GET_PRIVATE(obj);
+
+    if (connection != NULL)
+	priv->connection = g_object_ref(connection);
+
+    return obj;
+}
+
+static void
+fw_service_cache_init(FWServiceCache *obj)
+{
+    FWServiceCachePrivate *priv = FW_SERVICE_CACHE_GET_PRIVATE(obj);
+
+    /* init vars */
+    priv->connection = NULL;
+    priv->generation = 0;
+    priv->services = g_hash_table_new_full(g_str_hash, g_str_equal,
+					   g_free, g_object_unref);
+    priv->expansions = g_hash_table_new_full(g_str_hash, g_str_equal,
+					     g_free,
+					     _fw_service_cache_expansion_free);
+}
+
+static void
+fw_service_cache_finalize(GObject *obj)
+{
+    FWServiceCachePrivate *priv = FW_SERVICE_CACHE_GET_PRIVATE(obj);
+
+    g_hash_table_destroy(priv->services);
+    g_hash_table_destroy(priv->expansions);
+    if (priv->connection != NULL)
+	g_object_unref(priv->connection);
+
+    G_OBJECT_CLASS(fw_service_cache_parent_class)->finalize(obj);
+}
+
+static void
+fw_service_cache_class_init(FWServiceCacheClass *fw_service_cache_class)
+{
+    GObjectClass *obj_class = G_OBJECT_CLASS(fw_service_cache_class);
+
+    obj_class->finalize = fw_service_cache_finalize;
+
+    g_type_class_add_private(obj_class, sizeof(FWServiceCachePrivate));
+    fw_accounting_register(obj_class, sizeof(FWServiceCachePrivate));
+}
+
+/* methods */
+
+/**
+ * fw_service_cache_invalidate:
+ * @obj: (type FWServiceCache*): a FWServiceCache instance
+ *
+ * Drops all services and expansions and starts a new generation, to be
+ * called after firewalld has been reloaded.
+ */
+void
+fw_service_cache_invalidate(FWServiceCache *obj)
+{
+    FWServiceCachePrivate *priv = FW_SERVICE_CACHE_GET_PRIVATE(obj);
+
+#ifdef FW_DEBUG
+    g_printerr("fw_service_cache_invalidate(): generation %u\n",
+	       priv->generation + 1);
+#endif
+
+    g_hash_table_remove_all(priv->services);
+    g_hash_table_remove_all(priv->expansions);
+    priv->generation++;
+}
+
+guint
+fw_service_cache_getGeneration(FWServiceCache *obj)
+{
+    FWServiceCachePrivate *priv = FW_SERVICE_CACHE_GET_PRIVATE(obj);
+
+    return priv->generation;
+}
+
+/* gets all services of the list that are not cached yet with one batch */
+static void
+_fw_service_cache_fetch(FWServiceCachePrivate *priv,
+			GList *names)
+{
+    FWBatch *batch;
+    GPtrArray *missing;
+    GList *l;
+    guint i;
+
+    missing = g_ptr_array_new();
+    for (l = names; l != NULL; l = l->next) {
+	if (!g_hash_table_contains(priv->services, l->data))
+	    g_ptr_array_add(missing, l->data);
+    }
+    if (missing->len == 0 || priv->connection == NULL) {
+	g_ptr_array_unref(missing);
+	return;
+    }
+
+    batch = fw_batch_new(priv->connection);
+    for (i = 0; i < missing->len; i++) {
+	fw_batch_add(batch, FW_DBUS_PATH, FW_DBUS_INTERFACE,
+		     "getServiceSettings",
+		     g_variant_new("(s)",
+				   (gchar *) g_ptr_array_index(missing, i)));
+    }
+    fw_batch_run(batch, NULL);
+
+    for (i = 0; i < missing->len; i++) {
+	const gchar *name = g_ptr_array_index(missing, i);
+	const GError *error = fw_batch_getError(batch, i);
+	FWService *service;
+
+	if (error != NULL) {
+	    g_print(_("ERROR: getServiceSettings(%s) failed: %s\n"),
+		    name, error->message);
+	    continue;
+	}
+
+	service = fw_service_new_from_variant(fw_batch_getResult(batch, i));
+	if (service != NULL)
+	    g_hash_table_insert(priv->services, g_strdup(name), service);
+    }
+
+    g_object_unref(batch);
+    g_ptr_array_unref(missing);
+}
+
+/**
+ * fw_service_cache_getService:
+ * @obj: (type FWServiceCache*): a FWServiceCache instance
+ * @name: (type utf8): service name
+ *
+ * Returns: (transfer none) (allow-none) (type FWService*): cached service,
+ *   valid until the cache is invalidated
+ */
+FWService *
+fw_service_cache_getService(FWServiceCache *obj,
+			    const gchar *name)
+{
+    FWServiceCachePrivate *priv = FW_SERVICE_CACHE_GET_PRIVATE(obj);
+    GList list = { (gpointer) name, NULL, NULL };
+
+    _fw_service_cache_fetch(priv, &list);
+
+    return g_hash_table_lookup(priv->services, name);
+}
+
+/* port normalization */
+
+static gboolean
+_fw_service_cache_parse_port(const gchar *str,
+			     guint *value)
+{
+    gchar *end;
+    guint64 port;
+
+    if (!g_ascii_isdigit(*str))
+	return FALSE;
+    port = g_ascii_strtoull(str, &end, 10);
+    if (*end != '\0' || port > 65535)
+	return FALSE;
+    *value = port;
+    return TRUE;
+}
+
+static void
+_fw_service_cache_ports_add(GHashTable *protocols,
+			    FWPortList *ports)
+{
+    GList *l;
+
+    if (ports == NULL)
+	return;
+
+    for (l = fw_port_list_getPorts(ports); l != NULL; l = l->next) {
+	const gchar *port = fw_port_getPort(l->data);
+	const gchar *protocol_name = fw_port_getProtocol(l->data);
+	FWServiceCacheProtocol *protocol;
+	FWServiceCacheRange range;
+	gchar **parts;
+	gboolean ok;
+
+	protocol = g_hash_table_lookup(protocols, protocol_name);
+	if (protocol == NULL) {
+	    protocol = g_slice_new(FWServiceCacheProtocol);
+	    protocol->ranges = g_array_new(FALSE, FALSE,
+					   sizeof(FWServiceCacheRange));
+	    protocol->names = g_hash_table_new(g_str_hash, g_str_equal);
+	    g_hash_table_insert(protocols, (gpointer) protocol_name,
+				protocol);
+	}
+
+	parts = g_strsplit(port, "-", 2);
+	ok = (parts[0] != NULL &&
+	      _fw_service_cache_parse_port(parts[0], &range.lo));
+	if (ok && parts[1] != NULL)
+	    ok = _fw_service_cache_parse_port(parts[1], &range.hi);
+	else
+	    range.hi = range.lo;
+	g_strfreev(parts);
+
+	if (ok) {
+	    if (range.lo > range.hi) {
+		guint tmp = range.lo;
+		range.lo = range.hi;
+		range.hi = tmp;
+	    }
+	    g_array_append_val(protocol->ranges, range);
+	} else
+	    g_hash_table_add(protocol->names, (gpointer) port);
+    }
+}
+
+static gint
+_fw_service_cache_range_cmp(gconstpointer a,
+			    gconstpointer b)
+{
+    const FWServiceCacheRange *range_a = a;
+    const FWServiceCacheRange *range_b = b;
+
+    if (range_a->lo != range_b->lo)
+	return (range_a->lo < range_b->lo) ? -1 : 1;
+    if (range_a->hi != range_b->hi)
+	return (range_a->hi < range_b->hi) ? -1 : 1;
+    return 0;
+}
+
+static gint
+_fw_service_cache_str_cmp(gconstpointer a,
+			  gconstpointer b)
+{
+    return strcmp(*(const gchar **) a, *(const gchar **) b);
+}
+
+/* sorted by protocol, merged ranges first, then named ports */
+static GPtrArray *
+_fw_service_cache_ports_merge(GHashTable *protocols)
+{
+    GPtrArray *ports = g_ptr_array_new_with_free_func(g_free);
+    GList *names, *l;
+
+    names = g_list_sort(g_hash_table_get_keys(protocols),
+			(GCompareFunc) strcmp);
+    for (l = names; l != NULL; l = l->next) {
+	FWServiceCacheProtocol *protocol = g_hash_table_lookup(protocols,
+							       l->data);
+	GArray *ranges = protocol->ranges;
+	GPtrArray *named;
+	GHashTableIter iter;
+	gpointer key;
+	guint i, j;
+
+	g_array_sort(ranges, _fw_service_cache_range_cmp);
+	for (i = 0; i < ranges->len; i = j) {
+	    FWServiceCacheRange range = g_array_index(ranges,
+						      FWServiceCacheRange, i);
+
+	    for (j = i + 1; j < ranges->len; j++) {
+		FWServiceCacheRange *next = &g_array_index(ranges,
+							   FWServiceCacheRange,
+							   j);
+		if (next->lo > range.hi + 1)
+		    break;
+		range.hi = MAX(range.hi, next->hi);
+	    }
+
+	    if (range.lo == range.hi)
+		g_ptr_array_add(ports, g_strdup_printf("%u", range.lo));
+	    else
+		g_ptr_array_add(ports, g_strdup_printf("%u-%u", range.lo,
+						       range.hi));
+	    g_ptr_array_add(ports, g_strdup(l->data));
+	}
+
+	named = g_ptr_array_new();
+	g_hash_table_iter_init(&iter, protocol->names);
+	while (g_hash_table_iter_next(&iter, &key, NULL))
+	    g_ptr_array_add(named, key);
+	g_ptr_array_sort(named, _fw_service_cache_str_cmp);
+	for (i = 0; i < named->len; i++) {
+	    g_ptr_array_add(ports, g_strdup(g_ptr_array_index(named, i)));
+	    g_ptr_array_add(ports, g_strdup(l->data));
+	}
+	g_ptr_array_unref(named);
+    }
+    g_list_free(names);
+
+    return ports;
+}
+
+static void
+_fw_service_cache_str_set_add(GHashTable *set,
+			      GList *list)
+{
+    GList *l;
+
+    for (l = list; l != NULL; l = l->next)
+	g_hash_table_add(set, l->data);
+}
+
+/* sorted copy of the strings in set */
+static GList *
+_fw_service_cache_str_set_list(GHashTable *set)
+{
+    GList *list, *l;
+
+    list = g_list_sort(g_hash_table_get_keys(set), (GCompareFunc) strcmp);
+    for (l = list; l != NULL; l = l->next)
+	l->data = g_strdup(l->data);
+
+    return list;
+}
+
+static void
+_fw_service_cache_signature_ports(GString *signature,
+				  FWPortList *ports)
+{
+    GList *l;
+
+    g_string_append_c(signature, '|');
+    if (ports == NULL)
+	return;
+    for (l = fw_port_list_getPorts(ports); l != NULL; l = l->next)
+	g_string_append_printf(signature, "%s/%s ",
+			       fw_port_getPort(l->data),
+			       fw_port_getProtocol(l->data));
+}
+
+static gchar *
+_fw_service_cache_signature(FWZone *zone)
+{
+    GString *signature = g_string_new("");
+    GList *l;
+
+    for (l = fw_zone_getServices(zone); l != NULL; l = l->next)
+	g_string_append_printf(signature, "%s ", (gchar *) l->data);
+    _fw_service_cache_signature_ports(signature, fw_zone_getPorts(zone));
+    _fw_service_cache_signature_ports(signature,
+				      fw_zone_getSourcePorts(zone));
+    g_string_append_c(signature, '|');
+    for (l = fw_zone_getProtocols(zone); l != NULL; l = l->next)
+	g_string_append_printf(signature, "%s ", (gchar *) l->data);
+
+    return g_string_free(signature, FALSE);
+}
+
+static FWServiceCacheExpansion *
+_fw_service_cache_expand(FWServiceCachePrivate *priv,
+			 const gchar *name,
+			 FWZone *zone)
+{
+    FWServiceCacheExpansion *expansion;
+    GHashTable *ports, *source_ports, *protocols, *modules;
+    gchar *signature;
+    GList *l;
+
+    signature = _fw_service_cache_signature(zone);
+    expansion = g_hash_table_lookup(priv->expansions, name);
+    if (expansion != NULL &&
+	expansion->generation == priv->generation &&
+	strcmp(expansion->signature, signature) == 0)
+    {
+	g_free(signature);
+	return expansion;
+    }
+
+#ifdef FW_DEBUG
+    g_printerr("_fw_service_cache_expand('%s'): generation %u\n", name,
+	       priv->generation);
+#endif
+
+    _fw_service_cache_fetch(priv, fw_zone_getServices(zone));
+
+    ports = g_hash_table_new_full(g_str_hash, g_str_equal, NULL,
+				  _fw_service_cache_protocol_free);
+    source_ports = g_hash_table_new_full(g_str_hash, g_str_equal, NULL,
+					 _fw_service_cache_protocol_free);
+    protocols = g_hash_table_new(g_str_hash, g_str_equal);
+    modules = g_hash_table_new(g_str_hash, g_str_equal);
+
+    _fw_service_cache_ports_add(ports, fw_zone_getPorts(zone));
+    _fw_service_cache_ports_add(source_ports, fw_zone_getSourcePorts(zone));
+    _fw_service_cache_str_set_add(protocols, fw_zone_getProtocols(zone));
+
+    for (l = fw_zone_getServices(zone); l != NULL; l = l->next) {
+	FWService *service = g_hash_table_lookup(priv->services, l->data);
+
+	if (service == NULL)
+	    continue;
+	_fw_service_cache_ports_add(ports, fw_service_getPorts(service));
+	_fw_service_cache_ports_add(source_ports,
+				    fw_service_getSourcePorts(service));
+	_fw_service_cache_str_set_add(protocols,
+				      fw_service_getProtocols(service));
+	_fw_service_cache_str_set_add(modules,
+				      fw_service_getModules(service));
+    }
+
+    expansion = g_slice_new(FWServiceCacheExpansion);
+    expansion->generation = priv->generation;
+    expansion->signature = signature;
+    expansion->ports = _fw_service_cache_ports_merge(ports);
+    expansion->source_ports = _fw_service_cache_ports_merge(source_ports);
+    expansion->protocols = _fw_service_cache_str_set_list(protocols);
+    expansion->modules = _fw_service_cache_str_set_list(modules);
+    g_hash_table_replace(priv->expansions, g_strdup(name), expansion);
+
+    g_hash_table_destroy(ports);
+    g_hash_table_destroy(source_ports);
+    g_hash_table_destroy(protocols);
+    g_hash_table_destroy(modules);
+
+    return expansion;
+}
+
+static FWPortList *
+_fw_service_cache_port_list(GPtrArray *ports)
+{
+    FWPortList *list = fw_port_list_new();
+    guint i;
+
+    for (i = 0; i + 1 < ports->len; i += 2)
+	fw_port_list_addPort(list, g_ptr_array_index(ports, i),
+			     g_ptr_array_index(ports, i + 1));
+
+    return list;
+}
+
+/**
+ * fw_service_cache_getEffectivePorts:
+ * @obj: (type FWServiceCache*): a FWServiceCache instance
+ * @name: (type utf8): zone name
+ * @zone: (type FWZone*): current settings of the zone
+ *
+ * Returns: (transfer full) (type FWPortList*): ports of the zone and its
+ *   services, sorted by protocol and with merged port ranges
+ */
+FWPortList *
+fw_service_cache_getEffectivePorts(FWServiceCache *obj,
+				   const gchar *name,
+				   FWZone *zone)
+{
+    FWServiceCachePrivate *priv = FW_SERVICE_CACHE_GET_PRIVATE(obj);
+
+    return _fw_service_cache_port_list(
+	_fw_service_cache_expand(priv, name, zone)->ports);
+}
+
+/**
+ * fw_service_cache_getEffectiveSourcePorts:
+ * @obj: (type FWServiceCache*): a FWServiceCache instance
+ * @name: (type utf8): zone name
+ * @zone: (type FWZone*): current settings of the zone
+ *
+ * Returns: (transfer full) (type FWPortList*): source ports of the zone
+ *   and its services, sorted by protocol and with merged port ranges
+ */
+FWPortList *
+fw_service_cache_getEffectiveSourcePorts(FWServiceCache *obj,
+					 const gchar *name,
+					 FWZone *zone)
+{
+    FWServiceCachePrivate *priv = FW_SERVICE_CACHE_GET_PRIVATE(obj);
+
+    return _fw_service_cache_port_list(
+	_fw_service_cache_expand(priv, name, zone)->source_ports);
+}
+
+/**
+ * fw_service_cache_getEffectiveProtocols:
+ * @obj: (type FWServiceCache*): a FWServiceCache instance
+ * @name: (type utf8): zone name
+ * @zone: (type FWZone*): current settings of the zone
+ *
+ * Returns: (transfer full) (element-type utf8): sorted protocols of the
+ *   zone and its services
+ */
+GList *
+fw_service_cache_getEffectiveProtocols(FWServiceCache *obj,
+				       const gchar *name,
+				       FWZone *zone)
+{
+    FWServiceCachePrivate *priv = FW_SERVICE_CACHE_GET_PRIVATE(obj);
+
+    return fw_str_list_copy(
+	_fw_service_cache_expand(priv, name, zone)->protocols);
+}
+
+/**
+ * fw_service_cache_getEffectiveModules:
+ * @obj: (type FWServiceCache*): a FWServiceCache instance
+ * @name: (type utf8): zone name
+ * @zone: (type FWZone*): current settings of the zone
+ *
+ * Returns: (transfer full) (element-type utf8): sorted netfilter helper
+ *   modules of the services of the zone
+ */
+GList *
+fw_service_cache_getEffectiveModules(FWServiceCache *obj,
+				     const gchar *name,
+				     FWZone *zone)
+{
+    FWServiceCachePrivate *priv = FW_SERVICE_CACHE_GET_PRIVATE(obj);
+
+    return fw_str_list_copy(
+	_fw_service_cache_expand(priv, name, zone)->modules);
+}
@@ -0,0 +1,61 @@
+/*
+ * Copyright (C) 2017 Red Hat, Inc.
+ *
+ * Authors:
+ * Thomas Woerner <twoerner@redhat.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __FW_SERVICE_CACHE_H__
+#define __FW_SERVICE_CACHE_H__
+
+#include <glib.h>
+#include <glib-object.h>
+#include <gio/gio.h>
+#include "firewall.h"
+#include "fw_service.h"
+#include "fw_zone.h"
+#include "fw_port_list.h"
+
+#define FW_SERVICE_CACHE_TYPE            (fw_service_cache_get_type())
+#define FW_SERVICE_CACHE(obj)            (G_TYPE_CHECK_INSTANCE_CAST((obj), FW_SERVICE_CACHE_TYPE, FWServiceCache))
+#define FW_SERVICE_CACHE_CLASS(klass)    (G_TYPE_CHECK_CLASS_CAST((klass), FW_SERVICE_CACHE_TYPE, FWServiceCacheClass))
+#define FW_IS_SERVICE_CACHE(klass)       (G_TYPE_CHECK_INSTANCE_CLASS((klass), FW_SERVICE_CACHE_TYPE, FWServiceCacheClass))
+#define FW_SERVICE_CACHE_GET_CLASS(obj)  (G_TYPE_INSTANCE_GET_CLASS((obj), FW_SERVICE_CACHE_TYPE, FWServiceCacheClass))
+
+typedef struct {
+    GObject parent;
+} FWServiceCache;
+
+typedef struct {
+    GObjectClass parent;
+} FWServiceCacheClass;
+
+GType fw_service_cache_get_type(void);
+FWServiceCache *fw_service_cache_new(GDBusConnection *connection);
+
+void fw_service_cache_invalidate(FWServiceCache *obj);
+guint fw_service_cache_getGeneration(FWServiceCache *obj);
+
+FWService *fw_service_cache_getService(FWServiceCache *obj, const gchar *name);
+
+/* zone settings expanded with the settings of its services */
+
+FWPortList *fw_service_cache_getEffectivePorts(FWServiceCache *obj, const gchar *name, FWZone *zone);
+FWPortList *fw_service_cache_getEffectiveSourcePorts(FWServiceCache *obj, const gchar *name, FWZone *zone);
+GList *fw_service_cache_getEffectiveProtocols(FWServiceCache *obj, const gchar *name, FWZone *zone);
+GList *fw_service_cache_getEffectiveModules(FWServiceCache *obj, const gchar *name, FWZone *zone);
+
+#endif /* __FW_SERVICE_CACHE_H__ */
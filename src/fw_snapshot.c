@@ -0,0 +1,1581 @@
+/*
+ * Copyright (C) 2017 Red Hat, Inc.
+ *
+ * Authors:
+ * Thomas Woerner <twoerner@redhat.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Snapshot file layout:
+ *
+ *   FWSnapshotHeader (64 bytes)
+ *   payload: serialized GVariant of type FW_SNAPSHOT_VARIANT_TYPE
+ *
+ * The header is followed directly by the payload, so the payload is 8 byte
+ * aligned inside the mapping and can be used by GVariant without copying.
+ * Named entries are stored as dictionaries sorted by name, lookups are done
+ * with a binary search on the mapped data.
+ */
+
+#include "fw_snapshot.h"
+#include "fw_trace.h"
+#include "fw_accounting.h"
+#include <stdlib.h>
+#include <string.h>
+
+G_DEFINE_TYPE(FWSnapshot, fw_snapshot, G_TYPE_OBJECT);
+
+#define FW_SNAPSHOT_GET_PRIVATE(o) (G_TYPE_INSTANCE_GET_PRIVATE((o), FW_SNAPSHOT_TYPE, FWSnapshotPrivate))
+
+#define FW_SNAPSHOT_BYTE_ORDER          0x01020304
+#define FW_SNAPSHOT_BYTE_ORDER_SWAPPED  0x04030201
+
+enum {
+    FW_SNAPSHOT_TIMESTAMP = 0,
+    FW_SNAPSHOT_ZONES,
+    FW_SNAPSHOT_SERVICES,
+    FW_SNAPSHOT_IPSETS,
+    FW_SNAPSHOT_ICMPTYPES,
+    FW_SNAPSHOT_HELPERS,
+    FW_SNAPSHOT_DIRECT_RULES,
+    FW_SNAPSHOT_PASSTHROUGHS,
+    FW_SNAPSHOT_N_ITEMS
+};
+
+static const gchar *_fw_snapshot_item_names[] = {
+    "timestamp",
+    "zone",
+    "service",
+    "ipset",
+    "icmptype",
+    "helper",
+    "direct rule",
+    "passthrough",
+};
+
+static const gchar *_fw_snapshot_item_types[] = {
+    "t",
+    "a{s(sssbsasa(ss)asba(ssss)asasasasa(ss)b)}",
+    "a{s(sssa(ss)asa{ss}asa(ss))}",
+    "a{s(ssssa{ss}as)}",
+    "a{s(sssas)}",
+    "a{s(sssssa(ss))}",
+    "a(sssias)",
+    "a(sas)",
+};
+
+typedef struct {
+    gchar magic[8];         /* FW_SNAPSHOT_MAGIC */
+    guint32 version;        /* FW_SNAPSHOT_FORMAT_VERSION */
+    guint32 byte_order;     /* FW_SNAPSHOT_BYTE_ORDER of the writer */
+    guint64 timestamp;      /* real time in microseconds */
+    guint64 size;           /* size of the payload */
+    guint8 checksum[32];    /* sha256 of the payload */
+} FWSnapshotHeader;
+
+G_STATIC_ASSERT(sizeof(FWSnapshotHeader) == 64);
+
+typedef struct {
+    guint64 timestamp;
+    GTree *entries[FW_SNAPSHOT_N_ITEMS];  /* name: GVariant, while writing */
+    GList *direct_rules;                  /* list of GVariant, while writing */
+    GList *passthroughs;                  /* list of GVariant, while writing */
+    GVariant *variant;                    /* sealed snapshot */
+    gboolean mapped;                      /* variant is backed by a file */
+    GHashTable *checked;                  /* "item/name": check result */
+    guint check_item;                     /* checkNext position */
+    gsize check_index;                    /* checkNext position */
+    gboolean stale;
+} FWSnapshotPrivate;
+
+enum {
+    FW_SNAPSHOT_CHECK_CONSISTENT = 1,
+    FW_SNAPSHOT_CHECK_STALE
+};
+
+static gint
+_fw_snapshot_str_compare(gconstpointer a,
+			 gconstpointer b,
+			 gpointer user_data)
+{
+    return strcmp(a, b);
+}
+
+static gint
+_fw_snapshot_dict_entry_compare(gconstpointer a,
+				gconstpointer b)
+{
+    GVariant *key_a = g_variant_get_child_value(*(GVariant **) a, 0);
+    GVariant *key_b = g_variant_get_child_value(*(GVariant **) b, 0);
+    gint ret;
+
+    ret = g_variant_compare(key_a, key_b);
+
+    g_variant_unref(key_a);
+    g_variant_unref(key_b);
+
+    return ret;
+}
+
+/*
+ * Returns a new reference of variant where all dictionaries are sorted by
+ * key. Dictionaries are created from hash tables in the objects, therefore
+ * the order of the entries is random.
+ */
+static GVariant *
+_fw_snapshot_normalize(GVariant *variant)
+{
+    GVariant **children;
+    GVariant *result = NULL;
+    const gchar *type;
+    gsize i, n;
+
+    if (!g_variant_is_container(variant))
+	return g_variant_ref(variant);
+
+    n = g_variant_n_children(variant);
+    children = g_new(GVariant *, n);
+    for (i=0; i<n; i++) {
+	GVariant *child = g_variant_get_child_value(variant, i);
+
+	children[i] = _fw_snapshot_normalize(child);
+	g_variant_unref(child);
+    }
+
+    type = g_variant_get_type_string(variant);
+    if (type[0] == 'a' && type[1] == '{')
+	qsort(children, n, sizeof(GVariant *), _fw_snapshot_dict_entry_compare);
+
+    switch (g_variant_classify(variant)) {
+    case G_VARIANT_CLASS_ARRAY:
+	result = g_variant_new_array(
+	    g_variant_type_element(g_variant_get_type(variant)), children, n);
+	break;
+    case G_VARIANT_CLASS_TUPLE:
+	result = g_variant_new_tuple(children, n);
+	break;
+    case G_VARIANT_CLASS_DICT_ENTRY:
+	result = g_variant_new_dict_entry(children[0], children[1]);
+	break;
+    case G_VARIANT_CLASS_VARIANT:
+	result = g_variant_new_variant(children[0]);
+	break;
+    default:
+	result = g_variant_ref(variant);
+	break;
+    }
+
+    for (i=0; i<n; i++)
+	g_variant_unref(children[i]);
+    g_free(children);
+
+    return g_variant_ref_sink(result);
+}
+
+/*
+ * Creates the snapshot entry from the result of a *_to_variant call. The
+ * returned variant is the plain settings tuple without the outer tuple that
+ * some of the objects add for D-Bus.
+ */
+static GVariant *
+_fw_snapshot_entry_new(GVariant *variant)
+{
+    GVariant *entry;
+
+    if (variant == NULL)
+	return NULL;
+
+    g_variant_ref_sink(variant);
+
+    if (strncmp(g_variant_get_type_string(variant), "((", 2) == 0) {
+	GVariant *child = g_variant_get_child_value(variant, 0);
+
+	entry = _fw_snapshot_normalize(child);
+	g_variant_unref(child);
+    } else
+	entry = _fw_snapshot_normalize(variant);
+
+    g_variant_unref(variant);
+
+    return entry;
+}
+
+/* wraps entry into a tuple for the *_new_from_variant functions */
+static GVariant *
+_fw_snapshot_entry_wrap(GVariant *entry)
+{
+    return g_variant_ref_sink(g_variant_new_tuple(&entry, 1));
+}
+
+static GVariant *
+_fw_snapshot_direct_rule_to_variant(FWDirectRule *rule)
+{
+    GVariantBuilder *builder = fw_str_list_to_builder(
+	fw_direct_rule_getArgs(rule));
+    GVariant *variant;
+
+    variant = g_variant_new("(sssias)",
+			    fw_direct_rule_getIpv(rule),
+			    fw_direct_rule_getTable(rule),
+			    fw_direct_rule_getChain(rule),
+			    fw_direct_rule_getPriority(rule),
+			    builder);
+
+    g_variant_builder_unref(builder);
+
+    return variant;
+}
+
+static GVariant *
+_fw_snapshot_passthrough_to_variant(FWPassthrough *passthrough)
+{
+    GVariantBuilder *builder = fw_str_list_to_builder(
+	fw_passthrough_getArgs(passthrough));
+    GVariant *variant;
+
+    variant = g_variant_new("(sas)",
+			    fw_passthrough_getIpv(passthrough),
+			    builder);
+
+    g_variant_builder_unref(builder);
+
+    return variant;
+}
+
+static gboolean
+_fw_snapshot_add_dict_entry(gpointer key,
+			    gpointer value,
+			    gpointer data)
+{
+    GVariantBuilder *builder = data;
+
+    g_variant_builder_add_value(builder,
+				g_variant_new_dict_entry(
+				    g_variant_new_string(key), value));
+
+    return FALSE;
+}
+
+/* builds the snapshot variant from the added entries */
+static GVariant *
+_fw_snapshot_seal(FWSnapshotPrivate *priv)
+{
+    GVariantBuilder builder;
+    GList *list;
+    guint i;
+
+    if (priv->variant != NULL)
+	return priv->variant;
+
+    g_variant_builder_init(&builder, G_VARIANT_TYPE(FW_SNAPSHOT_VARIANT_TYPE));
+
+    g_variant_builder_add(&builder, "t", priv->timestamp);
+
+    for (i=FW_SNAPSHOT_ZONES; i<=FW_SNAPSHOT_HELPERS; i++) {
+	g_variant_builder_open(&builder,
+			       G_VARIANT_TYPE(_fw_snapshot_item_types[i]));
+	g_tree_foreach(priv->entries[i], _fw_snapshot_add_dict_entry,
+		       &builder);
+	g_variant_builder_close(&builder);
+    }
+
+    g_variant_builder_open(&builder, G_VARIANT_TYPE(
+	_fw_snapshot_item_types[FW_SNAPSHOT_DIRECT_RULES]));
+    for (list = priv->direct_rules; list != NULL; list = list->next)
+	g_variant_builder_add_value(&builder, list->data);
+    g_variant_builder_close(&builder);
+
+    g_variant_builder_open(&builder, G_VARIANT_TYPE(
+	_fw_snapshot_item_types[FW_SNAPSHOT_PASSTHROUGHS]));
+    for (list = priv->passthroughs; list != NULL; list = list->next)
+	g_variant_builder_add_value(&builder, list->data);
+    g_variant_builder_close(&builder);
+
+    priv->variant = g_variant_ref_sink(g_variant_builder_end(&builder));
+
+    /* serialize now, lookups are done on the serialized data */
+    g_variant_get_data(priv->variant);
+
+    return priv->variant;
+}
+
+static gboolean
+_fw_snapshot_writable(FWSnapshotPrivate *priv)
+{
+    if (priv->mapped) {
+	g_print(_("ERROR: snapshot is read-only\n"));
+	return FALSE;
+    }
+
+    if (priv->variant != NULL) {
+	g_variant_unref(priv->variant);
+	priv->variant = NULL;
+    }
+
+    return TRUE;
+}
+
+static void
+_fw_snapshot_add_entry(FWSnapshotPrivate *priv,
+		       guint item,
+		       const gchar *name,
+		       GVariant *variant)
+{
+    GVariant *entry;
+
+    if (!_fw_snapshot_writable(priv)) {
+	g_variant_unref(g_variant_ref_sink(variant));
+	return;
+    }
+
+    entry = _fw_snapshot_entry_new(variant);
+    g_tree_replace(priv->entries[item], g_strdup(name), entry);
+}
+
+/*
+ * Binary search for name in the sorted dictionary of item.
+ * Returns: the settings of the entry (transfer full) or NULL
+ */
+static GVariant *
+_fw_snapshot_lookup(FWSnapshotPrivate *priv,
+		    guint item,
+		    const gchar *name)
+{
+    GVariant *dict, *ret = NULL;
+    gsize low, high;
+
+    if (name == NULL)
+	return NULL;
+
+    dict = g_variant_get_child_value(_fw_snapshot_seal(priv), item);
+
+    low = 0;
+    high = g_variant_n_children(dict);
+    while (low < high) {
+	gsize mid = low + (high - low) / 2;
+	GVariant *entry = g_variant_get_child_value(dict, mid);
+	GVariant *key = g_variant_get_child_value(entry, 0);
+	gint cmp = strcmp(name, g_variant_get_string(key, NULL));
+
+	g_variant_unref(key);
+
+	if (cmp == 0)
+	    ret = g_variant_get_child_value(entry, 1);
+	g_variant_unref(entry);
+
+	if (cmp == 0)
+	    break;
+	else if (cmp < 0)
+	    high = mid;
+	else
+	    low = mid + 1;
+    }
+
+    g_variant_unref(dict);
+
+    return ret;
+}
+
+/* Returns: list of copied names, the data goes away with the next change */
+static GList *
+_fw_snapshot_get_names(FWSnapshotPrivate *priv,
+		       guint item)
+{
+    GVariant *dict;
+    GList *list = NULL;
+    gsize i, n;
+
+    dict = g_variant_get_child_value(_fw_snapshot_seal(priv), item);
+
+    n = g_variant_n_children(dict);
+    for (i=0; i<n; i++) {
+	GVariant *entry = g_variant_get_child_value(dict, i);
+	GVariant *key = g_variant_get_child_value(entry, 0);
+
+	list = g_list_prepend(list, g_variant_dup_string(key, NULL));
+
+	g_variant_unref(key);
+	g_variant_unref(entry);
+    }
+
+    g_variant_unref(dict);
+
+    return g_list_reverse(list);
+}
+
+FWSnapshot *
+fw_snapshot_new()
+{
+    return g_object_new(FW_SNAPSHOT_TYPE, NULL);
+}
+
+/**
+ * fw_snapshot_new_from_variant:
+ * @variant: (type GVariant*): snapshot of type FW_SNAPSHOT_VARIANT_TYPE
+ *
+ * Creates a writable snapshot from the result of fw_snapshot_to_variant.
+ *
+ * Returns: (transfer full) (allow-none) (type FWSnapshot*)
+ */
+FWSnapshot *
+fw_snapshot_new_from_variant(GVariant *variant)
+{
+    FWSnapshot *obj;
+    FWSnapshotPrivate *priv;
+    GVariant *normalized, *child;
+    GList **lists[FW_SNAPSHOT_N_ITEMS];
+    guint i;
+    gsize j, n;
+
+    if (variant == NULL)
+	return NULL;
+
+    if (!g_variant_is_of_type(variant,
+			      G_VARIANT_TYPE(FW_SNAPSHOT_VARIANT_TYPE))) {
+	g_print(_("ERROR: Invalid snapshot type '%s'\n"),
+		g_variant_get_type_string(variant));
+	return NULL;
+    }
+
+    FW_TRACE_DECODE_START(variant);
+
+    obj = fw_snapshot_new();
+    priv = FW_SNAPSHOT_GET_PRIVATE(obj);
+
+    g_variant_ref_sink(variant);
+    normalized = _fw_snapshot_normalize(variant);
+    g_variant_unref(variant);
+
+    child = g_variant_get_child_value(normalized, FW_SNAPSHOT_TIMESTAMP);
+    priv->timestamp = g_variant_get_uint64(child);
+    g_variant_unref(child);
+
+    for (i=FW_SNAPSHOT_ZONES; i<=FW_SNAPSHOT_HELPERS; i++) {
+	GVariant *dict = g_variant_get_child_value(normalized, i);
+
+	n = g_variant_n_children(dict);
+	for (j=0; j<n; j++) {
+	    GVariant *entry = g_variant_get_child_value(dict, j);
+	    GVariant *key = g_variant_get_child_value(entry, 0);
+
+	    g_tree_replace(priv->entries[i],
+			   g_strdup(g_variant_get_string(key, NULL)),
+			   g_variant_get_child_value(entry, 1));
+
+	    g_variant_unref(key);
+	    g_variant_unref(entry);
+	}
+	g_variant_unref(dict);
+    }
+
+    lists[FW_SNAPSHOT_DIRECT_RULES] = &priv->direct_rules;
+    lists[FW_SNAPSHOT_PASSTHROUGHS] = &priv->passthroughs;
+    for (i=FW_SNAPSHOT_DIRECT_RULES; i<=FW_SNAPSHOT_PASSTHROUGHS; i++) {
+	GVariant *array = g_variant_get_child_value(normalized, i);
+
+	n = g_variant_n_children(array);
+	for (j=0; j<n; j++)
+	    *lists[i] = g_list_prepend(*lists[i],
+				       g_variant_get_child_value(array, j));
+	*lists[i] = g_list_reverse(*lists[i]);
+	g_variant_unref(array);
+    }
+
+    /* already sealed, the entries are kept for further additions */
+    priv->variant = normalized;
+    g_variant_get_data(priv->variant);
+
+    FW_TRACE_DECODE_DONE();
+    return obj;
+}
+
+/**
+ * fw_snapshot_new_from_client:
+ * @client: (type FWClient*): a FWClient instance
+ *
+ * Creates a snapshot of the runtime zones, services, ipsets, icmptypes,
+ * helpers, direct rules and passthroughs of firewalld.
+ *
+ * Returns: (transfer full) (type FWSnapshot*)
+ */
+FWSnapshot *
+fw_snapshot_new_from_client(FWClient *client)
+{
+    FWSnapshot *obj = fw_snapshot_new();
+    GList *names, *list, *l;
+
+#ifdef FW_DEBUG
+    g_printerr("fw_snapshot_new_from_client()\n");
+#endif
+
+    names = fw_client_getZones(client);
+    for (l = names; l != NULL; l = l->next) {
+	FWZone *zone = fw_client_getZoneSettings(client, l->data);
+
+	if (zone != NULL) {
+	    fw_snapshot_addZone(obj, l->data, zone);
+	    g_object_unref(zone);
+	}
+    }
+    fw_str_list_free(names);
+
+    names = fw_client_listServices(client);
+    for (l = names; l != NULL; l = l->next) {
+	FWService *service = fw_client_getServiceSettings(client, l->data);
+
+	if (service != NULL) {
+	    fw_snapshot_addService(obj, l->data, service);
+	    g_object_unref(service);
+	}
+    }
+    fw_str_list_free(names);
+
+    names = fw_client_listIPSets(client);
+    for (l = names; l != NULL; l = l->next) {
+	FWIPSet *ipset = fw_client_getIPSetSettings(client, l->data);
+
+	if (ipset != NULL) {
+	    fw_snapshot_addIPSet(obj, l->data, ipset);
+	    g_object_unref(ipset);
+	}
+    }
+    fw_str_list_free(names);
+
+    names = fw_client_listIcmpTypes(client);
+    for (l = names; l != NULL; l = l->next) {
+	FWIcmpType *icmptype = fw_client_getIcmpTypeSettings(client, l->data);
+
+	if (icmptype != NULL) {
+	    fw_snapshot_addIcmpType(obj, l->data, icmptype);
+	    g_object_unref(icmptype);
+	}
+    }
+    fw_str_list_free(names);
+
+    names = fw_client_listHelpers(client);
+    for (l = names; l != NULL; l = l->next) {
+	FWHelper *helper = fw_client_getHelperSettings(client, l->data);
+
+	if (helper != NULL) {
+	    fw_snapshot_addHelper(obj, l->data, helper);
+	    g_object_unref(helper);
+	}
+    }
+    fw_str_list_free(names);
+
+    list = fw_client_getAllRules(client);
+    for (l = list; l != NULL; l = l->next)
+	fw_snapshot_addDirectRule(obj, l->data);
+    g_list_free_full(list, g_object_unref);
+
+    list = fw_client_getAllPassthroughs(client);
+    for (l = list; l != NULL; l = l->next)
+	fw_snapshot_addPassthrough(obj, l->data);
+    g_list_free_full(list, g_object_unref);
+
+    return obj;
+}
+
+/**
+ * fw_snapshot_load:
+ * @filename: (type gchar*): snapshot file
+ *
+ * Maps a snapshot file created with fw_snapshot_save. The header and the
+ * checksum are verified, the data itself is not copied: names and strings
+ * are read directly from the mapped file.
+ *
+ * Returns: (transfer full) (allow-none) (type FWSnapshot*)
+ */
+FWSnapshot *
+fw_snapshot_load(const gchar *filename)
+{
+    FWSnapshot *obj;
+    FWSnapshotPrivate *priv;
+    FWSnapshotHeader header;
+    GMappedFile *mapped;
+    GBytes *bytes, *payload;
+    GChecksum *checksum;
+    GError *error = NULL;
+    GVariant *variant;
+    guint8 digest[32];
+    gsize digest_len = sizeof(digest);
+    const gchar *contents;
+    gsize length;
+
+#ifdef FW_DEBUG
+    g_printerr("fw_snapshot_load(%s)\n", filename);
+#endif
+
+    mapped = g_mapped_file_new(filename, FALSE, &error);
+    if (mapped == NULL) {
+	g_print(_("ERROR: Loading snapshot '%s' failed: %s\n"), filename,
+		error->message);
+	g_error_free(error);
+	return NULL;
+    }
+
+    contents = g_mapped_file_get_contents(mapped);
+    length = g_mapped_file_get_length(mapped);
+
+    if (length < sizeof(header)) {
+	g_print(_("ERROR: Snapshot '%s' is truncated\n"), filename);
+	g_mapped_file_unref(mapped);
+	return NULL;
+    }
+    memcpy(&header, contents, sizeof(header));
+
+    if (memcmp(header.magic, FW_SNAPSHOT_MAGIC, sizeof(header.magic)) != 0) {
+	g_print(_("ERROR: '%s' is not a snapshot\n"), filename);
+	g_mapped_file_unref(mapped);
+	return NULL;
+    }
+
+    if (header.byte_order == FW_SNAPSHOT_BYTE_ORDER_SWAPPED) {
+	header.version = GUINT32_SWAP_LE_BE(header.version);
+	header.timestamp = GUINT64_SWAP_LE_BE(header.timestamp);
+	header.size = GUINT64_SWAP_LE_BE(header.size);
+    } else if (header.byte_order != FW_SNAPSHOT_BYTE_ORDER) {
+	g_print(_("ERROR: Snapshot '%s' has an invalid byte order\n"),
+		filename);
+	g_mapped_file_unref(mapped);
+	return NULL;
+    }
+
+    if (header.version != FW_SNAPSHOT_FORMAT_VERSION) {
+	g_print(_("ERROR: Snapshot '%s' has unsupported version %u\n"),
+		filename, header.version);
+	g_mapped_file_unref(mapped);
+	return NULL;
+    }
+
+    if (header.size != length - sizeof(header)) {
+	g_print(_("ERROR: Snapshot '%s' is truncated\n"), filename);
+	g_mapped_file_unref(mapped);
+	return NULL;
+    }
+
+    checksum = g_checksum_new(G_CHECKSUM_SHA256);
+    g_checksum_update(checksum, (const guchar *) contents + sizeof(header),
+		      header.size);
+    g_checksum_get_digest(checksum, digest, &digest_len);
+    g_checksum_free(checksum);
+
+    if (memcmp(digest, header.checksum, sizeof(digest)) != 0) {
+	g_print(_("ERROR: Snapshot '%s' has an invalid checksum\n"), filename);
+	g_mapped_file_unref(mapped);
+	return NULL;
+    }
+
+    bytes = g_mapped_file_get_bytes(mapped);
+    payload = g_bytes_new_from_bytes(bytes, sizeof(header), header.size);
+    g_bytes_unref(bytes);
+    g_mapped_file_unref(mapped);
+
+    variant = g_variant_new_from_bytes(G_VARIANT_TYPE(FW_SNAPSHOT_VARIANT_TYPE),
+				       payload, FALSE);
+    g_variant_ref_sink(variant);
+    g_bytes_unref(payload);
+
+    if (header.byte_order == FW_SNAPSHOT_BYTE_ORDER_SWAPPED) {
+	/* foreign byte order, this needs a copy */
+	GVariant *swapped = g_variant_byteswap(variant);
+
+	g_variant_unref(variant);
+	variant = swapped;
+    }
+
+    obj = fw_snapshot_new();
+    priv = FW_SNAPSHOT_GET_PRIVATE(obj);
+    priv->variant = variant;
+    priv->mapped = TRUE;
+    priv->timestamp = header.timestamp;
+
+    return obj;
+}
+
+/**
+ * fw_snapshot_save:
+ * @obj: (type FWSnapshot*): a FWSnapshot instance
+ * @filename: (type gchar*): snapshot file
+ *
+ * Writes the snapshot atomically to filename.
+ *
+ * Returns: (type gboolean)
+ */
+gboolean
+fw_snapshot_save(FWSnapshot *obj,
+		 const gchar *filename)
+{
+    FWSnapshotPrivate *priv = FW_SNAPSHOT_GET_PRIVATE(obj);
+    FWSnapshotHeader header;
+    GVariant *variant;
+    GChecksum *checksum;
+    GError *error = NULL;
+    gsize digest_len = sizeof(header.checksum);
+    gchar *data;
+    gsize size;
+    gboolean ret;
+
+#ifdef FW_DEBUG
+    g_printerr("fw_snapshot_save(%s)\n", filename);
+#endif
+
+    variant = _fw_snapshot_seal(priv);
+    size = g_variant_get_size(variant);
+
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, FW_SNAPSHOT_MAGIC, sizeof(header.magic));
+    header.version = FW_SNAPSHOT_FORMAT_VERSION;
+    header.byte_order = FW_SNAPSHOT_BYTE_ORDER;
+    header.timestamp = priv->timestamp;
+    header.size = size;
+
+    data = g_malloc(sizeof(header) + size);
+    g_variant_store(variant, data + sizeof(header));
+
+    checksum = g_checksum_new(G_CHECKSUM_SHA256);
+    g_checksum_update(checksum, (const guchar *) data + sizeof(header), size);
+    g_checksum_get_digest(checksum, header.checksum, &digest_len);
+    g_checksum_free(checksum);
+
+    memcpy(data, &header, sizeof(header));
+
+    ret = g_file_set_contents(filename, data, sizeof(header) + size, &error);
+    if (!ret) {
+	g_print(_("ERROR: Saving snapshot '%s' failed: %s\n"), filename,
+		error->message);
+	g_error_free(error);
+    }
+
+    g_free(data);
+
+    return ret;
+}
+
+static void
+fw_snapshot_init(FWSnapshot *obj)
+{
+    FWSnapshotPrivate *priv = FW_SNAPSHOT_GET_PRIVATE(obj);
+    guint i;
+
+    /* init vars */
+    priv->timestamp = g_get_real_time();
+    for (i=FW_SNAPSHOT_ZONES; i<=FW_SNAPSHOT_HELPERS; i++)
+	priv->entries[i] = g_tree_new_full(_fw_snapshot_str_compare, NULL,
+					   g_free,
+					   (GDestroyNotify) g_variant_unref);
+    priv->direct_rules = NULL;
+    priv->passthroughs = NULL;
+    priv->variant = NULL;
+    priv->mapped = FALSE;
+    priv->checked = g_hash_table_new_full(g_str_hash, g_str_equal,
+					  g_free, NULL);
+    priv->check_item = FW_SNAPSHOT_ZONES;
+    priv->check_index = 0;
+    priv->stale = FALSE;
+}
+
+static void
+fw_snapshot_finalize(GObject *obj)
+{
+    FWSnapshotPrivate *priv = FW_SNAPSHOT_GET_PRIVATE(obj);
+    guint i;
+
+    for (i=FW_SNAPSHOT_ZONES; i<=FW_SNAPSHOT_HELPERS; i++)
+	if (priv->entries[i] != NULL)
+	    g_tree_destroy(priv->entries[i]);
+    if (priv->direct_rules != NULL)
+	g_list_free_full(priv->direct_rules, (GDestroyNotify) g_variant_unref);
+    if (priv->passthroughs != NULL)
+	g_list_free_full(priv->passthroughs, (GDestroyNotify) g_variant_unref);
+    if (priv->variant != NULL)
+	g_variant_unref(priv->variant);
+    if (priv->checked != NULL)
+	g_hash_table_destroy(priv->checked);
+
+    G_OBJECT_CLASS(fw_snapshot_parent_class)->finalize(obj);
+}
+
+static void
+fw_snapshot_class_init(FWSnapshotClass *fw_snapshot_class)
+{
+    GObjectClass *obj_class = G_OBJECT_CLASS(fw_snapshot_class);
+
+    obj_class->finalize = fw_snapshot_finalize;
+
+    g_type_class_add_private(obj_class, sizeof(FWSnapshotPrivate));
+    fw_accounting_register(obj_class, sizeof(FWSnapshotPrivate));
+}
+
+/* methods */
+
+/**
+ * fw_snapshot_to_variant:
+ * @obj: (type FWSnapshot*): a FWSnapshot instance
+ *
+ * Returns: (transfer full) (type GVariant*)
+ */
+GVariant *
+fw_snapshot_to_variant(FWSnapshot *obj)
+{
+    FWSnapshotPrivate *priv = FW_SNAPSHOT_GET_PRIVATE(obj);
+
+    return g_variant_ref(_fw_snapshot_seal(priv));
+}
+
+/**
+ * fw_snapshot_getTimestamp:
+ * @obj: (type FWSnapshot*): a FWSnapshot instance
+ *
+ * Returns: (type guint64): creation time in microseconds since the epoch
+ */
+guint64
+fw_snapshot_getTimestamp(FWSnapshot *obj)
+{
+    FWSnapshotPrivate *priv = FW_SNAPSHOT_GET_PRIVATE(obj);
+
+    return priv->timestamp;
+}
+
+gboolean
+fw_snapshot_isMapped(FWSnapshot *obj)
+{
+    FWSnapshotPrivate *priv = FW_SNAPSHOT_GET_PRIVATE(obj);
+
+    return priv->mapped;
+}
+
+/* writing */
+
+void
+fw_snapshot_addZone(FWSnapshot *obj,
+		    const gchar *name,
+		    FWZone *zone)
+{
+    FWSnapshotPrivate *priv = FW_SNAPSHOT_GET_PRIVATE(obj);
+
+    _fw_snapshot_add_entry(priv, FW_SNAPSHOT_ZONES, name,
+			   fw_zone_to_variant(zone));
+}
+
+void
+fw_snapshot_addService(FWSnapshot *obj,
+		       const gchar *name,
+		       FWService *service)
+{
+    FWSnapshotPrivate *priv = FW_SNAPSHOT_GET_PRIVATE(obj);
+
+    _fw_snapshot_add_entry(priv, FW_SNAPSHOT_SERVICES, name,
+			   fw_service_to_variant(service));
+}
+
+void
+fw_snapshot_addIPSet(FWSnapshot *obj,
+		     const gchar *name,
+		     FWIPSet *ipset)
+{
+    FWSnapshotPrivate *priv = FW_SNAPSHOT_GET_PRIVATE(obj);
+
+    _fw_snapshot_add_entry(priv, FW_SNAPSHOT_IPSETS, name,
+			   fw_ipset_to_variant(ipset));
+}
+
+void
+fw_snapshot_addIcmpType(FWSnapshot *obj,
+			const gchar *name,
+			FWIcmpType *icmptype)
+{
+    FWSnapshotPrivate *priv = FW_SNAPSHOT_GET_PRIVATE(obj);
+
+    _fw_snapshot_add_entry(priv, FW_SNAPSHOT_ICMPTYPES, name,
+			   fw_icmptype_to_variant(icmptype));
+}
+
+void
+fw_snapshot_addHelper(FWSnapshot *obj,
+		      const gchar *name,
+		      FWHelper *helper)
+{
+    FWSnapshotPrivate *priv = FW_SNAPSHOT_GET_PRIVATE(obj);
+
+    _fw_snapshot_add_entry(priv, FW_SNAPSHOT_HELPERS, name,
+			   fw_helper_to_variant(helper));
+}
+
+void
+fw_snapshot_addDirectRule(FWSnapshot *obj,
+			  FWDirectRule *rule)
+{
+    FWSnapshotPrivate *priv = FW_SNAPSHOT_GET_PRIVATE(obj);
+
+    if (!_fw_snapshot_writable(priv))
+	return;
+
+    priv->direct_rules = g_list_append(priv->direct_rules,
+	_fw_snapshot_entry_new(_fw_snapshot_direct_rule_to_variant(rule)));
+}
+
+void
+fw_snapshot_addPassthrough(FWSnapshot *obj,
+			   FWPassthrough *passthrough)
+{
+    FWSnapshotPrivate *priv = FW_SNAPSHOT_GET_PRIVATE(obj);
+
+    if (!_fw_snapshot_writable(priv))
+	return;
+
+    priv->passthroughs = g_list_append(priv->passthroughs,
+	_fw_snapshot_entry_new(_fw_snapshot_passthrough_to_variant(passthrough)));
+}
+
+/* reading */
+
+/**
+ * fw_snapshot_getZoneNames:
+ * @obj: (type FWSnapshot*): a FWSnapshot instance
+ *
+ * Returns: (transfer full) (allow-none) (type GList*) (element-type gchar*)
+ */
+GList *
+fw_snapshot_getZoneNames(FWSnapshot *obj)
+{
+    FWSnapshotPrivate *priv = FW_SNAPSHOT_GET_PRIVATE(obj);
+
+    return _fw_snapshot_get_names(priv, FW_SNAPSHOT_ZONES);
+}
+
+/**
+ * fw_snapshot_getZone:
+ * @obj: (type FWSnapshot*): a FWSnapshot instance
+ * @name: (type gchar*): zone name
+ *
+ * Returns: (transfer full) (allow-none) (type FWZone*)
+ */
+FWZone *
+fw_snapshot_getZone(FWSnapshot *obj,
+		    const gchar *name)
+{
+    FWSnapshotPrivate *priv = FW_SNAPSHOT_GET_PRIVATE(obj);
+    GVariant *entry, *variant;
+    FWZone *zone;
+
+    entry = _fw_snapshot_lookup(priv, FW_SNAPSHOT_ZONES, name);
+    if (entry == NULL)
+	return NULL;
+
+    variant = _fw_snapshot_entry_wrap(entry);
+    zone = fw_zone_new_from_variant(variant);
+    g_variant_unref(variant);
+    g_variant_unref(entry);
+
+    return zone;
+}
+
+/**
+ * fw_snapshot_getServiceNames:
+ * @obj: (type FWSnapshot*): a FWSnapshot instance
+ *
+ * Returns: (transfer full) (allow-none) (type GList*) (element-type gchar*)
+ */
+GList *
+fw_snapshot_getServiceNames(FWSnapshot *obj)
+{
+    FWSnapshotPrivate *priv = FW_SNAPSHOT_GET_PRIVATE(obj);
+
+    return _fw_snapshot_get_names(priv, FW_SNAPSHOT_SERVICES);
+}
+
+/**
+ * fw_snapshot_getService:
+ * @obj: (type FWSnapshot*): a FWSnapshot instance
+ * @name: (type gchar*): service name
+ *
+ * Returns: (transfer full) (allow-none) (type FWService*)
+ */
+FWService *
+fw_snapshot_getService(FWSnapshot *obj,
+		       const gchar *name)
+{
+    FWSnapshotPrivate *priv = FW_SNAPSHOT_GET_PRIVATE(obj);
+    GVariant *entry, *variant;
+    FWService *service;
+
+    entry = _fw_snapshot_lookup(priv, FW_SNAPSHOT_SERVICES, name);
+    if (entry == NULL)
+	return NULL;
+
+    variant = _fw_snapshot_entry_wrap(entry);
+    service = fw_service_new_from_variant(variant);
+    g_variant_unref(variant);
+    g_variant_unref(entry);
+
+    return service;
+}
+
+/**
+ * fw_snapshot_getIPSetNames:
+ * @obj: (type FWSnapshot*): a FWSnapshot instance
+ *
+ * Returns: (transfer full) (allow-none) (type GList*) (element-type gchar*)
+ */
+GList *
+fw_snapshot_getIPSetNames(FWSnapshot *obj)
+{
+    FWSnapshotPrivate *priv = FW_SNAPSHOT_GET_PRIVATE(obj);
+
+    return _fw_snapshot_get_names(priv, FW_SNAPSHOT_IPSETS);
+}
+
+/**
+ * fw_snapshot_getIPSet:
+ * @obj: (type FWSnapshot*): a FWSnapshot instance
+ * @name: (type gchar*): ipset name
+ *
+ * Returns: (transfer full) (allow-none) (type FWIPSet*)
+ */
+FWIPSet *
+fw_snapshot_getIPSet(FWSnapshot *obj,
+		     const gchar *name)
+{
+    FWSnapshotPrivate *priv = FW_SNAPSHOT_GET_PRIVATE(obj);
+    GVariant *entry, *variant;
+    FWIPSet *ipset;
+
+    entry = _fw_snapshot_lookup(priv, FW_SNAPSHOT_IPSETS, name);
+    if (entry == NULL)
+	return NULL;
+
+    variant = _fw_snapshot_entry_wrap(entry);
+    ipset = fw_ipset_new_from_variant(variant);
+    g_variant_unref(variant);
+    g_variant_unref(entry);
+
+    return ipset;
+}
+
+/**
+ * fw_snapshot_getIcmpTypeNames:
+ * @obj: (type FWSnapshot*): a FWSnapshot instance
+ *
+ * Returns: (transfer full) (allow-none) (type GList*) (element-type gchar*)
+ */
+GList *
+fw_snapshot_getIcmpTypeNames(FWSnapshot *obj)
+{
+    FWSnapshotPrivate *priv = FW_SNAPSHOT_GET_PRIVATE(obj);
+
+    return _fw_snapshot_get_names(priv, FW_SNAPSHOT_ICMPTYPES);
+}
+
+/**
+ * fw_snapshot_getIcmpType:
+ * @obj: (type FWSnapshot*): a FWSnapshot instance
+ * @name: (type gchar*): icmptype name
+ *
+ * Returns: (transfer full) (allow-none) (type FWIcmpType*)
+ */
+FWIcmpType *
+fw_snapshot_getIcmpType(FWSnapshot *obj,
+			const gchar *name)
+{
+    FWSnapshotPrivate *priv = FW_SNAPSHOT_GET_PRIVATE(obj);
+    GVariant *entry;
+    FWIcmpType *icmptype;
+
+    entry = _fw_snapshot_lookup(priv, FW_SNAPSHOT_ICMPTYPES, name);
+    if (entry == NULL)
+	return NULL;
+
+    icmptype = fw_icmptype_new_from_variant(entry);
+    g_variant_unref(entry);
+
+    return icmptype;
+}
+
+/**
+ * fw_snapshot_getHelperNames:
+ * @obj: (type FWSnapshot*): a FWSnapshot instance
+ *
+ * Returns: (transfer full) (allow-none) (type GList*) (element-type gchar*)
+ */
+GList *
+fw_snapshot_getHelperNames(FWSnapshot *obj)
+{
+    FWSnapshotPrivate *priv = FW_SNAPSHOT_GET_PRIVATE(obj);
+
+    return _fw_snapshot_get_names(priv, FW_SNAPSHOT_HELPERS);
+}
+
+/**
+ * fw_snapshot_getHelper:
+ * @obj: (type FWSnapshot*): a FWSnapshot instance
+ * @name: (type gchar*): helper name
+ *
+ * Returns: (transfer full) (allow-none) (type FWHelper*)
+ */
+FWHelper *
+fw_snapshot_getHelper(FWSnapshot *obj,
+		      const gchar *name)
+{
+    FWSnapshotPrivate *priv = FW_SNAPSHOT_GET_PRIVATE(obj);
+    GVariant *entry, *variant;
+    FWHelper *helper;
+
+    entry = _fw_snapshot_lookup(priv, FW_SNAPSHOT_HELPERS, name);
+    if (entry == NULL)
+	return NULL;
+
+    variant = _fw_snapshot_entry_wrap(entry);
+    helper = fw_helper_new_from_variant(variant);
+    g_variant_unref(variant);
+    g_variant_unref(entry);
+
+    return helper;
+}
+
+/**
+ * fw_snapshot_getDirectRules:
+ * @obj: (type FWSnapshot*): a FWSnapshot instance
+ *
+ * Returns: (transfer full) (type GList*) (element-type FWDirectRule*)
+ */
+GList *
+fw_snapshot_getDirectRules(FWSnapshot *obj)
+{
+    FWSnapshotPrivate *priv = FW_SNAPSHOT_GET_PRIVATE(obj);
+    GVariant *array, *element;
+    GVariantIter iter;
+    GList *list = NULL;
+
+    array = g_variant_get_child_value(_fw_snapshot_seal(priv),
+				      FW_SNAPSHOT_DIRECT_RULES);
+
+    g_variant_iter_init(&iter, array);
+    while ((element = g_variant_iter_next_value(&iter)) != NULL) {
+	FWDirectRule *rule = fw_direct_rule_new();
+	const gchar *ipv, *table, *chain;
+	gint32 priority;
+	GVariant *args;
+	GList *args_list;
+
+	g_variant_get(element, "(&s&s&si@as)", &ipv, &table, &chain,
+		      &priority, &args);
+	args_list = fw_str_list_new_from_variant(args);
+
+	fw_direct_rule_setIpv(rule, (gchar *) ipv);
+	fw_direct_rule_setTable(rule, (gchar *) table);
+	fw_direct_rule_setChain(rule, (gchar *) chain);
+	fw_direct_rule_setPriority(rule, priority);
+	fw_direct_rule_setArgs(rule, args_list);
+
+	fw_str_list_free(args_list);
+	g_variant_unref(args);
+	g_variant_unref(element);
+
+	list = g_list_prepend(list, rule);
+    }
+
+    g_variant_unref(array);
+
+    return g_list_reverse(list);
+}
+
+/**
+ * fw_snapshot_getPassthroughs:
+ * @obj: (type FWSnapshot*): a FWSnapshot instance
+ *
+ * Returns: (transfer full) (type GList*) (element-type FWPassthrough*)
+ */
+GList *
+fw_snapshot_getPassthroughs(FWSnapshot *obj)
+{
+    FWSnapshotPrivate *priv = FW_SNAPSHOT_GET_PRIVATE(obj);
+    GVariant *array, *element;
+    GVariantIter iter;
+    GList *list = NULL;
+
+    array = g_variant_get_child_value(_fw_snapshot_seal(priv),
+				      FW_SNAPSHOT_PASSTHROUGHS);
+
+    g_variant_iter_init(&iter, array);
+    while ((element = g_variant_iter_next_value(&iter)) != NULL) {
+	FWPassthrough *passthrough = fw_passthrough_new();
+	const gchar *ipv;
+	GVariant *args;
+	GList *args_list;
+
+	g_variant_get(element, "(&s@as)", &ipv, &args);
+	args_list = fw_str_list_new_from_variant(args);
+
+	fw_passthrough_setIpv(passthrough, (gchar *) ipv);
+	fw_passthrough_setArgs(passthrough, args_list);
+
+	fw_str_list_free(args_list);
+	g_variant_unref(args);
+	g_variant_unref(element);
+
+	list = g_list_prepend(list, passthrough);
+    }
+
+    g_variant_unref(array);
+
+    return g_list_reverse(list);
+}
+
+/* lazy consistency check against firewalld */
+
+/* Returns: live settings of the named entry as snapshot entry or NULL */
+static GVariant *
+_fw_snapshot_get_live(FWClient *client,
+		      guint item,
+		      const gchar *name)
+{
+    GVariant *variant = NULL;
+
+    switch (item) {
+    case FW_SNAPSHOT_ZONES: {
+	FWZone *zone = fw_client_getZoneSettings(client, name);
+
+	if (zone != NULL) {
+	    variant = fw_zone_to_variant(zone);
+	    g_object_unref(zone);
+	}
+	break;
+    }
+    case FW_SNAPSHOT_SERVICES: {
+	FWService *service = fw_client_getServiceSettings(client, name);
+
+	if (service != NULL) {
+	    variant = fw_service_to_variant(service);
+	    g_object_unref(service);
+	}
+	break;
+    }
+    case FW_SNAPSHOT_IPSETS: {
+	FWIPSet *ipset = fw_client_getIPSetSettings(client, name);
+
+	if (ipset != NULL) {
+	    variant = fw_ipset_to_variant(ipset);
+	    g_object_unref(ipset);
+	}
+	break;
+    }
+    case FW_SNAPSHOT_ICMPTYPES: {
+	FWIcmpType *icmptype = fw_client_getIcmpTypeSettings(client, name);
+
+	if (icmptype != NULL) {
+	    variant = fw_icmptype_to_variant(icmptype);
+	    g_object_unref(icmptype);
+	}
+	break;
+    }
+    case FW_SNAPSHOT_HELPERS: {
+	FWHelper *helper = fw_client_getHelperSettings(client, name);
+
+	if (helper != NULL) {
+	    variant = fw_helper_to_variant(helper);
+	    g_object_unref(helper);
+	}
+	break;
+    }
+    default:
+	break;
+    }
+
+    return _fw_snapshot_entry_new(variant);
+}
+
+static gboolean
+_fw_snapshot_set_checked(FWSnapshotPrivate *priv,
+			 gchar *key,
+			 gboolean consistent)
+{
+    g_hash_table_replace(priv->checked, key,
+			 GINT_TO_POINTER(consistent ?
+					 FW_SNAPSHOT_CHECK_CONSISTENT :
+					 FW_SNAPSHOT_CHECK_STALE));
+    if (!consistent)
+	priv->stale = TRUE;
+
+    return consistent;
+}
+
+static gboolean
+_fw_snapshot_check_entry(FWSnapshotPrivate *priv,
+			 FWClient *client,
+			 guint item,
+			 const gchar *name)
+{
+    GVariant *entry, *live;
+    gchar *key;
+    gpointer state;
+    gboolean consistent;
+
+    key = g_strdup_printf("%s/%s", _fw_snapshot_item_names[item], name);
+    state = g_hash_table_lookup(priv->checked, key);
+    if (state != NULL) {
+	g_free(key);
+	return GPOINTER_TO_INT(state) == FW_SNAPSHOT_CHECK_CONSISTENT;
+    }
+
+#ifdef FW_DEBUG
+    g_printerr("fw_snapshot_check(%s)\n", key);
+#endif
+
+    entry = _fw_snapshot_lookup(priv, item, name);
+    live = _fw_snapshot_get_live(client, item, name);
+
+    if (entry == NULL || live == NULL)
+	consistent = (entry == live);
+    else
+	consistent = g_variant_equal(entry, live);
+
+    if (entry != NULL)
+	g_variant_unref(entry);
+    if (live != NULL)
+	g_variant_unref(live);
+
+    return _fw_snapshot_set_checked(priv, key, consistent);
+}
+
+/*
+ * Compares the snapshot entries of item with the live entries. The order of
+ * the entries is not relevant, the serialized data of the normalized entries
+ * is used as key.
+ */
+static gboolean
+_fw_snapshot_compare_list(FWSnapshotPrivate *priv,
+			  guint item,
+			  GList *live)
+{
+    GHashTable *counts;
+    GVariant *array, *element;
+    GVariantIter iter;
+    GList *l;
+    gboolean consistent = TRUE;
+
+    counts = g_hash_table_new_full(g_bytes_hash, g_bytes_equal,
+				   (GDestroyNotify) g_bytes_unref, NULL);
+
+    array = g_variant_get_child_value(_fw_snapshot_seal(priv), item);
+    g_variant_iter_init(&iter, array);
+    while ((element = g_variant_iter_next_value(&iter)) != NULL) {
+	GBytes *bytes = g_variant_get_data_as_bytes(element);
+	gint count = GPOINTER_TO_INT(g_hash_table_lookup(counts, bytes));
+
+	g_hash_table_replace(counts, bytes, GINT_TO_POINTER(count + 1));
+	g_variant_unref(element);
+    }
+    g_variant_unref(array);
+
+    for (l = live; l != NULL && consistent; l = l->next) {
+	GBytes *bytes = g_variant_get_data_as_bytes(l->data);
+	gint count = GPOINTER_TO_INT(g_hash_table_lookup(counts, bytes));
+
+	if (count == 0)
+	    consistent = FALSE;
+	else if (count == 1)
+	    g_hash_table_remove(counts, bytes);
+	else
+	    g_hash_table_replace(counts, g_bytes_ref(bytes),
+				 GINT_TO_POINTER(count - 1));
+	g_bytes_unref(bytes);
+    }
+
+    if (g_hash_table_size(counts) > 0)
+	consistent = FALSE;
+
+    g_hash_table_destroy(counts);
+
+    return consistent;
+}
+
+/**
+ * fw_snapshot_checkZone:
+ * @obj: (type FWSnapshot*): a FWSnapshot instance
+ * @client: (type FWClient*): a FWClient instance
+ * @name: (type gchar*): zone name
+ *
+ * Compares the zone in the snapshot with the runtime settings in firewalld.
+ * The result is remembered, firewalld is only asked once per zone.
+ *
+ * Returns: (type gboolean): TRUE if the snapshot entry is up to date
+ */
+gboolean
+fw_snapshot_checkZone(FWSnapshot *obj,
+		      FWClient *client,
+		      const gchar *name)
+{
+    FWSnapshotPrivate *priv = FW_SNAPSHOT_GET_PRIVATE(obj);
+
+    return _fw_snapshot_check_entry(priv, client, FW_SNAPSHOT_ZONES, name);
+}
+
+gboolean
+fw_snapshot_checkService(FWSnapshot *obj,
+			 FWClient *client,
+			 const gchar *name)
+{
+    FWSnapshotPrivate *priv = FW_SNAPSHOT_GET_PRIVATE(obj);
+
+    return _fw_snapshot_check_entry(priv, client, FW_SNAPSHOT_SERVICES, name);
+}
+
+gboolean
+fw_snapshot_checkIPSet(FWSnapshot *obj,
+		       FWClient *client,
+		       const gchar *name)
+{
+    FWSnapshotPrivate *priv = FW_SNAPSHOT_GET_PRIVATE(obj);
+
+    return _fw_snapshot_check_entry(priv, client, FW_SNAPSHOT_IPSETS, name);
+}
+
+gboolean
+fw_snapshot_checkIcmpType(FWSnapshot *obj,
+			  FWClient *client,
+			  const gchar *name)
+{
+    FWSnapshotPrivate *priv = FW_SNAPSHOT_GET_PRIVATE(obj);
+
+    return _fw_snapshot_check_entry(priv, client, FW_SNAPSHOT_ICMPTYPES, name);
+}
+
+gboolean
+fw_snapshot_checkHelper(FWSnapshot *obj,
+			FWClient *client,
+			const gchar *name)
+{
+    FWSnapshotPrivate *priv = FW_SNAPSHOT_GET_PRIVATE(obj);
+
+    return _fw_snapshot_check_entry(priv, client, FW_SNAPSHOT_HELPERS, name);
+}
+
+/**
+ * fw_snapshot_checkDirect:
+ * @obj: (type FWSnapshot*): a FWSnapshot instance
+ * @client: (type FWClient*): a FWClient instance
+ *
+ * Compares the direct rules and passthroughs in the snapshot with firewalld.
+ *
+ * Returns: (type gboolean): TRUE if the snapshot entries are up to date
+ */
+gboolean
+fw_snapshot_checkDirect(FWSnapshot *obj,
+			FWClient *client)
+{
+    FWSnapshotPrivate *priv = FW_SNAPSHOT_GET_PRIVATE(obj);
+    GList *list, *live, *l;
+    gpointer state;
+    gboolean consistent;
+
+    state = g_hash_table_lookup(priv->checked, "direct");
+    if (state != NULL)
+	return GPOINTER_TO_INT(state) == FW_SNAPSHOT_CHECK_CONSISTENT;
+
+    live = NULL;
+    list = fw_client_getAllRules(client);
+    for (l = list; l != NULL; l = l->next)
+	live = g_list_prepend(live, _fw_snapshot_entry_new(
+	    _fw_snapshot_direct_rule_to_variant(l->data)));
+    g_list_free_full(list, g_object_unref);
+
+    consistent = _fw_snapshot_compare_list(priv, FW_SNAPSHOT_DIRECT_RULES,
+					   live);
+    g_list_free_full(live, (GDestroyNotify) g_variant_unref);
+
+    if (consistent) {
+	live = NULL;
+	list = fw_client_getAllPassthroughs(client);
+	for (l = list; l != NULL; l = l->next)
+	    live = g_list_prepend(live, _fw_snapshot_entry_new(
+		_fw_snapshot_passthrough_to_variant(l->data)));
+	g_list_free_full(list, g_object_unref);
+
+	consistent = _fw_snapshot_compare_list(priv, FW_SNAPSHOT_PASSTHROUGHS,
+					       live);
+	g_list_free_full(live, (GDestroyNotify) g_variant_unref);
+    }
+
+    return _fw_snapshot_set_checked(priv, g_strdup("direct"), consistent);
+}
+
+/**
+ * fw_snapshot_checkNext:
+ * @obj: (type FWSnapshot*): a FWSnapshot instance
+ * @client: (type FWClient*): a FWClient instance
+ *
+ * Checks the next entry of the snapshot that has not been checked yet. This
+ * is meant to be called from an idle handler after a warm start, so that the
+ * snapshot is verified in the background while it is already in use.
+ *
+ * Returns: (type gboolean): FALSE if all entries have been checked
+ */
+gboolean
+fw_snapshot_checkNext(FWSnapshot *obj,
+		      FWClient *client)
+{
+    FWSnapshotPrivate *priv = FW_SNAPSHOT_GET_PRIVATE(obj);
+
+    while (priv->check_item <= FW_SNAPSHOT_HELPERS) {
+	GVariant *dict, *entry, *key;
+	gsize n;
+
+	dict = g_variant_get_child_value(_fw_snapshot_seal(priv),
+					 priv->check_item);
+	n = g_variant_n_children(dict);
+
+	if (priv->check_index >= n) {
+	    g_variant_unref(dict);
+	    priv->check_item++;
+	    priv->check_index = 0;
+	    continue;
+	}
+
+	entry = g_variant_get_child_value(dict, priv->check_index++);
+	key = g_variant_get_child_value(entry, 0);
+
+	_fw_snapshot_check_entry(priv, client, priv->check_item,
+				 g_variant_get_string(key, NULL));
+
+	g_variant_unref(key);
+	g_variant_unref(entry);
+	g_variant_unref(dict);
+
+	return TRUE;
+    }
+
+    if (priv->check_item == FW_SNAPSHOT_DIRECT_RULES) {
+	fw_snapshot_checkDirect(obj, client);
+	priv->check_item = FW_SNAPSHOT_N_ITEMS;
+    }
+
+    return FALSE;
+}
+
+/**
+ * fw_snapshot_isStale:
+ * @obj: (type FWSnapshot*): a FWSnapshot instance
+ *
+ * Returns: (type gboolean): TRUE if a check found a difference to firewalld
+ */
+gboolean
+fw_snapshot_isStale(FWSnapshot *obj)
+{
+    FWSnapshotPrivate *priv = FW_SNAPSHOT_GET_PRIVATE(obj);
+
+    return priv->stale;
+}
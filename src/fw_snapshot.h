@@ -0,0 +1,110 @@
+/*
+ * Copyright (C) 2017 Red Hat, Inc.
+ *
+ * Authors:
+ * Thomas Woerner <twoerner@redhat.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __FW_SNAPSHOT_H__
+#define __FW_SNAPSHOT_H__
+
+#include <glib.h>
+#include <glib-object.h>
+#include "firewall.h"
+#include "fw_client.h"
+#include "fw_zone.h"
+#include "fw_service.h"
+#include "fw_ipset.h"
+#include "fw_icmptype.h"
+#include "fw_helper.h"
+#include "fw_direct_rule.h"
+#include "fw_passthrough.h"
+
+#define FW_SNAPSHOT_TYPE            (fw_snapshot_get_type())
+#define FW_SNAPSHOT(obj)            (G_TYPE_CHECK_INSTANCE_CAST((obj), FW_SNAPSHOT_TYPE, FWSnapshot))
+#define FW_SNAPSHOT_CLASS(klass)    (G_TYPE_CHECK_CLASS_CAST((klass), FW_SNAPSHOT_TYPE, FWSnapshotClass))
+#define FW_IS_SNAPSHOT(klass)       (G_TYPE_CHECK_INSTANCE_CLASS((klass), FW_SNAPSHOT_TYPE, FWSnapshotClass))
+#define FW_SNAPSHOT_GET_CLASS(obj)  (G_TYPE_INSTANCE_GET_CLASS((obj), FW_SNAPSHOT_TYPE, FWSnapshotClass))
+
+#define FW_SNAPSHOT_MAGIC           "FWSNAP\r\n"
+#define FW_SNAPSHOT_FORMAT_VERSION  1
+
+/* zones, services, ipsets, icmptypes, helpers, direct rules, passthroughs */
+#define FW_SNAPSHOT_VARIANT_TYPE \
+    "(ta{s(sssbsasa(ss)asba(ssss)asasasasa(ss)b)}" \
+    "a{s(sssa(ss)asa{ss}asa(ss))}" \
+    "a{s(ssssa{ss}as)}" \
+    "a{s(sssas)}" \
+    "a{s(sssssa(ss))}" \
+    "a(sssias)" \
+    "a(sas))"
+
+typedef struct {
+    GObject parent;
+} FWSnapshot;
+
+typedef struct {
+    GObjectClass parent;
+} FWSnapshotClass;
+
+GType fw_snapshot_get_type(void);
+FWSnapshot *fw_snapshot_new(void);
+FWSnapshot *fw_snapshot_new_from_client(FWClient *client);
+FWSnapshot *fw_snapshot_new_from_variant(GVariant *variant);
+FWSnapshot *fw_snapshot_load(const gchar *filename);
+gboolean fw_snapshot_save(FWSnapshot *obj, const gchar *filename);
+
+GVariant *fw_snapshot_to_variant(FWSnapshot *obj);
+guint64 fw_snapshot_getTimestamp(FWSnapshot *obj);
+gboolean fw_snapshot_isMapped(FWSnapshot *obj);
+
+/* writing */
+
+void fw_snapshot_addZone(FWSnapshot *obj, const gchar *name, FWZone *zone);
+void fw_snapshot_addService(FWSnapshot *obj, const gchar *name, FWService *service);
+void fw_snapshot_addIPSet(FWSnapshot *obj, const gchar *name, FWIPSet *ipset);
+void fw_snapshot_addIcmpType(FWSnapshot *obj, const gchar *name, FWIcmpType *icmptype);
+void fw_snapshot_addHelper(FWSnapshot *obj, const gchar *name, FWHelper *helper);
+void fw_snapshot_addDirectRule(FWSnapshot *obj, FWDirectRule *rule);
+void fw_snapshot_addPassthrough(FWSnapshot *obj, FWPassthrough *passthrough);
+
+/* reading */
+
+GList *fw_snapshot_getZoneNames(FWSnapshot *obj);
+FWZone *fw_snapshot_getZone(FWSnapshot *obj, const gchar *name);
+GList *fw_snapshot_getServiceNames(FWSnapshot *obj);
+FWService *fw_snapshot_getService(FWSnapshot *obj, const gchar *name);
+GList *fw_snapshot_getIPSetNames(FWSnapshot *obj);
+FWIPSet *fw_snapshot_getIPSet(FWSnapshot *obj, const gchar *name);
+GList *fw_snapshot_getIcmpTypeNames(FWSnapshot *obj);
+FWIcmpType *fw_snapshot_getIcmpType(FWSnapshot *obj, const gchar *name);
+GList *fw_snapshot_getHelperNames(FWSnapshot *obj);
+FWHelper *fw_snapshot_getHelper(FWSnapshot *obj, const gchar *name);
+GList *fw_snapshot_getDirectRules(FWSnapshot *obj);
+GList *fw_snapshot_getPassthroughs(FWSnapshot *obj);
+
+/* lazy consistency check against firewalld */
+
+gboolean fw_snapshot_checkZone(FWSnapshot *obj, FWClient *client, const gchar *name);
+gboolean fw_snapshot_checkService(FWSnapshot *obj, FWClient *client, const gchar *name);
+gboolean fw_snapshot_checkIPSet(FWSnapshot *obj, FWClient *client, const gchar *name);
+gboolean fw_snapshot_checkIcmpType(FWSnapshot *obj, FWClient *client, const gchar *name);
+gboolean fw_snapshot_checkHelper(FWSnapshot *obj, FWClient *client, const gchar *name);
+gboolean fw_snapshot_checkDirect(FWSnapshot *obj, FWClient *client);
+gboolean fw_snapshot_checkNext(FWSnapshot *obj, FWClient *client);
+gboolean fw_snapshot_isStale(FWSnapshot *obj);
+
+#endif /* __FW_SNAPSHOT_H__ */
@@ -0,0 +1,1067 @@
+/*
+ * Copyright (C) 2017 Red Hat, Inc.
+ *
+ * Authors:
+ * Thomas Woerner <twoerner@redhat.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * History of snapshots: a ring buffer of records, each either a base with
+ * the full snapshot or a delta with the changed fields of the entries since
+ * the previous record. A base is written every base_interval records, the
+ * oldest record in the ring is always a base. Looking up a point in time is
+ * a binary search on the record timestamps and a replay of at most
+ * base_interval deltas.
+ *
+ * History file layout, append-only:
+ *
+ *   FWSnapshotHistoryFileHeader (16 bytes)
+ *   records: FWSnapshotHistoryRecordHeader (32 bytes)
+ *            payload: serialized GVariant, padded to 8 bytes
+ *
+ * Base payloads are of type FW_SNAPSHOT_VARIANT_TYPE, delta payloads of
+ * type FW_SNAPSHOT_HISTORY_DELTA_TYPE.
+ */
+
+#include "fw_snapshot_history.h"
+#include "fw_trace.h"
+#include "fw_accounting.h"
+#include "fw_fingerprint.h"
+#include <stdio.h>
+#include <string.h>
+
+G_DEFINE_TYPE(FWSnapshotHistory, fw_snapshot_history, G_TYPE_OBJECT);
+
+#define FW_SNAPSHOT_HISTORY_GET_PRIVATE(o) (G_TYPE_INSTANCE_GET_PRIVATE((o), FW_SNAPSHOT_HISTORY_TYPE, FWSnapshotHistoryPrivate))
+
+#define FW_SNAPSHOT_HISTORY_BYTE_ORDER  0x01020304
+
+#define FW_SNAPSHOT_HISTORY_PAD(size)   (((size) + 7) & ~((guint64) 7))
+
+/* children of FW_SNAPSHOT_VARIANT_TYPE */
+enum {
+    FW_SNAPSHOT_HISTORY_TIMESTAMP = 0,
+    FW_SNAPSHOT_HISTORY_ZONES,
+    FW_SNAPSHOT_HISTORY_SERVICES,
+    FW_SNAPSHOT_HISTORY_IPSETS,
+    FW_SNAPSHOT_HISTORY_ICMPTYPES,
+    FW_SNAPSHOT_HISTORY_HELPERS,
+    FW_SNAPSHOT_HISTORY_DIRECT_RULES,
+    FW_SNAPSHOT_HISTORY_PASSTHROUGHS,
+    FW_SNAPSHOT_HISTORY_N_ITEMS
+};
+
+/* direct rules and passthroughs are stored as one entry with this name */
+#define FW_SNAPSHOT_HISTORY_LIST_NAME  ""
+
+enum {
+    FW_SNAPSHOT_HISTORY_RECORD_BASE = 1,
+    FW_SNAPSHOT_HISTORY_RECORD_DELTA
+};
+
+typedef struct {
+    gchar magic[8];         /* FW_SNAPSHOT_HISTORY_MAGIC */
+    guint32 version;        /* FW_SNAPSHOT_HISTORY_FORMAT_VERSION */
+    guint32 byte_order;     /* FW_SNAPSHOT_HISTORY_BYTE_ORDER of the writer */
+} FWSnapshotHistoryFileHeader;
+
+typedef struct {
+    guint32 kind;           /* FW_SNAPSHOT_HISTORY_RECORD_* */
+    guint32 reserved;
+    guint64 timestamp;      /* real time in microseconds */
+    guint64 size;           /* size of the payload without padding */
+    guint64 checksum;       /* first 8 bytes of the sha256 of the payload */
+} FWSnapshotHistoryRecordHeader;
+
+G_STATIC_ASSERT(sizeof(FWSnapshotHistoryFileHeader) == 16);
+G_STATIC_ASSERT(sizeof(FWSnapshotHistoryRecordHeader) == 32);
+
+typedef struct {
+    guint64 timestamp;
+    guint64 sequence;
+    guint64 base_sequence;  /* sequence of the base the delta applies to */
+    gboolean base;
+    GVariant *variant;
+} FWSnapshotHistoryRecord;
+
+/* item: hash table name: GVariant */
+typedef struct {
+    GHashTable *items[FW_SNAPSHOT_HISTORY_N_ITEMS];
+} FWSnapshotHistoryState;
+
+typedef struct {
+    FWSnapshotHistoryRecord *records;   /* ring buffer */
+    guint capacity;
+    guint base_interval;
+    guint head;
+    guint length;
+    guint64 sequence;                   /* sequence of the next record */
+    guint since_base;                   /* deltas since the last base */
+    gsize size;                         /* payload sizes of the records */
+    FWSnapshotHistoryState *state;      /* state of the newest record */
+    GHashTable *fingerprints[FW_SNAPSHOT_HISTORY_N_ITEMS]; /* of state */
+    gchar *filename;
+    FILE *file;
+} FWSnapshotHistoryPrivate;
+
+/* state */
+
+static FWSnapshotHistoryState *
+_fw_snapshot_history_state_new(void)
+{
+    FWSnapshotHistoryState *state = g_new0(FWSnapshotHistoryState, 1);
+    guint i;
+
+    for (i=FW_SNAPSHOT_HISTORY_ZONES; i<FW_SNAPSHOT_HISTORY_N_ITEMS; i++)
+	state->items[i] = g_hash_table_new_full(
+	    g_str_hash, g_str_equal, g_free, (GDestroyNotify) g_variant_unref);
+
+    return state;
+}
+
+static void
+_fw_snapshot_history_state_free(FWSnapshotHistoryState *state)
+{
+    guint i;
+
+    if (state == NULL)
+	return;
+
+    for (i=FW_SNAPSHOT_HISTORY_ZONES; i<FW_SNAPSHOT_HISTORY_N_ITEMS; i++)
+	g_hash_table_destroy(state->items[i]);
+    g_free(state);
+}
+
+static FWSnapshotHistoryState *
+_fw_snapshot_history_state_new_from_variant(GVariant *variant)
+{
+    FWSnapshotHistoryState *state = _fw_snapshot_history_state_new();
+    guint i;
+    gsize j, n;
+
+    FW_TRACE_DECODE_START(variant);
+
+    for (i=FW_SNAPSHOT_HISTORY_ZONES; i<=FW_SNAPSHOT_HISTORY_HELPERS; i++) {
+	GVariant *dict = g_variant_get_child_value(variant, i);
+
+	n = g_variant_n_children(dict);
+	for (j=0; j<n; j++) {
+	    GVariant *entry = g_variant_get_child_value(dict, j);
+	    GVariant *key = g_variant_get_child_value(entry, 0);
+
+	    g_hash_table_replace(state->items[i],
+				 g_strdup(g_variant_get_string(key, NULL)),
+				 g_variant_get_child_value(entry, 1));
+
+	    g_variant_unref(key);
+	    g_variant_unref(entry);
+	}
+	g_variant_unref(dict);
+    }
+
+    for (i=FW_SNAPSHOT_HISTORY_DIRECT_RULES; i<FW_SNAPSHOT_HISTORY_N_ITEMS; i++)
+	g_hash_table_replace(state->items[i],
+			     g_strdup(FW_SNAPSHOT_HISTORY_LIST_NAME),
+			     g_variant_get_child_value(variant, i));
+
+    FW_TRACE_DECODE_DONE();
+    return state;
+}
+
+static gint
+_fw_snapshot_history_str_compare(gconstpointer a,
+				 gconstpointer b)
+{
+    return strcmp(*(const gchar **) a, *(const gchar **) b);
+}
+
+/* Returns: floating snapshot variant with dictionaries sorted by name */
+static GVariant *
+_fw_snapshot_history_state_to_variant(FWSnapshotHistoryState *state,
+				      guint64 timestamp)
+{
+    const GVariantType *type = G_VARIANT_TYPE(FW_SNAPSHOT_VARIANT_TYPE);
+    const GVariantType *child_type;
+    GVariantBuilder builder;
+    guint i;
+
+    g_variant_builder_init(&builder, type);
+    g_variant_builder_add(&builder, "t", timestamp);
+
+    child_type = g_variant_type_next(g_variant_type_first(type));
+    for (i=FW_SNAPSHOT_HISTORY_ZONES; i<FW_SNAPSHOT_HISTORY_N_ITEMS; i++) {
+	if (i >= FW_SNAPSHOT_HISTORY_DIRECT_RULES) {
+	    GVariant *array = g_hash_table_lookup(
+		state->items[i], FW_SNAPSHOT_HISTORY_LIST_NAME);
+
+	    if (array != NULL)
+		g_variant_builder_add_value(&builder, array);
+	    else
+		g_variant_builder_add_value(&builder, g_variant_new_array(
+		    g_variant_type_element(child_type), NULL, 0));
+	} else {
+	    GPtrArray *names = g_ptr_array_new();
+	    GHashTableIter iter;
+	    gpointer key;
+	    guint j;
+
+	    g_hash_table_iter_init(&iter, state->items[i]);
+	    while (g_hash_table_iter_next(&iter, &key, NULL))
+		g_ptr_array_add(names, key);
+	    g_ptr_array_sort(names, _fw_snapshot_history_str_compare);
+
+	    g_variant_builder_open(&builder, child_type);
+	    for (j=0; j<names->len; j++)
+		g_variant_builder_add_value(&builder, g_variant_new_dict_entry(
+		    g_variant_new_string(g_ptr_array_index(names, j)),
+		    g_hash_table_lookup(state->items[i],
+					g_ptr_array_index(names, j))));
+	    g_variant_builder_close(&builder);
+
+	    g_ptr_array_free(names, TRUE);
+	}
+	child_type = g_variant_type_next(child_type);
+    }
+
+    return g_variant_builder_end(&builder);
+}
+
+/* Returns: (type gboolean): FALSE for a corrupt delta */
+static gboolean
+_fw_snapshot_history_state_apply(FWSnapshotHistoryState *state,
+				 GVariant *delta)
+{
+    gboolean ret = TRUE;
+    gsize i, n;
+
+    n = g_variant_n_children(delta);
+    for (i=0; i<n; i++) {
+	GVariant *value, *old, **children;
+	const gchar *name;
+	guchar item;
+	gint32 field;
+	gsize j, n_children;
+
+	g_variant_get_child(delta, i, "(y&siv)", &item, &name, &field, &value);
+
+	if (item < FW_SNAPSHOT_HISTORY_ZONES ||
+	    item >= FW_SNAPSHOT_HISTORY_N_ITEMS) {
+	    g_variant_unref(value);
+	    ret = FALSE;
+	    continue;
+	}
+
+	if (field == FW_SNAPSHOT_HISTORY_FIELD_REMOVED) {
+	    g_hash_table_remove(state->items[item], name);
+	    g_variant_unref(value);
+	    continue;
+	}
+
+	if (field == FW_SNAPSHOT_HISTORY_FIELD_ENTRY) {
+	    g_hash_table_replace(state->items[item], g_strdup(name), value);
+	    continue;
+	}
+
+	old = g_hash_table_lookup(state->items[item], name);
+	if (field < 0 || old == NULL || !g_variant_is_container(old) ||
+	    (gsize) field >= g_variant_n_children(old))
+	{
+	    g_variant_unref(value);
+	    ret = FALSE;
+	    continue;
+	}
+
+	/* replace the field in the settings tuple */
+	n_children = g_variant_n_children(old);
+	children = g_new(GVariant *, n_children);
+	for (j=0; j<n_children; j++)
+	    children[j] = (j == (gsize) field) ? value :
+		g_variant_get_child_value(old, j);
+
+	g_hash_table_replace(state->items[item], g_strdup(name),
+			     g_variant_ref_sink(
+				 g_variant_new_tuple(children, n_children)));
+
+	for (j=0; j<n_children; j++)
+	    g_variant_unref(children[j]);
+	g_free(children);
+    }
+
+    return ret;
+}
+
+/* records */
+
+static FWSnapshotHistoryRecord *
+_fw_snapshot_history_record(FWSnapshotHistoryPrivate *priv,
+			    guint index)
+{
+    return &priv->records[(priv->head + index) % priv->capacity];
+}
+
+/* Returns: state at the record index (transfer full) or NULL if corrupt */
+static FWSnapshotHistoryState *
+_fw_snapshot_history_replay(FWSnapshotHistoryPrivate *priv,
+			    guint index)
+{
+    FWSnapshotHistoryRecord *record = _fw_snapshot_history_record(priv, index);
+    guint64 oldest = _fw_snapshot_history_record(priv, 0)->sequence;
+    FWSnapshotHistoryState *state;
+    guint i, base;
+
+    /* the base of the oldest deltas has been rebased to the oldest record */
+    base = (record->base_sequence > oldest) ?
+	(guint) (record->base_sequence - oldest) : 0;
+
+    state = _fw_snapshot_history_state_new_from_variant(
+	_fw_snapshot_history_record(priv, base)->variant);
+
+    for (i=base+1; i<=index; i++) {
+	if (!_fw_snapshot_history_state_apply(
+		state, _fw_snapshot_history_record(priv, i)->variant))
+	{
+	    g_print(_("ERROR: Snapshot history delta %" G_GUINT64_FORMAT
+		      " is corrupt\n"),
+		    _fw_snapshot_history_record(priv, i)->sequence);
+	    _fw_snapshot_history_state_free(state);
+	    return NULL;
+	}
+    }
+
+    return state;
+}
+
+/*
+ * Drops the oldest record. If the next record is a delta, it is replaced by
+ * a base so that the oldest record is always a base.
+ */
+static void
+_fw_snapshot_history_evict(FWSnapshotHistoryPrivate *priv)
+{
+    FWSnapshotHistoryRecord *oldest = _fw_snapshot_history_record(priv, 0);
+
+    if (priv->length > 1) {
+	FWSnapshotHistoryRecord *next = _fw_snapshot_history_record(priv, 1);
+
+	if (!next->base) {
+	    FWSnapshotHistoryState *state = _fw_snapshot_history_replay(priv, 1);
+
+	    if (state != NULL) {
+		priv->size -= g_variant_get_size(next->variant);
+		g_variant_unref(next->variant);
+		next->variant = g_variant_ref_sink(
+		    _fw_snapshot_history_state_to_variant(state,
+							  next->timestamp));
+		priv->size += g_variant_get_size(next->variant);
+		next->base = TRUE;
+		_fw_snapshot_history_state_free(state);
+	    }
+	}
+    }
+
+    priv->size -= g_variant_get_size(oldest->variant);
+    g_variant_unref(oldest->variant);
+    oldest->variant = NULL;
+    priv->head = (priv->head + 1) % priv->capacity;
+    priv->length--;
+}
+
+/* takes the reference of variant */
+static void
+_fw_snapshot_history_push(FWSnapshotHistoryPrivate *priv,
+			  gboolean base,
+			  guint64 timestamp,
+			  GVariant *variant)
+{
+    FWSnapshotHistoryRecord *record;
+
+    if (priv->length == priv->capacity)
+	_fw_snapshot_history_evict(priv);
+
+    record = _fw_snapshot_history_record(priv, priv->length);
+    record->timestamp = timestamp;
+    record->sequence = priv->sequence++;
+    record->base = base;
+    record->variant = variant;
+
+    if (base) {
+	record->base_sequence = record->sequence;
+	priv->since_base = 0;
+    } else {
+	record->base_sequence =
+	    _fw_snapshot_history_record(priv, priv->length - 1)->base_sequence;
+	priv->since_base++;
+    }
+
+    priv->size += g_variant_get_size(variant);
+    priv->length++;
+}
+
+static void
+_fw_snapshot_history_clear(FWSnapshotHistoryPrivate *priv)
+{
+    guint i;
+
+    for (i=0; i<priv->length; i++) {
+	FWSnapshotHistoryRecord *record = _fw_snapshot_history_record(priv, i);
+
+	g_variant_unref(record->variant);
+	record->variant = NULL;
+    }
+    priv->head = 0;
+    priv->length = 0;
+    priv->since_base = 0;
+    priv->size = 0;
+
+    _fw_snapshot_history_state_free(priv->state);
+    priv->state = NULL;
+    for (i=0; i<FW_SNAPSHOT_HISTORY_N_ITEMS; i++) {
+	if (priv->fingerprints[i] != NULL) {
+	    g_hash_table_destroy(priv->fingerprints[i]);
+	    priv->fingerprints[i] = NULL;
+	}
+    }
+}
+
+/* Returns: index of the newest record not after timestamp, -1 if none */
+static gint
+_fw_snapshot_history_search(FWSnapshotHistoryPrivate *priv,
+			    guint64 timestamp)
+{
+    guint low = 0, high = priv->length;
+
+    while (low < high) {
+	guint mid = low + (high - low) / 2;
+
+	if (_fw_snapshot_history_record(priv, mid)->timestamp <= timestamp)
+	    low = mid + 1;
+	else
+	    high = mid;
+    }
+
+    return (gint) low - 1;
+}
+
+/* file */
+
+static guint64
+_fw_snapshot_history_checksum(const gchar *data,
+			      gsize size)
+{
+    GChecksum *checksum = g_checksum_new(G_CHECKSUM_SHA256);
+    guint8 digest[32];
+    gsize digest_len = sizeof(digest);
+    guint64 ret;
+
+    g_checksum_update(checksum, (const guchar *) data, size);
+    g_checksum_get_digest(checksum, digest, &digest_len);
+    g_checksum_free(checksum);
+
+    memcpy(&ret, digest, sizeof(ret));
+
+    return ret;
+}
+
+static gboolean
+_fw_snapshot_history_write(FWSnapshotHistoryPrivate *priv,
+			   guint32 kind,
+			   guint64 timestamp,
+			   GVariant *variant)
+{
+    FWSnapshotHistoryRecordHeader header;
+    static const gchar padding[8] = { 0 };
+    gsize size = g_variant_get_size(variant);
+    gconstpointer data = g_variant_get_data(variant);
+
+    if (priv->file == NULL)
+	return TRUE;
+
+    memset(&header, 0, sizeof(header));
+    header.kind = kind;
+    header.timestamp = timestamp;
+    header.size = size;
+    header.checksum = _fw_snapshot_history_checksum(data, size);
+
+    if (fwrite(&header, sizeof(header), 1, priv->file) != 1 ||
+	(size > 0 && fwrite(data, size, 1, priv->file) != 1) ||
+	(FW_SNAPSHOT_HISTORY_PAD(size) > size &&
+	 fwrite(padding, FW_SNAPSHOT_HISTORY_PAD(size) - size, 1,
+		priv->file) != 1) ||
+	fflush(priv->file) != 0)
+    {
+	g_print(_("ERROR: Writing snapshot history '%s' failed\n"),
+		priv->filename);
+	return FALSE;
+    }
+
+    return TRUE;
+}
+
+/* reads the records of a mapped history file into the ring */
+static gboolean
+_fw_snapshot_history_read(FWSnapshotHistoryPrivate *priv,
+			  GMappedFile *mapped,
+			  gsize *valid_length)
+{
+    FWSnapshotHistoryFileHeader file_header;
+    const gchar *contents = g_mapped_file_get_contents(mapped);
+    gsize length = g_mapped_file_get_length(mapped);
+    GBytes *bytes;
+    guint64 newest = 0;
+    gsize offset;
+
+    if (length < sizeof(file_header)) {
+	*valid_length = 0;
+	return TRUE;
+    }
+
+    memcpy(&file_header, contents, sizeof(file_header));
+    if (memcmp(file_header.magic, FW_SNAPSHOT_HISTORY_MAGIC,
+	       sizeof(file_header.magic)) != 0)
+    {
+	g_print(_("ERROR: '%s' is not a snapshot history\n"), priv->filename);
+	return FALSE;
+    }
+    if (file_header.byte_order != FW_SNAPSHOT_HISTORY_BYTE_ORDER) {
+	g_print(_("ERROR: Snapshot history '%s' has a foreign byte order\n"),
+		priv->filename);
+	return FALSE;
+    }
+    if (file_header.version != FW_SNAPSHOT_HISTORY_FORMAT_VERSION) {
+	g_print(_("ERROR: Snapshot history '%s' has unsupported version %u\n"),
+		priv->filename, file_header.version);
+	return FALSE;
+    }
+
+    bytes = g_mapped_file_get_bytes(mapped);
+
+    offset = sizeof(file_header);
+    while (offset + sizeof(FWSnapshotHistoryRecordHeader) <= length) {
+	FWSnapshotHistoryRecordHeader header;
+	const GVariantType *type;
+	GBytes *payload;
+	GVariant *variant;
+
+	memcpy(&header, contents + offset, sizeof(header));
+	if (header.size > length - offset - sizeof(header) ||
+	    FW_SNAPSHOT_HISTORY_PAD(header.size) > length - offset - sizeof(header))
+	    break;  /* incomplete last record */
+
+	if (header.checksum != _fw_snapshot_history_checksum(
+		contents + offset + sizeof(header), header.size))
+	{
+	    g_print(_("ERROR: Snapshot history '%s' has an invalid checksum "
+		      "at offset %" G_GSIZE_FORMAT "\n"), priv->filename, offset);
+	    g_bytes_unref(bytes);
+	    return FALSE;
+	}
+
+	if (header.kind == FW_SNAPSHOT_HISTORY_RECORD_BASE)
+	    type = G_VARIANT_TYPE(FW_SNAPSHOT_VARIANT_TYPE);
+	else if (header.kind == FW_SNAPSHOT_HISTORY_RECORD_DELTA &&
+		 priv->length > 0)
+	    type = G_VARIANT_TYPE(FW_SNAPSHOT_HISTORY_DELTA_TYPE);
+	else {
+	    g_print(_("ERROR: Snapshot history '%s' has an invalid record "
+		      "at offset %" G_GSIZE_FORMAT "\n"), priv->filename, offset);
+	    g_bytes_unref(bytes);
+	    return FALSE;
+	}
+
+	if (header.timestamp < newest) {
+	    g_print(_("ERROR: Snapshot history '%s' is not in time order "
+		      "at offset %" G_GSIZE_FORMAT "\n"), priv->filename, offset);
+	    g_bytes_unref(bytes);
+	    return FALSE;
+	}
+	newest = header.timestamp;
+
+	payload = g_bytes_new_from_bytes(bytes, offset + sizeof(header),
+					 header.size);
+	variant = g_variant_ref_sink(
+	    g_variant_new_from_bytes(type, payload, FALSE));
+	g_bytes_unref(payload);
+
+	_fw_snapshot_history_push(priv,
+				  header.kind == FW_SNAPSHOT_HISTORY_RECORD_BASE,
+				  header.timestamp, variant);
+
+	offset += sizeof(header) + FW_SNAPSHOT_HISTORY_PAD(header.size);
+    }
+
+    g_bytes_unref(bytes);
+    *valid_length = offset;
+
+    return TRUE;
+}
+
+/**
+ * fw_snapshot_history_new:
+ * @capacity: number of records kept in memory, 0 for the default
+ * @base_interval: number of deltas between two bases, 0 for the default
+ *
+ * Returns: (transfer full) (type FWSnapshotHistory*)
+ */
+FWSnapshotHistory *
+fw_snapshot_history_new(guint capacity,
+			guint base_interval)
+{
+    FWSnapshotHistory *obj = g_object_new(FW_SNAPSHOT_HISTORY_TYPE, NULL);
+    FWSnapshotHistoryPrivate *priv = FW_SNAPSHOT_HISTORY_GET_PRIVATE(obj);
+
+    if (capacity == 0)
+	capacity = FW_SNAPSHOT_HISTORY_DEFAULT_CAPACITY;
+    if (base_interval == 0)
+	base_interval = FW_SNAPSHOT_HISTORY_DEFAULT_BASE_INTERVAL;
+
+    /* eviction rebases the second oldest record */
+    priv->capacity = MAX(capacity, 2);
+    priv->base_interval = base_interval;
+    priv->records = g_new0(FWSnapshotHistoryRecord, priv->capacity);
+
+    return obj;
+}
+
+static void
+fw_snapshot_history_init(FWSnapshotHistory *obj)
+{
+    FWSnapshotHistoryPrivate *priv = FW_SNAPSHOT_HISTORY_GET_PRIVATE(obj);
+    guint i;
+
+    /* init vars */
+    priv->records = NULL;
+    priv->capacity = 0;
+    priv->base_interval = 0;
+    priv->head = 0;
+    priv->length = 0;
+    priv->sequence = 0;
+    priv->since_base = 0;
+    priv->size = 0;
+    priv->state = NULL;
+    for (i=0; i<FW_SNAPSHOT_HISTORY_N_ITEMS; i++)
+	priv->fingerprints[i] = NULL;
+    priv->filename = NULL;
+    priv->file = NULL;
+}
+
+static void
+fw_snapshot_history_finalize(GObject *obj)
+{
+    FWSnapshotHistoryPrivate *priv = FW_SNAPSHOT_HISTORY_GET_PRIVATE(obj);
+
+    fw_snapshot_history_close(FW_SNAPSHOT_HISTORY(obj));
+    _fw_snapshot_history_clear(priv);
+    g_free(priv->records);
+
+    G_OBJECT_CLASS(fw_snapshot_history_parent_class)->finalize(obj);
+}
+
+static void
+fw_snapshot_history_class_init(FWSnapshotHistoryClass *fw_snapshot_history_class)
+{
+    GObjectClass *obj_class = G_OBJECT_CLASS(fw_snapshot_history_class);
+
+    obj_class->finalize = fw_snapshot_history_finalize;
+
+    g_type_class_add_private(obj_class, sizeof(FWSnapshotHistoryPrivate));
+    fw_accounting_register(obj_class, sizeof(FWSnapshotHistoryPrivate));
+}
+
+/* methods */
+
+/**
+ * fw_snapshot_history_open:
+ * @obj: (type FWSnapshotHistory*): an empty FWSnapshotHistory instance
+ * @filename: (type gchar*): history file
+ *
+ * Reads the records of an existing history file into the ring buffer and
+ * appends all further records to it. An incomplete last record left by an
+ * interrupted write is cut off.
+ *
+ * Returns: (type gboolean)
+ */
+gboolean
+fw_snapshot_history_open(FWSnapshotHistory *obj,
+			 const gchar *filename)
+{
+    FWSnapshotHistoryPrivate *priv = FW_SNAPSHOT_HISTORY_GET_PRIVATE(obj);
+    GMappedFile *mapped = NULL;
+    GError *error = NULL;
+    gsize valid_length = 0;
+
+#ifdef FW_DEBUG
+    g_printerr("fw_snapshot_history_open(%s)\n", filename);
+#endif
+
+    if (priv->length > 0 || priv->file != NULL) {
+	g_print(_("ERROR: Snapshot history is already in use\n"));
+	return FALSE;
+    }
+
+    priv->filename = g_strdup(filename);
+
+    if (g_file_test(filename, G_FILE_TEST_EXISTS)) {
+	mapped = g_mapped_file_new(filename, FALSE, &error);
+	if (mapped == NULL) {
+	    g_print(_("ERROR: Loading snapshot history '%s' failed: %s\n"),
+		    filename, error->message);
+	    g_error_free(error);
+	    fw_snapshot_history_close(obj);
+	    return FALSE;
+	}
+
+	if (!_fw_snapshot_history_read(priv, mapped, &valid_length)) {
+	    g_mapped_file_unref(mapped);
+	    _fw_snapshot_history_clear(priv);
+	    fw_snapshot_history_close(obj);
+	    return FALSE;
+	}
+
+	if (valid_length < g_mapped_file_get_length(mapped)) {
+	    g_print(_("ERROR: Snapshot history '%s' is truncated, dropping "
+		      "the incomplete last record\n"), filename);
+	    if (!g_file_set_contents(filename,
+				     g_mapped_file_get_contents(mapped),
+				     valid_length, &error))
+	    {
+		g_print(_("ERROR: Saving snapshot history '%s' failed: %s\n"),
+			filename, error->message);
+		g_error_free(error);
+		g_mapped_file_unref(mapped);
+		_fw_snapshot_history_clear(priv);
+		fw_snapshot_history_close(obj);
+		return FALSE;
+	    }
+	}
+	g_mapped_file_unref(mapped);
+    }
+
+    priv->file = fopen(filename, "ab");
+    if (priv->file == NULL) {
+	g_print(_("ERROR: Opening snapshot history '%s' failed\n"), filename);
+	fw_snapshot_history_close(obj);
+	return FALSE;
+    }
+
+    if (valid_length == 0) {
+	FWSnapshotHistoryFileHeader header;
+
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, FW_SNAPSHOT_HISTORY_MAGIC, sizeof(header.magic));
+	header.version = FW_SNAPSHOT_HISTORY_FORMAT_VERSION;
+	header.byte_order = FW_SNAPSHOT_HISTORY_BYTE_ORDER;
+
+	if (fwrite(&header, sizeof(header), 1, priv->file) != 1 ||
+	    fflush(priv->file) != 0)
+	{
+	    g_print(_("ERROR: Writing snapshot history '%s' failed\n"),
+		    filename);
+	    fw_snapshot_history_close(obj);
+	    return FALSE;
+	}
+    }
+
+    /* continue the deltas from the newest record */
+    if (priv->length > 0) {
+	priv->state = _fw_snapshot_history_replay(priv, priv->length - 1);
+	if (priv->state == NULL) {
+	    fw_snapshot_history_close(obj);
+	    return FALSE;
+	}
+    }
+
+    return TRUE;
+}
+
+/**
+ * fw_snapshot_history_close:
+ * @obj: (type FWSnapshotHistory*): a FWSnapshotHistory instance
+ *
+ * Stops appending to the history file, the records stay in memory.
+ */
+void
+fw_snapshot_history_close(FWSnapshotHistory *obj)
+{
+    FWSnapshotHistoryPrivate *priv = FW_SNAPSHOT_HISTORY_GET_PRIVATE(obj);
+
+    if (priv->file != NULL) {
+	fclose(priv->file);
+	priv->file = NULL;
+    }
+    if (priv->filename != NULL) {
+	g_free(priv->filename);
+	priv->filename = NULL;
+    }
+}
+
+/*
+ * Compares the entries of the snapshot with the current state, replaces the
+ * current state and adds the changes to delta. Entries with an unchanged
+ * fingerprint are skipped, changed settings are compared field by field.
+ */
+static void
+_fw_snapshot_history_diff(FWSnapshotHistoryPrivate *priv,
+			  GVariant *snapshot,
+			  GVariantBuilder *delta)
+{
+    FWSnapshotHistoryState *state = _fw_snapshot_history_state_new_from_variant(
+	snapshot);
+    guint i;
+
+    for (i=FW_SNAPSHOT_HISTORY_ZONES; i<FW_SNAPSHOT_HISTORY_N_ITEMS; i++) {
+	GHashTable *fingerprints = g_hash_table_new_full(g_str_hash,
+							 g_str_equal,
+							 g_free, g_free);
+	GHashTable *old = (priv->state != NULL) ? priv->state->items[i] : NULL;
+	GHashTableIter iter;
+	gpointer key, value;
+
+	g_hash_table_iter_init(&iter, state->items[i]);
+	while (g_hash_table_iter_next(&iter, &key, &value)) {
+	    FWFingerprint *fingerprint = g_new(FWFingerprint, 1);
+	    FWFingerprint *old_fingerprint = NULL, computed;
+	    GVariant *old_value = NULL;
+	    gsize j, n;
+
+	    fw_fingerprint_variant(value, fingerprint);
+	    g_hash_table_insert(fingerprints, g_strdup(key), fingerprint);
+
+	    if (old != NULL)
+		old_value = g_hash_table_lookup(old, key);
+	    if (old_value != NULL) {
+		if (priv->fingerprints[i] != NULL)
+		    old_fingerprint = g_hash_table_lookup(priv->fingerprints[i],
+							  key);
+		if (old_fingerprint == NULL) {
+		    fw_fingerprint_variant(old_value, &computed);
+		    old_fingerprint = &computed;
+		}
+		if (fw_fingerprint_equal(fingerprint, old_fingerprint))
+		    continue;
+	    }
+
+	    if (old_value == NULL || i >= FW_SNAPSHOT_HISTORY_DIRECT_RULES ||
+		g_variant_n_children(old_value) != g_variant_n_children(value))
+	    {
+		g_variant_builder_add(delta, "(ysiv)", (guchar) i, key,
+				      FW_SNAPSHOT_HISTORY_FIELD_ENTRY, value);
+		continue;
+	    }
+
+	    n = g_variant_n_children(value);
+	    for (j=0; j<n; j++) {
+		GVariant *field = g_variant_get_child_value(value, j);
+		GVariant *old_field = g_variant_get_child_value(old_value, j);
+
+		if (!g_variant_equal(field, old_field))
+		    g_variant_builder_add(delta, "(ysiv)", (guchar) i, key,
+					  (gint32) j, field);
+
+		g_variant_unref(old_field);
+		g_variant_unref(field);
+	    }
+	}
+
+	if (old != NULL) {
+	    g_hash_table_iter_init(&iter, old);
+	    while (g_hash_table_iter_next(&iter, &key, NULL))
+		if (!g_hash_table_contains(state->items[i], key))
+		    g_variant_builder_add(delta, "(ysiv)", (guchar) i, key,
+					  FW_SNAPSHOT_HISTORY_FIELD_REMOVED,
+					  g_variant_new_tuple(NULL, 0));
+	}
+
+	if (priv->fingerprints[i] != NULL)
+	    g_hash_table_destroy(priv->fingerprints[i]);
+	priv->fingerprints[i] = fingerprints;
+    }
+
+    _fw_snapshot_history_state_free(priv->state);
+    priv->state = state;
+}
+
+/**
+ * fw_snapshot_history_add:
+ * @obj: (type FWSnapshotHistory*): a FWSnapshotHistory instance
+ * @snapshot: (type FWSnapshot*): snapshot not older than the newest record
+ *
+ * Records the snapshot as a delta to the previous one, or as a new base
+ * every base_interval records. A snapshot without changes is not recorded.
+ *
+ * Returns: (type gboolean)
+ */
+gboolean
+fw_snapshot_history_add(FWSnapshotHistory *obj,
+			FWSnapshot *snapshot)
+{
+    FWSnapshotHistoryPrivate *priv = FW_SNAPSHOT_HISTORY_GET_PRIVATE(obj);
+    guint64 timestamp = fw_snapshot_getTimestamp(snapshot);
+    GVariantBuilder builder;
+    GVariant *variant, *delta;
+    gboolean base, ret;
+
+#ifdef FW_DEBUG
+    g_printerr("fw_snapshot_history_add(%" G_GUINT64_FORMAT ")\n", timestamp);
+#endif
+
+    if (priv->length > 0 &&
+	timestamp < _fw_snapshot_history_record(priv,
+						priv->length - 1)->timestamp)
+    {
+	g_print(_("ERROR: Snapshot is older than the snapshot history\n"));
+	return FALSE;
+    }
+
+    variant = fw_snapshot_to_variant(snapshot);
+
+    g_variant_builder_init(&builder,
+			   G_VARIANT_TYPE(FW_SNAPSHOT_HISTORY_DELTA_TYPE));
+    _fw_snapshot_history_diff(priv, variant, &builder);
+    delta = g_variant_ref_sink(g_variant_builder_end(&builder));
+
+    base = (priv->length == 0 || priv->since_base >= priv->base_interval);
+    if (!base && g_variant_n_children(delta) == 0) {
+	g_variant_unref(delta);
+	g_variant_unref(variant);
+	return TRUE;
+    }
+
+    if (base) {
+	ret = _fw_snapshot_history_write(priv, FW_SNAPSHOT_HISTORY_RECORD_BASE,
+					 timestamp, variant);
+	_fw_snapshot_history_push(priv, TRUE, timestamp, variant);
+	g_variant_unref(delta);
+    } else {
+	ret = _fw_snapshot_history_write(priv, FW_SNAPSHOT_HISTORY_RECORD_DELTA,
+					 timestamp, delta);
+	_fw_snapshot_history_push(priv, FALSE, timestamp, delta);
+	g_variant_unref(variant);
+    }
+
+    return ret;
+}
+
+/**
+ * fw_snapshot_history_addFromClient:
+ * @obj: (type FWSnapshotHistory*): a FWSnapshotHistory instance
+ * @client: (type FWClient*): a FWClient instance
+ *
+ * Returns: (type gboolean)
+ */
+gboolean
+fw_snapshot_history_addFromClient(FWSnapshotHistory *obj,
+				  FWClient *client)
+{
+    FWSnapshot *snapshot = fw_snapshot_new_from_client(client);
+    gboolean ret;
+
+    ret = fw_snapshot_history_add(obj, snapshot);
+    g_object_unref(snapshot);
+
+    return ret;
+}
+
+/**
+ * fw_snapshot_history_getAt:
+ * @obj: (type FWSnapshotHistory*): a FWSnapshotHistory instance
+ * @timestamp: (type guint64): real time in microseconds
+ *
+ * Reconstructs the state recorded last before or at timestamp.
+ *
+ * Returns: (transfer full) (allow-none) (type FWSnapshot*): NULL if
+ * timestamp is before the oldest record
+ */
+FWSnapshot *
+fw_snapshot_history_getAt(FWSnapshotHistory *obj,
+			  guint64 timestamp)
+{
+    FWSnapshotHistoryPrivate *priv = FW_SNAPSHOT_HISTORY_GET_PRIVATE(obj);
+    FWSnapshotHistoryRecord *record;
+    FWSnapshotHistoryState *state;
+    FWSnapshot *snapshot;
+    gint index;
+
+    index = _fw_snapshot_history_search(priv, timestamp);
+    if (index < 0)
+	return NULL;
+
+    record = _fw_snapshot_history_record(priv, index);
+    if (record->base)
+	return fw_snapshot_new_from_variant(record->variant);
+
+    state = _fw_snapshot_history_replay(priv, index);
+    if (state == NULL)
+	return NULL;
+
+    snapshot = fw_snapshot_new_from_variant(
+	_fw_snapshot_history_state_to_variant(state, record->timestamp));
+    _fw_snapshot_history_state_free(state);
+
+    return snapshot;
+}
+
+guint
+fw_snapshot_history_getLength(FWSnapshotHistory *obj)
+{
+    FWSnapshotHistoryPrivate *priv = FW_SNAPSHOT_HISTORY_GET_PRIVATE(obj);
+
+    return priv->length;
+}
+
+/**
+ * fw_snapshot_history_getTimestamp:
+ * @obj: (type FWSnapshotHistory*): a FWSnapshotHistory instance
+ * @index: record index, 0 is the oldest
+ *
+ * Returns: (type guint64): timestamp of the record, 0 if out of range
+ */
+guint64
+fw_snapshot_history_getTimestamp(FWSnapshotHistory *obj,
+				 guint index)
+{
+    FWSnapshotHistoryPrivate *priv = FW_SNAPSHOT_HISTORY_GET_PRIVATE(obj);
+
+    if (index >= priv->length)
+	return 0;
+
+    return _fw_snapshot_history_record(priv, index)->timestamp;
+}
+
+gboolean
+fw_snapshot_history_isBase(FWSnapshotHistory *obj,
+			   guint index)
+{
+    FWSnapshotHistoryPrivate *priv = FW_SNAPSHOT_HISTORY_GET_PRIVATE(obj);
+
+    if (index >= priv->length)
+	return FALSE;
+
+    return _fw_snapshot_history_record(priv, index)->base;
+}
+
+/**
+ * fw_snapshot_history_getSize:
+ * @obj: (type FWSnapshotHistory*): a FWSnapshotHistory instance
+ *
+ * Returns: serialized size of the records in memory in bytes
+ */
+gsize
+fw_snapshot_history_getSize(FWSnapshotHistory *obj)
+{
+    FWSnapshotHistoryPrivate *priv = FW_SNAPSHOT_HISTORY_GET_PRIVATE(obj);
+
+    return priv->size;
+}
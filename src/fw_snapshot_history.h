@@ -0,0 +1,73 @@
+/*
+ * Copyright (C) 2017 Red Hat, Inc.
+ *
+ * Authors:
+ * Thomas Woerner <twoerner@redhat.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __FW_SNAPSHOT_HISTORY_H__
+#define __FW_SNAPSHOT_HISTORY_H__
+
+#include <glib.h>
+#include <glib-object.h>
+#include "firewall.h"
+#include "fw_client.h"
+#include "fw_snapshot.h"
+
+#define FW_SNAPSHOT_HISTORY_TYPE            (fw_snapshot_history_get_type())
+#define FW_SNAPSHOT_HISTORY(obj)            (G_TYPE_CHECK_INSTANCE_CAST((obj), FW_SNAPSHOT_HISTORY_TYPE, FWSnapshotHistory))
+#define FW_SNAPSHOT_HISTORY_CLASS(klass)    (G_TYPE_CHECK_CLASS_CAST((klass), FW_SNAPSHOT_HISTORY_TYPE, FWSnapshotHistoryClass))
+#define FW_IS_SNAPSHOT_HISTORY(klass)       (G_TYPE_CHECK_INSTANCE_CLASS((klass), FW_SNAPSHOT_HISTORY_TYPE, FWSnapshotHistoryClass))
+#define FW_SNAPSHOT_HISTORY_GET_CLASS(obj)  (G_TYPE_INSTANCE_GET_CLASS((obj), FW_SNAPSHOT_HISTORY_TYPE, FWSnapshotHistoryClass))
+
+#define FW_SNAPSHOT_HISTORY_MAGIC           "FWHIST\r\n"
+#define FW_SNAPSHOT_HISTORY_FORMAT_VERSION  1
+
+/* one day of snapshots taken every minute, a base every hour */
+#define FW_SNAPSHOT_HISTORY_DEFAULT_CAPACITY       1440
+#define FW_SNAPSHOT_HISTORY_DEFAULT_BASE_INTERVAL  60
+
+/* item, name, field or FW_SNAPSHOT_HISTORY_FIELD_*, value */
+#define FW_SNAPSHOT_HISTORY_DELTA_TYPE  "a(ysiv)"
+
+#define FW_SNAPSHOT_HISTORY_FIELD_REMOVED  -1
+#define FW_SNAPSHOT_HISTORY_FIELD_ENTRY    -2
+
+typedef struct {
+    GObject parent;
+} FWSnapshotHistory;
+
+typedef struct {
+    GObjectClass parent;
+} FWSnapshotHistoryClass;
+
+GType fw_snapshot_history_get_type(void);
+FWSnapshotHistory *fw_snapshot_history_new(guint capacity, guint base_interval);
+
+gboolean fw_snapshot_history_open(FWSnapshotHistory *obj, const gchar *filename);
+void fw_snapshot_history_close(FWSnapshotHistory *obj);
+
+gboolean fw_snapshot_history_add(FWSnapshotHistory *obj, FWSnapshot *snapshot);
+gboolean fw_snapshot_history_addFromClient(FWSnapshotHistory *obj, FWClient *client);
+
+FWSnapshot *fw_snapshot_history_getAt(FWSnapshotHistory *obj, guint64 timestamp);
+
+guint fw_snapshot_history_getLength(FWSnapshotHistory *obj);
+guint64 fw_snapshot_history_getTimestamp(FWSnapshotHistory *obj, guint index);
+gboolean fw_snapshot_history_isBase(FWSnapshotHistory *obj, guint index);
+gsize fw_snapshot_history_getSize(FWSnapshotHistory *obj);
+
+#endif /* __FW_SNAPSHOT_HISTORY_H__ */
@@ -0,0 +1,369 @@
+/*
+ * Copyright (C) 2017 Red Hat, Inc.
+ *
+ * Authors:
+ * Thomas Woerner <twoerner@redhat.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Hierarchical timer wheel. Level 0 has one slot per tick, every slot of
+ * level n covers 64^n ticks. Timers are added to the lowest level that can
+ * hold them and moved down a level when the wheel reaches their slot, so
+ * adding and removing a timer is O(1) and advancing costs O(1) per tick
+ * plus the timers that are due. Times are in microseconds, like
+ * g_get_monotonic_time, timers never fire before they expire.
+ */
+
+#include "fw_timer_wheel.h"
+#include "fw_accounting.h"
+
+G_DEFINE_TYPE(FWTimerWheel, fw_timer_wheel, G_TYPE_OBJECT);
+
+#define FW_TIMER_WHEEL_GET_PRIVATE(o) (G_TYPE_INSTANCE_GET_PRIVATE((o), FW_TIMER_WHEEL_TYPE, FWTimerWheelPrivate))
+
+#define FW_TIMER_WHEEL_MASK  (FW_TIMER_WHEEL_SLOTS - 1)
+#define FW_TIMER_WHEEL_SHIFT(level)  ((level) * FW_TIMER_WHEEL_SLOT_BITS)
+
+struct _FWTimerWheelEntry {
+    gint64 expires;		/* time */
+    gint64 tick;		/* first tick at or after expires */
+    gpointer data;
+    GQueue *queue;		/* slot or due queue the entry is in */
+    GList link;
+};
+
+typedef struct {
+    gint64 tick_len;
+    gint64 origin;
+    gint64 current;		/* tick the wheel has been advanced to */
+    GQueue slots[FW_TIMER_WHEEL_LEVELS][FW_TIMER_WHEEL_SLOTS];
+    GQueue due;			/* expired, fired with the next advance */
+    guint length;
+} FWTimerWheelPrivate;
+
+/**
+ * fw_timer_wheel_new:
+ * @tick: length of a tick in microseconds
+ * @now: current time in microseconds
+ *
+ * Returns: (transfer full) (type FWTimerWheel*)
+ */
+FWTimerWheel *
+fw_timer_wheel_new(gint64 tick,
+		   gint64 now)
+{
+    FWTimerWheel *obj = g_object_new(FW_TIMER_WHEEL_TYPE, NULL);
+    FWTimerWheelPrivate *priv = FW_TIMER_WHEEL_GET_PRIVATE(obj);
+
+    priv->tick_len = MAX(tick, 1);
+    priv->origin = now;
+
+    return obj;
+}
+
+static void
+fw_timer_wheel_init(FWTimerWheel *obj)
+{
+    FWTimerWheelPrivate *priv = FW_TIMER_WHEEL_GET_PRIVATE(obj);
+    guint level, slot;
+
+    /* init vars */
+    priv->tick_len = G_USEC_PER_SEC;
+    priv->origin = 0;
+    priv->current = 0;
+    for (level = 0; level < FW_TIMER_WHEEL_LEVELS; level++)
+	for (slot = 0; slot < FW_TIMER_WHEEL_SLOTS; slot++)
+	    g_queue_init(&priv->slots[level][slot]);
+    g_queue_init(&priv->due);
+    priv->length = 0;
+}
+
+static void
+_fw_timer_wheel_queue_free(GQueue *queue)
+{
+    while (!g_queue_is_empty(queue)) {
+	GList *link = g_queue_pop_head_link(queue);
+
+	g_slice_free(FWTimerWheelEntry, link->data);
+    }
+}
+
+static void
+fw_timer_wheel_finalize(GObject *obj)
+{
+    FWTimerWheelPrivate *priv = FW_TIMER_WHEEL_GET_PRIVATE(obj);
+    guint level, slot;
+
+    for (level = 0; level < FW_TIMER_WHEEL_LEVELS; level++)
+	for (slot = 0; slot < FW_TIMER_WHEEL_SLOTS; slot++)
+	    _fw_timer_wheel_queue_free(&priv->slots[level][slot]);
+    _fw_timer_wheel_queue_free(&priv->due);
+
+    G_OBJECT_CLASS(fw_timer_wheel_parent_class)->finalize(obj);
+}
+
+static void
+fw_timer_wheel_class_init(FWTimerWheelClass *fw_timer_wheel_class)
+{
+    GObjectClass *obj_class = G_OBJECT_CLASS(fw_timer_wheel_class);
+
+    obj_class->finalize = fw_timer_wheel_finalize;
+
+    g_type_class_add_private(obj_class, sizeof(FWTimerWheelPrivate));
+    fw_accounting_register(obj_class, sizeof(FWTimerWheelPrivate));
+}
+
+/* puts the entry into the slot for its tick, relative to priv->current */
+static void
+_fw_timer_wheel_place(FWTimerWheelPrivate *priv,
+		      FWTimerWheelEntry *entry)
+{
+    gint64 delta = entry->tick - priv->current;
+    guint level;
+
+    if (delta <= 0) {
+	entry->queue = &priv->due;
+    } else {
+	for (level = 0; level < FW_TIMER_WHEEL_LEVELS - 1; level++) {
+	    if ((delta >> FW_TIMER_WHEEL_SHIFT(level + 1)) == 0)
+		break;
+	}
+	if ((delta >> FW_TIMER_WHEEL_SHIFT(level + 1)) == 0) {
+	    entry->queue = &priv->slots[level][
+		(entry->tick >> FW_TIMER_WHEEL_SHIFT(level)) &
+		FW_TIMER_WHEEL_MASK];
+	} else {
+	    /* beyond the wheel: the slot of the top level that is reached
+	       last, the entry is placed again from there */
+	    entry->queue = &priv->slots[level][
+		((priv->current >> FW_TIMER_WHEEL_SHIFT(level)) - 1) &
+		FW_TIMER_WHEEL_MASK];
+	}
+    }
+
+    g_queue_push_tail_link(entry->queue, &entry->link);
+}
+
+/**
+ * fw_timer_wheel_add:
+ * @obj: (type FWTimerWheel*): a FWTimerWheel instance
+ * @expires: expiry time in microseconds
+ * @data: (allow-none): user data of the timer
+ *
+ * Returns: (transfer none): handle of the timer for fw_timer_wheel_remove
+ */
+FWTimerWheelEntry *
+fw_timer_wheel_add(FWTimerWheel *obj,
+		   gint64 expires,
+		   gpointer data)
+{
+    FWTimerWheelPrivate *priv = FW_TIMER_WHEEL_GET_PRIVATE(obj);
+    FWTimerWheelEntry *entry = g_slice_new0(FWTimerWheelEntry);
+    gint64 offset = expires - priv->origin;
+
+    entry->expires = expires;
+    if (offset <= 0)
+	entry->tick = 0;
+    else
+	entry->tick = (offset + priv->tick_len - 1) / priv->tick_len;
+    entry->data = data;
+    entry->link.data = entry;
+
+    _fw_timer_wheel_place(priv, entry);
+    priv->length++;
+
+    return entry;
+}
+
+/**
+ * fw_timer_wheel_remove:
+ * @obj: (type FWTimerWheel*): a FWTimerWheel instance
+ * @entry: handle of a timer that has not expired yet
+ */
+void
+fw_timer_wheel_remove(FWTimerWheel *obj,
+		      FWTimerWheelEntry *entry)
+{
+    FWTimerWheelPrivate *priv = FW_TIMER_WHEEL_GET_PRIVATE(obj);
+
+    g_queue_unlink(entry->queue, &entry->link);
+    g_slice_free(FWTimerWheelEntry, entry);
+    priv->length--;
+}
+
+guint
+fw_timer_wheel_length(FWTimerWheel *obj)
+{
+    FWTimerWheelPrivate *priv = FW_TIMER_WHEEL_GET_PRIVATE(obj);
+
+    return priv->length;
+}
+
+gint64
+fw_timer_wheel_getExpires(FWTimerWheelEntry *entry)
+{
+    return entry->expires;
+}
+
+gpointer
+fw_timer_wheel_getData(FWTimerWheelEntry *entry)
+{
+    return entry->data;
+}
+
+/* places all entries of the queue again */
+static void
+_fw_timer_wheel_cascade(FWTimerWheelPrivate *priv,
+			GQueue *queue)
+{
+    GQueue entries = *queue;
+
+    g_queue_init(queue);
+    while (!g_queue_is_empty(&entries)) {
+	GList *link = g_queue_pop_head_link(&entries);
+
+	_fw_timer_wheel_place(priv, link->data);
+    }
+}
+
+/* fires and frees all entries of the due queue */
+static guint
+_fw_timer_wheel_fire(FWTimerWheelPrivate *priv,
+		     FWTimerWheelFunc func,
+		     gpointer user_data)
+{
+    guint n = 0;
+
+    while (!g_queue_is_empty(&priv->due)) {
+	GList *link = g_queue_pop_head_link(&priv->due);
+	FWTimerWheelEntry *entry = link->data;
+	gpointer data = entry->data;
+
+	g_slice_free(FWTimerWheelEntry, entry);
+	priv->length--;
+	n++;
+
+	if (func != NULL)
+	    func(data, user_data);
+    }
+
+    return n;
+}
+
+/**
+ * fw_timer_wheel_advance:
+ * @obj: (type FWTimerWheel*): a FWTimerWheel instance
+ * @now: current time in microseconds
+ * @func: (scope call) (allow-none): called for every expired timer, the
+ *   handle is not valid anymore
+ * @user_data: (allow-none): user data for func
+ *
+ * Returns: number of expired timers
+ */
+guint
+fw_timer_wheel_advance(FWTimerWheel *obj,
+		       gint64 now,
+		       FWTimerWheelFunc func,
+		       gpointer user_data)
+{
+    FWTimerWheelPrivate *priv = FW_TIMER_WHEEL_GET_PRIVATE(obj);
+    gint64 target = (now - priv->origin) / priv->tick_len;
+    guint n = 0;
+    gint level;
+
+    if (priv->length == 0 ||
+	target - priv->current >
+	((gint64) 1 << FW_TIMER_WHEEL_SHIFT(FW_TIMER_WHEEL_LEVELS)))
+    {
+	/* nothing to walk through or a jump over the whole wheel */
+	GQueue all = G_QUEUE_INIT;
+	guint slot;
+
+	for (level = 0; level < FW_TIMER_WHEEL_LEVELS; level++) {
+	    for (slot = 0; slot < FW_TIMER_WHEEL_SLOTS; slot++) {
+		GQueue *queue = &priv->slots[level][slot];
+
+		while (!g_queue_is_empty(queue))
+		    g_queue_push_tail_link(&all,
+					   g_queue_pop_head_link(queue));
+	    }
+	}
+	priv->current = MAX(priv->current, target);
+	_fw_timer_wheel_cascade(priv, &all);
+	return _fw_timer_wheel_fire(priv, func, user_data);
+    }
+
+    n += _fw_timer_wheel_fire(priv, func, user_data);
+
+    while (priv->current < target) {
+	priv->current++;
+
+	/* move the slots down that the wheel reached, top level first */
+	for (level = FW_TIMER_WHEEL_LEVELS - 1; level > 0; level--) {
+	    gint64 low = ((gint64) 1 << FW_TIMER_WHEEL_SHIFT(level)) - 1;
+
+	    if ((priv->current & low) == 0)
+		_fw_timer_wheel_cascade(
+		    priv, &priv->slots[level][
+			(priv->current >> FW_TIMER_WHEEL_SHIFT(level)) &
+			FW_TIMER_WHEEL_MASK]);
+	}
+	_fw_timer_wheel_cascade(
+	    priv, &priv->slots[0][priv->current & FW_TIMER_WHEEL_MASK]);
+
+	n += _fw_timer_wheel_fire(priv, func, user_data);
+    }
+
+    return n;
+}
+
+/**
+ * fw_timer_wheel_getNextWakeup:
+ * @obj: (type FWTimerWheel*): a FWTimerWheel instance
+ *
+ * The next time the wheel needs to be advanced: when the next timer
+ * expires or when far timers have to be moved down a level. It is in the
+ * past if there are expired timers.
+ *
+ * Returns: time in microseconds or -1 if there are no timers
+ */
+gint64
+fw_timer_wheel_getNextWakeup(FWTimerWheel *obj)
+{
+    FWTimerWheelPrivate *priv = FW_TIMER_WHEEL_GET_PRIVATE(obj);
+    gint64 next = G_MAXINT64;
+    guint level, j;
+
+    if (priv->length == 0)
+	return -1;
+    if (!g_queue_is_empty(&priv->due))
+	return priv->origin + priv->current * priv->tick_len;
+
+    for (level = 0; level < FW_TIMER_WHEEL_LEVELS; level++) {
+	gint64 base = priv->current >> FW_TIMER_WHEEL_SHIFT(level);
+
+	for (j = 1; j <= FW_TIMER_WHEEL_SLOTS; j++) {
+	    if (!g_queue_is_empty(&priv->slots[level][(base + j) &
+						      FW_TIMER_WHEEL_MASK]))
+	    {
+		next = MIN(next, (base + j) << FW_TIMER_WHEEL_SHIFT(level));
+		break;
+	    }
+	}
+    }
+
+    return priv->origin + next * priv->tick_len;
+}
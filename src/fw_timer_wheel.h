@@ -0,0 +1,65 @@
+/*
+ * Copyright (C) 2017 Red Hat, Inc.
+ *
+ * Authors:
+ * Thomas Woerner <twoerner@redhat.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __FW_TIMER_WHEEL_H__
+#define __FW_TIMER_WHEEL_H__
+
+#include <glib.h>
+#include <glib-object.h>
+#include "firewall.h"
+
+#define FW_TIMER_WHEEL_TYPE            (fw_timer_wheel_get_type())
+#define FW_TIMER_WHEEL(obj)            (G_TYPE_CHECK_INSTANCE_CAST((obj), FW_TIMER_WHEEL_TYPE, FWTimerWheel))
+#define FW_TIMER_WHEEL_CLASS(klass)    (G_TYPE_CHECK_CLASS_CAST((klass), FW_TIMER_WHEEL_TYPE, FWTimerWheelClass))
+#define FW_IS_TIMER_WHEEL(klass)       (G_TYPE_CHECK_INSTANCE_CLASS((klass), FW_TIMER_WHEEL_TYPE, FWTimerWheelClass))
+#define FW_TIMER_WHEEL_GET_CLASS(obj)  (G_TYPE_INSTANCE_GET_CLASS((obj), FW_TIMER_WHEEL_TYPE, FWTimerWheelClass))
+
+/* 4 levels of 64 slots: 64^4 ticks, about 194 days with 1s ticks */
+#define FW_TIMER_WHEEL_LEVELS      4
+#define FW_TIMER_WHEEL_SLOT_BITS   6
+#define FW_TIMER_WHEEL_SLOTS       (1 << FW_TIMER_WHEEL_SLOT_BITS)
+
+typedef struct {
+    GObject parent;
+} FWTimerWheel;
+
+typedef struct {
+    GObjectClass parent;
+} FWTimerWheelClass;
+
+/* handle of a timer, valid until it expired or has been removed */
+typedef struct _FWTimerWheelEntry FWTimerWheelEntry;
+
+typedef void (*FWTimerWheelFunc)(gpointer data, gpointer user_data);
+
+GType fw_timer_wheel_get_type(void);
+FWTimerWheel *fw_timer_wheel_new(gint64 tick, gint64 now);
+
+FWTimerWheelEntry *fw_timer_wheel_add(FWTimerWheel *obj, gint64 expires, gpointer data);
+void fw_timer_wheel_remove(FWTimerWheel *obj, FWTimerWheelEntry *entry);
+guint fw_timer_wheel_length(FWTimerWheel *obj);
+
+gint64 fw_timer_wheel_getExpires(FWTimerWheelEntry *entry);
+gpointer fw_timer_wheel_getData(FWTimerWheelEntry *entry);
+
+guint fw_timer_wheel_advance(FWTimerWheel *obj, gint64 now, FWTimerWheelFunc func, gpointer user_data);
+gint64 fw_timer_wheel_getNextWakeup(FWTimerWheel *obj);
+
+#endif /* __FW_TIMER_WHEEL_H__ */
@@ -0,0 +1,93 @@
+/*
+ * Copyright (C) 2017 Red Hat, Inc.
+ *
+ * Authors:
+ * Thomas Woerner <twoerner@redhat.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Static tracepoints of the provider libfirewall for perf, bpftrace and
+ * systemtap:
+ *
+ *   call__start(method, path, size)
+ *   call__done(method, path, size, duration, failed)
+ *   decode__start(decoder, size)
+ *   decode__done(decoder, size, duration)
+ *
+ * size is the serialized size of the parameters, the reply or the decoded
+ * variant in bytes, duration is in microseconds and decoder the name of the
+ * *_new_from_variant function. Calls on the offline config carry the path
+ * of the config object. The probes are nops until a tracer attaches, without
+ * FW_TRACE they are compiled out.
+ *
+ *   bpftrace -e 'usdt:libfirewall.so:libfirewall:call__done
+ *       { @[str(arg0)] = hist(arg3); }'
+ */
+
+#ifndef __FW_TRACE_H__
+#define __FW_TRACE_H__
+
+#include <glib.h>
+#include <gio/gio.h>
+
+#ifdef FW_TRACE
+
+#include <sys/sdt.h>
+
+static inline gsize
+_fw_trace_size(GVariant *variant)
+{
+    return (variant != NULL) ? g_variant_get_size(variant) : 0;
+}
+
+static inline const gchar *
+_fw_trace_path(GDBusProxy *proxy)
+{
+    return (proxy != NULL) ? g_dbus_proxy_get_object_path(proxy) : NULL;
+}
+
+#define FW_TRACE_CALL_START(method, path, parameters) \
+    gint64 _fw_trace_call_start = g_get_monotonic_time(); \
+    DTRACE_PROBE3(libfirewall, call__start, (method), (path), \
+		  _fw_trace_size(parameters))
+
+#define FW_TRACE_CALL_DONE(method, path, result, error) \
+    DTRACE_PROBE5(libfirewall, call__done, (method), (path), \
+		  _fw_trace_size(result), \
+		  g_get_monotonic_time() - _fw_trace_call_start, \
+		  (error) != NULL)
+
+#define FW_TRACE_DECODE_START(variant) \
+    gint64 _fw_trace_decode_start = g_get_monotonic_time(); \
+    gsize _fw_trace_decode_size = _fw_trace_size(variant); \
+    DTRACE_PROBE2(libfirewall, decode__start, __func__, _fw_trace_decode_size)
+
+#define FW_TRACE_DECODE_DONE() \
+    DTRACE_PROBE3(libfirewall, decode__done, __func__, _fw_trace_decode_size, \
+		  g_get_monotonic_time() - _fw_trace_decode_start)
+
+#define FW_TRACE_PROXY_PATH(proxy) _fw_trace_path(proxy)
+
+#else /* FW_TRACE */
+
+#define FW_TRACE_CALL_START(method, path, parameters)
+#define FW_TRACE_CALL_DONE(method, path, result, error)
+#define FW_TRACE_DECODE_START(variant)
+#define FW_TRACE_DECODE_DONE()
+
+#endif /* FW_TRACE */
+
+#endif /* __FW_TRACE_H__ */
@@ -0,0 +1,1010 @@
+/*
+ * Copyright (C) 2017 Red Hat, Inc.
+ *
+ * Authors:
+ * Thomas Woerner <twoerner@redhat.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <errno.h>
+#include <string.h>
+#include "firewall.h"
+#include "fw_xml.h"
+
+#define FW_XML_MAX_FIELDS 16
+
+/* Index of every XML element in the settings tuple of a type, -1 if the
+ * element does not exist for the type. The settings tuples are the ones
+ * used by the firewalld config D-Bus interface. */
+typedef struct {
+    const gchar *name;
+    const gchar *dir;
+    const gchar *signature;
+    gint target;
+    gint services;
+    gint ports;
+    gint icmp_blocks;
+    gint masquerade;
+    gint forward_ports;
+    gint interfaces;
+    gint sources;
+    gint rules;
+    gint protocols;
+    gint source_ports;
+    gint icmp_block_inversion;
+    gint modules;
+    gint destinations;
+    gint ipset_type;
+    gint options;
+    gint entries;
+    gint family;
+    gint module;
+} FWXmlTypeInfo;
+
+static const FWXmlTypeInfo fw_xml_types[FW_XML_N_TYPES] = {
+    /* target, services, ports, icmp_blocks, masquerade, forward_ports,
+       interfaces, sources, rules, protocols, source_ports,
+       icmp_block_inversion, modules, destinations, ipset_type, options,
+       entries, family, module */
+    { "zone", "zones", FW_XML_ZONE_SIGNATURE,
+      4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, -1, -1, -1, -1, -1, -1, -1 },
+    { "service", "services", FW_XML_SERVICE_SIGNATURE,
+      -1, -1, 3, -1, -1, -1, -1, -1, -1, 6, 7, -1, 4, 5, -1, -1, -1, -1, -1 },
+    { "ipset", "ipsets", FW_XML_IPSET_SIGNATURE,
+      -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 3, 4, 5, -1, -1 },
+    { "icmptype", "icmptypes", FW_XML_ICMPTYPE_SIGNATURE,
+      -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 3, -1, -1, -1, -1, -1 },
+    { "helper", "helpers", FW_XML_HELPER_SIGNATURE,
+      -1, -1, 5, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 3, 4 },
+};
+
+/* version, short and description are the first three fields of all types */
+#define FW_XML_VERSION     0
+#define FW_XML_SHORT       1
+#define FW_XML_DESCRIPTION 2
+
+const gchar *
+fw_xml_type_get_name(FWXmlType type)
+{
+    g_return_val_if_fail(type < FW_XML_N_TYPES, NULL);
+    return fw_xml_types[type].name;
+}
+
+const gchar *
+fw_xml_type_get_dir(FWXmlType type)
+{
+    g_return_val_if_fail(type < FW_XML_N_TYPES, NULL);
+    return fw_xml_types[type].dir;
+}
+
+const gchar *
+fw_xml_type_get_signature(FWXmlType type)
+{
+    g_return_val_if_fail(type < FW_XML_N_TYPES, NULL);
+    return fw_xml_types[type].signature;
+}
+
+/****************************************************************************/
+/* parser */
+
+typedef struct {
+    const FWXmlTypeInfo *info;
+    const GVariantType *field_types[FW_XML_MAX_FIELDS];
+    gint n_fields;
+
+    gchar *strings[FW_XML_MAX_FIELDS];
+    gboolean bools[FW_XML_MAX_FIELDS];
+    GVariantBuilder *arrays[FW_XML_MAX_FIELDS];
+
+    gint depth;
+    gint text_field;
+    GString *text;
+
+    /* rich rule collected from the current <rule> element */
+    GString *rule;
+    gint rule_depth;
+} FWXmlParseData;
+
+static const gchar *
+_fw_xml_attr(const gchar **names, const gchar **values, const gchar *name)
+{
+    gint i;
+
+    for (i=0; names[i] != NULL; i++) {
+	if (strcmp(names[i], name) == 0)
+	    return values[i];
+    }
+    return NULL;
+}
+
+static gboolean
+_fw_xml_attr_is_true(const gchar *value)
+{
+    return (value != NULL &&
+	    (g_ascii_strcasecmp(value, "true") == 0 ||
+	     g_ascii_strcasecmp(value, "yes") == 0 ||
+	     strcmp(value, "1") == 0));
+}
+
+static GVariantBuilder *
+_fw_xml_array(FWXmlParseData *data, gint field)
+{
+    if (data->arrays[field] == NULL)
+	data->arrays[field] = g_variant_builder_new(data->field_types[field]);
+    return data->arrays[field];
+}
+
+static void
+_fw_xml_set_string(FWXmlParseData *data, gint field, const gchar *value)
+{
+    if (field < 0 || value == NULL)
+	return;
+    g_free(data->strings[field]);
+    data->strings[field] = g_strdup(value);
+}
+
+static void
+_fw_xml_add_string(FWXmlParseData *data, gint field, const gchar *value)
+{
+    if (field < 0 || value == NULL)
+	return;
+    g_variant_builder_add(_fw_xml_array(data, field), "s", value);
+}
+
+static void
+_fw_xml_add_port(FWXmlParseData *data, gint field,
+		 const gchar **names, const gchar **values)
+{
+    const gchar *port = _fw_xml_attr(names, values, "port");
+    const gchar *protocol = _fw_xml_attr(names, values, "protocol");
+
+    if (field < 0)
+	return;
+    g_variant_builder_add(_fw_xml_array(data, field), "(ss)",
+			  port ? port : "", protocol ? protocol : "");
+}
+
+static void
+_fw_xml_rule_start(FWXmlParseData *data,
+		   const gchar *element_name,
+		   const gchar **names,
+		   const gchar **values,
+		   GError **error)
+{
+    gint i;
+
+    /* rich rule values are quoted without escapes, a quote in a value
+       would end it early and firewalld would read a different rule */
+    for (i=0; names[i] != NULL; i++) {
+	if (strchr(values[i], '"') != NULL) {
+	    g_set_error(error, G_MARKUP_ERROR, G_MARKUP_ERROR_INVALID_CONTENT,
+			"Quote in attribute '%s' of rule element '%s'",
+			names[i], element_name);
+	    return;
+	}
+    }
+
+    if (data->rule_depth > 0) {
+	g_string_append_c(data->rule, ' ');
+	g_string_append(data->rule, element_name);
+    }
+
+    if ((strcmp(element_name, "source") == 0 ||
+	 strcmp(element_name, "destination") == 0) &&
+	_fw_xml_attr_is_true(_fw_xml_attr(names, values, "invert")))
+	g_string_append(data->rule, " NOT");
+
+    for (i=0; names[i] != NULL; i++) {
+	if (strcmp(names[i], "invert") == 0)
+	    continue;
+	g_string_append_printf(data->rule, " %s=\"%s\"", names[i], values[i]);
+    }
+
+    data->rule_depth++;
+}
+
+static void
+_fw_xml_start_element(GMarkupParseContext *context,
+		      const gchar *element_name,
+		      const gchar **names,
+		      const gchar **values,
+		      gpointer user_data,
+		      GError **error)
+{
+    FWXmlParseData *data = user_data;
+    const FWXmlTypeInfo *info = data->info;
+    const gchar *value;
+
+    data->depth++;
+
+    if (data->rule != NULL) {
+	_fw_xml_rule_start(data, element_name, names, values, error);
+	return;
+    }
+
+    if (data->depth == 1) {
+	if (strcmp(element_name, info->name) != 0) {
+	    g_set_error(error, G_MARKUP_ERROR, G_MARKUP_ERROR_UNKNOWN_ELEMENT,
+			"Unexpected root element '%s', expected '%s'",
+			element_name, info->name);
+	    return;
+	}
+	_fw_xml_set_string(data, FW_XML_VERSION,
+			   _fw_xml_attr(names, values, "version"));
+	/* a zone without target attribute uses the default target */
+	_fw_xml_set_string(data, info->target, "default");
+	_fw_xml_set_string(data, info->target,
+			   _fw_xml_attr(names, values, "target"));
+	_fw_xml_set_string(data, info->ipset_type,
+			   _fw_xml_attr(names, values, "type"));
+	_fw_xml_set_string(data, info->family,
+			   _fw_xml_attr(names, values, "family"));
+	_fw_xml_set_string(data, info->module,
+			   _fw_xml_attr(names, values, "module"));
+	return;
+    }
+
+    /* only direct children of the root element are of interest */
+    if (data->depth != 2)
+	return;
+
+    if (strcmp(element_name, "short") == 0) {
+	data->text_field = FW_XML_SHORT;
+    } else if (strcmp(element_name, "description") == 0) {
+	data->text_field = FW_XML_DESCRIPTION;
+    } else if (strcmp(element_name, "entry") == 0) {
+	data->text_field = info->entries;
+    } else if (strcmp(element_name, "port") == 0) {
+	_fw_xml_add_port(data, info->ports, names, values);
+    } else if (strcmp(element_name, "source-port") == 0) {
+	_fw_xml_add_port(data, info->source_ports, names, values);
+    } else if (strcmp(element_name, "protocol") == 0) {
+	_fw_xml_add_string(data, info->protocols,
+			   _fw_xml_attr(names, values, "value"));
+    } else if (strcmp(element_name, "service") == 0) {
+	_fw_xml_add_string(data, info->services,
+			   _fw_xml_attr(names, values, "name"));
+    } else if (strcmp(element_name, "icmp-block") == 0) {
+	_fw_xml_add_string(data, info->icmp_blocks,
+			   _fw_xml_attr(names, values, "name"));
+    } else if (strcmp(element_name, "interface") == 0) {
+	_fw_xml_add_string(data, info->interfaces,
+			   _fw_xml_attr(names, values, "name"));
+    } else if (strcmp(element_name, "module") == 0) {
+	_fw_xml_add_string(data, info->modules,
+			   _fw_xml_attr(names, values, "name"));
+    } else if (strcmp(element_name, "masquerade") == 0) {
+	if (info->masquerade >= 0)
+	    data->bools[info->masquerade] = TRUE;
+    } else if (strcmp(element_name, "icmp-block-inversion") == 0) {
+	if (info->icmp_block_inversion >= 0)
+	    data->bools[info->icmp_block_inversion] = TRUE;
+    } else if (strcmp(element_name, "source") == 0) {
+	if (info->sources < 0)
+	    return;
+	if ((value = _fw_xml_attr(names, values, "address")) != NULL) {
+	    _fw_xml_add_string(data, info->sources, value);
+	} else if ((value = _fw_xml_attr(names, values, "mac")) != NULL) {
+	    gchar *mac = g_ascii_strup(value, -1);
+	    _fw_xml_add_string(data, info->sources, mac);
+	    g_free(mac);
+	} else if ((value = _fw_xml_attr(names, values, "ipset")) != NULL) {
+	    gchar *ipset = g_strdup_printf("ipset:%s", value);
+	    _fw_xml_add_string(data, info->sources, ipset);
+	    g_free(ipset);
+	}
+    } else if (strcmp(element_name, "forward-port") == 0) {
+	const gchar *port = _fw_xml_attr(names, values, "port");
+	const gchar *protocol = _fw_xml_attr(names, values, "protocol");
+	const gchar *toport = _fw_xml_attr(names, values, "to-port");
+	const gchar *toaddr = _fw_xml_attr(names, values, "to-addr");
+
+	if (info->forward_ports < 0)
+	    return;
+	g_variant_builder_add(_fw_xml_array(data, info->forward_ports),
+			      "(ssss)",
+			      port ? port : "", protocol ? protocol : "",
+			      toport ? toport : "", toaddr ? toaddr : "");
+    } else if (strcmp(element_name, "destination") == 0) {
+	const gchar *ipv4 = _fw_xml_attr(names, values, "ipv4");
+	const gchar *ipv6 = _fw_xml_attr(names, values, "ipv6");
+
+	if (info->destinations < 0)
+	    return;
+	if (g_variant_type_is_dict_entry(
+		g_variant_type_element(data->field_types[info->destinations])))
+	{
+	    /* service: address per ip version */
+	    if (ipv4 != NULL)
+		g_variant_builder_add(_fw_xml_array(data, info->destinations),
+				      "{ss}", "ipv4", ipv4);
+	    if (ipv6 != NULL)
+		g_variant_builder_add(_fw_xml_array(data, info->destinations),
+				      "{ss}", "ipv6", ipv6);
+	} else {
+	    /* icmptype: ip versions the type is available for */
+	    if (_fw_xml_attr_is_true(ipv4))
+		_fw_xml_add_string(data, info->destinations, "ipv4");
+	    if (_fw_xml_attr_is_true(ipv6))
+		_fw_xml_add_string(data, info->destinations, "ipv6");
+	}
+    } else if (strcmp(element_name, "option") == 0) {
+	const gchar *name = _fw_xml_attr(names, values, "name");
+	const gchar *option = _fw_xml_attr(names, values, "value");
+
+	if (info->options < 0 || name == NULL)
+	    return;
+	g_variant_builder_add(_fw_xml_array(data, info->options), "{ss}",
+			      name, option ? option : "");
+    } else if (strcmp(element_name, "rule") == 0) {
+	if (info->rules < 0)
+	    return;
+	data->rule = g_string_new("rule");
+	data->rule_depth = 0;
+	_fw_xml_rule_start(data, element_name, names, values, error);
+    }
+
+    if (data->text_field >= 0)
+	g_string_truncate(data->text, 0);
+}
+
+static void
+_fw_xml_end_element(GMarkupParseContext *context,
+		    const gchar *element_name,
+		    gpointer user_data,
+		    GError **error)
+{
+    FWXmlParseData *data = user_data;
+
+    data->depth--;
+
+    if (data->rule != NULL) {
+	if (--data->rule_depth == 0) {
+	    _fw_xml_add_string(data, data->info->rules, data->rule->str);
+	    g_string_free(data->rule, TRUE);
+	    data->rule = NULL;
+	}
+	return;
+    }
+
+    if (data->text_field < 0)
+	return;
+
+    if (data->text_field == data->info->entries)
+	_fw_xml_add_string(data, data->text_field, data->text->str);
+    else
+	_fw_xml_set_string(data, data->text_field, data->text->str);
+    data->text_field = -1;
+}
+
+static void
+_fw_xml_text(GMarkupParseContext *context,
+	     const gchar *text,
+	     gsize text_len,
+	     gpointer user_data,
+	     GError **error)
+{
+    FWXmlParseData *data = user_data;
+
+    if (data->text_field >= 0)
+	g_string_append_len(data->text, text, text_len);
+}
+
+static const GMarkupParser fw_xml_parser = {
+    _fw_xml_start_element,
+    _fw_xml_end_element,
+    _fw_xml_text,
+    NULL,
+    NULL
+};
+
+static GVariant *
+_fw_xml_parse_data_end(FWXmlParseData *data)
+{
+    GVariantBuilder builder;
+    gint i;
+
+    g_variant_builder_init(&builder, G_VARIANT_TYPE(data->info->signature));
+    for (i=0; i<data->n_fields; i++) {
+	const GVariantType *field_type = data->field_types[i];
+
+	if (g_variant_type_equal(field_type, G_VARIANT_TYPE_STRING)) {
+	    g_variant_builder_add(&builder, "s",
+				  data->strings[i] ? data->strings[i] : "");
+	} else if (g_variant_type_equal(field_type, G_VARIANT_TYPE_BOOLEAN)) {
+	    g_variant_builder_add(&builder, "b", data->bools[i]);
+	} else if (data->arrays[i] != NULL) {
+	    g_variant_builder_add_value(&builder,
+					g_variant_builder_end(data->arrays[i]));
+	} else {
+	    g_variant_builder_add_value(
+		&builder,
+		g_variant_new_array(g_variant_type_element(field_type),
+				    NULL, 0));
+	}
+    }
+
+    return g_variant_ref_sink(g_variant_builder_end(&builder));
+}
+
+static void
+_fw_xml_parse_data_clear(FWXmlParseData *data)
+{
+    gint i;
+
+    for (i=0; i<data->n_fields; i++) {
+	g_free(data->strings[i]);
+	if (data->arrays[i] != NULL)
+	    g_variant_builder_unref(data->arrays[i]);
+    }
+    if (data->text != NULL)
+	g_string_free(data->text, TRUE);
+    if (data->rule != NULL)
+	g_string_free(data->rule, TRUE);
+}
+
+/**
+ * fw_xml_parse:
+ * @type: the type of the document
+ * @data: (type utf8): the XML document
+ * @length: length of @data or -1 if it is nul terminated
+ * @error: return location for a #GError
+ *
+ * Parses a firewalld XML document in one pass with the GMarkup stream
+ * parser into the settings tuple used by the config D-Bus interface.
+ *
+ * Returns: (transfer full) (allow-none) (type GVariant*)
+ */
+GVariant *
+fw_xml_parse(FWXmlType type,
+	     const gchar *data,
+	     gssize length,
+	     GError **error)
+{
+    GMarkupParseContext *context;
+    FWXmlParseData parse_data;
+    const GVariantType *field_type;
+    GVariant *settings = NULL;
+
+    g_return_val_if_fail(type < FW_XML_N_TYPES, NULL);
+
+    memset(&parse_data, 0, sizeof(parse_data));
+    parse_data.info = &fw_xml_types[type];
+    parse_data.text_field = -1;
+    parse_data.text = g_string_new(NULL);
+
+    field_type = g_variant_type_first(
+	G_VARIANT_TYPE(parse_data.info->signature));
+    while (field_type != NULL) {
+	parse_data.field_types[parse_data.n_fields++] = field_type;
+	field_type = g_variant_type_next(field_type);
+    }
+
+    context = g_markup_parse_context_new(&fw_xml_parser, 0,
+					 &parse_data, NULL);
+    if (g_markup_parse_context_parse(context, data, length, error) &&
+	g_markup_parse_context_end_parse(context, error))
+	settings = _fw_xml_parse_data_end(&parse_data);
+    g_markup_parse_context_free(context);
+
+    _fw_xml_parse_data_clear(&parse_data);
+
+    return settings;
+}
+
+/**
+ * fw_xml_parse_file:
+ * @type: the type of the document
+ * @filename: (type filename): file to parse
+ * @error: return location for a #GError
+ *
+ * Returns: (transfer full) (allow-none) (type GVariant*)
+ */
+GVariant *
+fw_xml_parse_file(FWXmlType type,
+		  const gchar *filename,
+		  GError **error)
+{
+    GMappedFile *file;
+    GVariant *settings;
+
+    file = g_mapped_file_new(filename, FALSE, error);
+    if (file == NULL)
+	return NULL;
+
+    settings = fw_xml_parse(type, g_mapped_file_get_contents(file),
+			    g_mapped_file_get_length(file), error);
+    g_mapped_file_unref(file);
+
+    if (settings == NULL && error != NULL && *error != NULL)
+	g_prefix_error(error, "%s: ", filename);
+
+    return settings;
+}
+
+/****************************************************************************/
+/* writer */
+
+/* Appends a self-closing element, attributes are given as NULL terminated
+ * name, value pairs. Attributes with NULL or empty values are omitted. */
+static void
+_fw_xml_append_element(GString *xml,
+		       const gchar *indent,
+		       const gchar *name,
+		       gboolean close,
+		       ...)
+{
+    const gchar *attr, *value;
+    va_list args;
+
+    g_string_append_printf(xml, "%s<%s", indent, name);
+
+    va_start(args, close);
+    while ((attr = va_arg(args, const gchar *)) != NULL) {
+	gchar *escaped;
+
+	value = va_arg(args, const gchar *);
+	if (value == NULL || value[0] == '\0')
+	    continue;
+	escaped = g_markup_escape_text(value, -1);
+	g_string_append_printf(xml, " %s=\"%s\"", attr, escaped);
+	g_free(escaped);
+    }
+    va_end(args);
+
+    g_string_append(xml, close ? "/>\n" : ">\n");
+}
+
+static void
+_fw_xml_append_text_element(GString *xml,
+			    const gchar *name,
+			    const gchar *text)
+{
+    gchar *escaped;
+
+    if (text == NULL || text[0] == '\0')
+	return;
+
+    escaped = g_markup_escape_text(text, -1);
+    g_string_append_printf(xml, "  <%s>%s</%s>\n", name, escaped, name);
+    g_free(escaped);
+}
+
+static void
+_fw_xml_append_str_list(GString *xml,
+			GVariant *settings,
+			gint field,
+			const gchar *element,
+			const gchar *attr)
+{
+    GVariant *list;
+    GVariantIter iter;
+    const gchar *str;
+
+    if (field < 0)
+	return;
+
+    list = g_variant_get_child_value(settings, field);
+    g_variant_iter_init(&iter, list);
+    while (g_variant_iter_loop(&iter, "&s", &str))
+	_fw_xml_append_element(xml, "  ", element, TRUE, attr, str, NULL);
+    g_variant_unref(list);
+}
+
+static void
+_fw_xml_append_port_list(GString *xml,
+			 GVariant *settings,
+			 gint field,
+			 const gchar *element)
+{
+    GVariant *list;
+    GVariantIter iter;
+    const gchar *port, *protocol;
+
+    if (field < 0)
+	return;
+
+    list = g_variant_get_child_value(settings, field);
+    g_variant_iter_init(&iter, list);
+    while (g_variant_iter_loop(&iter, "(&s&s)", &port, &protocol))
+	_fw_xml_append_element(xml, "  ", element, TRUE,
+			       "port", port, "protocol", protocol, NULL);
+    g_variant_unref(list);
+}
+
+static gboolean
+_fw_xml_is_mac(const gchar *str)
+{
+    gint i;
+
+    if (strlen(str) != 17)
+	return FALSE;
+    for (i=0; i<17; i++) {
+	if ((i % 3) == 2) {
+	    if (str[i] != ':' && str[i] != '-')
+		return FALSE;
+	} else if (!g_ascii_isxdigit(str[i]))
+	    return FALSE;
+    }
+    return TRUE;
+}
+
+static void
+_fw_xml_append_sources(GString *xml,
+		       GVariant *settings,
+		       gint field)
+{
+    GVariant *list;
+    GVariantIter iter;
+    const gchar *source;
+
+    list = g_variant_get_child_value(settings, field);
+    g_variant_iter_init(&iter, list);
+    while (g_variant_iter_loop(&iter, "&s", &source)) {
+	if (g_str_has_prefix(source, "ipset:"))
+	    _fw_xml_append_element(xml, "  ", "source", TRUE,
+				   "ipset", source + 6, NULL);
+	else if (_fw_xml_is_mac(source))
+	    _fw_xml_append_element(xml, "  ", "source", TRUE,
+				   "mac", source, NULL);
+	else
+	    _fw_xml_append_element(xml, "  ", "source", TRUE,
+				   "address", source, NULL);
+    }
+    g_variant_unref(list);
+}
+
+typedef struct {
+    gchar *name;
+    GString *attrs;
+    GString *limit;
+} FWXmlRuleElement;
+
+static void
+_fw_xml_rule_element_free(gpointer data)
+{
+    FWXmlRuleElement *element = data;
+
+    g_free(element->name);
+    g_string_free(element->attrs, TRUE);
+    if (element->limit != NULL)
+	g_string_free(element->limit, TRUE);
+    g_free(element);
+}
+
+/* Converts a rich rule string into the <rule> element. The rich rule
+ * language is a flat list of element names followed by their key="value"
+ * attributes, "NOT" inverts source and destination, and "limit" belongs to
+ * the preceding log, audit or action element. */
+static void
+_fw_xml_append_rich_rule(GString *xml,
+			 const gchar *rule)
+{
+    GPtrArray *elements;
+    FWXmlRuleElement *element = NULL;
+    const gchar *p = rule;
+    guint i;
+
+    elements = g_ptr_array_new_with_free_func(_fw_xml_rule_element_free);
+
+    while (*p != '\0') {
+	const gchar *start, *end;
+	gchar *word;
+
+	while (g_ascii_isspace(*p))
+	    p++;
+	if (*p == '\0')
+	    break;
+
+	start = p;
+	while (*p != '\0' && *p != '=' && !g_ascii_isspace(*p))
+	    p++;
+	word = g_strndup(start, p - start);
+
+	if (*p == '=') {
+	    /* attribute of the current element */
+	    p++;
+	    if (*p == '"') {
+		start = ++p;
+		end = strchr(p, '"');
+		if (end == NULL)
+		    end = p + strlen(p);
+		p = (*end == '"') ? end + 1 : end;
+	    } else {
+		start = p;
+		while (*p != '\0' && !g_ascii_isspace(*p))
+		    p++;
+		end = p;
+	    }
+	    if (element != NULL) {
+		gchar *value = g_strndup(start, end - start);
+		gchar *escaped = g_markup_escape_text(value, -1);
+		GString *attrs = element->limit ? element->limit
+		    : element->attrs;
+
+		g_string_append_printf(attrs, " %s=\"%s\"", word, escaped);
+		g_free(escaped);
+		g_free(value);
+	    }
+	    g_free(word);
+	} else if (strcmp(word, "NOT") == 0) {
+	    if (element != NULL)
+		g_string_append(element->attrs, " invert=\"True\"");
+	    g_free(word);
+	} else if (strcmp(word, "limit") == 0 && element != NULL &&
+		   element->limit == NULL) {
+	    element->limit = g_string_new(NULL);
+	    g_free(word);
+	} else {
+	    element = g_new0(FWXmlRuleElement, 1);
+	    element->name = word;
+	    element->attrs = g_string_new(NULL);
+	    g_ptr_array_add(elements, element);
+	}
+    }
+
+    if (elements->len > 0 &&
+	strcmp(((FWXmlRuleElement *) elements->pdata[0])->name, "rule") == 0)
+    {
+	element = elements->pdata[0];
+	g_string_append_printf(xml, "  <rule%s>\n", element->attrs->str);
+	for (i=1; i<elements->len; i++) {
+	    element = elements->pdata[i];
+	    if (element->limit != NULL)
+		g_string_append_printf(xml,
+				       "    <%s%s>\n"
+				       "      <limit%s/>\n"
+				       "    </%s>\n",
+				       element->name, element->attrs->str,
+				       element->limit->str, element->name);
+	    else
+		g_string_append_printf(xml, "    <%s%s/>\n",
+				       element->name, element->attrs->str);
+	}
+	g_string_append(xml, "  </rule>\n");
+    }
+
+    g_ptr_array_free(elements, TRUE);
+}
+
+static void
+_fw_xml_append_rich_rules(GString *xml,
+			  GVariant *settings,
+			  gint field)
+{
+    GVariant *list;
+    GVariantIter iter;
+    const gchar *rule;
+
+    list = g_variant_get_child_value(settings, field);
+    g_variant_iter_init(&iter, list);
+    while (g_variant_iter_loop(&iter, "&s", &rule))
+	_fw_xml_append_rich_rule(xml, rule);
+    g_variant_unref(list);
+}
+
+static const gchar *
+_fw_xml_get_str(GVariant *settings, gint field)
+{
+    const gchar *str;
+
+    if (field < 0)
+	return NULL;
+    g_variant_get_child(settings, field, "&s", &str);
+    return str;
+}
+
+/**
+ * fw_xml_to_string:
+ * @type: the type of the settings
+ * @settings: (type GVariant*): settings tuple, optionally wrapped in a
+ *   tuple or a variant
+ *
+ * Returns: (transfer full) (allow-none) (type utf8)
+ */
+gchar *
+fw_xml_to_string(FWXmlType type,
+		 GVariant *settings)
+{
+    const FWXmlTypeInfo *info;
+    GString *xml;
+    GVariant *child;
+    GVariantIter iter;
+    const gchar *key, *value, *target;
+
+    g_return_val_if_fail(type < FW_XML_N_TYPES, NULL);
+    info = &fw_xml_types[type];
+
+    g_variant_ref_sink(settings);
+    while (g_variant_is_of_type(settings, G_VARIANT_TYPE_VARIANT) ||
+	   g_str_has_prefix(g_variant_get_type_string(settings), "(("))
+    {
+	child = g_variant_get_child_value(settings, 0);
+	if (g_variant_is_of_type(settings, G_VARIANT_TYPE_VARIANT)) {
+	    g_variant_unref(child);
+	    child = g_variant_get_variant(settings);
+	}
+	g_variant_unref(settings);
+	settings = child;
+    }
+
+    if (!g_variant_is_of_type(settings, G_VARIANT_TYPE(info->signature))) {
+	g_print(_("ERROR: Invalid %s settings: %s\n"), info->name,
+		g_variant_get_type_string(settings));
+	g_variant_unref(settings);
+	return NULL;
+    }
+
+    xml = g_string_new("<?xml version=\"1.0\" encoding=\"utf-8\"?>\n");
+
+    /* root element */
+    target = _fw_xml_get_str(settings, info->target);
+    if (target != NULL && strcmp(target, "default") == 0)
+	target = NULL;
+    _fw_xml_append_element(xml, "", info->name, FALSE,
+			   "type", _fw_xml_get_str(settings, info->ipset_type),
+			   "module", _fw_xml_get_str(settings, info->module),
+			   "family", _fw_xml_get_str(settings, info->family),
+			   "target", target,
+			   "version", _fw_xml_get_str(settings,
+						      FW_XML_VERSION),
+			   NULL);
+
+    _fw_xml_append_text_element(xml, "short",
+				_fw_xml_get_str(settings, FW_XML_SHORT));
+    _fw_xml_append_text_element(xml, "description",
+				_fw_xml_get_str(settings,
+						FW_XML_DESCRIPTION));
+
+    _fw_xml_append_str_list(xml, settings, info->interfaces,
+			    "interface", "name");
+    if (info->sources >= 0)
+	_fw_xml_append_sources(xml, settings, info->sources);
+    _fw_xml_append_str_list(xml, settings, info->services,
+			    "service", "name");
+    _fw_xml_append_port_list(xml, settings, info->ports, "port");
+    _fw_xml_append_str_list(xml, settings, info->protocols,
+			    "protocol", "value");
+    _fw_xml_append_str_list(xml, settings, info->icmp_blocks,
+			    "icmp-block", "name");
+    if (info->icmp_block_inversion >= 0) {
+	child = g_variant_get_child_value(settings,
+					  info->icmp_block_inversion);
+	if (g_variant_get_boolean(child))
+	    g_string_append(xml, "  <icmp-block-inversion/>\n");
+	g_variant_unref(child);
+    }
+    if (info->masquerade >= 0) {
+	child = g_variant_get_child_value(settings, info->masquerade);
+	if (g_variant_get_boolean(child))
+	    g_string_append(xml, "  <masquerade/>\n");
+	g_variant_unref(child);
+    }
+    if (info->forward_ports >= 0) {
+	const gchar *port, *protocol, *toport, *toaddr;
+
+	child = g_variant_get_child_value(settings, info->forward_ports);
+	g_variant_iter_init(&iter, child);
+	while (g_variant_iter_loop(&iter, "(&s&s&s&s)",
+				   &port, &protocol, &toport, &toaddr))
+	    _fw_xml_append_element(xml, "  ", "forward-port", TRUE,
+				   "port", port, "protocol", protocol,
+				   "to-port", toport, "to-addr", toaddr,
+				   NULL);
+	g_variant_unref(child);
+    }
+    _fw_xml_append_port_list(xml, settings, info->source_ports,
+			     "source-port");
+    _fw_xml_append_str_list(xml, settings, info->modules, "module", "name");
+    if (info->rules >= 0)
+	_fw_xml_append_rich_rules(xml, settings, info->rules);
+
+    if (info->destinations >= 0) {
+	const gchar *ipv4 = NULL, *ipv6 = NULL;
+
+	child = g_variant_get_child_value(settings, info->destinations);
+	g_variant_iter_init(&iter, child);
+	if (g_variant_is_of_type(child, G_VARIANT_TYPE("a{ss}"))) {
+	    while (g_variant_iter_next(&iter, "{&s&s}", &key, &value)) {
+		if (strcmp(key, "ipv4") == 0)
+		    ipv4 = value;
+		else if (strcmp(key, "ipv6") == 0)
+		    ipv6 = value;
+	    }
+	} else {
+	    while (g_variant_iter_next(&iter, "&s", &key)) {
+		if (strcmp(key, "ipv4") == 0)
+		    ipv4 = "yes";
+		else if (strcmp(key, "ipv6") == 0)
+		    ipv6 = "yes";
+	    }
+	}
+	if (ipv4 != NULL || ipv6 != NULL)
+	    _fw_xml_append_element(xml, "  ", "destination", TRUE,
+				   "ipv4", ipv4, "ipv6", ipv6, NULL);
+	g_variant_unref(child);
+    }
+
+    if (info->options >= 0) {
+	child = g_variant_get_child_value(settings, info->options);
+	g_variant_iter_init(&iter, child);
+	while (g_variant_iter_loop(&iter, "{&s&s}", &key, &value))
+	    _fw_xml_append_element(xml, "  ", "option", TRUE,
+				   "name", key, "value", value, NULL);
+	g_variant_unref(child);
+    }
+    if (info->entries >= 0) {
+	child = g_variant_get_child_value(settings, info->entries);
+	g_variant_iter_init(&iter, child);
+	while (g_variant_iter_loop(&iter, "&s", &value))
+	    _fw_xml_append_text_element(xml, "entry", value);
+	g_variant_unref(child);
+    }
+
+    g_string_append_printf(xml, "</%s>\n", info->name);
+
+    g_variant_unref(settings);
+
+    return g_string_free(xml, FALSE);
+}
+
+/**
+ * fw_xml_write_file:
+ * @type: the type of the settings
+ * @settings: (type GVariant*): settings tuple
+ * @filename: (type filename): target file
+ * @error: return location for a #GError
+ *
+ * Writes the settings as XML document. The document is written to a
+ * temporary file in the same directory and renamed to @filename, readers
+ * see either the old or the new document.
+ *
+ * Returns: TRUE on success
+ */
+gboolean
+fw_xml_write_file(FWXmlType type,
+		  GVariant *settings,
+		  const gchar *filename,
+		  GError **error)
+{
+    gchar *xml, *dirname;
+    gboolean ret;
+
+    xml = fw_xml_to_string(type, settings);
+    if (xml == NULL) {
+	g_set_error(error, G_MARKUP_ERROR, G_MARKUP_ERROR_INVALID_CONTENT,
+		    "Invalid %s settings", fw_xml_type_get_name(type));
+	return FALSE;
+    }
+
+    dirname = g_path_get_dirname(filename);
+    if (g_mkdir_with_parents(dirname, 0750) != 0) {
+	gint saved_errno = errno;
+
+	g_set_error(error, G_FILE_ERROR, g_file_error_from_errno(saved_errno),
+		    "Failed to create directory '%s': %s", dirname,
+		    g_strerror(saved_errno));
+	g_free(dirname);
+	g_free(xml);
+	return FALSE;
+    }
+    g_free(dirname);
+
+    /* g_file_set_contents writes a temporary file and renames it */
+    ret = g_file_set_contents(filename, xml, -1, error);
+    g_free(xml);
+
+    return ret;
+}
@@ -0,0 +1,55 @@
+/*
+ * Copyright (C) 2017 Red Hat, Inc.
+ *
+ * Authors:
+ * Thomas Woerner <twoerner@redhat.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __FW_XML_H__
+#define __FW_XML_H__
+
+#include <glib.h>
+
+/* settings signatures as used by the firewalld config D-Bus interface */
+#define FW_XML_ZONE_SIGNATURE     "(sssbsasa(ss)asba(ssss)asasasasa(ss)b)"
+#define FW_XML_SERVICE_SIGNATURE  "(sssa(ss)asa{ss}asa(ss))"
+#define FW_XML_IPSET_SIGNATURE    "(ssssa{ss}as)"
+#define FW_XML_ICMPTYPE_SIGNATURE "(sssas)"
+#define FW_XML_HELPER_SIGNATURE   "(sssssa(ss))"
+
+typedef enum {
+    FW_XML_ZONE,
+    FW_XML_SERVICE,
+    FW_XML_IPSET,
+    FW_XML_ICMPTYPE,
+    FW_XML_HELPER,
+    FW_XML_N_TYPES
+} FWXmlType;
+
+const gchar *fw_xml_type_get_name(FWXmlType type);
+const gchar *fw_xml_type_get_dir(FWXmlType type);
+const gchar *fw_xml_type_get_signature(FWXmlType type);
+
+GVariant *fw_xml_parse(FWXmlType type, const gchar *data, gssize length,
+		       GError **error);
+GVariant *fw_xml_parse_file(FWXmlType type, const gchar *filename,
+			    GError **error);
+
+gchar *fw_xml_to_string(FWXmlType type, GVariant *settings);
+gboolean fw_xml_write_file(FWXmlType type, GVariant *settings,
+			   const gchar *filename, GError **error);
+
+#endif /* __FW_XML_H__ */
@@ -20,6 +20,8 @@
 
 #include <string.h>
 #include "fw_zone.h"
+#include "fw_trace.h"
+#include "fw_accounting.h"
 #include "fw_functions.h"
 
 G_DEFINE_TYPE(FWZone, fw_zone, G_TYPE_OBJECT);
@@ -42,6 +44,8 @@ typedef struct {
     GList *protocols;         /* list of string */
     FWPortList *source_ports; /* list of FWPort */
     gboolean icmp_block_inversion; /* boolean */
+    FWFingerprint fingerprint;  /* cached structural hash */
+    gboolean fingerprint_valid;
 } FWZonePrivate;
 
 FWZone *
@@ -57,6 +61,7 @@ fw_zone_new_from_variant(GVariant *variant)
     GVariant *item;
     gchar *str;
     gboolean bool;
+    GList *strs;
 
     if (variant == NULL)
 	return obj;
@@ -67,25 +72,27 @@ fw_zone_new_from_variant(GVariant *variant)
        return obj;
     }
 
+    FW_TRACE_DECODE_START(variant);
+
     variant = g_variant_get_child_value(variant, 0);
 
     obj = fw_zone_new();
 
     /* 0: version */
     item = g_variant_get_child_value(variant, 0);
-    g_variant_get(item, "s", &str);
+    g_variant_get(item, "&s", &str);
     fw_zone_setVersion(obj, str);
     g_variant_unref(item);
 
     /* 1: short */
     item = g_variant_get_child_value(variant, 1);
-    g_variant_get(item, "s", &str);
+    g_variant_get(item, "&s", &str);
     fw_zone_setShort(obj, str);
     g_variant_unref(item);
 
     /* 2: description */
     item = g_variant_get_child_value(variant, 2);
-    g_variant_get(item, "s", &str);
+    g_variant_get(item, "&s", &str);
     fw_zone_setDescription(obj, str);
     g_variant_unref(item);
 
@@ -93,13 +100,15 @@ fw_zone_new_from_variant(GVariant *variant)
 
     /* 4: target */
     item = g_variant_get_child_value(variant, 4);
-    g_variant_get(item, "s", &str);
+    g_variant_get(item, "&s", &str);
     fw_zone_setTarget(obj, str);
     g_variant_unref(item);
 
     /* 5: services */
     item = g_variant_get_child_value(variant, 5);
-    fw_zone_setServices(obj, fw_str_list_new_from_variant(item));
+    strs = fw_str_list_new_from_variant(item);
+    fw_zone_setServices(obj, strs);
+    fw_str_list_free(strs);
     g_variant_unref(item);
 
     /* 6: ports */
@@ -109,7 +118,9 @@ fw_zone_new_from_variant(GVariant *variant)
 
     /* 7: icmp blocks */
     item = g_variant_get_child_value(variant, 7);
-    fw_zone_setIcmpBlocks(obj, fw_str_list_new_from_variant(item));
+    strs = fw_str_list_new_from_variant(item);
+    fw_zone_setIcmpBlocks(obj, strs);
+    fw_str_list_free(strs);
     g_variant_unref(item);
 
     /* 8: masquerade */
@@ -125,22 +136,30 @@ fw_zone_new_from_variant(GVariant *variant)
 
     /* 10: interfaces */
     item = g_variant_get_child_value(variant, 10);
-    fw_zone_setInterfaces(obj, fw_str_list_new_from_variant(item));
+    strs = fw_str_list_new_from_variant(item);
+    fw_zone_setInterfaces(obj, strs);
+    fw_str_list_free(strs);
     g_variant_unref(item);
 
     /* 11: sources */
     item = g_variant_get_child_value(variant, 11);
-    fw_zone_setSources(obj, fw_str_list_new_from_variant(item));
+    strs = fw_str_list_new_from_variant(item);
+    fw_zone_setSources(obj, strs);
+    fw_str_list_free(strs);
     g_variant_unref(item);
 
     /* 12: rich rules */
     item = g_variant_get_child_value(variant, 12);
-    fw_zone_setRichRules(obj, fw_str_list_new_from_variant(item));
+    strs = fw_str_list_new_from_variant(item);
+    fw_zone_setRichRules(obj, strs);
+    fw_str_list_free(strs);
     g_variant_unref(item);
 
     /* 13: protocols */
     item = g_variant_get_child_value(variant, 13);
-    fw_zone_setProtocols(obj, fw_str_list_new_from_variant(item));
+    strs = fw_str_list_new_from_variant(item);
+    fw_zone_setProtocols(obj, strs);
+    fw_str_list_free(strs);
     g_variant_unref(item);
 
     /* 14: source ports */
@@ -154,6 +173,9 @@ fw_zone_new_from_variant(GVariant *variant)
     fw_zone_setIcmpBlockInversion(obj, bool);
     g_variant_unref(item);
 
+    g_variant_unref(variant);
+
+    FW_TRACE_DECODE_DONE();
     return obj;
 }
 
@@ -232,6 +254,7 @@ fw_zone_init(FWZone *obj)
     priv->protocols = NULL;
     priv->source_ports = fw_port_list_new();
     priv->icmp_block_inversion = FALSE;
+    priv->fingerprint_valid = FALSE;
 }
 
 static void
@@ -250,11 +273,11 @@ fw_zone_finalize(GObject *obj)
     if (priv->services != NULL)
 	fw_str_list_free(priv->services);
     if (priv->ports != NULL)
-	fw_port_list_free(priv->ports);
+	g_object_unref(priv->ports);
     if (priv->icmp_blocks != NULL)
 	fw_str_list_free(priv->icmp_blocks);
     if (priv->forward_ports != NULL)
-	fw_forward_port_list_free(priv->forward_ports);
+	g_object_unref(priv->forward_ports);
     if (priv->interfaces != NULL)
 	fw_str_list_free(priv->interfaces);
     if (priv->sources != NULL)
@@ -264,7 +287,7 @@ fw_zone_finalize(GObject *obj)
     if (priv->protocols != NULL)
 	fw_str_list_free(priv->protocols);
     if (priv->source_ports != NULL)
-	fw_port_list_free(priv->source_ports);
+	g_object_unref(priv->source_ports);
 
     G_OBJECT_CLASS(fw_zone_parent_class)->finalize(obj);
 }
@@ -277,6 +300,7 @@ fw_zone_class_init(FWZoneClass *fw_zone_class)
     obj_class->finalize = fw_zone_finalize;
 
     g_type_class_add_private(obj_class, sizeof(FWZonePrivate));
+    fw_accounting_register(obj_class, sizeof(FWZonePrivate));
 }
 
 /* methods */
@@ -351,6 +375,7 @@ fw_zone_setVersion(FWZone *obj,
     if (priv->version != NULL)
 	g_free(priv->version);
     priv->version = g_strdup(version);
+    priv->fingerprint_valid = FALSE;
 }
 
 /**
@@ -375,6 +400,7 @@ fw_zone_setShort(FWZone *obj,
     if (priv->short_description != NULL)
 	g_free(priv->short_description);
     priv->short_description = g_strdup(short_description);
+    priv->fingerprint_valid = FALSE;
 }
 
 /**
@@ -399,6 +425,7 @@ fw_zone_setDescription(FWZone *obj,
     if (priv->description != NULL)
 	g_free(priv->description);
     priv->description = g_strdup(description);
+    priv->fingerprint_valid = FALSE;
 }
 
 /**
@@ -423,6 +450,7 @@ fw_zone_setTarget(FWZone *obj,
     if (priv->target != NULL)
 	g_free(priv->target);
     priv->target = g_strdup(target);
+    priv->fingerprint_valid = FALSE;
 }
 
 /**
@@ -453,6 +481,7 @@ fw_zone_setServices(FWZone *obj,
     if (priv->services != NULL)
 	fw_str_list_free(priv->services);
     priv->services = fw_str_list_copy(services);
+    priv->fingerprint_valid = FALSE;
 }
 
 void
@@ -462,6 +491,7 @@ fw_zone_addService(FWZone *obj,
     FWZonePrivate *priv = FW_ZONE_GET_PRIVATE(obj);
 
     priv->services = fw_str_list_append(priv->services, service);
+    priv->fingerprint_valid = FALSE;
 }
 
 void
@@ -471,6 +501,7 @@ fw_zone_removeService(FWZone *obj,
     FWZonePrivate *priv = FW_ZONE_GET_PRIVATE(obj);
 
     priv->services = fw_str_list_remove(priv->services, service);
+    priv->fingerprint_valid = FALSE;
 }
 
 gboolean
@@ -498,7 +529,8 @@ fw_zone_getPorts(FWZone *obj)
 /**
  * fw_zone_setPorts:
  * @obj: (type FWZone*): a FWZone instance
- * @ports: (type FWPortList*)
+ * @ports: (type FWPortList*) (transfer full): the list is owned by @obj
+ *   afterwards
  */
 void
 fw_zone_setPorts(FWZone *obj,
@@ -506,9 +538,13 @@ fw_zone_setPorts(FWZone *obj,
 {
     FWZonePrivate *priv = FW_ZONE_GET_PRIVATE(obj);
 
+    if (ports == priv->ports)
+	return;
+
     if (priv->ports != NULL)
-	fw_port_list_free(priv->ports);
+	g_object_unref(priv->ports);
     priv->ports = ports;
+    priv->fingerprint_valid = FALSE;
 }
 
 void
@@ -520,6 +556,7 @@ fw_zone_addPort(FWZone *obj,
     FWPort *item = fw_port_new(port, protocol);
 
     fw_port_list_add(priv->ports, item);
+    priv->fingerprint_valid = FALSE;
 }
 
 void
@@ -531,6 +568,7 @@ fw_zone_removePort(FWZone *obj,
     FWPort *item = fw_port_new(port, protocol);
 
     fw_port_list_remove(priv->ports, item);
+    priv->fingerprint_valid = FALSE;
 }
 
 gboolean
@@ -551,6 +589,7 @@ fw_zone_add_port(FWZone *obj,
     FWZonePrivate *priv = FW_ZONE_GET_PRIVATE(obj);
 
     fw_port_list_add(priv->ports, port);
+    priv->fingerprint_valid = FALSE;
 }
 
 void
@@ -560,6 +599,7 @@ fw_zone_remove_port(FWZone *obj,
     FWZonePrivate *priv = FW_ZONE_GET_PRIVATE(obj);
 
     fw_port_list_remove(priv->ports, port);
+    priv->fingerprint_valid = FALSE;
 }
 
 gboolean
@@ -598,6 +638,7 @@ fw_zone_setProtocols(FWZone *obj,
     if (priv->protocols != NULL)
 	fw_str_list_free(priv->protocols);
     priv->protocols = fw_str_list_copy(protocols);
+    priv->fingerprint_valid = FALSE;
 }
 
 void
@@ -607,6 +648,7 @@ fw_zone_addProtocol(FWZone *obj,
     FWZonePrivate *priv = FW_ZONE_GET_PRIVATE(obj);
 
     priv->protocols = fw_str_list_append(priv->protocols, protocol);
+    priv->fingerprint_valid = FALSE;
 }
 
 void
@@ -616,6 +658,7 @@ fw_zone_removeProtocol(FWZone *obj,
     FWZonePrivate *priv = FW_ZONE_GET_PRIVATE(obj);
 
     priv->protocols = fw_str_list_remove(priv->protocols, protocol);
+    priv->fingerprint_valid = FALSE;
 }
 
 gboolean
@@ -643,7 +686,8 @@ fw_zone_getSourcePorts(FWZone *obj)
 /**
  * fw_zone_setSourcePorts:
  * @obj: (type FWZone*): a FWZone instance
- * @ports: (type FWPortList*)
+ * @ports: (type FWPortList*) (transfer full): the list is owned by @obj
+ *   afterwards
  */
 void
 fw_zone_setSourcePorts(FWZone *obj,
@@ -651,9 +695,13 @@ fw_zone_setSourcePorts(FWZone *obj,
 {
     FWZonePrivate *priv = FW_ZONE_GET_PRIVATE(obj);
 
+    if (ports == priv->source_ports)
+	return;
+
     if (priv->source_ports != NULL)
-	fw_port_list_free(priv->source_ports);
+	g_object_unref(priv->source_ports);
     priv->source_ports = ports;
+    priv->fingerprint_valid = FALSE;
 }
 
 void
@@ -665,6 +713,7 @@ fw_zone_addSourcePort(FWZone *obj,
     FWPort *item = fw_port_new(port, protocol);
 
     fw_port_list_add(priv->source_ports, item);
+    priv->fingerprint_valid = FALSE;
 }
 
 void
@@ -676,6 +725,7 @@ fw_zone_removeSourcePort(FWZone *obj,
     FWPort *item = fw_port_new(port, protocol);
 
     fw_port_list_remove(priv->source_ports, item);
+    priv->fingerprint_valid = FALSE;
 }
 
 gboolean
@@ -696,6 +746,7 @@ fw_zone_add_source_port(FWZone *obj,
     FWZonePrivate *priv = FW_ZONE_GET_PRIVATE(obj);
 
     fw_port_list_add(priv->source_ports, port);
+    priv->fingerprint_valid = FALSE;
 }
 
 void
@@ -705,6 +756,7 @@ fw_zone_remove_source_port(FWZone *obj,
     FWZonePrivate *priv = FW_ZONE_GET_PRIVATE(obj);
 
     fw_port_list_remove(priv->source_ports, port);
+    priv->fingerprint_valid = FALSE;
 }
 
 gboolean
@@ -744,6 +796,7 @@ fw_zone_setIcmpBlocks(FWZone *obj,
     if (priv->icmp_blocks != NULL)
 	fw_str_list_free(priv->icmp_blocks);
     priv->icmp_blocks = fw_str_list_copy(icmp_types);
+    priv->fingerprint_valid = FALSE;
 }
 
 void
@@ -753,6 +806,7 @@ fw_zone_addIcmpBlock(FWZone *obj,
     FWZonePrivate *priv = FW_ZONE_GET_PRIVATE(obj);
 
     priv->icmp_blocks = fw_str_list_append(priv->icmp_blocks, icmp_type);
+    priv->fingerprint_valid = FALSE;
 }
 
 void
@@ -762,6 +816,7 @@ fw_zone_removeIcmpBlock(FWZone *obj,
     FWZonePrivate *priv = FW_ZONE_GET_PRIVATE(obj);
 
     priv->icmp_blocks = fw_str_list_remove(priv->icmp_blocks, icmp_type);
+    priv->fingerprint_valid = FALSE;
 }
 
 gboolean
@@ -787,6 +842,7 @@ fw_zone_setMasquerade(FWZone *obj,
     FWZonePrivate *priv = FW_ZONE_GET_PRIVATE(obj);
 
     priv->masquerade = masquerade;
+    priv->fingerprint_valid = FALSE;
 }
 
 void
@@ -795,6 +851,7 @@ fw_zone_addMasquerade(FWZone *obj)
     FWZonePrivate *priv = FW_ZONE_GET_PRIVATE(obj);
 
     priv->masquerade = TRUE;
+    priv->fingerprint_valid = FALSE;
 }
 
 void
@@ -803,6 +860,7 @@ fw_zone_removeMasquerade(FWZone *obj)
     FWZonePrivate *priv = FW_ZONE_GET_PRIVATE(obj);
 
     priv->masquerade = FALSE;
+    priv->fingerprint_valid = FALSE;
 }
 
 gboolean
@@ -838,8 +896,9 @@ fw_zone_setForwardPorts(FWZone *obj,
     FWZonePrivate *priv = FW_ZONE_GET_PRIVATE(obj);
 
     if (priv->forward_ports != NULL)
-	fw_forward_port_list_free(priv->forward_ports);
+	g_object_unref(priv->forward_ports);
     priv->forward_ports = forward_ports;
+    priv->fingerprint_valid = FALSE;
 }
 
 void
@@ -853,6 +912,7 @@ fw_zone_addForwardPort(FWZone *obj,
     FWForwardPort *item = fw_forward_port_new(port, protocol, toport, toaddr);
 
     fw_forward_port_list_add(priv->forward_ports, item);
+    priv->fingerprint_valid = FALSE;
 }
 
 void
@@ -866,6 +926,8 @@ fw_zone_removeForwardPort(FWZone *obj,
     FWForwardPort *item = fw_forward_port_new(port, protocol, toport, toaddr);
 
     fw_forward_port_list_remove(priv->forward_ports, item);
+    g_object_unref(item);
+    priv->fingerprint_valid = FALSE;
 }
 
 gboolean
@@ -877,8 +939,12 @@ fw_zone_queryForwardPort(FWZone *obj,
 {
     FWZonePrivate *priv = FW_ZONE_GET_PRIVATE(obj);
     FWForwardPort *item = fw_forward_port_new(port, protocol, toport, toaddr);
+    gboolean ret;
 
-    return fw_forward_port_list_query(priv->forward_ports, item);
+    ret = fw_forward_port_list_query(priv->forward_ports, item);
+    g_object_unref(item);
+
+    return ret;
 }
 
 void
@@ -888,6 +954,7 @@ fw_zone_add_forward_port(FWZone *obj,
     FWZonePrivate *priv = FW_ZONE_GET_PRIVATE(obj);
 
     fw_forward_port_list_add(priv->forward_ports, forward_port);
+    priv->fingerprint_valid = FALSE;
 }
 
 void
@@ -897,6 +964,7 @@ fw_zone_remove_forward_port(FWZone *obj,
     FWZonePrivate *priv = FW_ZONE_GET_PRIVATE(obj);
 
     fw_forward_port_list_remove(priv->forward_ports, forward_port);
+    priv->fingerprint_valid = FALSE;
 }
 
 gboolean
@@ -936,6 +1004,7 @@ fw_zone_setInterfaces(FWZone *obj,
     if (priv->interfaces != NULL)
 	fw_str_list_free(priv->interfaces);
     priv->interfaces = fw_str_list_copy(interfaces);
+    priv->fingerprint_valid = FALSE;
 }
 
 void
@@ -945,6 +1014,7 @@ fw_zone_addInterface(FWZone *obj,
     FWZonePrivate *priv = FW_ZONE_GET_PRIVATE(obj);
 
     priv->interfaces = fw_str_list_append(priv->interfaces, interface);
+    priv->fingerprint_valid = FALSE;
 }
 
 void
@@ -954,6 +1024,7 @@ fw_zone_removeInterface(FWZone *obj,
     FWZonePrivate *priv = FW_ZONE_GET_PRIVATE(obj);
 
     priv->interfaces = fw_str_list_remove(priv->interfaces, interface);
+    priv->fingerprint_valid = FALSE;
 }
 
 gboolean
@@ -992,6 +1063,7 @@ fw_zone_setSources(FWZone *obj,
     if (priv->sources != NULL)
 	fw_str_list_free(priv->sources);
     priv->sources = fw_str_list_copy(sources);
+    priv->fingerprint_valid = FALSE;
 }
 
 void
@@ -1001,6 +1073,7 @@ fw_zone_addSource(FWZone *obj,
     FWZonePrivate *priv = FW_ZONE_GET_PRIVATE(obj);
 
     priv->sources = fw_str_list_append(priv->sources, source);
+    priv->fingerprint_valid = FALSE;
 }
 
 void
@@ -1010,6 +1083,7 @@ fw_zone_removeSource(FWZone *obj,
     FWZonePrivate *priv = FW_ZONE_GET_PRIVATE(obj);
 
     priv->sources = fw_str_list_remove(priv->sources, source);
+    priv->fingerprint_valid = FALSE;
 }
 
 gboolean
@@ -1048,6 +1122,7 @@ fw_zone_setRichRules(FWZone *obj,
     if (priv->rich_rules != NULL)
 	fw_str_list_free(priv->rich_rules);
     priv->rich_rules = fw_str_list_copy(rich_rules);
+    priv->fingerprint_valid = FALSE;
 }
 
 void
@@ -1057,6 +1132,7 @@ fw_zone_addRichRule(FWZone *obj,
     FWZonePrivate *priv = FW_ZONE_GET_PRIVATE(obj);
 
     priv->rich_rules = fw_str_list_append(priv->rich_rules, rich_rule);
+    priv->fingerprint_valid = FALSE;
 }
 
 void
@@ -1066,6 +1142,7 @@ fw_zone_removeRichRule(FWZone *obj,
     FWZonePrivate *priv = FW_ZONE_GET_PRIVATE(obj);
 
     priv->rich_rules = fw_str_list_remove(priv->rich_rules, rich_rule);
+    priv->fingerprint_valid = FALSE;
 }
 
 gboolean
@@ -1092,6 +1169,7 @@ fw_zone_setIcmpBlockInversion(FWZone *obj,
     FWZonePrivate *priv = FW_ZONE_GET_PRIVATE(obj);
 
     priv->icmp_block_inversion = icmp_block_inversion;
+    priv->fingerprint_valid = FALSE;
 }
 
 void
@@ -1100,6 +1178,7 @@ fw_zone_addIcmpBlockInversion(FWZone *obj)
     FWZonePrivate *priv = FW_ZONE_GET_PRIVATE(obj);
 
     priv->icmp_block_inversion = TRUE;
+    priv->fingerprint_valid = FALSE;
 }
 
 void
@@ -1108,6 +1187,7 @@ fw_zone_removeIcmpBlockInversion(FWZone *obj)
     FWZonePrivate *priv = FW_ZONE_GET_PRIVATE(obj);
 
     priv->icmp_block_inversion = FALSE;
+    priv->fingerprint_valid = FALSE;
 }
 
 gboolean
@@ -1117,3 +1197,54 @@ fw_zone_queryIcmpBlockInversion(FWZone *obj)
 
     return priv->icmp_block_inversion;
 }
+
+/* fingerprint */
+
+/**
+ * fw_zone_getFingerprint:
+ * @obj: (type FWZone*): a FWZone instance
+ *
+ * Order insensitive structural hash of the settings, cached until the
+ * next change through the FWZone methods.
+ *
+ * Returns: (transfer none): fingerprint of the settings
+ */
+const FWFingerprint *
+fw_zone_getFingerprint(FWZone *obj)
+{
+    FWZonePrivate *priv = FW_ZONE_GET_PRIVATE(obj);
+    GVariant *variant;
+
+    if (!priv->fingerprint_valid) {
+	variant = g_variant_ref_sink(fw_zone_to_variant(obj));
+	fw_fingerprint_variant(variant, &priv->fingerprint);
+	g_variant_unref(variant);
+	priv->fingerprint_valid = TRUE;
+    }
+
+    return &priv->fingerprint;
+}
+
+/**
+ * fw_zone_equal:
+ * @a: (type FWZone*): a FWZone instance
+ * @b: (type FWZone*): a FWZone instance
+ *
+ * Returns: TRUE if the settings are equal up to the order of list items
+ */
+gboolean
+fw_zone_equal(FWZone *a,
+	      FWZone *b)
+{
+    if (a == b)
+	return TRUE;
+
+    return fw_fingerprint_equal(fw_zone_getFingerprint(a),
+				fw_zone_getFingerprint(b));
+}
+
+guint
+fw_zone_hash(FWZone *obj)
+{
+    return fw_fingerprint_hash(fw_zone_getFingerprint(obj));
+}
@@ -24,6 +24,7 @@
 #include <glib.h>
 #include <glib-object.h>
 #include "firewall.h"
+#include "fw_fingerprint.h"
 #include "fw_functions.h"
 #include "fw_port.h"
 #include "fw_port_list.h"
@@ -144,4 +145,8 @@ void fw_zone_addIcmpBlockInversion(FWZone *obj);
 void fw_zone_removeIcmpBlockInversion(FWZone *obj);
 gboolean fw_zone_queryIcmpBlockInversion(FWZone *obj);
 
+const FWFingerprint *fw_zone_getFingerprint(FWZone *obj);
+gboolean fw_zone_equal(FWZone *a, FWZone *b);
+guint fw_zone_hash(FWZone *obj);
+
 #endif /* __FW_ZONE_H__ */
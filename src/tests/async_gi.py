@@ -0,0 +1,151 @@
+#!/usr/bin/python3
+#
+# Copyright (C) 2017 Red Hat, Inc.
+#
+# Authors:
+# Thomas Woerner <twoerner@redhat.com>
+#
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 2 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+
+# Adds and removes ports from many asyncio tasks: with the sync API right
+# in the event loop, with the sync API in a thread pool and with the async
+# API on one client. Prints the calls per second and the longest stall of
+# the event loop.
+#
+# With PyGObject 3.50 or later the event loop runs on the GLib main context
+# and the async methods are awaited directly, older versions get the
+# replies from a GLib main loop in a thread.
+#
+# Run against mock_firewalld with: make bench-async
+#
+# Usage: async_gi.py [-n CALLS] [-c TASKS] [-t THREADS] [-z ZONE]
+
+import sys
+import time
+import getopt
+import asyncio
+import threading
+import concurrent.futures
+
+import gi
+gi.require_version('firewall', '0.1')
+from gi.repository import GLib
+from gi.repository import firewall
+
+try:
+    from gi.events import GLibEventLoopPolicy
+except ImportError:
+    GLibEventLoopPolicy = None
+
+calls = 2000
+tasks = 64
+threads = 8
+zone = ""
+
+opts, args = getopt.getopt(sys.argv[1:], "n:c:t:z:")
+for (opt, val) in opts:
+    if opt == "-n":
+        calls = int(val)
+    elif opt == "-c":
+        tasks = int(val)
+    elif opt == "-t":
+        threads = int(val)
+    elif opt == "-z":
+        zone = val
+
+if GLibEventLoopPolicy is not None:
+    asyncio.set_event_loop_policy(GLibEventLoopPolicy())
+else:
+    threading.Thread(target=GLib.MainLoop().run, daemon=True).start()
+
+fw = firewall.Client()
+
+async def call_async(method, *args):
+    if GLibEventLoopPolicy is not None:
+        return await getattr(fw, method + "Async")(*args)
+
+    # start the call in the GLib thread, the replies are dispatched there
+    loop = asyncio.get_running_loop()
+    future = loop.create_future()
+
+    def done(client, result):
+        try:
+            value = getattr(client, method + "Finish")(result)
+        except GLib.Error as e:
+            loop.call_soon_threadsafe(future.set_exception, e)
+        else:
+            loop.call_soon_threadsafe(future.set_result, value)
+
+    def start():
+        getattr(fw, method + "Async")(*args, None, done)
+        return False
+
+    GLib.idle_add(start)
+    return await future
+
+# the sync calls keep the error of the last call in the client, one client
+# per thread
+local = threading.local()
+
+def call_sync(method, *args):
+    if not hasattr(local, "fw"):
+        local.fw = firewall.Client()
+    return getattr(local.fw, method)(*args)
+
+async def call_blocking(method, *args):
+    return getattr(fw, method)(*args)
+
+async def call_pool(method, *args):
+    loop = asyncio.get_running_loop()
+    return await loop.run_in_executor(pool, call_sync, method, *args)
+
+async def ticker(stall):
+    # longest time the loop has not been able to run this
+    while True:
+        start = time.monotonic()
+        await asyncio.sleep(0.001)
+        stall[0] = max(stall[0], time.monotonic() - start - 0.001)
+
+async def run(name, call, base):
+    limit = asyncio.Semaphore(tasks)
+    stall = [ 0.0 ]
+
+    async def one(port):
+        async with limit:
+            await call("addPort", zone, port, "tcp", 0)
+            await call("removePort", zone, port, "tcp")
+
+    tick = asyncio.ensure_future(ticker(stall))
+    await asyncio.sleep(0.01)
+    start = time.monotonic()
+    await asyncio.gather(*[ one("%d" % (base + i)) for i in range(calls) ])
+    duration = time.monotonic() - start
+    tick.cancel()
+
+    print("%-10s %8.0f calls/s %10.1f ms longest stall" %
+          (name, 2 * calls / duration, stall[0] * 1000))
+
+async def main():
+    print("%d ports, %d tasks, %d threads, %s\n" %
+          (calls, tasks, threads,
+           "native await" if GLibEventLoopPolicy is not None else
+           "GLib main loop thread"))
+    await run("blocking", call_blocking, 30000)
+    await run("threads", call_pool, 30000)
+    await run("async", call_async, 30000)
+
+pool = concurrent.futures.ThreadPoolExecutor(max_workers=threads)
+asyncio.run(main())
+pool.shutdown()
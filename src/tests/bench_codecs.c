@@ -0,0 +1,517 @@
+/*
+ * Copyright (C) 2017 Red Hat, Inc.
+ *
+ * Authors:
+ * Thomas Woerner <twoerner@redhat.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Microbenchmarks for the variant decoders, encoders and print functions.
+ * The replies are generated, no firewalld is needed.
+ *
+ * Usage: bench_codecs [-n SIZE] [-b BASELINE] [-w BASELINE]
+ *
+ * Allocations are counted by wrapping the glibc allocator, the counts are
+ * deterministic and a growth against the baseline is reported as failure.
+ * Times are only reported.
+ */
+
+#include <glib.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "fw_zone.h"
+#include "fw_ipset.h"
+#include "fw_port_list.h"
+#include "fw_active_zone.h"
+#include "fw_direct_rule.h"
+#include "fw_functions.h"
+
+/* time spent per benchmark in microseconds */
+#define BENCH_TIME       200000
+/* slower than the baseline by more than this is marked */
+#define BENCH_TOLERANCE  25
+
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t nmemb, size_t size);
+extern void *__libc_realloc(void *ptr, size_t size);
+
+static guint64 allocations = 0;
+
+void *
+malloc(size_t size)
+{
+    allocations++;
+    return __libc_malloc(size);
+}
+
+void *
+calloc(size_t nmemb, size_t size)
+{
+    allocations++;
+    return __libc_calloc(nmemb, size);
+}
+
+void *
+realloc(void *ptr, size_t size)
+{
+    if (ptr == NULL)
+	allocations++;
+    return __libc_realloc(ptr, size);
+}
+
+typedef struct {
+    const gchar *name;
+    void (*func)(gpointer data);
+    gpointer data;
+} Bench;
+
+typedef struct {
+    gchar *name;
+    gdouble ns;
+    gdouble allocs;
+} BenchResult;
+
+static guint size = 100;
+
+static GVariant *zone_variant;
+static FWZone *zone;
+static GVariant *ipset_variant;
+static FWIPSet *ipset;
+static GVariant *ports_variant;
+static FWPortList *ports;
+static GVariant *active_zones_variant;
+static GVariant *rules_variant;
+
+/* replies */
+
+static GVariant *
+bench_zone_variant(guint n)
+{
+    GVariantBuilder services, ports, icmp_blocks, forward_ports;
+    GVariantBuilder interfaces, sources, rules, protocols, source_ports;
+    guint i;
+
+    g_variant_builder_init(&services, G_VARIANT_TYPE("as"));
+    g_variant_builder_init(&ports, G_VARIANT_TYPE("a(ss)"));
+    g_variant_builder_init(&icmp_blocks, G_VARIANT_TYPE("as"));
+    g_variant_builder_init(&forward_ports, G_VARIANT_TYPE("a(ssss)"));
+    g_variant_builder_init(&interfaces, G_VARIANT_TYPE("as"));
+    g_variant_builder_init(&sources, G_VARIANT_TYPE("as"));
+    g_variant_builder_init(&rules, G_VARIANT_TYPE("as"));
+    g_variant_builder_init(&protocols, G_VARIANT_TYPE("as"));
+    g_variant_builder_init(&source_ports, G_VARIANT_TYPE("a(ss)"));
+
+    for (i=0; i<n; i++) {
+	gchar *str;
+
+	str = g_strdup_printf("service%u", i);
+	g_variant_builder_add(&services, "s", str);
+	g_free(str);
+
+	str = g_strdup_printf("%u", 1024 + i);
+	g_variant_builder_add(&ports, "(ss)", str, (i % 2) ? "udp" : "tcp");
+	g_variant_builder_add(&forward_ports, "(ssss)", str, "tcp", "80",
+			      "10.0.0.1");
+	g_variant_builder_add(&source_ports, "(ss)", str, "tcp");
+	g_free(str);
+
+	str = g_strdup_printf("eth%u", i);
+	g_variant_builder_add(&interfaces, "s", str);
+	g_free(str);
+
+	str = g_strdup_printf("10.%u.%u.0/24", i / 256, i % 256);
+	g_variant_builder_add(&sources, "s", str);
+	g_free(str);
+
+	str = g_strdup_printf("rule family=\"ipv4\" source address=\"10.%u.%u.1\" "
+			      "service name=\"ssh\" accept", i / 256, i % 256);
+	g_variant_builder_add(&rules, "s", str);
+	g_free(str);
+    }
+    g_variant_builder_add(&icmp_blocks, "s", "echo-request");
+    g_variant_builder_add(&protocols, "s", "gre");
+
+    return g_variant_ref_sink(g_variant_new(
+	"((sssbsasa(ss)asba(ssss)asasasasa(ss)b))",
+	"1", "bench", "benchmark zone", FALSE, "default", &services, &ports,
+	&icmp_blocks, TRUE, &forward_ports, &interfaces, &sources, &rules,
+	&protocols, &source_ports, FALSE));
+}
+
+static GVariant *
+bench_ipset_variant(guint n)
+{
+    GVariantBuilder options, entries;
+    guint i;
+
+    g_variant_builder_init(&options, G_VARIANT_TYPE("a{ss}"));
+    g_variant_builder_init(&entries, G_VARIANT_TYPE("as"));
+
+    g_variant_builder_add(&options, "{ss}", "family", "inet");
+    g_variant_builder_add(&options, "{ss}", "maxelem", "65536");
+    for (i=0; i<n; i++) {
+	gchar *str = g_strdup_printf("10.%u.%u.%u", i / 65536,
+				     (i / 256) % 256, i % 256);
+
+	g_variant_builder_add(&entries, "s", str);
+	g_free(str);
+    }
+
+    return g_variant_ref_sink(g_variant_new("((ssssa{ss}as))", "1", "bench",
+					    "benchmark ipset", "hash:ip",
+					    &options, &entries));
+}
+
+static GVariant *
+bench_ports_variant(guint n)
+{
+    GVariantBuilder builder;
+    guint i;
+
+    g_variant_builder_init(&builder, G_VARIANT_TYPE("a(ss)"));
+    for (i=0; i<n; i++) {
+	gchar *str = g_strdup_printf("%u", 1024 + i);
+
+	g_variant_builder_add(&builder, "(ss)", str, (i % 2) ? "udp" : "tcp");
+	g_free(str);
+    }
+
+    return g_variant_ref_sink(g_variant_builder_end(&builder));
+}
+
+static GVariant *
+bench_active_zones_variant(guint n)
+{
+    GVariantBuilder zones;
+    guint i, j;
+
+    g_variant_builder_init(&zones, G_VARIANT_TYPE("a{sa{sas}}"));
+    for (i=0; i<n; i++) {
+	GVariantBuilder interfaces, sources;
+	gchar *str;
+
+	g_variant_builder_init(&interfaces, G_VARIANT_TYPE("as"));
+	g_variant_builder_init(&sources, G_VARIANT_TYPE("as"));
+	for (j=0; j<4; j++) {
+	    str = g_strdup_printf("eth%u.%u", i, j);
+	    g_variant_builder_add(&interfaces, "s", str);
+	    g_free(str);
+
+	    str = g_strdup_printf("10.%u.%u.0/24", i % 256, j);
+	    g_variant_builder_add(&sources, "s", str);
+	    g_free(str);
+	}
+
+	str = g_strdup_printf("zone%u", i);
+	g_variant_builder_open(&zones, G_VARIANT_TYPE("{sa{sas}}"));
+	g_variant_builder_add(&zones, "s", str);
+	g_variant_builder_open(&zones, G_VARIANT_TYPE("a{sas}"));
+	g_variant_builder_add(&zones, "{sas}", "interfaces", &interfaces);
+	g_variant_builder_add(&zones, "{sas}", "sources", &sources);
+	g_variant_builder_close(&zones);
+	g_variant_builder_close(&zones);
+	g_free(str);
+    }
+
+    return g_variant_ref_sink(g_variant_new("(a{sa{sas}})", &zones));
+}
+
+static GVariant *
+bench_rules_variant(guint n)
+{
+    GVariantBuilder rules;
+    guint i;
+
+    g_variant_builder_init(&rules, G_VARIANT_TYPE("a(sssias)"));
+    for (i=0; i<n; i++) {
+	GVariantBuilder args;
+	gchar *str = g_strdup_printf("%u", 1024 + i);
+
+	g_variant_builder_init(&args, G_VARIANT_TYPE("as"));
+	g_variant_builder_add(&args, "s", "-p");
+	g_variant_builder_add(&args, "s", "tcp");
+	g_variant_builder_add(&args, "s", "--dport");
+	g_variant_builder_add(&args, "s", str);
+	g_variant_builder_add(&args, "s", "-j");
+	g_variant_builder_add(&args, "s", "ACCEPT");
+	g_variant_builder_add(&rules, "(sssias)", "ipv4", "filter", "INPUT",
+			      (gint32) (i % 10), &args);
+	g_free(str);
+    }
+
+    return g_variant_ref_sink(g_variant_new("(a(sssias))", &rules));
+}
+
+/* benchmarks */
+
+static void
+bench_zone_new_from_variant(gpointer data)
+{
+    g_object_unref(fw_zone_new_from_variant(zone_variant));
+}
+
+static void
+bench_zone_to_variant(gpointer data)
+{
+    g_variant_unref(g_variant_ref_sink(fw_zone_to_variant(zone)));
+}
+
+static void
+bench_ipset_new_from_variant(gpointer data)
+{
+    g_object_unref(fw_ipset_new_from_variant(ipset_variant));
+}
+
+static void
+bench_port_list_new_from_variant(gpointer data)
+{
+    g_object_unref(fw_port_list_new_from_variant(ports_variant));
+}
+
+static void
+bench_active_zones(gpointer data)
+{
+    g_hash_table_destroy(
+	fw_active_zone_table_new_from_variant(active_zones_variant));
+}
+
+static void
+bench_all_rules(gpointer data)
+{
+    g_list_free_full(fw_direct_rule_list_new_from_variant(rules_variant),
+		     g_object_unref);
+}
+
+static void
+bench_zone_print(gpointer data)
+{
+    fw_zone_print_str(zone);
+}
+
+static void
+bench_ipset_print(gpointer data)
+{
+    fw_ipset_print_str(ipset);
+}
+
+static void
+bench_port_list_print(gpointer data)
+{
+    fw_port_list_print_str(ports);
+}
+
+static const Bench benchmarks[] = {
+    { "zone_new_from_variant", bench_zone_new_from_variant, NULL },
+    { "zone_to_variant", bench_zone_to_variant, NULL },
+    { "ipset_new_from_variant", bench_ipset_new_from_variant, NULL },
+    { "port_list_new_from_variant", bench_port_list_new_from_variant, NULL },
+    { "getActiveZones_decode", bench_active_zones, NULL },
+    { "getAllRules_decode", bench_all_rules, NULL },
+    { "zone_print_str", bench_zone_print, NULL },
+    { "ipset_print_str", bench_ipset_print, NULL },
+    { "port_list_print_str", bench_port_list_print, NULL },
+};
+
+static void
+bench_print_discard(const gchar *string)
+{
+}
+
+static void
+bench_run(const Bench *bench,
+	  BenchResult *result)
+{
+    guint64 iterations = 0, allocs;
+    gint64 start, elapsed;
+
+    /* warm up and count the allocations of a single run */
+    bench->func(bench->data);
+    allocs = allocations;
+    bench->func(bench->data);
+    allocs = allocations - allocs;
+
+    start = g_get_monotonic_time();
+    do {
+	bench->func(bench->data);
+	iterations++;
+	elapsed = g_get_monotonic_time() - start;
+    } while (elapsed < BENCH_TIME);
+
+    result->name = g_strdup(bench->name);
+    result->ns = (gdouble) elapsed * 1000 / iterations;
+    result->allocs = allocs;
+}
+
+/* Returns: name: BenchResult of the baseline file */
+static GHashTable *
+bench_load_baseline(const gchar *filename,
+		    guint *baseline_size)
+{
+    GHashTable *baseline;
+    gchar *contents, **lines;
+    guint i;
+
+    if (!g_file_get_contents(filename, &contents, NULL, NULL))
+	return NULL;
+
+    baseline = g_hash_table_new_full(g_str_hash, g_str_equal, NULL, g_free);
+    lines = g_strsplit(contents, "\n", -1);
+    for (i=0; lines[i] != NULL; i++) {
+	BenchResult *result;
+	gchar name[64];
+	gdouble ns, allocs;
+
+	if (sscanf(lines[i], "size %u", baseline_size) == 1)
+	    continue;
+	if (lines[i][0] == '#' ||
+	    sscanf(lines[i], "%63s %lf %lf", name, &ns, &allocs) != 3)
+	    continue;
+
+	result = g_new0(BenchResult, 1);
+	result->name = g_strdup(name);
+	result->ns = ns;
+	result->allocs = allocs;
+	g_hash_table_replace(baseline, result->name, result);
+    }
+    g_strfreev(lines);
+    g_free(contents);
+
+    return baseline;
+}
+
+static gboolean
+bench_save_baseline(const gchar *filename,
+		    BenchResult *results,
+		    guint n)
+{
+    GString *str = g_string_new("# name ns/op allocs/op\n");
+    gboolean ret;
+    guint i;
+
+    g_string_append_printf(str, "size %u\n", size);
+    for (i=0; i<n; i++)
+	g_string_append_printf(str, "%s %.0f %.0f\n", results[i].name,
+			       results[i].ns, results[i].allocs);
+
+    ret = g_file_set_contents(filename, str->str, str->len, NULL);
+    g_string_free(str, TRUE);
+
+    return ret;
+}
+
+int
+main(int argc, char **argv) {
+    const gchar *baseline_file = NULL, *write_file = NULL;
+    GHashTable *baseline = NULL;
+    GPrintFunc print_func;
+    BenchResult results[G_N_ELEMENTS(benchmarks)];
+    guint baseline_size = 0;
+    gint ret = 0;
+    guint i;
+
+    for (i=1; i<argc; i++) {
+	if (strcmp(argv[i], "-n") == 0 && i+1 < argc)
+	    size = atoi(argv[++i]);
+	else if (strcmp(argv[i], "-b") == 0 && i+1 < argc)
+	    baseline_file = argv[++i];
+	else if (strcmp(argv[i], "-w") == 0 && i+1 < argc)
+	    write_file = argv[++i];
+	else {
+	    g_printerr("Usage: %s [-n SIZE] [-b BASELINE] [-w BASELINE]\n",
+		       argv[0]);
+	    return 2;
+	}
+    }
+
+    if (baseline_file != NULL) {
+	baseline = bench_load_baseline(baseline_file, &baseline_size);
+	if (baseline == NULL)
+	    g_printerr("Baseline '%s' not found\n", baseline_file);
+	else if (baseline_size != size) {
+	    g_printerr("Baseline '%s' is for size %u, not %u\n",
+		       baseline_file, baseline_size, size);
+	    g_hash_table_destroy(baseline);
+	    baseline = NULL;
+	}
+    }
+
+    zone_variant = bench_zone_variant(size);
+    zone = fw_zone_new_from_variant(zone_variant);
+    ipset_variant = bench_ipset_variant(size * 10);
+    ipset = fw_ipset_new_from_variant(ipset_variant);
+    ports_variant = bench_ports_variant(size);
+    ports = fw_port_list_new_from_variant(ports_variant);
+    active_zones_variant = bench_active_zones_variant(size);
+    rules_variant = bench_rules_variant(size);
+
+    /* the print functions write with g_print */
+    print_func = g_set_print_handler(bench_print_discard);
+    for (i=0; i<G_N_ELEMENTS(benchmarks); i++)
+	bench_run(&benchmarks[i], &results[i]);
+    g_set_print_handler(print_func);
+
+    g_print("size %u\n", size);
+    g_print("%-28s %12s %10s", "benchmark", "ns/op", "allocs/op");
+    if (baseline != NULL)
+	g_print(" %9s %9s", "ns", "allocs");
+    g_print("\n");
+
+    for (i=0; i<G_N_ELEMENTS(benchmarks); i++) {
+	BenchResult *base = NULL;
+
+	g_print("%-28s %12.0f %10.0f", results[i].name, results[i].ns,
+		results[i].allocs);
+
+	if (baseline != NULL)
+	    base = g_hash_table_lookup(baseline, results[i].name);
+	if (base != NULL) {
+	    gdouble ns = (base->ns > 0) ?
+		(results[i].ns - base->ns) * 100 / base->ns : 0;
+
+	    g_print(" %+8.1f%% %+9.0f", ns, results[i].allocs - base->allocs);
+	    if (ns > BENCH_TOLERANCE)
+		g_print("  slower");
+	    if (results[i].allocs > base->allocs) {
+		g_print("  MORE ALLOCATIONS");
+		ret = 1;
+	    }
+	}
+	g_print("\n");
+    }
+
+    if (write_file != NULL && !bench_save_baseline(write_file, results,
+						   G_N_ELEMENTS(benchmarks)))
+    {
+	g_printerr("Writing baseline '%s' failed\n", write_file);
+	ret = 1;
+    }
+
+    for (i=0; i<G_N_ELEMENTS(benchmarks); i++)
+	g_free(results[i].name);
+    if (baseline != NULL)
+	g_hash_table_destroy(baseline);
+    g_variant_unref(rules_variant);
+    g_variant_unref(active_zones_variant);
+    g_object_unref(ports);
+    g_variant_unref(ports_variant);
+    g_object_unref(ipset);
+    g_variant_unref(ipset_variant);
+    g_object_unref(zone);
+    g_variant_unref(zone_variant);
+
+    return ret;
+}
@@ -0,0 +1,94 @@
+#!/usr/bin/python
+#
+# Copyright (C) 2017 Red Hat, Inc.
+#
+# Authors:
+# Thomas Woerner <twoerner@redhat.com>
+#
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 2 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+
+# Compares the GList collection getters with the Strv and Variant forms
+# as seen from python, on a zone filled with many services and ports.
+#
+# Run against mock_firewalld with: make bench-gi
+#
+# Usage: bench_gi.py [-n ENTRIES] [-r ROUNDS] [-z ZONE]
+
+import sys
+import time
+import getopt
+
+import gi
+gi.require_version('firewall', '0.1')
+from gi.repository import firewall
+
+entries = 2000
+rounds = 20
+zone = ""
+
+opts, args = getopt.getopt(sys.argv[1:], "n:r:z:")
+for (opt, val) in opts:
+    if opt == "-n":
+        entries = int(val)
+    elif opt == "-r":
+        rounds = int(val)
+    elif opt == "-z":
+        zone = val
+
+fw = firewall.Client()
+
+# fill the zone, entries that are already there are fine
+for i in range(entries):
+    fw.addService(zone, "service%d" % i, 0)
+    fw.addPort(zone, "%d" % (10000 + i), "tcp", 0)
+    fw.addRule("ipv4", "filter", "INPUT", 0,
+               [ "-p", "tcp", "--dport", "%d" % (10000 + i), "-j", "ACCEPT" ])
+
+def services_list():
+    return [ s for s in fw.getServices(zone) ]
+
+def services_strv():
+    return fw.getServicesStrv(zone)
+
+def ports_list():
+    return [ (p.getPort(), p.getProtocol()) for p in fw.getPorts(zone) ]
+
+def ports_strv():
+    return [ tuple(p.split("/", 1)) for p in fw.getPortsStrv(zone) ]
+
+def rules_list():
+    return [ (r.getIpv(), r.getTable(), r.getChain(), r.getPriority(),
+              r.getArgs()) for r in fw.getAllRules() ]
+
+def rules_variant():
+    return fw.getAllRulesVariant().unpack()
+
+def bench(name, func):
+    count = len(func())
+    start = time.time()
+    for i in range(rounds):
+        func()
+    usec = (time.time() - start) * 1000000 / rounds
+    print("%-16s %8d entries %12.0f us/call %8.2f us/entry" %
+          (name, count, usec, usec / max(count, 1)))
+    return usec
+
+print("%d rounds\n" % rounds)
+for (name, old, new) in [ ("services", services_list, services_strv),
+                          ("ports", ports_list, ports_strv),
+                          ("rules", rules_list, rules_variant) ]:
+    usec_old = bench(name + " list", old)
+    usec_new = bench(name + " bulk", new)
+    print("%-16s %8.1fx\n" % (name + " speedup", usec_old / max(usec_new, 1)))
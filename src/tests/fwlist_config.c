@@ -26,21 +26,89 @@
 #include "fw_port.h"
 #include "fw_port_list.h"
 #include "fw_functions.h"
+#include "fw_ndjson.h"
 
 #include "fw_zone.h"
 
+static int
+export_json(FWClient *fw, const gchar *filename)
+{
+    GFile *file;
+    GOutputStream *stream;
+    GError *error = NULL;
+    gboolean ok = FALSE;
+
+    if (filename == NULL || strcmp(filename, "-") == 0) {
+	file = g_file_new_for_path("/dev/stdout");
+	stream = G_OUTPUT_STREAM(g_file_append_to(file, G_FILE_CREATE_NONE,
+						  NULL, &error));
+    } else {
+	file = g_file_new_for_commandline_arg(filename);
+	stream = G_OUTPUT_STREAM(g_file_replace(file, NULL, FALSE,
+						G_FILE_CREATE_NONE,
+						NULL, &error));
+    }
+
+    if (stream != NULL) {
+	ok = fw_ndjson_export(fw, stream, &error);
+	if (!g_output_stream_close(stream, NULL, ok ? &error : NULL))
+	    ok = FALSE;
+	g_object_unref(stream);
+    }
+    if (!ok) {
+	g_printerr("ERROR: %s\n", error->message);
+	g_error_free(error);
+    }
+    g_object_unref(file);
+
+    return ok ? 0 : 1;
+}
+
+static int
+import_json(FWClient *fw, const gchar *filename)
+{
+    GFile *file;
+    GInputStream *stream;
+    GError *error = NULL;
+    gboolean ok = FALSE;
+
+    file = g_file_new_for_commandline_arg(filename);
+    stream = G_INPUT_STREAM(g_file_read(file, NULL, &error));
+    if (stream != NULL) {
+	ok = fw_ndjson_import(fw, stream, &error);
+	g_object_unref(stream);
+    }
+    if (!ok) {
+	g_printerr("ERROR: %s\n", error->message);
+	g_error_free(error);
+    }
+    g_object_unref(file);
+
+    return ok ? 0 : 1;
+}
+
 int
 main(int argc, char **argv) {
     FWClient *fw;
     FWConfig *fw_config;
     const gchar *default_zone;
-    GList *list;
-    gint i, j;
+    GList *list, *l, *k;
     GHashTable *hash;
     const char *name;
     /* const gchar *item, *item2, *zone; */
 
     fw = fw_client_new();
+
+    /* fwlist_config --json [FILE] | --import FILE */
+    if (argc > 1 && strcmp(argv[1], "--json") == 0)
+	return export_json(fw, (argc > 2) ? argv[2] : NULL);
+    if (argc > 2 && strcmp(argv[1], "--import") == 0)
+	return import_json(fw, argv[2]);
+    if (argc > 1) {
+	g_printerr("Usage: %s [--json [FILE] | --import FILE]\n", argv[0]);
+	return 2;
+    }
+
     fw_config = fw_client_config(fw);
 
     default_zone = fw_client_getDefaultZone(fw);
@@ -53,11 +121,11 @@ main(int argc, char **argv) {
 
     g_print("zones:\n\n");
     list = fw_config_getZoneNames(fw_config);
-    for (i=0; i<g_list_length(list); i++) {
+    for (l = list; l != NULL; l = l->next) {
 	FWConfigZone *config_zone;
 	FWZone *zone;
 	GList *interfaces, *sources, *rules;
-	name = g_list_nth_data(list, i);
+	name = l->data;
 	config_zone = fw_config_getZoneByName(fw_config, name);
 	zone = fw_config_zone_getSettings(config_zone);
 	interfaces = fw_zone_getInterfaces(zone);
@@ -114,10 +182,8 @@ main(int argc, char **argv) {
 
 	g_print("  rich-rules:\n");
 	rules = fw_zone_getRichRules(zone);
-	for (j=0; j<g_list_length(rules); j++) {
-	    char *str = g_list_nth_data(rules, j);
-	    g_print("\t%s\n", str);
-	}
+	for (k = rules; k != NULL; k = k->next)
+	    g_print("\t%s\n", (gchar *) k->data);
 
     	g_print("\n");
     }
@@ -127,12 +193,12 @@ main(int argc, char **argv) {
 
     g_print("services:\n\n");
     list = fw_config_getServiceNames(fw_config);
-    for (i=0; i<g_list_length(list); i++) {
+    for (l = list; l != NULL; l = l->next) {
 	FWConfigService *config_service;
 	FWService *service;
 	GList *keys;
 	GHashTable *destinations;
-	name = g_list_nth_data(list, i);
+	name = l->data;
 	config_service = fw_config_getServiceByName(fw_config, name);
 	service = fw_config_service_getSettings(config_service);
 
@@ -157,11 +223,12 @@ main(int argc, char **argv) {
 	g_print("  destinations: ");
 	destinations = fw_service_getDestinations(service);
 	keys = g_hash_table_get_keys(destinations);
-	for (j=0; j<g_list_length(keys); j++) {
-	    gchar *str = (gchar *) g_list_nth_data(keys, j);
-	    g_print("%s%s:%s", (j>0) ? ", " : "", str, 
+	for (k = keys; k != NULL; k = k->next) {
+	    gchar *str = (gchar *) k->data;
+	    g_print("%s%s:%s", (k != keys) ? ", " : "", str,
 		    (gchar *)g_hash_table_lookup(destinations, str));
 	}
+	g_list_free(keys);
 	g_print("\n");
 
 	g_print("\n");
@@ -172,10 +239,10 @@ main(int argc, char **argv) {
 
     g_print("icmptypes:\n\n");
     list = fw_config_getIcmpTypeNames(fw_config);
-    for (i=0; i<g_list_length(list); i++) {
+    for (l = list; l != NULL; l = l->next) {
 	FWConfigIcmpType *config_icmp;
 	FWIcmpType *icmp;
-	name = g_list_nth_data(list, i);
+	name = l->data;
 	config_icmp = fw_config_getIcmpTypeByName(fw_config, name);
 	icmp = fw_config_icmptype_getSettings(config_icmp);
 
@@ -193,12 +260,12 @@ main(int argc, char **argv) {
 
     g_print("ipsets:\n\n");
     list = fw_config_getIPSetNames(fw_config);
-    for (i=0; i<g_list_length(list); i++) {
+    for (l = list; l != NULL; l = l->next) {
 	FWConfigIPSet *config_ipset;
 	FWIPSet *ipset;
 	GList *keys;
 	GHashTable *options;
-	name = g_list_nth_data(list, i);
+	name = l->data;
 	config_ipset = fw_config_getIPSetByName(fw_config, name);
 	ipset = fw_config_ipset_getSettings(config_ipset);
 
@@ -209,11 +276,12 @@ main(int argc, char **argv) {
 	g_print("  options:");
 	options = fw_ipset_getOptions(ipset);
 	keys = g_hash_table_get_keys(options);
-	for (i=0; i<g_list_length(keys); i++) {
-	    gchar *str = (gchar *) g_list_nth_data(keys, i);
+	for (k = keys; k != NULL; k = k->next) {
+	    gchar *str = (gchar *) k->data;
 	    g_print(" %s=%s", str,
 		    (gchar *)g_hash_table_lookup(options, str));
 	}
+	g_list_free(keys);
 	g_print("\n");
 
 	g_print("  entries: ");
@@ -229,10 +297,10 @@ main(int argc, char **argv) {
 
     g_print("helpers:\n\n");
     list = fw_config_getHelperNames(fw_config);
-    for (i=0; i<g_list_length(list); i++) {
+    for (l = list; l != NULL; l = l->next) {
 	FWConfigHelper *config_helper;
 	FWHelper *helper;
-	name = g_list_nth_data(list, i);
+	name = l->data;
 	config_helper = fw_config_getHelperByName(fw_config, name);
 	helper = fw_config_helper_getSettings(config_helper);
 
@@ -0,0 +1,446 @@
+/*
+ * Copyright (C) 2017 Red Hat, Inc.
+ *
+ * Authors:
+ * Thomas Woerner <twoerner@redhat.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Open-loop load generator: calls are issued at a fixed arrival rate no
+ * matter how long earlier calls take, latency is measured from the time a
+ * call was due, not from the time it was sent.
+ *
+ * Usage: loadgen [-t THREADS] [-r RATE[,RATE...]] [-d SECONDS] [-i SECONDS]
+ *                [-w PERCENT] [-z ZONE] [-o CSV]
+ *
+ * Every thread calls firewalld with a client of its own, a client is not
+ * thread safe.
+ *
+ * Every rate of the sweep runs for -d seconds. Latency percentiles are
+ * printed every -i seconds and per rate, followed by a latency versus load
+ * curve. The mean latency is split into the CPU time of the calling thread
+ * (client), the service time reported by mock_firewalld (daemon) and the
+ * rest (bus, GDBus worker thread and queueing). Run it with loadgen.sh to
+ * get a private bus and mock_firewalld.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <glib.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "fw_client.h"
+#include "fw_histogram.h"
+
+/* rates are over the knee if p99 grows beyond this factor of the lowest */
+#define LOADGEN_KNEE_FACTOR  4
+/* or less than this percentage of the offered calls complete */
+#define LOADGEN_KNEE_ACHIEVED  95
+#define LOADGEN_SERVICES  8
+#define LOADGEN_PLOT_WIDTH  50
+
+typedef struct {
+    guint id;
+    FWClient *client;
+    GRand *rand;
+    guint services;             /* bitmask of added services */
+    GMutex lock;
+    FWHistogram *interval;      /* latencies of the current interval */
+    FWHistogram *step;          /* latencies of the current rate */
+    guint64 errors;
+    gint64 client_cpu;          /* nanoseconds */
+} LoadgenThread;
+
+typedef struct {
+    gdouble rate;
+    gdouble achieved;
+    gint64 p50, p90, p99, max;
+    gdouble mean;               /* all in microseconds */
+    gdouble client;
+    gdouble daemon;
+    guint64 errors;
+} LoadgenResult;
+
+static guint n_threads = 4;
+static guint duration = 10;
+static guint interval = 1;
+static guint write_percent = 20;
+static const gchar *zone = "public";
+
+static gdouble rate;
+static gint64 step_start;
+static gint64 step_end;
+
+static gint64
+loadgen_thread_cpu(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+
+    return (gint64) ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+/* Returns: FALSE if the call failed */
+static gboolean
+loadgen_call(LoadgenThread *thread,
+	     guint64 n)
+{
+    gboolean ret = TRUE;
+
+    if ((guint) g_rand_int_range(thread->rand, 0, 100) < write_percent) {
+	guint index = n % LOADGEN_SERVICES;
+	gchar *service = g_strdup_printf("loadgen-%u-%u", thread->id, index);
+
+	if (thread->services & (1 << index))
+	    ret = fw_client_removeService(thread->client, zone, service) != NULL;
+	else
+	    ret = fw_client_addService(thread->client, zone, service, 0) != NULL;
+	if (ret)
+	    thread->services ^= (1 << index);
+
+	g_free(service);
+    } else {
+	switch (n % 3) {
+	case 0:
+	    ret = fw_client_getDefaultZone(thread->client) != NULL;
+	    break;
+	case 1: {
+	    FWZone *settings = fw_client_getZoneSettings(thread->client, zone);
+
+	    ret = settings != NULL;
+	    if (settings != NULL)
+		g_object_unref(settings);
+	    break;
+	}
+	default: {
+	    GHashTable *active = fw_client_getActiveZones(thread->client);
+
+	    ret = active != NULL;
+	    if (active != NULL)
+		g_hash_table_destroy(active);
+	    break;
+	}
+	}
+    }
+
+    return ret;
+}
+
+static gpointer
+loadgen_thread(gpointer data)
+{
+    LoadgenThread *thread = data;
+    guint64 n;
+
+    /* calls of all threads interleave at the arrival rate */
+    for (n = 0; ; n++) {
+	gint64 due = step_start +
+	    (gint64) ((n * n_threads + thread->id) * 1000000.0 / rate);
+	gint64 now = g_get_monotonic_time();
+	gint64 cpu;
+	gboolean ok;
+
+	if (due >= step_end)
+	    break;
+	if (due > now)
+	    g_usleep(due - now);
+
+	cpu = loadgen_thread_cpu();
+	ok = loadgen_call(thread, n);
+	cpu = loadgen_thread_cpu() - cpu;
+	now = g_get_monotonic_time();
+
+	g_mutex_lock(&thread->lock);
+	fw_histogram_add(thread->interval, now - due);
+	fw_histogram_add(thread->step, now - due);
+	thread->client_cpu += cpu;
+	if (!ok)
+	    thread->errors++;
+	g_mutex_unlock(&thread->lock);
+    }
+
+    return NULL;
+}
+
+/* Returns: FALSE if the daemon is not mock_firewalld */
+static gboolean
+loadgen_daemon_stats(FWClient *client,
+		     guint64 *calls,
+		     guint64 *busy)
+{
+    GVariant *reply;
+
+    reply = g_dbus_connection_call_sync(fw_client_getConnection(client),
+					FW_DBUS_NAME, FW_DBUS_PATH,
+					FW_DBUS_INTERFACE, "mockGetStats",
+					NULL, G_VARIANT_TYPE("(tt)"),
+					G_DBUS_CALL_FLAGS_NONE, -1, NULL, NULL);
+    if (reply == NULL)
+	return FALSE;
+
+    g_variant_get(reply, "(tt)", calls, busy);
+    g_variant_unref(reply);
+
+    return TRUE;
+}
+
+static void
+loadgen_print_histogram(FWHistogram *histogram)
+{
+    g_print(" %8" G_GINT64_FORMAT " %8" G_GINT64_FORMAT " %8" G_GINT64_FORMAT
+	    " %8" G_GINT64_FORMAT,
+	    fw_histogram_getPercentile(histogram, 50),
+	    fw_histogram_getPercentile(histogram, 90),
+	    fw_histogram_getPercentile(histogram, 99),
+	    fw_histogram_getMax(histogram));
+}
+
+static void
+loadgen_run(LoadgenThread *threads,
+	    LoadgenResult *result)
+{
+    FWHistogram *total = fw_histogram_new();
+    FWHistogram *merged = fw_histogram_new();
+    GThread **workers = g_new(GThread *, n_threads);
+    guint64 calls = 0, busy = 0, calls_end, busy_end;
+    gboolean mock;
+    gint64 next, client_cpu = 0;
+    guint i;
+
+    mock = loadgen_daemon_stats(threads[0].client, &calls, &busy);
+
+    g_print("%10s %6s %10s %8s %8s %8s %8s %8s\n", "rate", "time",
+	    "calls/s", "p50", "p90", "p99", "max", "errors");
+
+    step_start = g_get_monotonic_time();
+    step_end = step_start + (gint64) duration * G_USEC_PER_SEC;
+    for (i=0; i<n_threads; i++)
+	workers[i] = g_thread_new("loadgen", loadgen_thread, &threads[i]);
+
+    for (next = step_start + interval * G_USEC_PER_SEC; next <= step_end;
+	 next += interval * G_USEC_PER_SEC)
+    {
+	guint64 errors = 0;
+
+	g_usleep(next - g_get_monotonic_time());
+
+	fw_histogram_reset(merged);
+	for (i=0; i<n_threads; i++) {
+	    g_mutex_lock(&threads[i].lock);
+	    fw_histogram_merge(merged, threads[i].interval);
+	    fw_histogram_reset(threads[i].interval);
+	    errors += threads[i].errors;
+	    g_mutex_unlock(&threads[i].lock);
+	}
+
+	g_print("%10.0f %5" G_GINT64_FORMAT "s %10.0f", rate,
+		(next - step_start) / G_USEC_PER_SEC,
+		(gdouble) fw_histogram_getCount(merged) / interval);
+	loadgen_print_histogram(merged);
+	g_print(" %8" G_GUINT64_FORMAT "\n", errors);
+    }
+
+    /* the calls due before the end may still be running */
+    for (i=0; i<n_threads; i++)
+	g_thread_join(workers[i]);
+
+    result->rate = rate;
+    result->errors = 0;
+    for (i=0; i<n_threads; i++) {
+	fw_histogram_merge(total, threads[i].step);
+	fw_histogram_reset(threads[i].step);
+	fw_histogram_reset(threads[i].interval);
+	result->errors += threads[i].errors;
+	threads[i].errors = 0;
+	client_cpu += threads[i].client_cpu;
+	threads[i].client_cpu = 0;
+    }
+
+    result->achieved = (gdouble) fw_histogram_getCount(total) * G_USEC_PER_SEC /
+	(g_get_monotonic_time() - step_start);
+    result->p50 = fw_histogram_getPercentile(total, 50);
+    result->p90 = fw_histogram_getPercentile(total, 90);
+    result->p99 = fw_histogram_getPercentile(total, 99);
+    result->max = fw_histogram_getMax(total);
+    result->mean = result->client = 0;
+    result->daemon = -1;
+    if (fw_histogram_getCount(total) > 0) {
+	result->mean = (gdouble) fw_histogram_getSum(total) /
+	    fw_histogram_getCount(total);
+	result->client = client_cpu / 1000.0 / fw_histogram_getCount(total);
+    }
+    if (mock && loadgen_daemon_stats(threads[0].client, &calls_end,
+				     &busy_end) && calls_end > calls + 1)
+	/* the stats call itself is part of the difference */
+	result->daemon = (gdouble) (busy_end - busy) / (calls_end - calls - 1);
+
+    g_free(workers);
+    g_object_unref(merged);
+    g_object_unref(total);
+}
+
+static void
+loadgen_report(LoadgenResult *results,
+	       guint n,
+	       const gchar *csv)
+{
+    GString *str = g_string_new("rate,achieved,p50,p90,p99,max,mean,client,"
+				"daemon,errors\n");
+    gint64 largest = 1;
+    gint knee = -1;
+    guint i;
+
+    g_print("\n%10s %10s %8s %8s %8s %8s %8s %8s %8s %8s\n", "rate",
+	    "achieved", "p50", "p90", "p99", "max", "mean", "client", "daemon",
+	    "bus");
+    for (i=0; i<n; i++) {
+	LoadgenResult *r = &results[i];
+
+	g_print("%10.0f %10.0f %8" G_GINT64_FORMAT " %8" G_GINT64_FORMAT
+		" %8" G_GINT64_FORMAT " %8" G_GINT64_FORMAT " %8.0f %8.1f",
+		r->rate, r->achieved, r->p50, r->p90, r->p99, r->max, r->mean,
+		r->client);
+	if (r->daemon >= 0)
+	    g_print(" %8.1f %8.1f\n", r->daemon,
+		    r->mean - r->client - r->daemon);
+	else
+	    g_print(" %8s %8.1f\n", "-", r->mean - r->client);
+
+	g_string_append_printf(str, "%.0f,%.1f,%" G_GINT64_FORMAT ",%"
+			       G_GINT64_FORMAT ",%" G_GINT64_FORMAT ",%"
+			       G_GINT64_FORMAT ",%.1f,%.1f,%.1f,%"
+			       G_GUINT64_FORMAT "\n", r->rate, r->achieved,
+			       r->p50, r->p90, r->p99, r->max, r->mean,
+			       r->client, r->daemon, r->errors);
+
+	largest = MAX(largest, r->p99);
+	if (knee < 0 && i > 0 &&
+	    (r->p99 > results[0].p99 * LOADGEN_KNEE_FACTOR ||
+	     r->achieved * 100 < r->rate * LOADGEN_KNEE_ACHIEVED))
+	    knee = i;
+    }
+
+    /* p99 over the offered rate, on a logarithmic scale */
+    g_print("\np99 latency (us, log scale) versus offered rate:\n");
+    for (i=0; i<n; i++) {
+	gint width = (gint) (LOADGEN_PLOT_WIDTH *
+			     g_bit_storage(MAX(results[i].p99, 1)) /
+			     g_bit_storage(largest));
+	gchar *bar = g_strnfill(MAX(width, 1), '#');
+
+	g_print("%10.0f | %-*s %" G_GINT64_FORMAT "%s\n", results[i].rate,
+		LOADGEN_PLOT_WIDTH, bar, results[i].p99,
+		((gint) i == knee) ? "  <- knee" : "");
+	g_free(bar);
+    }
+
+    if (knee >= 0) {
+	LoadgenResult *r = &results[knee];
+	gdouble bus = r->mean - r->client - MAX(r->daemon, 0);
+
+	g_print("\nknee at %.0f calls/s: ", r->rate);
+	if (r->daemon >= 0 && r->daemon >= r->client && r->daemon >= bus)
+	    g_print("daemon service time dominates\n");
+	else if (r->client >= bus)
+	    g_print("client overhead dominates\n");
+	else
+	    g_print("bus and queueing dominate\n");
+    } else
+	g_print("\nno knee in the measured range\n");
+
+    if (csv != NULL && !g_file_set_contents(csv, str->str, str->len, NULL))
+	g_printerr("Writing '%s' failed\n", csv);
+    g_string_free(str, TRUE);
+}
+
+int
+main(int argc, char **argv) {
+    const gchar *rates = "100", *csv = NULL;
+    LoadgenThread *threads;
+    LoadgenResult *results;
+    gchar **list;
+    guint i, n;
+
+    for (i=1; i<argc; i++) {
+	if (strcmp(argv[i], "-t") == 0 && i+1 < argc)
+	    n_threads = atoi(argv[++i]);
+	else if (strcmp(argv[i], "-r") == 0 && i+1 < argc)
+	    rates = argv[++i];
+	else if (strcmp(argv[i], "-d") == 0 && i+1 < argc)
+	    duration = atoi(argv[++i]);
+	else if (strcmp(argv[i], "-i") == 0 && i+1 < argc)
+	    interval = atoi(argv[++i]);
+	else if (strcmp(argv[i], "-w") == 0 && i+1 < argc)
+	    write_percent = atoi(argv[++i]);
+	else if (strcmp(argv[i], "-z") == 0 && i+1 < argc)
+	    zone = argv[++i];
+	else if (strcmp(argv[i], "-o") == 0 && i+1 < argc)
+	    csv = argv[++i];
+	else {
+	    g_printerr("Usage: %s [-t THREADS] [-r RATE[,RATE...]] "
+		       "[-d SECONDS] [-i SECONDS] [-w PERCENT] [-z ZONE] "
+		       "[-o CSV]\n", argv[0]);
+	    return 2;
+	}
+    }
+    n_threads = MAX(n_threads, 1);
+    duration = MAX(duration, 1);
+    interval = CLAMP(interval, 1, duration);
+    write_percent = MIN(write_percent, 100);
+
+    threads = g_new0(LoadgenThread, n_threads);
+    for (i=0; i<n_threads; i++) {
+	threads[i].id = i;
+	threads[i].client = fw_client_new();
+	if (!fw_client_isConnected(threads[i].client)) {
+	    g_printerr("Not connected to firewalld\n");
+	    return 1;
+	}
+	threads[i].rand = g_rand_new_with_seed(i);
+	g_mutex_init(&threads[i].lock);
+	threads[i].interval = fw_histogram_new();
+	threads[i].step = fw_histogram_new();
+    }
+
+    g_print("%u threads, %u%% writes, zone '%s'\n", n_threads,
+	    write_percent, zone);
+
+    list = g_strsplit(rates, ",", -1);
+    n = g_strv_length(list);
+    results = g_new0(LoadgenResult, n);
+    for (i=0; i<n; i++) {
+	rate = g_ascii_strtod(list[i], NULL);
+	rate = MAX(rate, 1);
+	loadgen_run(threads, &results[i]);
+    }
+    loadgen_report(results, n, csv);
+
+    g_free(results);
+    g_strfreev(list);
+    for (i=0; i<n_threads; i++) {
+	g_object_unref(threads[i].client);
+	g_rand_free(threads[i].rand);
+	g_mutex_clear(&threads[i].lock);
+	g_object_unref(threads[i].interval);
+	g_object_unref(threads[i].step);
+    }
+    g_free(threads);
+
+    return 0;
+}
@@ -0,0 +1,60 @@
+#!/bin/sh
+#
+# Copyright (C) 2017 Red Hat, Inc.
+#
+# Authors:
+# Thomas Woerner <twoerner@redhat.com>
+#
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 2 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+
+# Runs loadgen against mock_firewalld on a private bus.
+#
+# Usage: loadgen.sh [-D DELAY] [-p PROGRAM] [loadgen options]
+#
+# DELAY is the service time of mock_firewalld per call in microseconds.
+# PROGRAM is run instead of loadgen, with the remaining options.
+
+cd "$(dirname "$0")" || exit 1
+
+DELAY=0
+PROGRAM=./loadgen
+while [ $# -ge 2 ]; do
+    case "$1" in
+    -D) DELAY=$2 ;;
+    -p) PROGRAM=$2 ;;
+    *) break ;;
+    esac
+    shift 2
+done
+
+eval $(dbus-launch --sh-syntax) || exit 1
+DBUS_SYSTEM_BUS_ADDRESS=$DBUS_SESSION_BUS_ADDRESS
+export DBUS_SYSTEM_BUS_ADDRESS
+
+READY=$(mktemp)
+./mock_firewalld -d "$DELAY" > "$READY" &
+MOCK=$!
+for i in $(seq 50); do
+    grep -q ready "$READY" && break
+    sleep 0.1
+done
+
+"$PROGRAM" "$@"
+RC=$?
+
+kill $MOCK
+kill $DBUS_SESSION_BUS_PID
+rm -f "$READY"
+exit $RC
@@ -0,0 +1,492 @@
+/*
+ * Copyright (C) 2017 Red Hat, Inc.
+ *
+ * Authors:
+ * Thomas Woerner <twoerner@redhat.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Minimal firewalld stand-in for load tests: zones with services and
+ * ports, active zones and direct rules, all in memory. Like firewalld it
+ * handles one call at a time in the main loop.
+ *
+ * Usage: mock_firewalld [-d DELAY]
+ *
+ * DELAY is an additional service time per call in microseconds. The mock
+ * connects to the system bus, point DBUS_SYSTEM_BUS_ADDRESS to a private
+ * bus. The mockGetStats method returns the number of calls and the time
+ * spent handling them in microseconds.
+ */
+
+#include <glib.h>
+#include <gio/gio.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "firewall.h"
+#include "fw_zone.h"
+#include "fw_functions.h"
+
+#define MOCK_ERROR  "org.fedoraproject.FirewallD1.Exception"
+
+static const gchar introspection_xml[] =
+    "<node>"
+    "  <interface name='" FW_DBUS_INTERFACE "'>"
+    "    <method name='getDefaultZone'>"
+    "      <arg type='s' direction='out'/>"
+    "    </method>"
+    "    <method name='getZoneSettings'>"
+    "      <arg type='s' direction='in'/>"
+    "      <arg type='(sssbsasa(ss)asba(ssss)asasasasa(ss)b)' direction='out'/>"
+    "    </method>"
+    "    <method name='mockGetStats'>"
+    "      <arg type='t' direction='out'/>"
+    "      <arg type='t' direction='out'/>"
+    "    </method>"
+    "    <property name='version' type='s' access='read'/>"
+    "    <property name='state' type='s' access='read'/>"
+    "  </interface>"
+    "  <interface name='" FW_DBUS_INTERFACE_ZONE "'>"
+    "    <method name='getZones'>"
+    "      <arg type='as' direction='out'/>"
+    "    </method>"
+    "    <method name='getActiveZones'>"
+    "      <arg type='a{sa{sas}}' direction='out'/>"
+    "    </method>"
+    "    <method name='getServices'>"
+    "      <arg type='s' direction='in'/>"
+    "      <arg type='as' direction='out'/>"
+    "    </method>"
+    "    <method name='getPorts'>"
+    "      <arg type='s' direction='in'/>"
+    "      <arg type='aas' direction='out'/>"
+    "    </method>"
+    "    <method name='addService'>"
+    "      <arg type='s' direction='in'/>"
+    "      <arg type='s' direction='in'/>"
+    "      <arg type='i' direction='in'/>"
+    "      <arg type='s' direction='out'/>"
+    "    </method>"
+    "    <method name='removeService'>"
+    "      <arg type='s' direction='in'/>"
+    "      <arg type='s' direction='in'/>"
+    "      <arg type='s' direction='out'/>"
+    "    </method>"
+    "    <method name='queryService'>"
+    "      <arg type='s' direction='in'/>"
+    "      <arg type='s' direction='in'/>"
+    "      <arg type='b' direction='out'/>"
+    "    </method>"
+    "    <method name='addPort'>"
+    "      <arg type='s' direction='in'/>"
+    "      <arg type='s' direction='in'/>"
+    "      <arg type='s' direction='in'/>"
+    "      <arg type='i' direction='in'/>"
+    "      <arg type='s' direction='out'/>"
+    "    </method>"
+    "    <method name='removePort'>"
+    "      <arg type='s' direction='in'/>"
+    "      <arg type='s' direction='in'/>"
+    "      <arg type='s' direction='in'/>"
+    "      <arg type='s' direction='out'/>"
+    "    </method>"
+    "    <method name='queryPort'>"
+    "      <arg type='s' direction='in'/>"
+    "      <arg type='s' direction='in'/>"
+    "      <arg type='s' direction='in'/>"
+    "      <arg type='b' direction='out'/>"
+    "    </method>"
+    "  </interface>"
+    "  <interface name='" FW_DBUS_INTERFACE_DIRECT "'>"
+    "    <method name='getAllRules'>"
+    "      <arg type='a(sssias)' direction='out'/>"
+    "    </method>"
+    "    <method name='addRule'>"
+    "      <arg type='s' direction='in'/>"
+    "      <arg type='s' direction='in'/>"
+    "      <arg type='s' direction='in'/>"
+    "      <arg type='i' direction='in'/>"
+    "      <arg type='as' direction='in'/>"
+    "    </method>"
+    "    <method name='removeRule'>"
+    "      <arg type='s' direction='in'/>"
+    "      <arg type='s' direction='in'/>"
+    "      <arg type='s' direction='in'/>"
+    "      <arg type='i' direction='in'/>"
+    "      <arg type='as' direction='in'/>"
+    "    </method>"
+    "    <method name='queryRule'>"
+    "      <arg type='s' direction='in'/>"
+    "      <arg type='s' direction='in'/>"
+    "      <arg type='s' direction='in'/>"
+    "      <arg type='i' direction='in'/>"
+    "      <arg type='as' direction='in'/>"
+    "      <arg type='b' direction='out'/>"
+    "    </method>"
+    "  </interface>"
+    "</node>";
+
+static GHashTable *zones;       /* name: FWZone */
+static gchar *default_zone;
+static GPtrArray *rules;        /* GVariant (sssias) */
+static gulong delay = 0;
+static guint64 calls = 0;
+static guint64 busy = 0;
+
+static void
+mock_add_zone(const gchar *name,
+	      const gchar *interface,
+	      const gchar *source)
+{
+    FWZone *zone = fw_zone_new();
+
+    fw_zone_setShort(zone, (gchar *) name);
+    fw_zone_addService(zone, "ssh");
+    if (interface != NULL)
+	fw_zone_addInterface(zone, (gchar *) interface);
+    if (source != NULL)
+	fw_zone_addSource(zone, (gchar *) source);
+
+    g_hash_table_insert(zones, g_strdup(name), zone);
+}
+
+/* Returns: index of rule in rules or -1 */
+static gint
+mock_find_rule(GVariant *rule)
+{
+    guint i;
+
+    for (i=0; i<rules->len; i++)
+	if (g_variant_equal(g_ptr_array_index(rules, i), rule))
+	    return i;
+
+    return -1;
+}
+
+static GVariant *
+mock_get_active_zones(void)
+{
+    GVariantBuilder builder;
+    GHashTableIter iter;
+    gpointer key, value;
+
+    g_variant_builder_init(&builder, G_VARIANT_TYPE("a{sa{sas}}"));
+    g_hash_table_iter_init(&iter, zones);
+    while (g_hash_table_iter_next(&iter, &key, &value)) {
+	GList *interfaces = fw_zone_getInterfaces(value);
+	GList *sources = fw_zone_getSources(value);
+	GVariantBuilder *interfaces_builder, *sources_builder;
+
+	if (interfaces == NULL && sources == NULL)
+	    continue;
+
+	interfaces_builder = fw_str_list_to_builder(interfaces);
+	sources_builder = fw_str_list_to_builder(sources);
+	g_variant_builder_open(&builder, G_VARIANT_TYPE("{sa{sas}}"));
+	g_variant_builder_add(&builder, "s", key);
+	g_variant_builder_open(&builder, G_VARIANT_TYPE("a{sas}"));
+	g_variant_builder_add(&builder, "{sas}", "interfaces", interfaces_builder);
+	g_variant_builder_add(&builder, "{sas}", "sources", sources_builder);
+	g_variant_builder_close(&builder);
+	g_variant_builder_close(&builder);
+	g_variant_builder_unref(interfaces_builder);
+	g_variant_builder_unref(sources_builder);
+    }
+
+    return g_variant_new("(a{sa{sas}})", &builder);
+}
+
+/*
+ * Returns: reply or NULL with error set to the firewalld error string
+ */
+static GVariant *
+mock_call(const gchar *interface_name,
+	  const gchar *method_name,
+	  GVariant *parameters,
+	  gchar **error)
+{
+    const gchar *name = NULL, *item = NULL, *protocol = NULL;
+    FWZone *zone = NULL;
+
+    if (strcmp(interface_name, FW_DBUS_INTERFACE_DIRECT) == 0) {
+	gint index = -1;
+
+	if (strcmp(method_name, "getAllRules") == 0) {
+	    GVariantBuilder builder;
+	    guint i;
+
+	    g_variant_builder_init(&builder, G_VARIANT_TYPE("a(sssias)"));
+	    for (i=0; i<rules->len; i++)
+		g_variant_builder_add_value(&builder,
+					    g_ptr_array_index(rules, i));
+	    return g_variant_new("(a(sssias))", &builder);
+	}
+
+	index = mock_find_rule(parameters);
+	if (strcmp(method_name, "queryRule") == 0)
+	    return g_variant_new("(b)", index >= 0);
+	if (strcmp(method_name, "addRule") == 0) {
+	    if (index >= 0) {
+		*error = g_strdup("ALREADY_ENABLED");
+		return NULL;
+	    }
+	    g_ptr_array_add(rules, g_variant_ref(parameters));
+	    return g_variant_new("()");
+	}
+	if (strcmp(method_name, "removeRule") == 0) {
+	    if (index < 0) {
+		*error = g_strdup("NOT_ENABLED");
+		return NULL;
+	    }
+	    g_ptr_array_remove_index(rules, index);
+	    return g_variant_new("()");
+	}
+    }
+
+    if (strcmp(method_name, "getDefaultZone") == 0)
+	return g_variant_new("(s)", default_zone);
+    if (strcmp(method_name, "mockGetStats") == 0)
+	return g_variant_new("(tt)", calls, busy);
+    if (strcmp(method_name, "getActiveZones") == 0)
+	return mock_get_active_zones();
+    if (strcmp(method_name, "getZones") == 0) {
+	GList *names = g_hash_table_get_keys(zones);
+	GVariantBuilder *builder = fw_str_list_to_builder(names);
+	GVariant *reply = g_variant_new("(as)", builder);
+
+	g_variant_builder_unref(builder);
+	g_list_free(names);
+	return reply;
+    }
+
+    /* the remaining methods start with the zone */
+    if (g_variant_n_children(parameters) > 0)
+	g_variant_get_child(parameters, 0, "&s", &name);
+    if (name != NULL) {
+	if (name[0] == '\0')
+	    name = default_zone;
+	zone = g_hash_table_lookup(zones, name);
+    }
+    if (zone == NULL) {
+	*error = g_strdup_printf("INVALID_ZONE: %s", name ? name : "");
+	return NULL;
+    }
+    if (g_variant_n_children(parameters) > 1)
+	g_variant_get_child(parameters, 1, "&s", &item);
+    if (g_str_has_suffix(method_name, "Port"))
+	g_variant_get_child(parameters, 2, "&s", &protocol);
+
+    if (strcmp(method_name, "getZoneSettings") == 0)
+	return g_variant_new_tuple((GVariant *[]) {
+		fw_zone_to_variant(zone) }, 1);
+
+    if (strcmp(method_name, "getServices") == 0) {
+	GVariantBuilder *builder =
+	    fw_str_list_to_builder(fw_zone_getServices(zone));
+	GVariant *reply = g_variant_new("(as)", builder);
+
+	g_variant_builder_unref(builder);
+	return reply;
+    }
+    if (strcmp(method_name, "getPorts") == 0) {
+	GVariantBuilder builder;
+	GList *ports;
+
+	g_variant_builder_init(&builder, G_VARIANT_TYPE("aas"));
+	for (ports = fw_port_list_getPorts(fw_zone_getPorts(zone));
+	     ports != NULL; ports = ports->next)
+	{
+	    const gchar *port[] = { fw_port_getPort(ports->data),
+				    fw_port_getProtocol(ports->data) };
+
+	    g_variant_builder_add_value(&builder,
+					g_variant_new_strv(port, 2));
+	}
+	return g_variant_new("(aas)", &builder);
+    }
+
+    if (strcmp(method_name, "queryService") == 0)
+	return g_variant_new("(b)", fw_zone_queryService(zone, (gchar *) item));
+    if (strcmp(method_name, "queryPort") == 0)
+	return g_variant_new("(b)", fw_zone_queryPort(zone, (gchar *) item,
+						      (gchar *) protocol));
+
+    if (strcmp(method_name, "addService") == 0 ||
+	strcmp(method_name, "addPort") == 0)
+    {
+	gboolean enabled = (protocol == NULL) ?
+	    fw_zone_queryService(zone, (gchar *) item) :
+	    fw_zone_queryPort(zone, (gchar *) item, (gchar *) protocol);
+
+	if (enabled) {
+	    *error = g_strdup_printf("ALREADY_ENABLED: %s", item);
+	    return NULL;
+	}
+	if (protocol == NULL)
+	    fw_zone_addService(zone, (gchar *) item);
+	else
+	    fw_zone_addPort(zone, (gchar *) item, (gchar *) protocol);
+	return g_variant_new("(s)", name);
+    }
+
+    if (strcmp(method_name, "removeService") == 0 ||
+	strcmp(method_name, "removePort") == 0)
+    {
+	gboolean enabled = (protocol == NULL) ?
+	    fw_zone_queryService(zone, (gchar *) item) :
+	    fw_zone_queryPort(zone, (gchar *) item, (gchar *) protocol);
+
+	if (!enabled) {
+	    *error = g_strdup_printf("NOT_ENABLED: %s", item);
+	    return NULL;
+	}
+	if (protocol == NULL)
+	    fw_zone_removeService(zone, (gchar *) item);
+	else
+	    fw_zone_removePort(zone, (gchar *) item, (gchar *) protocol);
+	return g_variant_new("(s)", name);
+    }
+
+    *error = g_strdup_printf("UNKNOWN_METHOD: %s", method_name);
+    return NULL;
+}
+
+static void
+mock_method_call(GDBusConnection *connection,
+		 const gchar *sender,
+		 const gchar *object_path,
+		 const gchar *interface_name,
+		 const gchar *method_name,
+		 GVariant *parameters,
+		 GDBusMethodInvocation *invocation,
+		 gpointer user_data)
+{
+    gint64 start = g_get_monotonic_time();
+    gchar *error = NULL;
+    GVariant *reply;
+
+    /* service time of the daemon */
+    if (delay > 0)
+	g_usleep(delay);
+
+    reply = mock_call(interface_name, method_name, parameters, &error);
+    if (reply != NULL)
+	g_dbus_method_invocation_return_value(invocation, reply);
+    else {
+	g_dbus_method_invocation_return_dbus_error(invocation, MOCK_ERROR,
+						   error);
+	g_free(error);
+    }
+
+    calls++;
+    busy += g_get_monotonic_time() - start;
+}
+
+static GVariant *
+mock_get_property(GDBusConnection *connection,
+		  const gchar *sender,
+		  const gchar *object_path,
+		  const gchar *interface_name,
+		  const gchar *property_name,
+		  GError **error,
+		  gpointer user_data)
+{
+    if (strcmp(property_name, "version") == 0)
+	return g_variant_new_string("0.4.4.5");
+    if (strcmp(property_name, "state") == 0)
+	return g_variant_new_string("RUNNING");
+
+    return NULL;
+}
+
+static const GDBusInterfaceVTable mock_vtable = {
+    mock_method_call,
+    mock_get_property,
+    NULL,
+};
+
+static void
+mock_name_acquired(GDBusConnection *connection,
+		   const gchar *name,
+		   gpointer user_data)
+{
+    g_print("ready\n");
+}
+
+static void
+mock_name_lost(GDBusConnection *connection,
+	       const gchar *name,
+	       gpointer user_data)
+{
+    g_printerr("Could not acquire %s\n", name);
+    g_main_loop_quit(user_data);
+}
+
+int
+main(int argc, char **argv) {
+    GDBusConnection *connection;
+    GDBusNodeInfo *info;
+    GMainLoop *loop;
+    GError *error = NULL;
+    guint i;
+
+    for (i=1; i<argc; i++) {
+	if (strcmp(argv[i], "-d") == 0 && i+1 < argc)
+	    delay = strtoul(argv[++i], NULL, 10);
+	else {
+	    g_printerr("Usage: %s [-d DELAY]\n", argv[0]);
+	    return 2;
+	}
+    }
+
+    zones = g_hash_table_new_full(g_str_hash, g_str_equal, g_free,
+				  g_object_unref);
+    mock_add_zone("public", "eth0", NULL);
+    mock_add_zone("trusted", NULL, "10.0.0.0/8");
+    mock_add_zone("block", NULL, NULL);
+    mock_add_zone("dmz", "eth1", NULL);
+    default_zone = g_strdup("public");
+    rules = g_ptr_array_new_with_free_func((GDestroyNotify) g_variant_unref);
+
+    connection = g_bus_get_sync(G_BUS_TYPE_SYSTEM, NULL, &error);
+    if (connection == NULL) {
+	g_printerr("Failed to connect to system bus: %s\n", error->message);
+	g_error_free(error);
+	return 1;
+    }
+
+    info = g_dbus_node_info_new_for_xml(introspection_xml, NULL);
+    for (i=0; info->interfaces[i] != NULL; i++)
+	g_dbus_connection_register_object(connection, FW_DBUS_PATH,
+					  info->interfaces[i], &mock_vtable,
+					  NULL, NULL, NULL);
+
+    loop = g_main_loop_new(NULL, FALSE);
+    g_bus_own_name_on_connection(connection, FW_DBUS_NAME,
+				 G_BUS_NAME_OWNER_FLAGS_NONE,
+				 mock_name_acquired, mock_name_lost,
+				 loop, NULL);
+    g_main_loop_run(loop);
+
+    g_main_loop_unref(loop);
+    g_dbus_node_info_unref(info);
+    g_object_unref(connection);
+    g_ptr_array_free(rules, TRUE);
+    g_free(default_zone);
+    g_hash_table_destroy(zones);
+
+    return 0;
+}
@@ -0,0 +1,246 @@
+/*
+ * Copyright (C) 2017 Red Hat, Inc.
+ *
+ * Authors:
+ * Thomas Woerner <twoerner@redhat.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Soak test: polls firewalld in a loop like a long running agent and
+ * watches the live instances of the library types and the resident set
+ * size. After the warmup both have to stay flat, otherwise it exits 1.
+ *
+ * Usage: soak [-d SECONDS] [-r RATE] [-s SECONDS] [-W SECONDS] [-g KB]
+ *             [-z ZONE] [-o CSV]
+ *
+ * The defaults poll 24 hours at 50 cycles per second and sample every
+ * minute after a warmup of five minutes. A cycle reads the default zone,
+ * the zone settings, the active zones and the direct rules and adds,
+ * queries and removes a port in the settings. RSS may grow by -g KB over
+ * the first sample after the warmup to allow for allocator slack. Send
+ * SIGUSR1 for the accounting table. Run it with soak.sh to get a private
+ * bus and mock_firewalld.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <glib.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "fw_client.h"
+#include "fw_zone.h"
+#include "fw_port_list.h"
+#include "fw_accounting.h"
+
+static guint duration = 24 * 60 * 60;
+static guint rate = 50;
+static guint sample = 60;
+static guint warmup = 5 * 60;
+static guint growth = 2048;
+static const gchar *zone = "public";
+
+/* Returns: resident set size in KB, 0 if unknown */
+static guint64
+soak_rss(void)
+{
+    gchar *contents;
+    gchar **fields;
+    guint64 rss = 0;
+
+    if (!g_file_get_contents("/proc/self/statm", &contents, NULL, NULL))
+	return 0;
+
+    fields = g_strsplit(contents, " ", -1);
+    if (g_strv_length(fields) > 1)
+	rss = g_ascii_strtoull(fields[1], NULL, 10) * sysconf(_SC_PAGESIZE) /
+	    1024;
+    g_strfreev(fields);
+    g_free(contents);
+
+    return rss;
+}
+
+/* Returns: FALSE if a call failed */
+static gboolean
+soak_cycle(FWClient *client)
+{
+    FWZone *settings;
+    FWPortList *ports;
+    GHashTable *active;
+    GList *rules;
+    gboolean ret = TRUE;
+
+    if (fw_client_getDefaultZone(client) == NULL)
+	ret = FALSE;
+
+    settings = fw_client_getZoneSettings(client, zone);
+    if (settings != NULL) {
+	ports = fw_zone_getPorts(settings);
+	if (ports != NULL) {
+	    fw_port_list_addPort(ports, "4711", "tcp");
+	    if (!fw_port_list_queryPort(ports, "4711", "tcp"))
+		ret = FALSE;
+	    fw_port_list_removePort(ports, "4711", "tcp");
+	    if (fw_port_list_queryPort(ports, "4711", "tcp"))
+		ret = FALSE;
+	}
+	g_object_unref(settings);
+    } else
+	ret = FALSE;
+
+    active = fw_client_getActiveZones(client);
+    if (active != NULL)
+	g_hash_table_destroy(active);
+    else
+	ret = FALSE;
+
+    /* an empty rule list is NULL as well */
+    rules = fw_client_getAllRules(client);
+    g_list_free_full(rules, g_object_unref);
+
+    return ret;
+}
+
+int
+main(int argc, char **argv) {
+    const gchar *csv = NULL;
+    FWClient *client;
+    GString *str;
+    guint64 cycles = 0, errors = 0, rss, rss_base = 0;
+    gint instances, instances_base = -1;
+    gint64 start, next_cycle, next_sample;
+    guint i, failures = 0;
+
+    for (i=1; i<argc; i++) {
+	if (strcmp(argv[i], "-d") == 0 && i+1 < argc)
+	    duration = atoi(argv[++i]);
+	else if (strcmp(argv[i], "-r") == 0 && i+1 < argc)
+	    rate = atoi(argv[++i]);
+	else if (strcmp(argv[i], "-s") == 0 && i+1 < argc)
+	    sample = atoi(argv[++i]);
+	else if (strcmp(argv[i], "-W") == 0 && i+1 < argc)
+	    warmup = atoi(argv[++i]);
+	else if (strcmp(argv[i], "-g") == 0 && i+1 < argc)
+	    growth = atoi(argv[++i]);
+	else if (strcmp(argv[i], "-z") == 0 && i+1 < argc)
+	    zone = argv[++i];
+	else if (strcmp(argv[i], "-o") == 0 && i+1 < argc)
+	    csv = argv[++i];
+	else {
+	    g_printerr("Usage: %s [-d SECONDS] [-r RATE] [-s SECONDS] "
+		       "[-W SECONDS] [-g KB] [-z ZONE] [-o CSV]\n", argv[0]);
+	    return 2;
+	}
+    }
+    duration = MAX(duration, 1);
+    rate = MAX(rate, 1);
+    sample = CLAMP(sample, 1, duration);
+    warmup = MIN(warmup, duration - sample);
+
+    client = fw_client_new();
+    if (!fw_client_isConnected(client)) {
+	g_printerr("Not connected to firewalld\n");
+	return 1;
+    }
+    fw_accounting_installSignalHandler(SIGUSR1);
+
+    g_print("%u s at %u cycles/s, %u s warmup, zone '%s'\n", duration, rate,
+	    warmup, zone);
+    g_print("%8s %10s %8s %10s %12s %10s\n", "time", "cycles", "errors",
+	    "instances", "bytes", "rss KB");
+    str = g_string_new("time,cycles,errors,instances,bytes,rss\n");
+
+    start = g_get_monotonic_time();
+    next_cycle = start;
+    next_sample = start + (gint64) sample * G_USEC_PER_SEC;
+    while (next_sample <= start + (gint64) duration * G_USEC_PER_SEC) {
+	gint64 now = g_get_monotonic_time();
+	guint elapsed;
+
+	if (now < next_sample) {
+	    if (next_cycle > now)
+		g_usleep(MIN(next_cycle, next_sample) - now);
+	    if (g_get_monotonic_time() >= next_cycle) {
+		if (!soak_cycle(client))
+		    errors++;
+		cycles++;
+		next_cycle += G_USEC_PER_SEC / rate;
+	    }
+	    /* dispatches the SIGUSR1 dump */
+	    g_main_context_iteration(NULL, FALSE);
+	    continue;
+	}
+
+	/* between two cycles all temporary objects are gone */
+	elapsed = (next_sample - start) / G_USEC_PER_SEC;
+	instances = fw_accounting_getTotalInstances();
+	rss = soak_rss();
+	g_print("%7us %10" G_GUINT64_FORMAT " %8" G_GUINT64_FORMAT
+		" %10d %12" G_GSIZE_FORMAT " %10" G_GUINT64_FORMAT "\n",
+		elapsed, cycles, errors, instances,
+		fw_accounting_getTotalBytes(), rss);
+	g_string_append_printf(str, "%u,%" G_GUINT64_FORMAT ",%"
+			       G_GUINT64_FORMAT ",%d,%" G_GSIZE_FORMAT ",%"
+			       G_GUINT64_FORMAT "\n", elapsed, cycles, errors,
+			       instances, fw_accounting_getTotalBytes(), rss);
+
+	if (elapsed > warmup) {
+	    if (instances_base < 0) {
+		instances_base = instances;
+		rss_base = rss;
+	    } else if (instances != instances_base) {
+		g_print("live instances changed from %d to %d\n",
+			instances_base, instances);
+		fw_accounting_print();
+		instances_base = instances;
+		failures++;
+	    }
+	}
+	next_sample += (gint64) sample * G_USEC_PER_SEC;
+    }
+
+    g_print("\n");
+    fw_accounting_print();
+
+    rss = soak_rss();
+    if (instances_base < 0)
+	g_print("\nno samples after the warmup\n");
+    else {
+	g_print("\nrss %" G_GUINT64_FORMAT " KB after the warmup, %"
+		G_GUINT64_FORMAT " KB at the end, %+" G_GINT64_FORMAT " KB\n",
+		rss_base, rss, (gint64) rss - (gint64) rss_base);
+	if (rss > rss_base + growth) {
+	    g_print("rss grew by more than %u KB\n", growth);
+	    failures++;
+	}
+    }
+    if (errors > 0) {
+	g_print("%" G_GUINT64_FORMAT " cycles failed\n", errors);
+	failures++;
+    }
+
+    if (csv != NULL && !g_file_set_contents(csv, str->str, str->len, NULL))
+	g_printerr("Writing '%s' failed\n", csv);
+    g_string_free(str, TRUE);
+    g_object_unref(client);
+
+    g_print("%s\n", (failures > 0) ? "FAILED" : "PASSED");
+
+    return (failures > 0) ? 1 : 0;
+}
@@ -0,0 +1,28 @@
+#!/bin/sh
+#
+# Copyright (C) 2017 Red Hat, Inc.
+#
+# Authors:
+# Thomas Woerner <twoerner@redhat.com>
+#
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 2 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+
+# Runs the soak test against mock_firewalld on a private bus.
+#
+# Usage: soak.sh [-D DELAY] [soak options]
+
+cd "$(dirname "$0")" || exit 1
+
+exec ./loadgen.sh -p ./soak "$@"